@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Mutex protection with a condition variable.
+ *
+ *****************************************************************************/
+
+#ifndef __vpCondition_h_
+#define __vpCondition_h_
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+
+#if defined(VISP_HAVE_PTHREAD)
+#  include <pthread.h>
+#elif defined(_WIN32)
+#  include <windows.h>
+#endif
+
+/*!
+
+   \class vpCondition
+
+   \ingroup group_core_threading
+
+   Class that associates a mutex and a condition variable.
+
+   Like vpMutex, lock() and unlock() protect the shared data. In addition,
+   a thread that owns the lock can call wait() to release it and sleep until
+   another thread calls signal() or broadcast(). The lock is owned again when
+   wait() returns. Since a thread may be woken up without a signal, the
+   condition has to be tested again in a loop.
+
+   This class implements native pthread functionalities if available, or
+   native Windows condition variables (Windows Vista and later) if pthread is
+   not available under Windows.
+
+   \code
+#include <visp3/core/vpCondition.h>
+
+vpCondition cond;
+bool ready = false;
+
+void consumer()
+{
+  vpCondition::vpScopedLock lock(cond);
+  while (! ready)
+    cond.wait();
+  // use the shared data
+}
+
+void producer()
+{
+  vpCondition::vpScopedLock lock(cond);
+  ready = true;
+  cond.broadcast();
+}
+   \endcode
+
+   \sa vpMutex
+*/
+class vpCondition {
+public:
+  vpCondition() : m_mutex(), m_cond() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_init( &m_mutex, NULL );
+    pthread_cond_init( &m_cond, NULL );
+#elif defined(_WIN32)
+    InitializeCriticalSection( &m_mutex );
+    InitializeConditionVariable( &m_cond );
+#endif
+  }
+  //! Lock the mutex.
+  void lock() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_lock( &m_mutex );
+#elif defined(_WIN32)
+    EnterCriticalSection( &m_mutex );
+#endif
+  }
+  //! Unlock the mutex.
+  void unlock() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(_WIN32)
+    LeaveCriticalSection( &m_mutex );
+#endif
+  }
+  /*!
+    Release the mutex and wait until the condition is signaled. The mutex has
+    to be locked by the calling thread; it is locked again when the function
+    returns.
+  */
+  void wait() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_wait( &m_cond, &m_mutex );
+#elif defined(_WIN32)
+    SleepConditionVariableCS( &m_cond, &m_mutex, INFINITE );
+#endif
+  }
+  //! Wake up one of the threads waiting for the condition.
+  void signal() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_signal( &m_cond );
+#elif defined(_WIN32)
+    WakeConditionVariable( &m_cond );
+#endif
+  }
+  //! Wake up all the threads waiting for the condition.
+  void broadcast() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_broadcast( &m_cond );
+#elif defined(_WIN32)
+    WakeAllConditionVariable( &m_cond );
+#endif
+  }
+  virtual ~vpCondition() {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_destroy( &m_cond );
+    pthread_mutex_destroy( &m_mutex );
+#elif defined(_WIN32)
+    DeleteCriticalSection( &m_mutex );
+#endif
+  }
+
+  /*!
+
+    \class vpScopedLock
+
+    \ingroup group_core_threading
+
+    \brief Class that locks a vpCondition in its constructor and unlocks it
+    in its destructor, like vpMutex::vpScopedLock.
+
+    \sa vpCondition
+  */
+  class vpScopedLock
+  {
+  private:
+    vpCondition & _cond;
+
+  public:
+    //! Constructor that locks the mutex.
+    vpScopedLock(vpCondition & cond)
+      : _cond(cond)
+    {
+      _cond.lock();
+    }
+    //! Destructor that unlocks the mutex.
+    ~vpScopedLock()
+    {
+      _cond.unlock();
+    }
+  };
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  vpCondition(const vpCondition &) : m_mutex(), m_cond() {}
+  vpCondition &operator=(const vpCondition &) { return *this; }
+#endif
+
+#if defined(VISP_HAVE_PTHREAD)
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+#elif defined(_WIN32)
+  CRITICAL_SECTION m_mutex;
+  CONDITION_VARIABLE m_cond;
+#endif
+};
+
+#endif
+#endif
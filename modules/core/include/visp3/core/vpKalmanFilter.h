@@ -104,6 +104,16 @@
 
   ViSP provides different state evolution models implemented in the
   vpLinearKalmanFilterInstantiation class.
+
+  When the signals are independent, the matrices \f${\bf F}\f$, \f${\bf
+  H}\f$, \f${\bf Q}\f$, \f${\bf R}\f$ and \f${\bf P}\f$ are block
+  diagonal, with one block per signal. Calling setBlockDiagonal(true) lets
+  prediction() and filtering() only process the diagonal blocks, signal per
+  signal, which makes their cost linear in the number of signals instead of
+  cubic. Only the diagonal blocks of the matrices are then read and updated,
+  the other coefficients are ignored. The signals are processed in parallel
+  when ViSP is built with OpenMP support. This mode is enabled by default in
+  vpLinearKalmanFilterInstantiation.
 */
 class VISP_EXPORT vpKalmanFilter
 {
@@ -122,6 +132,8 @@ protected :
 
   //! When set to true, print the content of internal variables during filtering() and prediction().
   bool verbose_mode;
+  //! When set to true, only the diagonal blocks corresponding to each signal are considered.
+  bool block_diagonal;
 
 public:
   vpKalmanFilter() ;
@@ -157,6 +169,20 @@ public:
     Return the iteration number.
   */
   long getIteration() { return iter ; }
+  /*!
+    Return true if the signals are filtered independently.
+    \sa setBlockDiagonal()
+  */
+  bool isBlockDiagonal() const { return block_diagonal; }
+  /*!
+    Consider that the signals are independent. In that case the prediction and
+    the filtering only use the diagonal blocks of size getStateSize() (or
+    getMeasureSize()) of the matrices, one per signal.
+
+    \param on : If true, the signals are filtered independently. Otherwise,
+    the whole matrices are used.
+  */
+  void setBlockDiagonal(bool on) { block_diagonal = on; }
   /*!
     Sets the verbose mode.
     \param on : If true, activates the verbose mode which consists in printing the Kalman 
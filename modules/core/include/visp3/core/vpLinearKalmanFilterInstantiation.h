@@ -83,10 +83,13 @@ class VISP_EXPORT vpLinearKalmanFilterInstantiation : public vpKalmanFilter
     Default linear Kalman filter.
     
     By default the state model is unknown and set to
-    vpLinearKalmanFilterInstantiation::unknown.
+    vpLinearKalmanFilterInstantiation::unknown. Since the signals are
+    independent in all the state models, they are filtered independently (see
+    vpKalmanFilter::setBlockDiagonal()).
   */
     vpLinearKalmanFilterInstantiation() : model(unknown)
     {
+      block_diagonal = true;
     };
 
   /*! Destructor that does nothng. */
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read-only memory mapping of a file.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpMemoryMappedFile.h
+  \brief Memory mapping of a file to access its content without reading it.
+*/
+
+#ifndef vpMemoryMappedFile_h
+#define vpMemoryMappedFile_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpMemoryMappedFile
+
+  \ingroup group_core_files_io
+
+  \brief Map the content of a file in memory.
+
+  The pages of the file are loaded by the system when they are first
+  accessed, so that opening even a large file is immediate and data that is
+  never accessed is never read. The mapping is private: the data can be
+  modified in memory (copy-on-write), but the modifications are never written
+  to the file. On platforms without memory mapping support, the file is read
+  in memory when it is opened.
+
+  The data is aligned on at least 8 bytes (on a memory page when the file is
+  mapped), so that arrays stored at offsets multiple of their element size in
+  the file can be used in place.
+
+  \code
+#include <visp3/core/vpMemoryMappedFile.h>
+
+int main()
+{
+  vpMemoryMappedFile file("data.bin");
+  const unsigned char *data = file.getData();
+  for (size_t i = 0; i < file.getSize(); i++) {
+    // Use data[i]
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpMemoryMappedFile
+{
+public:
+  vpMemoryMappedFile();
+  explicit vpMemoryMappedFile(const std::string &filename);
+  virtual ~vpMemoryMappedFile();
+
+  void close();
+
+  /*!
+    Return the content of the file, or NULL if no file is opened or the file is empty.
+  */
+  inline unsigned char *getData() { return m_data; }
+  /*!
+    Return the content of the file, or NULL if no file is opened or the file is empty.
+  */
+  inline const unsigned char *getData() const { return m_data; }
+  /*!
+    Return the size of the file in bytes.
+  */
+  inline size_t getSize() const { return m_size; }
+  /*!
+    Return true if the file is mapped in memory, false if it has been read
+    because memory mapping is not supported.
+  */
+  inline bool isMapped() const { return m_mapped; }
+  /*!
+    Return true if a file is opened.
+  */
+  inline bool isOpen() const { return m_opened; }
+
+  void open(const std::string &filename);
+
+private:
+  vpMemoryMappedFile(const vpMemoryMappedFile &);
+  vpMemoryMappedFile &operator=(const vpMemoryMappedFile &);
+
+  unsigned char *m_data;
+  size_t m_size;
+  bool m_opened;
+  bool m_mapped;
+  std::vector<double> m_buffer; // File content when the file cannot be mapped, aligned on 8 bytes
+#if defined(_WIN32)
+  void *m_fileHandle;
+  void *m_mappingHandle;
+#endif
+};
+
+#endif
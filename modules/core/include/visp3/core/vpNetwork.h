@@ -39,6 +39,7 @@
 #define vpNetwork_H
 
 #include <visp3/core/vpConfig.h>
+#include <visp3/core/vpNetworkMessage.h>
 #include <visp3/core/vpRequest.h>
 
 #include <vector>
@@ -153,6 +154,9 @@ private:
   void              _receiveRequestFrom(const unsigned int &receptorEmitting);
   int               _receiveRequestOnce();
   int               _receiveRequestOnceFrom(const unsigned int &receptorEmitting);
+
+  int               _receiveMessageFrom(vpNetworkMessage &msg, const unsigned int &receptorEmitting);
+  void              _closeReceptor(const unsigned int &receptorIndex);
   
 public:
 
@@ -197,6 +201,9 @@ public:
   int               receiveRequestOnce();
   int               receiveRequestOnceFrom(const unsigned int &receptorEmitting);
   
+  int               receiveMessage(vpNetworkMessage &msg);
+  int               receiveMessageFrom(vpNetworkMessage &msg, const unsigned int &receptorEmitting);
+
   std::vector<int>  receiveAndDecodeRequest();
   std::vector<int>  receiveAndDecodeRequestFrom(const unsigned int &receptorEmitting);
   int               receiveAndDecodeRequestOnce();
@@ -209,6 +216,9 @@ public:
   template<typename T>
   int               sendTo(T* object, const unsigned int &dest, const unsigned int &sizeOfObject = sizeof(T));
   
+  int               sendMessage(const vpNetworkMessage &msg);
+  int               sendMessageTo(const vpNetworkMessage &msg, const unsigned int &dest);
+
   int               sendRequest(vpRequest &req);
   int               sendRequestTo(vpRequest &req, const unsigned int &dest);
   
@@ -0,0 +1,290 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Binary message transiting on the network.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpNetworkMessage.h
+  \brief Binary message sent and received by vpNetwork without text encoding.
+*/
+
+#ifndef vpNetworkMessage_H
+#define vpNetworkMessage_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpMatrix.h>
+
+/*!
+  \class vpNetworkMessage
+
+  \ingroup group_core_network
+
+  \brief Binary message made of several parts that transits on the network
+  with vpNetwork::sendMessage() and vpNetwork::receiveMessage().
+
+  Contrary to vpRequest, the parts of the message are not encoded in strings
+  and separated by text delimiters. The message is sent as a length-prefixed
+  frame:
+  - a fixed size header containing a magic number, the size of the id and the
+    number of parts,
+  - a descriptor per part giving its type, its size and for images and
+    matrices its dimensions,
+  - the id of the message,
+  - the data of each part.
+
+  On emission, addImage(), addMatrix() and addData() only keep a pointer on
+  the data: the whole frame is sent with a single scatter/gather system call
+  directly from the image bitmap or the matrix data. The objects added to the
+  message have thus to stay valid and unchanged until the message is sent.
+
+  On reception, the data of the parts are read with a single scatter/gather
+  system call. By default they are stored in an internal buffer that is reused
+  from one message to the next and can be copied with getImage() or
+  getMatrix(). A part can also be bound to an image or a matrix with
+  bindImage() or bindMatrix(): the object is resized and the data are received
+  directly in it without any copy.
+
+  The data are sent with the byte order of the emitter. A receiver with a
+  different byte order rejects the message.
+
+  A received frame is rejected, and the connection with the emitter is shut
+  down, when it is not a valid vpNetworkMessage frame: wrong magic number,
+  more than 65536 parts, an id longer than 65536 bytes, an image or a matrix
+  part whose number of elements does not fit in an unsigned int or whose size
+  does not match its dimensions, or data larger than 1 GB (\f$2^{30}\f$
+  bytes) for the whole frame.
+
+  Here is an example of a client sending an image with the estimated pose of
+  an object:
+  \code
+#include <visp3/core/vpClient.h>
+
+int main()
+{
+  vpClient client;
+  client.connectToIP("127.0.0.1", 35000);
+
+  vpImage<unsigned char> I(480, 640, 128);
+  vpHomogeneousMatrix cMo(0.1, 0.2, 1.0, 0, 0, 0);
+
+  vpNetworkMessage msg("pose");
+  msg.addImage(I);
+  msg.addMatrix(cMo);
+  client.sendMessage(msg);
+}
+  \endcode
+
+  and the corresponding server receiving the image and the pose directly in
+  the destination objects:
+  \code
+#include <visp3/core/vpServer.h>
+
+int main()
+{
+  vpServer serv(35000);
+  serv.start();
+
+  vpImage<unsigned char> I;
+  vpHomogeneousMatrix cMo;
+  vpNetworkMessage msg;
+  std::vector<unsigned int> clients;
+
+  while (true) {
+    serv.checkForActivity(clients, 100);
+    for (size_t i = 0; i < clients.size(); i++) {
+      msg.bindImage(0, I);
+      msg.bindMatrix(1, cMo);
+      if (serv.receiveMessageFrom(msg, clients[i]) > 0 && msg.getId() == "pose")
+        std::cout << "Received a " << I.getWidth() << "x" << I.getHeight() << " image and cMo:\n" << cMo << std::endl;
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpNetworkMessage
+{
+  friend class vpNetwork;
+
+public:
+  //! Type of a part of the message.
+  typedef enum {
+    PART_DATA,   //!< Raw data.
+    PART_IMAGE,  //!< Bitmap of a vpImage.
+    PART_MATRIX  //!< Data of a vpArray2D<double> (vpMatrix, vpHomogeneousMatrix, vpColVector...).
+  } vpPartType;
+
+  vpNetworkMessage();
+  explicit vpNetworkMessage(const std::string &id);
+  virtual ~vpNetworkMessage();
+
+  void addData(const void *data, size_t size);
+  /*!
+    Add an image to the message. Only a pointer on the bitmap is kept: the
+    image has to stay valid and unchanged until the message is sent.
+
+    \param I : Image to send.
+  */
+  template <class Type> void addImage(const vpImage<Type> &I)
+  {
+    addPart(PART_IMAGE, sizeof(Type), I.getHeight(), I.getWidth(), I.bitmap);
+  }
+  void addMatrix(const vpArray2D<double> &M);
+
+  /*!
+    Receive directly the image part \e index of the next received messages in
+    \e I, that is resized if needed. If the part \e index of a received
+    message is not an image of \e Type, it is stored in the internal buffer
+    instead.
+
+    \param index : Index of the part.
+    \param I : Destination image that has to stay valid while the binding is active.
+
+    \sa unbind()
+  */
+  template <class Type> void bindImage(unsigned int index, vpImage<Type> &I)
+  {
+    bind(index, PART_IMAGE, sizeof(Type), &I, &vpNetworkMessage::resizeImage<Type>);
+  }
+  void bindMatrix(unsigned int index, vpMatrix &M);
+  void bindMatrix(unsigned int index, vpHomogeneousMatrix &M);
+
+  void clear();
+
+  const void *getData(unsigned int index) const;
+  /*!
+    Return the id of the message.
+  */
+  inline std::string getId() const { return m_id; }
+  /*!
+    Copy the image part \e index in \e I. Nothing is copied if the part was
+    received directly in \e I with bindImage().
+
+    \param index : Index of the part.
+    \param I : Image resized to the dimensions of the part.
+
+    \exception vpException::badValue : If the part is not an image of \e Type.
+  */
+  template <class Type> void getImage(unsigned int index, vpImage<Type> &I) const
+  {
+    const vpPartHeader &part = checkPart(index, PART_IMAGE, sizeof(Type));
+    if (m_data[index] == I.bitmap)
+      return;
+    I.resize(part.rows, part.cols);
+    if (part.size)
+      memcpy((void *)I.bitmap, m_data[index], (size_t)part.size);
+  }
+  void getMatrix(unsigned int index, vpMatrix &M) const;
+  void getMatrix(unsigned int index, vpHomogeneousMatrix &M) const;
+  /*!
+    Return the number of parts of the message.
+  */
+  inline unsigned int getNumberOfParts() const { return (unsigned int)m_parts.size(); }
+  /*!
+    Return the number of columns of the image or matrix part \e index.
+  */
+  inline unsigned int getPartCols(unsigned int index) const { return m_parts.at(index).cols; }
+  /*!
+    Return the number of rows of the image or matrix part \e index.
+  */
+  inline unsigned int getPartRows(unsigned int index) const { return m_parts.at(index).rows; }
+  /*!
+    Return the size in bytes of the data of the part \e index.
+  */
+  inline size_t getPartSize(unsigned int index) const { return (size_t)m_parts.at(index).size; }
+  /*!
+    Return the type of the part \e index.
+  */
+  inline vpPartType getPartType(unsigned int index) const { return (vpPartType)m_parts.at(index).type; }
+
+  /*!
+    Set the id of the message.
+  */
+  inline void setId(const std::string &id) { m_id = id; }
+
+  void unbind();
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+protected:
+  //! Descriptor of a part as it is sent on the network.
+  struct vpPartHeader {
+    uint32_t type;
+    uint32_t elemSize;
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t size;
+  };
+
+  typedef void *(*vpResizeFunction)(void *object, unsigned int rows, unsigned int cols);
+
+  struct vpBinding {
+    unsigned int index;
+    uint32_t type;
+    uint32_t elemSize;
+    void *object;
+    vpResizeFunction resize;
+  };
+
+  void addPart(vpPartType type, size_t elemSize, unsigned int rows, unsigned int cols, const void *data);
+  void bind(unsigned int index, vpPartType type, size_t elemSize, void *object, vpResizeFunction resize);
+  const vpPartHeader &checkPart(unsigned int index, vpPartType type, size_t elemSize) const;
+
+  // The number of elements rows*cols of a received part is checked by vpNetwork before the call
+  template <class Type> static void *resizeImage(void *object, unsigned int rows, unsigned int cols)
+  {
+    vpImage<Type> *I = static_cast<vpImage<Type> *>(object);
+    I->resize(rows, cols);
+    return (void *)I->bitmap;
+  }
+  static void *resizeMatrix(void *object, unsigned int rows, unsigned int cols);
+  static void *resizeHomogeneousMatrix(void *object, unsigned int rows, unsigned int cols);
+
+  std::string m_id;
+  std::vector<vpPartHeader> m_parts;
+  //! Data of each part: user data on emission, bound object or internal buffer on reception
+  std::vector<const void *> m_data;
+  std::vector<vpBinding> m_bindings;
+  //! Storage of the received parts that are not bound
+  std::vector<unsigned char> m_buffer;
+  //! Storage of the id and the part descriptors on reception
+  std::vector<char> m_header;
+#endif
+};
+
+#endif
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Point cloud container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPointCloud.h
+  \brief Contiguous point cloud container filled from depth images.
+*/
+
+#ifndef vpPointCloud_h
+#define vpPointCloud_h
+
+#include <stdint.h>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpPointCloud
+
+  \ingroup group_core_geometry
+
+  \brief Container of 3D points stored as a structure of arrays.
+
+  The X, Y and Z coordinates of the points are stored in three contiguous
+  float arrays (see getX(), getY() and getZ()) allocated in a single buffer.
+  An optional color per point can be enabled with enableColor(). The buffer
+  is only reallocated when the number of points changes, so that a point
+  cloud acquired at each frame does not cost any allocation.
+
+  A point cloud built from a depth image is organized: it has the height and
+  the width of the depth image, and the point corresponding to pixel (i,j)
+  has index i*getWidth()+j. Pixels without depth measurement, or farther
+  than the maximal depth, lead to points with X = Y = Z = 0.
+
+  The following example shows how to fill a point cloud from a depth image
+  given in millimeters:
+  \code
+#include <visp3/core/vpPointCloud.h>
+
+int main()
+{
+  vpImage<uint16_t> depth(480, 640, 1000); // Depth in mm
+  vpCameraParameters cam(525., 525., 320., 240.);
+  vpPointCloud pointcloud;
+  pointcloud.deproject(depth, cam, 0.001f, 5.f); // Keep points closer than 5 m
+
+  const float *Z = pointcloud.getZ();
+  std::cout << "Z of the point at pixel (10, 20): " << Z[10*pointcloud.getWidth() + 20] << std::endl;
+}
+  \endcode
+
+  The deprojection uses per-pixel normalized coordinate tables computed with
+  vpPixelMeterConversion, so that camera parameters with distortion are
+  supported. The tables are cached and only recomputed when the camera
+  parameters or the image size change. The deprojection itself uses SSE2 when
+  available and OpenMP when ViSP is built with OpenMP support.
+*/
+class VISP_EXPORT vpPointCloud
+{
+public:
+  vpPointCloud();
+  explicit vpPointCloud(unsigned int n);
+  vpPointCloud(unsigned int height, unsigned int width);
+  virtual ~vpPointCloud();
+
+  void clear();
+
+  void colorize(const vpImage<vpRGBa> &I, const vpCameraParameters &cam, const vpHomogeneousMatrix &cMd);
+
+  void deproject(const vpImage<uint16_t> &depth, const vpCameraParameters &cam, float depth_scale, float max_Z=10.f);
+  void deproject(const uint16_t *depth, unsigned int height, unsigned int width, const vpCameraParameters &cam,
+                 float depth_scale, float max_Z=10.f);
+  void deproject(const vpImage<float> &depth, const vpCameraParameters &cam, float max_Z=10.f);
+
+  void enableColor(bool enable);
+
+  /*!
+    Return the colors of the points, or NULL if the color is not enabled.
+    \sa enableColor()
+  */
+  inline vpRGBa *getColor() { return m_color.empty() ? NULL : &m_color[0]; }
+  /*!
+    Return the colors of the points, or NULL if the color is not enabled.
+    \sa enableColor()
+  */
+  inline const vpRGBa *getColor() const { return m_color.empty() ? NULL : &m_color[0]; }
+  /*!
+    Return the height of an organized point cloud, 1 otherwise.
+  */
+  inline unsigned int getHeight() const { return m_height; }
+  /*!
+    Get the coordinates of the point \e index.
+  */
+  inline void getPoint(unsigned int index, float &X, float &Y, float &Z) const
+  {
+    X = m_xyz[index];
+    Y = m_xyz[m_size + index];
+    Z = m_xyz[2*m_size + index];
+  }
+  unsigned int getValidPointCount() const;
+  /*!
+    Return the width of an organized point cloud, the number of points otherwise.
+  */
+  inline unsigned int getWidth() const { return m_width; }
+  /*!
+    Return the X coordinates of the points.
+  */
+  inline float *getX() { return m_size ? &m_xyz[0] : NULL; }
+  /*!
+    Return the X coordinates of the points.
+  */
+  inline const float *getX() const { return m_size ? &m_xyz[0] : NULL; }
+  /*!
+    Return the Y coordinates of the points.
+  */
+  inline float *getY() { return m_size ? &m_xyz[m_size] : NULL; }
+  /*!
+    Return the Y coordinates of the points.
+  */
+  inline const float *getY() const { return m_size ? &m_xyz[m_size] : NULL; }
+  /*!
+    Return the Z coordinates of the points.
+  */
+  inline float *getZ() { return m_size ? &m_xyz[2*m_size] : NULL; }
+  /*!
+    Return the Z coordinates of the points.
+  */
+  inline const float *getZ() const { return m_size ? &m_xyz[2*m_size] : NULL; }
+
+  /*!
+    Return true if the color of the points is available.
+  */
+  inline bool hasColor() const { return m_colorEnabled; }
+  /*!
+    Return true if the point cloud is organized as an image, that is if its height is greater than 1.
+  */
+  inline bool isOrganized() const { return m_height > 1; }
+  /*!
+    Return true if the point \e index has a depth measurement.
+  */
+  inline bool isValid(unsigned int index) const { return m_xyz[2*m_size + index] > 0; }
+
+  void resize(unsigned int n);
+  void resize(unsigned int height, unsigned int width);
+
+  /*!
+    Set the coordinates of the point \e index.
+  */
+  inline void setPoint(unsigned int index, float X, float Y, float Z)
+  {
+    m_xyz[index] = X;
+    m_xyz[m_size + index] = Y;
+    m_xyz[2*m_size + index] = Z;
+  }
+
+  /*!
+    Return the number of points.
+  */
+  inline unsigned int size() const { return m_size; }
+
+  void toVector(std::vector<vpColVector> &pointcloud) const;
+
+private:
+  void updateDeprojectionTables(unsigned int height, unsigned int width, const vpCameraParameters &cam);
+
+  unsigned int m_height;
+  unsigned int m_width;
+  unsigned int m_size;
+  std::vector<float> m_xyz; //!< X coordinates, then Y coordinates, then Z coordinates
+  bool m_colorEnabled;
+  std::vector<vpRGBa> m_color;
+
+  // Cache of the normalized coordinates of each pixel used by deproject()
+  std::vector<float> m_xn;
+  std::vector<float> m_yn;
+  unsigned int m_tableHeight;
+  unsigned int m_tableWidth;
+  vpCameraParameters m_tableCam;
+};
+
+#endif
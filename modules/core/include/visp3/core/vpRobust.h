@@ -49,6 +49,8 @@
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpMath.h>
 
+#include <vector>
+
 
 /*!
   \class vpRobust
@@ -111,6 +113,12 @@ public:
 		 const vpColVector& all_residues,
 		 vpColVector &weights);
 
+  //! Compute the weights of several groups of residues, each group having its own scale
+  void MEstimator(const vpRobustEstimatorType method,
+                  const vpColVector &residues,
+                  const std::vector<unsigned int> &groupSizes,
+                  vpColVector &weights);
+
   vpRobust & operator=(const vpRobust &other);
 #ifdef VISP_HAVE_CPP11_COMPATIBILITY
   vpRobust & operator=(const vpRobust &&other);
@@ -208,7 +216,7 @@ public:
   void exch(double &A, double &B){swap = A; A = B;  B = swap;}
   //! Sort function using partition method
   int partition(vpColVector &a, int l, int r);
-  //! Sort the vector and select a value in the sorted vector
+  //! Partially sort the vector and select a value in the sorted vector
   double select(vpColVector &a, int l, int r, int k);
   //@}
 };
@@ -43,6 +43,9 @@
 #include <visp3/core/vpException.h>
 #include <visp3/core/vpNetwork.h>
 
+#if defined(__linux__)
+#  include <set>
+#endif
 
 /*!
   \class vpServer
@@ -153,6 +156,13 @@ int main(int argc,const char** argv)
 }
   \endcode
   
+  When many clients are connected, checkForActivity() accepts the new
+  clients, detects the disconnections and returns the clients that have data
+  to read in a single call. On Linux it relies on epoll, so that its cost does
+  not grow with the number of idle clients. An example of server receiving
+  binary messages with checkForActivity() is given in vpNetworkMessage
+  documentation.
+
   \sa vpClient
   \sa vpRequest
   \sa vpNetwork
@@ -168,7 +178,13 @@ private:
   int          port;
   bool         started;
   unsigned int max_clients;
-  
+#if defined(__linux__)
+  int           epollFileDescriptor;
+  std::set<int> epollSockets;
+#endif
+
+  bool          acceptClient();
+
 public:
   
   vpServer();
@@ -177,6 +193,7 @@ public:
   
   virtual       ~vpServer();
   
+  int           checkForActivity(std::vector<unsigned int> &clients, int timeout_ms = 0);
   bool          checkForConnections();
   
   /*!
@@ -203,6 +220,14 @@ public:
     \return Number of clients connected.
   */
   unsigned int  getNumberOfClients(){ return (unsigned int)receptor_list.size(); }
+
+  /*!
+    Get the port of the server. If the server was built without port, the
+    port chosen by the system is available once the server is started.
+
+    \return Port of the server.
+  */
+  int           getPort(){ return port; }
   
   void          print();
   
@@ -0,0 +1,315 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Shared memory ring buffer of images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSharedImageBuffer.h
+  \brief Image transport between processes of the same host through shared memory.
+*/
+
+#ifndef vpSharedImageBuffer_H
+#define vpSharedImageBuffer_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImage.h>
+
+class vpSharedImageBuffer;
+
+/*!
+  \class vpSharedImageView
+
+  \ingroup group_core_network
+
+  \brief Read-only view of a frame published in a vpSharedImageBuffer.
+
+  The image returned by getImage() points directly in the shared memory
+  segment: no pixel is copied. The view stays attached to its frame until the
+  producer reuses the corresponding slot of the ring buffer, which happens
+  after the publication of vpSharedImageBuffer::getNumberOfSlots()-1 new
+  frames. Use vpSharedImageBuffer::isValid() after having processed the view
+  to check that the frame was not overwritten meanwhile.
+*/
+template <class Type> class vpSharedImageView
+{
+  friend class vpSharedImageBuffer;
+
+public:
+  vpSharedImageView() : m_image(), m_sequence(0), m_timestamp(0) {}
+  virtual ~vpSharedImageView()
+  {
+    // The bitmap belongs to the shared memory segment
+    m_image.bitmap = NULL;
+  }
+
+  /*!
+    Return the image of the frame. Its bitmap is mapped read-only: it must not
+    be modified nor resized.
+  */
+  inline const vpImage<Type> &getImage() const { return m_image; }
+  /*!
+    Return the sequence number of the frame, 0 if the view is not attached to a frame.
+  */
+  inline uint64_t getSequence() const { return m_sequence; }
+  /*!
+    Return the timestamp given by the producer when the frame was published.
+  */
+  inline double getTimestamp() const { return m_timestamp; }
+
+private:
+  vpSharedImageView(const vpSharedImageView &);
+  vpSharedImageView &operator=(const vpSharedImageView &);
+
+  void attach(const void *bitmap, unsigned int height, unsigned int width, uint64_t sequence, double timestamp)
+  {
+    if (m_image.bitmap != bitmap) {
+      m_image.bitmap = NULL;
+      m_image.init(static_cast<Type *>(const_cast<void *>(bitmap)), height, width, false);
+    }
+    m_sequence = sequence;
+    m_timestamp = timestamp;
+  }
+
+  vpImage<Type> m_image;
+  uint64_t m_sequence;
+  double m_timestamp;
+};
+
+/*!
+  \class vpSharedImageBuffer
+
+  \ingroup group_core_network
+
+  \brief Ring buffer of images in a named shared memory segment, used to
+  exchange frames between processes running on the same host.
+
+  A single producer creates the segment with create() and publishes frames
+  with publish(), or writes them in place with beginPublish() and
+  endPublish(). Each frame gets a sequence number, starting from 1, and a
+  timestamp. Any number of consumers open the segment with open() and either
+  copy the latest frame with getFrame(), or map it without copy as a read-only
+  vpImage with getView().
+
+  The protocol is lock-free: the producer never waits for the consumers and
+  a consumer never blocks the producer. Each slot of the ring buffer carries
+  the sequence number of the frame it contains, reset while the producer
+  overwrites it, so that consumers detect frames overwritten during a copy
+  (getFrame() then retries with the latest frame) or while a view is used
+  (see isValid()). The number of slots gives the number of frames a consumer
+  can lag behind the producer before its views are overwritten.
+
+  The segments are created with POSIX shared memory and are only available
+  on UNIX platforms.
+
+  Producer side:
+  \code
+#include <visp3/core/vpSharedImageBuffer.h>
+#include <visp3/core/vpTime.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640);
+  vpSharedImageBuffer buffer;
+  buffer.create<unsigned char>("/visp_camera", I.getHeight(), I.getWidth(), 4);
+  for (;;) {
+    // ... acquire I
+    buffer.publish(I, vpTime::measureTimeMs());
+  }
+}
+  \endcode
+
+  Consumer side:
+  \code
+#include <visp3/core/vpSharedImageBuffer.h>
+
+int main()
+{
+  vpSharedImageBuffer buffer;
+  buffer.open("/visp_camera");
+  vpSharedImageView<unsigned char> view;
+  uint64_t last = 0;
+  while (buffer.waitForFrame(last, 1000)) {
+    if (buffer.getView(view)) {
+      const vpImage<unsigned char> &I = view.getImage();
+      // ... process I
+      if (! buffer.isValid(view))
+        std::cout << "Frame " << view.getSequence() << " was overwritten during the processing" << std::endl;
+      last = view.getSequence();
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpSharedImageBuffer
+{
+public:
+  vpSharedImageBuffer();
+  virtual ~vpSharedImageBuffer();
+
+  void *beginPublish();
+
+  void close();
+
+  /*!
+    Create the shared memory segment and become its producer. If a segment
+    with the same name already exists, it is unlinked and a new segment is
+    created: the consumers that opened the former segment keep reading its
+    last frames and have to call open() again to get the new ones.
+
+    \param name : Name of the segment, for example "/visp_camera".
+    \param height, width : Size of the published images.
+    \param nbSlots : Number of frames in the ring buffer, at least 2.
+  */
+  template <class Type>
+  void create(const std::string &name, unsigned int height, unsigned int width, unsigned int nbSlots = 4)
+  {
+    createSegment(name, height, width, (unsigned int)sizeof(Type), nbSlots);
+  }
+
+  uint64_t endPublish(double timestamp);
+
+  /*!
+    Copy the latest published frame in \e I. If the frame is overwritten by the
+    producer during the copy, the copy is done again with the new latest frame.
+
+    \param I : Copy of the frame.
+    \param sequence : Sequence number of the frame.
+    \param timestamp : Timestamp of the frame.
+
+    \return false if no frame was published yet.
+  */
+  template <class Type> bool getFrame(vpImage<Type> &I, uint64_t &sequence, double &timestamp) const
+  {
+    checkPixelSize(sizeof(Type));
+    if (I.getHeight() != m_height || I.getWidth() != m_width)
+      I.resize(m_height, m_width);
+    return copyLatest((void *)I.bitmap, sequence, timestamp);
+  }
+
+  uint64_t getLastSequence() const;
+  //! Return the height of the images.
+  inline unsigned int getHeight() const { return m_height; }
+  //! Return the name of the shared memory segment.
+  inline std::string getName() const { return m_name; }
+  //! Return the number of frames of the ring buffer.
+  inline unsigned int getNumberOfSlots() const { return m_nbSlots; }
+  //! Return the width of the images.
+  inline unsigned int getWidth() const { return m_width; }
+
+  /*!
+    Attach \e view to the latest published frame, without copy.
+
+    \param view : View on the frame.
+
+    \return false if no frame was published yet.
+  */
+  template <class Type> bool getView(vpSharedImageView<Type> &view) const
+  {
+    checkPixelSize(sizeof(Type));
+    uint64_t sequence;
+    double timestamp;
+    const void *bitmap = latestSlot(sequence, timestamp);
+    if (bitmap == NULL)
+      return false;
+    view.attach(bitmap, m_height, m_width, sequence, timestamp);
+    return true;
+  }
+
+  //! Return true if the segment was created by this object with create().
+  inline bool isProducer() const { return m_producer; }
+
+  /*!
+    Return true if the frame of \e view was not overwritten by the producer
+    since getView() was called.
+  */
+  template <class Type> bool isValid(const vpSharedImageView<Type> &view) const
+  {
+    return view.getSequence() != 0 && isSlotValid(view.getSequence());
+  }
+
+  void open(const std::string &name);
+
+  /*!
+    Copy \e I in the next slot of the ring buffer and publish it.
+
+    \param I : Image to publish, with the size given to create().
+    \param timestamp : Timestamp of the frame, for example the acquisition time.
+
+    \return The sequence number of the published frame.
+  */
+  template <class Type> uint64_t publish(const vpImage<Type> &I, double timestamp)
+  {
+    checkPixelSize(sizeof(Type));
+    if (I.getHeight() != m_height || I.getWidth() != m_width) {
+      throw(vpException(vpException::dimensionError, "Cannot publish a %dx%d image in a %dx%d shared buffer",
+                        I.getWidth(), I.getHeight(), m_width, m_height));
+    }
+    void *slot = beginPublish();
+    memcpy(slot, (const void *)I.bitmap, (size_t)I.getSize() * sizeof(Type));
+    return endPublish(timestamp);
+  }
+
+  bool waitForFrame(uint64_t sequence, double timeout_ms) const;
+
+private:
+  vpSharedImageBuffer(const vpSharedImageBuffer &);
+  vpSharedImageBuffer &operator=(const vpSharedImageBuffer &);
+
+  void checkPixelSize(size_t pixelSize) const;
+  bool copyLatest(void *bitmap, uint64_t &sequence, double &timestamp) const;
+  void createSegment(const std::string &name, unsigned int height, unsigned int width, unsigned int pixelSize,
+                     unsigned int nbSlots);
+  bool isSlotValid(uint64_t sequence) const;
+  const void *latestSlot(uint64_t &sequence, double &timestamp) const;
+  void map(size_t size, bool writable);
+
+  std::string m_name;
+  bool m_producer;
+  unsigned char *m_segment;
+  size_t m_segmentSize;
+  unsigned int m_height;
+  unsigned int m_width;
+  unsigned int m_pixelSize;
+  unsigned int m_nbSlots;
+  size_t m_slotSize;
+  uint64_t m_writeSequence; //!< Sequence number of the frame being written by the producer
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int m_fd;
+#endif
+};
+
+#endif
@@ -45,6 +45,354 @@
 #  include <cv.h>
 #endif
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifdef VISP_HAVE_OPENMP
+#  include <omp.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /* Rows of a ring buffer indexed by an increasing (possibly negative) row
+     number. Each row has \e pad extra elements on both sides. */
+  template <class Type>
+  class vpRowRing
+  {
+  public:
+    vpRowRing(unsigned int nrows, unsigned int width, unsigned int pad)
+      : m_nrows(nrows), m_stride(width + 2*pad), m_pad(pad), m_data(nrows * (width + 2*pad), 0)
+    {
+    }
+
+    Type *row(int index)
+    {
+      int r = index % (int) m_nrows;
+      if (r < 0)
+        r += (int) m_nrows;
+      return &m_data[(unsigned int) r * m_stride + m_pad];
+    }
+
+  private:
+    unsigned int m_nrows;
+    unsigned int m_stride;
+    unsigned int m_pad;
+    std::vector<Type> m_data;
+  };
+
+  // Index of a pixel outside [0, n-1] with a border reflected without duplication (as in "gfedcb|abcdefgh|gfedcba")
+  inline int reflect101(int i, int n)
+  {
+    if (n == 1)
+      return 0;
+    while (i < 0 || i >= n) {
+      if (i < 0)
+        i = -i;
+      if (i >= n)
+        i = 2*n - 2 - i;
+    }
+    return i;
+  }
+
+  inline int clampIndex(int i, int n)
+  {
+    return i < 0 ? 0 : (i >= n ? n-1 : i);
+  }
+
+  /* Canny edge detection on the rows [y0, y1) of the image. The rows are
+     streamed through Gaussian blur, Sobel derivatives and non-maximum
+     suppression, so that only a few rows of each stage are stored. E is set to
+     255 for edges above the upper threshold, 1 for edges above the lower
+     threshold and 0 otherwise. The strong edges are pushed on the stack. */
+  class vpCannyBand
+  {
+  public:
+    vpCannyBand(const vpImage<unsigned char> &I, const std::vector<int> &gaussian, const std::vector<int> &smooth,
+                const std::vector<int> &derivative)
+      : m_I(I), m_w((int) I.getWidth()), m_h((int) I.getHeight()),
+        m_gaussian(gaussian), m_smooth(smooth), m_derivative(derivative),
+        m_r((int) gaussian.size() / 2), m_s((int) smooth.size() / 2),
+        m_src(I.getWidth() + 2*gaussian.size()), m_acc(I.getWidth()),
+        m_horizontal((unsigned int) gaussian.size(), I.getWidth(), 0),
+        m_blurred((unsigned int) smooth.size(), I.getWidth(), (unsigned int) smooth.size() / 2),
+        m_dx(3, I.getWidth(), 0), m_dy(3, I.getWidth(), 0), m_mag(3, I.getWidth(), 1),
+        m_sm(I.getWidth() + smooth.size()), m_dv(I.getWidth() + smooth.size()),
+        m_smS(I.getWidth() + 2), m_dvS(I.getWidth() + 2),
+        m_lastHorizontal(0), m_lastBlurred(0)
+    {
+    }
+
+    void detect(vpImage<unsigned char> &E, int y0, int y1, int low, int high, std::vector<unsigned int> &stack)
+    {
+      int t0 = y0 - 1;
+      m_lastBlurred = clampIndex(t0 - m_s, m_h) - 1;
+      m_lastHorizontal = m_lastBlurred - m_r;
+
+      for (int t = t0; t <= y1; t++) {
+        computeMagnitude(t);
+        if (t - 1 >= y0)
+          suppressNonMaxima(E, t - 1, low, high, stack);
+      }
+    }
+
+  private:
+    // Horizontal Gaussian blur of the source row reflect(v), in Q8
+    void computeHorizontal(int v)
+    {
+      const unsigned char *src = m_I[(unsigned int) reflect101(v, m_h)];
+      int *h = m_horizontal.row(v);
+      const int k = (int) m_gaussian.size();
+      for (int x = -m_r; x < m_w + m_r; x++)
+        m_src[(size_t) (x + m_r)] = src[reflect101(x, m_w)];
+
+      const int *s = &m_src[0];
+      for (int x = 0; x < m_w; x++)
+        h[x] = 0;
+      for (int i = 0; i < k; i++) {
+        const int c = m_gaussian[(size_t) i];
+        const int *si = s + i;
+        for (int x = 0; x < m_w; x++)
+          h[x] += c * si[x];
+      }
+    }
+
+    // Vertical Gaussian blur giving the blurred row u, with its borders replicated
+    void computeBlurred(int u)
+    {
+      while (m_lastHorizontal < u + m_r)
+        computeHorizontal(++m_lastHorizontal);
+
+      short *b = m_blurred.row(u);
+      const int k = (int) m_gaussian.size();
+      int *acc = &m_acc[0];
+      for (int x = 0; x < m_w; x++)
+        acc[x] = 1 << 15;
+      for (int j = 0; j < k; j++) {
+        const int c = m_gaussian[(size_t) j];
+        const int *h = m_horizontal.row(u - m_r + j);
+        for (int x = 0; x < m_w; x++)
+          acc[x] += c * h[x];
+      }
+      for (int x = 0; x < m_w; x++)
+        b[x] = (short) (acc[x] >> 16);
+      for (int x = 1; x <= m_s; x++) {
+        b[-x] = b[0];
+        b[m_w - 1 + x] = b[m_w - 1];
+      }
+    }
+
+    // Sobel derivatives and L1 gradient magnitude of the row t, null outside of the image
+    void computeMagnitude(int t)
+    {
+      int *dx = m_dx.row(t);
+      int *dy = m_dy.row(t);
+      int *mag = m_mag.row(t);
+      if (t < 0 || t >= m_h) {
+        for (int x = -1; x <= m_w; x++)
+          mag[x] = 0;
+        return;
+      }
+
+      while (m_lastBlurred < clampIndex(t + m_s, m_h))
+        computeBlurred(++m_lastBlurred);
+
+      if (m_s == 1) {
+        sobel3(m_blurred.row(clampIndex(t-1, m_h)), m_blurred.row(t), m_blurred.row(clampIndex(t+1, m_h)),
+               dx, dy, mag);
+      }
+      else {
+        // Separable filtering: vertical smoothing / derivative, then horizontal derivative / smoothing
+        const int n = (int) m_smooth.size();
+        int *sm = &m_sm[0] + m_s;
+        int *dv = &m_dv[0] + m_s;
+        for (int x = -m_s; x < m_w + m_s; x++)
+          sm[x] = dv[x] = 0;
+        for (int j = 0; j < n; j++) {
+          const short *b = m_blurred.row(clampIndex(t - m_s + j, m_h));
+          const int cs = m_smooth[(size_t) j], cd = m_derivative[(size_t) j];
+          for (int x = -m_s; x < m_w + m_s; x++) {
+            sm[x] += cs * b[x];
+            dv[x] += cd * b[x];
+          }
+        }
+        for (int x = 0; x < m_w; x++)
+          dx[x] = dy[x] = 0;
+        for (int i = 0; i < n; i++) {
+          const int cs = m_smooth[(size_t) i], cd = m_derivative[(size_t) i];
+          const int *smi = sm - m_s + i;
+          const int *dvi = dv - m_s + i;
+          for (int x = 0; x < m_w; x++) {
+            dx[x] += cd * smi[x];
+            dy[x] += cs * dvi[x];
+          }
+        }
+        for (int x = 0; x < m_w; x++)
+          mag[x] = std::abs(dx[x]) + std::abs(dy[x]);
+      }
+      mag[-1] = mag[m_w] = 0;
+    }
+
+    // 3x3 Sobel on three blurred rows with replicated borders
+    void sobel3(const short *b0, const short *b1, const short *b2, int *dx, int *dy, int *mag)
+    {
+      short *sm = &m_smS[0] + 1;
+      short *dv = &m_dvS[0] + 1;
+      int x = -1;
+#if VISP_HAVE_SSE2
+      for (; x + 8 <= m_w + 1; x += 8) {
+        __m128i r0 = _mm_loadu_si128((const __m128i *) (b0 + x));
+        __m128i r1 = _mm_loadu_si128((const __m128i *) (b1 + x));
+        __m128i r2 = _mm_loadu_si128((const __m128i *) (b2 + x));
+        _mm_storeu_si128((__m128i *) (sm + x), _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_slli_epi16(r1, 1)));
+        _mm_storeu_si128((__m128i *) (dv + x), _mm_sub_epi16(r2, r0));
+      }
+#endif
+      for (; x <= m_w; x++) {
+        sm[x] = (short) (b0[x] + 2*b1[x] + b2[x]);
+        dv[x] = (short) (b2[x] - b0[x]);
+      }
+
+      x = 0;
+#if VISP_HAVE_SSE2
+      const __m128i zero = _mm_setzero_si128();
+      for (; x + 8 <= m_w; x += 8) {
+        __m128i gx = _mm_sub_epi16(_mm_loadu_si128((const __m128i *) (sm + x + 1)),
+                                   _mm_loadu_si128((const __m128i *) (sm + x - 1)));
+        __m128i gy = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *) (dv + x - 1)),
+                                                 _mm_loadu_si128((const __m128i *) (dv + x + 1))),
+                                   _mm_slli_epi16(_mm_loadu_si128((const __m128i *) (dv + x)), 1));
+        __m128i m = _mm_add_epi16(_mm_max_epi16(gx, _mm_sub_epi16(zero, gx)),
+                                  _mm_max_epi16(gy, _mm_sub_epi16(zero, gy)));
+        // Sign extension to 32 bits
+        _mm_storeu_si128((__m128i *) (dx + x), _mm_srai_epi32(_mm_unpacklo_epi16(gx, gx), 16));
+        _mm_storeu_si128((__m128i *) (dx + x + 4), _mm_srai_epi32(_mm_unpackhi_epi16(gx, gx), 16));
+        _mm_storeu_si128((__m128i *) (dy + x), _mm_srai_epi32(_mm_unpacklo_epi16(gy, gy), 16));
+        _mm_storeu_si128((__m128i *) (dy + x + 4), _mm_srai_epi32(_mm_unpackhi_epi16(gy, gy), 16));
+        _mm_storeu_si128((__m128i *) (mag + x), _mm_unpacklo_epi16(m, zero));
+        _mm_storeu_si128((__m128i *) (mag + x + 4), _mm_unpackhi_epi16(m, zero));
+      }
+#endif
+      for (; x < m_w; x++) {
+        dx[x] = sm[x+1] - sm[x-1];
+        dy[x] = dv[x-1] + 2*dv[x] + dv[x+1];
+        mag[x] = std::abs(dx[x]) + std::abs(dy[x]);
+      }
+    }
+
+    // Keep the local maxima of the gradient magnitude along the gradient direction
+    void suppressNonMaxima(vpImage<unsigned char> &E, int y, int low, int high, std::vector<unsigned int> &stack)
+    {
+      // tan(22.5 deg)
+      const double tg22 = 0.4142135623730950488;
+      const int *dx = m_dx.row(y);
+      const int *dy = m_dy.row(y);
+      const int *prev = m_mag.row(y-1);
+      const int *cur = m_mag.row(y);
+      const int *next = m_mag.row(y+1);
+      unsigned char *e = E[(unsigned int) y];
+
+      for (int x = 0; x < m_w; x++) {
+        const int m = cur[x];
+        unsigned char edge = 0;
+        if (m > low) {
+          const int xs = dx[x], ys = dy[x];
+          const double ax = std::abs(xs), ay = std::abs(ys);
+          const double tg22x = ax * tg22;
+          bool maximum;
+          if (ay < tg22x) {
+            maximum = m > cur[x-1] && m >= cur[x+1];
+          }
+          else if (ay > tg22x + 2*ax) {
+            maximum = m > prev[x] && m >= next[x];
+          }
+          else {
+            const int s = (xs ^ ys) < 0 ? -1 : 1;
+            maximum = m > prev[x-s] && m > next[x+s];
+          }
+          if (maximum) {
+            if (m > high) {
+              edge = 255;
+              stack.push_back((unsigned int) y * (unsigned int) m_w + (unsigned int) x);
+            }
+            else {
+              edge = 1;
+            }
+          }
+        }
+        e[x] = edge;
+      }
+    }
+
+    const vpImage<unsigned char> &m_I;
+    int m_w, m_h;
+    const std::vector<int> &m_gaussian;
+    const std::vector<int> &m_smooth;
+    const std::vector<int> &m_derivative;
+    int m_r, m_s;
+    std::vector<int> m_src;
+    std::vector<int> m_acc;
+    vpRowRing<int> m_horizontal;
+    vpRowRing<short> m_blurred;
+    vpRowRing<int> m_dx, m_dy, m_mag;
+    std::vector<int> m_sm, m_dv;
+    std::vector<short> m_smS, m_dvS;
+    int m_lastHorizontal, m_lastBlurred;
+  };
+
+  /* Propagate the strong edges of the stack to the connected weak edges of the
+     rows [y0, y1). */
+  void propagateEdges(vpImage<unsigned char> &E, std::vector<unsigned int> &stack, unsigned int y0, unsigned int y1)
+  {
+    const unsigned int w = E.getWidth();
+    unsigned char *bitmap = E.bitmap;
+    while (! stack.empty()) {
+      const unsigned int index = stack.back();
+      stack.pop_back();
+      const unsigned int y = index / w, x = index - y*w;
+      const unsigned int ymin = y > y0 ? y-1 : y0, ymax = y+1 < y1 ? y+1 : y1-1;
+      const unsigned int xmin = x > 0 ? x-1 : 0, xmax = x+1 < w ? x+1 : w-1;
+      for (unsigned int v = ymin; v <= ymax; v++) {
+        for (unsigned int u = xmin; u <= xmax; u++) {
+          unsigned char &e = bitmap[v*w + u];
+          if (e == 1) {
+            e = 255;
+            stack.push_back(v*w + u);
+          }
+        }
+      }
+    }
+  }
+
+  // Binomial smoothing and derivative kernels of the Sobel operator
+  void getSobelKernels(unsigned int apertureSobel, std::vector<int> &smooth, std::vector<int> &derivative)
+  {
+    smooth.assign(apertureSobel, 0);
+    smooth[0] = 1;
+    for (unsigned int n = 1; n < apertureSobel; n++)
+      for (unsigned int i = n; i > 0; i--)
+        smooth[i] += smooth[i-1];
+
+    // Derivative: binomial of size aperture-1 convolved with [-1 1]
+    std::vector<int> binomial(apertureSobel - 1, 0);
+    binomial[0] = 1;
+    for (unsigned int n = 1; n + 1 < apertureSobel; n++)
+      for (unsigned int i = n; i > 0; i--)
+        binomial[i] += binomial[i-1];
+    derivative.assign(apertureSobel, 0);
+    for (unsigned int i = 0; i + 1 < apertureSobel; i++) {
+      derivative[i] -= binomial[i];
+      derivative[i+1] += binomial[i];
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Apply a filter to an image.
 
@@ -129,7 +477,6 @@ vpImageFilter::filter(const vpImage<double> &I,
 
 }
 
-#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
 /*!
   Apply the Canny edge operator on the image \e Isrc and return the resulting
   image \e Ires.
@@ -137,13 +484,11 @@ vpImageFilter::filter(const vpImage<double> &I,
   The following example shows how to use the method:
 
   \code
-#include <visp3/core/vpConfig.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpImageFilter.h>
 
 int main()
 {
-#if VISP_HAVE_OPENCV_VERSION >= 0x020100 // Canny uses OpenCV >=2.1.0
   // Constants for the Canny operator.
   const unsigned int gaussianFilterSize = 5;
   const double thresholdCanny = 15;
@@ -157,7 +502,6 @@ int main()
 
   //Apply the Canny edge operator and set the Icanny image.
   vpImageFilter::canny(Isrc, Icanny, gaussianFilterSize, thresholdCanny, apertureSobel);
-#endif
   return (0);
 }
   \endcode
@@ -169,6 +513,8 @@ int main()
   \param thresholdCanny : The threshold for the Canny operator. Only value
   greater than this value are marked as an edge).
   \param apertureSobel : Size of the mask for the Sobel operator (odd number).
+
+  \sa canny(const vpImage<unsigned char>&, vpImage<unsigned char>&, const unsigned int, const double, const double, const unsigned int)
 */
 void
 vpImageFilter:: canny(const vpImage<unsigned char>& Isrc,
@@ -177,27 +523,121 @@ vpImageFilter:: canny(const vpImage<unsigned char>& Isrc,
                       const double thresholdCanny,
                       const unsigned int apertureSobel)
 {
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  IplImage* img_ipl = NULL;
-  vpImageConvert::convert(Isrc, img_ipl);
-  IplImage* edges_ipl;
-  edges_ipl = cvCreateImage(cvSize(img_ipl->width, img_ipl->height), img_ipl->depth, img_ipl->nChannels);
-
-  cvSmooth(img_ipl, img_ipl, CV_GAUSSIAN, (int)gaussianFilterSize, (int)gaussianFilterSize, 0, 0);
-  cvCanny(img_ipl, edges_ipl, thresholdCanny, thresholdCanny, (int)apertureSobel);
-
-  vpImageConvert::convert(edges_ipl, Ires);
-  cvReleaseImage(&img_ipl);
-  cvReleaseImage(&edges_ipl);
-#else
-  cv::Mat img_cvmat, edges_cvmat;
-  vpImageConvert::convert(Isrc, img_cvmat);
-  cv::GaussianBlur(img_cvmat, img_cvmat, cv::Size((int)gaussianFilterSize, (int)gaussianFilterSize), 0, 0);
-  cv::Canny(img_cvmat, edges_cvmat, thresholdCanny, thresholdCanny, (int)apertureSobel);
-  vpImageConvert::convert(edges_cvmat, Ires);
-#endif
+  canny(Isrc, Ires, gaussianFilterSize, thresholdCanny, thresholdCanny, apertureSobel);
 }
+
+/*!
+  Apply the Canny edge operator with hysteresis thresholding on the image \e
+  Isrc and return the resulting image \e Ires.
+
+  The image is first smoothed by a Gaussian filter whose standard deviation is
+  deduced from its size as in OpenCV. The gradient is then computed with a
+  Sobel operator and its magnitude is the sum of the absolute values of its
+  components. Pixels that are a local maximum of the magnitude along the
+  gradient direction are edges if their magnitude is greater than \e
+  upperThresholdCanny, or if it is greater than \e lowerThresholdCanny and
+  they are connected to an edge.
+
+  The image is processed by horizontal bands in parallel when ViSP is built
+  with OpenMP support, and the 3x3 Sobel operator uses SSE2 when available.
+  \e Ires is only reallocated if its size differs from the size of \e Isrc.
+
+  \param Isrc : Image to apply the Canny edge detector to.
+  \param Ires : Filtered image (255 means an edge, 0 otherwise). It can be
+  the same image as \e Isrc.
+  \param gaussianFilterSize : The size of the mask of the Gaussian filter to
+  apply (an odd number, 1 to disable the smoothing).
+  \param lowerThresholdCanny : Lower threshold of the hysteresis.
+  \param upperThresholdCanny : Upper threshold of the hysteresis.
+  \param apertureSobel : Size of the mask for the Sobel operator (odd number
+  greater than 1).
+*/
+void
+vpImageFilter::canny(const vpImage<unsigned char>& Isrc,
+                     vpImage<unsigned char>& Ires,
+                     const unsigned int gaussianFilterSize,
+                     const double lowerThresholdCanny,
+                     const double upperThresholdCanny,
+                     const unsigned int apertureSobel)
+{
+  if (gaussianFilterSize % 2 != 1)
+    throw (vpImageException(vpImageException::incorrectInitializationError,
+                            "Bad Gaussian filter size"));
+  if (apertureSobel % 2 != 1 || apertureSobel < 3)
+    throw (vpImageException(vpImageException::incorrectInitializationError,
+                            "Bad Sobel aperture size"));
+
+  if (Isrc.bitmap == Ires.bitmap && Isrc.bitmap != NULL) {
+    // The source rows are still needed after the edges of the rows above have been written
+    vpImage<unsigned char> I = Isrc;
+    canny(I, Ires, gaussianFilterSize, lowerThresholdCanny, upperThresholdCanny, apertureSobel);
+    return;
+  }
+
+  const unsigned int height = Isrc.getHeight(), width = Isrc.getWidth();
+  Ires.resize(height, width);
+  if (height == 0 || width == 0)
+    return;
+
+  // Gaussian kernel in Q8, with the standard deviation used by OpenCV
+  std::vector<double> half((gaussianFilterSize + 1) / 2);
+  getGaussianKernel(&half[0], gaussianFilterSize, 0.3*((gaussianFilterSize - 1)*0.5 - 1) + 0.8, true);
+  const int middle = (int) gaussianFilterSize / 2;
+  std::vector<int> gaussian(gaussianFilterSize);
+  int sum = 0;
+  for (int i = 1; i <= middle; i++) {
+    gaussian[(size_t) (middle - i)] = gaussian[(size_t) (middle + i)] = vpMath::round(half[(size_t) i] * 256);
+    sum += 2 * gaussian[(size_t) (middle + i)];
+  }
+  gaussian[(size_t) middle] = 256 - sum;
+
+  std::vector<int> smooth, derivative;
+  getSobelKernels(apertureSobel, smooth, derivative);
+
+  const int low = (int) floor(lowerThresholdCanny);
+  const int high = (std::max)(low, (int) floor(upperThresholdCanny));
+
+  // Bands of at least 32 rows
+  unsigned int nbBands = 1;
+#ifdef VISP_HAVE_OPENMP
+  nbBands = (std::max)(1u, (std::min)((unsigned int) omp_get_max_threads(), height / 32));
+#endif
+  std::vector<std::vector<unsigned int> > stacks(nbBands);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(static, 1)
 #endif
+  for (int band = 0; band < (int) nbBands; band++) {
+    const unsigned int y0 = (unsigned int) band * height / nbBands;
+    const unsigned int y1 = (unsigned int) (band + 1) * height / nbBands;
+    vpCannyBand detector(Isrc, gaussian, smooth, derivative);
+    detector.detect(Ires, (int) y0, (int) y1, low, high, stacks[(size_t) band]);
+    propagateEdges(Ires, stacks[(size_t) band], y0, y1);
+  }
+
+  // Propagate the edges across the band borders
+  if (nbBands > 1) {
+    std::vector<unsigned int> &stack = stacks[0];
+    for (unsigned int band = 1; band < nbBands; band++) {
+      const unsigned int y0 = band * height / nbBands;
+      for (unsigned int y = y0 - 1; y <= y0; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+          if (Ires[y][x] == 255)
+            stack.push_back(y * width + x);
+        }
+      }
+    }
+    propagateEdges(Ires, stack, 0, height);
+  }
+
+  // Remove the weak edges that are not connected to a strong edge
+  unsigned char *bitmap = Ires.bitmap;
+  const unsigned int size = height * width;
+  for (unsigned int i = 0; i < size; i++) {
+    if (bitmap[i] == 1)
+      bitmap[i] = 0;
+  }
+}
 
 /*!
   Apply a separable filter.
@@ -44,8 +44,227 @@
 
 #include <visp3/core/vpKalmanFilter.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Minimal number of signals to process them in parallel
+  const unsigned int kalmanParallelSignalCount = 64;
+
+  /* Prediction of one signal. The state block of size ns starts at index o in
+     the vectors and at (o, o) in the matrices. FP is a scratch of size ns*ns.
+     When NS is not null, it is the state size known at compile time. */
+  template <unsigned int NS>
+  inline void predictSignal(unsigned int ns_, unsigned int o, const vpMatrix &F, const vpMatrix &Q,
+                            const vpMatrix &Pest, const vpColVector &Xest, vpMatrix &Ppre, vpColVector &Xpre,
+                            double *FP)
+  {
+    const unsigned int ns = NS ? NS : ns_;
+
+    for (unsigned int r = 0; r < ns; r++) {
+      const double *f = F[o+r] + o;
+      double x = 0;
+      for (unsigned int k = 0; k < ns; k++)
+        x += f[k] * Xest[o+k];
+      Xpre[o+r] = x;
+
+      for (unsigned int c = 0; c < ns; c++) {
+        double v = 0;
+        for (unsigned int k = 0; k < ns; k++)
+          v += f[k] * Pest[o+k][o+c];
+        FP[r*ns+c] = v;
+      }
+    }
+
+    for (unsigned int r = 0; r < ns; r++) {
+      for (unsigned int c = 0; c < ns; c++) {
+        const double *f = F[o+c] + o;
+        double v = Q[o+r][o+c];
+        for (unsigned int k = 0; k < ns; k++)
+          v += FP[r*ns+k] * f[k];
+        Ppre[o+r][o+c] = v;
+      }
+    }
+  }
+
+  /* In place inversion of the n x n matrix A by Gauss-Jordan elimination with
+     partial pivoting. Ainv is a scratch of size n*n that receives the inverse.
+     Return false if A is singular. */
+  inline bool invertSmallMatrix(double *A, double *Ainv, unsigned int n)
+  {
+    if (n == 1) {
+      if (std::fabs(A[0]) <= std::numeric_limits<double>::min())
+        return false;
+      Ainv[0] = 1. / A[0];
+      return true;
+    }
+
+    double norm = 0;
+    for (unsigned int i = 0; i < n*n; i++) {
+      norm = (std::max)(norm, std::fabs(A[i]));
+      Ainv[i] = 0;
+    }
+    for (unsigned int i = 0; i < n; i++)
+      Ainv[i*n+i] = 1;
+
+    for (unsigned int c = 0; c < n; c++) {
+      unsigned int pivot = c;
+      for (unsigned int r = c+1; r < n; r++) {
+        if (std::fabs(A[r*n+c]) > std::fabs(A[pivot*n+c]))
+          pivot = r;
+      }
+      if (std::fabs(A[pivot*n+c]) <= std::numeric_limits<double>::epsilon() * norm)
+        return false;
+      if (pivot != c) {
+        for (unsigned int k = 0; k < n; k++) {
+          std::swap(A[pivot*n+k], A[c*n+k]);
+          std::swap(Ainv[pivot*n+k], Ainv[c*n+k]);
+        }
+      }
+
+      const double inv = 1. / A[c*n+c];
+      for (unsigned int k = 0; k < n; k++) {
+        A[c*n+k] *= inv;
+        Ainv[c*n+k] *= inv;
+      }
+      for (unsigned int r = 0; r < n; r++) {
+        const double a = A[r*n+c];
+        if (r == c || a == 0)
+          continue;
+        for (unsigned int k = 0; k < n; k++) {
+          A[r*n+k] -= a * A[c*n+k];
+          Ainv[r*n+k] -= a * Ainv[c*n+k];
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /* Size of the scratch used by filterSignal(). */
+  inline unsigned int filterSignalScratchSize(unsigned int ns, unsigned int nm)
+  {
+    return ns*nm + 2*nm*nm + nm;
+  }
+
+  /* Filtering of one signal. The state block of size ns starts at index os and
+     the measure block of size nm at index om. Return false if the innovation
+     covariance is singular. */
+  template <unsigned int NS, unsigned int NM>
+  inline bool filterSignal(unsigned int ns_, unsigned int nm_, unsigned int os, unsigned int om,
+                           const vpMatrix &H, const vpMatrix &R, const vpMatrix &Ppre, const vpColVector &Xpre,
+                           const vpColVector &z, vpMatrix &W, vpMatrix &Pest, vpColVector &Xest, double *scratch)
+  {
+    const unsigned int ns = NS ? NS : ns_;
+    const unsigned int nm = NM ? NM : nm_;
+    double *PHt = scratch;         // ns x nm
+    double *S = PHt + ns*nm;       // nm x nm
+    double *Sinv = S + nm*nm;      // nm x nm
+    double *innovation = Sinv + nm*nm;
+
+    // PHt = Ppre H^T
+    for (unsigned int r = 0; r < ns; r++) {
+      const double *p = Ppre[os+r] + os;
+      for (unsigned int c = 0; c < nm; c++) {
+        const double *h = H[om+c] + os;
+        double v = 0;
+        for (unsigned int k = 0; k < ns; k++)
+          v += p[k] * h[k];
+        PHt[r*nm+c] = v;
+      }
+    }
+
+    // S = H Ppre H^T + R and innovation = z - H Xpre
+    for (unsigned int r = 0; r < nm; r++) {
+      const double *h = H[om+r] + os;
+      for (unsigned int c = 0; c < nm; c++) {
+        double v = R[om+r][om+c];
+        for (unsigned int k = 0; k < ns; k++)
+          v += h[k] * PHt[k*nm+c];
+        S[r*nm+c] = v;
+      }
+      double v = z[om+r];
+      for (unsigned int k = 0; k < ns; k++)
+        v -= h[k] * Xpre[os+k];
+      innovation[r] = v;
+    }
+
+    if (! invertSmallMatrix(S, Sinv, nm))
+      return false;
+
+    // W = Ppre H^T S^-1, Xest = Xpre + W innovation
+    for (unsigned int r = 0; r < ns; r++) {
+      double x = Xpre[os+r];
+      for (unsigned int c = 0; c < nm; c++) {
+        double v = 0;
+        for (unsigned int k = 0; k < nm; k++)
+          v += PHt[r*nm+k] * Sinv[k*nm+c];
+        W[os+r][om+c] = v;
+        x += v * innovation[c];
+      }
+      Xest[os+r] = x;
+    }
+
+    // Pest = Ppre - W S W^T, where W S = Ppre H^T
+    for (unsigned int r = 0; r < ns; r++) {
+      for (unsigned int c = 0; c < ns; c++) {
+        const double *w = W[os+c] + om;
+        double v = Ppre[os+r][os+c];
+        for (unsigned int k = 0; k < nm; k++)
+          v -= PHt[r*nm+k] * w[k];
+        Pest[os+r][os+c] = v;
+      }
+    }
+
+    return true;
+  }
+
+  template <unsigned int NS>
+  void predictSignals(unsigned int ns, unsigned int nsignal, const vpMatrix &F, const vpMatrix &Q,
+                      const vpMatrix &Pest, const vpColVector &Xest, vpMatrix &Ppre, vpColVector &Xpre)
+  {
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (nsignal >= kalmanParallelSignalCount)
+#endif
+    {
+      std::vector<double> scratch(ns*ns);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+      for (int i = 0; i < (int) nsignal; i++) {
+        predictSignal<NS>(ns, (unsigned int) i*ns, F, Q, Pest, Xest, Ppre, Xpre, &scratch[0]);
+      }
+    }
+  }
+
+  template <unsigned int NS, unsigned int NM>
+  bool filterSignals(unsigned int ns, unsigned int nm, unsigned int nsignal, const vpMatrix &H, const vpMatrix &R,
+                     const vpMatrix &Ppre, const vpColVector &Xpre, const vpColVector &z,
+                     vpMatrix &W, vpMatrix &Pest, vpColVector &Xest)
+  {
+    bool success = true;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (nsignal >= kalmanParallelSignalCount)
+#endif
+    {
+      std::vector<double> scratch(filterSignalScratchSize(ns, nm));
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for reduction(&&:success)
+#endif
+      for (int i = 0; i < (int) nsignal; i++) {
+        success = filterSignal<NS, NM>(ns, nm, (unsigned int) i*ns, (unsigned int) i*nm, H, R, Ppre, Xpre, z,
+                                       W, Pest, Xest, &scratch[0]) && success;
+      }
+    }
+    return success;
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
   Initialize the Kalman filter.
@@ -88,7 +307,7 @@ vpKalmanFilter::init(unsigned int size_state_vector, unsigned int size_measure_v
   
 */
 vpKalmanFilter::vpKalmanFilter()
-  : iter(0), size_state(0), size_measure(0), nsignal(0), verbose_mode(false),
+  : iter(0), size_state(0), size_measure(0), nsignal(0), verbose_mode(false), block_diagonal(false),
     Xest(), Xpre(), F(), H(), R(), Q(), dt(-1), Ppre(), Pest(), W(), I()
 {
 }
@@ -101,7 +320,7 @@ vpKalmanFilter::vpKalmanFilter()
   \param n_signal : Number of signal to filter.
 */
 vpKalmanFilter::vpKalmanFilter(unsigned int n_signal)
-  : iter(0), size_state(0), size_measure(0), nsignal(n_signal), verbose_mode(false),
+  : iter(0), size_state(0), size_measure(0), nsignal(n_signal), verbose_mode(false), block_diagonal(false),
     Xest(), Xpre(), F(), H(), R(), Q(), dt(-1), Ppre(), Pest(), W(), I()
 {
 }
@@ -119,7 +338,7 @@ vpKalmanFilter::vpKalmanFilter(unsigned int n_signal)
   \param n_signal : Number of signal to filter.
 */
 vpKalmanFilter::vpKalmanFilter(unsigned int size_state_vector, unsigned int size_measure_vector, unsigned int n_signal)
-  : iter(0), size_state(0), size_measure(0), nsignal(0), verbose_mode(false),
+  : iter(0), size_state(0), size_measure(0), nsignal(0), verbose_mode(false), block_diagonal(false),
     Xest(), Xpre(), F(), H(), R(), Q(), dt(-1), Ppre(), Pest(), W(), I()
 {
   init( size_state_vector, size_measure_vector, n_signal) ;
@@ -162,6 +381,29 @@ vpKalmanFilter::prediction()
     std::cout << "Xest = "<< std::endl  << Xest << std::endl  ;  
   }
   // Prediction
+  if (block_diagonal) {
+    const unsigned int n = size_state*nsignal;
+    if (Xpre.getRows() != n)
+      Xpre.resize(n);
+    // The blocks outside of the diagonal remain null
+    if (Ppre.getRows() != n || Ppre.getCols() != n)
+      Ppre.resize(n, n);
+
+    // Bar-Shalom  5.2.3.2 and 5.2.3.5 for each signal
+    if (size_state == 2)
+      predictSignals<2>(size_state, nsignal, F, Q, Pest, Xest, Ppre, Xpre);
+    else if (size_state == 3)
+      predictSignals<3>(size_state, nsignal, F, Q, Pest, Xest, Ppre, Xpre);
+    else
+      predictSignals<0>(size_state, nsignal, F, Q, Pest, Xest, Ppre, Xpre);
+
+    if (verbose_mode) {
+      std::cout << "Xpre = "<< std::endl  << Xpre << std::endl  ;
+      std::cout << "Ppre " << std::endl << Ppre << std::endl ;
+    }
+    return;
+  }
+
   // Bar-Shalom  5.2.3.2
   Xpre = F*Xest  ;
   if (verbose_mode) {
@@ -213,6 +455,45 @@ vpKalmanFilter::filtering(const vpColVector &z)
 {
   if (verbose_mode)
     std::cout << "z " << std::endl << z << std::endl ;
+
+  if (block_diagonal) {
+    const unsigned int n = size_state*nsignal;
+    if (z.getRows() != size_measure*nsignal) {
+      throw(vpException(vpException::dimensionError,
+                        "Bad measure vector size (%d) for %d signals with a measure size of %d",
+                        z.getRows(), nsignal, size_measure)) ;
+    }
+    if (Xest.getRows() != n)
+      Xest.resize(n);
+    // The blocks outside of the diagonal remain null
+    if (Pest.getRows() != n || Pest.getCols() != n)
+      Pest.resize(n, n);
+    if (W.getRows() != n || W.getCols() != size_measure*nsignal)
+      W.resize(n, size_measure*nsignal);
+
+    // Bar-Shalom  5.2.3.11 to 5.2.3.15 for each signal
+    bool success;
+    if (size_state == 2 && size_measure == 1)
+      success = filterSignals<2, 1>(size_state, size_measure, nsignal, H, R, Ppre, Xpre, z, W, Pest, Xest);
+    else if (size_state == 3 && size_measure == 1)
+      success = filterSignals<3, 1>(size_state, size_measure, nsignal, H, R, Ppre, Xpre, z, W, Pest, Xest);
+    else
+      success = filterSignals<0, 0>(size_state, size_measure, nsignal, H, R, Ppre, Xpre, z, W, Pest, Xest);
+    if (! success) {
+      throw(vpException(vpException::fatalError,
+                        "Cannot invert the innovation covariance matrix of a signal")) ;
+    }
+
+    if (verbose_mode) {
+      std::cout << "W " << std::endl << W << std::endl ;
+      std::cout << "Pest " << std::endl << Pest << std::endl ;
+      std::cout << "Xest " << std::endl << Xest << std::endl ;
+    }
+
+    iter++ ;
+    return;
+  }
+
   // Bar-Shalom  5.2.3.11
   vpMatrix S =  H*Ppre*H.t() + R ;
   if (verbose_mode)
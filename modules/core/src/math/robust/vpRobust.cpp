@@ -51,13 +51,175 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm> // std::nth_element
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
 #define vpITMAX 100
 #define vpEPS 3.0e-7
 #define vpCST 1
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  /*
+    Return the k-th smallest value of a[0..n-1]. The values are reordered.
+  */
+  double selectKth(double *a, const unsigned int n, const unsigned int k)
+  {
+    if (k >= n)
+      return 0;
+
+    std::nth_element(a, a + k, a + n);
+    return a[k];
+  }
+
+  /*
+    Compute the absolute deviations normres[i] = |r[i] - med| of the residues
+    r[0..n-1] to their median med, and return the median absolute deviation
+    scaled to be consistent with the standard deviation of a normal
+    distribution. sorted_r and sorted_normres are work buffers of n values.
+  */
+  double computeMADScale(const double *r, const unsigned int n, double *normres, double *sorted_r, double *sorted_normres)
+  {
+    unsigned int ind_med = (unsigned int)(ceil(n/2.0))-1;
+
+    memcpy(sorted_r, r, n*sizeof(double));
+    double med = selectKth(sorted_r, n, ind_med);
+
+    for (unsigned int i = 0; i < n; i++) {
+      normres[i] = fabs(r[i] - med);
+      sorted_normres[i] = fabs(sorted_r[i] - med);
+    }
+
+    // 1.48 keeps scale estimate consistent for a normal probability dist.
+    return 1.4826*selectKth(sorted_normres, n, ind_med);
+  }
+
+  /*
+    Tukey weights of the normalized residues x[0..n-1]. Points with a null
+    weight are outliers rejected previously and keep a null weight.
+  */
+  void computeTukeyWeights(const double sig, const double *x, double *w, const unsigned int n)
+  {
+    const double eps = std::numeric_limits<double>::epsilon();
+    const double cst_const = vpCST*4.6851;
+    unsigned int i = 0;
+
+    if (std::fabs(sig) <= eps) {
+      for (; i < n; i++)
+        w[i] = (std::fabs(w[i]) > eps) ? 1 : 0;
+      return;
+    }
+
+#if VISP_HAVE_SSE2
+    const __m128d v_sign = _mm_set1_pd(-0.0);
+    const __m128d v_sig = _mm_set1_pd(sig);
+    const __m128d v_c = _mm_set1_pd(cst_const);
+    const __m128d v_one = _mm_set1_pd(1.0);
+    const __m128d v_eps = _mm_set1_pd(eps);
+    for (; i + 1 < n; i += 2) {
+      __m128d v_xi = _mm_div_pd(_mm_loadu_pd(x + i), v_sig);
+      __m128d v_w = _mm_loadu_pd(w + i);
+      __m128d v_inlier = _mm_and_pd(_mm_cmple_pd(_mm_andnot_pd(v_sign, v_xi), v_c),
+                                    _mm_cmpgt_pd(_mm_andnot_pd(v_sign, v_w), v_eps));
+      __m128d v_t = _mm_div_pd(v_xi, v_c);
+      __m128d v_u = _mm_sub_pd(v_one, _mm_mul_pd(v_t, v_t));
+      _mm_storeu_pd(w + i, _mm_and_pd(v_inlier, _mm_mul_pd(v_u, v_u)));
+    }
+#endif
+
+    for (; i < n; i++) {
+      double xi_sig = x[i]/sig;
+
+      if ((std::fabs(xi_sig) <= cst_const) && std::fabs(w[i]) > eps)
+        w[i] = vpMath::sqr(1-vpMath::sqr(xi_sig/cst_const));
+      else
+        w[i] = 0; // Outlier
+    }
+  }
+
+  /*
+    Huber weights of the normalized residues x[0..n-1]. Points with a null
+    weight keep a null weight.
+  */
+  void computeHuberWeights(const double sig, const double *x, double *w, const unsigned int n)
+  {
+    const double eps = std::numeric_limits<double>::epsilon();
+    const double c = 1.2107; //1.345;
+    unsigned int i = 0;
+
+#if VISP_HAVE_SSE2
+    const __m128d v_sign = _mm_set1_pd(-0.0);
+    const __m128d v_sig = _mm_set1_pd(sig);
+    const __m128d v_c = _mm_set1_pd(c);
+    const __m128d v_one = _mm_set1_pd(1.0);
+    const __m128d v_eps = _mm_set1_pd(eps);
+    for (; i + 1 < n; i += 2) {
+      __m128d v_abs = _mm_andnot_pd(v_sign, _mm_div_pd(_mm_loadu_pd(x + i), v_sig));
+      __m128d v_w = _mm_loadu_pd(w + i);
+      __m128d v_inside = _mm_cmple_pd(v_abs, v_c);
+      __m128d v_huber = _mm_or_pd(_mm_and_pd(v_inside, v_one), _mm_andnot_pd(v_inside, _mm_div_pd(v_c, v_abs)));
+      __m128d v_kept = _mm_cmpgt_pd(_mm_andnot_pd(v_sign, v_w), v_eps);
+      _mm_storeu_pd(w + i, _mm_or_pd(_mm_and_pd(v_kept, v_huber), _mm_andnot_pd(v_kept, v_w)));
+    }
+#endif
+
+    for (; i < n; i++) {
+      if (std::fabs(w[i]) > eps) {
+        double xi_sig = x[i]/sig;
+        if (fabs(xi_sig) <= c)
+          w[i] = 1;
+        else
+          w[i] = c/fabs(xi_sig);
+      }
+    }
+  }
+
+  /*
+    Cauchy weights of the normalized residues x[0..n-1].
+  */
+  void computeCauchyWeights(const double sig, const double *x, double *w, const unsigned int n)
+  {
+    const double const_sig = 2.3849*sig;
+    unsigned int i = 0;
+
+#if VISP_HAVE_SSE2
+    const __m128d v_const_sig = _mm_set1_pd(const_sig);
+    const __m128d v_one = _mm_set1_pd(1.0);
+    for (; i + 1 < n; i += 2) {
+      __m128d v_t = _mm_div_pd(_mm_loadu_pd(x + i), v_const_sig);
+      _mm_storeu_pd(w + i, _mm_div_pd(v_one, _mm_add_pd(v_one, _mm_mul_pd(v_t, v_t))));
+    }
+#endif
+
+    for (; i < n; i++)
+      w[i] = 1/(1+vpMath::sqr(x[i]/const_sig));
+  }
+
+  void computeWeights(const vpRobust::vpRobustEstimatorType method, const double sig, const double *x, double *w,
+                      const unsigned int n)
+  {
+    switch (method) {
+    case vpRobust::TUKEY:
+      computeTukeyWeights(sig, x, w, n);
+      break;
+    case vpRobust::CAUCHY:
+      computeCauchyWeights(sig, x, w, n);
+      break;
+    case vpRobust::HUBER:
+      computeHuberWeights(sig, x, w, n);
+      break;
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 
 // ===================================================================
 /*!
@@ -184,35 +346,15 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
 		     vpColVector &weights)
 {
 
-  double med=0;	// median
-  double normmedian=0; 	// Normalized median
-  double sigma=0;// Standard Deviation
-
   // resize vector only if the size of residue vector has changed
   unsigned int n_data = residues.getRows();
   resize(n_data); 
-  
-  sorted_residues = residues;
-  
-  unsigned int ind_med = (unsigned int)(ceil(n_data/2.0))-1;
-
-  // Calculate median
-  med = select(sorted_residues, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
-   //residualMedian = med ;
-
-  // Normalize residues
-  for(unsigned int i=0; i<n_data; i++)
-  {
-    normres[i] = (fabs(residues[i]- med));
-    sorted_normres[i] = (fabs(sorted_residues[i]- med));
 
-  }
+  if (n_data == 0)
+    return;
 
-  // Calculate MAD
-  normmedian = select(sorted_normres, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
-  //normalizedResidualMedian = normmedian ;
-  // 1.48 keeps scale estimate consistent for a normal probability dist.
-  sigma = 1.4826*normmedian; // median Absolute Deviation
+  // Median Absolute Deviation
+  double sigma = computeMADScale(residues.data, n_data, normres.data, sorted_residues.data, sorted_normres.data);
 
   // Set a minimum threshold for sigma
   // (when sigma reaches the level of noise in the image)
@@ -221,35 +363,63 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
     sigma= NoiseThreshold;
   }
 
-  switch (method)
-  {
-  case TUKEY :
-    {
-      psiTukey(sigma, normres,weights);
+  computeWeights(method, sigma, normres.data, weights.data, n_data);
+}
 
-      vpCDEBUG(2) << "Tukey's function computed" << std::endl;
-      break ;
+/*!
+  Compute the weights of several groups of residues stacked in the same
+  vector, each group having its own scale estimate. This is equivalent to
+  calling MEstimator() on each group with a different vpRobust instance
+  sharing the same noise threshold, but without any copy of the residues
+  or the weights.
+
+  This is useful when the residues come from features of different kinds,
+  for instance moving edges and KLT points, that should not share the same
+  scale.
+
+  \param method : Type of M-Estimator.
+  \param residues : Residues of all the groups, the first group first.
+  \param groupSizes : Number of residues of each group.
+  \param weights : Weights of all the groups. As in MEstimator(), null weights
+  of rejected points are kept null with the Tukey and Huber estimators.
+
+  \exception vpException::dimensionError : If the size of the weights, or the
+  sum of the group sizes, differs from the number of residues.
+*/
+void vpRobust::MEstimator(const vpRobustEstimatorType method, const vpColVector &residues,
+                          const std::vector<unsigned int> &groupSizes, vpColVector &weights)
+{
+  unsigned int n_data = residues.getRows();
+  if (weights.getRows() != n_data) {
+    throw(vpException(vpException::dimensionError, "Cannot compute %d weights from %d residues",
+                      weights.getRows(), n_data));
+  }
 
-    }
-  case CAUCHY :
-    {
-      psiCauchy(sigma, normres,weights);
-      break ;
-    }
-    /*  case MCLURE :
-    {
-      psiMcLure(sigma, normres);
-      break ;
-      }*/
-  case HUBER :
-    {
-      psiHuber(sigma, normres,weights);
-      break ;
-    }
+  unsigned int n_sum = 0;
+  for (size_t g = 0; g < groupSizes.size(); g++)
+    n_sum += groupSizes[g];
+  if (n_sum != n_data) {
+    throw(vpException(vpException::dimensionError, "The %d residues do not match the groups of %d residues",
+                      n_data, n_sum));
   }
-}
 
+  resize(n_data);
+
+  unsigned int offset = 0;
+  for (size_t g = 0; g < groupSizes.size(); g++) {
+    unsigned int n = groupSizes[g];
+    if (n == 0)
+      continue;
+
+    double sigma = computeMADScale(residues.data + offset, n, normres.data + offset,
+                                   sorted_residues.data, sorted_normres.data);
+    if (sigma < NoiseThreshold)
+      sigma = NoiseThreshold;
 
+    computeWeights(method, sigma, normres.data + offset, weights.data + offset, n);
+    offset += n;
+  }
+}
 
 void vpRobust::MEstimator(const vpRobustEstimatorType method,
 		     const vpColVector &residues,
@@ -325,40 +495,27 @@ double vpRobust::computeNormalizedMedian(vpColVector &all_normres,
   
   // resize vector only if the size of residue vector has changed
   resize(n_data);
-    
-  sorted_residues = residues;
-  vpColVector no_null_weight_residues;
-  no_null_weight_residues.resize(n_data);
-  
-  //all_normres.resize(n_all_data); // Normalized Residue
-  //vpColVector sorted_normres(n_data); // Normalized Residue
-  //vpColVector sorted_residues = residues;
-  //vpColVector sorted_residues;
-  
 
+  // Be careful to not use the rejected residues for the
+  // calculation.
   unsigned int index =0;
   for(unsigned int j=0;j<n_data;j++)
   {
     //if(weights[j]!=0)
     if(std::fabs(weights[j]) > std::numeric_limits<double>::epsilon())
     {
-      no_null_weight_residues[index]=residues[j];
+      sorted_residues[index]=residues[j];
       index++;
     }
   }
-  sorted_residues.resize(index);
-  memcpy(sorted_residues.data,no_null_weight_residues.data,index*sizeof(double));
   n_data=index;
 
   vpCDEBUG(2) << "vpRobust MEstimator reached. No. data = " << n_data
 	      << std::endl;
 
   // Calculate Median
-  // Be careful to not use the rejected residues for the
-  // calculation.
-  
   unsigned int ind_med = (unsigned int)(ceil(n_data/2.0))-1;
-  med = select(sorted_residues, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  med = selectKth(sorted_residues.data, n_data, ind_med);
 
   unsigned int i;
   // Normalize residues
@@ -371,11 +528,8 @@ double vpRobust::computeNormalizedMedian(vpColVector &all_normres,
   {
     sorted_normres[i] = (fabs(sorted_residues[i]- med));
   }
-  // MAD calculated only on first iteration
 
-  //normmedian = Median(normres, weights);
-  //normmedian = Median(normres);
-  normmedian = select(sorted_normres, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  normmedian = selectKth(sorted_normres.data, n_data, ind_med);
 
   return normmedian;
 }
@@ -405,7 +559,7 @@ vpRobust::simultMEstimator(vpColVector &residues)
 
   // Calculate Median
   unsigned int ind_med = (unsigned int)(ceil(n_data/2.0))-1;
-  med = select(residues, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  med = selectKth(residues.data, n_data, ind_med);
 
   // Normalize residues
   for(unsigned int i=0; i<n_data; i++)
@@ -416,7 +570,7 @@ vpRobust::simultMEstimator(vpColVector &residues)
   // For Others use MAD calculated on first iteration
   if(it==0)
   {
-    double normmedian = select(norm_res, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/); // Normalized Median
+    double normmedian = selectKth(norm_res.data, n_data, ind_med); // Normalized Median
     // 1.48 keeps scale estimate consistent for a normal probability dist.
     sigma = 1.4826*normmedian; // Median Absolute Deviation
   }
@@ -672,33 +826,7 @@ vpRobust::simult_chi_huber(double x)
 
 void vpRobust::psiTukey(double sig, vpColVector &x, vpColVector & weights)
 {
-
-  unsigned int n_data = x.getRows();
-  double cst_const = vpCST*4.6851;
-
-  for(unsigned int i=0; i<n_data; i++)
-  {
-    //if(sig==0 && weights[i]!=0)
-    if(std::fabs(sig) <= std::numeric_limits<double>::epsilon() && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
-    {
-      weights[i]=1;
-      continue;
-    }
-
-    double xi_sig = x[i]/sig;
-
-    //if((fabs(xi_sig)<=(cst_const)) && weights[i]!=0)
-    if((std::fabs(xi_sig)<=(cst_const)) && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
-    {
-      weights[i] = vpMath::sqr(1-vpMath::sqr(xi_sig/cst_const));
-      //w[i] = vpMath::sqr(1-vpMath::sqr(x[i]/sig/4.7));
-    }
-    else
-    {
-      //Outlier - could resize list of points tracked here?
-      weights[i] = 0;
-    }
-  }
+  computeTukeyWeights(sig, x.data, weights.data, x.getRows());
 }
 
 /*!
@@ -710,21 +838,7 @@ void vpRobust::psiTukey(double sig, vpColVector &x, vpColVector & weights)
 */
 void vpRobust::psiHuber(double sig, vpColVector &x, vpColVector &weights)
 {
-  double c = 1.2107; //1.345;
-  unsigned int n_data = x.getRows();
-
-  for(unsigned int i=0; i<n_data; i++)
-  {
-    //if(weights[i]!=0)
-    if(std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
-    {
-      double xi_sig = x[i]/sig;
-      if(fabs(xi_sig)<=c)
-	weights[i] = 1;
-      else
-	weights[i] = c/fabs(xi_sig);
-    }
-  }
+  computeHuberWeights(sig, x.data, weights.data, x.getRows());
 }
 
 /*!
@@ -737,27 +851,7 @@ void vpRobust::psiHuber(double sig, vpColVector &x, vpColVector &weights)
 
 void vpRobust::psiCauchy(double sig, vpColVector &x, vpColVector &weights)
 {
-  unsigned int n_data = x.getRows();
-  double const_sig = 2.3849*sig;
-
-  //Calculate Cauchy's equation
-  for(unsigned int i=0; i<n_data; i++)
-  {
-    weights[i] = 1/(1+vpMath::sqr(x[i]/(const_sig)));
-
-    // If one coordinate is an outlier the other is too!
-    // w[i] < 0.01 is a threshold to be set
-    /*if(w[i] < 0.01)
-      {
-      if(i%2 == 0)
-      {
-      w[i+1] = w[i];
-      i++;
-      }
-      else
-      w[i-1] = w[i];
-      }*/
-  }
+  computeCauchyWeights(sig, x.data, weights.data, x.getRows());
 }
 
 
@@ -819,22 +913,21 @@ vpRobust::partition(vpColVector &a, int l, int r)
 }
 
 /*!
-  \brief sort a part of a vector and select a value of this new vector
-  \param a : vector to be sorted
+  \brief Reorder a part of a vector and select a value of this new vector
+  \param a : vector to be reordered
   \param l : first value to be considered
   \param r : last value to be considered
-  \param k : value to be selected
+  \param k : index of the value to be selected, such that the values of
+  a[l..k-1] are lower or equal to a[k] and the values of a[k+1..r] are greater
+  or equal to a[k].
 */
 double 
 vpRobust::select(vpColVector &a, int l, int r, int k)
 {
-  while (r > l)
-  {
-    int i = partition(a, l, r);
-    if (i >= k) r = i-1;
-    if (i <= k) l = i+1;
-  }
-  return a[(unsigned int)k];
+  if (r < l || k < l || k > r)
+    return 0;
+
+  return selectKth(a.data + l, (unsigned int)(r-l+1), (unsigned int)(k-l)) ;
 }
 
 
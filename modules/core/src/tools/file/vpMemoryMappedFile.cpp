@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read-only memory mapping of a file.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpMemoryMappedFile.cpp
+  \brief Memory mapping of a file to access its content without reading it.
+*/
+
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VP_HAVE_MMAP
+#elif defined(_WIN32) && !defined(WINRT)
+#  include <windows.h>
+#  define VP_HAVE_MAP_VIEW_OF_FILE
+#endif
+
+/*!
+  Create an object without opened file.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile()
+  : m_data(NULL), m_size(0), m_opened(false), m_mapped(false), m_buffer()
+#if defined(_WIN32)
+  , m_fileHandle(NULL), m_mappingHandle(NULL)
+#endif
+{
+}
+
+/*!
+  Map a file in memory.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file cannot be opened or mapped.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile(const std::string &filename)
+  : m_data(NULL), m_size(0), m_opened(false), m_mapped(false), m_buffer()
+#if defined(_WIN32)
+  , m_fileHandle(NULL), m_mappingHandle(NULL)
+#endif
+{
+  open(filename);
+}
+
+/*!
+  Destructor that unmaps the file.
+*/
+vpMemoryMappedFile::~vpMemoryMappedFile()
+{
+  close();
+}
+
+/*!
+  Unmap the file. The pointers returned by getData() become invalid.
+*/
+void vpMemoryMappedFile::close()
+{
+#if defined(VP_HAVE_MMAP)
+  if (m_mapped && m_data != NULL)
+    munmap(m_data, m_size);
+#elif defined(VP_HAVE_MAP_VIEW_OF_FILE)
+  if (m_mapped && m_data != NULL)
+    UnmapViewOfFile(m_data);
+  if (m_mappingHandle != NULL)
+    CloseHandle((HANDLE)m_mappingHandle);
+  if (m_fileHandle != NULL)
+    CloseHandle((HANDLE)m_fileHandle);
+#endif
+#if defined(_WIN32)
+  m_fileHandle = NULL;
+  m_mappingHandle = NULL;
+#endif
+  std::vector<double>().swap(m_buffer);
+  m_data = NULL;
+  m_size = 0;
+  m_opened = false;
+  m_mapped = false;
+}
+
+/*!
+  Map a file in memory. A previously opened file is closed.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file cannot be opened or mapped.
+*/
+void vpMemoryMappedFile::open(const std::string &filename)
+{
+  close();
+
+#if defined(VP_HAVE_MMAP)
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw vpException(vpException::ioError, "Cannot open the file %s", filename.c_str());
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw vpException(vpException::ioError, "Cannot get the size of the file %s", filename.c_str());
+  }
+  m_size = (size_t)st.st_size;
+  if (m_size > 0) {
+    // Private writable mapping: modifications are copy-on-write and never reach the file
+    void *data = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      m_size = 0;
+      throw vpException(vpException::ioError, "Cannot map the file %s", filename.c_str());
+    }
+    m_data = static_cast<unsigned char *>(data);
+    m_mapped = true;
+  }
+  // The mapping stays valid after the descriptor is closed
+  ::close(fd);
+  m_opened = true;
+#elif defined(VP_HAVE_MAP_VIEW_OF_FILE)
+  HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, NULL);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    throw vpException(vpException::ioError, "Cannot open the file %s", filename.c_str());
+  }
+  m_fileHandle = fileHandle;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(fileHandle, &size)) {
+    close();
+    throw vpException(vpException::ioError, "Cannot get the size of the file %s", filename.c_str());
+  }
+  m_size = (size_t)size.QuadPart;
+  if (m_size > 0) {
+    m_mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void *data = m_mappingHandle != NULL ? MapViewOfFile((HANDLE)m_mappingHandle, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (data == NULL) {
+      close();
+      throw vpException(vpException::ioError, "Cannot map the file %s", filename.c_str());
+    }
+    m_data = static_cast<unsigned char *>(data);
+    m_mapped = true;
+  }
+  m_opened = true;
+#else
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot open the file %s", filename.c_str());
+  }
+  file.seekg(0, std::ios::end);
+  m_size = (size_t)file.tellg();
+  file.seekg(0, std::ios::beg);
+  if (m_size > 0) {
+    m_buffer.resize((m_size + sizeof(double) - 1) / sizeof(double));
+    m_data = reinterpret_cast<unsigned char *>(&m_buffer[0]);
+    file.read(reinterpret_cast<char *>(m_data), (std::streamsize)m_size);
+    if (!file) {
+      close();
+      throw vpException(vpException::ioError, "Cannot read the file %s", filename.c_str());
+    }
+  }
+  m_opened = true;
+#endif
+}
@@ -0,0 +1,387 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Point cloud container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPointCloud.cpp
+  \brief Contiguous point cloud container filled from depth images.
+*/
+
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpPointCloud.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*
+    Deproject one row of depth values. Z is already expressed in meter and
+    invalid depth values (Z <= 0, Z > max_Z or NaN) lead to X = Y = Z = 0.
+  */
+  inline void deprojectScalar(float Z, float xn, float yn, float max_Z, float &X, float &Y, float &Zout)
+  {
+    if (! (Z > 0.f && Z <= max_Z))
+      Z = 0.f;
+    X = xn * Z;
+    Y = yn * Z;
+    Zout = Z;
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor that builds an empty point cloud.
+*/
+vpPointCloud::vpPointCloud()
+  : m_height(0), m_width(0), m_size(0), m_xyz(), m_colorEnabled(false), m_color(),
+    m_xn(), m_yn(), m_tableHeight(0), m_tableWidth(0), m_tableCam()
+{
+}
+
+/*!
+  Build an unorganized point cloud of \e n points initialized to zero.
+*/
+vpPointCloud::vpPointCloud(unsigned int n)
+  : m_height(0), m_width(0), m_size(0), m_xyz(), m_colorEnabled(false), m_color(),
+    m_xn(), m_yn(), m_tableHeight(0), m_tableWidth(0), m_tableCam()
+{
+  resize(n);
+}
+
+/*!
+  Build an organized point cloud of \e height x \e width points initialized to zero.
+*/
+vpPointCloud::vpPointCloud(unsigned int height, unsigned int width)
+  : m_height(0), m_width(0), m_size(0), m_xyz(), m_colorEnabled(false), m_color(),
+    m_xn(), m_yn(), m_tableHeight(0), m_tableWidth(0), m_tableCam()
+{
+  resize(height, width);
+}
+
+/*!
+  Destructor.
+*/
+vpPointCloud::~vpPointCloud()
+{
+}
+
+/*!
+  Remove all the points and release the memory, including the cached
+  deprojection tables.
+*/
+void vpPointCloud::clear()
+{
+  m_height = m_width = m_size = 0;
+  std::vector<float>().swap(m_xyz);
+  std::vector<vpRGBa>().swap(m_color);
+  std::vector<float>().swap(m_xn);
+  std::vector<float>().swap(m_yn);
+  m_tableHeight = m_tableWidth = 0;
+}
+
+/*!
+  Set the color of each point from a color image.
+
+  Each valid point is expressed in the color camera frame using \e cMd, then
+  projected in \e I using the color camera parameters \e cam. Points that
+  are not valid or that project outside the image are set to black. The
+  color of the points is enabled by this function.
+
+  \param I : Color image.
+  \param cam : Intrinsic parameters of the color camera.
+  \param cMd : Transformation from the frame of the point cloud (usually the
+  depth camera frame) to the color camera frame.
+*/
+void vpPointCloud::colorize(const vpImage<vpRGBa> &I, const vpCameraParameters &cam, const vpHomogeneousMatrix &cMd)
+{
+  enableColor(true);
+
+  const float r00 = (float)cMd[0][0], r01 = (float)cMd[0][1], r02 = (float)cMd[0][2], tx = (float)cMd[0][3];
+  const float r10 = (float)cMd[1][0], r11 = (float)cMd[1][1], r12 = (float)cMd[1][2], ty = (float)cMd[1][3];
+  const float r20 = (float)cMd[2][0], r21 = (float)cMd[2][1], r22 = (float)cMd[2][2], tz = (float)cMd[2][3];
+  const float *X = getX(), *Y = getY(), *Z = getZ();
+  const int height = (int)I.getHeight(), width = (int)I.getWidth();
+  const int size = (int)m_size;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < size; k++) {
+    vpRGBa color(0, 0, 0, vpRGBa::alpha_default);
+    if (Z[k] > 0) {
+      float Xc = r00 * X[k] + r01 * Y[k] + r02 * Z[k] + tx;
+      float Yc = r10 * X[k] + r11 * Y[k] + r12 * Z[k] + ty;
+      float Zc = r20 * X[k] + r21 * Y[k] + r22 * Z[k] + tz;
+      if (Zc > 0) {
+        double u = 0., v = 0.;
+        vpMeterPixelConversion::convertPoint(cam, Xc / Zc, Yc / Zc, u, v);
+        int j = (int)(u + 0.5), i = (int)(v + 0.5);
+        if (u > -0.5 && v > -0.5 && i < height && j < width)
+          color = I[i][j];
+      }
+    }
+    m_color[(size_t)k] = color;
+  }
+}
+
+/*!
+  Fill the point cloud from a depth image.
+
+  The point cloud becomes organized with the size of the depth image. The
+  point corresponding to pixel (i,j) is given by \f$ Z = d(i,j) \times
+  depth\_scale \f$, \f$ X = x Z \f$ and \f$ Y = y Z \f$ where \f$ (x,y) \f$
+  are the normalized coordinates of the pixel. Pixels with a null depth or
+  with a depth greater than \e max_Z lead to X = Y = Z = 0.
+
+  \param depth : Depth image in sensor units.
+  \param cam : Intrinsic parameters of the depth camera.
+  \param depth_scale : Scale factor to convert the depth values in meter.
+  \param max_Z : Maximal depth in meter.
+*/
+void vpPointCloud::deproject(const vpImage<uint16_t> &depth, const vpCameraParameters &cam, float depth_scale, float max_Z)
+{
+  deproject(depth.bitmap, depth.getHeight(), depth.getWidth(), cam, depth_scale, max_Z);
+}
+
+/*!
+  Fill the point cloud from a depth buffer, for example the frame data of a
+  device, without copying it in a vpImage.
+
+  \param d : Depth buffer of \e height x \e width values in sensor units stored row by row.
+  \param height, width : Size of the depth buffer.
+  \param cam : Intrinsic parameters of the depth camera.
+  \param depth_scale : Scale factor to convert the depth values in meter.
+  \param max_Z : Maximal depth in meter.
+
+  \sa deproject(const vpImage<uint16_t> &, const vpCameraParameters &, float, float)
+*/
+void vpPointCloud::deproject(const uint16_t *d, unsigned int height, unsigned int width, const vpCameraParameters &cam,
+                             float depth_scale, float max_Z)
+{
+  resize(height, width);
+  updateDeprojectionTables(height, width, cam);
+
+  float *X = getX(), *Y = getY(), *Z = getZ();
+  const float *xn = m_xn.empty() ? NULL : &m_xn[0];
+  const float *yn = m_yn.empty() ? NULL : &m_yn[0];
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)height; i++) {
+    unsigned int j = 0;
+    const size_t offset = (size_t)i * width;
+#if VISP_HAVE_SSE2
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128 v_zerof = _mm_setzero_ps();
+    const __m128 v_scale = _mm_set1_ps(depth_scale);
+    const __m128 v_max = _mm_set1_ps(max_Z);
+    for (; j + 4 <= width; j += 4) {
+      const size_t k = offset + j;
+      __m128i v_d = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(d + k)), v_zero);
+      __m128 v_Z = _mm_mul_ps(_mm_cvtepi32_ps(v_d), v_scale);
+      __m128 v_valid = _mm_and_ps(_mm_cmpgt_ps(v_Z, v_zerof), _mm_cmple_ps(v_Z, v_max));
+      v_Z = _mm_and_ps(v_Z, v_valid);
+      _mm_storeu_ps(X + k, _mm_mul_ps(_mm_loadu_ps(xn + k), v_Z));
+      _mm_storeu_ps(Y + k, _mm_mul_ps(_mm_loadu_ps(yn + k), v_Z));
+      _mm_storeu_ps(Z + k, v_Z);
+    }
+#endif
+    for (; j < width; j++) {
+      const size_t k = offset + j;
+      deprojectScalar(d[k] * depth_scale, xn[k], yn[k], max_Z, X[k], Y[k], Z[k]);
+    }
+  }
+}
+
+/*!
+  Fill the point cloud from a depth image expressed in meter.
+
+  This function behaves like deproject(const vpImage<uint16_t> &, const
+  vpCameraParameters &, float, float) except that no scale factor is
+  applied. Negative values (for example -1 used by vpKinect) and NaN values
+  are considered as invalid.
+
+  \param depth : Depth image in meter.
+  \param cam : Intrinsic parameters of the depth camera.
+  \param max_Z : Maximal depth in meter.
+*/
+void vpPointCloud::deproject(const vpImage<float> &depth, const vpCameraParameters &cam, float max_Z)
+{
+  const unsigned int height = depth.getHeight(), width = depth.getWidth();
+  resize(height, width);
+  updateDeprojectionTables(height, width, cam);
+
+  float *X = getX(), *Y = getY(), *Z = getZ();
+  const float *xn = m_xn.empty() ? NULL : &m_xn[0];
+  const float *yn = m_yn.empty() ? NULL : &m_yn[0];
+  const float *d = depth.bitmap;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)height; i++) {
+    unsigned int j = 0;
+    const size_t offset = (size_t)i * width;
+#if VISP_HAVE_SSE2
+    const __m128 v_zerof = _mm_setzero_ps();
+    const __m128 v_max = _mm_set1_ps(max_Z);
+    for (; j + 4 <= width; j += 4) {
+      const size_t k = offset + j;
+      __m128 v_Z = _mm_loadu_ps(d + k);
+      // Comparisons with NaN are false, so NaN values are discarded as well
+      __m128 v_valid = _mm_and_ps(_mm_cmpgt_ps(v_Z, v_zerof), _mm_cmple_ps(v_Z, v_max));
+      v_Z = _mm_and_ps(v_Z, v_valid);
+      _mm_storeu_ps(X + k, _mm_mul_ps(_mm_loadu_ps(xn + k), v_Z));
+      _mm_storeu_ps(Y + k, _mm_mul_ps(_mm_loadu_ps(yn + k), v_Z));
+      _mm_storeu_ps(Z + k, v_Z);
+    }
+#endif
+    for (; j < width; j++) {
+      const size_t k = offset + j;
+      deprojectScalar(d[k], xn[k], yn[k], max_Z, X[k], Y[k], Z[k]);
+    }
+  }
+}
+
+/*!
+  Enable or disable the color of the points. When enabled, the colors are
+  initialized to black and can be set with colorize() or getColor().
+*/
+void vpPointCloud::enableColor(bool enable)
+{
+  m_colorEnabled = enable;
+  if (enable)
+    m_color.resize(m_size, vpRGBa(0, 0, 0, vpRGBa::alpha_default));
+  else
+    std::vector<vpRGBa>().swap(m_color);
+}
+
+/*!
+  Return the number of points that have a depth measurement (Z > 0).
+*/
+unsigned int vpPointCloud::getValidPointCount() const
+{
+  unsigned int count = 0;
+  const float *Z = getZ();
+  for (unsigned int k = 0; k < m_size; k++) {
+    if (Z[k] > 0)
+      count++;
+  }
+  return count;
+}
+
+/*!
+  Resize the point cloud as an unorganized set of \e n points. The memory is
+  only reallocated when the number of points changes. The coordinates of the
+  points are not initialized.
+*/
+void vpPointCloud::resize(unsigned int n)
+{
+  resize(1, n);
+}
+
+/*!
+  Resize the point cloud as an organized set of \e height x \e width points.
+  The memory is only reallocated when the number of points changes. The
+  coordinates of the points are not initialized.
+*/
+void vpPointCloud::resize(unsigned int height, unsigned int width)
+{
+  const unsigned int n = height * width;
+  m_height = n ? height : 0;
+  m_width = n ? width : 0;
+  if (n != m_size) {
+    m_size = n;
+    m_xyz.resize(3 * (size_t)n);
+    if (m_colorEnabled)
+      m_color.resize(n, vpRGBa(0, 0, 0, vpRGBa::alpha_default));
+  }
+}
+
+/*!
+  Convert the point cloud in the homogeneous representation used by
+  vpKinect and vpRealSense. Each point is a 4 dimension vector (X, Y, Z, 1).
+*/
+void vpPointCloud::toVector(std::vector<vpColVector> &pointcloud) const
+{
+  pointcloud.resize(m_size);
+  const float *X = getX(), *Y = getY(), *Z = getZ();
+  for (unsigned int k = 0; k < m_size; k++) {
+    vpColVector &P = pointcloud[k];
+    P.resize(4, false);
+    P[0] = X[k];
+    P[1] = Y[k];
+    P[2] = Z[k];
+    P[3] = 1.;
+  }
+}
+
+/*!
+  Update the normalized coordinates of each pixel if the image size or the
+  camera parameters differ from the ones used at the previous call.
+*/
+void vpPointCloud::updateDeprojectionTables(unsigned int height, unsigned int width, const vpCameraParameters &cam)
+{
+  if (height == m_tableHeight && width == m_tableWidth
+      && cam.get_projModel() == m_tableCam.get_projModel()
+      && cam.get_px() == m_tableCam.get_px() && cam.get_py() == m_tableCam.get_py()
+      && cam.get_u0() == m_tableCam.get_u0() && cam.get_v0() == m_tableCam.get_v0()
+      && cam.get_kud() == m_tableCam.get_kud() && cam.get_kdu() == m_tableCam.get_kdu())
+    return;
+
+  const size_t n = (size_t)height * width;
+  m_xn.resize(n);
+  m_yn.resize(n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      double x = 0., y = 0.;
+      vpPixelMeterConversion::convertPoint(cam, (double)j, (double)i, x, y);
+      const size_t k = (size_t)i * width + j;
+      m_xn[k] = (float)x;
+      m_yn[k] = (float)y;
+    }
+  }
+
+  m_tableHeight = height;
+  m_tableWidth = width;
+  m_tableCam = cam;
+}
@@ -38,6 +38,106 @@
 
 #include <visp3/core/vpNetwork.h>
 
+#include <errno.h>
+#include <limits.h>
+#include <limits>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <sys/uio.h>
+#endif
+
+#ifndef IOV_MAX
+#  define IOV_MAX 1024
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+typedef int vpSocket;
+typedef struct iovec vpIoVec;
+#else
+typedef SOCKET vpSocket;
+struct vpIoVec {
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
+// Header of the frames sent by vpNetwork::sendMessageTo(). It is followed by the
+// part descriptors, the id of the message and the data of the parts.
+struct vpFrameHeader {
+  uint32_t magic;
+  uint32_t idSize;
+  uint32_t nbParts;
+  uint32_t reserved;
+};
+
+const uint32_t vpFrameMagic = 0x4d425056; // "VPBM" read with a little endian byte order
+const uint32_t vpFrameMaxParts = 65536;
+const uint32_t vpFrameMaxIdSize = 65536;
+// Maximum size of the data of a received frame, see vpNetworkMessage
+const uint64_t vpFrameMaxDataSize = (uint64_t)1 << 30;
+
+// Send or receive all the buffers with as few system calls as possible,
+// resuming after partial transfers. Return false on error or disconnection.
+bool vp_transfer_all(vpSocket s, vpIoVec *iov, size_t iovcnt, bool sending, size_t &transferred)
+{
+  transferred = 0;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int flags = sending ? 0 : MSG_WAITALL;
+#if defined(__linux__)
+  if (sending)
+    flags = MSG_NOSIGNAL; // Only for Linux
+#endif
+  while (iovcnt > 0) {
+    if (iov->iov_len == 0) {
+      ++iov;
+      --iovcnt;
+      continue;
+    }
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = iov;
+    header.msg_iovlen = (int)(iovcnt < IOV_MAX ? iovcnt : IOV_MAX);
+    ssize_t n = sending ? sendmsg(s, &header, flags) : recvmsg(s, &header, flags);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    transferred += (size_t)n;
+
+    size_t remaining = (size_t)n;
+    while (iovcnt > 0 && remaining >= iov->iov_len) {
+      remaining -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (remaining > 0) {
+      iov->iov_base = (char *)iov->iov_base + remaining;
+      iov->iov_len -= remaining;
+    }
+  }
+#else
+  for (; iovcnt > 0; ++iov, --iovcnt) {
+    char *ptr = (char *)iov->iov_base;
+    size_t len = iov->iov_len;
+    while (len > 0) {
+      int chunk = len > (size_t)INT_MAX ? INT_MAX : (int)len;
+      int n = sending ? send((unsigned int)s, ptr, chunk, 0) : recv((unsigned int)s, ptr, chunk, 0);
+      if (n <= 0)
+        return false;
+      ptr += n;
+      len -= (size_t)n;
+      transferred += (size_t)n;
+    }
+  }
+#endif
+  return true;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 vpNetwork::vpNetwork()
   : emitter(), receptor_list(), readFileDescriptor(), socketMax(0), request_list(),
     max_size_message(999999), separator("[*@*]"), beginning("[*start*]"), end("[*end*]"),
@@ -268,6 +368,74 @@ int vpNetwork::sendAndEncodeRequestTo(vpRequest &req, const unsigned int &dest)
   return sendRequestTo(req,dest);
 }
 
+/*!
+  Send a binary message to the first receptor in the list.
+
+  \sa vpNetwork::sendMessageTo()
+  \sa vpNetwork::receiveMessage()
+
+  \param msg : Message to send.
+
+  \return The number of bytes that have been sent, -1 if an error occured.
+*/
+int vpNetwork::sendMessage(const vpNetworkMessage &msg)
+{
+  return sendMessageTo(msg, 0);
+}
+
+/*!
+  Send a binary message to a specific receptor.
+
+  Contrary to sendRequestTo(), the parts of the message are neither encoded
+  nor copied: the frame header, the part descriptors, the id and the data of
+  each part are sent with a single scatter/gather system call.
+
+  \sa vpNetwork::sendMessage()
+  \sa vpNetwork::receiveMessageFrom()
+
+  \param msg : Message to send.
+  \param dest : Index of the receptor receiving the message.
+
+  \return The number of bytes that have been sent, -1 if an error occured.
+*/
+int vpNetwork::sendMessageTo(const vpNetworkMessage &msg, const unsigned int &dest)
+{
+  if(receptor_list.size() == 0 || dest > (unsigned int)receptor_list.size()-1)
+  {
+    if(verboseMode)
+      vpTRACE( "Cannot Send Message! Bad Index" );
+    return 0;
+  }
+
+  size_t nbParts = msg.m_parts.size();
+  vpFrameHeader header;
+  header.magic = vpFrameMagic;
+  header.idSize = (uint32_t)msg.m_id.size();
+  header.nbParts = (uint32_t)nbParts;
+  header.reserved = 0;
+
+  std::vector<vpIoVec> iov(3 + nbParts);
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = nbParts ? (void *)&msg.m_parts[0] : NULL;
+  iov[1].iov_len = nbParts * sizeof(vpNetworkMessage::vpPartHeader);
+  iov[2].iov_base = (void *)msg.m_id.c_str();
+  iov[2].iov_len = msg.m_id.size();
+  for (size_t i = 0; i < nbParts; i++) {
+    iov[3 + i].iov_base = const_cast<void *>(msg.m_data[i]);
+    iov[3 + i].iov_len = (size_t)msg.m_parts[i].size;
+  }
+
+  size_t numbytes = 0;
+  if (!vp_transfer_all(receptor_list[dest].socketFileDescriptorReceptor, &iov[0], iov.size(), true, numbytes)) {
+    if(verboseMode)
+      vpERROR_TRACE( "Cannot send the message" );
+    return -1;
+  }
+
+  return (int)numbytes;
+}
+
 /*!
   Receive requests untils there is requests to receive.
   
@@ -797,5 +965,248 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
   return numbytes;
 }
 
+/*!
+  Receive a binary message from the first receptor that emits one.
+
+  The call waits at most the timeout set with setTimeoutSec() and
+  setTimeoutUSec() for the beginning of a message, then blocks until the
+  whole message is received.
+
+  \sa vpNetwork::receiveMessageFrom()
+  \sa vpNetwork::sendMessage()
+
+  \param msg : Received message.
+
+  \return The index of the receptor that emitted the message, -1 if no message
+  was received.
+*/
+int vpNetwork::receiveMessage(vpNetworkMessage &msg)
+{
+  if(receptor_list.size() == 0)
+  {
+    if(verboseMode)
+      vpTRACE( "No Receptor!" );
+    return -1;
+  }
+
+  tv.tv_sec = tv_sec;
+#if TARGET_OS_IPHONE
+  tv.tv_usec = (int)tv_usec;
+#else
+  tv.tv_usec = tv_usec;
+#endif
+
+  FD_ZERO(&readFileDescriptor);
+
+  for(unsigned int i=0; i<receptor_list.size(); i++){
+    if(i == 0)
+      socketMax = receptor_list[i].socketFileDescriptorReceptor;
+
+    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
+    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor;
+  }
+
+  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  if(value == -1){
+    if(verboseMode)
+      vpERROR_TRACE( "Select error" );
+    return -1;
+  }
+  else if(value > 0){
+    for(unsigned int i=0; i<receptor_list.size(); i++){
+      if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor)){
+        if(_receiveMessageFrom(msg, i) > 0)
+          return (int)i;
+        return -1;
+      }
+    }
+  }
+
+  return -1;
+}
+
+/*!
+  Receive a binary message from a specific receptor.
+
+  The call waits at most the timeout set with setTimeoutSec() and
+  setTimeoutUSec() for the beginning of a message, then blocks until the
+  whole message is received. The parts bound with
+  vpNetworkMessage::bindImage() or vpNetworkMessage::bindMatrix() are received
+  directly in the bound objects.
+
+  \warning If the receptor is disconnected, it is removed from the list of
+  receptors and the indexes of the following receptors are shifted.
+
+  \sa vpNetwork::receiveMessage()
+  \sa vpNetwork::sendMessageTo()
+
+  \param msg : Received message.
+  \param receptorEmitting : Index of the receptor emitting the message.
+
+  \return The number of bytes received, 0 if no message was received before
+  the timeout, -1 if an error occured.
+*/
+int vpNetwork::receiveMessageFrom(vpNetworkMessage &msg, const unsigned int &receptorEmitting)
+{
+  if(receptor_list.size() == 0 || receptorEmitting > (unsigned int)receptor_list.size()-1 )
+  {
+    if(verboseMode)
+      vpTRACE( "No receptor at the specified index!" );
+    return -1;
+  }
+
+  tv.tv_sec = tv_sec;
+#if TARGET_OS_IPHONE
+  tv.tv_usec = (int)tv_usec;
+#else
+  tv.tv_usec = tv_usec;
+#endif
+
+  FD_ZERO(&readFileDescriptor);
+
+  socketMax = receptor_list[receptorEmitting].socketFileDescriptorReceptor;
+  FD_SET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor);
+
+  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  if(value == -1){
+    if(verboseMode)
+      vpERROR_TRACE( "Select error" );
+    return -1;
+  }
+  else if(value == 0){
+    //Timeout
+    return 0;
+  }
+
+  return _receiveMessageFrom(msg, receptorEmitting);
+}
+
+/*!
+  Close the connection with a receptor after an invalid frame and remove it
+  from the list of receptors. The end of the frame cannot be located, so that
+  the stream can't be resynchronized.
 
+  \param receptorIndex : Index of the receptor.
+*/
+void vpNetwork::_closeReceptor(const unsigned int &receptorIndex)
+{
+  std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorIndex].receptorAddress.sin_addr) << std::endl;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  close( receptor_list[receptorIndex].socketFileDescriptorReceptor );
+#else //Win32
+  closesocket( (unsigned)receptor_list[receptorIndex].socketFileDescriptorReceptor );
+#endif
+  receptor_list.erase(receptor_list.begin()+(int)receptorIndex);
+}
+
+/*!
+  Receive a whole binary message from a receptor whose socket is readable.
+
+  \param msg : Received message.
+  \param receptorEmitting : Index of the receptor emitting the message.
+
+  \return The number of bytes received, -1 if an error occured.
+*/
+int vpNetwork::_receiveMessageFrom(vpNetworkMessage &msg, const unsigned int &receptorEmitting)
+{
+  vpSocket sock = receptor_list[receptorEmitting].socketFileDescriptorReceptor;
+  size_t numbytes = 0, n = 0;
+
+  vpFrameHeader header;
+  vpIoVec iov_header;
+  iov_header.iov_base = &header;
+  iov_header.iov_len = sizeof(header);
+  if (!vp_transfer_all(sock, &iov_header, 1, false, n)) {
+    std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorEmitting].receptorAddress.sin_addr) << std::endl;
+    receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
+    return -1;
+  }
+  numbytes += n;
 
+  if (header.magic != vpFrameMagic || header.nbParts > vpFrameMaxParts || header.idSize > vpFrameMaxIdSize) {
+    if(verboseMode)
+      vpERROR_TRACE( "The received data is not a vpNetworkMessage" );
+    _closeReceptor(receptorEmitting);
+    return -1;
+  }
+
+  // Part descriptors followed by the id
+  size_t nbParts = header.nbParts;
+  size_t partsSize = nbParts * sizeof(vpNetworkMessage::vpPartHeader);
+  msg.m_header.resize(partsSize + header.idSize);
+  if (!msg.m_header.empty()) {
+    iov_header.iov_base = &msg.m_header[0];
+    iov_header.iov_len = msg.m_header.size();
+    if (!vp_transfer_all(sock, &iov_header, 1, false, n)) {
+      std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorEmitting].receptorAddress.sin_addr) << std::endl;
+      receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
+      return -1;
+    }
+    numbytes += n;
+  }
+  msg.m_parts.resize(nbParts);
+  if (nbParts)
+    memcpy(&msg.m_parts[0], &msg.m_header[0], partsSize);
+  msg.m_id.assign(msg.m_header.begin() + (long)partsSize, msg.m_header.end());
+
+  // Check the part descriptors before resizing any object: the number of
+  // elements of an image or a matrix has to fit in an unsigned int, and the
+  // size of the data is bounded
+  uint64_t dataSize = 0;
+  for (size_t i = 0; i < nbParts; i++) {
+    const vpNetworkMessage::vpPartHeader &part = msg.m_parts[i];
+    bool valid = part.size <= vpFrameMaxDataSize;
+    if (part.type == vpNetworkMessage::PART_IMAGE || part.type == vpNetworkMessage::PART_MATRIX) {
+      uint64_t nbElements = (uint64_t)part.rows * part.cols;
+      valid = valid && nbElements <= (uint64_t)std::numeric_limits<unsigned int>::max()
+          && part.size == nbElements * part.elemSize;
+    }
+    else if (part.type != vpNetworkMessage::PART_DATA)
+      valid = false;
+    dataSize += part.size;
+    if (! valid || dataSize > vpFrameMaxDataSize) {
+      if(verboseMode)
+        vpERROR_TRACE( "Invalid part %u in the received message", (unsigned int)i );
+      _closeReceptor(receptorEmitting);
+      return -1;
+    }
+  }
+
+  // Destination of each part: the bound object if any, the internal buffer otherwise
+  std::vector<size_t> offsets(nbParts, 0);
+  msg.m_data.assign(nbParts, NULL);
+  size_t bufferSize = 0;
+  for (size_t i = 0; i < nbParts; i++) {
+    const vpNetworkMessage::vpPartHeader &part = msg.m_parts[i];
+    for (size_t j = 0; j < msg.m_bindings.size(); j++) {
+      const vpNetworkMessage::vpBinding &binding = msg.m_bindings[j];
+      if (binding.index == i && binding.type == part.type && binding.elemSize == part.elemSize) {
+        msg.m_data[i] = binding.resize(binding.object, part.rows, part.cols);
+        break;
+      }
+    }
+    if (msg.m_data[i] == NULL) {
+      offsets[i] = bufferSize;
+      bufferSize += (size_t)part.size;
+    }
+  }
+  msg.m_buffer.resize(bufferSize);
+
+  std::vector<vpIoVec> iov(nbParts);
+  for (size_t i = 0; i < nbParts; i++) {
+    if (msg.m_data[i] == NULL)
+      msg.m_data[i] = bufferSize ? &msg.m_buffer[0] + offsets[i] : NULL;
+    iov[i].iov_base = const_cast<void *>(msg.m_data[i]);
+    iov[i].iov_len = (size_t)msg.m_parts[i].size;
+  }
+  if (nbParts) {
+    if (!vp_transfer_all(sock, &iov[0], nbParts, false, n)) {
+      std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorEmitting].receptorAddress.sin_addr) << std::endl;
+      receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
+      return -1;
+    }
+    numbytes += n;
+  }
+
+  return (int)numbytes;
+}
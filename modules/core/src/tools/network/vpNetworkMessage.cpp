@@ -0,0 +1,242 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Binary message transiting on the network.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpNetworkMessage.h>
+
+/*!
+  Build an empty message with an empty id.
+*/
+vpNetworkMessage::vpNetworkMessage()
+  : m_id(), m_parts(), m_data(), m_bindings(), m_buffer(), m_header()
+{
+}
+
+/*!
+  Build an empty message.
+
+  \param id : Id of the message.
+*/
+vpNetworkMessage::vpNetworkMessage(const std::string &id)
+  : m_id(id), m_parts(), m_data(), m_bindings(), m_buffer(), m_header()
+{
+}
+
+/*!
+  Destructor.
+*/
+vpNetworkMessage::~vpNetworkMessage()
+{
+}
+
+/*!
+  Add raw data to the message. Only the pointer is kept: the data have to
+  stay valid and unchanged until the message is sent.
+
+  \param data : Pointer on the data.
+  \param size : Size of the data in bytes.
+*/
+void vpNetworkMessage::addData(const void *data, size_t size)
+{
+  addPart(PART_DATA, 1, 1, (unsigned int)size, data);
+  m_parts.back().size = (uint64_t)size;
+}
+
+/*!
+  Add a matrix, a vpHomogeneousMatrix or a vector to the message. Only a
+  pointer on the data is kept: the matrix has to stay valid and unchanged
+  until the message is sent.
+
+  \param M : Matrix to send.
+*/
+void vpNetworkMessage::addMatrix(const vpArray2D<double> &M)
+{
+  addPart(PART_MATRIX, sizeof(double), M.getRows(), M.getCols(), M.data);
+}
+
+void vpNetworkMessage::addPart(vpPartType type, size_t elemSize, unsigned int rows, unsigned int cols,
+                               const void *data)
+{
+  vpPartHeader part;
+  part.type = (uint32_t)type;
+  part.elemSize = (uint32_t)elemSize;
+  part.rows = rows;
+  part.cols = cols;
+  part.size = (uint64_t)rows * cols * elemSize;
+  m_parts.push_back(part);
+  m_data.push_back(data);
+}
+
+/*!
+  Receive directly the matrix part \e index of the next received messages in
+  \e M, that is resized if needed.
+
+  \param index : Index of the part.
+  \param M : Destination matrix that has to stay valid while the binding is active.
+
+  \sa unbind()
+*/
+void vpNetworkMessage::bindMatrix(unsigned int index, vpMatrix &M)
+{
+  bind(index, PART_MATRIX, sizeof(double), &M, &vpNetworkMessage::resizeMatrix);
+}
+
+/*!
+  Receive directly the matrix part \e index of the next received messages in
+  \e M. If the part of a received message is not a 4 by 4 matrix, it is
+  stored in the internal buffer instead.
+
+  \param index : Index of the part.
+  \param M : Destination matrix that has to stay valid while the binding is active.
+
+  \sa unbind()
+*/
+void vpNetworkMessage::bindMatrix(unsigned int index, vpHomogeneousMatrix &M)
+{
+  bind(index, PART_MATRIX, sizeof(double), &M, &vpNetworkMessage::resizeHomogeneousMatrix);
+}
+
+void vpNetworkMessage::bind(unsigned int index, vpPartType type, size_t elemSize, void *object,
+                            vpResizeFunction resize)
+{
+  vpBinding binding;
+  binding.index = index;
+  binding.type = (uint32_t)type;
+  binding.elemSize = (uint32_t)elemSize;
+  binding.object = object;
+  binding.resize = resize;
+
+  for (size_t i = 0; i < m_bindings.size(); i++) {
+    if (m_bindings[i].index == index) {
+      m_bindings[i] = binding;
+      return;
+    }
+  }
+  m_bindings.push_back(binding);
+}
+
+const vpNetworkMessage::vpPartHeader &vpNetworkMessage::checkPart(unsigned int index, vpPartType type,
+                                                                  size_t elemSize) const
+{
+  if (index >= m_parts.size()) {
+    throw(vpException(vpException::badValue, "The message has only %d parts", (int)m_parts.size()));
+  }
+  const vpPartHeader &part = m_parts[index];
+  if (part.type != (uint32_t)type || part.elemSize != (uint32_t)elemSize) {
+    throw(vpException(vpException::badValue, "The type of the part %d of the message does not match", index));
+  }
+  return part;
+}
+
+/*!
+  Remove the parts of the message. The id, the bindings and the internal
+  buffers are kept, so that the message can be reused without allocation.
+*/
+void vpNetworkMessage::clear()
+{
+  m_parts.clear();
+  m_data.clear();
+}
+
+/*!
+  Return a pointer on the data of the part \e index.
+*/
+const void *vpNetworkMessage::getData(unsigned int index) const
+{
+  if (index >= m_parts.size()) {
+    throw(vpException(vpException::badValue, "The message has only %d parts", (int)m_parts.size()));
+  }
+  return m_data[index];
+}
+
+/*!
+  Copy the matrix part \e index in \e M. Nothing is copied if the part was
+  received directly in \e M with bindMatrix().
+
+  \param index : Index of the part.
+  \param M : Matrix resized to the dimensions of the part.
+
+  \exception vpException::badValue : If the part is not a matrix.
+*/
+void vpNetworkMessage::getMatrix(unsigned int index, vpMatrix &M) const
+{
+  const vpPartHeader &part = checkPart(index, PART_MATRIX, sizeof(double));
+  if (m_data[index] == M.data)
+    return;
+  M.resize(part.rows, part.cols, false);
+  if (part.size)
+    memcpy(M.data, m_data[index], (size_t)part.size);
+}
+
+/*!
+  Copy the matrix part \e index in \e M. Nothing is copied if the part was
+  received directly in \e M with bindMatrix().
+
+  \param index : Index of the part.
+  \param M : Homogeneous matrix.
+
+  \exception vpException::badValue : If the part is not a 4 by 4 matrix.
+*/
+void vpNetworkMessage::getMatrix(unsigned int index, vpHomogeneousMatrix &M) const
+{
+  const vpPartHeader &part = checkPart(index, PART_MATRIX, sizeof(double));
+  if (part.rows != 4 || part.cols != 4) {
+    throw(vpException(vpException::dimensionError, "Cannot get a %dx%d matrix in an homogeneous matrix", part.rows,
+                      part.cols));
+  }
+  if (m_data[index] == M.data)
+    return;
+  memcpy(M.data, m_data[index], (size_t)part.size);
+}
+
+void *vpNetworkMessage::resizeMatrix(void *object, unsigned int rows, unsigned int cols)
+{
+  vpMatrix *M = static_cast<vpMatrix *>(object);
+  M->resize(rows, cols, false);
+  return (void *)M->data;
+}
+
+void *vpNetworkMessage::resizeHomogeneousMatrix(void *object, unsigned int rows, unsigned int cols)
+{
+  if (rows != 4 || cols != 4)
+    return NULL;
+  return (void *)static_cast<vpHomogeneousMatrix *>(object)->data;
+}
+
+/*!
+  Remove all the bindings set with bindImage() and bindMatrix().
+*/
+void vpNetworkMessage::unbind()
+{
+  m_bindings.clear();
+}
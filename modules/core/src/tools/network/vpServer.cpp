@@ -37,15 +37,25 @@
 
 #include <visp3/core/vpServer.h>
 
+#include <algorithm>
+
 #if defined(__APPLE__) && defined(__MACH__) // Apple OSX and iOS (Darwin)
 #  include <TargetConditionals.h> // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
 #endif
 
+#if defined(__linux__)
+#  include <errno.h>
+#  include <sys/epoll.h>
+#endif
+
 /*!
   Construct a server on the machine launching it.
 */
 vpServer::vpServer( ) : adress(), port(0), started(false), max_clients(10)
 {
+#if defined(__linux__)
+  epollFileDescriptor = -1;
+#endif
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
@@ -71,6 +81,9 @@ vpServer::vpServer( ) : adress(), port(0), started(false), max_clients(10)
 */
 vpServer::vpServer( const int &port_serv ) : adress(), port(0), started(false), max_clients(10)
 {
+#if defined(__linux__)
+  epollFileDescriptor = -1;
+#endif
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
@@ -98,6 +111,9 @@ vpServer::vpServer( const int &port_serv ) : adress(), port(0), started(false),
 vpServer::vpServer( const std::string &adress_serv,const int &port_serv )
   : adress(), port(0), started(false), max_clients(10)
 {
+#if defined(__linux__)
+  epollFileDescriptor = -1;
+#endif
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
@@ -121,6 +137,10 @@ vpServer::vpServer( const std::string &adress_serv,const int &port_serv )
 */
 vpServer::~vpServer()
 {
+#if defined(__linux__)
+  if (epollFileDescriptor >= 0)
+    close( epollFileDescriptor );
+#endif
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
   close( emitter.socketFileDescriptorEmitter );
 #else //Win32
@@ -163,6 +183,19 @@ bool vpServer::start()
     vpERROR_TRACE( errorMessage.c_str() );
     return false;
   }
+
+  if (port == 0) {
+    // Get the port chosen by the system
+    struct sockaddr_in boundAddress;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+    socklen_t boundAddressSize = sizeof(boundAddress);
+    if (getsockname( emitter.socketFileDescriptorEmitter, (struct sockaddr *) &boundAddress, &boundAddressSize ) == 0)
+#else //Win32
+    int boundAddressSize = sizeof(boundAddress);
+    if (getsockname( (unsigned)emitter.socketFileDescriptorEmitter, (struct sockaddr *) &boundAddress, &boundAddressSize ) == 0)
+#endif
+      port = ntohs( boundAddress.sin_port );
+  }
   
 #ifdef SO_NOSIGPIPE
   // Mac OS X does not have the MSG_NOSIGNAL flag. It does have this
@@ -189,6 +222,188 @@ bool vpServer::start()
   return true;
 }
 
+/*!
+  Accept a pending connection and add the new client to the list of clients.
+
+  \return True if a client was accepted, false otherwise.
+*/
+bool vpServer::acceptClient()
+{
+  vpNetwork::vpReceptor client;
+  client.receptorAddressSize = sizeof(client.receptorAddress);
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  client.socketFileDescriptorReceptor = accept(emitter.socketFileDescriptorEmitter,(struct sockaddr*) &client.receptorAddress, &client.receptorAddressSize);
+#else //Win32
+  client.socketFileDescriptorReceptor = accept((unsigned int)emitter.socketFileDescriptorEmitter,(struct sockaddr*) &client.receptorAddress, &client.receptorAddressSize);
+#endif
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  if((client.socketFileDescriptorReceptor) == -1)
+#else
+  if((client.socketFileDescriptorReceptor) == INVALID_SOCKET)
+#endif
+  {
+    vpERROR_TRACE( "vpServer::run(), accept()" );
+    return false;
+  }
+
+  client.receptorIP = inet_ntoa(client.receptorAddress.sin_addr);
+  printf("New client connected : %s\n", inet_ntoa(client.receptorAddress.sin_addr));
+  receptor_list.push_back(client);
+
+  return true;
+}
+
+/*!
+  Wait for an activity on the server socket and on the sockets of the
+  clients. New clients are accepted, disconnected clients are removed from
+  the list of clients, and the indexes of the clients that have data to read
+  are returned.
+
+  On Linux the sockets are monitored with epoll: they are registered once and
+  only the sockets with pending events are processed, so that the cost of a
+  call does not grow with the number of idle clients. On the other platforms
+  select() is used.
+
+  \param clients : Indexes of the clients that have data to read, in increasing order.
+  \param timeout_ms : Maximum time to wait for an activity in milliseconds, -1 to wait indefinitely.
+
+  \return The number of clients that have data to read, -1 if an error occured OR server not started yet.
+
+  \sa vpNetwork::receiveMessageFrom(), vpNetwork::receiveRequestOnceFrom()
+*/
+int vpServer::checkForActivity(std::vector<unsigned int> &clients, int timeout_ms)
+{
+  clients.clear();
+  if(!started)
+    if(!start()){
+      return -1;
+    }
+
+  bool newConnection = false;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  std::vector<int> readySockets;
+#else
+  std::vector<SOCKET> readySockets;
+#endif
+
+#if defined(__linux__)
+  if (epollFileDescriptor < 0) {
+    epollFileDescriptor = epoll_create1(0);
+    if (epollFileDescriptor < 0) {
+      vpERROR_TRACE( "vpServer::checkForActivity(), cannot create epoll instance" );
+      return -1;
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = emitter.socketFileDescriptorEmitter;
+    epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, emitter.socketFileDescriptorEmitter, &event);
+  }
+
+  // Forget the removed clients, then register the new ones. A client closed
+  // by vpNetwork may have been removed and its descriptor reused since the
+  // last call, so the removed ones are processed first.
+  std::set<int> current;
+  for(unsigned int i=0; i<receptor_list.size(); i++)
+    current.insert(receptor_list[i].socketFileDescriptorReceptor);
+  for (std::set<int>::const_iterator it = epollSockets.begin(); it != epollSockets.end(); ++it) {
+    if (current.find(*it) == current.end())
+      epoll_ctl(epollFileDescriptor, EPOLL_CTL_DEL, *it, NULL);
+  }
+  for (std::set<int>::const_iterator it = current.begin(); it != current.end(); ++it) {
+    if (epollSockets.find(*it) == epollSockets.end()) {
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN | EPOLLRDHUP;
+      event.data.fd = *it;
+      epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, *it, &event);
+    }
+  }
+  epollSockets.swap(current);
+
+  std::vector<struct epoll_event> events(receptor_list.size() + 1);
+  int value = epoll_wait(epollFileDescriptor, &events[0], (int)events.size(), timeout_ms);
+  if (value < 0) {
+    if (errno == EINTR)
+      return 0;
+    vpERROR_TRACE( "vpServer::checkForActivity(), epoll_wait()" );
+    return -1;
+  }
+  for (int i = 0; i < value; i++) {
+    if (events[(size_t)i].data.fd == emitter.socketFileDescriptorEmitter)
+      newConnection = true;
+    else
+      readySockets.push_back(events[(size_t)i].data.fd);
+  }
+#else
+  struct timeval timeout;
+  struct timeval *timeoutPtr = NULL;
+  if (timeout_ms >= 0) {
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    timeoutPtr = &timeout;
+  }
+
+  FD_ZERO(&readFileDescriptor);
+
+  socketMax = emitter.socketFileDescriptorEmitter;
+  FD_SET((unsigned)emitter.socketFileDescriptorEmitter,&readFileDescriptor);
+
+  for(unsigned int i=0; i<receptor_list.size(); i++){
+    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
+    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor;
+  }
+
+  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,timeoutPtr);
+  if(value == -1){
+    vpERROR_TRACE( "vpServer::checkForActivity(), select()" );
+    return -1;
+  }
+  if(value > 0){
+    newConnection = FD_ISSET((unsigned int)emitter.socketFileDescriptorEmitter,&readFileDescriptor) != 0;
+    for(unsigned int i=0; i<receptor_list.size(); i++){
+      if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor))
+        readySockets.push_back(receptor_list[i].socketFileDescriptorReceptor);
+    }
+  }
+#endif
+
+  // Remove the disconnected clients: a readable socket without data
+  for(unsigned int i=0; i<receptor_list.size(); ){
+    if (std::find(readySockets.begin(), readySockets.end(), receptor_list[i].socketFileDescriptorReceptor) != readySockets.end()) {
+      char deco;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+      ssize_t numbytes = recv(receptor_list[i].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
+#else //Win32
+      int numbytes = recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
+#endif
+      if(numbytes <= 0)
+      {
+        std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
+#if defined(__linux__)
+        // Closing the socket removes it from the epoll instance
+        epollSockets.erase(receptor_list[i].socketFileDescriptorReceptor);
+#endif
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+        close( receptor_list[i].socketFileDescriptorReceptor );
+#else //Win32
+        closesocket( (unsigned)receptor_list[i].socketFileDescriptorReceptor );
+#endif
+        receptor_list.erase(receptor_list.begin()+(int)i);
+        continue;
+      }
+      clients.push_back(i);
+    }
+    i++;
+  }
+
+  if (newConnection)
+    acceptClient();
+
+  return (int)clients.size();
+}
+
 /*!
   Check if a client has connected or deconnected the server
   
@@ -232,26 +447,7 @@ bool vpServer::checkForConnections()
   }
   else{
     if(FD_ISSET((unsigned int)emitter.socketFileDescriptorEmitter,&readFileDescriptor)){
-      vpNetwork::vpReceptor client;
-      client.receptorAddressSize = sizeof(client.receptorAddress);
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-      client.socketFileDescriptorReceptor = accept(emitter.socketFileDescriptorEmitter,(struct sockaddr*) &client.receptorAddress, &client.receptorAddressSize);
-#else //Win32
-      client.socketFileDescriptorReceptor = accept((unsigned int)emitter.socketFileDescriptorEmitter,(struct sockaddr*) &client.receptorAddress, &client.receptorAddressSize);
-#endif
-      
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-      if((client.socketFileDescriptorReceptor) == -1)
-#else
-      if((client.socketFileDescriptorReceptor) == INVALID_SOCKET)
-#endif
-        vpERROR_TRACE( "vpServer::run(), accept()" );
-      
-      client.receptorIP = inet_ntoa(client.receptorAddress.sin_addr);
-      printf("New client connected : %s\n", inet_ntoa(client.receptorAddress.sin_addr));
-      receptor_list.push_back(client);
-      
-      return true;
+      return acceptClient();
     }
     else{
       for(unsigned int i=0; i<receptor_list.size(); i++){
@@ -0,0 +1,433 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Shared memory ring buffer of images.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpSharedImageBuffer.h>
+#include <visp3/core/vpTime.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VISP_HAVE_SHM 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Layout of the segment: a segment header, a header per slot, then the
+// bitmaps of the slots. Headers are padded to cache lines so that the
+// sequence numbers polled by the consumers do not share a line with pixels.
+struct vpSegmentHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t height;
+  uint32_t width;
+  uint32_t pixelSize;
+  uint32_t nbSlots;
+  uint64_t slotSize;
+  volatile uint64_t lastSequence;
+  char padding[88];
+};
+
+struct vpSlotHeader {
+  volatile uint64_t sequence; // 0 while the producer writes the slot
+  double timestamp;
+  char padding[48];
+};
+
+const uint32_t vpSegmentMagic = 0x4d495056; // "VPIM"
+const uint32_t vpSegmentVersion = 1;
+const size_t vpCacheLineSize = 64;
+
+inline size_t vp_align(size_t size) { return (size + vpCacheLineSize - 1) / vpCacheLineSize * vpCacheLineSize; }
+
+#if defined(__GNUC__)
+inline uint64_t vp_load_acquire(const volatile uint64_t *ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+inline uint64_t vp_load_relaxed(const volatile uint64_t *ptr) { return __atomic_load_n(ptr, __ATOMIC_RELAXED); }
+inline void vp_store_release(volatile uint64_t *ptr, uint64_t value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+inline void vp_store_relaxed(volatile uint64_t *ptr, uint64_t value) { __atomic_store_n(ptr, value, __ATOMIC_RELAXED); }
+inline void vp_fence_acquire() { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+inline void vp_fence_release() { __atomic_thread_fence(__ATOMIC_RELEASE); }
+#else
+// Volatile accesses are enough on strongly ordered architectures
+inline uint64_t vp_load_acquire(const volatile uint64_t *ptr) { return *ptr; }
+inline uint64_t vp_load_relaxed(const volatile uint64_t *ptr) { return *ptr; }
+inline void vp_store_release(volatile uint64_t *ptr, uint64_t value) { *ptr = value; }
+inline void vp_store_relaxed(volatile uint64_t *ptr, uint64_t value) { *ptr = value; }
+inline void vp_fence_acquire() {}
+inline void vp_fence_release() {}
+#endif
+
+inline vpSegmentHeader *vp_segment_header(unsigned char *segment)
+{
+  return reinterpret_cast<vpSegmentHeader *>(segment);
+}
+
+inline vpSlotHeader *vp_slot_header(unsigned char *segment, unsigned int nbSlots, uint64_t sequence)
+{
+  return reinterpret_cast<vpSlotHeader *>(segment + sizeof(vpSegmentHeader)) + sequence % nbSlots;
+}
+
+inline unsigned char *vp_slot_data(unsigned char *segment, unsigned int nbSlots, size_t slotSize, uint64_t sequence)
+{
+  return segment + sizeof(vpSegmentHeader) + nbSlots * sizeof(vpSlotHeader) + (sequence % nbSlots) * slotSize;
+}
+
+std::string vp_segment_name(const std::string &name)
+{
+  if (name.empty() || name[0] != '/')
+    return "/" + name;
+  return name;
+}
+
+#ifdef VISP_HAVE_SHM
+// Check that the name still refers to the segment opened with fd, and not to
+// a segment created since then by another producer
+bool vp_is_named_segment(const std::string &name, int fd)
+{
+  int named_fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (named_fd < 0)
+    return false;
+  struct stat named_st, st;
+  bool same = fstat(named_fd, &named_st) == 0 && fstat(fd, &st) == 0 && named_st.st_dev == st.st_dev &&
+              named_st.st_ino == st.st_ino;
+  ::close(named_fd);
+  return same;
+}
+#endif
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. Call create() or open() to use the buffer.
+*/
+vpSharedImageBuffer::vpSharedImageBuffer()
+  : m_name(), m_producer(false), m_segment(NULL), m_segmentSize(0), m_height(0), m_width(0), m_pixelSize(0),
+    m_nbSlots(0), m_slotSize(0), m_writeSequence(0)
+#ifdef VISP_HAVE_SHM
+    , m_fd(-1)
+#endif
+{
+}
+
+/*!
+  Destructor that unmaps the segment. The segment is removed if this object
+  is its producer.
+*/
+vpSharedImageBuffer::~vpSharedImageBuffer() { close(); }
+
+/*!
+  Start the publication of a new frame and return the bitmap of its slot, so
+  that the producer can write the image directly in the shared memory. The
+  frame is made visible to the consumers by endPublish().
+
+  \return Pointer on the getHeight() x getWidth() pixels of the slot.
+*/
+void *vpSharedImageBuffer::beginPublish()
+{
+  if (!m_producer) {
+    throw(vpException(vpException::fatalError, "Only the producer can publish in the shared buffer"));
+  }
+  vpSegmentHeader *header = vp_segment_header(m_segment);
+  m_writeSequence = vp_load_relaxed(&header->lastSequence) + 1;
+
+  // Invalidate the slot before overwriting its bitmap
+  vpSlotHeader *slot = vp_slot_header(m_segment, m_nbSlots, m_writeSequence);
+  vp_store_relaxed(&slot->sequence, 0);
+  vp_fence_release();
+
+  return vp_slot_data(m_segment, m_nbSlots, m_slotSize, m_writeSequence);
+}
+
+void vpSharedImageBuffer::checkPixelSize(size_t pixelSize) const
+{
+  if (m_segment == NULL) {
+    throw(vpException(vpException::fatalError, "The shared buffer is not created nor opened"));
+  }
+  if (pixelSize != m_pixelSize) {
+    throw(vpException(vpException::badValue, "The shared buffer %s contains pixels of %d bytes, not %d",
+                      m_name.c_str(), m_pixelSize, (int)pixelSize));
+  }
+}
+
+/*!
+  Unmap the segment. If this object is the producer, the segment is removed:
+  the consumers that have it mapped can still read the last frames but no new
+  consumer can open it. A segment created since then with the same name by
+  another producer is not removed.
+*/
+void vpSharedImageBuffer::close()
+{
+#ifdef VISP_HAVE_SHM
+  if (m_segment != NULL)
+    munmap(m_segment, m_segmentSize);
+  if (m_producer && m_fd >= 0 && vp_is_named_segment(m_name, m_fd))
+    shm_unlink(m_name.c_str());
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = -1;
+#endif
+  m_segment = NULL;
+  m_segmentSize = 0;
+  m_producer = false;
+  m_writeSequence = 0;
+}
+
+bool vpSharedImageBuffer::copyLatest(void *bitmap, uint64_t &sequence, double &timestamp) const
+{
+  vpSegmentHeader *header = vp_segment_header(m_segment);
+  size_t size = (size_t)m_height * m_width * m_pixelSize;
+  for (;;) {
+    uint64_t last = vp_load_acquire(&header->lastSequence);
+    if (last == 0)
+      return false;
+    vpSlotHeader *slot = vp_slot_header(m_segment, m_nbSlots, last);
+    if (vp_load_acquire(&slot->sequence) != last)
+      continue; // Overwritten by the producer, retry with the latest frame
+    double t = slot->timestamp;
+    memcpy(bitmap, vp_slot_data(m_segment, m_nbSlots, m_slotSize, last), size);
+    vp_fence_acquire();
+    if (vp_load_relaxed(&slot->sequence) == last) {
+      sequence = last;
+      timestamp = t;
+      return true;
+    }
+  }
+}
+
+void vpSharedImageBuffer::createSegment(const std::string &name, unsigned int height, unsigned int width,
+                                        unsigned int pixelSize, unsigned int nbSlots)
+{
+#ifdef VISP_HAVE_SHM
+  if (nbSlots < 2) {
+    throw(vpException(vpException::badValue, "The shared buffer needs at least 2 slots"));
+  }
+  close();
+
+  m_name = vp_segment_name(name);
+  m_height = height;
+  m_width = width;
+  m_pixelSize = pixelSize;
+  m_nbSlots = nbSlots;
+  m_slotSize = vp_align((size_t)height * width * pixelSize);
+
+  // A segment left with the same name, by a previous producer that is still
+  // running or that crashed, may be mapped by consumers: resizing it would
+  // make them crash on their next access. It is unlinked instead, so that its
+  // consumers keep reading its last frames and a new segment is created.
+  shm_unlink(m_name.c_str());
+  m_fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (m_fd < 0) {
+    throw(vpException(vpException::ioError, "Cannot create shared memory segment %s: %s", m_name.c_str(),
+                      strerror(errno)));
+  }
+  m_producer = true;
+  size_t size = sizeof(vpSegmentHeader) + nbSlots * (sizeof(vpSlotHeader) + m_slotSize);
+  if (ftruncate(m_fd, (off_t)size) != 0) {
+    std::string error = strerror(errno);
+    close();
+    throw(vpException(vpException::ioError, "Cannot resize shared memory segment %s: %s", name.c_str(),
+                      error.c_str()));
+  }
+  map(size, true);
+
+  vpSegmentHeader *header = vp_segment_header(m_segment);
+  memset((void *)m_segment, 0, sizeof(vpSegmentHeader) + nbSlots * sizeof(vpSlotHeader));
+  header->version = vpSegmentVersion;
+  header->height = height;
+  header->width = width;
+  header->pixelSize = pixelSize;
+  header->nbSlots = nbSlots;
+  header->slotSize = m_slotSize;
+  vp_fence_release();
+  header->magic = vpSegmentMagic;
+#else
+  (void)name;
+  (void)height;
+  (void)width;
+  (void)pixelSize;
+  (void)nbSlots;
+  throw(vpException(vpException::functionNotImplementedError, "Shared memory buffers are only available on UNIX"));
+#endif
+}
+
+/*!
+  End the publication started with beginPublish(): the frame becomes the
+  latest frame seen by the consumers.
+
+  \param timestamp : Timestamp of the frame, for example the acquisition time.
+
+  \return The sequence number of the published frame.
+*/
+uint64_t vpSharedImageBuffer::endPublish(double timestamp)
+{
+  if (m_writeSequence == 0) {
+    throw(vpException(vpException::fatalError, "endPublish() called without beginPublish()"));
+  }
+  vpSegmentHeader *header = vp_segment_header(m_segment);
+  vpSlotHeader *slot = vp_slot_header(m_segment, m_nbSlots, m_writeSequence);
+  slot->timestamp = timestamp;
+  vp_store_release(&slot->sequence, m_writeSequence);
+  vp_store_release(&header->lastSequence, m_writeSequence);
+
+  uint64_t sequence = m_writeSequence;
+  m_writeSequence = 0;
+  return sequence;
+}
+
+/*!
+  Return the sequence number of the latest published frame, 0 if no frame
+  was published yet.
+*/
+uint64_t vpSharedImageBuffer::getLastSequence() const
+{
+  if (m_segment == NULL)
+    return 0;
+  return vp_load_acquire(&vp_segment_header(m_segment)->lastSequence);
+}
+
+bool vpSharedImageBuffer::isSlotValid(uint64_t sequence) const
+{
+  vp_fence_acquire();
+  return vp_load_relaxed(&vp_slot_header(m_segment, m_nbSlots, sequence)->sequence) == sequence;
+}
+
+const void *vpSharedImageBuffer::latestSlot(uint64_t &sequence, double &timestamp) const
+{
+  vpSegmentHeader *header = vp_segment_header(m_segment);
+  for (;;) {
+    uint64_t last = vp_load_acquire(&header->lastSequence);
+    if (last == 0)
+      return NULL;
+    vpSlotHeader *slot = vp_slot_header(m_segment, m_nbSlots, last);
+    if (vp_load_acquire(&slot->sequence) != last)
+      continue;
+    double t = slot->timestamp;
+    vp_fence_acquire();
+    if (vp_load_relaxed(&slot->sequence) == last) {
+      sequence = last;
+      timestamp = t;
+      return vp_slot_data(m_segment, m_nbSlots, m_slotSize, last);
+    }
+  }
+}
+
+void vpSharedImageBuffer::map(size_t size, bool writable)
+{
+#ifdef VISP_HAVE_SHM
+  void *ptr = mmap(NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_fd, 0);
+  if (ptr == MAP_FAILED) {
+    std::string error = strerror(errno);
+    close();
+    throw(vpException(vpException::ioError, "Cannot map shared memory segment: %s", error.c_str()));
+  }
+  m_segment = static_cast<unsigned char *>(ptr);
+  m_segmentSize = size;
+#else
+  (void)size;
+  (void)writable;
+#endif
+}
+
+/*!
+  Open the shared memory segment created by a producer and map it read-only.
+
+  \param name : Name of the segment given to create().
+
+  \exception vpException::ioError : If the segment does not exist or is not a
+  vpSharedImageBuffer.
+*/
+void vpSharedImageBuffer::open(const std::string &name)
+{
+#ifdef VISP_HAVE_SHM
+  close();
+  m_name = vp_segment_name(name);
+  m_fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+  if (m_fd < 0) {
+    throw(vpException(vpException::ioError, "Cannot open shared memory segment %s: %s", m_name.c_str(),
+                      strerror(errno)));
+  }
+  struct stat st;
+  if (fstat(m_fd, &st) != 0 || (size_t)st.st_size < sizeof(vpSegmentHeader)) {
+    close();
+    throw(vpException(vpException::ioError, "Shared memory segment %s is not initialized", name.c_str()));
+  }
+  map((size_t)st.st_size, false);
+
+  const vpSegmentHeader *header = vp_segment_header(m_segment);
+  bool valid = (header->magic == vpSegmentMagic && header->version == vpSegmentVersion && header->nbSlots >= 2);
+  if (valid) {
+    vp_fence_acquire();
+    m_height = header->height;
+    m_width = header->width;
+    m_pixelSize = header->pixelSize;
+    m_nbSlots = header->nbSlots;
+    m_slotSize = (size_t)header->slotSize;
+    valid = m_slotSize >= (size_t)m_height * m_width * m_pixelSize &&
+            m_segmentSize >= sizeof(vpSegmentHeader) + m_nbSlots * (sizeof(vpSlotHeader) + m_slotSize);
+  }
+  if (!valid) {
+    close();
+    throw(vpException(vpException::ioError, "Shared memory segment %s is not a valid image buffer", name.c_str()));
+  }
+#else
+  (void)name;
+  throw(vpException(vpException::functionNotImplementedError, "Shared memory buffers are only available on UNIX"));
+#endif
+}
+
+/*!
+  Wait until a frame more recent than \e sequence is published. The call
+  first spins for a few microseconds to catch frames published at a high
+  rate with a low latency, then sleeps between checks.
+
+  \param sequence : Sequence number of the last frame processed by the consumer.
+  \param timeout_ms : Maximum waiting time in milliseconds, negative to wait indefinitely.
+
+  \return true if a new frame is available, false after the timeout.
+*/
+bool vpSharedImageBuffer::waitForFrame(uint64_t sequence, double timeout_ms) const
+{
+  double t0 = vpTime::measureTimeMs();
+  for (unsigned int i = 0;; i++) {
+    if (getLastSequence() > sequence)
+      return true;
+    if (timeout_ms >= 0 && vpTime::measureTimeMs() - t0 > timeout_ms)
+      return false;
+    if (i >= 1000)
+      vpTime::sleepMs(0.05);
+  }
+}
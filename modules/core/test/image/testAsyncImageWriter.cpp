@@ -0,0 +1,358 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test asynchronous image writing with vpAsyncImageWriter and vpVideoWriter.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpAsyncImageWriter.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/io/vpVideoWriter.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+  \example testAsyncImageWriter.cpp
+
+  \brief Write image sequences with vpAsyncImageWriter and vpVideoWriter,
+  check the written images and the queue counters, and compare the time spent
+  in the caller thread with synchronous writing.
+*/
+
+// List of allowed command line options
+#define GETOPTARGS  "cdo:n:t:h"
+
+void usage(const char *name, const char *badparam, std::string opath, std::string user,
+           unsigned int nbImages, unsigned int nbThreads)
+{
+  fprintf(stdout, "\n\
+Test asynchronous image writing.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output image path>] [-n <nb images>] [-t <nb threads>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output image path>                               %s\n\
+     Set image output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the image sequences are written.\n\
+\n\
+  -n <nb images>                                       %u\n\
+     Number of images of the sequences.\n\
+\n\
+  -t <nb threads>                                      %u\n\
+     Number of writer threads.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+    opath.c_str(), user.c_str(), nbImages, nbThreads);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user,
+                unsigned int &nbImages, unsigned int &nbThreads)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'o': opath = optarg_; break;
+    case 'n': nbImages = (unsigned int) atoi(optarg_); break;
+    case 't': nbThreads = (unsigned int) atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, opath, user, nbImages, nbThreads); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, opath, user, nbImages, nbThreads); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user, nbImages, nbThreads);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/*
+  Compare two images without the verbose vpImage::operator==().
+*/
+template<class Type>
+bool isEqual(const vpImage<Type> &I1, const vpImage<Type> &I2)
+{
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth())
+    return false;
+  return memcmp(I1.bitmap, I2.bitmap, I1.getSize() * sizeof(Type)) == 0;
+}
+
+/*
+  Synthetic image number k of a sequence.
+*/
+void createImage(vpImage<unsigned char> &I, unsigned int k)
+{
+  I.resize(480, 640);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = (unsigned char)(i + 3*j + 7*k);
+    }
+  }
+}
+
+/*
+  Check that the images of the sequence that were not dropped are on the disk and are correct.
+  Return the number of images found.
+*/
+unsigned int checkSequence(const std::string &format, unsigned int nbImages, bool &ok)
+{
+  char name[FILENAME_MAX];
+  vpImage<unsigned char> I, Iref;
+  unsigned int found = 0;
+  ok = true;
+  for (unsigned int k = 0; k < nbImages; k++) {
+    sprintf(name, format.c_str(), k);
+    if (! vpIoTools::checkFilename(name))
+      continue;
+    found++;
+    vpImageIo::read(I, name);
+    createImage(Iref, k);
+    if (! isEqual(I, Iref)) {
+      std::cerr << "Image " << name << " differs from the reference" << std::endl;
+      ok = false;
+    }
+  }
+  return found;
+}
+
+int main(int argc, const char ** argv)
+{
+  try {
+    std::string opt_opath;
+    std::string opath;
+    std::string username;
+    unsigned int nbImages = 40;
+    unsigned int nbThreads = 2;
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username, nbImages, nbThreads) == false) {
+      exit (-1);
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+    opath = vpIoTools::createFilePath(opath, "sequence-async");
+
+    // Remove the images of a previous run
+    if (vpIoTools::checkDirectory(opath))
+      vpIoTools::remove(opath);
+
+    try {
+      // Create the dirname
+      vpIoTools::makeDirectory(opath);
+    }
+    catch (...) {
+      usage(argv[0], NULL, opt_opath, username, nbImages, nbThreads);
+      std::cerr << std::endl
+                << "ERROR:" << std::endl;
+      std::cerr << "  Cannot create " << opath << std::endl;
+      std::cerr << "  Check your -o " << opt_opath << " option " << std::endl;
+      exit(-1);
+    }
+
+#if defined(VISP_HAVE_PNG)
+    std::string ext = "png";
+#else
+    std::string ext = "pgm";
+#endif
+    std::vector<vpImage<unsigned char> > Iref(nbImages);
+    for (unsigned int k = 0; k < nbImages; k++)
+      createImage(Iref[k], k);
+
+    // Time spent in the caller thread with synchronous and asynchronous writing
+    double t_sync, t_async;
+    bool ok;
+    char name[FILENAME_MAX];
+    std::string format_sync = vpIoTools::createFilePath(opath, "sync%04d." + ext);
+    std::string format_async = vpIoTools::createFilePath(opath, "async%04d." + ext);
+    t_sync = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nbImages; k++) {
+      sprintf(name, format_sync.c_str(), k);
+      vpImageIo::write(Iref[k], name);
+    }
+    t_sync = vpTime::measureTimeMs() - t_sync;
+    {
+      vpAsyncImageWriter writer(nbThreads, nbImages, vpAsyncImageWriter::BLOCK);
+      t_async = vpTime::measureTimeMs();
+      for (unsigned int k = 0; k < nbImages; k++) {
+        sprintf(name, format_async.c_str(), k);
+        if (! writer.write(Iref[k], name)) {
+          std::cerr << "An image was dropped with the BLOCK policy" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      t_async = vpTime::measureTimeMs() - t_async;
+      writer.flush();
+      if (writer.getQueueDepth() != 0 || writer.getWrittenCount() != nbImages || writer.getDroppedCount() != 0
+          || writer.getErrorCount() != 0) {
+        std::cerr << "Bad counters with the BLOCK policy" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (checkSequence(format_async, nbImages, ok) != nbImages || ! ok) {
+      std::cerr << "Bad sequence written with the BLOCK policy" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Time spent in the caller thread to write " << nbImages << " " << ext << " images: "
+              << t_sync << " ms synchronously, " << t_async << " ms with " << nbThreads << " threads" << std::endl;
+
+    // Drop policies with a single buffer
+    vpAsyncImageWriter::vpQueuePolicy policies[2] = { vpAsyncImageWriter::DROP_NEWEST, vpAsyncImageWriter::DROP_OLDEST };
+    const char *policy_names[2] = { "drop_newest", "drop_oldest" };
+    for (unsigned int p = 0; p < 2; p++) {
+      std::string format = vpIoTools::createFilePath(opath, std::string(policy_names[p]) + "%04d." + ext);
+      unsigned int written, dropped;
+      {
+        vpAsyncImageWriter writer(1, 1, policies[p]);
+        for (unsigned int k = 0; k < nbImages; k++) {
+          sprintf(name, format.c_str(), k);
+          writer.write(Iref[k], name);
+        }
+        writer.flush();
+        written = writer.getWrittenCount();
+        dropped = writer.getDroppedCount();
+        if (writer.getErrorCount() != 0 || written + dropped != nbImages || writer.getMaxQueueDepth() > 1) {
+          std::cerr << "Bad counters with the " << policy_names[p] << " policy" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      if (checkSequence(format, nbImages, ok) != written || ! ok) {
+        std::cerr << "Bad sequence written with the " << policy_names[p] << " policy" << std::endl;
+        return EXIT_FAILURE;
+      }
+      // The last image is never dropped with DROP_OLDEST
+      sprintf(name, format.c_str(), nbImages - 1);
+      if (policies[p] == vpAsyncImageWriter::DROP_OLDEST && ! vpIoTools::checkFilename(name)) {
+        std::cerr << "The last image was dropped with the " << policy_names[p] << " policy" << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::cout << policy_names[p] << ": " << written << " images written, " << dropped << " dropped" << std::endl;
+    }
+
+    // Color image sequence with vpVideoWriter
+    {
+      std::string format = vpIoTools::createFilePath(opath, "writer%04d.ppm");
+      vpImage<vpRGBa> Ic, Icref;
+      vpVideoWriter writer;
+      writer.setFileName(format);
+      writer.setAsync(nbThreads, 4);
+      vpImageConvert::convert(Iref[0], Ic);
+      writer.open(Ic);
+      for (unsigned int k = 0; k < nbImages; k++) {
+        vpImageConvert::convert(Iref[k], Ic);
+        writer.saveFrame(Ic);
+      }
+      writer.close();
+      if (writer.getQueueDepth() != 0 || writer.getDroppedFrameCount() != 0) {
+        std::cerr << "Bad vpVideoWriter counters" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int k = 0; k < nbImages; k++) {
+        sprintf(name, format.c_str(), k);
+        vpImageIo::read(Ic, name);
+        vpImageConvert::convert(Iref[k], Icref);
+        if (! isEqual(Ic, Icref)) {
+          std::cerr << "Image " << name << " written with vpVideoWriter differs from the reference" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // A write error is reported by close()
+    {
+      vpVideoWriter writer;
+      writer.setFileName(vpIoTools::createFilePath(opath, "missing-dir/I%04d.pgm"));
+      writer.setAsync(nbThreads);
+      writer.open(Iref[0]);
+      writer.saveFrame(Iref[0]);
+      bool error_detected = false;
+      try {
+        writer.close();
+      }
+      catch(const vpException &) {
+        error_detected = true;
+      }
+      if (! error_detected) {
+        std::cerr << "vpVideoWriter::close() did not report a write error" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // The error of the previous sequence is not reported again after open()
+      writer.setFileName(vpIoTools::createFilePath(opath, "reopen%04d.pgm"));
+      writer.open(Iref[0]);
+      writer.saveFrame(Iref[0]);
+      writer.close();
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the Canny edge detector of vpImageFilter.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageFilterCanny.cpp
+
+  \brief Test the Canny edge detector of vpImageFilter on synthetic images.
+*/
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpTime.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+#ifdef VISP_HAVE_OPENMP
+#  include <omp.h>
+#endif
+
+namespace {
+  // Disk with a gradient background and a low contrast square
+  void createImage(vpImage<unsigned char> &I, unsigned int height, unsigned int width)
+  {
+    I.resize(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        double r = sqrt(vpMath::sqr(i - height / 2.) + vpMath::sqr(j - width / 2.));
+        double value = 40 + 30. * j / width;
+        if (r < height / 4.)
+          value = 200;
+        if (i > height / 10 && i < height / 5 && j > width / 10 && j < width / 5)
+          value += 8;
+        I[i][j] = (unsigned char) value;
+      }
+    }
+  }
+
+  unsigned int countEdges(const vpImage<unsigned char> &E)
+  {
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < E.getSize(); i++) {
+      if (E.bitmap[i] == 255)
+        n++;
+      else if (E.bitmap[i] != 0)
+        return 0;
+    }
+    return n;
+  }
+}
+
+int main()
+{
+  try {
+    const unsigned int height = 480, width = 640;
+    vpImage<unsigned char> I, E;
+    createImage(I, height, width);
+
+    vpImageFilter::canny(I, E, 5, 30, 3);
+    unsigned int nbEdges = countEdges(E);
+    std::cout << "Number of edges: " << nbEdges << std::endl;
+
+    // Edges must lie on the disk border, and be thin
+    double perimeter = 2 * M_PI * height / 4.;
+    if (nbEdges < perimeter || nbEdges > 2 * perimeter) {
+      std::cerr << "Bad number of edges" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        double r = sqrt(vpMath::sqr(i - height / 2.) + vpMath::sqr(j - width / 2.));
+        if (E[i][j] && std::fabs(r - height / 4.) > 2) {
+          std::cerr << "Edge at (" << i << ", " << j << ") outside of the disk border" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Hysteresis: the low contrast square is only detected with a low lower threshold
+    vpImage<unsigned char> E_low;
+    vpImageFilter::canny(I, E_low, 5, 10, 30, 3);
+    unsigned int nbEdgesLow = countEdges(E_low);
+    vpImageFilter::canny(I, E, 5, 10, 10, 3);
+    unsigned int nbEdgesAll = countEdges(E);
+    std::cout << "Number of edges with hysteresis: " << nbEdgesLow << ", with a low threshold: " << nbEdgesAll
+              << std::endl;
+    if (nbEdgesLow != nbEdges || nbEdgesAll <= nbEdges) {
+      std::cerr << "Bad hysteresis" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // In place filtering gives the same result
+    vpImage<unsigned char> I_copy = I;
+    vpImageFilter::canny(I_copy, I_copy, 5, 10, 10, 3);
+    if (I_copy != E) {
+      std::cerr << "In place filtering gives a different result" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+#ifdef VISP_HAVE_OPENMP
+    // The result does not depend on the number of threads
+    int nbThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    vpImage<unsigned char> E_single;
+    vpImageFilter::canny(I, E_single, 5, 10, 10, 3);
+    omp_set_num_threads(nbThreads > 1 ? nbThreads : 4);
+    vpImageFilter::canny(I, E, 5, 10, 10, 3);
+    omp_set_num_threads(nbThreads);
+    if (E_single != E) {
+      std::cerr << "The result depends on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+#endif
+
+    // Larger Sobel aperture
+    vpImageFilter::canny(I, E, 3, 200, 5);
+    if (countEdges(E) < perimeter) {
+      std::cerr << "Bad number of edges with a 5x5 Sobel operator" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    unsigned int nbIter = 20;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nbIter; iter++)
+      vpImageFilter::canny(I, E, 5, 10, 30, 3);
+    std::cout << "Canny on a " << width << "x" << height << " image: " << (vpTime::measureTimeMs() - t) / nbIter
+              << " ms" << std::endl;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "testImageFilterCanny is ok" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,319 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark PGM/PPM read and write.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+
+#include <fstream>
+#include <stdlib.h>
+#include <stdio.h>
+
+/*!
+  \example testPerformanceIoPNM.cpp
+
+  \brief Benchmark the PGM/PPM readers and writers of vpImageIo against a
+  pixel by pixel implementation and check that both give the same images.
+*/
+
+// List of allowed command line options
+#define GETOPTARGS  "cdo:n:h"
+
+void usage(const char *name, const char *badparam, std::string opath, std::string user, unsigned int nbIterations)
+{
+  fprintf(stdout, "\n\
+Benchmark PGM/PPM read and write.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output image path>] [-n <nb iterations>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output image path>                               %s\n\
+     Set image output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the benchmark images are written.\n\
+\n\
+  -n <nb iterations>                                   %u\n\
+     Number of read/write iterations.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+    opath.c_str(), user.c_str(), nbIterations);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user, unsigned int &nbIterations)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'o': opath = optarg_; break;
+    case 'n': nbIterations = (unsigned int) atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, opath, user, nbIterations); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, opath, user, nbIterations); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user, nbIterations);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/*
+  Reference pixel by pixel PPM reader. The header is supposed to be
+  "P6\n<width> <height>\n255\n" as written by vpImageIo::writePPM().
+*/
+void readPPM_pixel(vpImage<vpRGBa> &I, const std::string &filename)
+{
+  std::ifstream fd(filename.c_str(), std::ios::binary);
+  std::string magic;
+  unsigned int w, h, maxval;
+  fd >> magic >> w >> h >> maxval;
+  fd.get();
+  I.resize(h, w);
+  for (unsigned int i = 0; i < h; i++) {
+    for (unsigned int j = 0; j < w; j++) {
+      unsigned char rgb[3];
+      fd.read((char *)&rgb, 3);
+      I[i][j] = vpRGBa(rgb[0], rgb[1], rgb[2], vpRGBa::alpha_default);
+    }
+  }
+}
+
+/*
+  Reference pixel by pixel PPM writer.
+*/
+void writePPM_pixel(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  FILE *f = fopen(filename.c_str(), "wb");
+  fprintf(f, "P6\n%d %d\n%d\n", I.getWidth(), I.getHeight(), 255);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      unsigned char rgb[3] = { I[i][j].R, I[i][j].G, I[i][j].B };
+      fwrite(&rgb, 1, 3, f);
+    }
+  }
+  fclose(f);
+}
+
+int main(int argc, const char ** argv)
+{
+  try {
+    std::string opt_opath;
+    std::string opath;
+    std::string filename;
+    std::string username;
+    unsigned int nbIterations = 10;
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username, nbIterations) == false) {
+      exit (-1);
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+
+    // Test if the output path exist. If no try to create it
+    if (vpIoTools::checkDirectory(opath) == false) {
+      try {
+        // Create the dirname
+        vpIoTools::makeDirectory(opath);
+      }
+      catch (...) {
+        usage(argv[0], NULL, opt_opath, username, nbIterations);
+        std::cerr << std::endl
+                  << "ERROR:" << std::endl;
+        std::cerr << "  Cannot create " << opath << std::endl;
+        std::cerr << "  Check your -o " << opt_opath << " option " << std::endl;
+        exit(-1);
+      }
+    }
+
+    // Synthetic 1280x960 color image
+    vpImage<vpRGBa> Icolor(960, 1280);
+    for (unsigned int i = 0; i < Icolor.getHeight(); i++) {
+      for (unsigned int j = 0; j < Icolor.getWidth(); j++) {
+        Icolor[i][j] = vpRGBa((unsigned char)(i+j), (unsigned char)(3*i), (unsigned char)(i*j), vpRGBa::alpha_default);
+      }
+    }
+    vpImage<unsigned char> Igrey;
+    vpImageConvert::convert(Icolor, Igrey);
+
+    std::string filename_ppm = vpIoTools::createFilePath(opath, "performance_io.ppm");
+    std::string filename_pgm = vpIoTools::createFilePath(opath, "performance_io.pgm");
+
+    //
+    // PPM write
+    //
+    double t_pixel = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      writePPM_pixel(Icolor, filename_ppm);
+    t_pixel = vpTime::measureTimeMs() - t_pixel;
+
+    double t_io = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      vpImageIo::writePPM(Icolor, filename_ppm);
+    t_io = vpTime::measureTimeMs() - t_io;
+    std::cout << "writePPM: pixel by pixel " << t_pixel / nbIterations << " ms ; vpImageIo "
+              << t_io / nbIterations << " ms" << std::endl;
+
+    //
+    // PPM read
+    //
+    vpImage<vpRGBa> Icolor_pixel, Icolor_io;
+    t_pixel = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      readPPM_pixel(Icolor_pixel, filename_ppm);
+    t_pixel = vpTime::measureTimeMs() - t_pixel;
+
+    t_io = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      vpImageIo::readPPM(Icolor_io, filename_ppm);
+    t_io = vpTime::measureTimeMs() - t_io;
+    std::cout << "readPPM: pixel by pixel " << t_pixel / nbIterations << " ms ; vpImageIo "
+              << t_io / nbIterations << " ms" << std::endl;
+
+    if (Icolor_pixel != Icolor || Icolor_io != Icolor) {
+      std::cerr << "Problem with PPM read/write" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //
+    // PPM read in a grey level image
+    //
+    vpImage<unsigned char> Igrey_io;
+    t_pixel = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++) {
+      readPPM_pixel(Icolor_pixel, filename_ppm);
+      vpImageConvert::convert(Icolor_pixel, Igrey_io);
+    }
+    t_pixel = vpTime::measureTimeMs() - t_pixel;
+
+    t_io = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      vpImageIo::readPPM(Igrey_io, filename_ppm);
+    t_io = vpTime::measureTimeMs() - t_io;
+    std::cout << "readPPM (grey): pixel by pixel " << t_pixel / nbIterations << " ms ; vpImageIo "
+              << t_io / nbIterations << " ms" << std::endl;
+
+    if (Igrey_io != Igrey) {
+      std::cerr << "Problem with PPM read in a grey level image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //
+    // PGM read in a color image
+    //
+    vpImageIo::writePGM(Igrey, filename_pgm);
+    vpImage<unsigned char> Igrey_tmp;
+    t_pixel = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++) {
+      vpImageIo::readPGM(Igrey_tmp, filename_pgm);
+      vpImageConvert::convert(Igrey_tmp, Icolor_pixel);
+    }
+    t_pixel = vpTime::measureTimeMs() - t_pixel;
+
+    t_io = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < nbIterations; cpt++)
+      vpImageIo::readPGM(Icolor_io, filename_pgm);
+    t_io = vpTime::measureTimeMs() - t_io;
+    std::cout << "readPGM (color): temporary image " << t_pixel / nbIterations << " ms ; vpImageIo "
+              << t_io / nbIterations << " ms" << std::endl;
+
+    if (Icolor_io != Icolor_pixel) {
+      std::cerr << "Problem with PGM read in a color image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    //
+    // 16 bits PGM
+    //
+    vpImage<unsigned short> Idepth(480, 640), Idepth_io;
+    for (unsigned int i = 0; i < Idepth.getSize(); i++)
+      Idepth.bitmap[i] = (unsigned short)(37 * i);
+    std::string filename_pgm16 = vpIoTools::createFilePath(opath, "performance_io_16bits.pgm");
+    vpImageIo::writePGM(Idepth, filename_pgm16);
+    vpImageIo::readPGM(Idepth_io, filename_pgm16);
+    if (Idepth_io != Idepth) {
+      std::cerr << "Problem with 16 bits PGM read/write" << std::endl;
+      return EXIT_FAILURE;
+    }
+    // 8 bits PGM read in a 16 bits image
+    vpImageIo::readPGM(Idepth_io, filename_pgm);
+    for (unsigned int i = 0; i < Igrey.getSize(); i++) {
+      if (Idepth_io.bitmap[i] != Igrey.bitmap[i]) {
+        std::cerr << "Problem with 8 bits PGM read in a 16 bits image" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testPerformanceIoPNM is ok" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,362 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the frame index of vpFFMPEG.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpFFMPEG.h>
+#include <visp3/io/vpParseArgv.h>
+
+#include <cmath>
+#include <fstream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+  \example testVideoFFMPEGIndex.cpp
+
+  \brief Encode a small synthetic video, then check that the frames read
+  with vpFFMPEG::getFrame() in a random order are the ones decoded
+  sequentially, with the index built by vpFFMPEG::initStream() and with the
+  same index saved and reloaded. Check also that corrupted index files are
+  rejected.
+*/
+
+// List of allowed command line options
+#define GETOPTARGS  "cdo:h"
+
+void usage(const char *name, const char *badparam, std::string opath, std::string user)
+{
+  fprintf(stdout, "\n\
+Test the frame index of vpFFMPEG.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output video path>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output video path>                               %s\n\
+     Set video output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the video and its index are written.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+    opath.c_str(), user.c_str());
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'o': opath = optarg_; break;
+    case 'h': usage(argv[0], NULL, opath, user); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, opath, user); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+#if defined(VISP_HAVE_FFMPEG)
+
+/*
+  Compare two images without the verbose vpImage::operator==().
+*/
+bool isEqual(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2)
+{
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth())
+    return false;
+  return memcmp(I1.bitmap, I2.bitmap, I1.getSize()) == 0;
+}
+
+/*
+  The background level of frame k, that identifies the frame after a lossy
+  encoding.
+*/
+unsigned char getLevel(unsigned int k)
+{
+  return (unsigned char)(40 + 4 * k);
+}
+
+/*
+  Mean level of frame k, the white square covering 1/15 of the image.
+*/
+double getExpectedMean(unsigned int k)
+{
+  return (14. * getLevel(k) + 255.) / 15.;
+}
+
+double getMean(const vpImage<unsigned char> &I)
+{
+  double sum = 0;
+  for (unsigned int i = 0; i < I.getSize(); i++)
+    sum += I.bitmap[i];
+  return sum / I.getSize();
+}
+
+/*
+  Read the frames in a random order and compare them with the frames decoded
+  sequentially.
+*/
+bool checkSeek(vpFFMPEG &ffmpeg, const std::vector<vpImage<unsigned char> > &Iseq, const std::string &name)
+{
+  const unsigned int n = (unsigned int)Iseq.size();
+  const unsigned int frames[10] = { n - 1, 5, 5, 6, 0, n / 2, n / 2 + 1, 10, n - 2, 1 };
+  vpImage<unsigned char> I;
+  for (unsigned int k = 0; k < 10; k++) {
+    if (! ffmpeg.getFrame(I, frames[k]) || ! isEqual(I, Iseq[frames[k]])) {
+      std::cerr << name << ": bad frame " << frames[k] << std::endl;
+      return false;
+    }
+  }
+  if (ffmpeg.getFrame(I, n)) {
+    std::cerr << name << ": a frame after the end of the video was read" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/*
+  Write an index file from the lines of a valid one, after applying one of
+  the corruptions and check that it is rejected.
+*/
+bool checkCorruptedIndex(const std::string &videoname, const std::string &indexname,
+                         const std::string &corruptedname, unsigned int corruption)
+{
+  std::ifstream in(indexname.c_str());
+  std::string header;
+  unsigned long n;
+  std::getline(in, header);
+  in >> n;
+  std::vector<long long> ts(n);
+  std::vector<int> keys(n);
+  for (unsigned long i = 0; i < n; i++)
+    in >> ts[i] >> keys[i];
+
+  std::ofstream out(corruptedname.c_str());
+  out << header << std::endl;
+  switch (corruption) {
+  case 0:
+    // Huge number of frames
+    out << 4000000000UL << std::endl;
+    for (unsigned long i = 0; i < n; i++)
+      out << ts[i] << " " << keys[i] << std::endl;
+    break;
+  case 1:
+    // Unsorted timestamps
+    std::swap(ts[n/2], ts[n/2 + 1]);
+    out << n << std::endl;
+    for (unsigned long i = 0; i < n; i++)
+      out << ts[i] << " " << keys[i] << std::endl;
+    break;
+  default:
+    // Truncated file
+    out << n << std::endl;
+    for (unsigned long i = 0; i < n / 2; i++)
+      out << ts[i] << " " << keys[i] << std::endl;
+    break;
+  }
+  out.close();
+
+  vpFFMPEG ffmpeg;
+  ffmpeg.openStream(videoname.c_str(), vpFFMPEG::GRAY_SCALED);
+  if (ffmpeg.loadIndex(corruptedname)) {
+    std::cerr << "Corrupted index " << corruption << " was loaded" << std::endl;
+    return false;
+  }
+  return true;
+}
+#endif
+
+int main(int argc, const char ** argv)
+{
+  try {
+#if defined(VISP_HAVE_FFMPEG)
+    std::string opt_opath;
+    std::string opath;
+    std::string username;
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username) == false) {
+      exit (-1);
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+
+    // Test if the output path exist. If no try to create it
+    if (vpIoTools::checkDirectory(opath) == false) {
+      try {
+        // Create the dirname
+        vpIoTools::makeDirectory(opath);
+      }
+      catch (...) {
+        usage(argv[0], NULL, opt_opath, username);
+        std::cerr << std::endl
+                  << "ERROR:" << std::endl;
+        std::cerr << "  Cannot create " << opath << std::endl;
+        std::cerr << "  Check your -o " << opt_opath << " option " << std::endl;
+        exit(-1);
+      }
+    }
+    std::string videoname = vpIoTools::createFilePath(opath, "video-ffmpeg-index.mpeg");
+    std::string indexname = videoname + ".index";
+    std::string corruptedname = videoname + ".corrupted.index";
+
+    // Encode a video where the background level identifies the frame and a
+    // moving square adds some texture
+    const unsigned int nbFrames = 48;
+    {
+      vpFFMPEG writer;
+      writer.setFramerate(25);
+      if (! writer.openEncoder(videoname.c_str(), 160, 96)) {
+        std::cerr << "Cannot open the encoder" << std::endl;
+        return EXIT_FAILURE;
+      }
+      vpImage<unsigned char> I(96, 160);
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        I = getLevel(k);
+        for (unsigned int i = 32; i < 64; i++)
+          for (unsigned int j = 2 * k; j < 2 * k + 32; j++)
+            I[i][j] = 255;
+        if (! writer.saveFrame(I)) {
+          std::cerr << "Cannot encode frame " << k << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      writer.endWrite();
+    }
+
+    // Index built by browsing the video, frames decoded sequentially
+    std::vector<vpImage<unsigned char> > Iseq;
+    {
+      vpFFMPEG ffmpeg;
+      if (! ffmpeg.openStream(videoname.c_str(), vpFFMPEG::GRAY_SCALED) || ! ffmpeg.initStream()) {
+        std::cerr << "Cannot read " << videoname << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (ffmpeg.getFrameNumber() != nbFrames) {
+        std::cerr << "Bad number of frames " << ffmpeg.getFrameNumber() << std::endl;
+        return EXIT_FAILURE;
+      }
+      vpImage<unsigned char> I;
+      while (ffmpeg.acquire(I))
+        Iseq.push_back(I);
+      if (Iseq.size() != nbFrames) {
+        std::cerr << "Only " << Iseq.size() << " frames were decoded" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        if (std::fabs(getMean(Iseq[k]) - getExpectedMean(k)) > 1.8) {
+          std::cerr << "Frame " << k << " is not the encoded one" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      if (! checkSeek(ffmpeg, Iseq, "Built index"))
+        return EXIT_FAILURE;
+      if (! ffmpeg.saveIndex(indexname)) {
+        std::cerr << "Cannot save the index" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Same frames with the reloaded index
+    {
+      vpFFMPEG ffmpeg;
+      ffmpeg.openStream(videoname.c_str(), vpFFMPEG::GRAY_SCALED);
+      if (! ffmpeg.loadIndex(indexname) || ! ffmpeg.initStream()) {
+        std::cerr << "Cannot load the index" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (ffmpeg.getFrameNumber() != nbFrames) {
+        std::cerr << "Bad number of frames with the loaded index " << ffmpeg.getFrameNumber() << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (! checkSeek(ffmpeg, Iseq, "Loaded index"))
+        return EXIT_FAILURE;
+    }
+
+    // Corrupted index files are rejected
+    for (unsigned int c = 0; c < 3; c++) {
+      if (! checkCorruptedIndex(videoname, indexname, corruptedname, c))
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+#else
+    (void)argc;
+    (void)argv;
+    std::cout << "This test requires FFmpeg" << std::endl;
+#endif
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
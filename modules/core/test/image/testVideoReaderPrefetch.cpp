@@ -0,0 +1,307 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the read-ahead mode of vpVideoReader and vpDiskGrabber.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpIoTools.h>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpDiskGrabber.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/io/vpVideoReader.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+  \example testVideoReaderPrefetch.cpp
+
+  \brief Read an image sequence with and without the read-ahead mode of
+  vpVideoReader and vpDiskGrabber, check that the same images are delivered in
+  the same order, including after a seek, and print the replay time.
+*/
+
+// List of allowed command line options
+#define GETOPTARGS  "cdo:n:t:h"
+
+void usage(const char *name, const char *badparam, std::string opath, std::string user,
+           unsigned int nbImages, unsigned int nbThreads)
+{
+  fprintf(stdout, "\n\
+Test the read-ahead mode of vpVideoReader and vpDiskGrabber.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output image path>] [-n <nb images>] [-t <nb threads>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output image path>                               %s\n\
+     Set image output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the image sequence is written.\n\
+\n\
+  -n <nb images>                                       %u\n\
+     Number of images of the sequence.\n\
+\n\
+  -t <nb threads>                                      %u\n\
+     Number of decoder threads.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+    opath.c_str(), user.c_str(), nbImages, nbThreads);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user,
+                unsigned int &nbImages, unsigned int &nbThreads)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'o': opath = optarg_; break;
+    case 'n': nbImages = (unsigned int) atoi(optarg_); break;
+    case 't': nbThreads = (unsigned int) atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, opath, user, nbImages, nbThreads); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, opath, user, nbImages, nbThreads); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user, nbImages, nbThreads);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/*
+  Compare two images without the verbose vpImage::operator==().
+*/
+template<class Type>
+bool isEqual(const vpImage<Type> &I1, const vpImage<Type> &I2)
+{
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth())
+    return false;
+  return memcmp(I1.bitmap, I2.bitmap, I1.getSize() * sizeof(Type)) == 0;
+}
+
+/*
+  Simulate the processing of an image, e.g. a tracking step.
+*/
+void process(const vpImage<unsigned char> &I)
+{
+  (void)I;
+  vpTime::sleepMs(2);
+}
+
+/*
+  Replay the whole sequence and return false if an image differs from the reference one.
+*/
+bool replay(vpVideoReader &reader, const std::vector<vpImage<unsigned char> > &Iref, double &t)
+{
+  vpImage<unsigned char> I;
+  reader.open(I);
+  t = vpTime::measureTimeMs();
+  while (! reader.end()) {
+    long index = reader.getFrameIndex();
+    reader.acquire(I);
+    if (! isEqual(I, Iref[(size_t)index])) {
+      std::cerr << "Image " << index << " differs from the reference" << std::endl;
+      return false;
+    }
+    process(I);
+  }
+  t = vpTime::measureTimeMs() - t;
+  return true;
+}
+
+int main(int argc, const char ** argv)
+{
+  try {
+    std::string opt_opath;
+    std::string opath;
+    std::string username;
+    unsigned int nbImages = 60;
+    unsigned int nbThreads = 2;
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username, nbImages, nbThreads) == false) {
+      exit (-1);
+    }
+    if (nbImages < 10)
+      nbImages = 10;
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+    opath = vpIoTools::createFilePath(opath, "sequence-prefetch");
+
+    // Remove the images of a previous run that may be longer
+    if (vpIoTools::checkDirectory(opath))
+      vpIoTools::remove(opath);
+
+    // Test if the output path exist. If no try to create it
+    if (vpIoTools::checkDirectory(opath) == false) {
+      try {
+        // Create the dirname
+        vpIoTools::makeDirectory(opath);
+      }
+      catch (...) {
+        usage(argv[0], NULL, opt_opath, username, nbImages, nbThreads);
+        std::cerr << std::endl
+                  << "ERROR:" << std::endl;
+        std::cerr << "  Cannot create " << opath << std::endl;
+        std::cerr << "  Check your -o " << opt_opath << " option " << std::endl;
+        exit(-1);
+      }
+    }
+
+    // Write a synthetic sequence where each image is different
+    std::vector<vpImage<unsigned char> > Iref(nbImages);
+    char name[FILENAME_MAX];
+    for (unsigned int k = 0; k < nbImages; k++) {
+      Iref[k].resize(480, 640);
+      for (unsigned int i = 0; i < Iref[k].getHeight(); i++) {
+        for (unsigned int j = 0; j < Iref[k].getWidth(); j++) {
+          Iref[k][i][j] = (unsigned char)(i + 3*j + 7*k);
+        }
+      }
+      sprintf(name, "%s/I%04u.pgm", opath.c_str(), k);
+      vpImageIo::write(Iref[k], name);
+    }
+    std::string filename = vpIoTools::createFilePath(opath, "I%04d.pgm");
+
+    // Replay without and with the read-ahead mode
+    double t_sync, t_prefetch;
+    {
+      vpVideoReader reader;
+      reader.setFileName(filename);
+      if (! replay(reader, Iref, t_sync))
+        return EXIT_FAILURE;
+    }
+    vpVideoReader reader;
+    reader.setFileName(filename);
+    reader.setPrefetch(nbThreads, 8);
+    if (! replay(reader, Iref, t_prefetch))
+      return EXIT_FAILURE;
+    if (reader.getLastFrameIndex() != (long)nbImages - 1) {
+      std::cerr << "Bad last frame index " << reader.getLastFrameIndex() << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Replay of " << nbImages << " images: " << t_sync << " ms without read-ahead, "
+              << t_prefetch << " ms with " << nbThreads << " decoder threads" << std::endl;
+
+    // Seek backward and forward, acquire() continues after the requested frame
+    vpImage<unsigned char> I;
+    long seek[3] = { 3, (long)nbImages - 4, 0 };
+    for (unsigned int s = 0; s < 3; s++) {
+      if (! reader.getFrame(I, seek[s]) || ! isEqual(I, Iref[(size_t)seek[s]])) {
+        std::cerr << "Bad image after seeking to frame " << seek[s] << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (long k = seek[s] + 1; k < seek[s] + 4; k++) {
+        reader.acquire(I);
+        if (! isEqual(I, Iref[(size_t)k]) || reader.getFrameIndex() != k + 1) {
+          std::cerr << "Bad image " << k << " after seeking to frame " << seek[s] << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Reading after the end of the sequence fails as without read-ahead
+    if (reader.getFrame(I, (long)nbImages + 5)) {
+      std::cerr << "A frame after the end of the sequence was read" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // vpDiskGrabber with a step and color images
+    vpDiskGrabber g(opath.c_str(), "I", 1, 2, 4, "pgm");
+    g.setPrefetch(nbThreads, 4);
+    vpImage<vpRGBa> Ic, Icref;
+    for (long k = 1; k < (long)nbImages; k += 2) {
+      g.acquire(Ic);
+      vpImageConvert::convert(Iref[(size_t)k], Icref);
+      if (! isEqual(Ic, Icref)) {
+        std::cerr << "Bad color image " << k << " with vpDiskGrabber" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    bool end_detected = false;
+    try {
+      g.acquire(Ic);
+    }
+    catch(const vpException &) {
+      end_detected = true;
+    }
+    if (! end_detected) {
+      std::cerr << "vpDiskGrabber did not detect the end of the sequence" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the Kalman filter with independent signals.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKalmanBlockDiagonal.cpp
+
+  \brief Test that filtering independent signals block per block gives the
+  same results than the filtering using the whole matrices.
+*/
+
+#include <visp3/core/vpLinearKalmanFilterInstantiation.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+  bool compare(const vpKalmanFilter &kalman1, const vpKalmanFilter &kalman2, double threshold)
+  {
+    for (unsigned int i = 0; i < kalman1.Xest.getRows(); i++) {
+      if (std::fabs(kalman1.Xest[i] - kalman2.Xest[i]) > threshold * (1 + std::fabs(kalman1.Xest[i]))
+          || std::fabs(kalman1.Xpre[i] - kalman2.Xpre[i]) > threshold * (1 + std::fabs(kalman1.Xpre[i]))) {
+        std::cerr << "Different state " << i << ": " << kalman1.Xest[i] << " " << kalman2.Xest[i] << std::endl;
+        return false;
+      }
+    }
+    for (unsigned int i = 0; i < kalman1.Pest.getRows(); i++) {
+      for (unsigned int j = 0; j < kalman1.Pest.getCols(); j++) {
+        if (std::fabs(kalman1.Pest[i][j] - kalman2.Pest[i][j]) > threshold * (1 + std::fabs(kalman1.Pest[i][j]))) {
+          std::cerr << "Different covariance (" << i << ", " << j << "): " << kalman1.Pest[i][j] << " "
+                    << kalman2.Pest[i][j] << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Block diagonal filter with a state of size 4 and a measure of size 2 per signal
+  void initGenericFilter(vpKalmanFilter &kalman, unsigned int nsignal)
+  {
+    kalman.init(4, 2, nsignal);
+    for (unsigned int i = 0; i < nsignal; i++) {
+      unsigned int s = 4*i, m = 2*i;
+      double dt = 0.04 * (1 + i % 3);
+      for (unsigned int j = 0; j < 4; j++) {
+        kalman.F[s+j][s+j] = 1;
+        kalman.Q[s+j][s+j] = 1e-4 * (1 + j);
+        kalman.Pest[s+j][s+j] = 1e-2;
+      }
+      kalman.F[s][s+1] = dt;
+      kalman.F[s+2][s+3] = dt;
+      kalman.F[s+1][s+3] = 0.1;
+      kalman.Q[s][s+1] = kalman.Q[s+1][s] = 5e-5;
+      kalman.H[m][s] = 1;
+      kalman.H[m+1][s+2] = 1;
+      kalman.H[m+1][s+1] = 0.5;
+      kalman.R[m][m] = kalman.R[m+1][m+1] = 1e-3;
+      kalman.R[m][m+1] = kalman.R[m+1][m] = 2e-4;
+      kalman.Xest[s] = i;
+    }
+  }
+}
+
+int main()
+{
+  try {
+    // Constant acceleration model
+    unsigned int nsignal = 100;
+    unsigned int niter = 10;
+    vpLinearKalmanFilterInstantiation kalman_block, kalman_dense;
+    kalman_block.setStateModel(vpLinearKalmanFilterInstantiation::stateConstAccWithColoredNoise_MeasureVel);
+    kalman_dense.setStateModel(vpLinearKalmanFilterInstantiation::stateConstAccWithColoredNoise_MeasureVel);
+    kalman_dense.setBlockDiagonal(false);
+    if (! kalman_block.isBlockDiagonal()) {
+      std::cerr << "Block diagonal mode should be enabled by default" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpColVector sigma_measure(nsignal, 0.0001);
+    vpColVector sigma_state(kalman_block.getStateSize()*nsignal);
+    for (unsigned int signal = 0; signal < nsignal; signal ++) {
+      sigma_state[3*signal+1] = 0.000001;
+      sigma_state[3*signal+2] = 0.000001;
+    }
+    kalman_block.initFilter(nsignal, sigma_state, sigma_measure, 0.9, 0.2);
+    kalman_dense.initFilter(nsignal, sigma_state, sigma_measure, 0.9, 0.2);
+
+    vpColVector velocity_measure(nsignal);
+    double t_block = 0, t_dense = 0;
+    for (unsigned int iter = 0; iter <= niter; iter++) {
+      for (unsigned int signal = 0; signal < nsignal; signal ++)
+        velocity_measure[signal] = 3 + 2*signal + 0.3*sin(vpMath::rad(360./niter*iter + signal));
+
+      double t = vpTime::measureTimeMs();
+      kalman_block.filter(velocity_measure);
+      t_block += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      kalman_dense.filter(velocity_measure);
+      t_dense += vpTime::measureTimeMs() - t;
+
+      if (! compare(kalman_dense, kalman_block, 1e-6)) {
+        std::cerr << "Constant acceleration model: different results at iteration " << iter << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << "Constant acceleration model with " << nsignal << " signals: " << t_dense / (niter+1)
+              << " ms per iteration with the whole matrices, " << t_block / (niter+1)
+              << " ms per iteration block per block" << std::endl;
+
+    // Generic model with coupled states and measures
+    nsignal = 20;
+    vpKalmanFilter kalman_generic_block, kalman_generic_dense;
+    initGenericFilter(kalman_generic_block, nsignal);
+    initGenericFilter(kalman_generic_dense, nsignal);
+    kalman_generic_block.setBlockDiagonal(true);
+    kalman_generic_block.prediction();
+    kalman_generic_dense.prediction();
+
+    vpColVector z(2*nsignal);
+    for (unsigned int iter = 0; iter < 50; iter++) {
+      for (unsigned int signal = 0; signal < nsignal; signal ++) {
+        z[2*signal] = signal + 0.1*iter + 0.01*cos(0.3*iter);
+        z[2*signal+1] = 0.5*sin(0.1*iter + signal);
+      }
+      kalman_generic_block.filtering(z);
+      kalman_generic_block.prediction();
+      kalman_generic_dense.filtering(z);
+      kalman_generic_dense.prediction();
+
+      if (! compare(kalman_generic_dense, kalman_generic_block, 1e-6)) {
+        std::cerr << "Generic model: different results at iteration " << iter << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // A singular innovation covariance is detected whatever the signal, also
+    // when the signals are filtered in parallel
+    nsignal = 200;
+    for (unsigned int bad = 0; bad < nsignal; bad += 67) {
+      vpKalmanFilter kalman_singular;
+      initGenericFilter(kalman_singular, nsignal);
+      kalman_singular.setBlockDiagonal(true);
+      for (unsigned int j = 0; j < 4; j++)
+        kalman_singular.H[2*bad][4*bad+j] = 0;
+      kalman_singular.R[2*bad][2*bad] = kalman_singular.R[2*bad][2*bad+1] = kalman_singular.R[2*bad+1][2*bad] = 0;
+      kalman_singular.prediction();
+      bool exception = false;
+      try {
+        kalman_singular.filtering(vpColVector(2*nsignal, 1));
+      }
+      catch(const vpException &) {
+        exception = true;
+      }
+      if (! exception) {
+        std::cerr << "Singular innovation covariance of signal " << bad << " not detected" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testKalmanBlockDiagonal is ok" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
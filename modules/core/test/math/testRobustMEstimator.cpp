@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the M-estimator weights.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRobustMEstimator.cpp
+
+  \brief Test the weights computed by vpRobust::MEstimator() against a
+  reference implementation using a full sort, check that the weights of
+  several groups of residues computed at once are the same than the ones
+  computed group per group, and measure the computation time.
+*/
+
+#include <visp3/core/vpRobust.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Residues of a normal distribution with a few outliers
+  void generateResidues(vpColVector &residues, unsigned int seed)
+  {
+    srand(seed);
+    for (unsigned int i = 0; i < residues.getRows(); i++) {
+      double u1 = (rand() + 1.) / (RAND_MAX + 2.), u2 = (rand() + 1.) / (RAND_MAX + 2.);
+      residues[i] = 0.2 * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+      if (rand() % 10 == 0)
+        residues[i] += (rand() % 2 ? 5. : -5.);
+    }
+  }
+
+  double median(std::vector<double> v)
+  {
+    std::sort(v.begin(), v.end());
+    return v[(unsigned int)(ceil(v.size()/2.0))-1];
+  }
+
+  // Reference weights computed from a full sort and the scalar formulas
+  void referenceWeights(vpRobust::vpRobustEstimatorType method, const vpColVector &residues, double threshold,
+                        vpColVector &weights)
+  {
+    std::vector<double> r(residues.data, residues.data + residues.getRows());
+    double med = median(r);
+    std::vector<double> normres(r.size());
+    for (size_t i = 0; i < r.size(); i++)
+      normres[i] = fabs(r[i] - med);
+    double sigma = std::max(1.4826 * median(normres), threshold);
+
+    for (size_t i = 0; i < r.size(); i++) {
+      double x = normres[i] / sigma;
+      switch (method) {
+      case vpRobust::TUKEY:
+        weights[(unsigned int)i] = (x <= 4.6851 && weights[(unsigned int)i] != 0.) ? vpMath::sqr(1 - vpMath::sqr(x / 4.6851)) : 0;
+        break;
+      case vpRobust::CAUCHY:
+        weights[(unsigned int)i] = 1 / (1 + vpMath::sqr(x / 2.3849));
+        break;
+      case vpRobust::HUBER:
+        if (weights[(unsigned int)i] != 0.)
+          weights[(unsigned int)i] = (x <= 1.2107) ? 1 : 1.2107 / x;
+        break;
+      }
+    }
+  }
+
+  bool compare(const vpColVector &w1, const vpColVector &w2, const std::string &name)
+  {
+    for (unsigned int i = 0; i < w1.getRows(); i++) {
+      if (std::fabs(w1[i] - w2[i]) > 1e-12) {
+        std::cerr << name << ": different weight " << i << ": " << w1[i] << " " << w2[i] << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const vpRobust::vpRobustEstimatorType methods[3] = { vpRobust::TUKEY, vpRobust::CAUCHY, vpRobust::HUBER };
+    const char *names[3] = { "Tukey", "Cauchy", "Huber" };
+
+    // Compare with the reference implementation, with odd and even sizes
+    // to check both the SIMD and the scalar code
+    const unsigned int sizes[4] = { 1, 2, 101, 1000 };
+    for (unsigned int s = 0; s < 4; s++) {
+      vpColVector residues(sizes[s]);
+      generateResidues(residues, s);
+      for (unsigned int m = 0; m < 3; m++) {
+        vpRobust robust;
+        robust.setThreshold(0.01);
+        vpColVector weights(sizes[s], 1), weights_ref(sizes[s], 1);
+        if (sizes[s] > 2) {
+          // Previously rejected point
+          weights[1] = weights_ref[1] = 0;
+        }
+        robust.MEstimator(methods[m], residues, weights);
+        referenceWeights(methods[m], residues, 0.01, weights_ref);
+        if (! compare(weights_ref, weights, names[m]))
+          return EXIT_FAILURE;
+      }
+    }
+
+    // Compare the weights computed by groups with the ones computed group per group
+    std::vector<unsigned int> groupSizes;
+    groupSizes.push_back(300);
+    groupSizes.push_back(0);
+    groupSizes.push_back(51);
+    groupSizes.push_back(1000);
+    vpColVector residues(1351);
+    generateResidues(residues, 10);
+    for (unsigned int i = 300; i < 351; i++)
+      residues[i] *= 10;
+    for (unsigned int m = 0; m < 3; m++) {
+      vpRobust robust;
+      robust.setThreshold(0.01);
+      vpColVector weights(residues.getRows(), 1), weights_ref(residues.getRows(), 1);
+      robust.MEstimator(methods[m], residues, groupSizes, weights);
+
+      unsigned int offset = 0;
+      for (size_t g = 0; g < groupSizes.size(); g++) {
+        if (groupSizes[g] == 0)
+          continue;
+        vpColVector r(residues, offset, groupSizes[g]), w(groupSizes[g], 1);
+        vpRobust robust_group;
+        robust_group.setThreshold(0.01);
+        robust_group.MEstimator(methods[m], r, w);
+        weights_ref.insert(offset, w);
+        offset += groupSizes[g];
+      }
+      if (! compare(weights_ref, weights, std::string(names[m]) + " by groups"))
+        return EXIT_FAILURE;
+    }
+
+    // Mismatching sizes should be detected
+    try {
+      vpRobust robust;
+      vpColVector weights(residues.getRows() - 1, 1);
+      robust.MEstimator(vpRobust::TUKEY, residues, groupSizes, weights);
+      std::cerr << "Mismatching sizes not detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+    catch(const vpException &) {
+    }
+
+    // Computation time
+    for (unsigned int n = 1000; n <= 100000; n *= 10) {
+      vpColVector r(n);
+      generateResidues(r, n);
+      vpRobust robust;
+      robust.setThreshold(0.01);
+      unsigned int niter = 1000000 / n;
+      for (unsigned int m = 0; m < 3; m++) {
+        vpColVector weights(n, 1);
+        double t = vpTime::measureTimeMs();
+        for (unsigned int iter = 0; iter < niter; iter++)
+          robust.MEstimator(methods[m], r, weights);
+        t = vpTime::measureTimeMs() - t;
+        std::cout << names[m] << " weights of " << n << " residues: " << t / niter << " ms" << std::endl;
+      }
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
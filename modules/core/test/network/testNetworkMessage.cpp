@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test binary messages exchanged over the loopback interface.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testNetworkMessage.cpp
+
+  Test binary messages containing images and matrices exchanged between a
+  vpServer and a vpClient over the loopback interface.
+*/
+
+#include <iostream>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) && !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpThread.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+const unsigned int nbImages = 100;
+
+struct vpClientArgs {
+  int port;
+  bool success;
+};
+
+void fillImages(vpImage<unsigned char> &I, vpImage<vpRGBa> &Irgba, unsigned int index)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = (unsigned char)(i + j + index);
+    }
+  }
+  for (unsigned int i = 0; i < Irgba.getHeight(); i++) {
+    for (unsigned int j = 0; j < Irgba.getWidth(); j++) {
+      Irgba[i][j] = vpRGBa((unsigned char)i, (unsigned char)j, (unsigned char)index, vpRGBa::alpha_default);
+    }
+  }
+}
+
+vpThread::Return clientFunction(vpThread::Args args)
+{
+  vpClientArgs *clientArgs = static_cast<vpClientArgs *>(args);
+  clientArgs->success = false;
+
+  vpClient client;
+  if (!client.connectToIP("127.0.0.1", (unsigned int)clientArgs->port))
+    return 0;
+
+  vpImage<unsigned char> I(480, 640);
+  vpImage<vpRGBa> Irgba(120, 160);
+  vpMatrix M(3, 5);
+  for (unsigned int i = 0; i < M.size(); i++)
+    M.data[i] = i * 0.5;
+  vpHomogeneousMatrix cMo(0.1, 0.2, 1.0, 0.1, -0.2, 0.3);
+  const char text[] = "tracker status";
+
+  vpNetworkMessage msg("frame");
+  for (unsigned int n = 0; n < nbImages; n++) {
+    fillImages(I, Irgba, n);
+    msg.clear();
+    msg.addImage(I);
+    msg.addImage(Irgba);
+    msg.addMatrix(M);
+    msg.addMatrix(cMo);
+    msg.addData(text, sizeof(text));
+    msg.addData(&n, sizeof(n));
+    if (client.sendMessage(msg) <= 0)
+      return 0;
+  }
+
+  // Wait for the acknowledgement of the server
+  vpNetworkMessage ack;
+  client.setTimeoutSec(5);
+  if (client.receiveMessageFrom(ack, 0) <= 0 || ack.getId() != "ack" || ack.getNumberOfParts() != 1)
+    return 0;
+  unsigned int nbReceived = 0;
+  memcpy(&nbReceived, ack.getData(0), sizeof(nbReceived));
+  clientArgs->success = (nbReceived == nbImages);
+  return 0;
+}
+
+bool checkMessage(const vpNetworkMessage &msg, const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo,
+                  unsigned int n)
+{
+  if (msg.getId() != "frame" || msg.getNumberOfParts() != 6) {
+    std::cerr << "Bad message id or number of parts" << std::endl;
+    return false;
+  }
+
+  vpImage<unsigned char> I_ref(480, 640);
+  vpImage<vpRGBa> Irgba_ref(120, 160), Irgba;
+  fillImages(I_ref, Irgba_ref, n);
+  msg.getImage(1, Irgba);
+  if (I_ref != I || Irgba_ref != Irgba) {
+    std::cerr << "Bad image content in message " << n << std::endl;
+    return false;
+  }
+
+  vpMatrix M;
+  msg.getMatrix(2, M);
+  if (M.getRows() != 3 || M.getCols() != 5 || !vpMath::equal(M[2][4], 7., 1e-12)) {
+    std::cerr << "Bad matrix in message " << n << std::endl;
+    return false;
+  }
+  vpHomogeneousMatrix cMo_ref(0.1, 0.2, 1.0, 0.1, -0.2, 0.3);
+  for (unsigned int i = 0; i < 16; i++) {
+    if (cMo.data[i] != cMo_ref.data[i]) {
+      std::cerr << "Bad homogeneous matrix in message " << n << std::endl;
+      return false;
+    }
+  }
+
+  if (std::string((const char *)msg.getData(4)) != "tracker status" || msg.getPartSize(5) != sizeof(unsigned int)) {
+    std::cerr << "Bad raw data in message " << n << std::endl;
+    return false;
+  }
+  unsigned int index = 0;
+  memcpy(&index, msg.getData(5), sizeof(index));
+  return index == n;
+}
+
+// Frame made of a header and a single part descriptor, as sent by vpNetwork
+std::vector<char> buildFrame(uint32_t magic, uint32_t type, uint32_t rows, uint32_t cols, uint64_t size)
+{
+  uint32_t header[4] = { magic, 0, 1, 0 };
+  uint32_t part[4] = { type, 1, rows, cols };
+  std::vector<char> frame(sizeof(header) + sizeof(part) + sizeof(size) + 64, 0);
+  memcpy(&frame[0], header, sizeof(header));
+  memcpy(&frame[sizeof(header)], part, sizeof(part));
+  memcpy(&frame[sizeof(header) + sizeof(part)], &size, sizeof(size));
+  return frame;
+}
+
+// Send an invalid frame from a raw socket and check that the server rejects
+// it without reading the data and closes the connection
+bool testInvalidFrame(vpServer &serv, const std::vector<char> &frame, const std::string &name)
+{
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)serv.getPort());
+  addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+      || send(fd, &frame[0], frame.size(), 0) != (ssize_t)frame.size()) {
+    std::cerr << name << ": cannot send the frame" << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned int> clients;
+  double t_start = vpTime::measureTimeMs();
+  while (clients.empty() && vpTime::measureTimeMs() - t_start < 2000)
+    serv.checkForActivity(clients, 100);
+  if (clients.empty()) {
+    std::cerr << name << ": the frame was not received" << std::endl;
+    return false;
+  }
+
+  vpImage<unsigned char> I;
+  vpNetworkMessage msg;
+  msg.bindImage(0, I);
+  if (serv.receiveMessageFrom(msg, clients[0]) != -1) {
+    std::cerr << name << ": the frame was not rejected" << std::endl;
+    return false;
+  }
+
+  // The connection is closed on both sides
+  char c;
+  // The unread data of the frame may reset the connection instead of closing it
+  bool closed = (recv(fd, &c, 1, 0) <= 0);
+  close(fd);
+  t_start = vpTime::measureTimeMs();
+  while (serv.getNumberOfClients() > 0 && vpTime::measureTimeMs() - t_start < 2000)
+    serv.checkForActivity(clients, 100);
+  if (! closed || serv.getNumberOfClients() != 0) {
+    std::cerr << name << ": the connection was not closed" << std::endl;
+    return false;
+  }
+  std::cout << name << " rejected" << std::endl;
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    // Let the system choose the port
+    vpServer serv;
+    if (!serv.start())
+      return EXIT_FAILURE;
+
+    vpClientArgs clientArgs;
+    clientArgs.port = serv.getPort();
+    clientArgs.success = false;
+    std::cout << "Server listening on port " << clientArgs.port << std::endl;
+    vpThread clientThread((vpThread::Fn)clientFunction, (vpThread::Args)&clientArgs);
+
+    // The image and the pose are received directly in the destination objects,
+    // the other parts in the internal buffer of the message
+    vpImage<unsigned char> I;
+    vpHomogeneousMatrix cMo;
+    vpNetworkMessage msg;
+    msg.bindImage(0, I);
+    msg.bindMatrix(3, cMo);
+
+    std::vector<unsigned int> clients;
+    unsigned int nbReceived = 0;
+    bool success = true;
+    double t_start = vpTime::measureTimeMs(), t_receive = 0;
+    while (success && nbReceived < nbImages && vpTime::measureTimeMs() - t_start < 10000) {
+      serv.checkForActivity(clients, 100);
+      for (size_t i = 0; i < clients.size(); i++) {
+        double t = vpTime::measureTimeMs();
+        int numbytes = serv.receiveMessageFrom(msg, clients[i]);
+        t_receive += vpTime::measureTimeMs() - t;
+        if (numbytes <= 0) {
+          success = false;
+          break;
+        }
+        if (msg.getData(0) != I.bitmap || msg.getData(3) != cMo.data) {
+          std::cerr << "The bound parts were not received in place" << std::endl;
+          success = false;
+          break;
+        }
+        success = checkMessage(msg, I, cMo, nbReceived);
+        nbReceived++;
+      }
+    }
+    std::cout << "Received " << nbReceived << " messages in " << t_receive << " ms" << std::endl;
+
+    vpNetworkMessage ack("ack");
+    ack.addData(&nbReceived, sizeof(nbReceived));
+    if (serv.getNumberOfClients() > 0)
+      serv.sendMessage(ack);
+
+    clientThread.join();
+
+    if (!success || nbReceived != nbImages || !clientArgs.success) {
+      std::cerr << "Test failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The client is disconnected and removed by the server
+    t_start = vpTime::measureTimeMs();
+    while (serv.getNumberOfClients() > 0 && vpTime::measureTimeMs() - t_start < 2000)
+      serv.checkForActivity(clients, 100);
+    if (serv.getNumberOfClients() != 0) {
+      std::cerr << "The disconnection of the client was not detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Invalid frames
+    const uint32_t magic = 0x4d425056;
+    if (! testInvalidFrame(serv, buildFrame(0x12345678, vpNetworkMessage::PART_DATA, 0, 0, 4), "Bad magic number")
+        || ! testInvalidFrame(serv, buildFrame(magic, vpNetworkMessage::PART_IMAGE, 65536, 65537, (uint64_t)65536 * 65537),
+                              "Image with more than 2^32 pixels")
+        || ! testInvalidFrame(serv, buildFrame(magic, vpNetworkMessage::PART_IMAGE, 480, 640, 100), "Bad image size")
+        || ! testInvalidFrame(serv, buildFrame(magic, vpNetworkMessage::PART_DATA, 0, 0, (uint64_t)1 << 40), "1 TB data part"))
+      return EXIT_FAILURE;
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "This test requires pthread on a UNIX platform." << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpPointCloud deprojection from depth images.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPointCloud.cpp
+
+  \brief Test vpPointCloud deprojection from depth images against a per
+  pixel reference and compare the computation time with the
+  std::vector<vpColVector> representation.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpPointCloud.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpParseArgv.h>
+
+//! List of allowed command line options
+#define GETOPTARGS	"cdhn:"
+
+void usage(const char *name, const char *badparam, unsigned int nbIter);
+bool getOptions(int argc, const char **argv, unsigned int &nbIter);
+
+/*!
+
+Print the program options.
+
+\param name : Program name.
+\param badparam : Bad parameter name.
+\param nbIter : Number of benchmark iterations.
+
+ */
+void usage(const char *name, const char *badparam, unsigned int nbIter)
+{
+  fprintf(stdout, "\n\
+Test vpPointCloud deprojection from depth images.\n\
+\n\
+SYNOPSIS\n\
+  %s [-n <number of iterations>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -n <number of iterations>                            %u\n\
+     Number of iterations used to benchmark the deprojection.\n\
+\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", nbIter);
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param nbIter : Number of benchmark iterations.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv, unsigned int &nbIter)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'n': nbIter = (unsigned int)atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, nbIter); return false; break;
+
+    default:
+      usage(argv[0], optarg_, nbIter); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbIter);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  // Reference deprojection with one vpColVector per point, as done by vpRealSense
+  void deprojectReference(const vpImage<uint16_t> &depth, const vpCameraParameters &cam, float depth_scale,
+                          float max_Z, std::vector<vpColVector> &pointcloud)
+  {
+    vpColVector p3d(4);
+    pointcloud.resize((size_t)depth.getSize());
+    for (unsigned int i = 0; i < depth.getHeight(); i++) {
+      for (unsigned int j = 0; j < depth.getWidth(); j++) {
+        double x = 0., y = 0.;
+        vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+        double Z = depth[i][j] * depth_scale;
+        if (Z <= 0 || Z > max_Z)
+          x = y = Z = 0;
+        p3d[0] = x * Z;
+        p3d[1] = y * Z;
+        p3d[2] = Z;
+        p3d[3] = 1;
+        pointcloud[(size_t)(i*depth.getWidth() + j)] = p3d;
+      }
+    }
+  }
+
+  bool compare(const vpPointCloud &pointcloud, const std::vector<vpColVector> &reference, const std::string &name)
+  {
+    if (pointcloud.size() != reference.size()) {
+      std::cerr << name << ": bad size " << pointcloud.size() << " instead of " << reference.size() << std::endl;
+      return false;
+    }
+    for (unsigned int k = 0; k < pointcloud.size(); k++) {
+      float X, Y, Z;
+      pointcloud.getPoint(k, X, Y, Z);
+      if (fabs(X - reference[k][0]) > 1e-5 || fabs(Y - reference[k][1]) > 1e-5 || fabs(Z - reference[k][2]) > 1e-5) {
+        std::cerr << name << ": point " << k << " is (" << X << ", " << Y << ", " << Z << ") instead of ("
+                  << reference[k][0] << ", " << reference[k][1] << ", " << reference[k][2] << ")" << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    unsigned int nbIter = 20;
+    if (getOptions(argc, argv, nbIter) == false) {
+      exit (-1);
+    }
+
+    // Synthetic depth map in mm with invalid and far pixels. The width is not
+    // a multiple of 4 to test the scalar tail of the vectorized deprojection.
+    const unsigned int height = 241, width = 321;
+    const float depth_scale = 0.001f, max_Z = 3.f;
+    vpImage<uint16_t> depth(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        if ((i + j) % 17 == 0)
+          depth[i][j] = 0;
+        else
+          depth[i][j] = (uint16_t)(500 + (i * 7 + j * 13) % 3000);
+      }
+    }
+
+    vpCameraParameters cam(300., 310., 160.5, 121.);
+    vpCameraParameters cam_dist;
+    cam_dist.initPersProjWithDistortion(300., 310., 160.5, 121., -0.2, 0.2);
+
+    std::vector<vpColVector> reference;
+    vpPointCloud pointcloud;
+
+    // Test deprojection without and with distortion, the second call has to
+    // update the cached normalized coordinates
+    deprojectReference(depth, cam, depth_scale, max_Z, reference);
+    pointcloud.deproject(depth, cam, depth_scale, max_Z);
+    if (! compare(pointcloud, reference, "uint16 depth"))
+      return EXIT_FAILURE;
+    if (pointcloud.getHeight() != height || pointcloud.getWidth() != width || ! pointcloud.isOrganized()) {
+      std::cerr << "Point cloud is not organized as the depth image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    deprojectReference(depth, cam_dist, depth_scale, max_Z, reference);
+    pointcloud.deproject(depth, cam_dist, depth_scale, max_Z);
+    if (! compare(pointcloud, reference, "uint16 depth with distortion"))
+      return EXIT_FAILURE;
+
+    // Same deprojection from the raw depth buffer
+    vpPointCloud pointcloud_buffer;
+    pointcloud_buffer.deproject(depth.bitmap, height, width, cam_dist, depth_scale, max_Z);
+    if (! compare(pointcloud_buffer, reference, "uint16 depth buffer"))
+      return EXIT_FAILURE;
+
+    // Only the undistortion coefficient used by the deprojection changes
+    vpCameraParameters cam_dist2;
+    cam_dist2.initPersProjWithDistortion(300., 310., 160.5, 121., -0.2, 0.1);
+    std::vector<vpColVector> reference_dist2;
+    deprojectReference(depth, cam_dist2, depth_scale, max_Z, reference_dist2);
+    pointcloud_buffer.deproject(depth.bitmap, height, width, cam_dist2, depth_scale, max_Z);
+    if (! compare(pointcloud_buffer, reference_dist2, "uint16 depth buffer with other kdu"))
+      return EXIT_FAILURE;
+
+    unsigned int nbValid = 0;
+    for (size_t k = 0; k < reference.size(); k++) {
+      if (reference[k][2] > 0)
+        nbValid++;
+    }
+    if (pointcloud.getValidPointCount() != nbValid) {
+      std::cerr << "Bad number of valid points: " << pointcloud.getValidPointCount() << " instead of " << nbValid << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Deprojection of " << pointcloud.size() << " pixels gives " << nbValid << " valid points" << std::endl;
+
+    // Test deprojection of a float depth map, -1 and NaN being invalid
+    vpImage<float> depth_float(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        depth_float[i][j] = depth[i][j] ? depth[i][j] * depth_scale : -1.f;
+      }
+    }
+    depth_float[0][5] = sqrtf(-1.f);
+    reference[5][0] = reference[5][1] = reference[5][2] = 0;
+    pointcloud.deproject(depth_float, cam_dist, max_Z);
+    if (! compare(pointcloud, reference, "float depth"))
+      return EXIT_FAILURE;
+
+    // Test conversion to the vpColVector representation
+    std::vector<vpColVector> vec;
+    pointcloud.toVector(vec);
+    for (size_t k = 0; k < vec.size(); k++) {
+      if (vec[k].size() != 4 || std::fabs(vec[k][3] - 1.) > 0) {
+        std::cerr << "Bad homogeneous point " << k << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (! compare(pointcloud, vec, "toVector"))
+      return EXIT_FAILURE;
+
+    // Test colorization with the identity transformation: each valid point
+    // projects back on its pixel in an image of the same size
+    vpImage<vpRGBa> I(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        I[i][j] = vpRGBa((unsigned char)i, (unsigned char)j, (unsigned char)(i + j), vpRGBa::alpha_default);
+      }
+    }
+    pointcloud.deproject(depth, cam, depth_scale, max_Z);
+    pointcloud.colorize(I, cam, vpHomogeneousMatrix());
+    if (! pointcloud.hasColor()) {
+      std::cerr << "Color should be enabled after colorize()" << std::endl;
+      return EXIT_FAILURE;
+    }
+    const vpRGBa *color = pointcloud.getColor();
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        unsigned int k = i*width + j;
+        vpRGBa expected = pointcloud.isValid(k) ? I[i][j] : vpRGBa(0, 0, 0, vpRGBa::alpha_default);
+        if (color[k].R != expected.R || color[k].G != expected.G || color[k].B != expected.B) {
+          std::cerr << "Bad color for pixel (" << i << ", " << j << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // A translation along X moves the points outside of the image on one side
+    vpHomogeneousMatrix cMd(10., 0., 0., 0., 0., 0.);
+    pointcloud.colorize(I, cam, cMd);
+    for (unsigned int k = 0; k < pointcloud.size(); k++) {
+      if (color[k].R != 0 || color[k].G != 0 || color[k].B != 0) {
+        std::cerr << "Point " << k << " should be black" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Benchmark at VGA resolution
+    vpImage<uint16_t> depth_vga(480, 640);
+    for (unsigned int i = 0; i < depth_vga.getHeight(); i++) {
+      for (unsigned int j = 0; j < depth_vga.getWidth(); j++) {
+        depth_vga[i][j] = (uint16_t)(400 + (i * 3 + j * 5) % 4000);
+      }
+    }
+    vpCameraParameters cam_vga(525., 525., 320., 240.);
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nbIter; iter++) {
+      std::vector<vpColVector> pc;
+      deprojectReference(depth_vga, cam_vga, depth_scale, 5.f, pc);
+    }
+    double t_vector = (vpTime::measureTimeMs() - t) / nbIter;
+
+    vpPointCloud pc_vga;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nbIter; iter++) {
+      pc_vga.deproject(depth_vga, cam_vga, depth_scale, 5.f);
+    }
+    double t_pointcloud = (vpTime::measureTimeMs() - t) / nbIter;
+
+    std::cout << "Deprojection of a 640x480 depth image: " << std::endl;
+    std::cout << "  std::vector<vpColVector>: " << t_vector << " ms" << std::endl;
+    std::cout << "  vpPointCloud:             " << t_pointcloud << " ms" << std::endl;
+
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
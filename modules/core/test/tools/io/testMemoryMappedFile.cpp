@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the memory mapping of a file.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMemoryMappedFile.cpp
+
+  \brief Test the memory mapping of a file with vpMemoryMappedFile.
+*/
+
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string opath = "C:/temp";
+#else
+    std::string opath = "/tmp";
+#endif
+    opath = vpIoTools::createFilePath(opath, vpIoTools::getUserName());
+    if (! vpIoTools::checkDirectory(opath))
+      vpIoTools::makeDirectory(opath);
+    std::string filename = vpIoTools::createFilePath(opath, "testMemoryMappedFile.bin");
+
+    std::vector<float> data(100000);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = (float)i * 0.5f;
+    {
+      std::ofstream file(filename.c_str(), std::ofstream::binary);
+      file.write(reinterpret_cast<const char *>(&data[0]), (std::streamsize)(data.size() * sizeof(float)));
+    }
+
+    {
+      vpMemoryMappedFile mapped(filename);
+      if (! mapped.isOpen() || mapped.getSize() != data.size() * sizeof(float)) {
+        std::cerr << "Bad size of the mapped file" << std::endl;
+        return EXIT_FAILURE;
+      }
+      // The data is aligned and can be used in place
+      float *values = reinterpret_cast<float *>(mapped.getData());
+      for (size_t i = 0; i < data.size(); i++) {
+        if (values[i] != data[i]) {
+          std::cerr << "Bad value " << values[i] << " at index " << i << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      // The modifications in memory are not written in the file
+      values[0] = -1.f;
+      std::cout << "File mapped in memory: " << (mapped.isMapped() ? "yes" : "no") << std::endl;
+    }
+
+    vpMemoryMappedFile mapped;
+    mapped.open(filename);
+    if (reinterpret_cast<const float *>(mapped.getData())[0] != 0.f) {
+      std::cerr << "The file has been modified" << std::endl;
+      return EXIT_FAILURE;
+    }
+    mapped.close();
+    if (mapped.isOpen() || mapped.getData() != NULL) {
+      std::cerr << "The file is not closed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Empty file
+    {
+      std::ofstream file(filename.c_str(), std::ofstream::binary);
+    }
+    mapped.open(filename);
+    if (! mapped.isOpen() || mapped.getSize() != 0 || mapped.getData() != NULL) {
+      std::cerr << "Bad mapping of an empty file" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpIoTools::remove(filename);
+
+    // Missing file
+    bool exception = false;
+    try {
+      mapped.open(filename);
+    }
+    catch(const vpException &) {
+      exception = true;
+    }
+    if (! exception) {
+      std::cerr << "Opening a missing file should fail" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
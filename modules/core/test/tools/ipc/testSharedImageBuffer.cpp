@@ -0,0 +1,236 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test images exchanged between processes through a shared memory ring buffer.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testSharedImageBuffer.cpp
+
+  Test images published by a producer process and read by a consumer process
+  through a vpSharedImageBuffer.
+*/
+
+#include <iostream>
+#include <sstream>
+
+#include <visp3/core/vpConfig.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <visp3/core/vpSharedImageBuffer.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+const unsigned int nbFrames = 200;
+
+// The content of a frame depends on its sequence number
+void fillBitmap(vpRGBa *bitmap, unsigned int height, unsigned int width, uint64_t sequence)
+{
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      bitmap[i * width + j] =
+          vpRGBa((unsigned char)sequence, (unsigned char)i, (unsigned char)j, (unsigned char)(sequence >> 8));
+    }
+  }
+}
+
+bool checkImage(const vpImage<vpRGBa> &I, uint64_t sequence)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      const vpRGBa &v = I[i][j];
+      if (v.R != (unsigned char)sequence || v.G != (unsigned char)i || v.B != (unsigned char)j ||
+          v.A != (unsigned char)(sequence >> 8))
+        return false;
+    }
+  }
+  return true;
+}
+
+int consumer(const std::string &name)
+{
+  vpSharedImageBuffer buffer;
+  buffer.open(name);
+  if (buffer.isProducer() || buffer.getWidth() != 640 || buffer.getHeight() != 480) {
+    std::cerr << "Bad shared buffer parameters" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vpSharedImageView<vpRGBa> view;
+  vpImage<vpRGBa> I;
+  uint64_t last = 0, sequence = 0;
+  double timestamp = 0, latency = 0;
+  unsigned int nbReceived = 0, nbOverwritten = 0;
+  while (last < nbFrames && buffer.waitForFrame(last, 5000)) {
+    if (!buffer.getView(view) || view.getSequence() <= last) {
+      std::cerr << "Cannot get the new frame" << std::endl;
+      return EXIT_FAILURE;
+    }
+    latency += vpTime::measureTimeMs() - view.getTimestamp();
+    bool ok = checkImage(view.getImage(), view.getSequence());
+    if (!buffer.isValid(view)) {
+      nbOverwritten++; // The content may be mixed with a newer frame
+    } else if (!ok) {
+      std::cerr << "Bad content in view of frame " << view.getSequence() << std::endl;
+      return EXIT_FAILURE;
+    }
+    last = view.getSequence();
+    nbReceived++;
+
+    // A copy is always consistent
+    if (!buffer.getFrame(I, sequence, timestamp) || sequence < last || !checkImage(I, sequence)) {
+      std::cerr << "Bad content in copy of frame " << sequence << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::cout << "Consumer received " << nbReceived << " frames, " << nbOverwritten
+            << " views overwritten during their processing, mean hand-off latency "
+            << latency / nbReceived << " ms" << std::endl;
+
+  // Trying to read the frames with another pixel type is an error
+  try {
+    vpImage<unsigned char> Ig;
+    buffer.getFrame(Ig, sequence, timestamp);
+    std::cerr << "Reading unsigned char images from a vpRGBa buffer should throw" << std::endl;
+    return EXIT_FAILURE;
+  } catch (const vpException &) {
+  }
+
+  return last == nbFrames ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+}
+
+int main()
+{
+  try {
+    std::ostringstream ss;
+    ss << "/visp_testSharedImageBuffer_" << getpid();
+    std::string name = ss.str();
+
+    vpSharedImageBuffer buffer;
+    buffer.create<vpRGBa>(name, 480, 640, 4);
+    if (!buffer.isProducer() || buffer.getLastSequence() != 0) {
+      std::cerr << "Bad initial state" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cerr << "Cannot fork the consumer process" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+      int status = EXIT_FAILURE;
+      try {
+        status = consumer(name);
+      } catch (const vpException &e) {
+        std::cerr << "Consumer catch an exception: " << e << std::endl;
+      }
+      _exit(status);
+    }
+
+    // Producer: half of the frames are copied, the other half written in place
+    vpImage<vpRGBa> I(480, 640);
+    double t_publish = 0;
+    for (unsigned int n = 1; n <= nbFrames; n++) {
+      if (n % 2) {
+        fillBitmap(I.bitmap, I.getHeight(), I.getWidth(), n);
+        double t = vpTime::measureTimeMs();
+        buffer.publish(I, t);
+        t_publish += vpTime::measureTimeMs() - t;
+      } else {
+        vpRGBa *slot = static_cast<vpRGBa *>(buffer.beginPublish());
+        fillBitmap(slot, buffer.getHeight(), buffer.getWidth(), n);
+        buffer.endPublish(vpTime::measureTimeMs());
+      }
+      vpTime::sleepMs(1);
+    }
+    std::cout << "Producer published " << buffer.getLastSequence() << " frames, mean copy time "
+              << t_publish / (nbFrames / 2) << " ms" << std::endl;
+
+    int status = EXIT_FAILURE;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+      std::cerr << "The consumer failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Creating again a segment with the same name while it is opened by a
+    // consumer must not resize the mapped segment
+    {
+      vpSharedImageBuffer reader;
+      reader.open(name);
+      vpSharedImageBuffer producer;
+      producer.create<unsigned char>(name, 10, 20, 2);
+      vpImage<vpRGBa> Ic;
+      uint64_t sequence = 0;
+      double timestamp = 0;
+      if (!reader.getFrame(Ic, sequence, timestamp) || sequence != nbFrames || !checkImage(Ic, sequence)) {
+        std::cerr << "The former segment was modified by the new producer" << std::endl;
+        return EXIT_FAILURE;
+      }
+      vpSharedImageBuffer newReader;
+      newReader.open(name);
+      if (newReader.getHeight() != 10 || newReader.getWidth() != 20 || newReader.getLastSequence() != 0) {
+        std::cerr << "The new segment was not created" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // Closing the former producer doesn't remove the new segment
+      buffer.close();
+      vpSharedImageBuffer lateReader;
+      lateReader.open(name);
+      if (lateReader.getHeight() != 10) {
+        std::cerr << "The new segment was removed by the former producer" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "Shared memory image buffers are only available on UNIX." << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Offscreen display that renders the overlay in an image.
+ *
+ *****************************************************************************/
+
+#ifndef vpDisplayOffscreen_h
+#define vpDisplayOffscreen_h
+
+/*!
+  \file vpDisplayOffscreen.h
+  \brief Display without window that renders images and overlay primitives in memory.
+*/
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRect.h>
+
+/*!
+  \class vpDisplayOffscreen
+
+  \ingroup group_gui_display
+
+  \brief Display device without window nor X server that renders the
+  displayed image and the overlay in a vpImage<vpRGBa>.
+
+  This display can be used everywhere a vpDisplayX, vpDisplayGTK or
+  vpDisplayOpenCV is used, for example to draw tracking results with the
+  static vpDisplay functions on a headless computer. The displayed image
+  and the lines, circles, crosses, arrows, rectangles, points and text
+  drawn in the overlay are rasterized by software directly in an RGBa
+  image, the canvas, that is available with getCanvas() without any copy,
+  or with vpDisplay::getImage().
+
+  Anti-aliasing of lines and circles can be enabled with setAntialiasing().
+  Text is drawn with a built-in 8 by 8 pixels bitmap font; setFont() has no
+  effect. Since there is no window, getClick(), getKeyboardEvent() and the
+  other event functions never block and always return false.
+
+  Besides the vpDisplay functions, displayLines(), displayPoints(),
+  displayCrosses() and displayPolygon() draw a set of primitives with a
+  single call.
+
+  The following example shows how to record annotated images without any
+  display server:
+  \code
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/gui/vpDisplayOffscreen.h>
+#include <visp3/io/vpImageIo.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640, 128);
+  vpDisplayOffscreen d(I);
+  d.setAntialiasing(true);
+
+  vpDisplay::display(I);
+  vpDisplay::displayCross(I, vpImagePoint(240, 320), 20, vpColor::red, 2);
+  vpDisplay::displayCircle(I, vpImagePoint(240, 320), 100, vpColor::green);
+  vpDisplay::displayText(I, vpImagePoint(20, 20), "Frame 0", vpColor::yellow);
+  vpDisplay::flush(I);
+
+  vpImageIo::write(d.getCanvas(), "annotated.ppm");
+}
+  \endcode
+*/
+class VISP_EXPORT vpDisplayOffscreen: public vpDisplay
+{
+private:
+  vpImage<vpRGBa> m_canvas; // Displayed image with the overlay
+  bool m_antialiasing;
+
+public:
+  vpDisplayOffscreen();
+  vpDisplayOffscreen(int winx, int winy, const std::string &title="");
+  vpDisplayOffscreen(vpImage<unsigned char> &I, vpScaleType type);
+  vpDisplayOffscreen(vpImage<unsigned char> &I, int winx=-1, int winy=-1, const std::string &title="", vpScaleType type=SCALE_DEFAULT);
+  vpDisplayOffscreen(vpImage<vpRGBa> &I, vpScaleType type);
+  vpDisplayOffscreen(vpImage<vpRGBa> &I, int winx=-1, int winy=-1, const std::string &title="", vpScaleType type=SCALE_DEFAULT);
+
+  virtual ~vpDisplayOffscreen();
+
+  void displayCrosses(const std::vector<vpImagePoint> &ips, unsigned int size,
+                      const vpColor &color, unsigned int thickness=1);
+  void displayLines(const std::vector<vpImagePoint> &ips, const vpColor &color, unsigned int thickness=1);
+  void displayPoints(const std::vector<vpImagePoint> &ips, const vpColor &color, unsigned int thickness=1);
+  void displayPolygon(const std::vector<vpImagePoint> &ips, const vpColor &color,
+                      bool fill=false, unsigned int thickness=1);
+
+  /*!
+    Return true if lines and circles are drawn with anti-aliasing.
+  */
+  inline bool getAntialiasing() const { return m_antialiasing; }
+  /*!
+    Return the image in which the displayed image and the overlay are
+    rendered. Its size is the size of the displayed image divided by the
+    down scaling factor.
+  */
+  inline const vpImage<vpRGBa> &getCanvas() const { return m_canvas; }
+  /*!
+    Return the image in which the displayed image and the overlay are
+    rendered. Its size is the size of the displayed image divided by the
+    down scaling factor.
+  */
+  inline vpImage<vpRGBa> &getCanvas() { return m_canvas; }
+  void getImage(vpImage<vpRGBa> &I);
+  unsigned int getScreenHeight();
+  void getScreenSize(unsigned int &width, unsigned int &height);
+  unsigned int getScreenWidth();
+
+  void init(vpImage<unsigned char> &I, int winx=-1, int winy=-1, const std::string &title="");
+  void init(vpImage<vpRGBa> &I, int winx=-1, int winy=-1, const std::string &title="");
+  void init(unsigned int width, unsigned int height, int winx=-1, int winy=-1, const std::string &title="");
+
+  /*!
+    Enable or disable the anti-aliasing of lines and circles. Anti-aliasing
+    is disabled by default.
+  */
+  inline void setAntialiasing(bool antialiasing) { m_antialiasing = antialiasing; }
+
+protected:
+  void clearDisplay(const vpColor &color=vpColor::white);
+
+  void closeDisplay();
+
+  void displayArrow(const vpImagePoint &ip1, const vpImagePoint &ip2,
+                    const vpColor &color=vpColor::white, unsigned int w=4, unsigned int h=2,
+                    unsigned int thickness=1);
+
+  void displayCharString(const vpImagePoint &ip, const char *text,
+                         const vpColor &color=vpColor::green);
+
+  void displayCircle(const vpImagePoint &center, unsigned int radius,
+                     const vpColor &color, bool fill = false, unsigned int thickness=1);
+  void displayCross(const vpImagePoint &ip, unsigned int size,
+                    const vpColor &color, unsigned int thickness=1);
+  void displayDotLine(const vpImagePoint &ip1, const vpImagePoint &ip2,
+                      const vpColor &color, unsigned int thickness=1);
+
+  void displayImage(const vpImage<unsigned char> &I);
+  void displayImage(const vpImage<vpRGBa> &I);
+
+  void displayImageROI(const vpImage<unsigned char> &I, const vpImagePoint &iP, const unsigned int width, const unsigned int height);
+  void displayImageROI(const vpImage<vpRGBa> &I, const vpImagePoint &iP, const unsigned int width, const unsigned int height);
+
+  void displayLine(const vpImagePoint &ip1, const vpImagePoint &ip2,
+                   const vpColor &color, unsigned int thickness=1);
+  void displayPoint(const vpImagePoint &ip, const vpColor &color, unsigned int thickness=1);
+
+  void displayRectangle(const vpImagePoint &topLeft, unsigned int width, unsigned int height,
+                        const vpColor &color, bool fill = false, unsigned int thickness=1);
+  void displayRectangle(const vpImagePoint &topLeft, const vpImagePoint &bottomRight,
+                        const vpColor &color, bool fill = false, unsigned int thickness=1);
+  void displayRectangle(const vpRect &rectangle, const vpColor &color, bool fill = false,
+                        unsigned int thickness=1);
+
+  void flushDisplay();
+  void flushDisplayROI(const vpImagePoint &iP, const unsigned int width, const unsigned int height);
+
+  bool getClick(bool blocking=true);
+  bool getClick(vpImagePoint &ip, bool blocking=true);
+  bool getClick(vpImagePoint &ip, vpMouseButton::vpMouseButtonType& button, bool blocking=true);
+  bool getClickUp(vpImagePoint &ip, vpMouseButton::vpMouseButtonType& button, bool blocking=true);
+
+  bool getKeyboardEvent(bool blocking=true);
+  bool getKeyboardEvent(std::string &key, bool blocking=true);
+
+  bool getPointerMotionEvent(vpImagePoint &ip);
+  bool getPointerPosition(vpImagePoint &ip);
+
+  void setFont(const std::string &font);
+  void setTitle(const std::string &title);
+  void setWindowPosition(int winx, int winy);
+
+private:
+  void checkInitialized() const;
+  void drawCircle(double u, double v, double radius, const vpColor &color, bool fill, unsigned int thickness);
+  void drawSegment(double u1, double v1, double u2, double v2, const vpColor &color, unsigned int thickness);
+  void drawText(int u, int v, const char *text, const vpColor &color);
+  void fillPolygon(const std::vector<double> &u, const std::vector<double> &v, const vpColor &color);
+  void fillRectangle(int u, int v, int w, int h, const vpColor &color);
+};
+
+#endif
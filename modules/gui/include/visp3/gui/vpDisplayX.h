@@ -46,6 +46,11 @@
 //{
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#ifdef VISP_HAVE_X11_XSHM
+#  include <sys/ipc.h>
+#  include <sys/shm.h>
+#  include <X11/extensions/XShm.h>
+#endif
 //#include <X11/Xatom.h>
 //#include <X11/cursorfont.h>
 //} ;
@@ -57,6 +62,9 @@
 #  undef Success // See http://eigen.tuxfamily.org/bz/show_bug.cgi?id=253
 #endif
 
+#include <map>
+#include <vector>
+
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpRect.h>
 
@@ -81,6 +89,16 @@
   It also define method to display some geometric feature (point, line, circle)
   in the image.
 
+  When the X server runs on the local host and supports the MIT-SHM
+  extension, images are transferred to the server through shared memory
+  rather than through the X protocol.
+
+  Lines (and thus crosses and arrows) and points drawn in the overlay are
+  buffered and sent with a single request per color and thickness when the
+  display is flushed, or before any other kind of drawing. Overlapping lines
+  or points of different colors may thus be stacked in a different order than
+  the order in which they were drawn.
+
   The example below shows how to display an image with this video device.
   \code
 #include <visp3/core/vpConfig.h>
@@ -169,6 +187,21 @@ private:
   bool ximage_data_init;
   unsigned int RMask, GMask, BMask;
   int RShift, GShift, BShift;
+#ifdef VISP_HAVE_X11_XSHM
+  XShmSegmentInfo m_shmInfo;
+#endif
+  bool m_useShm; // Ximage data is shared with the X server
+  bool m_shmPutPending; // A shared memory transfer may still read Ximage data
+  std::map<unsigned int, unsigned long> m_colorCache; // RGB color to X pixel value
+  // Overlay primitives with the same color and thickness sent in one request
+  struct vpPrimitiveBatch {
+    unsigned long pixel;
+    unsigned int thickness;
+    std::vector<XSegment> segments;
+    std::vector<XPoint> points;
+    std::vector<XRectangle> rectangles;
+  };
+  std::vector<vpPrimitiveBatch> m_batches;
 
   //private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -260,6 +293,16 @@ protected:
   void setFont(const std::string &font);
   void setTitle(const std::string &title) ;
   void setWindowPosition(int winx, int winy);
+
+private:
+  void discardBatches();
+  void flushBatches();
+  vpPrimitiveBatch &getBatch(unsigned long pixel, unsigned int thickness);
+  unsigned long getXColor(const vpColor &color);
+  void initXImage();
+  void putImage(int src_x, int src_y, int dst_x, int dst_y, unsigned int w, unsigned int h);
+  void releaseXImage();
+  void syncXImage();
 } ; 
 
 #endif
@@ -45,8 +45,12 @@
 
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpMutex.h>
+#include <visp3/core/vpThread.h>
 #include <visp3/gui/vpPlotGraph.h>
 
+#include <vector>
+
 /*!
   \class vpPlot
   \ingroup group_gui_plotter
@@ -106,6 +110,37 @@ int main ()
 #endif
 }
   \endcode
+
+  By default all the points given to plot() are kept, to be redrawn when the
+  range of a graphic changes and to be saved by saveData(). For plots that
+  run for hours, setMaxPoints() bounds the number of points kept per curve:
+  the most recent ones are stored in a ring buffer of fixed size. When a 2D
+  graphic is redrawn, consecutive points that fall in the same pixel column
+  are reduced to a vertical segment, so that the redraw cost depends on the
+  width of the graphic rather than on the number of points.
+
+  setAsync() moves the drawing of the 2D curves to a background thread:
+  plot() then only queues the point and returns, and the queued points are
+  drawn about every 10 ms. The other methods of the class first draw the
+  queued points, so that they can still be called from the main thread. In
+  that mode, the public image \e I should not be accessed directly. With X11,
+  if other windows are displayed by the main thread, XInitThreads() has to be
+  called at the beginning of the program when the X11 library does not do it
+  itself.
+
+  \code
+  vpPlot plotter(2, 700, 700, 100, 200, "Servo");
+  plotter.initGraph(0, 6); // Velocities
+  plotter.initGraph(1, 8); // Visual features error
+  plotter.setMaxPoints(0, 100000);
+  plotter.setMaxPoints(1, 100000);
+  plotter.setAsync(true);
+  for (unsigned int iter = 0; ; iter++) {
+    // ... compute v and e
+    plotter.plot(0, iter, v); // Returns immediately
+    plotter.plot(1, iter, e);
+  }
+  \endcode
 */
 
 #if defined(VISP_HAVE_DISPLAY)
@@ -126,6 +161,23 @@ class VISP_EXPORT vpPlot
     
     float factori;
     float factorj;
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    struct vpPendingPoint {
+      unsigned int graphNum;
+      unsigned int curveNum;
+      double x;
+      double y;
+    };
+#endif
+    std::vector<vpPendingPoint> m_pending; // Points queued by plot() in asynchronous mode
+    std::vector<vpPendingPoint> m_plotting; // Points being drawn
+    vpMutex m_pendingMutex; // Protects m_pending
+    vpMutex m_plotMutex; // Held while drawing
+    vpThread *m_thread;
+    bool m_stop;
+#endif
     
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -172,29 +224,40 @@ public:
     void resetPointList (const unsigned int graphNum, const unsigned int curveNum);
 
     void saveData(const unsigned int graphNum, const std::string &dataFile, const std::string &title_prefix="");
+    void setAsync(const bool async);
     void setColor (const unsigned int graphNum, const unsigned int curveNum, vpColor color);
     void setGraphThickness (const unsigned int graphNum, const unsigned int thickness);
     void setGridThickness (const unsigned int graphNum, const unsigned int thickness);
-    /*!
-      Set the font of the characters. The display should be initialized before.
-
-      To know which font are available, on Unix you can use xfontsel or xlsfonts utilities.
-      */
-    void setFont(const std::string &font)
-    {
-      if (display->isInitialised())
-        vpDisplay::setFont(I, font.c_str());
-    }
+    void setFont(const std::string &font);
     void setLegend (const unsigned int graphNum, const unsigned int curveNum, const std::string &legend);
     void setTitle (const unsigned int graphNum, const std::string &title);
     void setUnitX (const unsigned int graphNum, const std::string &unitx);
     void setUnitY (const unsigned int graphNum, const std::string &unity);
     void setUnitZ (const unsigned int graphNum, const std::string &unitz);
+    void setMaxPoints (const unsigned int graphNum, const unsigned int maxPoints);
     void setThickness (const unsigned int graphNum, const unsigned int curveNum, const unsigned int thickness);
     
   private:
     void initNbGraph (unsigned int nbGraph);
     void displayGrid();
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    // Gives the caller access to the graphics while the background thread
+    // started by setAsync() is running
+    class vpPlotLock {
+    public:
+      explicit vpPlotLock(vpPlot &plot);
+      ~vpPlotLock();
+    private:
+      vpPlot &m_plot;
+      vpPlotLock &operator=(const vpPlotLock &);
+    };
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+    void plotPending();
+    static vpThread::Return plotThread(vpThread::Args args);
+#endif
+#endif
 };
 #endif
 
@@ -49,7 +49,7 @@
 #include <visp3/core/vpCameraParameters.h>
 #include <visp3/core/vpPoint.h>
 
-#include <list>
+#include <vector>
 
 #if defined(VISP_HAVE_DISPLAY)
 
@@ -62,7 +62,7 @@ typedef enum
   marker
 } vpCurveStyle;
 
-class vpPlotCurve
+class VISP_EXPORT vpPlotCurve
 {
   public:
     vpColor color;
@@ -71,11 +71,13 @@ class vpPlotCurve
     //vpMarkerStyle markerStyle;
     //char lineStyle[20];
     //vpList<vpImagePoint> pointList;
-    unsigned int nbPoint;
+    unsigned int nbPoint; // Number of stored points
+    unsigned int maxPoint; // Capacity of the ring buffer, 0 if unbounded
+    unsigned int startPoint; // Index of the oldest stored point
     vpImagePoint lastPoint;
-    std::list<double> pointListx;
-    std::list<double> pointListy;
-    std::list<double> pointListz;
+    std::vector<double> pointListx;
+    std::vector<double> pointListy;
+    std::vector<double> pointListz;
     std::string legend;
     double xmin;
     double xmax;
@@ -85,8 +87,23 @@ class vpPlotCurve
   public:
     vpPlotCurve();
     ~vpPlotCurve();
+    void addPoint(const double x, const double y, const double z);
+    void clearPointList();
+    /*!
+      Get the point \e k, 0 being the oldest stored point.
+    */
+    inline void getPoint(const unsigned int k, double &x, double &y, double &z) const
+    {
+      unsigned int index = startPoint + k;
+      if (index >= nbPoint)
+        index -= nbPoint;
+      x = pointListx[index];
+      y = pointListy[index];
+      z = pointListz[index];
+    }
     void plotPoint(const vpImage<unsigned char> &I, const vpImagePoint &iP, const double x, const double y);
     void plotList(const vpImage<unsigned char> &I, const double xorg, const double yorg, const double zoomx, const double zoomy);
+    void setMaxPoint(const unsigned int n);
 };
 
 #endif
@@ -0,0 +1,1221 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Offscreen display that renders the overlay in an image.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDisplayOffscreen.cpp
+  \brief Display without window that renders images and overlay primitives in memory.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <visp3/core/vpDisplayException.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/gui/vpDisplayOffscreen.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  // 8x8 bitmap font of the printable ASCII characters (public domain
+  // font8x8_basic). Each byte is a row, the least significant bit is the
+  // leftmost pixel.
+  const unsigned char vp_font8x8[95][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // '!'
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 }, // '#'
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 }, // '$'
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 }, // '%'
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 }, // '&'
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '''
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 }, // '('
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 }, // ')'
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // '*'
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 }, // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ','
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 }, // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // '.'
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 }, // '/'
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 }, // '0'
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 }, // '1'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 }, // '2'
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 }, // '3'
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 }, // '4'
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 }, // '5'
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 }, // '6'
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 }, // '7'
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 }, // '8'
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 }, // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // ';'
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 }, // '<'
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 }, // '='
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // '>'
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 }, // '?'
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 }, // '@'
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 }, // 'A'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 }, // 'B'
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 }, // 'C'
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 }, // 'D'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 }, // 'E'
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 }, // 'F'
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 }, // 'G'
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 }, // 'H'
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'I'
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 }, // 'J'
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 }, // 'K'
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 }, // 'L'
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 }, // 'M'
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 }, // 'N'
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 }, // 'O'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 }, // 'P'
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 }, // 'Q'
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 }, // 'R'
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 }, // 'S'
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'T'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 }, // 'U'
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'V'
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 }, // 'W'
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 }, // 'X'
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 }, // 'Y'
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 }, // 'Z'
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 }, // '['
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 }, // '\'
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 }, // ']'
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // '_'
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '`'
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 }, // 'a'
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 }, // 'b'
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 }, // 'c'
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 }, // 'd'
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 }, // 'e'
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 }, // 'f'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'g'
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 }, // 'h'
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'i'
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E }, // 'j'
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 }, // 'k'
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // 'l'
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 }, // 'm'
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 }, // 'n'
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 }, // 'o'
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F }, // 'p'
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 }, // 'q'
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 }, // 'r'
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 }, // 's'
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 }, // 't'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 }, // 'u'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // 'v'
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 }, // 'w'
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 }, // 'x'
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // 'y'
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 }, // 'z'
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 }, // '{'
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // '|'
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 }, // '}'
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }  // '~'
+  };
+
+  // Blend color in pixel (u,v) with the opacity alpha in [0,1]
+  inline void vp_blend(vpImage<vpRGBa> &I, int u, int v, const vpColor &color, float alpha)
+  {
+    if (u < 0 || v < 0 || u >= (int)I.getWidth() || v >= (int)I.getHeight() || alpha <= 0.f)
+      return;
+
+    vpRGBa &dst = I.bitmap[(unsigned int)v * I.getWidth() + (unsigned int)u];
+    if (alpha >= 1.f) {
+      dst.R = color.R;
+      dst.G = color.G;
+      dst.B = color.B;
+    }
+    else {
+      unsigned int a = (unsigned int)(alpha * 256.f + 0.5f);
+      unsigned int na = 256 - a;
+      dst.R = (unsigned char)((dst.R * na + color.R * a) >> 8);
+      dst.G = (unsigned char)((dst.G * na + color.G * a) >> 8);
+      dst.B = (unsigned char)((dst.B * na + color.B * a) >> 8);
+    }
+  }
+
+  // Coordinates are clamped to [-vp_coordinate_max, vp_coordinate_max] before
+  // being converted to int: far outside the canvas, they neither overflow int
+  // nor change what is drawn. Non finite coordinates are sent outside the
+  // canvas.
+  const double vp_coordinate_max = 16777216.; // 2^24
+
+  inline double vp_clamp(double x)
+  {
+    if (! (x >= -vp_coordinate_max)) // Also true for NaN
+      return -vp_coordinate_max;
+    return (x > vp_coordinate_max) ? vp_coordinate_max : x;
+  }
+
+  inline int vp_round(double x) { return vpMath::round(vp_clamp(x)); }
+  inline int vp_floor(double x) { return (int)floor(vp_clamp(x)); }
+  inline int vp_ceil(double x) { return (int)ceil(vp_clamp(x)); }
+
+  inline bool vp_is_finite(double x)
+  {
+    return x - x == 0.; // False for NaN and infinity
+  }
+
+  inline float vp_coverage(double x)
+  {
+    return x <= 0. ? 0.f : (x >= 1. ? 1.f : (float)x);
+  }
+
+  // Distance from (x,y) to the segment [(x1,y1), (x2,y2)]
+  inline double vp_distance_to_segment(double x, double y, double x1, double y1, double x2, double y2)
+  {
+    double dx = x2 - x1, dy = y2 - y1;
+    double l2 = dx*dx + dy*dy;
+    double t = (l2 > 0.) ? ((x - x1)*dx + (y - y1)*dy) / l2 : 0.;
+    t = (t < 0.) ? 0. : (t > 1. ? 1. : t);
+    double ex = x1 + t*dx - x, ey = y1 + t*dy - y;
+    return sqrt(ex*ex + ey*ey);
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. The display has to be initialized with one of the
+  init() functions.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen()
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+}
+
+/*!
+  Constructor. The display has to be initialized with one of the init()
+  functions.
+
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen(int winx, int winy, const std::string &title)
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+  m_windowXPosition = winx;
+  m_windowYPosition = winy;
+  m_title = title;
+}
+
+/*!
+  Constructor that initializes the display for the gray level image \e I.
+
+  \param I : Image to be displayed.
+  \param scaleType : Down scaling factor of the canvas. vpDisplay::SCALE_AUTO
+  has no screen to adapt to and leads to no down scaling.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen(vpImage<unsigned char> &I, vpScaleType scaleType)
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+  m_scaleType = scaleType;
+  init(I);
+}
+
+/*!
+  Constructor that initializes the display for the gray level image \e I.
+
+  \param I : Image to be displayed.
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+  \param scaleType : Down scaling factor of the canvas. vpDisplay::SCALE_AUTO
+  has no screen to adapt to and leads to no down scaling.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen(vpImage<unsigned char> &I, int winx, int winy, const std::string &title,
+                                       vpScaleType scaleType)
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+  m_scaleType = scaleType;
+  init(I, winx, winy, title);
+}
+
+/*!
+  Constructor that initializes the display for the color image \e I.
+
+  \param I : Image to be displayed.
+  \param scaleType : Down scaling factor of the canvas. vpDisplay::SCALE_AUTO
+  has no screen to adapt to and leads to no down scaling.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen(vpImage<vpRGBa> &I, vpScaleType scaleType)
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+  m_scaleType = scaleType;
+  init(I);
+}
+
+/*!
+  Constructor that initializes the display for the color image \e I.
+
+  \param I : Image to be displayed.
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+  \param scaleType : Down scaling factor of the canvas. vpDisplay::SCALE_AUTO
+  has no screen to adapt to and leads to no down scaling.
+*/
+vpDisplayOffscreen::vpDisplayOffscreen(vpImage<vpRGBa> &I, int winx, int winy, const std::string &title,
+                                       vpScaleType scaleType)
+  : vpDisplay(), m_canvas(), m_antialiasing(false)
+{
+  m_scaleType = scaleType;
+  init(I, winx, winy, title);
+}
+
+/*!
+  Destructor.
+*/
+vpDisplayOffscreen::~vpDisplayOffscreen()
+{
+  closeDisplay();
+}
+
+/*!
+  Initialize the display for the gray level image \e I.
+
+  \param I : Image to be displayed.
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+*/
+void vpDisplayOffscreen::init(vpImage<unsigned char> &I, int winx, int winy, const std::string &title)
+{
+  if ((I.getHeight() == 0) || (I.getWidth() == 0)) {
+    throw(vpDisplayException(vpDisplayException::notInitializedError, "Image not initialized"));
+  }
+
+  init(I.getWidth(), I.getHeight(), winx, winy, title);
+  I.display = this;
+}
+
+/*!
+  Initialize the display for the color image \e I.
+
+  \param I : Image to be displayed.
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+*/
+void vpDisplayOffscreen::init(vpImage<vpRGBa> &I, int winx, int winy, const std::string &title)
+{
+  if ((I.getHeight() == 0) || (I.getWidth() == 0)) {
+    throw(vpDisplayException(vpDisplayException::notInitializedError, "Image not initialized"));
+  }
+
+  init(I.getWidth(), I.getHeight(), winx, winy, title);
+  I.display = this;
+}
+
+/*!
+  Initialize the display size, position and title.
+
+  \param w, h : Size of the displayed images.
+  \param winx, winy : Window position. Only stored, since there is no window.
+  \param title : Window title. Only stored, since there is no window.
+*/
+void vpDisplayOffscreen::init(unsigned int w, unsigned int h, int winx, int winy, const std::string &title)
+{
+  // There is no screen to compute an automatic down scaling factor
+  if (m_scaleType != vpDisplay::SCALE_AUTO)
+    setScale(m_scaleType, w, h);
+
+  m_width = w / m_scale;
+  m_height = h / m_scale;
+
+  if (winx != -1)
+    m_windowXPosition = winx;
+  if (winy != -1)
+    m_windowYPosition = winy;
+  if (! title.empty())
+    m_title = title;
+
+  m_canvas.resize(m_height, m_width, vpRGBa(255, 255, 255, vpRGBa::alpha_default));
+  m_displayHasBeenInitialized = true;
+}
+
+/*!
+  Throw a vpDisplayException if the display is not initialized.
+*/
+void vpDisplayOffscreen::checkInitialized() const
+{
+  if (! m_displayHasBeenInitialized) {
+    throw(vpDisplayException(vpDisplayException::notInitializedError, "Offscreen display not initialized"));
+  }
+}
+
+/*!
+  Fill the canvas with \e color.
+  \param color : Background color.
+*/
+void vpDisplayOffscreen::clearDisplay(const vpColor &color)
+{
+  checkInitialized();
+
+  vpRGBa background(color.R, color.G, color.B, vpRGBa::alpha_default);
+  m_canvas = background;
+}
+
+/*!
+  Release the canvas.
+*/
+void vpDisplayOffscreen::closeDisplay()
+{
+  if (m_displayHasBeenInitialized) {
+    m_canvas.destroy();
+    m_displayHasBeenInitialized = false;
+  }
+}
+
+/*!
+  Display an arrow from image point \e ip1 to image point \e ip2.
+  \param ip1,ip2 : Initial and final image point.
+  \param color : Arrow color.
+  \param w,h : Width and height of the arrow.
+  \param thickness : Thickness of the lines used to display the arrow.
+*/
+void vpDisplayOffscreen::displayArrow(const vpImagePoint &ip1, const vpImagePoint &ip2, const vpColor &color,
+                                      unsigned int w, unsigned int h, unsigned int thickness)
+{
+  checkInitialized();
+
+  double a = ip2.get_i() - ip1.get_i();
+  double b = ip2.get_j() - ip1.get_j();
+  double lg = sqrt(vpMath::sqr(a) + vpMath::sqr(b));
+
+  if ((std::fabs(a) <= std::numeric_limits<double>::epsilon()) && (std::fabs(b) <= std::numeric_limits<double>::epsilon()))
+    return;
+
+  a /= lg;
+  b /= lg;
+
+  vpImagePoint ip3;
+  ip3.set_i(ip2.get_i() - w*a);
+  ip3.set_j(ip2.get_j() - w*b);
+
+  vpImagePoint ip4;
+  ip4.set_i(ip3.get_i() - b*h);
+  ip4.set_j(ip3.get_j() + a*h);
+
+  if (lg > 2*vpImagePoint::distance(ip2, ip4))
+    displayLine(ip2, ip4, color, thickness);
+
+  ip4.set_i(ip3.get_i() + b*h);
+  ip4.set_j(ip3.get_j() - a*h);
+
+  if (lg > 2*vpImagePoint::distance(ip2, ip4))
+    displayLine(ip2, ip4, color, thickness);
+
+  displayLine(ip1, ip2, color, thickness);
+}
+
+/*!
+  Display a string with the built-in 8 by 8 pixels font.
+  \param ip : Bottom left position of the first character (baseline).
+  \param text : String to display.
+  \param color : Text color.
+*/
+void vpDisplayOffscreen::displayCharString(const vpImagePoint &ip, const char *text, const vpColor &color)
+{
+  checkInitialized();
+
+  drawText(vp_round(ip.get_u()/m_scale), vp_round(ip.get_v()/m_scale), text, color);
+}
+
+/*!
+  Display a circle.
+  \param center : Circle center position.
+  \param radius : Circle radius.
+  \param color : Circle color.
+  \param fill : When set to true fill the circle.
+  \param thickness : Thickness of the circle. This parameter is only useful
+  when \e fill is set to false.
+*/
+void vpDisplayOffscreen::displayCircle(const vpImagePoint &center, unsigned int radius, const vpColor &color,
+                                       bool fill, unsigned int thickness)
+{
+  checkInitialized();
+
+  drawCircle(center.get_u()/m_scale, center.get_v()/m_scale, (double)(radius/m_scale), color, fill, thickness);
+}
+
+/*!
+  Display a cross at the image point \e ip location.
+  \param ip : Cross location.
+  \param cross_size : Size (width and height) of the cross.
+  \param color : Cross color.
+  \param thickness : Thickness of the lines used to display the cross.
+*/
+void vpDisplayOffscreen::displayCross(const vpImagePoint &ip, unsigned int cross_size, const vpColor &color,
+                                      unsigned int thickness)
+{
+  checkInitialized();
+
+  double u = ip.get_u()/m_scale;
+  double v = ip.get_v()/m_scale;
+  double half = (double)(cross_size/2)/m_scale;
+  drawSegment(u, v - half, u, v + half, color, thickness);
+  drawSegment(u - half, v, u + half, v, color, thickness);
+}
+
+/*!
+  Display crosses at the image points \e ips locations.
+  \param ips : Cross locations.
+  \param cross_size : Size (width and height) of the crosses.
+  \param color : Cross color.
+  \param thickness : Thickness of the lines used to display the crosses.
+*/
+void vpDisplayOffscreen::displayCrosses(const std::vector<vpImagePoint> &ips, unsigned int cross_size,
+                                        const vpColor &color, unsigned int thickness)
+{
+  checkInitialized();
+
+  double half = (double)(cross_size/2)/m_scale;
+  for (size_t i = 0; i < ips.size(); i++) {
+    double u = ips[i].get_u()/m_scale;
+    double v = ips[i].get_v()/m_scale;
+    drawSegment(u, v - half, u, v + half, color, thickness);
+    drawSegment(u - half, v, u + half, v, color, thickness);
+  }
+}
+
+/*!
+  Display a dashed line from image point \e ip1 to image point \e ip2.
+  \param ip1,ip2 : Initial and final image points.
+  \param color : Line color.
+  \param thickness : Line thickness.
+*/
+void vpDisplayOffscreen::displayDotLine(const vpImagePoint &ip1, const vpImagePoint &ip2, const vpColor &color,
+                                        unsigned int thickness)
+{
+  checkInitialized();
+
+  double u1 = ip1.get_u()/m_scale, v1 = ip1.get_v()/m_scale;
+  double u2 = ip2.get_u()/m_scale, v2 = ip2.get_v()/m_scale;
+  double length = sqrt(vpMath::sqr(u2 - u1) + vpMath::sqr(v2 - v1));
+  if (length <= std::numeric_limits<double>::epsilon()) {
+    drawSegment(u1, v1, u2, v2, color, thickness);
+    return;
+  }
+
+  // Dashes of 4 pixels separated by 4 pixels, as the default X11 dashes
+  const double dash = 4.;
+  double du = (u2 - u1) / length, dv = (v2 - v1) / length;
+  for (double s = 0.; s < length; s += 2*dash) {
+    double e = std::min(s + dash - 1., length);
+    drawSegment(u1 + s*du, v1 + s*dv, u1 + e*du, v1 + e*dv, color, thickness);
+  }
+}
+
+/*!
+  Display the gray level image \e I in the canvas.
+
+  \warning Erases the overlay.
+
+  \param I : Image to display.
+*/
+void vpDisplayOffscreen::displayImage(const vpImage<unsigned char> &I)
+{
+  checkInitialized();
+
+  if (m_scale == 1) {
+    vpImageConvert::GreyToRGBa(const_cast<unsigned char *>(I.bitmap), reinterpret_cast<unsigned char *>(m_canvas.bitmap),
+                               m_width * m_height);
+  }
+  else {
+    for (unsigned int i = 0; i < m_height; i++) {
+      vpRGBa *dst = m_canvas[i];
+      const unsigned char *src = I[i*m_scale];
+      for (unsigned int j = 0; j < m_width; j++) {
+        unsigned char val = src[j*m_scale];
+        dst[j] = vpRGBa(val, val, val, vpRGBa::alpha_default);
+      }
+    }
+  }
+}
+
+/*!
+  Display the color image \e I in the canvas.
+
+  \warning Erases the overlay.
+
+  \param I : Image to display.
+*/
+void vpDisplayOffscreen::displayImage(const vpImage<vpRGBa> &I)
+{
+  checkInitialized();
+
+  if (m_scale == 1) {
+    memcpy(static_cast<void *>(m_canvas.bitmap), I.bitmap, m_width * m_height * sizeof(vpRGBa));
+  }
+  else {
+    for (unsigned int i = 0; i < m_height; i++) {
+      vpRGBa *dst = m_canvas[i];
+      const vpRGBa *src = I[i*m_scale];
+      for (unsigned int j = 0; j < m_width; j++)
+        dst[j] = src[j*m_scale];
+    }
+  }
+}
+
+/*!
+  Display a region of interest of the gray level image \e I in the canvas.
+
+  \warning Erases the overlay in the region of interest.
+
+  \param I : Image to display.
+  \param iP : Top left corner of the region of interest.
+  \param w, h : Width and height of the region of interest.
+*/
+void vpDisplayOffscreen::displayImageROI(const vpImage<unsigned char> &I, const vpImagePoint &iP,
+                                         const unsigned int w, const unsigned int h)
+{
+  checkInitialized();
+
+  unsigned int i_min = (unsigned int)std::max(vp_ceil(iP.get_i()/m_scale), 0);
+  unsigned int j_min = (unsigned int)std::max(vp_ceil(iP.get_j()/m_scale), 0);
+  unsigned int i_max = (unsigned int)std::min(vp_ceil((iP.get_i() + h)/m_scale), (int)m_height);
+  unsigned int j_max = (unsigned int)std::min(vp_ceil((iP.get_j() + w)/m_scale), (int)m_width);
+
+  for (unsigned int i = i_min; i < i_max; i++) {
+    vpRGBa *dst = m_canvas[i];
+    const unsigned char *src = I[i*m_scale];
+    for (unsigned int j = j_min; j < j_max; j++) {
+      unsigned char val = src[j*m_scale];
+      dst[j] = vpRGBa(val, val, val, vpRGBa::alpha_default);
+    }
+  }
+}
+
+/*!
+  Display a region of interest of the color image \e I in the canvas.
+
+  \warning Erases the overlay in the region of interest.
+
+  \param I : Image to display.
+  \param iP : Top left corner of the region of interest.
+  \param w, h : Width and height of the region of interest.
+*/
+void vpDisplayOffscreen::displayImageROI(const vpImage<vpRGBa> &I, const vpImagePoint &iP,
+                                         const unsigned int w, const unsigned int h)
+{
+  checkInitialized();
+
+  unsigned int i_min = (unsigned int)std::max(vp_ceil(iP.get_i()/m_scale), 0);
+  unsigned int j_min = (unsigned int)std::max(vp_ceil(iP.get_j()/m_scale), 0);
+  unsigned int i_max = (unsigned int)std::min(vp_ceil((iP.get_i() + h)/m_scale), (int)m_height);
+  unsigned int j_max = (unsigned int)std::min(vp_ceil((iP.get_j() + w)/m_scale), (int)m_width);
+
+  for (unsigned int i = i_min; i < i_max; i++) {
+    vpRGBa *dst = m_canvas[i];
+    const vpRGBa *src = I[i*m_scale];
+    for (unsigned int j = j_min; j < j_max; j++)
+      dst[j] = src[j*m_scale];
+  }
+}
+
+/*!
+  Display a line from image point \e ip1 to image point \e ip2.
+  \param ip1,ip2 : Initial and final image points.
+  \param color : Line color.
+  \param thickness : Line thickness.
+*/
+void vpDisplayOffscreen::displayLine(const vpImagePoint &ip1, const vpImagePoint &ip2, const vpColor &color,
+                                     unsigned int thickness)
+{
+  checkInitialized();
+
+  drawSegment(ip1.get_u()/m_scale, ip1.get_v()/m_scale, ip2.get_u()/m_scale, ip2.get_v()/m_scale, color, thickness);
+}
+
+/*!
+  Display line segments.
+  \param ips : Extremities of the segments: the i-th segment goes from
+  ips[2*i] to ips[2*i+1].
+  \param color : Line color.
+  \param thickness : Line thickness.
+*/
+void vpDisplayOffscreen::displayLines(const std::vector<vpImagePoint> &ips, const vpColor &color,
+                                      unsigned int thickness)
+{
+  checkInitialized();
+
+  for (size_t i = 0; i + 1 < ips.size(); i += 2) {
+    drawSegment(ips[i].get_u()/m_scale, ips[i].get_v()/m_scale,
+                ips[i+1].get_u()/m_scale, ips[i+1].get_v()/m_scale, color, thickness);
+  }
+}
+
+/*!
+  Display a point at the image point \e ip location.
+  \param ip : Point location.
+  \param color : Point color.
+  \param thickness : Point thickness. A point of thickness greater than 1 is
+  a square whose top left corner is at \e ip.
+*/
+void vpDisplayOffscreen::displayPoint(const vpImagePoint &ip, const vpColor &color, unsigned int thickness)
+{
+  checkInitialized();
+
+  int u = vp_round(ip.get_u()/m_scale);
+  int v = vp_round(ip.get_v()/m_scale);
+  if (thickness == 1)
+    vp_blend(m_canvas, u, v, color, 1.f);
+  else
+    fillRectangle(u, v, (int)thickness, (int)thickness, color);
+}
+
+/*!
+  Display points at the image points \e ips locations.
+  \param ips : Point locations.
+  \param color : Point color.
+  \param thickness : Point thickness. See displayPoint().
+*/
+void vpDisplayOffscreen::displayPoints(const std::vector<vpImagePoint> &ips, const vpColor &color,
+                                       unsigned int thickness)
+{
+  checkInitialized();
+
+  for (size_t i = 0; i < ips.size(); i++) {
+    int u = vp_round(ips[i].get_u()/m_scale);
+    int v = vp_round(ips[i].get_v()/m_scale);
+    if (thickness == 1)
+      vp_blend(m_canvas, u, v, color, 1.f);
+    else
+      fillRectangle(u, v, (int)thickness, (int)thickness, color);
+  }
+}
+
+/*!
+  Display a closed polygon.
+  \param ips : Polygon vertices.
+  \param color : Polygon color.
+  \param fill : When set to true fill the polygon with the even-odd rule.
+  \param thickness : Thickness of the polygon edges. This parameter is only
+  useful when \e fill is set to false.
+*/
+void vpDisplayOffscreen::displayPolygon(const std::vector<vpImagePoint> &ips, const vpColor &color,
+                                        bool fill, unsigned int thickness)
+{
+  checkInitialized();
+
+  if (ips.empty())
+    return;
+
+  size_t n = ips.size();
+  std::vector<double> u(n), v(n);
+  for (size_t i = 0; i < n; i++) {
+    u[i] = ips[i].get_u()/m_scale;
+    v[i] = ips[i].get_v()/m_scale;
+  }
+
+  if (fill) {
+    fillPolygon(u, v, color);
+    // Smooth the polygon border
+    if (! m_antialiasing)
+      return;
+    thickness = 1;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    size_t next = (i + 1) % n;
+    drawSegment(u[i], v[i], u[next], v[next], color, thickness);
+  }
+}
+
+/*!
+  Display a rectangle with \e topLeft as the top-left corner and \e
+  width and \e height the rectangle size.
+
+  \param topLeft : Top-left corner of the rectangle.
+  \param w,h : Rectangle size in terms of width and height.
+  \param color : Rectangle color.
+  \param fill : When set to true fill the rectangle.
+  \param thickness : Thickness of the four lines used to display the
+  rectangle. This parameter is only useful when \e fill is set to false.
+*/
+void vpDisplayOffscreen::displayRectangle(const vpImagePoint &topLeft, unsigned int w, unsigned int h,
+                                          const vpColor &color, bool fill, unsigned int thickness)
+{
+  checkInitialized();
+
+  int u = vp_round(topLeft.get_u()/m_scale);
+  int v = vp_round(topLeft.get_v()/m_scale);
+  int width = vp_floor(w/m_scale);
+  int height = vp_floor(h/m_scale);
+
+  if (fill) {
+    fillRectangle(u, v, width, height, color);
+  }
+  else {
+    drawSegment(u, v, u + width, v, color, thickness);
+    drawSegment(u + width, v, u + width, v + height, color, thickness);
+    drawSegment(u + width, v + height, u, v + height, color, thickness);
+    drawSegment(u, v + height, u, v, color, thickness);
+  }
+}
+
+/*!
+  Display a rectangle.
+
+  \param topLeft : Top-left corner of the rectangle.
+  \param bottomRight : Bottom-right corner of the rectangle.
+  \param color : Rectangle color.
+  \param fill : When set to true fill the rectangle.
+  \param thickness : Thickness of the four lines used to display the
+  rectangle. This parameter is only useful when \e fill is set to false.
+*/
+void vpDisplayOffscreen::displayRectangle(const vpImagePoint &topLeft, const vpImagePoint &bottomRight,
+                                          const vpColor &color, bool fill, unsigned int thickness)
+{
+  vpRect rectangle(topLeft, bottomRight);
+  displayRectangle(rectangle, color, fill, thickness);
+}
+
+/*!
+  Display a rectangle.
+
+  \param rectangle : Rectangle characteristics.
+  \param color : Rectangle color.
+  \param fill : When set to true fill the rectangle.
+  \param thickness : Thickness of the four lines used to display the
+  rectangle. This parameter is only useful when \e fill is set to false.
+*/
+void vpDisplayOffscreen::displayRectangle(const vpRect &rectangle, const vpColor &color, bool fill,
+                                          unsigned int thickness)
+{
+  unsigned int w = (unsigned int)std::max(vp_round(rectangle.getWidth()), 0);
+  unsigned int h = (unsigned int)std::max(vp_round(rectangle.getHeight()), 0);
+  // The outline goes through the last column and row of the rectangle
+  if (! fill) {
+    w = (w > 0) ? w - 1 : 0;
+    h = (h > 0) ? h - 1 : 0;
+  }
+  displayRectangle(rectangle.getTopLeft(), w, h, color, fill, thickness);
+}
+
+/*!
+  Nothing to do since the primitives are drawn immediately in the canvas.
+*/
+void vpDisplayOffscreen::flushDisplay()
+{
+  checkInitialized();
+}
+
+/*!
+  Nothing to do since the primitives are drawn immediately in the canvas.
+*/
+void vpDisplayOffscreen::flushDisplayROI(const vpImagePoint & /* iP */, const unsigned int /* width */,
+                                         const unsigned int /* height */)
+{
+  checkInitialized();
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getClick(bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getClick(vpImagePoint & /* ip */, bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getClick(vpImagePoint & /* ip */, vpMouseButton::vpMouseButtonType & /* button */,
+                                  bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getClickUp(vpImagePoint & /* ip */, vpMouseButton::vpMouseButtonType & /* button */,
+                                    bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  Copy the canvas, that is the displayed image with its overlay, in \e I.
+  The size of \e I is the size of the displayed image divided by the down
+  scaling factor.
+
+  \param I : Image to get.
+*/
+void vpDisplayOffscreen::getImage(vpImage<vpRGBa> &I)
+{
+  checkInitialized();
+
+  I.resize(m_height, m_width);
+  memcpy(static_cast<void *>(I.bitmap), m_canvas.bitmap, m_width * m_height * sizeof(vpRGBa));
+}
+
+/*!
+  There is no keyboard: always return false.
+*/
+bool vpDisplayOffscreen::getKeyboardEvent(bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no keyboard: always return false.
+*/
+bool vpDisplayOffscreen::getKeyboardEvent(std::string & /* key */, bool /* blocking */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getPointerMotionEvent(vpImagePoint & /* ip */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  There is no mouse: always return false.
+*/
+bool vpDisplayOffscreen::getPointerPosition(vpImagePoint & /* ip */)
+{
+  checkInitialized();
+  return false;
+}
+
+/*!
+  Return the canvas height, since there is no screen.
+*/
+unsigned int vpDisplayOffscreen::getScreenHeight()
+{
+  return m_height;
+}
+
+/*!
+  Return the canvas size, since there is no screen.
+*/
+void vpDisplayOffscreen::getScreenSize(unsigned int &w, unsigned int &h)
+{
+  w = m_width;
+  h = m_height;
+}
+
+/*!
+  Return the canvas width, since there is no screen.
+*/
+unsigned int vpDisplayOffscreen::getScreenWidth()
+{
+  return m_width;
+}
+
+/*!
+  Not used: text is always drawn with the built-in 8 by 8 pixels font.
+*/
+void vpDisplayOffscreen::setFont(const std::string & /* font */)
+{
+}
+
+/*!
+  Set the title. Only stored, since there is no window.
+*/
+void vpDisplayOffscreen::setTitle(const std::string &title)
+{
+  m_title = title;
+}
+
+/*!
+  Set the window position. Only stored, since there is no window.
+*/
+void vpDisplayOffscreen::setWindowPosition(int winx, int winy)
+{
+  m_windowXPosition = winx;
+  m_windowYPosition = winy;
+}
+
+/*!
+  Draw a circle in the canvas. Coordinates are canvas pixels.
+*/
+void vpDisplayOffscreen::drawCircle(double uc, double vc, double radius, const vpColor &color, bool fill,
+                                    unsigned int thickness)
+{
+  if (! vp_is_finite(uc) || ! vp_is_finite(vc) || ! (radius >= 0.))
+    return;
+
+  if (! fill && thickness <= 1 && ! m_antialiasing) {
+    // Nothing to draw when the canvas is inside the circle
+    double du = std::max(std::fabs(uc), std::fabs(uc - m_width)), dv = std::max(std::fabs(vc), std::fabs(vc - m_height));
+    if (radius > sqrt(du*du + dv*dv) + 1.)
+      return;
+    // Midpoint circle
+    int cu = vp_round(uc), cv = vp_round(vc);
+    int x = vp_round(radius), y = 0, err = 1 - x;
+    while (x >= y) {
+      vp_blend(m_canvas, cu + x, cv + y, color, 1.f);
+      vp_blend(m_canvas, cu + y, cv + x, color, 1.f);
+      vp_blend(m_canvas, cu - y, cv + x, color, 1.f);
+      vp_blend(m_canvas, cu - x, cv + y, color, 1.f);
+      vp_blend(m_canvas, cu - x, cv - y, color, 1.f);
+      vp_blend(m_canvas, cu - y, cv - x, color, 1.f);
+      vp_blend(m_canvas, cu + y, cv - x, color, 1.f);
+      vp_blend(m_canvas, cu + x, cv - y, color, 1.f);
+      y++;
+      if (err < 0) {
+        err += 2*y + 1;
+      }
+      else {
+        x--;
+        err += 2*(y - x) + 1;
+      }
+    }
+    return;
+  }
+
+  // Coverage of the ring between r_in and r_out, or of the disk of radius r_out
+  double half = fill ? 0. : std::max(1u, thickness) / 2.;
+  double r_out = radius + half;
+  double r_in = fill ? -1. : radius - half;
+  double margin = m_antialiasing ? 1. : 0.;
+  double r_span = r_out + margin;
+  double r_hole = r_in - margin;
+
+  int v_min = std::max(vp_floor(vc - r_span), 0);
+  int v_max = std::min(vp_ceil(vc + r_span), (int)m_height - 1);
+  for (int v = v_min; v <= v_max; v++) {
+    double dv = v - vc;
+    if (std::fabs(dv) > r_span)
+      continue;
+    double outer = sqrt(r_span*r_span - dv*dv);
+    double inner = (r_hole > 0. && std::fabs(dv) < r_hole) ? sqrt(r_hole*r_hole - dv*dv) : -1.;
+
+    int u_min = std::max(vp_floor(uc - outer), 0);
+    int u_max = std::min(vp_ceil(uc + outer), (int)m_width - 1);
+    for (int u = u_min; u <= u_max; u++) {
+      double du = u - uc;
+      // Skip the inside of the ring
+      if (inner > 0. && std::fabs(du) < inner) {
+        u = vp_floor(uc + inner);
+        continue;
+      }
+      double d = sqrt(du*du + dv*dv);
+      float alpha;
+      if (m_antialiasing)
+        alpha = std::min(vp_coverage(r_out + 0.5 - d), vp_coverage(d - r_in + 0.5));
+      else
+        alpha = (d <= r_out && d >= r_in) ? 1.f : 0.f;
+      vp_blend(m_canvas, u, v, color, alpha);
+    }
+  }
+}
+
+/*!
+  Draw a line segment in the canvas. Coordinates are canvas pixels, the
+  center of pixel (i,j) being at (u=j, v=i). Lines thicker than one pixel
+  have round ends.
+*/
+void vpDisplayOffscreen::drawSegment(double u1, double v1, double u2, double v2, const vpColor &color,
+                                     unsigned int thickness)
+{
+  if (thickness <= 1) {
+    bool steep = std::fabs(v2 - v1) > std::fabs(u2 - u1);
+    // Iterate along the major axis x, the minor axis is y
+    double x1 = steep ? v1 : u1, y1 = steep ? u1 : v1;
+    double x2 = steep ? v2 : u2, y2 = steep ? u2 : v2;
+    if (x1 > x2) {
+      std::swap(x1, x2);
+      std::swap(y1, y2);
+    }
+    double gradient = (x2 - x1 > 0.) ? (y2 - y1) / (x2 - x1) : 0.;
+    int x_size = steep ? (int)m_height : (int)m_width;
+    int x_min = std::max(vp_round(x1), 0);
+    int x_max = std::min(vp_round(x2), x_size - 1);
+
+    for (int x = x_min; x <= x_max; x++) {
+      double y = y1 + gradient * (x - x1);
+      if (m_antialiasing) {
+        // Xiaolin Wu's line
+        int yf = vp_floor(y);
+        float frac = (float)(y - yf);
+        if (steep) {
+          vp_blend(m_canvas, yf, x, color, 1.f - frac);
+          vp_blend(m_canvas, yf + 1, x, color, frac);
+        }
+        else {
+          vp_blend(m_canvas, x, yf, color, 1.f - frac);
+          vp_blend(m_canvas, x, yf + 1, color, frac);
+        }
+      }
+      else {
+        if (steep)
+          vp_blend(m_canvas, vp_round(y), x, color, 1.f);
+        else
+          vp_blend(m_canvas, x, vp_round(y), color, 1.f);
+      }
+    }
+    return;
+  }
+
+  // Thick line: pixels whose center is closer to the segment than half the thickness
+  double r = thickness / 2.;
+  double margin = r + (m_antialiasing ? 1. : 0.);
+
+  int v_min = std::max(vp_floor(std::min(v1, v2) - margin), 0);
+  int v_max = std::min(vp_ceil(std::max(v1, v2) + margin), (int)m_height - 1);
+  for (int v = v_min; v <= v_max; v++) {
+    // Part of the segment in the band of rows [v - margin, v + margin]
+    double ua, ub;
+    if (std::fabs(v2 - v1) < std::numeric_limits<double>::epsilon()) {
+      ua = std::min(u1, u2);
+      ub = std::max(u1, u2);
+    }
+    else {
+      double ta = (v - margin - v1) / (v2 - v1);
+      double tb = (v + margin - v1) / (v2 - v1);
+      if (ta > tb)
+        std::swap(ta, tb);
+      ta = std::max(ta, 0.);
+      tb = std::min(tb, 1.);
+      if (ta > tb)
+        continue;
+      ua = std::min(u1 + ta*(u2 - u1), u1 + tb*(u2 - u1));
+      ub = std::max(u1 + ta*(u2 - u1), u1 + tb*(u2 - u1));
+    }
+
+    int u_min = std::max(vp_floor(ua - margin), 0);
+    int u_max = std::min(vp_ceil(ub + margin), (int)m_width - 1);
+    for (int u = u_min; u <= u_max; u++) {
+      double d = vp_distance_to_segment(u, v, u1, v1, u2, v2);
+      float alpha = m_antialiasing ? vp_coverage(r + 0.5 - d) : (d <= r ? 1.f : 0.f);
+      vp_blend(m_canvas, u, v, color, alpha);
+    }
+  }
+}
+
+/*!
+  Draw a string with the built-in 8 by 8 pixels font. (u,v) is the bottom
+  left corner of the first character, on the baseline.
+*/
+void vpDisplayOffscreen::drawText(int u, int v, const char *text, const vpColor &color)
+{
+  if (text == NULL)
+    return;
+
+  int top = v - 6;
+  for (const char *c = text; *c != '\0'; c++, u += 8) {
+    unsigned char code = (unsigned char)*c;
+    if (code < 32 || code > 126)
+      code = '?';
+    const unsigned char *glyph = vp_font8x8[code - 32];
+    for (int row = 0; row < 8; row++) {
+      unsigned char bits = glyph[row];
+      for (int col = 0; bits != 0; col++, bits >>= 1) {
+        if (bits & 1)
+          vp_blend(m_canvas, u + col, top + row, color, 1.f);
+      }
+    }
+  }
+}
+
+/*!
+  Fill a polygon in the canvas with the even-odd rule. Coordinates are
+  canvas pixels.
+*/
+void vpDisplayOffscreen::fillPolygon(const std::vector<double> &u, const std::vector<double> &v,
+                                     const vpColor &color)
+{
+  size_t n = u.size();
+  if (n < 3)
+    return;
+  for (size_t i = 0; i < n; i++) {
+    if (! vp_is_finite(u[i]) || ! vp_is_finite(v[i]))
+      return;
+  }
+
+  double v_lo = *std::min_element(v.begin(), v.end());
+  double v_hi = *std::max_element(v.begin(), v.end());
+  int row_min = std::max(vp_ceil(v_lo), 0);
+  int row_max = std::min(vp_floor(v_hi), (int)m_height - 1);
+
+  std::vector<double> crossings;
+  for (int row = row_min; row <= row_max; row++) {
+    crossings.clear();
+    for (size_t i = 0; i < n; i++) {
+      size_t j = (i + 1) % n;
+      if ((v[i] <= row && row < v[j]) || (v[j] <= row && row < v[i]))
+        crossings.push_back(u[i] + (row - v[i]) * (u[j] - u[i]) / (v[j] - v[i]));
+    }
+    std::sort(crossings.begin(), crossings.end());
+    for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+      int u_min = std::max(vp_ceil(crossings[k]), 0);
+      int u_max = std::min(vp_ceil(crossings[k+1]) - 1, (int)m_width - 1);
+      for (int col = u_min; col <= u_max; col++)
+        vp_blend(m_canvas, col, row, color, 1.f);
+    }
+  }
+}
+
+/*!
+  Fill the rectangle of top left corner (u,v) and size w by h pixels.
+*/
+void vpDisplayOffscreen::fillRectangle(int u, int v, int w, int h, const vpColor &color)
+{
+  int u_min = std::max(u, 0), u_max = std::min(u + w, (int)m_width);
+  int v_min = std::max(v, 0), v_max = std::min(v + h, (int)m_height);
+  for (int row = v_min; row < v_max; row++) {
+    vpRGBa *dst = m_canvas[(unsigned int)row];
+    for (int col = u_min; col < u_max; col++) {
+      dst[col].R = color.R;
+      dst[col].G = color.G;
+      dst[col].B = color.B;
+    }
+  }
+}
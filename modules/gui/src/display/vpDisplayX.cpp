@@ -62,6 +62,75 @@
 // math
 #include <visp3/core/vpMath.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  // Convert n grey level pixels into 32 bits little endian BGRA pixels
+  void vp_grey_to_bgra(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    unsigned int i = 0;
+#if VISP_HAVE_SSE2
+    const __m128i alpha = _mm_set1_epi8((char)vpRGBa::alpha_default);
+    for (; i + 16 <= n; i += 16) {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+      const __m128i vv_lo = _mm_unpacklo_epi8(v, v);
+      const __m128i va_lo = _mm_unpacklo_epi8(v, alpha);
+      const __m128i vv_hi = _mm_unpackhi_epi8(v, v);
+      const __m128i va_hi = _mm_unpackhi_epi8(v, alpha);
+      _mm_storeu_si128((__m128i *)(dst + 4*i), _mm_unpacklo_epi16(vv_lo, va_lo));
+      _mm_storeu_si128((__m128i *)(dst + 4*i + 16), _mm_unpackhi_epi16(vv_lo, va_lo));
+      _mm_storeu_si128((__m128i *)(dst + 4*i + 32), _mm_unpacklo_epi16(vv_hi, va_hi));
+      _mm_storeu_si128((__m128i *)(dst + 4*i + 48), _mm_unpackhi_epi16(vv_hi, va_hi));
+    }
+#endif
+    for (; i < n; i++) {
+      unsigned char val = src[i];
+      dst[4*i]   = val; // Blue
+      dst[4*i+1] = val; // Green
+      dst[4*i+2] = val; // Red
+      dst[4*i+3] = vpRGBa::alpha_default;
+    }
+  }
+
+  // Convert n RGBa pixels into 32 bits little endian BGRA pixels
+  void vp_rgba_to_bgra(const vpRGBa *src, unsigned char *dst, unsigned int n)
+  {
+    unsigned int i = 0;
+#if VISP_HAVE_SSE2
+    const __m128i mask_ga = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i mask_rb = _mm_set1_epi32(0x00FF00FF);
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+      const __m128i rb = _mm_and_si128(v, mask_rb);
+      const __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+      _mm_storeu_si128((__m128i *)(dst + 4*i), _mm_or_si128(_mm_and_si128(v, mask_ga), br));
+    }
+#endif
+    for (; i < n; i++) {
+      dst[4*i]   = src[i].B;
+      dst[4*i+1] = src[i].G;
+      dst[4*i+2] = src[i].R;
+      dst[4*i+3] = src[i].A;
+    }
+  }
+
+#ifdef VISP_HAVE_X11_XSHM
+  bool vp_shm_attach_failed = false;
+
+  int vp_shm_error_handler(Display *, XErrorEvent *)
+  {
+    vp_shm_attach_failed = true;
+    return 0;
+  }
+#endif
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 
   Constructor : initialize a display to visualize a gray level image
@@ -82,7 +151,8 @@ vpDisplayX::vpDisplayX (vpImage<unsigned char> &I, vpScaleType scaleType)
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
   setScale(scaleType, I.getWidth(), I.getHeight());
 
@@ -114,7 +184,8 @@ vpDisplayX::vpDisplayX ( vpImage<unsigned char> &I,
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
   setScale(scaleType, I.getWidth(), I.getHeight());
   init ( I, x, y, title ) ;
@@ -138,7 +209,8 @@ vpDisplayX::vpDisplayX ( vpImage<vpRGBa> &I, vpScaleType scaleType)
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
   setScale(scaleType, I.getWidth(), I.getHeight());
   init ( I ) ;
@@ -167,7 +239,8 @@ vpDisplayX::vpDisplayX ( vpImage<vpRGBa> &I,
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
   setScale(scaleType, I.getWidth(), I.getHeight());
   init ( I, x, y, title ) ;
@@ -199,7 +272,8 @@ vpDisplayX::vpDisplayX ( int x, int y, const std::string &title )
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
   m_windowXPosition = x ;
   m_windowYPosition = y ;
@@ -230,7 +304,8 @@ vpDisplayX::vpDisplayX()
   : display(NULL), window(), Ximage(NULL), lut(), context(),
     screen(0), event(), pixmap(), x_color(NULL),
     screen_depth(8), xcolor(), values(), ximage_data_init(false),
-    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0)
+    RMask(0), GMask(0), BMask(0), RShift(0), GShift(0), BShift(0),
+    m_useShm(false), m_shmPutPending(false), m_colorCache(), m_batches()
 {
 }
 
@@ -681,15 +756,7 @@ vpDisplayX::init ( vpImage<unsigned char> &I, int x, int y, const std::string &t
   //    XNextEvent ( display, &event );
   //  while ( event.xany.type != Expose );
 
-  {
-    Ximage = XCreateImage ( display, DefaultVisual ( display, screen ),
-                            screen_depth, ZPixmap, 0, NULL,
-                            m_width, m_height, XBitmapPad ( display ), 0 );
-
-    Ximage->data = ( char * ) malloc ( m_height * (unsigned int)Ximage->bytes_per_line );
-    ximage_data_init = true;
-
-  }
+  initXImage();
   m_displayHasBeenInitialized = true ;
 
   XStoreName ( display, window, m_title.c_str() );
@@ -1143,16 +1210,7 @@ vpDisplayX::init ( vpImage<vpRGBa> &I, int x, int y, const std::string &title)
   //    XNextEvent ( display, &event );
   //  while ( event.xany.type != Expose );
 
-  {
-    Ximage = XCreateImage ( display, DefaultVisual ( display, screen ),
-                            screen_depth, ZPixmap, 0, NULL,
-                            m_width, m_height, XBitmapPad ( display ), 0 );
-
-
-    Ximage->data = ( char * ) malloc ( m_height * (unsigned int)Ximage->bytes_per_line );
-    ximage_data_init = true;
-
-  }
+  initXImage();
   m_displayHasBeenInitialized = true ;
 
   XSync ( display, true );
@@ -1623,14 +1681,7 @@ void vpDisplayX::init ( unsigned int w, unsigned int h, int x, int y, const std:
   //    XNextEvent ( display, &event );
   //  while ( event.xany.type != Expose );
 
-  {
-    Ximage = XCreateImage ( display, DefaultVisual ( display, screen ),
-                            screen_depth, ZPixmap, 0, NULL,
-                            m_width, m_height, XBitmapPad ( display ), 0 );
-
-    Ximage->data = ( char * ) malloc ( m_height * (unsigned int)Ximage->bytes_per_line );
-    ximage_data_init = true;
-  }
+  initXImage();
   m_displayHasBeenInitialized = true ;
 
   XSync ( display, true );
@@ -1732,6 +1783,10 @@ void vpDisplayX::displayImage ( const vpImage<unsigned char> &I )
 {
   if ( m_displayHasBeenInitialized )
   {
+    // The whole overlay is overwritten
+    discardBatches();
+    syncXImage();
+
     switch ( screen_depth )
     {
     case 8:
@@ -1772,7 +1827,7 @@ void vpDisplayX::displayImage ( const vpImage<unsigned char> &I )
       }
 
       // Affichage de l'image dans la Pixmap.
-      XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+      putImage(0, 0, 0, 0, m_width, m_height );
       XSetWindowBackgroundPixmap ( display, window, pixmap );
       break;
     }
@@ -1801,7 +1856,7 @@ void vpDisplayX::displayImage ( const vpImage<unsigned char> &I )
       }
 
       // Affichage de l'image dans la Pixmap.
-      XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+      putImage(0, 0, 0, 0, m_width, m_height );
       XSetWindowBackgroundPixmap ( display, window, pixmap );
       break;
     }
@@ -1828,14 +1883,7 @@ void vpDisplayX::displayImage ( const vpImage<unsigned char> &I )
         }
         else {
           // little endian
-          while ( bitmap < n )
-          {
-            unsigned char val = * ( bitmap++ );
-            * ( dst_32 ++ ) = val;  // Blue
-            * ( dst_32 ++ ) = val;  // Green
-            * ( dst_32 ++ ) = val;  // Red
-            * ( dst_32 ++ ) = vpRGBa::alpha_default;
-          }
+          vp_grey_to_bgra(bitmap, dst_32, size_);
         }
       }
       else {
@@ -1866,7 +1914,7 @@ void vpDisplayX::displayImage ( const vpImage<unsigned char> &I )
       }
 
       // Affichage de l'image dans la Pixmap.
-      XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+      putImage(0, 0, 0, 0, m_width, m_height );
       XSetWindowBackgroundPixmap ( display, window, pixmap );
       break;
     }
@@ -1893,6 +1941,10 @@ void vpDisplayX::displayImage ( const vpImage<vpRGBa> &I )
 {
   if ( m_displayHasBeenInitialized )
   {
+    // The whole overlay is overwritten
+    discardBatches();
+    syncXImage();
+
     switch ( screen_depth )
     {
     case 16: {
@@ -1934,7 +1986,7 @@ void vpDisplayX::displayImage ( const vpImage<vpRGBa> &I )
         }
       }
 
-      XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+      putImage(0, 0, 0, 0, m_width, m_height );
       XSetWindowBackgroundPixmap ( display, window, pixmap );
 
       break;
@@ -1962,13 +2014,7 @@ void vpDisplayX::displayImage ( const vpImage<vpRGBa> &I )
         }
         else {
           // little endian
-          for ( unsigned int i = 0; i < sizeI; i++ ) {
-            *(dst_32++) = bitmap->B;
-            *(dst_32++) = bitmap->G;
-            *(dst_32++) = bitmap->R;
-            *(dst_32++) = bitmap->A;
-            bitmap++;
-          }
+          vp_rgba_to_bgra(bitmap, dst_32, sizeI);
         }
       }
       else {
@@ -1999,7 +2045,7 @@ void vpDisplayX::displayImage ( const vpImage<vpRGBa> &I )
       }
 
       // Affichage de l'image dans la Pixmap.
-      XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+      putImage(0, 0, 0, 0, m_width, m_height );
       XSetWindowBackgroundPixmap ( display, window, pixmap );
       break;
     }
@@ -2031,6 +2077,10 @@ void vpDisplayX::displayImage ( const unsigned char *bitmap )
 
   if ( m_displayHasBeenInitialized )
   {
+    // The whole overlay is overwritten
+    discardBatches();
+    syncXImage();
+
     unsigned char *dst_32 = ( unsigned char* ) Ximage->data;
     for ( unsigned int i = 0; i < m_width * m_height; i++ )
     {
@@ -2042,7 +2092,7 @@ void vpDisplayX::displayImage ( const unsigned char *bitmap )
     }
 
     // Affichage de l'image dans la Pixmap.
-    XPutImage ( display, pixmap, context, Ximage, 0, 0, 0, 0, m_width, m_height );
+    putImage(0, 0, 0, 0, m_width, m_height );
     XSetWindowBackgroundPixmap ( display, window, pixmap );
   }
   else
@@ -2073,6 +2123,10 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
 {
   if ( m_displayHasBeenInitialized )
   {
+    // The region of interest covers the primitives drawn before
+    flushBatches();
+    syncXImage();
+
     switch ( screen_depth )
     {
     case 8:
@@ -2106,7 +2160,7 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
           i++;
         }
 
-        XPutImage ( display, pixmap, context, Ximage, (int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
+        putImage((int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
       }
       else {
         // Correction de l'image de facon a liberer les niveaux de gris
@@ -2126,7 +2180,7 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
               dst_8[j] = nivGris;
           }
         }
-        XPutImage(display, pixmap, context, Ximage, j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
+        putImage(j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
       }
 
       // Affichage de l'image dans la Pixmap.
@@ -2146,7 +2200,7 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
           }
         }
 
-        XPutImage ( display, pixmap, context, Ximage, (int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
+        putImage((int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
       }
       else {
         int i_min = std::max((int)ceil(iP.get_i()/m_scale), 0);
@@ -2162,7 +2216,7 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
           }
         }
 
-        XPutImage(display, pixmap, context, Ximage, j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
+        putImage(j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
       }
 
       XSetWindowBackgroundPixmap ( display, window, pixmap );
@@ -2199,26 +2253,14 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
         }
         else {
           // little endian
-          unsigned int i = 0;
-          while (i < h)
-          {
-            unsigned int j = 0;
-            while (j < w)
-            {
-              unsigned char val = *(src_8+j);
-              *(dst_32+4*j) = val;
-              *(dst_32+4*j+1) = val;
-              *(dst_32+4*j+2) = val;
-              *(dst_32+4*j+3) = vpRGBa::alpha_default;
-              j++;
-            }
+          for (unsigned int i = 0; i < h; i++) {
+            vp_grey_to_bgra(src_8, dst_32, w);
             src_8 = src_8 + iwidth;
             dst_32 = dst_32 + 4*m_width;
-            i++;
           }
         }
 
-        XPutImage ( display, pixmap, context, Ximage, (int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
+        putImage((int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
       }
       else {
         int i_min = std::max((int)ceil(iP.get_i()/m_scale), 0);
@@ -2253,7 +2295,7 @@ void vpDisplayX::displayImageROI ( const vpImage<unsigned char> &I, const vpImag
           }
         }
 
-        XPutImage(display, pixmap, context, Ximage, j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
+        putImage(j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
       }
 
       XSetWindowBackgroundPixmap ( display, window, pixmap );
@@ -2289,6 +2331,10 @@ void vpDisplayX::displayImageROI ( const vpImage<vpRGBa> &I,const vpImagePoint &
 {
   if ( m_displayHasBeenInitialized )
   {
+    // The region of interest covers the primitives drawn before
+    flushBatches();
+    syncXImage();
+
     switch ( screen_depth )
     {
     case 16: {
@@ -2308,7 +2354,7 @@ void vpDisplayX::displayImageROI ( const vpImage<vpRGBa> &I,const vpImagePoint &
                 (((b << 8) >> BShift) & BMask);
           }
         }
-        XPutImage ( display, pixmap, context, Ximage, (int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
+        putImage((int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
       }
       else {
         unsigned int bytes_per_line = (unsigned int)Ximage->bytes_per_line;
@@ -2330,7 +2376,7 @@ void vpDisplayX::displayImageROI ( const vpImage<vpRGBa> &I,const vpImagePoint &
                 (((b << 8) >> BShift) & BMask);
           }
         }
-        XPutImage(display, pixmap, context, Ximage, j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
+        putImage(j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
       }
 
       XSetWindowBackgroundPixmap ( display, window, pixmap );
@@ -2376,22 +2422,14 @@ void vpDisplayX::displayImageROI ( const vpImage<vpRGBa> &I,const vpImagePoint &
         else {
           // little endian
           while (i < h) {
-            unsigned int j = 0;
-            while (j < w) {
-              *(dst_32+4*j) = (src_32+j)->B;
-              *(dst_32+4*j+1) = (src_32+j)->G;
-              *(dst_32+4*j+2) = (src_32+j)->R;
-              *(dst_32+4*j+3) = (src_32+j)->A;
-
-              j++;
-            }
+            vp_rgba_to_bgra(src_32, dst_32, w);
             src_32 = src_32 + iwidth;
             dst_32 = dst_32 + 4*m_width;
             i++;
           }
         }
 
-        XPutImage ( display, pixmap, context, Ximage, (int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
+        putImage((int)iP.get_u(), (int)iP.get_v(), (int)iP.get_u(), (int)iP.get_v(), w, h );
       }
       else {
         int i_min = std::max((int)ceil(iP.get_i()/m_scale), 0);
@@ -2425,7 +2463,7 @@ void vpDisplayX::displayImageROI ( const vpImage<vpRGBa> &I,const vpImagePoint &
             }
           }
         }
-        XPutImage(display, pixmap, context, Ximage, j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
+        putImage(j_min, i_min, j_min, i_min, j_max-j_min, i_max-i_min);
       }
 
       XSetWindowBackgroundPixmap ( display, window, pixmap );
@@ -2455,11 +2493,8 @@ void vpDisplayX::closeDisplay()
 {
   if ( m_displayHasBeenInitialized )
   {
-    if ( ximage_data_init == true )
-      free ( Ximage->data );
-
-    Ximage->data = NULL;
-    XDestroyImage ( Ximage );
+    discardBatches();
+    releaseXImage();
 
     XFreePixmap ( display, pixmap );
 
@@ -2467,6 +2502,7 @@ void vpDisplayX::closeDisplay()
     XDestroyWindow ( display, window );
     XCloseDisplay ( display );
 
+    m_colorCache.clear();
     m_displayHasBeenInitialized = false;
 
     if (x_color != NULL) {
@@ -2486,6 +2522,7 @@ void vpDisplayX::flushDisplay()
 {
   if ( m_displayHasBeenInitialized )
   {
+    flushBatches();
     XClearWindow ( display, window );
     XFlush ( display );
   }
@@ -2507,6 +2544,7 @@ void vpDisplayX::flushDisplayROI(const vpImagePoint &iP, const unsigned int w, c
 {
   if ( m_displayHasBeenInitialized )
   {
+    flushBatches();
     XClearArea ( display, window,(int)iP.get_u()/m_scale,(int)iP.get_v()/m_scale, w/m_scale, h/m_scale, 0 );
     XFlush ( display );
   }
@@ -2526,6 +2564,7 @@ void vpDisplayX::clearDisplay ( const vpColor &color )
 {
   if ( m_displayHasBeenInitialized )
   {
+    discardBatches();
 
     if (color.id < vpColor::id_unknown)
       XSetWindowBackground ( display, window, x_color[color.id] );
@@ -2624,16 +2663,9 @@ void vpDisplayX::displayCharString ( const vpImagePoint &ip,
 {
   if ( m_displayHasBeenInitialized )
   {
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
     XDrawString ( display, pixmap, context,
                   (int)ip.get_u()/m_scale, (int)ip.get_v()/m_scale,
                   text, (int)strlen ( text ) );
@@ -2663,16 +2695,10 @@ void vpDisplayX::displayCircle ( const vpImagePoint &center,
   if ( m_displayHasBeenInitialized )
   {
     if ( thickness == 1 ) thickness = 0;
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
 
     XSetLineAttributes ( display, context, thickness,
                          LineSolid, CapButt, JoinBevel );
@@ -2751,16 +2777,9 @@ void vpDisplayX::displayDotLine ( const vpImagePoint &ip1,
   {
     if ( thickness == 1 ) thickness = 0;
 
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
 
     XSetLineAttributes ( display, context, thickness,
                          LineOnOffDash, CapButt, JoinBevel );
@@ -2793,25 +2812,13 @@ void vpDisplayX::displayLine ( const vpImagePoint &ip1,
   {
     if ( thickness == 1 ) thickness = 0;
 
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
-
-    XSetLineAttributes ( display, context, thickness,
-                         LineSolid, CapButt, JoinBevel );
-
-    XDrawLine ( display, pixmap, context,
-                vpMath::round( ip1.get_u()/m_scale ),
-                vpMath::round( ip1.get_v()/m_scale ),
-                vpMath::round( ip2.get_u()/m_scale ),
-                vpMath::round( ip2.get_v()/m_scale ) );
+    // Sent to the X server by flushBatches() with the lines of same color and thickness
+    XSegment segment;
+    segment.x1 = (short)vpMath::round( ip1.get_u()/m_scale );
+    segment.y1 = (short)vpMath::round( ip1.get_v()/m_scale );
+    segment.x2 = (short)vpMath::round( ip2.get_u()/m_scale );
+    segment.y2 = (short)vpMath::round( ip2.get_v()/m_scale );
+    getBatch(getXColor(color), thickness).segments.push_back(segment);
   }
   else
   {
@@ -2830,29 +2837,22 @@ void vpDisplayX::displayPoint ( const vpImagePoint &ip, const vpColor &color, un
 {
   if ( m_displayHasBeenInitialized )
   {
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
-    
+    // Sent to the X server by flushBatches() with the thin lines of same color
+    vpPrimitiveBatch &batch = getBatch(getXColor(color), 0);
     if (thickness == 1) {
-      XDrawPoint ( display, pixmap, context,
-                   vpMath::round( ip.get_u()/m_scale ),
-                   vpMath::round( ip.get_v()/m_scale ) );
+      XPoint point;
+      point.x = (short)vpMath::round( ip.get_u()/m_scale );
+      point.y = (short)vpMath::round( ip.get_v()/m_scale );
+      batch.points.push_back(point);
     }
     else {
-      XFillRectangle ( display, pixmap, context,
-                       vpMath::round( ip.get_u()/m_scale ),
-                       vpMath::round( ip.get_v()/m_scale ),
-                       thickness, thickness );
+      XRectangle rectangle;
+      rectangle.x = (short)vpMath::round( ip.get_u()/m_scale );
+      rectangle.y = (short)vpMath::round( ip.get_v()/m_scale );
+      rectangle.width = (unsigned short)thickness;
+      rectangle.height = (unsigned short)thickness;
+      batch.rectangles.push_back(rectangle);
     }
-
   }
   else
   {
@@ -2883,16 +2883,10 @@ vpDisplayX::displayRectangle ( const vpImagePoint &topLeft,
   if ( m_displayHasBeenInitialized )
   {
     if ( thickness == 1 ) thickness = 0;
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
     XSetLineAttributes ( display, context, thickness,
                          LineSolid, CapButt, JoinBevel );
     if ( fill == false )
@@ -2938,16 +2932,10 @@ vpDisplayX::displayRectangle ( const vpImagePoint &topLeft,
   if ( m_displayHasBeenInitialized )
   {
     if ( thickness == 1 ) thickness = 0;
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
 
     XSetLineAttributes ( display, context, thickness,
                          LineSolid, CapButt, JoinBevel );
@@ -2999,16 +2987,10 @@ vpDisplayX::displayRectangle ( const vpRect &rectangle,
   if ( m_displayHasBeenInitialized )
   {
     if ( thickness == 1 ) thickness = 0;
-    if (color.id < vpColor::id_unknown)
-      XSetForeground ( display, context, x_color[color.id] );
-    else {
-      xcolor.pad   = 0;
-      xcolor.red   = 256 * color.R;
-      xcolor.green = 256 * color.G;
-      xcolor.blue  = 256 * color.B;
-      XAllocColor ( display, lut, &xcolor );
-      XSetForeground ( display, context, xcolor.pixel );
-    }
+
+    flushBatches();
+
+    XSetForeground ( display, context, getXColor(color) );
 
     XSetLineAttributes ( display, context, thickness,
                          LineSolid, CapButt, JoinBevel );
@@ -3300,6 +3282,8 @@ void vpDisplayX::getImage ( vpImage<vpRGBa> &I )
 {
   if ( m_displayHasBeenInitialized )
   {
+    flushBatches();
+
     XImage *xi ;
 
     XCopyArea (display,window, pixmap, context,
@@ -3627,6 +3611,201 @@ int vpDisplayX::getMsb(unsigned int u32val)
   return i;
 }
 
+/*!
+  Create the image used to transfer the displayed images to the X server.
+  When the X server is local and supports the MIT-SHM extension, the image
+  data is allocated in a shared memory segment attached by the server.
+*/
+void vpDisplayX::initXImage()
+{
+  m_useShm = false;
+  m_shmPutPending = false;
+  ximage_data_init = false;
+
+#ifdef VISP_HAVE_X11_XSHM
+  if ( XShmQueryExtension ( display ) ) {
+    Ximage = XShmCreateImage ( display, DefaultVisual ( display, screen ),
+                               screen_depth, ZPixmap, NULL, &m_shmInfo,
+                               m_width, m_height );
+    if ( Ximage != NULL ) {
+      m_shmInfo.shmid = shmget ( IPC_PRIVATE, (size_t)Ximage->bytes_per_line * m_height, IPC_CREAT | 0600 );
+      if ( m_shmInfo.shmid >= 0 ) {
+        m_shmInfo.shmaddr = ( char * ) shmat ( m_shmInfo.shmid, NULL, 0 );
+        if ( m_shmInfo.shmaddr != ( char * ) -1 ) {
+          Ximage->data = m_shmInfo.shmaddr;
+          m_shmInfo.readOnly = False;
+
+          // When the X server is remote, XShmAttach() fails asynchronously with a BadAccess error
+          XSync ( display, False );
+          vp_shm_attach_failed = false;
+          XErrorHandler handler = XSetErrorHandler ( vp_shm_error_handler );
+          Status status = XShmAttach ( display, &m_shmInfo );
+          XSync ( display, False );
+          XSetErrorHandler ( handler );
+
+          m_useShm = ( status && ! vp_shm_attach_failed );
+          if ( ! m_useShm )
+            shmdt ( m_shmInfo.shmaddr );
+        }
+        // The segment is released as soon as both the X server and ViSP detach it
+        shmctl ( m_shmInfo.shmid, IPC_RMID, NULL );
+      }
+
+      if ( m_useShm )
+        return;
+
+      Ximage->data = NULL;
+      Ximage->obdata = NULL;
+      XDestroyImage ( Ximage );
+    }
+  }
+#endif
+
+  Ximage = XCreateImage ( display, DefaultVisual ( display, screen ),
+                          screen_depth, ZPixmap, 0, NULL,
+                          m_width, m_height, XBitmapPad ( display ), 0 );
+
+  Ximage->data = ( char * ) malloc ( m_height * (unsigned int)Ximage->bytes_per_line );
+  ximage_data_init = true;
+}
+
+/*!
+  Release the image created by initXImage().
+*/
+void vpDisplayX::releaseXImage()
+{
+  if ( m_useShm ) {
+#ifdef VISP_HAVE_X11_XSHM
+    XShmDetach ( display, &m_shmInfo );
+    XSync ( display, False );
+    shmdt ( m_shmInfo.shmaddr );
+#endif
+    m_useShm = false;
+    m_shmPutPending = false;
+  }
+  else if ( ximage_data_init == true ) {
+    free ( Ximage->data );
+    ximage_data_init = false;
+  }
+
+  Ximage->data = NULL;
+  Ximage->obdata = NULL;
+  XDestroyImage ( Ximage );
+  Ximage = NULL;
+}
+
+/*!
+  Copy a part of the image created by initXImage() in the pixmap.
+*/
+void vpDisplayX::putImage(int src_x, int src_y, int dst_x, int dst_y, unsigned int w, unsigned int h)
+{
+#ifdef VISP_HAVE_X11_XSHM
+  if ( m_useShm ) {
+    XShmPutImage ( display, pixmap, context, Ximage, src_x, src_y, dst_x, dst_y, w, h, False );
+    m_shmPutPending = true;
+    return;
+  }
+#endif
+  XPutImage ( display, pixmap, context, Ximage, src_x, src_y, dst_x, dst_y, w, h );
+}
+
+/*!
+  Wait until the X server has read the shared image data before it is
+  modified.
+*/
+void vpDisplayX::syncXImage()
+{
+  if ( m_shmPutPending ) {
+    XSync ( display, False );
+    m_shmPutPending = false;
+  }
+}
+
+/*!
+  Return the X pixel value of \e color. Colors that are not predefined are
+  allocated once in the colormap and then cached.
+*/
+unsigned long vpDisplayX::getXColor(const vpColor &color)
+{
+  if (color.id < vpColor::id_unknown)
+    return x_color[color.id];
+
+  unsigned int rgb = ((unsigned int)color.R << 16) | ((unsigned int)color.G << 8) | (unsigned int)color.B;
+  std::map<unsigned int, unsigned long>::const_iterator it = m_colorCache.find(rgb);
+  if (it != m_colorCache.end())
+    return it->second;
+
+  xcolor.pad   = 0;
+  xcolor.red   = 256 * color.R;
+  xcolor.green = 256 * color.G;
+  xcolor.blue  = 256 * color.B;
+  XAllocColor ( display, lut, &xcolor );
+  m_colorCache[rgb] = xcolor.pixel;
+
+  return xcolor.pixel;
+}
+
+/*!
+  Return the batch of primitives drawn with the X pixel value \e pixel and
+  the X line width \e thickness.
+*/
+vpDisplayX::vpPrimitiveBatch &vpDisplayX::getBatch(unsigned long pixel, unsigned int thickness)
+{
+  for (size_t i = 0; i < m_batches.size(); i++) {
+    if (m_batches[i].pixel == pixel && m_batches[i].thickness == thickness)
+      return m_batches[i];
+  }
+
+  m_batches.push_back(vpPrimitiveBatch());
+  m_batches.back().pixel = pixel;
+  m_batches.back().thickness = thickness;
+  return m_batches.back();
+}
+
+/*!
+  Draw the buffered lines and points in the pixmap, with one request per
+  color and thickness.
+*/
+void vpDisplayX::flushBatches()
+{
+  for (size_t i = 0; i < m_batches.size(); i++) {
+    vpPrimitiveBatch &batch = m_batches[i];
+    if (batch.segments.empty() && batch.points.empty() && batch.rectangles.empty())
+      continue;
+
+    XSetForeground ( display, context, batch.pixel );
+    // Xlib splits the requests that exceed the maximum request size
+    if (! batch.segments.empty()) {
+      XSetLineAttributes ( display, context, batch.thickness,
+                           LineSolid, CapButt, JoinBevel );
+      XDrawSegments ( display, pixmap, context, &batch.segments[0], (int)batch.segments.size() );
+    }
+    if (! batch.points.empty())
+      XDrawPoints ( display, pixmap, context, &batch.points[0], (int)batch.points.size(), CoordModeOrigin );
+    if (! batch.rectangles.empty())
+      XFillRectangles ( display, pixmap, context, &batch.rectangles[0], (int)batch.rectangles.size() );
+  }
+
+  discardBatches();
+}
+
+/*!
+  Remove the buffered lines and points without drawing them.
+*/
+void vpDisplayX::discardBatches()
+{
+  // Keep the allocated memory for the next frame, unless too many colors were used
+  if (m_batches.size() > 32) {
+    m_batches.clear();
+    return;
+  }
+  for (size_t i = 0; i < m_batches.size(); i++) {
+    m_batches[i].segments.clear();
+    m_batches[i].points.clear();
+    m_batches[i].rectangles.clear();
+  }
+}
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpDisplayX.cpp.o) has no symbols
 void dummy_vpDisplayX() {};
@@ -49,8 +49,8 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpMeterPixelConversion.h>
 #include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
 #include <fstream>
-#include <list>
 #include <vector>
 
 /*!
@@ -61,6 +61,9 @@
 */
 vpPlot::vpPlot() : I(), display(NULL), graphNbr(1), graphList(NULL), margei(30), margej(40),
   factori(1.f), factorj(1.)
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  , m_pending(), m_plotting(), m_pendingMutex(), m_plotMutex(), m_thread(NULL), m_stop(false)
+#endif
 {
 }
 /*!
@@ -84,6 +87,9 @@ vpPlot::vpPlot(const unsigned int graph_nbr,
          const int x, const int y, const std::string &title)
   : I(), display(NULL), graphNbr(1), graphList(NULL), margei(30), margej(40),
     factori(1.f), factorj(1.)
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  , m_pending(), m_plotting(), m_pendingMutex(), m_plotMutex(), m_thread(NULL), m_stop(false)
+#endif
 {  
   init(graph_nbr, height, width, x, y, title);
 }
@@ -133,6 +139,7 @@ void vpPlot::init(const unsigned int graph_nbr,
 */
 vpPlot::~vpPlot()
 {
+  setAsync(false);
   if (graphList != NULL)
   {
     delete[] graphList;
@@ -202,6 +209,7 @@ vpPlot::initNbGraph (unsigned int nbGraph)
 void
 vpPlot::initGraph (unsigned int graphNum, unsigned int curveNbr)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->initGraph(curveNbr);
 }
 
@@ -229,6 +237,7 @@ vpPlot::initRange (const unsigned int graphNum,
 		   double xmin, double xmax, 
 		   double ymin, double ymax)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->initScale(I,xmin,xmax,10,ymin,ymax,10,true,true);
 }
 
@@ -248,6 +257,7 @@ vpPlot::initRange (const unsigned int graphNum,
 		   double xmin, double xmax, double ymin, 
 		   double ymax, double zmin, double zmax)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->initScale(I,xmin,xmax,10,ymin,ymax,10,zmin,zmax,10,true,true);
 }
 
@@ -261,6 +271,7 @@ vpPlot::initRange (const unsigned int graphNum,
 void
 vpPlot::setColor (const unsigned int graphNum, const unsigned int curveNum, vpColor color)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setCurveColor(curveNum, color);
 }
 
@@ -281,10 +292,24 @@ vpPlot::displayGrid()
   \param curveNum : The index of the curve in the list of the curves belonging to the graphic.
   \param x : The coordinate of the new point along the x axis and given in the user unit system.
   \param y : The coordinate of the new point along the y axis and given in the user unit system.
+
+  \sa setAsync()
 */
 void
 vpPlot::plot (const unsigned int graphNum, const unsigned int curveNum, const double x, const double y)
 {
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_thread != NULL) {
+    vpPendingPoint point;
+    point.graphNum = graphNum;
+    point.curveNum = curveNum;
+    point.x = x;
+    point.y = y;
+    vpMutex::vpScopedLock lock(m_pendingMutex);
+    m_pending.push_back(point);
+    return;
+  }
+#endif
   (graphList+graphNum)->plot(I,curveNum,x,y);
 }
 
@@ -394,6 +419,7 @@ void vpPlot::plot(const unsigned int graphNum,
 vpMouseButton::vpMouseButtonType
 vpPlot::plot (const unsigned int graphNum, const unsigned int curveNum, const double x, const double y, const double z)
 {
+  vpPlotLock lock(*this);
   return (graphList+graphNum)->plot(I,curveNum,x,y,z);
 }
 
@@ -429,6 +455,7 @@ vpPlot::plot(const unsigned int graphNum, const double x, const vpColVector &v_y
 void
 vpPlot::navigate()
 {
+  vpPlotLock lock(*this);
   vpMouseButton::vpMouseButtonType b = vpMouseButton::none;
   
   bool blocked = false;
@@ -474,6 +501,7 @@ vpPlot::navigate()
 void
 vpPlot::getPixelValue(const bool block)
 {
+  vpPlotLock lock(*this);
   vpImagePoint iP;
   
   if (block)
@@ -496,6 +524,7 @@ vpPlot::getPixelValue(const bool block)
 void
 vpPlot::setTitle (const unsigned int graphNum, const std::string &title)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setTitle(title);
 }
 
@@ -508,6 +537,7 @@ vpPlot::setTitle (const unsigned int graphNum, const std::string &title)
 void
 vpPlot::setUnitX (const unsigned int graphNum, const std::string &unitx)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setUnitX(unitx);
 }
 
@@ -520,6 +550,7 @@ vpPlot::setUnitX (const unsigned int graphNum, const std::string &unitx)
 void
 vpPlot::setUnitY (const unsigned int graphNum, const std::string &unity)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setUnitY(unity);
 }
 
@@ -532,6 +563,7 @@ vpPlot::setUnitY (const unsigned int graphNum, const std::string &unity)
 void
 vpPlot::setUnitZ (const unsigned int graphNum, const std::string &unitz)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setUnitZ(unitz);
 }
 
@@ -545,6 +577,7 @@ vpPlot::setUnitZ (const unsigned int graphNum, const std::string &unitz)
 void
 vpPlot::setLegend (const unsigned int graphNum, const unsigned int curveNum, const std::string &legend)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setLegend(curveNum, legend);
 }
 
@@ -556,6 +589,7 @@ vpPlot::setLegend (const unsigned int graphNum, const unsigned int curveNum, con
 void 
 vpPlot::resetPointList (const unsigned int graphNum)
 {
+  vpPlotLock lock(*this);
   for (unsigned int i = 0; i < (graphList+graphNum)->curveNbr; i++)
     (graphList+graphNum)->resetPointList(i);
 }
@@ -570,6 +604,7 @@ This function enables you to choose the thickness used to draw a given curve.
 void
 vpPlot::setThickness (const unsigned int graphNum, const unsigned int curveNum, const unsigned int thickness)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setCurveThickness(curveNum, thickness);
 }
 
@@ -582,6 +617,7 @@ This function enables you to choose the thickness used to draw all the curves be
 void
 vpPlot::setGraphThickness (const unsigned int graphNum, const unsigned int thickness)
 {
+  vpPlotLock lock(*this);
   for (unsigned int curveNum=0; curveNum < (graphList+graphNum)->curveNbr; curveNum++)
     (graphList+graphNum)->setCurveThickness(curveNum, thickness);
 }
@@ -595,6 +631,7 @@ vpPlot::setGraphThickness (const unsigned int graphNum, const unsigned int thick
 void
 vpPlot::setGridThickness (const unsigned int graphNum, const unsigned int thickness)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->setGridThickness(thickness);
 }
 
@@ -607,6 +644,7 @@ vpPlot::setGridThickness (const unsigned int graphNum, const unsigned int thickn
 void 
 vpPlot::resetPointList (const unsigned int graphNum, const unsigned int curveNum)
 {
+  vpPlotLock lock(*this);
   (graphList+graphNum)->resetPointList(curveNum);
 }
 
@@ -633,81 +671,154 @@ vpPlot::resetPointList (const unsigned int graphNum, const unsigned int curveNum
 */
 void vpPlot::saveData(const unsigned int graphNum, const std::string &dataFile, const std::string &title_prefix)
 {
+  vpPlotLock lock(*this);
+
   std::ofstream fichier;
   fichier.open(dataFile.c_str());
 
-  unsigned int ind;
-  double *p = new double[3];
-  bool end=false;
-
-  std::vector< std::list<double>::const_iterator > vec_iter_pointListx((graphList+graphNum)->curveNbr);
-  std::vector< std::list<double>::const_iterator > vec_iter_pointListy((graphList+graphNum)->curveNbr);
-  std::vector< std::list<double>::const_iterator > vec_iter_pointListz((graphList+graphNum)->curveNbr);
-
-  fichier << title_prefix << (graphList+graphNum)->title << std::endl;
+  vpPlotGraph *graph = graphList+graphNum;
+  fichier << title_prefix << graph->title << std::endl;
 
-  for(ind=0;ind<(graphList+graphNum)->curveNbr;ind++)
-  {
-    vec_iter_pointListx[ind] = (graphList+graphNum)->curveList[ind].pointListx.begin();
-    vec_iter_pointListy[ind] = (graphList+graphNum)->curveList[ind].pointListy.begin();
-    vec_iter_pointListz[ind] = (graphList+graphNum)->curveList[ind].pointListz.begin();
-//    (graphList+graphNum)->curveList[ind].pointListx.front();
-//    (graphList+graphNum)->curveList[ind].pointListy.front();
-//    (graphList+graphNum)->curveList[ind].pointListz.front();
+  unsigned int nbPoint = 0;
+  for (unsigned int ind = 0; ind < graph->curveNbr; ind++) {
+    if (graph->curveList[ind].nbPoint > nbPoint)
+      nbPoint = graph->curveList[ind].nbPoint;
   }
 
-  while (end == false)
-  {
-    end = true;
-    for(ind=0;ind<(graphList+graphNum)->curveNbr;ind++)
-    {
-//      if (!(graphList+graphNum)->curveList[ind].pointListx.outside()
-//          && !(graphList+graphNum)->curveList[ind].pointListy.outside()
-//          && !(graphList+graphNum)->curveList[ind].pointListz.outside())
-      if((vec_iter_pointListx[ind] != (graphList+graphNum)->curveList[ind].pointListx.end())
-        && (vec_iter_pointListy[ind] != (graphList+graphNum)->curveList[ind].pointListy.end())
-        && (vec_iter_pointListz[ind] != (graphList+graphNum)->curveList[ind].pointListz.end()))
-      {
-        p[0] = *vec_iter_pointListx[ind];
-        p[1] = *vec_iter_pointListy[ind];
-        p[2] = *vec_iter_pointListz[ind];
-//        p[0] = (graphList+graphNum)->curveList[ind].pointListx.value();
-//        p[1] = (graphList+graphNum)->curveList[ind].pointListy.value();
-//        p[2] = (graphList+graphNum)->curveList[ind].pointListz.value();
-
-        fichier << p[0] << "\t" << p[1] << "\t" << p[2] << "\t";
-        ++vec_iter_pointListx[ind];
-        ++vec_iter_pointListy[ind];
-        ++vec_iter_pointListz[ind];
-//        (graphList+graphNum)->curveList[ind].pointListx.next();
-//        (graphList+graphNum)->curveList[ind].pointListy.next();
-//        (graphList+graphNum)->curveList[ind].pointListz.next();
-//        if(!(graphList+graphNum)->curveList[ind].pointListx.nextOutside()
-//           && !(graphList+graphNum)->curveList[ind].pointListy.nextOutside()
-//           && !(graphList+graphNum)->curveList[ind].pointListz.nextOutside())
-        if((vec_iter_pointListx[ind] != (graphList+graphNum)->curveList[ind].pointListx.end())
-          && (vec_iter_pointListy[ind] != (graphList+graphNum)->curveList[ind].pointListy.end())
-          && (vec_iter_pointListz[ind] != (graphList+graphNum)->curveList[ind].pointListz.end()))
-          end = false;
-      }
+  double x, y, z;
+  for (unsigned int k = 0; k < nbPoint; k++) {
+    for (unsigned int ind = 0; ind < graph->curveNbr; ind++) {
+      const vpPlotCurve &curve = graph->curveList[ind];
+      // A curve with less points repeats its last one
+      if (k < curve.nbPoint)
+        curve.getPoint(k, x, y, z);
+      else if (curve.nbPoint > 0)
+        curve.getPoint(curve.nbPoint - 1, x, y, z);
       else
-      {
-//        p[0] = (graphList+graphNum)->curveList[ind].pointListx.value();
-//        p[1] = (graphList+graphNum)->curveList[ind].pointListy.value();
-//        p[2] = (graphList+graphNum)->curveList[ind].pointListz.value();
-        p[0] = (graphList+graphNum)->curveList[ind].pointListx.back();
-        p[1] = (graphList+graphNum)->curveList[ind].pointListy.back();
-        p[2] = (graphList+graphNum)->curveList[ind].pointListz.back();
-        fichier << p[0] << "\t" << p[1] << "\t" << p[2] << "\t";
-      }
+        x = y = z = 0;
+      fichier << x << "\t" << y << "\t" << z << "\t";
     }
     fichier << std::endl;
   }
 
-  delete[] p;
   fichier.close();
 }
 
+/*!
+  Set the font of the characters. The display should be initialized before.
+
+  To know which font are available, on Unix you can use xfontsel or xlsfonts utilities.
+*/
+void vpPlot::setFont(const std::string &font)
+{
+  vpPlotLock lock(*this);
+  if (display->isInitialised())
+    vpDisplay::setFont(I, font.c_str());
+}
+
+/*!
+  Set the maximum number of points kept for each curve of a graphic. When a
+  curve reaches this number of points, each new point replaces the oldest
+  one, so that the memory used by the plotter does not grow any more. The
+  points that are no longer kept are neither redrawn when the range of the
+  graphic changes, nor saved by saveData().
+
+  This method has to be called after initGraph(). If a curve already has more
+  points, only the most recent ones are kept.
+
+  \param graphNum : The index of the graph in the window. As the number of graphic in a window is less or equal to 4, this parameter is between 0 and 3.
+  \param maxPoints : Maximum number of points per curve. 0, the default, keeps all the points.
+*/
+void vpPlot::setMaxPoints(const unsigned int graphNum, const unsigned int maxPoints)
+{
+  vpPlotLock lock(*this);
+  for (unsigned int i = 0; i < (graphList+graphNum)->curveNbr; i++)
+    (graphList+graphNum)->curveList[i].setMaxPoint(maxPoints);
+}
+
+/*!
+  Enable or disable the drawing of the 2D curves by a background thread.
+
+  When enabled, plot(const unsigned int, const unsigned int, const double, const double)
+  and the plot() methods that add a point to all the curves of a 2D graphic
+  only queue the points and return. A background thread draws the queued
+  points about every 10 ms. The other methods of the class wait until the
+  thread is not drawing and first draw the queued points themselves. The 3D
+  graphics are always drawn by the caller.
+
+  Disabling the asynchronous mode draws the remaining points and stops the
+  thread. Without pthread or Windows threading support, this method has no
+  effect.
+
+  \param async : true to draw the 2D curves in a background thread.
+*/
+void vpPlot::setAsync(const bool async)
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (async && m_thread == NULL) {
+    m_stop = false;
+    m_thread = new vpThread((vpThread::Fn)plotThread, (vpThread::Args)this);
+  }
+  else if (!async && m_thread != NULL) {
+    m_plotMutex.lock();
+    m_stop = true;
+    m_plotMutex.unlock();
+    delete m_thread; // Join the thread, which draws the remaining points
+    m_thread = NULL;
+  }
+#else
+  (void)async;
+#endif
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+vpPlot::vpPlotLock::vpPlotLock(vpPlot &plot) : m_plot(plot)
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  m_plot.m_plotMutex.lock();
+  m_plot.plotPending();
+#endif
+}
+
+vpPlot::vpPlotLock::~vpPlotLock()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  m_plot.m_plotMutex.unlock();
+#endif
+}
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+// Draw the points queued by plot(). m_plotMutex has to be locked.
+void vpPlot::plotPending()
+{
+  m_pendingMutex.lock();
+  m_plotting.swap(m_pending);
+  m_pendingMutex.unlock();
+
+  for (size_t i = 0; i < m_plotting.size(); i++) {
+    const vpPendingPoint &point = m_plotting[i];
+    (graphList+point.graphNum)->plot(I, point.curveNum, point.x, point.y);
+  }
+  m_plotting.clear();
+}
+
+vpThread::Return vpPlot::plotThread(vpThread::Args args)
+{
+  vpPlot *plot = (vpPlot *)args;
+  for (;;) {
+    plot->m_plotMutex.lock();
+    plot->plotPending();
+    bool stop = plot->m_stop;
+    plot->m_plotMutex.unlock();
+    if (stop)
+      break;
+    vpTime::sleepMs(10);
+  }
+  return 0;
+}
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpPlot.cpp.o) has no symbols
 void dummy_vpPlot() {};
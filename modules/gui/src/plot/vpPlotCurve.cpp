@@ -44,10 +44,11 @@
 #include <visp3/gui/vpDisplayGDI.h>
 #include <visp3/gui/vpDisplayGTK.h>
 #include <visp3/gui/vpDisplayD3D.h>
+#include <visp3/core/vpMath.h>
 
 #if defined(VISP_HAVE_DISPLAY)
 vpPlotCurve::vpPlotCurve() :
-  color(vpColor::red), curveStyle(point), thickness(1), nbPoint(0), lastPoint(),
+  color(vpColor::red), curveStyle(point), thickness(1), nbPoint(0), maxPoint(0), startPoint(0), lastPoint(),
   pointListx(), pointListy(), pointListz(), legend(), xmin(0), xmax(0), ymin(0), ymax(0)
 {
 }
@@ -59,12 +60,68 @@ vpPlotCurve::~vpPlotCurve()
   pointListz.clear();
 }
 
+/*
+  Store a new point. When the number of stored points reaches maxPoint, the
+  oldest one is overwritten.
+*/
+void
+vpPlotCurve::addPoint(const double x, const double y, const double z)
+{
+  if (maxPoint == 0 || nbPoint < maxPoint) {
+    pointListx.push_back(x);
+    pointListy.push_back(y);
+    pointListz.push_back(z);
+    nbPoint++;
+  }
+  else {
+    pointListx[startPoint] = x;
+    pointListy[startPoint] = y;
+    pointListz[startPoint] = z;
+    if (++startPoint == nbPoint)
+      startPoint = 0;
+  }
+}
+
+void
+vpPlotCurve::clearPointList()
+{
+  // The memory is kept to be reused by the next points
+  pointListx.clear();
+  pointListy.clear();
+  pointListz.clear();
+  nbPoint = 0;
+  startPoint = 0;
+}
+
+/*
+  Set the maximum number of stored points, 0 meaning unbounded. If more
+  points are already stored, only the most recent ones are kept.
+*/
+void
+vpPlotCurve::setMaxPoint(const unsigned int n)
+{
+  unsigned int kept = (n > 0 && nbPoint > n) ? n : nbPoint;
+  std::vector<double> x(kept), y(kept), z(kept);
+  for (unsigned int k = 0; k < kept; k++)
+    getPoint(nbPoint - kept + k, x[k], y[k], z[k]);
+
+  pointListx.swap(x);
+  pointListy.swap(y);
+  pointListz.swap(z);
+  if (n > 0) {
+    pointListx.reserve(n);
+    pointListy.reserve(n);
+    pointListz.reserve(n);
+  }
+  nbPoint = kept;
+  startPoint = 0;
+  maxPoint = n;
+}
+
 void
 vpPlotCurve::plotPoint(const vpImage<unsigned char> &I, const vpImagePoint &iP, const double x, const double y)
 {  
-  nbPoint++;
-  
-  if (nbPoint > 1)
+  if (nbPoint > 0)
   {
     vpDisplay::displayLine(I,lastPoint, iP, color, thickness);
   }
@@ -81,32 +138,51 @@ vpPlotCurve::plotPoint(const vpImage<unsigned char> &I, const vpImagePoint &iP,
   vpDisplay::flushROI(I,vpRect(left,top,width,height));
 #endif
   lastPoint = iP;
-  pointListx.push_back(x);
-  pointListy.push_back(y);
-  pointListz.push_back(0.0);
+  addPoint(x, y, 0.0);
 }
 
+/*
+  Draw all the stored points. Consecutive points that fall in the same pixel
+  column are reduced to a vertical segment between their extreme rows, so that
+  the number of drawn lines depends on the width of the graphic rather than
+  on the number of points.
+*/
 void 
 vpPlotCurve::plotList(const vpImage<unsigned char> &I, const double xorg, const double yorg, const double zoomx, const double zoomy)
 {
-  std::list<double>::const_iterator it_ptListx = pointListx.begin();
-  std::list<double>::const_iterator it_ptListy = pointListy.begin();
-  
-  unsigned int k = 0;
-  vpImagePoint iP;
-  while (k < nbPoint)
+  if (nbPoint == 0)
+    return;
+
+  double x, y, z;
+  getPoint(0, x, y, z);
+  vpImagePoint iP(yorg-(zoomy*y), xorg+(zoomx*x));
+  int column = vpMath::round(iP.get_j());
+  double imin = iP.get_i();
+  double imax = imin;
+  lastPoint = iP;
+
+  for (unsigned int k = 1; k < nbPoint; k++)
   {
-    iP.set_ij(yorg-(zoomy*(*it_ptListy)),xorg+(zoomx*(*it_ptListx)));
-    
-    if (k > 0)
-      vpDisplay::displayLine(I,lastPoint, iP, color, thickness);
-    
+    getPoint(k, x, y, z);
+    iP.set_ij(yorg-(zoomy*y), xorg+(zoomx*x));
+    int c = vpMath::round(iP.get_j());
+    if (c != column)
+    {
+      if (imax > imin)
+        vpDisplay::displayLine(I, vpImagePoint(imin, column), vpImagePoint(imax, column), color, thickness);
+      vpDisplay::displayLine(I, lastPoint, iP, color, thickness);
+      column = c;
+      imin = imax = iP.get_i();
+    }
+    else if (iP.get_i() < imin)
+      imin = iP.get_i();
+    else if (iP.get_i() > imax)
+      imax = iP.get_i();
+
     lastPoint = iP;
-    
-    ++it_ptListx;
-    ++it_ptListy;
-    k++;
   }
+  if (imax > imin)
+    vpDisplay::displayLine(I, vpImagePoint(imin, column), vpImagePoint(imax, column), color, thickness);
 }
 
 #elif !defined(VISP_BUILD_SHARED_LIBS)
@@ -101,8 +101,7 @@ vpPlotGraph::initGraph (unsigned int nbCurve)
   {
     (curveList+i)->color = colors[i%6]; 
     (curveList+i)->curveStyle = line;
-    (curveList+i)->pointListx.clear();
-    (curveList+i)->pointListy.clear();
+    (curveList+i)->clearPointList();
     (curveList+i)->legend.clear();
   }
 }
@@ -625,10 +624,7 @@ vpPlotGraph::getPixelValue(vpImage<unsigned char> &I, vpImagePoint &iP)
 void 
 vpPlotGraph::resetPointList(const unsigned int curveNum)
 {
-  (curveList+curveNum)->pointListx.clear();
-  (curveList+curveNum)->pointListy.clear();
-  (curveList+curveNum)->pointListz.clear();
-  (curveList+curveNum)->nbPoint = 0;
+  (curveList+curveNum)->clearPointList();
   firstPoint = true;
 }
 
@@ -1194,7 +1190,6 @@ vpPlotGraph::plot (vpImage<unsigned char> &I, const unsigned int curveNb, const
   iP.set_uv(u,v);
   iP = iP + dTopLeft3D;
   
-  (curveList+curveNb)->pointListz.end();
   if((curveList+curveNb)->nbPoint)
   {
     if (check3Dline((curveList+curveNb)->lastPoint,iP))
@@ -1214,10 +1209,7 @@ vpPlotGraph::plot (vpImage<unsigned char> &I, const unsigned int curveNb, const
 #endif
   
   (curveList+curveNb)->lastPoint = iP;
-  (curveList+curveNb)->pointListx.push_back(x);
-  (curveList+curveNb)->pointListy.push_back(y);
-  (curveList+curveNb)->pointListz.push_back(z);
-  (curveList+curveNb)->nbPoint++;
+  (curveList+curveNb)->addPoint(x, y, z);
   
 #if( !defined VISP_HAVE_X11 && defined FLUSH_ON_PLOT)  
   vpDisplay::flushROI(I,graphZone);
@@ -1233,18 +1225,12 @@ vpPlotGraph::replot3D (vpImage<unsigned char> &I)
   
   for (unsigned int i = 0; i < curveNbr; i++)
   {
-    std::list<double>::const_iterator it_ptListx = (curveList+i)->pointListx.begin();
-    std::list<double>::const_iterator it_ptListy = (curveList+i)->pointListy.begin();
-    std::list<double>::const_iterator it_ptListz = (curveList+i)->pointListz.begin();
-  
-    unsigned int k = 0;
     vpImagePoint iP;
     vpPoint pointPlot;
-    while (k < (curveList+i)->nbPoint)
+    double x, y, z;
+    for (unsigned int k = 0; k < (curveList+i)->nbPoint; k++)
     {
-      double x = *it_ptListx;
-      double y = *it_ptListy;
-      double z = *it_ptListz;
+      (curveList+i)->getPoint(k, x, y, z);
       pointPlot.setWorldCoordinates(ptXorg+(zoomx_3D*x),ptYorg-(zoomy_3D*y),ptZorg+(zoomz_3D*z));
       pointPlot.track(cMo);
       double u=0.0, v=0.0;
@@ -1255,17 +1241,17 @@ vpPlotGraph::replot3D (vpImage<unsigned char> &I)
       //vpDisplay::displayCross(I,iP,3,vpColor::cyan);
       if (k > 0)
       {
+        // Skip the points that fall in the same pixel as the previous drawn one
+        if (vpMath::round(iP.get_i()) == vpMath::round((curveList+i)->lastPoint.get_i())
+            && vpMath::round(iP.get_j()) == vpMath::round((curveList+i)->lastPoint.get_j())
+            && k+1 < (curveList+i)->nbPoint)
+          continue;
         if (check3Dline((curveList+i)->lastPoint,iP))
           vpDisplay::displayLine(I,(curveList+i)->lastPoint, iP, (curveList+i)->color);
         //vpDisplay::displayCross(I,iP,3,vpColor::orange);
       }
     
       (curveList+i)->lastPoint = iP;
-    
-      ++it_ptListx;
-      ++it_ptListy;
-      ++it_ptListz;
-      k++;
     }
   }
   vpDisplay::flushROI(I,graphZone);
@@ -0,0 +1,298 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the offscreen display.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testDisplayOffscreen.cpp
+
+  \brief Test the rendering of the overlay primitives by the offscreen
+  display and measure the time needed to annotate an image.
+*/
+
+#include <stdlib.h>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/gui/vpDisplayOffscreen.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+
+// List of allowed command line options
+#define GETOPTARGS	"cdho:"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv, std::string &opath);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+ */
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the offscreen display that renders the overlay in an image.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output image>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output image>\n\
+     Save the annotated image in this file.\n\
+\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param opath : Output image.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv, std::string &opath)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'o': opath = optarg_; break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  bool sameColor(const vpRGBa &a, const vpColor &c)
+  {
+    return a.R == c.R && a.G == c.G && a.B == c.B;
+  }
+
+  void check(bool condition, const std::string &message)
+  {
+    if (! condition)
+      throw vpException(vpException::fatalError, "%s", message.c_str());
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    std::string opath;
+    if (getOptions(argc, argv, opath) == false) {
+      exit (-1);
+    }
+
+    const vpColor grey(100, 100, 100);
+    vpImage<unsigned char> I(480, 640, 100);
+    vpDisplayOffscreen d(I);
+    const vpImage<vpRGBa> &canvas = d.getCanvas();
+    check(canvas.getHeight() == 480 && canvas.getWidth() == 640, "Bad canvas size");
+
+    vpDisplay::display(I);
+    check(sameColor(canvas[0][0], grey) && sameColor(canvas[479][639], grey), "Image not displayed");
+
+    // Lines
+    vpDisplay::displayLine(I, vpImagePoint(10, 10), vpImagePoint(10, 100), vpColor::red);
+    check(sameColor(canvas[10][10], vpColor::red) && sameColor(canvas[10][100], vpColor::red), "Line extremities");
+    check(sameColor(canvas[10][50], vpColor::red) && sameColor(canvas[11][50], grey), "Horizontal line");
+    vpDisplay::displayLine(I, vpImagePoint(20, 20), vpImagePoint(120, 120), vpColor::green, 5);
+    check(sameColor(canvas[70][70], vpColor::green) && sameColor(canvas[70][72], vpColor::green), "Thick line");
+    check(sameColor(canvas[70][76], grey), "Thick line width");
+    vpDisplay::displayDotLine(I, vpImagePoint(30, 200), vpImagePoint(30, 300), vpColor::blue);
+    check(sameColor(canvas[30][200], vpColor::blue) && sameColor(canvas[30][205], grey), "Dashed line");
+
+    // Points, cross, rectangles
+    vpDisplay::displayPoint(I, vpImagePoint(200, 10), vpColor::yellow);
+    check(sameColor(canvas[200][10], vpColor::yellow) && sameColor(canvas[200][11], grey), "Point");
+    vpDisplay::displayCross(I, vpImagePoint(200, 50), 10, vpColor::cyan);
+    check(sameColor(canvas[195][50], vpColor::cyan) && sameColor(canvas[200][55], vpColor::cyan), "Cross");
+    check(sameColor(canvas[197][52], grey), "Cross center");
+    vpDisplay::displayRectangle(I, vpImagePoint(300, 10), 20, 10, vpColor::orange, true);
+    check(sameColor(canvas[300][10], vpColor::orange) && sameColor(canvas[309][29], vpColor::orange), "Filled rectangle");
+    check(sameColor(canvas[310][10], grey) && sameColor(canvas[300][30], grey), "Filled rectangle size");
+    vpDisplay::displayRectangle(I, vpImagePoint(300, 100), 20, 10, vpColor::purple, false);
+    check(sameColor(canvas[300][110], vpColor::purple) && sameColor(canvas[310][120], vpColor::purple), "Rectangle");
+    check(sameColor(canvas[305][110], grey), "Rectangle inside");
+
+    // Circles
+    vpDisplay::displayCircle(I, vpImagePoint(240, 320), 50, vpColor::red);
+    check(sameColor(canvas[240][370], vpColor::red) && sameColor(canvas[190][320], vpColor::red), "Circle");
+    check(sameColor(canvas[240][320], grey) && sameColor(canvas[240][372], grey), "Circle inside and outside");
+    vpDisplay::displayCircle(I, vpImagePoint(240, 500), 20, vpColor::green, true);
+    check(sameColor(canvas[240][500], vpColor::green) && sameColor(canvas[255][500], vpColor::green), "Disk");
+    check(sameColor(canvas[240][522], grey), "Disk outside");
+
+    // Polygon
+    std::vector<vpImagePoint> triangle;
+    triangle.push_back(vpImagePoint(400, 400));
+    triangle.push_back(vpImagePoint(400, 500));
+    triangle.push_back(vpImagePoint(460, 450));
+    d.displayPolygon(triangle, vpColor::blue, true);
+    check(sameColor(canvas[420][450], vpColor::blue) && sameColor(canvas[420][405], grey), "Filled polygon");
+
+    // Text
+    vpDisplay::displayText(I, vpImagePoint(100, 300), "ViSP", vpColor::white);
+    unsigned int nbTextPixels = 0;
+    for (unsigned int i = 90; i < 105; i++)
+      for (unsigned int j = 300; j < 340; j++)
+        nbTextPixels += sameColor(canvas[i][j], vpColor::white) ? 1 : 0;
+    check(nbTextPixels > 20 && nbTextPixels < 200, "Text");
+
+    // No window events
+    check(! vpDisplay::getClick(I) && ! vpDisplay::getKeyboardEvent(I), "Events");
+
+    // Annotated image
+    vpDisplay::flush(I);
+    vpImage<vpRGBa> Iannotated;
+    vpDisplay::getImage(I, Iannotated);
+    check(Iannotated == canvas, "Annotated image");
+    if (! opath.empty())
+      vpImageIo::write(Iannotated, opath);
+
+    // Anti-aliasing blends the line color with the background
+    d.setAntialiasing(true);
+    vpDisplay::display(I);
+    vpDisplay::displayLine(I, vpImagePoint(10.5, 10), vpImagePoint(10.5, 100), vpColor::white);
+    check(canvas[10][50].R > 150 && canvas[10][50].R < 200 && canvas[10][50].R == canvas[11][50].R, "Anti-aliased line");
+    d.setAntialiasing(false);
+
+    // Down scaled color image
+    {
+      vpImage<vpRGBa> Irgba(480, 640, vpRGBa(10, 20, 30, vpRGBa::alpha_default));
+      vpDisplayOffscreen d2(Irgba, vpDisplay::SCALE_2);
+      check(d2.getCanvas().getHeight() == 240 && d2.getCanvas().getWidth() == 320, "Down scaled canvas size");
+      vpDisplay::display(Irgba);
+      vpDisplay::displayPoint(Irgba, vpImagePoint(100, 100), vpColor::red);
+      check(sameColor(d2.getCanvas()[50][50], vpColor::red) && d2.getCanvas()[0][0].B == 30, "Down scaled canvas");
+    }
+
+    // Huge and non finite coordinates neither overflow nor draw outside the canvas
+    {
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      const double inf = std::numeric_limits<double>::infinity();
+      vpDisplay::display(I);
+      vpDisplay::displayLine(I, vpImagePoint(50, -1e12), vpImagePoint(50, 1e12), vpColor::red);
+      check(sameColor(canvas[50][0], vpColor::red) && sameColor(canvas[50][639], vpColor::red), "Line with huge coordinates");
+      vpDisplay::displayLine(I, vpImagePoint(60, -inf), vpImagePoint(60, inf), vpColor::red, 3);
+      vpDisplay::displayLine(I, vpImagePoint(nan, 10), vpImagePoint(70, nan), vpColor::red);
+      vpDisplay::displayPoint(I, vpImagePoint(1e12, -1e12), vpColor::red);
+      vpDisplay::displayPoint(I, vpImagePoint(nan, nan), vpColor::red, 3);
+      vpDisplay::displayCross(I, vpImagePoint(-1e15, 1e15), 10, vpColor::red);
+      vpDisplay::displayRectangle(I, vpImagePoint(-1e12, -1e12), vpImagePoint(1e12, 1e12), vpColor::red);
+      vpDisplay::displayCircle(I, vpImagePoint(1e12, 1e12), 10, vpColor::red);
+      vpDisplay::displayCircle(I, vpImagePoint(240, 320), std::numeric_limits<unsigned int>::max(), vpColor::red);
+      vpDisplay::displayCircle(I, vpImagePoint(nan, 320), 10, vpColor::red, true);
+      vpDisplay::displayText(I, vpImagePoint(inf, -inf), "ViSP", vpColor::red);
+      std::vector<vpImagePoint> polygon(triangle);
+      polygon.push_back(vpImagePoint(nan, 1e12));
+      d.displayPolygon(polygon, vpColor::red, true);
+      for (unsigned int i = 0; i < canvas.getHeight(); i++) {
+        for (unsigned int j = 0; j < canvas.getWidth(); j++) {
+          // Only the lines of rows 50 and 60 may cross the canvas
+          if (i != 50 && (i < 59 || i > 61) && ! sameColor(canvas[i][j], grey))
+            check(false, "Primitive with huge or non finite coordinates drawn in the canvas");
+        }
+      }
+    }
+
+    // Annotation of 640x480 frames with many primitives
+    std::vector<vpImagePoint> sites;
+    for (unsigned int k = 0; k < 2000; k++)
+      sites.push_back(vpImagePoint(20 + (k * 7) % 440, 20 + (k * 13) % 600));
+
+    const unsigned int nbFrames = 100;
+    for (int aa = 0; aa < 2; aa++) {
+      d.setAntialiasing(aa == 1);
+      double t = vpTime::measureTimeMs();
+      for (unsigned int frame = 0; frame < nbFrames; frame++) {
+        vpDisplay::display(I);
+        for (size_t k = 0; k < sites.size(); k++)
+          vpDisplay::displayCross(I, sites[k], 5, vpColor::green);
+        d.displayPoints(sites, vpColor::red);
+        vpDisplay::displayRectangle(I, vpImagePoint(100, 100), 200, 150, vpColor::blue, false, 2);
+        vpDisplay::displayCircle(I, vpImagePoint(240, 320), 100, vpColor::yellow, false, 2);
+        vpDisplay::displayText(I, vpImagePoint(20, 20), "Frame", vpColor::red);
+        vpDisplay::flush(I);
+      }
+      t = (vpTime::measureTimeMs() - t) / nbFrames;
+      std::cout << "Annotation of a 640x480 frame with " << sites.size() << " crosses and points"
+                << (aa ? " with" : " without") << " anti-aliasing: " << t << " ms" << std::endl;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return 0;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,267 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the storage and the redraw of the curves of vpPlot.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPlotCurve.cpp
+
+  \brief Test the ring buffer that stores the points of a vpPlot curve, check
+  with an offscreen display that the decimated redraw covers the same pixels
+  than the curve, and measure the redraw time.
+*/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/gui/vpDisplayOffscreen.h>
+#include <visp3/gui/vpPlotCurve.h>
+#include <visp3/io/vpParseArgv.h>
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+ */
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the storage and the redraw of the curves of vpPlot.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+#if defined(VISP_HAVE_DISPLAY)
+
+namespace {
+  void check(bool condition, const std::string &message)
+  {
+    if (! condition)
+      throw vpException(vpException::fatalError, "%s", message.c_str());
+  }
+
+  // Check that the points of the curve are first, first+1, ... in this order
+  void checkPoints(const vpPlotCurve &curve, unsigned int nbPoint, double first, const std::string &message)
+  {
+    check(curve.nbPoint == nbPoint, message + ": bad number of points");
+    double x, y, z;
+    for (unsigned int k = 0; k < curve.nbPoint; k++) {
+      curve.getPoint(k, x, y, z);
+      check(x == first + k && y == 2 * x && z == -x, message + ": bad point");
+    }
+  }
+
+  void addPoints(vpPlotCurve &curve, unsigned int first, unsigned int last)
+  {
+    for (unsigned int k = first; k < last; k++)
+      curve.addPoint(k, 2. * k, -1. * k);
+  }
+
+  bool isDrawn(const vpRGBa &c)
+  {
+    return c.R != 255 || c.G != 255 || c.B != 255;
+  }
+
+  // Signal oscillating much faster than the pixel columns
+  double signal(unsigned int k)
+  {
+    return sin(0.3 * k) * (1 + 0.5 * sin(1e-4 * k));
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    if (getOptions(argc, argv) == false) {
+      exit (-1);
+    }
+
+    // Unbounded storage keeps all the points
+    vpPlotCurve curve;
+    addPoints(curve, 0, 250);
+    checkPoints(curve, 250, 0, "Unbounded curve");
+
+    // The ring buffer keeps the most recent points in order
+    curve.clearPointList();
+    checkPoints(curve, 0, 0, "Cleared curve");
+    curve.setMaxPoint(100);
+    addPoints(curve, 0, 250);
+    checkPoints(curve, 100, 150, "Ring buffer");
+    check(curve.pointListx.size() == 100, "The ring buffer should not grow");
+
+    // Reducing the capacity keeps the most recent points
+    curve.setMaxPoint(30);
+    checkPoints(curve, 30, 220, "Reduced capacity");
+    addPoints(curve, 250, 265);
+    checkPoints(curve, 30, 235, "Reduced capacity after new points");
+
+    // Increasing the capacity or removing it keeps the stored points
+    curve.setMaxPoint(40);
+    addPoints(curve, 265, 270);
+    checkPoints(curve, 35, 235, "Increased capacity");
+    curve.setMaxPoint(0);
+    addPoints(curve, 270, 400);
+    checkPoints(curve, 165, 235, "Capacity removed");
+
+    // Decimated redraw of a curve with much more points than pixel columns
+    const double xorg = 50, yorg = 100, zoomx = 300, zoomy = 50;
+    const unsigned int nbPoint = 200000;
+    vpImage<unsigned char> I(200, 400, 255);
+    vpDisplayOffscreen d(I);
+    const vpImage<vpRGBa> &canvas = d.getCanvas();
+
+    vpPlotCurve signalCurve;
+    for (unsigned int k = 0; k < nbPoint; k++)
+      signalCurve.addPoint(k / (double)nbPoint, signal(k), 0);
+
+    vpDisplay::display(I);
+    double t = vpTime::measureTimeMs();
+    signalCurve.plotList(I, xorg, yorg, zoomx, zoomy);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Decimated redraw of " << nbPoint << " points: " << t << " ms" << std::endl;
+
+    // Each column is covered between the extreme rows of its points, and
+    // nothing is drawn elsewhere
+    std::vector<double> imin(canvas.getWidth(), 1e6), imax(canvas.getWidth(), -1e6);
+    for (unsigned int k = 0; k < nbPoint; k++) {
+      int j = vpMath::round(xorg + zoomx * k / (double)nbPoint);
+      double i = yorg - zoomy * signal(k);
+      imin[(size_t)j] = std::min(imin[(size_t)j], i);
+      imax[(size_t)j] = std::max(imax[(size_t)j], i);
+    }
+    for (unsigned int j = 0; j < canvas.getWidth(); j++) {
+      if (imax[j] < imin[j]) {
+        for (unsigned int i = 0; i < canvas.getHeight(); i++)
+          check(! isDrawn(canvas[i][j]) || (j > 0 && imax[j - 1] >= imin[j - 1]) ||
+                (j + 1 < canvas.getWidth() && imax[j + 1] >= imin[j + 1]), "Pixel drawn outside the curve");
+        continue;
+      }
+      for (int i = vpMath::round(imin[j]) + 1; i < vpMath::round(imax[j]); i++)
+        check(isDrawn(canvas[(unsigned int)i][j]), "Column not covered by the redraw");
+      for (int i = 0; i < vpMath::round(imin[j]) - 2; i++)
+        check(! isDrawn(canvas[(unsigned int)i][j]), "Pixel drawn above the curve");
+      for (int i = vpMath::round(imax[j]) + 3; i < (int)canvas.getHeight(); i++)
+        check(! isDrawn(canvas[(unsigned int)i][j]), "Pixel drawn below the curve");
+    }
+
+    // The points overwritten in the ring buffer are not redrawn
+    vpPlotCurve bounded;
+    bounded.setMaxPoint(1000);
+    for (unsigned int k = 0; k < 2000; k++)
+      bounded.addPoint(k / 2000., k < 1000 ? 1.5 : -0.5, 0);
+    vpDisplay::display(I);
+    bounded.plotList(I, xorg, yorg, zoomx, zoomy);
+    check(! isDrawn(canvas[(unsigned int)(yorg - 1.5 * zoomy)][(unsigned int)xorg + 10]), "Overwritten point redrawn");
+    check(isDrawn(canvas[(unsigned int)(yorg + 0.5 * zoomy)][(unsigned int)xorg + 200]), "Recent point not redrawn");
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "You do not have display functionalities..." << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writer.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.h
+  \brief Write images on the disk from a pool of background threads.
+*/
+
+#ifndef vpAsyncImageWriter_h
+#define vpAsyncImageWriter_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpCondition.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/core/vpThread.h>
+#include <visp3/io/vpImageIo.h>
+
+/*!
+  \class vpAsyncImageWriter
+
+  \ingroup group_io_image
+
+  \brief Write images on the disk from a pool of background threads.
+
+  write() copies the image in a bounded queue of image buffers and returns
+  immediately; the compression (PNG, JPEG...) and the file writing done by
+  vpImageIo::write() are performed by the background threads, so that saving
+  images does not slow down a real-time loop. Images are taken from the
+  queue in the order they were pushed, and the buffers are reused from one
+  image to the next.
+
+  When the queue is full, the behavior depends on the vpQueuePolicy given to
+  the constructor: write() either waits for a free buffer, or drops the new
+  image, or drops the oldest image that is not yet being written. The number
+  of pending, written, dropped and failed images is available to monitor the
+  recording.
+
+  Without pthread or Windows threading support, or when the number of
+  threads is set to 0, write() simply calls vpImageIo::write().
+
+  \code
+#include <visp3/io/vpAsyncImageWriter.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640);
+  vpAsyncImageWriter writer(2, 16, vpAsyncImageWriter::DROP_OLDEST);
+  char filename[FILENAME_MAX];
+  for (unsigned int cpt = 0; cpt < 100; cpt++) {
+    // ... process I
+    sprintf(filename, "/tmp/I%04u.png", cpt);
+    writer.write(I, filename); // Returns immediately
+  }
+  writer.flush(); // Wait until all the images are written
+  std::cout << writer.getDroppedCount() << " images dropped" << std::endl;
+}
+  \endcode
+
+  \sa vpVideoWriter::setAsync()
+*/
+class VISP_EXPORT vpAsyncImageWriter
+{
+public:
+  /*!
+    Behavior of write() when the queue is full.
+  */
+  typedef enum {
+    BLOCK,       //!< Wait until a buffer is free. No image is lost.
+    DROP_NEWEST, //!< Drop the image given to write().
+    DROP_OLDEST  //!< Drop the oldest queued image that is not yet being written.
+  } vpQueuePolicy;
+
+  vpAsyncImageWriter(unsigned int nbThreads=2, unsigned int queueSize=16, vpQueuePolicy policy=BLOCK);
+  virtual ~vpAsyncImageWriter();
+
+  void flush();
+
+  /*!
+    Return the number of images that were dropped because the queue was full.
+  */
+  inline unsigned int getDroppedCount() { return getCounter(m_dropped); }
+  /*!
+    Return the number of images that could not be written.
+    \sa getLastError()
+  */
+  inline unsigned int getErrorCount() { return getCounter(m_errors); }
+  std::string getLastError();
+  /*!
+    Return the highest number of pending images observed since the creation or the last call to resetCounters().
+  */
+  inline unsigned int getMaxQueueDepth() { return getCounter(m_maxDepth); }
+  /*!
+    Return the queue policy.
+  */
+  inline vpQueuePolicy getPolicy() const { return m_policy; }
+  unsigned int getQueueDepth();
+  /*!
+    Return the maximum number of pending images.
+  */
+  inline unsigned int getQueueSize() const { return m_queueSize; }
+  /*!
+    Return the number of background threads.
+  */
+  inline unsigned int getThreadCount() const { return m_nbThreads; }
+  /*!
+    Return the number of images written on the disk.
+  */
+  inline unsigned int getWrittenCount() { return getCounter(m_written); }
+
+  void resetCounters();
+
+  bool write(const vpImage<unsigned char> &I, const std::string &filename);
+  bool write(const vpImage<vpRGBa> &I, const std::string &filename);
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  vpAsyncImageWriter(const vpAsyncImageWriter &)
+    : m_nbThreads(0), m_queueSize(0), m_policy(BLOCK), m_written(0), m_dropped(0), m_errors(0), m_maxDepth(0),
+      m_lastError()
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+      , m_slots(), m_threads(), m_cond(), m_stop(false), m_sequence(0)
+#endif
+  {
+    throw vpException(vpException::functionNotImplementedError, "Not implemented!");
+  }
+  vpAsyncImageWriter &operator=(const vpAsyncImageWriter &) {
+    throw vpException(vpException::functionNotImplementedError, "Not implemented!");
+    return *this;
+  }
+
+  typedef enum {
+    FREE,    // Available
+    FILLING, // Being copied by write()
+    QUEUED,  // Waiting for a thread
+    WRITING  // Owned by a thread
+  } vpSlotState;
+
+  struct vpSlot {
+    vpSlot() : state(FREE), sequence(0), color(false), Ig(), Ic(), filename() {}
+    vpSlotState state;
+    unsigned long sequence;
+    bool color;
+    vpImage<unsigned char> Ig;
+    vpImage<vpRGBa> Ic;
+    std::string filename;
+  };
+
+  template<class Type> bool push(const vpImage<Type> &I, const std::string &filename);
+  unsigned int getCounter(const unsigned int &counter);
+  void writeSync(const vpImage<unsigned char> &I, const std::string &filename);
+  void writeSync(const vpImage<vpRGBa> &I, const std::string &filename);
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  static vpThread::Return writerThread(vpThread::Args args);
+  void run();
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+  unsigned int m_nbThreads;
+  unsigned int m_queueSize;
+  vpQueuePolicy m_policy;
+  unsigned int m_written;
+  unsigned int m_dropped;
+  unsigned int m_errors;
+  unsigned int m_maxDepth;
+  std::string m_lastError;
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  std::vector<vpSlot> m_slots;
+  std::vector<vpThread *> m_threads;
+  vpCondition m_cond;
+  bool m_stop;
+  unsigned long m_sequence;
+#endif
+};
+
+#endif
@@ -48,6 +48,10 @@
 #include <visp3/core/vpRGBa.h>
 #include <visp3/core/vpDebug.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+class vpDiskGrabberPrefetcher;
+#endif
+
 /*!
   \class vpDiskGrabber
 
@@ -101,10 +105,33 @@ int main(){
     g.acquire(I) ;
   }
 }
+\endcode
+
+  When the images are processed while they are read, decoding can be
+  overlapped with the processing by enabling the read-ahead mode with
+  setPrefetch(). A pool of background threads then decodes the next images of
+  the sequence in a bounded ring of image buffers. Images are always
+  delivered in the order of the sequence, and acquire(I, image_number) may be
+  used to seek in the sequence; the read-ahead restarts from the requested
+  image. The read-ahead mode concerns only grey level and color images
+  (vpImage<unsigned char> and vpImage<vpRGBa>) and needs pthread or the
+  Windows threading API.
+
+\code
+  g.setPrefetch(2, 8); // 2 decoder threads, at most 8 images ahead
+  g.open(I);
+  while (...) {
+    g.acquire(I); // Returns as soon as the image is decoded by a background thread
+    ...
+  }
 \endcode
 */
 class VISP_EXPORT vpDiskGrabber  : public vpFrameGrabber
 {
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  friend class vpDiskGrabberPrefetcher;
+#endif
+
 private:
   long image_number ; //!< id of the next image to be read
   int image_step ;    //!< increment between two image id
@@ -117,14 +144,21 @@ private:
   bool useGenericName;
   char genericName[FILENAME_MAX];
 
+  unsigned int m_prefetchThreads; //!< number of read-ahead decoder threads (0 when disabled)
+  unsigned int m_prefetchSize;    //!< maximum number of images decoded ahead
+  vpDiskGrabberPrefetcher *m_prefetcher; //!< read-ahead engine, created on first use
+
 public:
   vpDiskGrabber();
   vpDiskGrabber(const char *genericName);
   vpDiskGrabber(const char *dir, const char *basename, 
                 long number, int step, unsigned int noz,
 		const char *ext) ;
+  vpDiskGrabber(const vpDiskGrabber &g);
   virtual ~vpDiskGrabber() ;
 
+  vpDiskGrabber &operator=(const vpDiskGrabber &g);
+
   void open(vpImage<unsigned char> &I) ;
   void open(vpImage<vpRGBa> &I) ;
   void open(vpImage<float> &I) ;
@@ -145,11 +179,21 @@ public:
   void setNumberOfZero(unsigned int noz);
   void setExtension(const char *ext);
   void setGenericName(const char *genericName);
+  void setPrefetch(unsigned int nbThreads, unsigned int bufferSize=8);
 
   /*!
     Return the current image number.
   */
   long getImageNumber() { return image_number; };
+  /*!
+    Return the number of read-ahead decoder threads, 0 if the read-ahead mode is disabled.
+    \sa setPrefetch()
+  */
+  unsigned int getPrefetchThreads() const { return m_prefetchThreads; };
+
+private:
+  void buildName(char *name, long number) const;
+  void stopPrefetch();
 } ;
 
 #endif
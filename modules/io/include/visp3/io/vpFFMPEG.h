@@ -47,6 +47,7 @@
 #include <visp3/io/vpImageIo.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string>
 #include <vector>
 
 #ifdef VISP_HAVE_FFMPEG
@@ -141,6 +142,16 @@ int main ()
 #endif
 }
   \endcode
+
+  initStream() browses the video packets once, without decoding them, to
+  index the timestamp of each frame and the key frames. getFrame() then only
+  decodes from the nearest key frame before the requested frame, or from the
+  current position when the requested frame follows it. For long videos,
+  the index can be saved in a sidecar file with saveIndex() and reloaded
+  with loadIndex() before initStream().
+
+  The alpha channel of the vpRGBa frames is set to vpRGBa::alpha_default,
+  for colored as well as gray scaled streams.
 */
 class VISP_EXPORT vpFFMPEG
 {
@@ -168,7 +179,14 @@ class VISP_EXPORT vpFFMPEG
     unsigned int videoStream;
     int numBytes ;
     uint8_t * buffer ;
+    //! Timestamp of each frame in display order
     std::vector<int64_t> index;
+    //! Indexes of the key frames, in increasing order
+    std::vector<unsigned int> keyframes;
+    //! Index of the frame returned by the next acquisition, -1 if unknown
+    long currentFrame;
+    //! Indicates that pFrame holds the frame currentFrame, decoded by seekFrame() and not yet returned
+    bool pendingFrame;
     //! Indicates if the openStream method was executed
     bool streamWasOpen;
     //! Indicates if the initStream method was executed
@@ -235,6 +253,7 @@ class VISP_EXPORT vpFFMPEG
     inline int getWidth() const {return width;}
 
     bool initStream();
+    bool loadIndex(const std::string &filename);
 
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(54,51,110) // libavcodec 54.51.100
     bool openEncoder(const char *filename, unsigned int width, unsigned int height, CodecID codec = CODEC_ID_MPEG1VIDEO);
@@ -245,6 +264,7 @@ class VISP_EXPORT vpFFMPEG
 
     bool saveFrame(vpImage<vpRGBa> &I);
     bool saveFrame(vpImage<unsigned char> &I);
+    bool saveIndex(const std::string &filename) const;
     /*!
      Sets the bit rate of the video when encoding.
 
@@ -259,6 +279,12 @@ class VISP_EXPORT vpFFMPEG
     inline void setFramerate(const int framerate) {framerate_encoder = framerate;}
 
   private:
+    bool buildIndex();
+    bool isIndexSizeValid(unsigned long n) const;
+    void convertFrame(vpImage<vpRGBa> &I);
+    void convertFrame(vpImage<unsigned char> &I);
+    bool decodeFrame();
+    bool seekFrame(unsigned int frame);
     void copyBitmap(vpImage<vpRGBa> &I);
     void copyBitmap(vpImage<unsigned char> &I);
     void writeBitmap(vpImage<vpRGBa> &I);
@@ -136,6 +136,7 @@ public:
   static void readPFM(vpImage<float> &I, const std::string &filename) ;
 
   static void readPGM(vpImage<unsigned char> &I, const std::string &filename) ;
+  static void readPGM(vpImage<unsigned short> &I, const std::string &filename) ;
   static void readPGM(vpImage<vpRGBa> &I, const std::string &filename) ;
 
   static void readPPM(vpImage<unsigned char> &I, const std::string &filename) ;
@@ -155,6 +156,7 @@ public:
 
   static void writePGM(const vpImage<unsigned char> &I, const std::string &filename) ;
   static void writePGM(const vpImage<short> &I, const std::string &filename) ;
+  static void writePGM(const vpImage<unsigned short> &I, const std::string &filename) ;
   static void writePGM(const vpImage<vpRGBa> &I, const std::string &filename) ;
 
   static void writePPM(const vpImage<unsigned char> &I, const std::string &filename) ;
@@ -206,6 +206,10 @@ class VISP_EXPORT vpVideoReader : public vpFrameGrabber
     long lastFrame;
     bool firstFrameIndexIsSet;
     bool lastFrameIndexIsSet;
+    //!Number of read-ahead decoder threads used for image sequences
+    unsigned int prefetchThreads;
+    //!Maximum number of images of a sequence decoded ahead
+    unsigned int prefetchSize;
 
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -281,9 +285,14 @@ class VISP_EXPORT vpVideoReader : public vpFrameGrabber
 
       This method is useful if you use the class like a frame grabber (ie with theacquire method).
     */
-    inline void resetFrameCounter() {frameCount = firstFrame;}
+    inline void resetFrameCounter() {
+      frameCount = firstFrame;
+      if (imSequence != NULL)
+        imSequence->setImageNumber(firstFrame);
+    }
     void setFileName(const char *filename);
     void setFileName(const std::string &filename);
+    void setPrefetch(unsigned int nbThreads, unsigned int bufferSize=8);
     /*!
       Enables to set the first frame index if you want to use the class like a grabber (ie with the
       acquire method).
@@ -45,6 +45,7 @@
 
 #include <string>
 
+#include <visp3/io/vpAsyncImageWriter.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpFFMPEG.h>
 
@@ -98,6 +99,15 @@
   }
   \endcode
   
+  When writing an image sequence, the image compression can be moved out of
+  the caller thread with setAsync(). saveFrame() then only copies the image in
+  a bounded queue processed by background threads (see vpAsyncImageWriter).
+
+  \code
+  writer.setAsync(2, 16, vpAsyncImageWriter::DROP_OLDEST);
+  writer.open(I);
+  \endcode
+
   The other following example explains how to use the class to write directly an mpeg file.
   
   \code
@@ -199,6 +209,12 @@ class VISP_EXPORT vpVideoWriter
     unsigned int width;
     unsigned int height;
 
+    //! Background writer of the image sequences, NULL when images are written synchronously
+    vpAsyncImageWriter *asyncWriter;
+    unsigned int asyncThreads;
+    unsigned int asyncQueueSize;
+    vpAsyncImageWriter::vpQueuePolicy asyncPolicy;
+
   public:
     vpVideoWriter();
     ~vpVideoWriter();
@@ -211,6 +227,8 @@ class VISP_EXPORT vpVideoWriter
       \return Returns the current frame index.
     */
     inline unsigned int getCurrentFrameIndex() const {return frameCount;}
+    unsigned int getDroppedFrameCount();
+    unsigned int getQueueDepth();
 
     void open (vpImage< vpRGBa > &I);
     void open (vpImage< unsigned char > &I);
@@ -223,6 +241,8 @@ class VISP_EXPORT vpVideoWriter
 
     void saveFrame (vpImage< vpRGBa > &I);
     void saveFrame (vpImage< unsigned char > &I);
+    void setAsync(unsigned int nbThreads, unsigned int queueSize=16,
+                  vpAsyncImageWriter::vpQueuePolicy policy=vpAsyncImageWriter::BLOCK);
 
 #ifdef VISP_HAVE_FFMPEG
     /*!
@@ -289,6 +309,7 @@ class VISP_EXPORT vpVideoWriter
     private:
       vpVideoFormatType getFormat(const char *filename);
       static std::string getExtension(const std::string &filename);
+      void openAsyncWriter();
 };
 
 #endif
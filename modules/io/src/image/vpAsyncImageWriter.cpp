@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writer.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.cpp
+  \brief Write images on the disk from a pool of background threads.
+*/
+
+#include <string.h>
+
+#include <visp3/io/vpAsyncImageWriter.h>
+
+/*!
+  Create the writer and start the background threads.
+
+  \param nbThreads : Number of background threads. If 0, write() writes the
+  image synchronously.
+  \param queueSize : Maximum number of pending images, that is images copied
+  by write() and not yet written on the disk (at least 1).
+  \param policy : Behavior of write() when the queue is full.
+*/
+vpAsyncImageWriter::vpAsyncImageWriter(unsigned int nbThreads, unsigned int queueSize, vpQueuePolicy policy)
+  : m_nbThreads(nbThreads), m_queueSize((queueSize > 0) ? queueSize : 1), m_policy(policy),
+    m_written(0), m_dropped(0), m_errors(0), m_maxDepth(0), m_lastError()
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+    , m_slots(), m_threads(), m_cond(), m_stop(false), m_sequence(0)
+#endif
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_nbThreads > 0) {
+    m_slots.resize(m_queueSize);
+    for (unsigned int i = 0; i < m_nbThreads; i++)
+      m_threads.push_back(new vpThread((vpThread::Fn)writerThread, (vpThread::Args)this));
+  }
+#else
+  m_nbThreads = 0;
+#endif
+}
+
+/*!
+  Destructor. Waits until all the pending images are written and stops the
+  background threads.
+*/
+vpAsyncImageWriter::~vpAsyncImageWriter()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  flush();
+  m_cond.lock();
+  m_stop = true;
+  m_cond.broadcast();
+  m_cond.unlock();
+  for (size_t i = 0; i < m_threads.size(); i++)
+    delete m_threads[i]; // Join the thread
+#endif
+}
+
+/*!
+  Queue an image to be written in \e filename. The image is copied, so that
+  \e I may be modified as soon as this function returns.
+
+  \param I : Image to write.
+  \param filename : Name of the file. The image format is given by its
+  extension, as in vpImageIo::write().
+
+  \return false if the image was dropped because the queue is full and the
+  policy is DROP_NEWEST, true otherwise.
+*/
+bool vpAsyncImageWriter::write(const vpImage<unsigned char> &I, const std::string &filename)
+{
+  return push(I, filename);
+}
+
+/*!
+  Queue a color image to be written in \e filename. The image is copied, so
+  that \e I may be modified as soon as this function returns.
+
+  \param I : Image to write.
+  \param filename : Name of the file. The image format is given by its
+  extension, as in vpImageIo::write().
+
+  \return false if the image was dropped because the queue is full and the
+  policy is DROP_NEWEST, true otherwise.
+*/
+bool vpAsyncImageWriter::write(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  return push(I, filename);
+}
+
+/*!
+  Wait until all the pending images are written on the disk.
+*/
+void vpAsyncImageWriter::flush()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  vpCondition::vpScopedLock lock(m_cond);
+  for (;;) {
+    size_t i = 0;
+    while (i < m_slots.size() && m_slots[i].state == FREE)
+      i++;
+    if (i == m_slots.size())
+      break;
+    m_cond.wait();
+  }
+#endif
+}
+
+/*!
+  Return the number of pending images, that is images queued by write()
+  and not yet written on the disk.
+*/
+unsigned int vpAsyncImageWriter::getQueueDepth()
+{
+  unsigned int depth = 0;
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  m_cond.lock();
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    if (m_slots[i].state != FREE)
+      depth++;
+  }
+  m_cond.unlock();
+#endif
+  return depth;
+}
+
+/*!
+  Return the message of the last error that occurred while writing an image.
+  \sa getErrorCount()
+*/
+std::string vpAsyncImageWriter::getLastError()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  vpCondition::vpScopedLock lock(m_cond);
+#endif
+  return m_lastError;
+}
+
+/*!
+  Reset the written, dropped, error and maximum queue depth counters.
+*/
+void vpAsyncImageWriter::resetCounters()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  vpCondition::vpScopedLock lock(m_cond);
+#endif
+  m_written = m_dropped = m_errors = m_maxDepth = 0;
+  m_lastError.clear();
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+unsigned int vpAsyncImageWriter::getCounter(const unsigned int &counter)
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  vpCondition::vpScopedLock lock(m_cond);
+#endif
+  return counter;
+}
+
+void vpAsyncImageWriter::writeSync(const vpImage<unsigned char> &I, const std::string &filename)
+{
+  vpImageIo::write(I, filename);
+}
+
+void vpAsyncImageWriter::writeSync(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  vpImageIo::write(I, filename);
+}
+
+namespace {
+  vpImage<unsigned char> &slotImage(vpImage<unsigned char> &Ig, vpImage<vpRGBa> &, const vpImage<unsigned char> &)
+  {
+    return Ig;
+  }
+  vpImage<vpRGBa> &slotImage(vpImage<unsigned char> &, vpImage<vpRGBa> &Ic, const vpImage<vpRGBa> &)
+  {
+    return Ic;
+  }
+  bool isColorImage(const vpImage<unsigned char> &) { return false; }
+  bool isColorImage(const vpImage<vpRGBa> &) { return true; }
+}
+
+template<class Type>
+bool vpAsyncImageWriter::push(const vpImage<Type> &I, const std::string &filename)
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_nbThreads > 0) {
+    m_cond.lock();
+    vpSlot *slot = NULL;
+    for (;;) {
+      vpSlot *oldest = NULL;
+      for (size_t i = 0; i < m_slots.size() && slot == NULL; i++) {
+        if (m_slots[i].state == FREE)
+          slot = &m_slots[i];
+        else if (m_slots[i].state == QUEUED && (oldest == NULL || m_slots[i].sequence < oldest->sequence))
+          oldest = &m_slots[i];
+      }
+      if (slot != NULL)
+        break;
+
+      if (m_policy == DROP_NEWEST) {
+        m_dropped++;
+        m_cond.unlock();
+        return false;
+      }
+      if (m_policy == DROP_OLDEST && oldest != NULL) {
+        m_dropped++;
+        slot = oldest;
+        break;
+      }
+      // BLOCK, or all the buffers are being written
+      m_cond.wait();
+    }
+    slot->state = FILLING;
+    unsigned int depth = 0;
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (m_slots[i].state != FREE)
+        depth++;
+    }
+    if (depth > m_maxDepth)
+      m_maxDepth = depth;
+    m_cond.unlock();
+
+    // Copy outside the lock; the buffer is not reallocated when the size is unchanged
+    vpImage<Type> &Is = slotImage(slot->Ig, slot->Ic, I);
+    Is.resize(I.getHeight(), I.getWidth());
+    memcpy((void *)Is.bitmap, (const void *)I.bitmap, I.getSize() * sizeof(Type));
+    slot->filename = filename;
+    slot->color = isColorImage(I);
+
+    m_cond.lock();
+    slot->sequence = m_sequence++;
+    slot->state = QUEUED;
+    m_cond.broadcast();
+    m_cond.unlock();
+    return true;
+  }
+#endif
+
+  try {
+    writeSync(I, filename);
+    m_written++;
+  }
+  catch(const vpException &e) {
+    m_errors++;
+    m_lastError = e.getStringMessage();
+    throw;
+  }
+  return true;
+}
+
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+vpThread::Return vpAsyncImageWriter::writerThread(vpThread::Args args)
+{
+  vpAsyncImageWriter *writer = (vpAsyncImageWriter *)args;
+  writer->run();
+  return 0;
+}
+
+void vpAsyncImageWriter::run()
+{
+  m_cond.lock();
+  for (;;) {
+    // Take the oldest queued image to keep the writing order
+    vpSlot *slot = NULL;
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (m_slots[i].state == QUEUED && (slot == NULL || m_slots[i].sequence < slot->sequence))
+        slot = &m_slots[i];
+    }
+    if (slot == NULL) {
+      if (m_stop)
+        break;
+      m_cond.wait();
+      continue;
+    }
+    slot->state = WRITING;
+    m_cond.unlock();
+
+    // Encode and write outside the lock; the buffer is owned by this thread
+    bool failed = false;
+    std::string error;
+    try {
+      if (slot->color)
+        vpImageIo::write(slot->Ic, slot->filename);
+      else
+        vpImageIo::write(slot->Ig, slot->filename);
+    }
+    catch(const vpException &e) {
+      failed = true;
+      error = e.getStringMessage();
+    }
+    catch(...) {
+      failed = true;
+      error = std::string("Cannot write ") + slot->filename;
+    }
+
+    m_cond.lock();
+    if (failed) {
+      m_errors++;
+      m_lastError = error;
+    }
+    else {
+      m_written++;
+    }
+    slot->state = FREE;
+    m_cond.broadcast();
+  }
+  m_cond.unlock();
+}
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
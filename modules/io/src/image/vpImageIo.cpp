@@ -45,8 +45,12 @@
 #include <visp3/core/vpImageConvert.h> //image  conversion
 #include <visp3/core/vpIoTools.h>
 
+#include <vector>
+
 void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const std::string &magic,
                      unsigned int &w, unsigned int &h, unsigned int &maxval);
+void vp_openPNM(const std::string &filename, std::ifstream &fd, const std::string &magic, unsigned int maxval_max,
+                unsigned int &w, unsigned int &h, unsigned int &maxval);
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 /*!
@@ -111,6 +115,43 @@ void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const st
     }
   }
 }
+
+/*!
+ * Open a PNM file and decode its header. On return the file descriptor
+ * points to the first byte of the bitmap.
+ * \param filename[in] : File name.
+ * \param fd[out] : File descriptor.
+ * \param magic[in] : Magic number for identifying the file type.
+ * \param maxval_max[in] : Greatest maximum pixel value supported by the caller.
+ * \param w[out] : Image width.
+ * \param h[out] : Image height.
+ * \param maxval[out] : Maximum pixel value.
+ */
+void vp_openPNM(const std::string &filename, std::ifstream &fd, const std::string &magic, unsigned int maxval_max,
+                unsigned int &w, unsigned int &h, unsigned int &maxval)
+{
+  unsigned int w_max = 100000, h_max = 100000;
+
+  fd.open(filename.c_str(), std::ios::binary);
+
+  // Open the filename
+  if(! fd.is_open()) {
+    throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
+  }
+
+  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
+
+  if (w > w_max || h > h_max) {
+    fd.close();
+    throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
+  }
+  if (maxval > maxval_max)
+  {
+    fd.close();
+    throw (vpImageException(vpImageException::ioError,
+                            "Bad maxval in \"%s\"",  filename.c_str()));
+  }
+}
 #endif
 
 vpImageIo::vpImageFormatType
@@ -630,18 +671,74 @@ vpImageIo::writePGM(const vpImage<vpRGBa> &I, const std::string &filename)
   fprintf(fd, "%d %d\n", I.getWidth(), I.getHeight());	// Image size
   fprintf(fd, "255\n");					// Max level
 
-  // Write the bitmap
-  size_t ierr;
-  size_t nbyte = I.getWidth()*I.getHeight();
+  // Write the bitmap row by row to avoid a temporary grey level image
+  unsigned int width = I.getWidth();
+  std::vector<unsigned char> row(width);
 
-  vpImage<unsigned char> Itmp ;
-  vpImageConvert::convert(I,Itmp) ;
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    vpImageConvert::RGBaToGrey((unsigned char *)I[i], &row[0], width);
+    size_t ierr = fwrite(&row[0], sizeof(unsigned char), width, fd) ;
+    if (ierr != width) {
+      fclose(fd);
+      throw (vpImageException(vpImageException::ioError,
+                              "Cannot save PGM file \"%s\": only %d over %d bytes saved", filename.c_str(),
+                              i*width + ierr, I.getSize())) ;
+    }
+  }
 
-  ierr = fwrite(Itmp.bitmap, sizeof(unsigned char), nbyte, fd) ;
-  if (ierr != nbyte) {
-    fclose(fd);
+  fflush(fd);
+  fclose(fd);
+}
+
+/*!
+  Write the content of the image bitmap in the file which name is given by \e
+  filename. This function writes a 16 bits portable gray pixmap (PGM P5) file
+  with a maximum value of 65535. As required by the PGM format, the most
+  significant byte of each pixel is written first.
+
+  \param I : Image to save as a 16 bits (PGM P5) file.
+  \param filename : Name of the file containing the image.
+*/
+void
+vpImageIo::writePGM(const vpImage<unsigned short> &I, const std::string &filename)
+{
+  FILE* fd;
+
+  // Test the filename
+  if (filename.empty())   {
     throw (vpImageException(vpImageException::ioError,
-                            "Cannot save PGM file \"%s\": only %d over %d bytes saved", filename.c_str(), ierr, nbyte)) ;
+           "Cannot create PGM file: filename empty")) ;
+  }
+
+  fd = fopen(filename.c_str(), "wb");
+
+  if (fd == NULL) {
+     throw (vpImageException(vpImageException::ioError,
+           "Cannot create PGM file \"%s\"", filename.c_str())) ;
+  }
+
+  // Write the head
+  fprintf(fd, "P5\n");					// Magic number
+  fprintf(fd, "%d %d\n", I.getWidth(), I.getHeight());	// Image size
+  fprintf(fd, "65535\n");					// Max level
+
+  // Write the bitmap row by row in big endian
+  unsigned int width = I.getWidth();
+  std::vector<unsigned char> row(2*width);
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    const unsigned short *src = I[i];
+    for (unsigned int j = 0; j < width; j++) {
+      row[2*j]   = (unsigned char)(src[j] >> 8);
+      row[2*j+1] = (unsigned char)(src[j] & 0xFF);
+    }
+    size_t ierr = fwrite(&row[0], sizeof(unsigned char), 2*width, fd) ;
+    if (ierr != 2*width) {
+      fclose(fd);
+      throw (vpImageException(vpImageException::ioError,
+                              "Cannot save PGM file \"%s\": only %d over %d bytes saved", filename.c_str(),
+                              2*i*width + ierr, 2*I.getSize())) ;
+    }
   }
 
   fflush(fd);
@@ -785,11 +882,86 @@ vpImageIo::readPGM(vpImage<unsigned char> &I, const std::string &filename)
 void
 vpImageIo::readPGM(vpImage<vpRGBa> &I, const std::string &filename)
 {
-  vpImage<unsigned char> Itmp ;
+  unsigned int w=0, h=0, maxval=0;
+  std::ifstream fd;
+
+  vp_openPNM(filename, fd, "P5", 255, w, h, maxval);
+
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
+  }
+
+  // The gray levels are read in the last quarter of the bitmap and expanded
+  // in place. Pixel i is written in bytes [4i, 4i+3] that are located before
+  // the gray level of pixel i+1, so that no temporary image is needed.
+  unsigned int npixels = I.getSize();
+  unsigned char *bitmap = (unsigned char *)I.bitmap;
+  unsigned char *grey = bitmap + 3*npixels;
+  fd.read ((char *)grey, npixels);
+  if (! fd) {
+    fd.close();
+    throw (vpImageException(vpImageException::ioError,
+                            "Read only %d of %d bytes in file \"%s\"", fd.gcount(), npixels, filename.c_str()));
+  }
+  fd.close();
+
+  for (unsigned int i = 0; i < npixels; i++) {
+    unsigned char v = grey[i];
+    bitmap[4*i]   = v;
+    bitmap[4*i+1] = v;
+    bitmap[4*i+2] = v;
+    bitmap[4*i+3] = vpRGBa::alpha_default;
+  }
+}
+
+/*!
+  Read a PGM P5 file and initialize a 16 bits image.
+
+  Both 8 bits (maximum value lower than 256) and 16 bits PGM files are
+  supported. In the latter case the most significant byte of each pixel comes
+  first as required by the PGM format.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  \param I : Image to set with the \e filename content.
+  \param filename : Name of the file containing the image.
+*/
+void
+vpImageIo::readPGM(vpImage<unsigned short> &I, const std::string &filename)
+{
+  unsigned int w=0, h=0, maxval=0;
+  std::ifstream fd;
+
+  vp_openPNM(filename, fd, "P5", 65535, w, h, maxval);
+
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
+  }
 
-  vpImageIo::readPGM(Itmp, filename) ;
+  // Read the raw data in the image bitmap and convert it in place, starting
+  // from the end for 8 bits data
+  unsigned int npixels = I.getSize();
+  unsigned int bytesPerPixel = (maxval > 255) ? 2 : 1;
+  unsigned int nbyte = npixels * bytesPerPixel;
+  unsigned char *data = (unsigned char *)I.bitmap;
+  fd.read ((char *)data, nbyte);
+  if (! fd) {
+    fd.close();
+    throw (vpImageException(vpImageException::ioError,
+                            "Read only %d of %d bytes in file \"%s\"", fd.gcount(), nbyte, filename.c_str()));
+  }
+  fd.close();
 
-  vpImageConvert::convert(Itmp, I) ;
+  if (bytesPerPixel == 2) {
+    for (unsigned int i = 0; i < npixels; i++)
+      I.bitmap[i] = (unsigned short)((data[2*i] << 8) | data[2*i+1]);
+  }
+  else {
+    for (unsigned int i = npixels; i > 0; i--)
+      I.bitmap[i-1] = data[i-1];
+  }
 }
 
 
@@ -816,11 +988,29 @@ vpImageIo::readPGM(vpImage<vpRGBa> &I, const std::string &filename)
 void
 vpImageIo::readPPM(vpImage<unsigned char> &I, const std::string &filename)
 {
-  vpImage<vpRGBa> Itmp ;
+  unsigned int w=0, h=0, maxval=0;
+  std::ifstream fd;
 
-  vpImageIo::readPPM(Itmp, filename) ;
+  vp_openPNM(filename, fd, "P6", 255, w, h, maxval);
 
-  vpImageConvert::convert(Itmp, I) ;
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
+  }
+
+  // Read and convert row by row to avoid a temporary color image
+  std::vector<unsigned char> row(3*w);
+  for (unsigned int i = 0; i < h; i++) {
+    fd.read ((char *)&row[0], 3*w);
+    if (! fd) {
+      fd.close();
+      throw (vpImageException(vpImageException::ioError,
+                              "Read only %d of %d bytes in file \"%s\"",
+                              3*i*w + fd.gcount(), 3*I.getSize(), filename.c_str()));
+    }
+    vpImageConvert::RGBToGrey(&row[0], I[i], w);
+  }
+
+  fd.close();
 }
 
 
@@ -839,53 +1029,35 @@ void
 vpImageIo::readPPM(vpImage<vpRGBa> &I, const std::string &filename)
 {
   unsigned int w=0, h=0, maxval=0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P6");
+  std::ifstream fd;
 
-  std::ifstream fd(filename.c_str(), std::ios::binary);
+  vp_openPNM(filename, fd, "P6", 255, w, h, maxval);
 
-  // Open the filename
-  if(! fd.is_open()) {
-    throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
   }
 
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
-  }
-  if (maxval > maxval_max)
-  {
+  // The RGB data is read with a single call in the last three quarters of
+  // the bitmap and expanded in place. Pixel i is written in bytes [4i, 4i+3]
+  // that are located before the RGB data of pixel i+1.
+  unsigned int npixels = I.getSize();
+  unsigned char *bitmap = (unsigned char *)I.bitmap;
+  unsigned char *rgb = bitmap + npixels;
+  fd.read ((char *)rgb, 3*npixels);
+  if (! fd) {
     fd.close();
     throw (vpImageException(vpImageException::ioError,
-                            "Bad maxval in \"%s\"",  filename.c_str()));
-  }
-
-  if ((h != I.getHeight())||( w != I.getWidth())) {
-    I.resize(h,w) ;
+                            "Read only %d of %d bytes in file \"%s\"", fd.gcount(), 3*npixels, filename.c_str()));
   }
+  fd.close();
 
-  for(unsigned int i=0;i<I.getHeight();i++) {
-    for(unsigned int j=0;j<I.getWidth();j++) {
-      unsigned char rgb[3];
-      fd.read((char *)&rgb, 3);
-
-      if (! fd) {
-        fd.close();
-        throw (vpImageException(vpImageException::ioError,
-                                "Read only %d of %d bytes in file \"%s\"",
-                                (i*I.getWidth() + j)*3 + fd.gcount(), I.getSize()*3, filename.c_str()));
-      }
-
-      I[i][j].R = rgb[0];
-      I[i][j].G = rgb[1];
-      I[i][j].B = rgb[2];
-      I[i][j].A = vpRGBa::alpha_default;
-    }
+  for (unsigned int i = 0; i < npixels; i++) {
+    unsigned char r = rgb[3*i], g = rgb[3*i+1], b = rgb[3*i+2];
+    bitmap[4*i]   = r;
+    bitmap[4*i+1] = g;
+    bitmap[4*i+2] = b;
+    bitmap[4*i+3] = vpRGBa::alpha_default;
   }
-
-  fd.close();
 }
 
 /*!
@@ -901,11 +1073,41 @@ vpImageIo::readPPM(vpImage<vpRGBa> &I, const std::string &filename)
 void
 vpImageIo::writePPM(const vpImage<unsigned char> &I, const std::string &filename)
 {
-  vpImage<vpRGBa> Itmp ;
+  FILE* f;
+
+  // Test the filename
+  if (filename.empty())   {
+    throw (vpImageException(vpImageException::ioError,
+           "Cannot create PPM file: filename empty")) ;
+  }
 
-  vpImageConvert::convert(I, Itmp) ;
+  f = fopen(filename.c_str(), "wb");
 
-  vpImageIo::writePPM(Itmp, filename) ;
+  if (f == NULL) {
+     throw (vpImageException(vpImageException::ioError,
+           "Cannot create PPM file \"%s\"", filename.c_str())) ;
+  }
+
+  fprintf(f,"P6\n");			         // Magic number
+  fprintf(f,"%d %d\n", I.getWidth(), I.getHeight());	// Image size
+  fprintf(f,"%d\n", 255);	        	// Max level
+
+  // Convert and write row by row to avoid a temporary color image
+  unsigned int width = I.getWidth();
+  std::vector<unsigned char> row(3*width);
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    vpImageConvert::GreyToRGB((unsigned char *)I[i], &row[0], width);
+    size_t res = fwrite(&row[0], 1, 3*width, f);
+    if (res != 3*width) {
+      fclose(f);
+      throw (vpImageException(vpImageException::ioError,
+                              "cannot write file \"%s\"", filename.c_str())) ;
+    }
+  }
+
+  fflush(f);
+  fclose(f);
 }
 
 
@@ -938,22 +1140,17 @@ vpImageIo::writePPM(const vpImage<vpRGBa> &I, const std::string &filename)
   fprintf(f,"%d %d\n", I.getWidth(), I.getHeight());	// Image size
   fprintf(f,"%d\n", 255);	        	// Max level
 
-  for(unsigned int i=0;i<I.getHeight();i++)
-  {
-    for(unsigned int j=0;j<I.getWidth();j++)
-    {
-      vpRGBa v = I[i][j];
-      unsigned char rgb[3];
-      rgb[0] = v.R;
-      rgb[1] = v.G;
-      rgb[2] = v.B;
-
-      size_t res = fwrite(&rgb, 1, 3, f);
-      if (res != 3) {
-        fclose(f);
-        throw (vpImageException(vpImageException::ioError,
-                                "cannot write file \"%s\"", filename.c_str())) ;
-      }
+  // Convert and write row by row instead of pixel by pixel
+  unsigned int width = I.getWidth();
+  std::vector<unsigned char> row(3*width);
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    vpImageConvert::RGBaToRGB((unsigned char *)I[i], &row[0], width);
+    size_t res = fwrite(&row[0], 1, 3*width, f);
+    if (res != 3*width) {
+      fclose(f);
+      throw (vpImageException(vpImageException::ioError,
+                              "cannot write file \"%s\"", filename.c_str())) ;
     }
   }
 
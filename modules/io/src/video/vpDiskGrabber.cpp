@@ -36,14 +36,234 @@
  *****************************************************************************/
 
 
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpCondition.h>
+#include <visp3/core/vpThread.h>
 #include <visp3/io/vpDiskGrabber.h>
 
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*!
+  Read-ahead engine of vpDiskGrabber.
+
+  A pool of decoder threads fills a bounded ring of image buffers with the
+  images that follow the last requested one. Each buffer keeps its bitmap
+  from one decoding to the next so that no allocation occurs while the
+  sequence is replayed. Idle decoder threads and acquire() sleep on a
+  condition variable that is signaled each time the ring state changes.
+*/
+class vpDiskGrabberPrefetcher
+{
+public:
+  vpDiskGrabberPrefetcher(const vpDiskGrabber &grabber, unsigned int nbThreads, unsigned int bufferSize)
+    : m_grabber(grabber), m_slots(bufferSize), m_threads(), m_cond(), m_stop(false), m_started(false),
+      m_endReached(false), m_generation(0), m_next(0), m_expected(0), m_step(1), m_type(GREY)
+  {
+    for (unsigned int i = 0; i < nbThreads; i++)
+      m_threads.push_back(new vpThread((vpThread::Fn)decoderThread, (vpThread::Args)this));
+  }
+
+  virtual ~vpDiskGrabberPrefetcher()
+  {
+    m_cond.lock();
+    m_stop = true;
+    m_cond.broadcast();
+    m_cond.unlock();
+    for (size_t i = 0; i < m_threads.size(); i++)
+      delete m_threads[i]; // Join the thread
+  }
+
+  void acquire(vpImage<unsigned char> &I, long number) { acquire(I, number, GREY); }
+  void acquire(vpImage<vpRGBa> &I, long number) { acquire(I, number, COLOR); }
+
+private:
+  typedef enum {
+    GREY,
+    COLOR
+  } vpImageType;
+
+  typedef enum {
+    FREE,    // Available for a new image
+    DECODING, // Owned by a decoder thread
+    READY,   // Decoded image waiting for acquire()
+    FAILED   // The image could not be read
+  } vpSlotState;
+
+  struct vpSlot {
+    vpSlot() : state(FREE), number(0), generation(0), Ig(), Ic(), error() {}
+    vpSlotState state;
+    long number;
+    unsigned int generation;
+    vpImage<unsigned char> Ig;
+    vpImage<vpRGBa> Ic;
+    std::string error;
+  };
+
+  static vpImage<unsigned char> &slotImage(vpSlot &slot, const vpImage<unsigned char> &) { return slot.Ig; }
+  static vpImage<vpRGBa> &slotImage(vpSlot &slot, const vpImage<vpRGBa> &) { return slot.Ic; }
+
+  // Drop the images read ahead and restart decoding from image \e number.
+  // Slots still being decoded are released by their thread when done.
+  // Must be called with the mutex locked.
+  void restart(long number, vpImageType type)
+  {
+    m_generation++;
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (m_slots[i].state != DECODING)
+        m_slots[i].state = FREE;
+    }
+    m_type = type;
+    m_step = m_grabber.image_step;
+    m_next = number;
+    m_expected = number;
+    m_endReached = false;
+    m_started = true;
+    m_cond.broadcast();
+  }
+
+  template<class Type>
+  void acquire(vpImage<Type> &I, long number, vpImageType type)
+  {
+    m_cond.lock();
+    if (! m_started || type != m_type || number != m_expected)
+      restart(number, type);
+
+    for (;;) {
+      bool decoding = false;
+      for (size_t i = 0; i < m_slots.size(); i++) {
+        vpSlot &slot = m_slots[i];
+        if (slot.generation != m_generation || slot.number != number)
+          continue;
+        if (slot.state == DECODING) {
+          decoding = true;
+        }
+        else if (slot.state == READY) {
+          const vpImage<Type> &Is = slotImage(slot, I);
+          // Copy in the user image without reallocating it when the size is unchanged
+          I.resize(Is.getHeight(), Is.getWidth());
+          memcpy((void *)I.bitmap, (const void *)Is.bitmap, Is.getSize() * sizeof(Type));
+          slot.state = FREE;
+          m_expected = number + m_step;
+          m_cond.broadcast();
+          m_cond.unlock();
+          return;
+        }
+        else if (slot.state == FAILED) {
+          std::string error = slot.error;
+          slot.state = FREE;
+          m_expected = number + m_step;
+          m_cond.broadcast();
+          m_cond.unlock();
+          throw(vpException(vpException::ioError, error));
+        }
+      }
+      // The image will never be scheduled since a previous one could not be read
+      if (! decoding && m_endReached && m_next != number)
+        restart(number, type);
+      else
+        m_cond.wait();
+    }
+  }
+
+  static vpThread::Return decoderThread(vpThread::Args args)
+  {
+    vpDiskGrabberPrefetcher *prefetcher = (vpDiskGrabberPrefetcher *)args;
+    prefetcher->decode();
+    return 0;
+  }
+
+  void decode()
+  {
+    char name[FILENAME_MAX];
+    m_cond.lock();
+    for (;;) {
+      if (m_stop) {
+        m_cond.unlock();
+        break;
+      }
+      vpSlot *slot = NULL;
+      if (m_started && ! m_endReached) {
+        for (size_t i = 0; i < m_slots.size(); i++) {
+          if (m_slots[i].state == FREE) {
+            slot = &m_slots[i];
+            break;
+          }
+        }
+      }
+      if (slot == NULL) {
+        m_cond.wait();
+        continue;
+      }
+      slot->state = DECODING;
+      slot->number = m_next;
+      slot->generation = m_generation;
+      vpImageType type = m_type;
+      m_next += m_step;
+      m_grabber.buildName(name, slot->number);
+      m_cond.unlock();
+
+      // Decode outside the lock; the slot is owned by this thread
+      bool failed = false;
+      std::string error;
+      try {
+        if (type == GREY)
+          vpImageIo::read(slot->Ig, name);
+        else
+          vpImageIo::read(slot->Ic, name);
+      }
+      catch(const vpException &e) {
+        failed = true;
+        error = e.getStringMessage();
+      }
+      catch(...) {
+        failed = true;
+        error = std::string("Cannot read ") + name;
+      }
+
+      m_cond.lock();
+      if (slot->generation != m_generation) {
+        slot->state = FREE; // Outdated after a seek
+      }
+      else if (failed) {
+        slot->state = FAILED;
+        slot->error = error;
+        m_endReached = true; // Most likely the end of the sequence
+      }
+      else {
+        slot->state = READY;
+      }
+      m_cond.broadcast();
+    }
+  }
+
+  const vpDiskGrabber &m_grabber;
+  std::vector<vpSlot> m_slots;
+  std::vector<vpThread *> m_threads;
+  vpCondition m_cond;
+  bool m_stop;
+  bool m_started;
+  bool m_endReached;
+  unsigned int m_generation;
+  long m_next;     // Next image to schedule
+  long m_expected; // Next image expected by acquire()
+  int m_step;
+  vpImageType m_type;
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
+
 
 /*!
   Elementary constructor.
 */
 vpDiskGrabber::vpDiskGrabber()
-  : image_number(0), image_step(1), number_of_zero(0), useGenericName(false)
+  : image_number(0), image_step(1), number_of_zero(0), useGenericName(false),
+    m_prefetchThreads(0), m_prefetchSize(8), m_prefetcher(NULL)
 {
   setDirectory("/tmp");
   setBaseName("I");
@@ -54,7 +274,8 @@ vpDiskGrabber::vpDiskGrabber()
 
 
 vpDiskGrabber::vpDiskGrabber(const char *generic_name)
-  : image_number(0), image_step(1), number_of_zero(0), useGenericName(false)
+  : image_number(0), image_step(1), number_of_zero(0), useGenericName(false),
+    m_prefetchThreads(0), m_prefetchSize(8), m_prefetcher(NULL)
 {
   setDirectory("/tmp");
   setBaseName("I");
@@ -86,7 +307,8 @@ vpDiskGrabber::vpDiskGrabber(const char *dir, const char *basename,
                              long number,
                              int step, unsigned int noz,
                              const char *ext)
-  : image_number(number), image_step(step), number_of_zero(noz), useGenericName(false)
+  : image_number(number), image_step(step), number_of_zero(noz), useGenericName(false),
+    m_prefetchThreads(0), m_prefetchSize(8), m_prefetcher(NULL)
 {
   setDirectory(dir);
   setBaseName(basename);
@@ -167,13 +389,22 @@ vpDiskGrabber::open(vpImage<float> &I)
 void
 vpDiskGrabber::acquire(vpImage<unsigned char> &I)
 {
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_prefetchThreads > 0) {
+    if (m_prefetcher == NULL)
+      m_prefetcher = new vpDiskGrabberPrefetcher(*this, m_prefetchThreads, m_prefetchSize);
+    long number = image_number;
+    image_number += image_step ;
+    m_prefetcher->acquire(I, number);
+
+    width = I.getWidth();
+    height = I.getHeight();
+    return;
+  }
+#endif
 
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,image_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,image_number,extension) ;
+  buildName(name, image_number);
 
   image_number += image_step ;
 
@@ -194,13 +425,22 @@ vpDiskGrabber::acquire(vpImage<unsigned char> &I)
 void
 vpDiskGrabber::acquire(vpImage<vpRGBa> &I)
 {
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_prefetchThreads > 0) {
+    if (m_prefetcher == NULL)
+      m_prefetcher = new vpDiskGrabberPrefetcher(*this, m_prefetchThreads, m_prefetchSize);
+    long number = image_number;
+    image_number += image_step ;
+    m_prefetcher->acquire(I, number);
+
+    width = I.getWidth();
+    height = I.getHeight();
+    return;
+  }
+#endif
 
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,image_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,image_number,extension) ;
+  buildName(name, image_number);
 
   image_number += image_step ;
 
@@ -222,13 +462,8 @@ vpDiskGrabber::acquire(vpImage<vpRGBa> &I)
 void
 vpDiskGrabber::acquire(vpImage<float> &I)
 {
-
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,image_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,image_number,extension) ;
+  buildName(name, image_number);
 
   image_number += image_step ;
 
@@ -251,13 +486,20 @@ vpDiskGrabber::acquire(vpImage<float> &I)
 void
 vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 {
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_prefetchThreads > 0) {
+    if (m_prefetcher == NULL)
+      m_prefetcher = new vpDiskGrabberPrefetcher(*this, m_prefetchThreads, m_prefetchSize);
+    m_prefetcher->acquire(I, img_number);
+
+    width = I.getWidth();
+    height = I.getHeight();
+    return;
+  }
+#endif
 
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,img_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,img_number,extension) ;
+  buildName(name, img_number);
 
   vpDEBUG_TRACE(2, "load: %s\n", name);
 
@@ -277,13 +519,20 @@ vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 void
 vpDiskGrabber::acquire(vpImage<vpRGBa> &I, long img_number)
 {
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_prefetchThreads > 0) {
+    if (m_prefetcher == NULL)
+      m_prefetcher = new vpDiskGrabberPrefetcher(*this, m_prefetchThreads, m_prefetchSize);
+    m_prefetcher->acquire(I, img_number);
+
+    width = I.getWidth();
+    height = I.getHeight();
+    return;
+  }
+#endif
 
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,img_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,img_number,extension) ;
+  buildName(name, img_number);
 
   vpDEBUG_TRACE(2, "load: %s\n", name);
 
@@ -305,13 +554,8 @@ vpDiskGrabber::acquire(vpImage<vpRGBa> &I, long img_number)
 void
 vpDiskGrabber::acquire(vpImage<float> &I, long img_number)
 {
-
   char name[FILENAME_MAX] ;
-
-  if(useGenericName)
-    sprintf(name,genericName,img_number) ;
-  else
-    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,img_number,extension) ;
+  buildName(name, img_number);
 
   vpDEBUG_TRACE(2, "load: %s\n", name);
 
@@ -335,12 +579,105 @@ vpDiskGrabber::close()
 
 
 /*!
-  Destructor
+  Copy constructor. The read-ahead settings are copied, but the images
+  already read ahead are not shared with the copy.
+ */
+vpDiskGrabber::vpDiskGrabber(const vpDiskGrabber &g)
+  : vpFrameGrabber(g), image_number(g.image_number), image_step(g.image_step), number_of_zero(g.number_of_zero),
+    useGenericName(g.useGenericName), m_prefetchThreads(g.m_prefetchThreads), m_prefetchSize(g.m_prefetchSize),
+    m_prefetcher(NULL)
+{
+  strcpy(directory, g.directory);
+  strcpy(base_name, g.base_name);
+  strcpy(extension, g.extension);
+  strcpy(genericName, g.genericName);
+}
 
-  In fact nothing to destroy...
+/*!
+  Copy operator. The read-ahead settings are copied, but the images
+  already read ahead are not shared with the copy.
+ */
+vpDiskGrabber &
+vpDiskGrabber::operator=(const vpDiskGrabber &g)
+{
+  if (this != &g) {
+    stopPrefetch();
+    vpFrameGrabber::operator=(g);
+    image_number = g.image_number;
+    image_step = g.image_step;
+    number_of_zero = g.number_of_zero;
+    useGenericName = g.useGenericName;
+    m_prefetchThreads = g.m_prefetchThreads;
+    m_prefetchSize = g.m_prefetchSize;
+    strcpy(directory, g.directory);
+    strcpy(base_name, g.base_name);
+    strcpy(extension, g.extension);
+    strcpy(genericName, g.genericName);
+  }
+  return *this;
+}
+
+/*!
+  Destructor. Stops the read-ahead decoder threads if any.
  */
 vpDiskGrabber::~vpDiskGrabber()
 {
+  stopPrefetch();
+}
+
+/*!
+  Enable or disable the read-ahead mode.
+
+  When enabled, \e nbThreads background threads decode the images that
+  follow the last acquired one in a ring of \e bufferSize image buffers,
+  so that acquire() does not wait for the disk and the image decoding as
+  long as the processing of an image takes longer than the decoding of the
+  next one. Images are delivered in the order of the sequence. Calling
+  acquire(I, image_number) or setImageNumber() with an image that does not
+  follow the last acquired one drops the images read ahead and restarts the
+  read-ahead from the requested image.
+
+  The read-ahead mode concerns only vpImage<unsigned char> and
+  vpImage<vpRGBa> images; vpImage<float> images are always read
+  synchronously. Without pthread or Windows threading support, this
+  setting has no effect.
+
+  \param nbThreads : Number of decoder threads. Set 0 to disable the read-ahead mode.
+  \param bufferSize : Maximum number of images decoded ahead (at least 1).
+ */
+void
+vpDiskGrabber::setPrefetch(unsigned int nbThreads, unsigned int bufferSize)
+{
+  stopPrefetch();
+  m_prefetchThreads = nbThreads;
+  m_prefetchSize = (bufferSize > 0) ? bufferSize : 1;
+}
+
+/*!
+  Stop the read-ahead decoder threads. They are started again on the next
+  acquisition if the read-ahead mode is enabled.
+ */
+void
+vpDiskGrabber::stopPrefetch()
+{
+#if defined(VISP_HAVE_PTHREAD) || defined(_WIN32)
+  if (m_prefetcher != NULL) {
+    delete m_prefetcher;
+    m_prefetcher = NULL;
+  }
+#endif
+}
+
+/*!
+  Build the name of the image file corresponding to the image \e number.
+ */
+void
+vpDiskGrabber::buildName(char *name, long number) const
+{
+  if(useGenericName)
+    sprintf(name,genericName,number) ;
+  else
+    sprintf(name,"%s/%s%0*ld.%s",directory,base_name,number_of_zero,number,extension) ;
 }
 
 
@@ -350,6 +687,7 @@ vpDiskGrabber::~vpDiskGrabber()
 void
 vpDiskGrabber::setDirectory(const char *dir)
 {
+  stopPrefetch();
   sprintf(directory, "%s", dir) ;
 }
 
@@ -359,6 +697,7 @@ vpDiskGrabber::setDirectory(const char *dir)
 void
 vpDiskGrabber::setBaseName(const char *name)
 {
+  stopPrefetch();
   sprintf(base_name, "%s", name) ;
 }
 
@@ -368,6 +707,7 @@ vpDiskGrabber::setBaseName(const char *name)
 void
 vpDiskGrabber::setExtension(const char *ext)
 {
+  stopPrefetch();
   sprintf(extension, "%s", ext) ;
 }
 
@@ -388,6 +728,7 @@ vpDiskGrabber::setImageNumber(long number)
 void
 vpDiskGrabber::setStep(int step)
 {
+  stopPrefetch();
   image_step = step;
 }
 /*!
@@ -396,6 +737,7 @@ vpDiskGrabber::setStep(int step)
 void
 vpDiskGrabber::setNumberOfZero(unsigned int noz)
 {
+  stopPrefetch();
   number_of_zero = noz ;
 }
 
@@ -407,6 +749,7 @@ vpDiskGrabber::setGenericName(const char *generic_name)
                       "Not enough memory to intialize the generic name"));
   }
 
+  stopPrefetch();
   strcpy(this->genericName, generic_name) ;
   useGenericName = true;
 }
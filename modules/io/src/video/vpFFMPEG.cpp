@@ -42,6 +42,10 @@
 */
 
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpDebug.h>
@@ -63,7 +67,7 @@ extern "C"
 vpFFMPEG::vpFFMPEG()
   : width(-1), height(-1), frameNumber(0), pFormatCtx(NULL), pCodecCtx(NULL),
     pCodec(NULL), pFrame(NULL), pFrameRGB(NULL), pFrameGRAY(NULL), packet(NULL),
-    img_convert_ctx(NULL), videoStream(0), numBytes(0), buffer(NULL), index(),
+    img_convert_ctx(NULL), videoStream(0), numBytes(0), buffer(NULL), index(), keyframes(), currentFrame(-1), pendingFrame(false),
     streamWasOpen(false), streamWasInitialized(false), color_type(COLORED),
     f(NULL), outbuf(NULL), picture_buf(NULL), outbuf_size(0), out_size(0),
     bit_rate(500000), encoderWasOpened(false),
@@ -180,7 +184,7 @@ bool vpFFMPEG::openStream(const char *filename, vpFFMPEGColorType colortype)
       if (pFrameRGB == NULL)
         return false;
       
-      numBytes = avpicture_get_size (PIX_FMT_RGB24,pCodecCtx->width,pCodecCtx->height);
+      numBytes = avpicture_get_size (PIX_FMT_RGBA,pCodecCtx->width,pCodecCtx->height);
     }
     
     else if (color_type == vpFFMPEG::GRAY_SCALED)
@@ -211,7 +215,7 @@ bool vpFFMPEG::openStream(const char *filename, vpFFMPEGColorType colortype)
   }
   
   if (color_type == vpFFMPEG::COLORED)
-    avpicture_fill((AVPicture *)pFrameRGB, buffer, PIX_FMT_RGB24, pCodecCtx->width, pCodecCtx->height);
+    avpicture_fill((AVPicture *)pFrameRGB, buffer, PIX_FMT_RGBA, pCodecCtx->width, pCodecCtx->height);
   
   else if (color_type == vpFFMPEG::GRAY_SCALED)
     avpicture_fill((AVPicture *)pFrameGRAY, buffer, PIX_FMT_GRAY8, pCodecCtx->width, pCodecCtx->height);
@@ -224,19 +228,50 @@ bool vpFFMPEG::openStream(const char *filename, vpFFMPEGColorType colortype)
 /*!
   This method initializes the conversion parameters.
   
-  It browses the video and lists all the frame. It sets the number of frame in the video.
+  If no index was loaded with loadIndex(), it browses the video packets to
+  build the frame index used by getFrame(): the timestamp of each frame and
+  the list of the key frames. The frames are not decoded. It sets the number
+  of frames in the video and rewinds the stream to the first frame.
   
   \returns It returns true if the method was executed without any problem. Else it returns false.
 */
 bool vpFFMPEG::initStream()
 {
   if (color_type == vpFFMPEG::COLORED)
-    img_convert_ctx= sws_getContext(pCodecCtx->width, pCodecCtx->height, pCodecCtx->pix_fmt, pCodecCtx->width,pCodecCtx->height,PIX_FMT_RGB24, SWS_BICUBIC, NULL, NULL, NULL);
+    img_convert_ctx= sws_getContext(pCodecCtx->width, pCodecCtx->height, pCodecCtx->pix_fmt, pCodecCtx->width,pCodecCtx->height,PIX_FMT_RGBA, SWS_BICUBIC, NULL, NULL, NULL);
   
   else if (color_type == vpFFMPEG::GRAY_SCALED)
     img_convert_ctx= sws_getContext(pCodecCtx->width, pCodecCtx->height, pCodecCtx->pix_fmt, pCodecCtx->width,pCodecCtx->height,PIX_FMT_GRAY8, SWS_BICUBIC, NULL, NULL, NULL);
 
-  int ret = av_seek_frame(pFormatCtx, (int)videoStream, 0, AVSEEK_FLAG_ANY) ;
+  if (index.empty()) {
+    if (! buildIndex())
+      return false;
+  }
+
+  frameNumber = index.size();
+  streamWasInitialized = true;
+
+  // Rewind the stream so that acquire() starts with the first frame
+  currentFrame = -1;
+  pendingFrame = false;
+  if (frameNumber > 0 && ! seekFrame(0))
+  {
+    vpTRACE("Error rewinding stream") ;
+    return false;
+  }
+  
+  return true;
+}
+
+/*!
+  Browse the video packets, without decoding them, to get the timestamp of
+  each frame in display order and the indexes of the key frames.
+
+  \return false if the stream could not be rewound.
+*/
+bool vpFFMPEG::buildIndex()
+{
+  int ret = av_seek_frame(pFormatCtx, (int)videoStream, 0, AVSEEK_FLAG_BACKWARD) ;
   if (ret < 0 )
   {
     vpTRACE("Error rewinding stream for full indexing") ;
@@ -244,66 +279,144 @@ bool vpFFMPEG::initStream()
   }
   avcodec_flush_buffers(pCodecCtx) ;
 
-  int frame_no = 0 ;
-  int frameFinished ;
-
+  // Packets are stored in decoding order, frames are indexed in display order
+  std::vector< std::pair<int64_t, bool> > frames;
+  int64_t last = (int64_t)AV_NOPTS_VALUE;
   av_init_packet(packet);
   while (av_read_frame (pFormatCtx, packet) >= 0)
   {
     if (packet->stream_index == (int)videoStream)
     {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,72,2)
-      ret = avcodec_decode_video(pCodecCtx, pFrame,
-         &frameFinished, packet->data, packet->size);
+      int64_t ts = (packet->pts != (int64_t)AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+      if (ts == (int64_t)AV_NOPTS_VALUE && last != (int64_t)AV_NOPTS_VALUE)
+      {
+        // No timestamp, the packet follows the previous one
+        ts = last + ((packet->duration > 0) ? (int64_t)packet->duration : 1);
+      }
+      if (ts != (int64_t)AV_NOPTS_VALUE)
+      {
+#ifdef AV_PKT_FLAG_KEY
+        bool key = (packet->flags & AV_PKT_FLAG_KEY) != 0;
 #else
-      ret = avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet); // libavcodec >= 52.72.2 (0.6)
+        bool key = (packet->flags & PKT_FLAG_KEY) != 0;
 #endif
-      if (frameFinished)
-      {
-        if (ret < 0 )
-        {
-          vpTRACE("Unable to decode video picture");
-        }
-        index.push_back(packet->dts);
-        frame_no++ ;
+        frames.push_back(std::make_pair(ts, key));
+        last = ts;
       }
+      else
+        vpTRACE("Skip a packet without timestamp at the beginning of the stream");
     }
+    av_free_packet(packet);
   }
-  
-  frameNumber = index.size();
-  av_free_packet(packet);
-  
-  streamWasInitialized = true;
-  
+  std::sort(frames.begin(), frames.end());
+
+  index.resize(frames.size());
+  keyframes.clear();
+  for (size_t i = 0; i < frames.size(); i++) {
+    index[i] = frames[i].first;
+    if (frames[i].second)
+      keyframes.push_back((unsigned int)i);
+  }
+  // The first frame is always decodable
+  if (! index.empty() && (keyframes.empty() || keyframes[0] != 0))
+    keyframes.insert(keyframes.begin(), 0);
+
   return true;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Presentation timestamp of a decoded frame, in the stream time base
+  int64_t getFrameTimestamp(const AVFrame *frame)
+  {
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(53,34,0)
+    if (frame->best_effort_timestamp != (int64_t)AV_NOPTS_VALUE)
+      return frame->best_effort_timestamp;
+#endif
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(52,94,3)
+    if (frame->pkt_pts != (int64_t)AV_NOPTS_VALUE)
+      return frame->pkt_pts;
+#endif
+    (void)frame;
+    return (int64_t)AV_NOPTS_VALUE;
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
-  Gets the \f$ frame \f$ th frame from the video and stores it in the image  \f$ I \f$.
-  
-  \param I : The vpImage used to stored the video's frame.
-  \param frame : The index of the frame which has to be read.
-  
-  \return It returns true if the frame could be read. Else it returns false.
+  Decode the frame \e frame in pFrame, so that the next acquire() returns
+  it. When the frame is after the current position and no key frame lies in
+  between, the frames are decoded forward. Otherwise the stream is moved to
+  the nearest key frame before the frame.
+
+  Since the decoder outputs the frames in display order but may need several
+  packets before the first one (B-frames), the frames are decoded until the
+  timestamp of the decoded frame reaches the one of the requested frame in
+  the index. The frames are counted only when the decoder does not provide
+  timestamps.
+
+  \return false if the frame does not exist or the end of the stream was
+  reached before it.
 */
-bool vpFFMPEG::getFrame(vpImage<vpRGBa> &I, unsigned int frame)
+bool vpFFMPEG::seekFrame(unsigned int frame)
 {
+  if (frame >= frameNumber || streamWasInitialized == false)
+  {
+    vpTRACE("Couldn't get a frame");
+    return false;
+  }
+
+  if (pendingFrame && currentFrame == (long)frame)
+    return true;
+
+  std::vector<unsigned int>::const_iterator it = std::upper_bound(keyframes.begin(), keyframes.end(), frame);
+  unsigned int keyframe = (it == keyframes.begin()) ? 0 : *(it - 1);
 
-  if (frame < frameNumber && streamWasInitialized== true)
+  if (currentFrame < 0 || (long)frame < currentFrame || (long)keyframe > currentFrame)
   {
-    int64_t targetPts = index[frame];
-    av_seek_frame(pFormatCtx, (int)videoStream,targetPts, AVSEEK_FLAG_ANY);
+    if (av_seek_frame(pFormatCtx, (int)videoStream, index[keyframe], AVSEEK_FLAG_BACKWARD) < 0)
+    {
+      vpTRACE("Couldn't seek to frame %u", keyframe);
+      currentFrame = -1;
+      pendingFrame = false;
+      return false;
+    }
+    avcodec_flush_buffers(pCodecCtx) ;
+    currentFrame = (long)keyframe;
+    pendingFrame = false;
   }
-  else
+
+  for (;;)
   {
-    vpTRACE("Couldn't get a frame");
-    return false;
+    if (! pendingFrame && ! decodeFrame())
+    {
+      // End of the stream
+      currentFrame = -1;
+      return false;
+    }
+    pendingFrame = false;
+
+    int64_t ts = getFrameTimestamp(pFrame);
+    bool reached = (ts != (int64_t)AV_NOPTS_VALUE) ? (ts >= index[frame]) : (currentFrame >= (long)frame);
+    if (reached)
+    {
+      currentFrame = (long)frame;
+      pendingFrame = true;
+      return true;
+    }
+    currentFrame++;
   }
-  
-  avcodec_flush_buffers(pCodecCtx) ;
+}
 
-  int frameFinished ;
+/*!
+  Decode the next frame of the stream in pFrame. At the end of the stream,
+  the frames delayed by the decoder are returned.
+
+  \return false when there is no more frame.
+*/
+bool vpFFMPEG::decodeFrame()
+{
+  int frameFinished = 0;
 
   av_init_packet(packet);
   while (av_read_frame (pFormatCtx, packet) >= 0)
@@ -316,20 +429,93 @@ bool vpFFMPEG::getFrame(vpImage<vpRGBa> &I, unsigned int frame)
 #else
       avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet); // libavcodec >= 52.72.2 (0.6)
 #endif
-      if (frameFinished)
-      {
-        if (color_type == vpFFMPEG::COLORED)
-          sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
-        else if (color_type == vpFFMPEG::GRAY_SCALED)
-          sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameGRAY->data, pFrameGRAY->linesize);
+    }
+    av_free_packet(packet);
+    if (frameFinished)
+      return true;
+  }
 
-        copyBitmap(I);
-        break;
-      }
+  // Flush the decoder
+  av_init_packet(packet);
+  packet->data = NULL;
+  packet->size = 0;
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,72,2)
+  avcodec_decode_video(pCodecCtx, pFrame,
+                       &frameFinished, packet->data, packet->size);
+#else
+  avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet);
+#endif
+  return (frameFinished != 0);
+}
+
+/*!
+  Convert the decoded frame in \e I. For a colored stream, the frame is
+  converted directly in the image bitmap, the memory layout of vpRGBa being
+  the one of PIX_FMT_RGBA. The alpha channel is set to vpRGBa::alpha_default
+  by the conversion, as for a gray scaled stream.
+*/
+void vpFFMPEG::convertFrame(vpImage<vpRGBa> &I)
+{
+  if (color_type == vpFFMPEG::COLORED)
+  {
+    if(height < 0 || width < 0){
+      throw vpException(vpException::dimensionError, "width or height negative.");
     }
+    I.resize((unsigned int)height, (unsigned int)width);
+    uint8_t *dst[4] = { (uint8_t *)I.bitmap, NULL, NULL, NULL };
+    int dstStride[4] = { 4*width, 0, 0, 0 };
+    sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, dst, dstStride);
   }
+  else if (color_type == vpFFMPEG::GRAY_SCALED)
+  {
+    sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameGRAY->data, pFrameGRAY->linesize);
+    copyBitmap(I);
+  }
+}
+
+/*!
+  Convert the decoded frame in \e I. For a gray scaled stream, the frame is
+  converted directly in the image bitmap.
+*/
+void vpFFMPEG::convertFrame(vpImage<unsigned char> &I)
+{
+  if (color_type == vpFFMPEG::GRAY_SCALED)
+  {
+    if(height < 0 || width < 0){
+      throw vpException(vpException::dimensionError, "width or height negative.");
+    }
+    I.resize((unsigned int)height, (unsigned int)width);
+    uint8_t *dst[4] = { (uint8_t *)I.bitmap, NULL, NULL, NULL };
+    int dstStride[4] = { width, 0, 0, 0 };
+    sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, dst, dstStride);
+  }
+  else if (color_type == vpFFMPEG::COLORED)
+  {
+    sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
+    copyBitmap(I);
+  }
+}
+
+/*!
+  Gets the \f$ frame \f$ th frame from the video and stores it in the image  \f$ I \f$.
+
+  Only the frames from the nearest key frame before the requested one are
+  decoded, or from the current position when reading forward.
+  
+  \param I : The vpImage used to stored the video's frame.
+  \param frame : The index of the frame which has to be read.
+  
+  \return It returns true if the frame could be read. Else it returns false.
+*/
+bool vpFFMPEG::getFrame(vpImage<vpRGBa> &I, unsigned int frame)
+{
+  if (! seekFrame(frame))
+    return false;
+
+  convertFrame(I);
+  pendingFrame = false;
+  currentFrame = (long)frame + 1;
 
-  av_free_packet(packet);
   return true;
 }
 
@@ -343,43 +529,27 @@ bool vpFFMPEG::getFrame(vpImage<vpRGBa> &I, unsigned int frame)
 */
 bool vpFFMPEG::acquire(vpImage<vpRGBa> &I)
 {
-  int frameFinished ;
-  
   if (streamWasInitialized == false)
   {
     vpTRACE("Couldn't get a frame. The parameters have to be initialized before ");
     return false;
   }
 
-  av_init_packet(packet);
-  while (av_read_frame (pFormatCtx, packet) >= 0)
-  {
-    if (packet->stream_index == (int)videoStream)
-    {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,72,2)
-      avcodec_decode_video(pCodecCtx, pFrame,
-         &frameFinished, packet->data, packet->size);
-#else
-      avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet); // libavcodec >= 52.72.2 (0.6)
-#endif
-      if (frameFinished)
-      {
-        if (color_type == vpFFMPEG::COLORED)
-	  sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
-        else if (color_type == vpFFMPEG::GRAY_SCALED)
-	  sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameGRAY->data, pFrameGRAY->linesize);
+  if (! pendingFrame && ! decodeFrame())
+    return false;
 
-        copyBitmap(I);
-        break;
-      }
-    }
-  }
-  av_free_packet(packet);
+  convertFrame(I);
+  pendingFrame = false;
+  if (currentFrame >= 0)
+    currentFrame++;
   return true;
 }
 
 /*!
   Gets the \f$ frame \f$ th frame from the video and stores it in the image  \f$ I \f$.
+
+  Only the frames from the nearest key frame before the requested one are
+  decoded, or from the current position when reading forward.
   
   \param I : The vpImage used to stored the video's frame.
   \param frame : The index of the frame which has to be read.
@@ -388,48 +558,14 @@ bool vpFFMPEG::acquire(vpImage<vpRGBa> &I)
 */
 bool vpFFMPEG::getFrame(vpImage<unsigned char> &I, unsigned int frame)
 {
-
-  if (frame < frameNumber && streamWasInitialized== true)
-  {
-    int64_t targetPts = index[frame];
-    av_seek_frame(pFormatCtx,(int)videoStream,targetPts, AVSEEK_FLAG_ANY);
-  }
-  else
-  {
-    vpTRACE("Couldn't get a frame");
+  if (! seekFrame(frame))
     return false;
-  }
-  
-  avcodec_flush_buffers(pCodecCtx) ;
 
-  int frameFinished ;
+  convertFrame(I);
+  pendingFrame = false;
+  currentFrame = (long)frame + 1;
 
-  av_init_packet(packet);
-  while (av_read_frame (pFormatCtx, packet) >= 0)
-  {
-    if (packet->stream_index == (int)videoStream)
-    {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,72,2)
-      avcodec_decode_video(pCodecCtx, pFrame,
-         &frameFinished, packet->data, packet->size);
-#else
-      avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet); // libavcodec >= 52.72.2 (0.6)
-#endif
-      if (frameFinished)
-      {
-        if (color_type == vpFFMPEG::COLORED)
-          sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
-	else if (color_type == vpFFMPEG::GRAY_SCALED)
-          sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameGRAY->data, pFrameGRAY->linesize);
-
-          copyBitmap(I);
-          break;
-        }
-      }
-    }
-
-    av_free_packet(packet);
-    return true;
+  return true;
 }
 
 
@@ -442,42 +578,155 @@ bool vpFFMPEG::getFrame(vpImage<unsigned char> &I, unsigned int frame)
 */
 bool vpFFMPEG::acquire(vpImage<unsigned char> &I)
 {
-  int frameFinished ;
-  
   if (streamWasInitialized == false)
   {
     vpTRACE("Couldn't get a frame. The parameters have to be initialized before ");
     return false;
   }
 
-  av_init_packet(packet);
-  while (av_read_frame (pFormatCtx, packet) >= 0)
+  if (! pendingFrame && ! decodeFrame())
+    return false;
+
+  convertFrame(I);
+  pendingFrame = false;
+  if (currentFrame >= 0)
+    currentFrame++;
+  return true;
+}
+
+/*!
+  Save the frame index built by initStream() in a sidecar file, so that
+  the video does not need to be browsed the next time it is opened.
+
+  \param filename : Name of the index file.
+
+  \return false if the stream is not initialized or if the file could not be written.
+
+  \sa loadIndex()
+*/
+bool vpFFMPEG::saveIndex(const std::string &filename) const
+{
+  if (! streamWasInitialized)
   {
-    if (packet->stream_index == (int)videoStream)
-    {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,72,2)
-      avcodec_decode_video(pCodecCtx, pFrame,
-         &frameFinished, packet->data, packet->size);
-#else
-      avcodec_decode_video2(pCodecCtx, pFrame, &frameFinished, packet); // libavcodec >= 52.72.2 (0.6)
-#endif
-     if (frameFinished)
-      {
-        if (color_type == vpFFMPEG::COLORED)
-	  sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameRGB->data, pFrameRGB->linesize);
-        else if (color_type == vpFFMPEG::GRAY_SCALED)
-	  sws_scale(img_convert_ctx, pFrame->data, pFrame->linesize, 0, pCodecCtx->height, pFrameGRAY->data, pFrameGRAY->linesize);
+    vpTRACE("The stream has to be initialized before saving the index");
+    return false;
+  }
 
-        copyBitmap(I);
-        break;
-      }
+  std::ofstream file(filename.c_str());
+  if (! file.is_open())
+    return false;
+
+  file << "# ViSP ffmpeg frame index" << std::endl;
+  file << index.size() << std::endl;
+  size_t k = 0;
+  for (size_t i = 0; i < index.size(); i++) {
+    bool key = (k < keyframes.size() && keyframes[k] == i);
+    if (key)
+      k++;
+    file << (long long)index[i] << " " << (key ? 1 : 0) << std::endl;
+  }
+
+  return file.good();
+}
+
+/*!
+  Load a frame index previously saved with saveIndex(). This method has to
+  be called after openStream() and before initStream(), that then uses
+  this index instead of browsing the video.
+
+  \param filename : Name of the index file.
+
+  \return false if the stream is not opened, if the file could not be read,
+  if its number of frames doesn't match the one given by the stream header or
+  if its timestamps are not sorted.
+
+  \code
+  vpFFMPEG ffmpeg;
+  ffmpeg.openStream("video.mpeg", vpFFMPEG::COLORED);
+  if (! ffmpeg.loadIndex("video.mpeg.index")) {
+    ffmpeg.initStream();
+    ffmpeg.saveIndex("video.mpeg.index");
+  }
+  else
+    ffmpeg.initStream();
+  \endcode
+*/
+bool vpFFMPEG::loadIndex(const std::string &filename)
+{
+  if (! streamWasOpen)
+  {
+    vpTRACE("The stream has to be opened before loading the index");
+    return false;
+  }
+
+  std::ifstream file(filename.c_str());
+  if (! file.is_open())
+    return false;
+
+  std::string header;
+  std::getline(file, header);
+  if (header != "# ViSP ffmpeg frame index")
+    return false;
+
+  unsigned long n;
+  if (! (file >> n))
+    return false;
+  if (! isIndexSizeValid(n))
+  {
+    vpTRACE("The number of frames of the index (%lu) doesn't match the video", n);
+    return false;
+  }
+
+  // The size comes from the file, the vectors grow with the frames read
+  std::vector<int64_t> ts;
+  std::vector<unsigned int> keys;
+  for (unsigned long i = 0; i < n; i++) {
+    long long t;
+    int key;
+    if (! (file >> t >> key))
+      return false;
+    if (! ts.empty() && (int64_t)t < ts.back())
+    {
+      vpTRACE("The timestamps of the index are not sorted");
+      return false;
     }
+    ts.push_back((int64_t)t);
+    if (key)
+      keys.push_back((unsigned int)i);
   }
-  av_free_packet(packet);
+  if (n > 0 && (keys.empty() || keys[0] != 0))
+    keys.insert(keys.begin(), 0);
+
+  index = ts;
+  keyframes = keys;
   return true;
 }
 
 
+/*!
+  Check the number of frames of an index file against the number of frames
+  or the duration given by the stream header, when they are known. The
+  index is rejected when it differs from them by more than 5 percent, or
+  two frames for short videos. A duration estimated from the bit rate is too
+  coarse to be used.
+*/
+bool vpFFMPEG::isIndexSizeValid(unsigned long n) const
+{
+  AVStream *stream = pFormatCtx->streams[videoStream];
+  double expected = -1;
+  if (stream->nb_frames > 0)
+    expected = (double)stream->nb_frames;
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(55,0,100)
+  else if (pFormatCtx->duration_estimation_method != AVFMT_DURATION_FROM_BITRATE
+           && stream->duration != (int64_t)AV_NOPTS_VALUE && stream->duration > 0 && framerate_stream > 0)
+    expected = (double)stream->duration * av_q2d(stream->time_base) * framerate_stream;
+#endif
+
+  if (expected < 0)
+    return true; // Nothing to compare with
+  return std::fabs((double)n - expected) <= std::max(2., 0.05 * expected);
+}
+
 /*!
   This method enable to fill the vpImage bitmap thanks to the selected frame.
   
@@ -493,9 +742,7 @@ void vpFFMPEG::copyBitmap(vpImage<vpRGBa> &I)
   }
   I.resize((unsigned int)height, (unsigned int)width);
   
-  unsigned char* line;
   unsigned char* beginOutput = (unsigned char*)I.bitmap;
-  unsigned char* output = NULL;
 
   if (color_type == COLORED)
   {
@@ -503,19 +750,9 @@ void vpFFMPEG::copyBitmap(vpImage<vpRGBa> &I)
     int widthStep = pFrameRGB->linesize[0];
     for(int i=0 ; i < height ; i++)
     {
-      line = input;
-      output = beginOutput + 4 * width * i;
-      for(int j=0 ; j < width ; j++)
-      {
-        *(output++) = *(line);
-        *(output++) = *(line+1);
-        *(output++) = *(line+2);
-        *(output++) = 0;
-
-        line+=3;
-      }
-    //go to the next line
-    input+=widthStep;
+      memcpy(beginOutput + 4 * width * i, input, (size_t)(4 * width));
+      //go to the next line
+      input+=widthStep;
     }
   }
   
@@ -525,17 +762,7 @@ void vpFFMPEG::copyBitmap(vpImage<vpRGBa> &I)
     int widthStep = pFrameGRAY->linesize[0];
     for(int i=0 ; i < height ; i++)
     {
-      line = input;
-      output = beginOutput + 4 * width * i;
-      for(int j=0 ; j < width ; j++)
-        {
-          *output++ = *(line);
-          *output++ = *(line);
-          *output++ = *(line);
-          *output++ = *(line);;
-
-          line++;
-        }
+      vpImageConvert::GreyToRGBa(input, beginOutput + 4 * width * i, (unsigned int)width);
       //go to the next line
       input+=widthStep;
     }
@@ -565,16 +792,9 @@ void vpFFMPEG::copyBitmap(vpImage<unsigned char> &I)
     int widthStep = pFrameGRAY->linesize[0];
     for(int i=0 ; i < height ; i++)
     {
-      unsigned char *line = input;
-      unsigned char *output = beginOutput + width * i;
-      for(int j=0 ; j < width ; j++)
-      {
-        *(output++) = *(line);
-
-        line++;
-      }
-    //go to the next line
-    input+=widthStep;
+      memcpy(beginOutput + width * i, input, (size_t)width);
+      //go to the next line
+      input+=widthStep;
     }
   }
   
@@ -584,7 +804,7 @@ void vpFFMPEG::copyBitmap(vpImage<unsigned char> &I)
     int widthStep = pFrameRGB->linesize[0];
     for (int i = 0  ; i < height ; i++)
     {
-      vpImageConvert::RGBToGrey(input + i*widthStep, beginOutput + i*width, (unsigned int)width, 1, false);
+      vpImageConvert::RGBaToGrey(input + i*widthStep, beginOutput + i*width, (unsigned int)width);
     }
   }
 }
@@ -621,6 +841,10 @@ void vpFFMPEG::closeStream()
 #endif
   }
   streamWasOpen = false;
+  index.clear();
+  keyframes.clear();
+  currentFrame = -1;
+  pendingFrame = false;
   
   if (encoderWasOpened)
   {
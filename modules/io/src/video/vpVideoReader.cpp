@@ -59,7 +59,8 @@ vpVideoReader::vpVideoReader()
   capture(), frame(),
 #endif
 	formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0),
-	firstFrame(0), lastFrame(0), firstFrameIndexIsSet(false), lastFrameIndexIsSet(false)
+	firstFrame(0), lastFrame(0), firstFrameIndexIsSet(false), lastFrameIndexIsSet(false),
+	prefetchThreads(0), prefetchSize(8)
 {
 }
 
@@ -128,6 +129,26 @@ void vpVideoReader::setFileName(const std::string &filename)
 	setFileName(filename.c_str());
 }
 
+/*!
+Enable the read-ahead mode when reading a sequence of images. Background
+threads then decode the next images of the sequence while the current one is
+processed, and acquire() only waits for the decoding when the processing is
+faster than it. Frames are still delivered in order, and getFrame() may be
+used to seek in the sequence. This setting has no effect on video files.
+
+\param nbThreads : Number of decoder threads. Set 0 to disable the read-ahead mode (default).
+\param bufferSize : Maximum number of images decoded ahead.
+
+\sa vpDiskGrabber::setPrefetch()
+*/
+void vpVideoReader::setPrefetch(unsigned int nbThreads, unsigned int bufferSize)
+{
+	prefetchThreads = nbThreads;
+	prefetchSize = bufferSize;
+	if (imSequence != NULL)
+		imSequence->setPrefetch(prefetchThreads, prefetchSize);
+}
+
 /*!
 Sets all the parameters needed to read the video or the image sequence.
 
@@ -147,6 +168,7 @@ void vpVideoReader::open(vpImage< vpRGBa > &I)
 	{
 		imSequence = new vpDiskGrabber;
 		imSequence->setGenericName(fileName);
+		imSequence->setPrefetch(prefetchThreads, prefetchSize);
 		if (firstFrameIndexIsSet)
 			imSequence->setImageNumber(firstFrame);
 	}
@@ -189,6 +211,8 @@ void vpVideoReader::open(vpImage< vpRGBa > &I)
 	isOpen = true;
 	findLastFrameIndex();
 	frameCount = firstFrame; // open() should not increase the frame counter
+	if (imSequence != NULL)
+		imSequence->setImageNumber(firstFrame);
 }
 
 
@@ -211,6 +235,7 @@ void vpVideoReader::open(vpImage<unsigned char> &I)
 	{
 		imSequence = new vpDiskGrabber;
 		imSequence->setGenericName(fileName);
+		imSequence->setPrefetch(prefetchThreads, prefetchSize);
 		if (firstFrameIndexIsSet)
 			imSequence->setImageNumber(firstFrame);
 	}
@@ -253,6 +278,8 @@ void vpVideoReader::open(vpImage<unsigned char> &I)
 	isOpen = true;
 	findLastFrameIndex();
 	frameCount = firstFrame; // open() should not increase the frame counter
+	if (imSequence != NULL)
+		imSequence->setImageNumber(firstFrame);
 }
 
 
@@ -365,6 +392,7 @@ bool vpVideoReader::getFrame(vpImage<vpRGBa> &I, long frame_index)
 		{
       imSequence->acquire(I, frame_index);
       frameCount = frame_index + 1; // next index
+      imSequence->setImageNumber(frameCount); // acquire() continues from here
     }
 		catch(...)
 		{
@@ -443,6 +471,7 @@ bool vpVideoReader::getFrame(vpImage<unsigned char> &I, long frame_index)
 		{
       imSequence->acquire(I, frame_index);
       frameCount = frame_index + 1;
+      imSequence->setImageNumber(frameCount); // acquire() continues from here
     }
 		catch(...)
 		{
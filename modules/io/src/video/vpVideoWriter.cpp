@@ -66,7 +66,8 @@ vpVideoWriter::vpVideoWriter() :
     writer(), fourcc(0), framerate(0.),
 #endif
     formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0),
-    firstFrame(0), width(0), height(0)
+    firstFrame(0), width(0), height(0), asyncWriter(NULL), asyncThreads(0), asyncQueueSize(16),
+    asyncPolicy(vpAsyncImageWriter::BLOCK)
 {
   initFileName = false;
   firstFrame = 0;
@@ -101,6 +102,8 @@ vpVideoWriter::~vpVideoWriter()
   if (ffmpeg != NULL)
     delete ffmpeg;
   #endif
+  if (asyncWriter != NULL)
+    delete asyncWriter; // Waits for the pending images
 }
 
 
@@ -167,6 +170,8 @@ void vpVideoWriter::open(vpImage< vpRGBa > &I)
   {
     width = I.getWidth();
     height = I.getHeight();
+
+    openAsyncWriter();
   }
   else if (formatType == FORMAT_AVI ||
            formatType == FORMAT_MPEG ||
@@ -220,6 +225,8 @@ void vpVideoWriter::open(vpImage< unsigned char > &I)
   {
     width = I.getWidth();
     height = I.getHeight();
+
+    openAsyncWriter();
   }
   else if (formatType == FORMAT_AVI ||
            formatType == FORMAT_MPEG ||
@@ -278,7 +285,10 @@ void vpVideoWriter::saveFrame (vpImage< vpRGBa > &I)
 
     sprintf(name,fileName,frameCount);
 
-    vpImageIo::write(I, name);
+    if (asyncWriter != NULL)
+      asyncWriter->write(I, name);
+    else
+      vpImageIo::write(I, name);
   }
   else
   {
@@ -319,7 +329,10 @@ void vpVideoWriter::saveFrame (vpImage< unsigned char > &I)
 
     sprintf(name,fileName,frameCount);
 
-    vpImageIo::write(I, name);
+    if (asyncWriter != NULL)
+      asyncWriter->write(I, name);
+    else
+      vpImageIo::write(I, name);
   }
   else
   {
@@ -358,6 +371,89 @@ void vpVideoWriter::close()
     ffmpeg->endWrite();
   }
   #endif
+  if (asyncWriter != NULL)
+  {
+    asyncWriter->flush();
+    if (asyncWriter->getErrorCount() > 0) {
+      throw (vpException(vpException::ioError, "%u images could not be written: %s",
+                         asyncWriter->getErrorCount(), asyncWriter->getLastError().c_str()));
+    }
+  }
+}
+
+/*!
+  Create the background writer for the settings given to setAsync(), or
+  reuse the current one when they are unchanged. The counters of the writer
+  are reset, so that the errors and the dropped images of a previous
+  sequence are not reported for the new one.
+*/
+void vpVideoWriter::openAsyncWriter()
+{
+  if (asyncWriter != NULL && (asyncThreads == 0 || asyncWriter->getThreadCount() != asyncThreads
+                              || asyncWriter->getQueueSize() != asyncQueueSize
+                              || asyncWriter->getPolicy() != asyncPolicy)) {
+    delete asyncWriter;
+    asyncWriter = NULL;
+  }
+  if (asyncWriter != NULL) {
+    asyncWriter->flush();
+    asyncWriter->resetCounters();
+  }
+  else if (asyncThreads > 0)
+    asyncWriter = new vpAsyncImageWriter(asyncThreads, asyncQueueSize, asyncPolicy);
+}
+
+/*!
+  Write the images of a sequence from background threads, so that
+  saveFrame() only copies the image and returns. The PNG or JPEG compression
+  and the file writing are then performed in parallel with the caller. This
+  setting is taken into account by the next call to open() and has no effect
+  on video files.
+
+  When more than \e queueSize images are waiting to be written, the behavior
+  of saveFrame() is given by \e policy. A dropped image keeps its frame
+  index, so that the file names of the following images are unchanged.
+  close() waits until all the pending images are written.
+
+  \param nbThreads : Number of background threads. Set 0 to write the
+  images synchronously (default).
+  \param queueSize : Maximum number of images waiting to be written.
+  \param policy : Behavior of saveFrame() when the queue is full.
+
+  \sa getQueueDepth(), getDroppedFrameCount(), vpAsyncImageWriter
+*/
+void vpVideoWriter::setAsync(unsigned int nbThreads, unsigned int queueSize,
+                             vpAsyncImageWriter::vpQueuePolicy policy)
+{
+  asyncThreads = nbThreads;
+  asyncQueueSize = queueSize;
+  asyncPolicy = policy;
+}
+
+/*!
+  Return the number of images of the sequence that were dropped because
+  the queue of the background writer was full.
+
+  \sa setAsync()
+*/
+unsigned int vpVideoWriter::getDroppedFrameCount()
+{
+  if (asyncWriter == NULL)
+    return 0;
+  return asyncWriter->getDroppedCount();
+}
+
+/*!
+  Return the number of images of the sequence waiting to be written by the
+  background writer.
+
+  \sa setAsync()
+*/
+unsigned int vpVideoWriter::getQueueDepth()
+{
+  if (asyncWriter == NULL)
+    return 0;
+  return asyncWriter->getQueueDepth();
 }
 
 
@@ -96,8 +96,14 @@
   The robot inverse jacobian used to compute the joint velocities from
   cartesian ones are given and implemented in get_fJe_inverse().
 
+  The forward kinematics and the jacobians can also be computed for a batch
+  of joint positions, given as the columns of a matrix. Unlike vpAfma6 and
+  vpViper, no inverse kinematics is implemented for this robot.
+
 */
 
+#include <vector>
+
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpRGBa.h>
@@ -122,12 +128,15 @@ class VISP_EXPORT vpAfma4
   vpHomogeneousMatrix get_fMc (const vpColVector & q) const;
   void get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const;
   void get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const;
+  void get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const;
 
   void get_cMe(vpHomogeneousMatrix &cMe) const;
   void get_cVe(vpVelocityTwistMatrix &cVe) const;
   void get_cVf(const vpColVector & q, vpVelocityTwistMatrix &cVf) const;
   void get_eJe(const vpColVector &q, vpMatrix &eJe) const;
+  void get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const;
   void get_fJe(const vpColVector &q, vpMatrix &fJe) const;
+  void get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const;
   void get_fJe_inverse(const vpColVector &q, vpMatrix &fJe_inverse) const;
 
   friend VISP_EXPORT std::ostream & operator << (std::ostream & os, const vpAfma4 & afma4);
@@ -140,6 +149,11 @@ class VISP_EXPORT vpAfma4
 
   static const unsigned int njoint; ///< Number of joint.
 
+ private:
+  void compute_eJe(const double *q, vpMatrix &eJe) const;
+  void compute_fJe(const double *q, vpMatrix &fJe) const;
+  void compute_fMe(const double *q, double fRe[9], double fte[3]) const;
+
  protected:
   // Denavit Hartenberg parameters
   double _a1; // distance along x2
@@ -67,6 +67,8 @@
 
 */
 
+#include <vector>
+
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpRGBa.h>
@@ -143,16 +145,24 @@ class VISP_EXPORT vpAfma6
   int getInverseKinematics(const vpHomogeneousMatrix & fMc,
                            vpColVector & q, const bool &nearest=true,
                            const bool &verbose=false) const;
+  void getInverseKinematics(const std::vector<vpHomogeneousMatrix> & fMc, vpMatrix & Q,
+                            std::vector<int> & nbSol, const bool &nearest=true,
+                            const bool &verbose=false) const;
+  void getInverseKinematicsSolutions(const std::vector<vpHomogeneousMatrix> & fMc, const vpMatrix & Q,
+                                     std::vector<vpMatrix> & solutions, const bool &verbose=false) const;
 
   vpHomogeneousMatrix get_eMc() const;
   vpHomogeneousMatrix get_fMc(const vpColVector & q) const;
   void get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const;
   void get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const;
+  void get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const;
 
   void get_cMe(vpHomogeneousMatrix &cMe) const;
   void get_cVe(vpVelocityTwistMatrix &cVe) const;
   void get_eJe(const vpColVector &q, vpMatrix &eJe) const;
+  void get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const;
   void get_fJe(const vpColVector &q, vpMatrix &fJe) const;
+  void get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const;
 
   //! Get the current tool type
   vpAfma6ToolType getToolType() const {
@@ -182,6 +192,13 @@ class VISP_EXPORT vpAfma6
 
   friend VISP_EXPORT std::ostream & operator << (std::ostream & os, const vpAfma6 & afma6);
 
+ private:
+  void computeInverseKinematics(const vpHomogeneousMatrix & fMe, const double *q, double q_[2][6],
+                                bool ok[2], const bool &verbose) const;
+  void compute_eJe(const double *q, vpMatrix &eJe) const;
+  void compute_fJe(const double *q, vpMatrix &fJe) const;
+  void compute_fMe(const double *q, double fRe[9], double fte[3]) const;
+
  protected:
   /** @name Protected Member Functions Inherited from vpAfma6 */
   //@{
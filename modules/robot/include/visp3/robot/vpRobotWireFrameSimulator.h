@@ -80,6 +80,26 @@
   \warning This class uses threading capabilities. Thus on Unix-like
   platforms, the libpthread third-party library need to be
   installed. On Windows, we use the native threading capabilities.
+
+  By default the robot displacement is computed by a thread that follows the
+  wall clock, so that a simulated motion lasts as long as the real one. When
+  the stepping mode is enabled with setSteppingMode(), this thread is stopped
+  and the simulated time is driven by the caller: each call to setVelocity()
+  or step() moves the robot during exactly one sampling time (see
+  setSamplingTime()), without any sleep. Simulations then run as fast as
+  possible and always give the same trajectory, which is convenient to run
+  many visual servoing scenarios in batch.
+  \code
+  vpSimulatorViper850 robot(false); // No external view
+  robot.setSteppingMode(true);
+  robot.setSamplingTime(0.040);
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+  for (unsigned int iter = 0; iter < 1000; iter ++) {
+    vpColVector v = ...; // Compute the camera velocity
+    robot.setVelocity(vpRobot::CAMERA_FRAME, v); // Simulated time advances by 40 ms
+  }
+  std::cout << "Simulated time: " << robot.getSimulationTime() << " s" << std::endl;
+  \endcode
 */
 class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, public vpRobotSimulator
 {
@@ -169,6 +189,11 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     bool setVelocityCalled;
 
     bool verbose_;
+
+    //! Flag set when the robot displacement is computed by step() rather than by the thread.
+    bool steppingMode;
+    //! Simulated time in second since the stepping mode was enabled.
+    double simulationTime;
     
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -234,6 +259,13 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     void getInternalView(vpImage<unsigned char> &I);
 
     vpHomogeneousMatrix get_cMo();
+    /*!
+      Get the simulated time in second elapsed since the stepping mode was
+      enabled.
+
+      \sa setSteppingMode(), step()
+    */
+    inline double getSimulationTime() const {return simulationTime;}
     /*!
       Get the pose between the object and the fixed world frame.
 
@@ -247,6 +279,14 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     void initScene (const vpSceneObject &obj);
     void initScene(const char* obj);
 
+    /*!
+      Return true if the robot displacement is driven by the caller through
+      step() and setVelocity().
+
+      \sa setSteppingMode()
+    */
+    inline bool isSteppingMode() const {return steppingMode;}
+
     /*!
       Set the color used to display the camera in the external view.
 
@@ -319,12 +359,14 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
       \param delta_t : Sampling time in second used to compute the robot displacement from
       the velocity applied to the robot during this time.
 
-      Since the wireframe simulator is threaded, the sampling time is set to vpTime::getMinTimeForUsleepCall() / 1000 seconds.
+      Since the wireframe simulator is threaded, the sampling time cannot be lower
+      than vpTime::getMinTimeForUsleepCall() / 1000 seconds. This limit does not
+      apply in stepping mode; see setSteppingMode().
 
     */
     inline void setSamplingTime(const double &delta_t)
     {
-      if(delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)){
+      if(! steppingMode && delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)){
         this->delta_t_ = static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3);
       } else {
         this->delta_t_ = delta_t;
@@ -332,6 +374,8 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     }
     /*! Set the parameter which enable or disable the singularity mangement */
     void setSingularityManagement (const bool sm) {singularityManagement = sm;}
+
+    void setSteppingMode(bool stepping);
               
     /*!
       Activates extra printings when the robot reaches joint limits...
@@ -347,6 +391,8 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
       \param fMo_ : The pose between the object and the fixed world frame.
     */
     void set_fMo(const vpHomogeneousMatrix &fMo_) {this->fMo = fMo_;}
+
+    void step();
     //@}
 
   protected:
@@ -370,10 +416,14 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     }
 #endif
     
+    void launchThread();
+    void joinThread();
+
     /* Robot functions */
     void init() {;}
     /*! Method lauched by the thread to compute the position of the robot in the articular frame. */
     virtual void updateArticularPosition() = 0;
+    virtual void computeArticularPosition(double ellapsedTime);
     /*! Method used to check if the robot reached a joint limit. */
     virtual int isInJointLimit () = 0;
     /*! Compute the articular velocity relative to the velocity in another frame. */
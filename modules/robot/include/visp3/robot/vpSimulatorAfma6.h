@@ -249,6 +249,7 @@ public:
 protected:
     /** @name Protected Member Functions Inherited from vpSimulatorAfma6 */
     //@{
+    void computeArticularPosition(double ellapsedTime);
     void computeArticularVelocity();
     void compute_fMi();
     void findHighestPositioningSpeed(vpColVector &q);
@@ -277,6 +277,7 @@ class VISP_EXPORT vpSimulatorViper850 : public vpRobotWireFrameSimulator, public
 protected:
     /** @name Protected Member Functions Inherited from vpSimulatorViper850 */
     //@{
+    void computeArticularPosition(double ellapsedTime);
     void computeArticularVelocity();
     void compute_fMi();
     void findHighestPositioningSpeed(vpColVector &q);
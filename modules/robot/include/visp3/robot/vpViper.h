@@ -46,6 +46,8 @@
 
 */
 
+#include <vector>
+
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpRGBa.h>
@@ -108,6 +110,29 @@
   from joint ones is given and implemented in get_fJw(), get_fJe() and
   get_eJe().
 
+  The forward kinematics, the jacobians and the inverse kinematics can also
+  be evaluated for a batch of joint positions, for example to sample a
+  workspace or a trajectory. The joint positions are then given as a
+  \f$6 \times N\f$ matrix whose column \e k contains the six joint positions
+  of configuration \e k. The results are written in the elements of the
+  output vectors, that are only reallocated when the number of configurations
+  changes. When ViSP is built with OpenMP, the configurations are processed in
+  parallel.
+  \code
+  vpViper850 robot;
+  vpMatrix Q(6, 1000); // 1000 joint positions
+  ...
+  std::vector<vpHomogeneousMatrix> fMc;
+  std::vector<vpMatrix> eJe;
+  robot.get_fMc(Q, fMc);
+  robot.get_eJe(Q, eJe);
+
+  // Nearest solution of the inverse kinematics from the joint positions Q
+  vpMatrix Qik = Q;
+  std::vector<unsigned int> nbSol;
+  robot.getInverseKinematics(fMc, Qik, nbSol);
+  \endcode
+
 */
 class VISP_EXPORT vpViper
 {
@@ -120,6 +145,10 @@ class VISP_EXPORT vpViper
   vpHomogeneousMatrix getForwardKinematics(const vpColVector & q) const;
   unsigned int getInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, vpColVector & q, const bool &verbose=false) const;
   unsigned int getInverseKinematics(const vpHomogeneousMatrix & fMc, vpColVector & q, const bool &verbose=false) const;
+  void getInverseKinematics(const std::vector<vpHomogeneousMatrix> & fMc, vpMatrix & Q,
+                            std::vector<unsigned int> & nbSol, const bool &verbose=false) const;
+  void getInverseKinematicsSolutions(const std::vector<vpHomogeneousMatrix> & fMc, const vpMatrix & Q,
+                                     std::vector<vpMatrix> & solutions, const bool &verbose=false) const;
   vpHomogeneousMatrix get_fMc (const vpColVector & q) const;
   void get_fMw(const vpColVector & q, vpHomogeneousMatrix & fMw) const;
   void get_wMe(vpHomogeneousMatrix & wMe) const;
@@ -127,12 +156,15 @@ class VISP_EXPORT vpViper
   void get_eMs(vpHomogeneousMatrix & eMs) const;
   void get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const;
   void get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const;
+  void get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const;
 
   void get_cMe(vpHomogeneousMatrix &cMe) const;
   void get_cVe(vpVelocityTwistMatrix &cVe) const;
   void get_fJw(const vpColVector &q, vpMatrix &fJw) const;
   void get_fJe(const vpColVector &q, vpMatrix &fJe) const;
+  void get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const;
   void get_eJe(const vpColVector &q, vpMatrix &eJe) const;
+  void get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const;
 
   virtual void set_eMc(const vpHomogeneousMatrix &eMc_);
   virtual void set_eMc(const vpTranslationVector &etc_, const vpRxyzVector &erc_);
@@ -145,6 +177,10 @@ class VISP_EXPORT vpViper
   friend VISP_EXPORT std::ostream & operator << (std::ostream & os, const vpViper & viper);
 
  private:
+  void computeInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, const double *q, double q_sol[8][6],
+                                     bool ok[8], const bool &verbose) const;
+  void compute_fJw(const double *q, double fJw[36]) const;
+  void compute_fMw(const double *q, double fRw[9], double ftw[3]) const;
   bool convertJointPositionInLimits(unsigned int joint, const double &q, double &q_mod, const bool &verbose=false) const;
 
  public:
@@ -50,6 +50,7 @@
 #include <limits>   // numeric_limits
 #include <list>
 #include <string>
+#include <vector>
 
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpImage.h>
@@ -98,6 +99,8 @@
   You can move the main external view while clicking in the image. The left click enables to turn, the middle button enables to zoom and the left to translate along x and y.
   
   The simulator is able to take into account to camera parameters. You can set the internal and external cameras parameters thanks to a vpCameraParameters.
+
+  The views obtained with getInternalImage() and getExternalImage() are drawn as overlays and thus require a display attached to the image. When no display is available, renderInternalImage() rasterizes the internal view directly in the image pixels. To render a large number of camera poses offline, renderInternalImages() renders them into preallocated images, in parallel when ViSP is built with OpenMP.
   
   The following example shows how it is easy to use.
   
@@ -358,6 +361,11 @@ public:
   void getInternalImage(vpImage<unsigned char> &I);
   void getInternalImage(vpImage<vpRGBa> &I);
 
+  void renderInternalImage(vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo);
+  void renderInternalImage(vpImage<vpRGBa> &I, const vpHomogeneousMatrix &cMo);
+  void renderInternalImages(const std::vector<vpHomogeneousMatrix> &list_cMo, std::vector<vpImage<unsigned char> > &images);
+  void renderInternalImages(const std::vector<vpHomogeneousMatrix> &list_cMo, std::vector<vpImage<vpRGBa> > &images);
+
   /*!
       Get the pose between the object and the camera.
 
@@ -537,6 +545,10 @@ protected:
   vpImagePoint projectCameraTrajectory (const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &fMo);
   vpImagePoint projectCameraTrajectory (const vpImage<vpRGBa> &I, const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &fMo, const vpHomogeneousMatrix &cMf);
   vpImagePoint projectCameraTrajectory (const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &fMo, const vpHomogeneousMatrix &cMf);
+  template <class Type>
+  void renderInternalView(vpImage<Type> &I, const vpHomogeneousMatrix &cMo, std::list<vpImageSimulator> &imSim) const;
+  template <class Type>
+  void renderInternalViews(const std::vector<vpHomogeneousMatrix> &list_cMo, std::vector<vpImage<Type> > &images);
   //@}
 };
 
@@ -58,6 +58,22 @@
 /* ---------------------------------------------------------------------- */
 const unsigned int vpAfma4::njoint = 4;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  /* Under this number of configurations, batched kinematics is computed by the calling thread. */
+  const int afma4ParallelCount = 32;
+
+  void checkJointMatrix(const vpMatrix &Q)
+  {
+    if (Q.getRows() != 4) {
+      throw vpException(vpException::dimensionError,
+                        "The joint positions matrix should have 4 rows, not %d", Q.getRows());
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 
 /*!
 
@@ -231,6 +247,45 @@ vpAfma4::get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const
   return;
 }
 
+/*!
+
+  Compute the forward kinematics (direct geometric model) for a batch of
+  joint positions.
+
+  \param Q : A \f$4 \times N\f$ matrix whose column \e k contains the four
+  joint positions of configuration \e k, in the same order than for
+  get_fMc(const vpColVector &, vpHomogeneousMatrix &) const.
+
+  \param fMc : The \e N homogeneous matrices \f$^f{\bf M}_c \f$. The vector
+  is only resized if it does not contain \e N elements.
+
+*/
+void
+vpAfma4::get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fMc.resize((size_t)n);
+
+  const vpHomogeneousMatrix &eMc = this->_eMc;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma4ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[4], R[9], t[3];
+    for (unsigned int j=0; j<4; j++)
+      q[j] = Q[j][k];
+    compute_fMe(q, R, t);
+
+    vpHomogeneousMatrix &M = fMc[(size_t)k];
+    for (unsigned int i=0; i<3; i++) {
+      for (unsigned int j=0; j<4; j++)
+        M[i][j] = R[3*i]*eMc[0][j] + R[3*i+1]*eMc[1][j] + R[3*i+2]*eMc[2][j];
+      M[i][3] += t[i];
+    }
+  }
+}
+
 /*!
 
   Compute the forward kinematics (direct geometric model) as an
@@ -266,6 +321,32 @@ vpAfma4::get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const
 */
 void
 vpAfma4::get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const
+{
+  double R[9], t[3];
+  compute_fMe(q.data, R, t);
+
+  for (unsigned int i=0; i<3; i++) {
+    for (unsigned int j=0; j<3; j++)
+      fMe[i][j] = R[3*i+j];
+    fMe[i][3] = t[i];
+  }
+
+  fMe[3][0] = 0.f;
+  fMe[3][1] = 0.f;
+  fMe[3][2] = 0.f;
+  fMe[3][3] = 1;
+
+  //  vpCTRACE << "Effector position fMe: " << std::endl << fMe;
+
+  return;
+}
+
+/*!
+  Compute the rotation \e fRe (row major) and the translation \e fte of
+  the forward kinematics of the end effector. See get_fMe().
+*/
+void
+vpAfma4::compute_fMe(const double *q, double fRe[9], double fte[3]) const
 {
   double            q1 = q[0]; // rot touret
   double            q2 = q[1]; // vertical translation
@@ -280,29 +361,20 @@ vpAfma4::get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const
   double            s5 = sin(q5);
 
   /* Calcul du modele d'apres les angles. */
-  fMe[0][0] = c1*s4*c5 + s1*c4*c5;
-  fMe[0][1] = -c1*s4*s5 - s1*c4*s5;
-  fMe[0][2] = c1*c4 - s1*s4;
-  fMe[0][3] = c1*this->_a1 - s1*(this->_d3);
-
-  fMe[1][0] = s1*s4*c5 - c1*c4*c5;
-  fMe[1][1] = -s1*s4*s5 + c1*c4*s5;
-  fMe[1][2] = s1*c4+c1*s4;
-  fMe[1][3] = s1*this->_a1 + c1*(this->_d3);
-
-  fMe[2][0] = -s5;
-  fMe[2][1] = -c5;
-  fMe[2][2] = 0.f;
-  fMe[2][3] = this->_d4 + q2;
-
-  fMe[3][0] = 0.f;
-  fMe[3][1] = 0.f;
-  fMe[3][2] = 0.f;
-  fMe[3][3] = 1;
-
-  //  vpCTRACE << "Effector position fMe: " << std::endl << fMe;
-
-  return;
+  fRe[0] = c1*s4*c5 + s1*c4*c5;
+  fRe[1] = -c1*s4*s5 - s1*c4*s5;
+  fRe[2] = c1*c4 - s1*s4;
+  fte[0] = c1*this->_a1 - s1*(this->_d3);
+
+  fRe[3] = s1*s4*c5 - c1*c4*c5;
+  fRe[4] = -s1*s4*s5 + c1*c4*s5;
+  fRe[5] = s1*c4+c1*s4;
+  fte[1] = s1*this->_a1 + c1*(this->_d3);
+
+  fRe[6] = -s5;
+  fRe[7] = -c5;
+  fRe[8] = 0.f;
+  fte[2] = this->_d4 + q2;
 }
 
 /*!
@@ -409,6 +481,50 @@ vpAfma4::get_cVf(const vpColVector & q, vpVelocityTwistMatrix &cVf) const
 */
 void
 vpAfma4::get_eJe(const vpColVector &q, vpMatrix &eJe) const
+{
+  eJe.resize(6, 4);
+  compute_eJe(q.data, eJe);
+}
+
+/*!
+
+  Get the robot jacobian expressed in the end-effector frame for a batch of
+  joint positions.
+
+  \param Q : A \f$4 \times N\f$ matrix whose column \e k contains the four
+  joint positions of configuration \e k.
+
+  \param eJe : The \e N robot jacobians expressed in the end-effector frame.
+  The vector is only resized if it does not contain \e N elements.
+
+  \sa get_eJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpAfma4::get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  eJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma4ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[4];
+    for (unsigned int j=0; j<4; j++)
+      q[j] = Q[j][k];
+    vpMatrix &J = eJe[(size_t)k];
+    J.resize(6, 4, false);
+    compute_eJe(q, J);
+  }
+}
+
+/*!
+  Fill the 6 by 4 matrix \e eJe with the robot jacobian expressed in the
+  end-effector frame. See get_eJe().
+*/
+void
+vpAfma4::compute_eJe(const double *q, vpMatrix &eJe) const
 {
   double            q4 = q[2]; // pan
   double            q5 = q[3]; // tilt
@@ -418,8 +534,6 @@ vpAfma4::get_eJe(const vpColVector &q, vpMatrix &eJe) const
   double            c5 = cos(q5);
   double            s5 = sin(q5);
 
-  eJe.resize(6, 4);
-
   eJe = 0;
 
   eJe[0][0] = -(this->_a1*c4 + this->_d3*s4)*c5;  eJe[0][1] = -s5;
@@ -465,7 +579,49 @@ void
 vpAfma4::get_fJe(const vpColVector &q, vpMatrix &fJe) const
 {
   fJe.resize(6,4) ;
+  compute_fJe(q.data, fJe);
+}
+
+/*!
+
+  Get the robot jacobian expressed in the robot reference frame for a batch
+  of joint positions.
+
+  \param Q : A \f$4 \times N\f$ matrix whose column \e k contains the four
+  joint positions of configuration \e k.
+
+  \param fJe : The \e N robot jacobians expressed in the robot reference
+  frame. The vector is only resized if it does not contain \e N elements.
 
+  \sa get_fJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpAfma4::get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma4ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[4];
+    for (unsigned int j=0; j<4; j++)
+      q[j] = Q[j][k];
+    vpMatrix &J = fJe[(size_t)k];
+    J.resize(6, 4, false);
+    compute_fJe(q, J);
+  }
+}
+
+/*!
+  Fill the 6 by 4 matrix \e fJe with the robot jacobian expressed in the
+  robot reference frame. See get_fJe().
+*/
+void
+vpAfma4::compute_fJe(const double *q, vpMatrix &fJe) const
+{
   double q1 = q[0]; // rot touret
   double q4 = q[2]; // pan
 
@@ -106,6 +106,73 @@ const vpAfma6::vpAfma6ToolType vpAfma6::defaultTool = TOOL_CCMOP;
 
 const unsigned int vpAfma6::njoint = 6;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  /* Under this number of configurations, batched kinematics is computed by the calling thread. */
+  const int afma6ParallelCount = 32;
+
+  /*
+    Distance on the three rotations between the current joint positions q and
+    each solution of the inverse kinematics.
+  */
+  void afma6SolutionDistances(const double *q, const double q_[2][6], double d[2])
+  {
+    for (int j=0;j<2;j++)
+    {
+      d[j] = 0.0;
+      for (unsigned int i=3;i<6;i++)
+        d[j] += (q_[j][i] - q[i]) * (q_[j][i] - q[i]);
+    }
+  }
+
+  /*
+    Select among the valid solutions of the inverse kinematics the nearest
+    (or the farest) from the current joint positions q. Return the number of
+    valid solutions.
+  */
+  int selectAfma6Solution(const double *q, const double q_[2][6], const bool ok[2], bool nearest, int &sol)
+  {
+    sol = 0;
+    if (ok[0] == false) {
+      if (ok[1] == false)
+        return 0;
+      sol = 1;
+      return 1;
+    }
+    if (ok[1] == false)
+      return 1;
+
+    double d[2];
+    afma6SolutionDistances(q, q_, d);
+    if (nearest == true)
+      sol = (d[0] <= d[1]) ? 0 : 1;
+    else
+      sol = (d[0] <= d[1]) ? 1 : 0;
+    return 2;
+  }
+
+  /* C = A * B without temporary allocation. */
+  void multiplyHomogeneous(const vpHomogeneousMatrix &A, const vpHomogeneousMatrix &B, vpHomogeneousMatrix &C)
+  {
+    for (unsigned int i=0; i<3; i++) {
+      for (unsigned int j=0; j<4; j++) {
+        C[i][j] = A[i][0]*B[0][j] + A[i][1]*B[1][j] + A[i][2]*B[2][j];
+      }
+      C[i][3] += A[i][3];
+    }
+  }
+
+  void checkJointMatrix(const vpMatrix &Q)
+  {
+    if (Q.getRows() != 6) {
+      throw vpException(vpException::dimensionError,
+                        "The joint positions matrix should have 6 rows, not %d", Q.getRows());
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 
   Default constructor.
@@ -542,31 +609,163 @@ int
 vpAfma6::getInverseKinematics(const vpHomogeneousMatrix & fMc,
                               vpColVector & q, const bool &nearest, const bool &verbose) const
 {
-  vpHomogeneousMatrix fMe;
-  double q_[2][6],d[2],t;
-  int ok[2];
-  double cord[6];
-
-  int nbsol = 0;
+  double q_[2][6];
+  bool ok[2];
 
   if (q.getRows() != njoint)
     q.resize(6);
 
+  vpHomogeneousMatrix fMe = fMc * this->_eMc.inverse();
+  computeInverseKinematics(fMe, q.data, q_, ok, verbose);
+
+  int sol;
+  int nbsol = selectAfma6Solution(q.data, q_, ok, nearest, sol);
+  if (nbsol == 0) {
+    std::cout << "No solution..." << std::endl;
+    return nbsol;
+  }
+  for(unsigned int i=0; i<6; i++)
+    q[i] = q_[sol][i] ;
+
+  return nbsol;
+}
+
+/*!
+
+  Compute the inverse kinematics for a batch of camera poses, keeping for each
+  pose the solution selected as
+  getInverseKinematics(const vpHomogeneousMatrix &, vpColVector &, const bool &, const bool &) does.
+
+  \param fMc : Poses \f$^f{\bf M}_c \f$ of the camera frame in the base frame.
 
-  //   for(unsigned int i=0;i<3;i++) {
-  //     fMe[i][3] = fMc[i][3];
-  //     for(int j=0;j<3;j++) {
-  //       fMe[i][j] = 0.0;
-  //       for (int k=0;k<3;k++) fMe[i][j] += fMc[i][k]*rpi[j][k];
-  //       fMe[i][3] -= fMe[i][j]*rpi[j][3];
-  //     }
-  //   }
+  \param Q : In input, a \f$6 \times N\f$ matrix whose column \e k contains
+  the current joint positions for pose \e k. In output, column \e k contains
+  the selected solution, or is unchanged if there is no solution.
 
-  //   std::cout << "\n\nfMc: " << fMc;
-  //   std::cout << "\n\neMc: " << _eMc;
+  \param nbSol : Number of solutions (0, 1 or 2) of the inverse kinematics
+  for each pose.
 
-  fMe = fMc * this->_eMc.inverse();
-  //   std::cout << "\n\nfMe: " << fMe;
+  \param nearest : true to return the nearest solution to the current joint
+  positions. false to return the farest.
+
+  \param verbose : Activates printings when a joint is out of its limits.
+
+  \sa getInverseKinematicsSolutions()
+*/
+void
+vpAfma6::getInverseKinematics(const std::vector<vpHomogeneousMatrix> & fMc, vpMatrix & Q,
+                              std::vector<int> & nbSol, const bool &nearest, const bool &verbose) const
+{
+  checkJointMatrix(Q);
+  if (Q.getCols() != fMc.size()) {
+    throw vpException(vpException::dimensionError,
+                      "The number of joint positions (%d) differs from the number of poses (%d)",
+                      Q.getCols(), (int)fMc.size());
+  }
+  vpHomogeneousMatrix cMe = this->_eMc.inverse();
+  nbSol.resize(fMc.size());
+
+  int n = (int)fMc.size();
+  unsigned int ncols = Q.getCols();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (n >= afma6ParallelCount)
+#endif
+  {
+    vpHomogeneousMatrix fMe;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int k = 0; k < n; k++) {
+      double q[6], q_[2][6];
+      bool ok[2];
+      for (unsigned int j=0; j<6; j++)
+        q[j] = Q[j][k];
+      multiplyHomogeneous(fMc[(size_t)k], cMe, fMe);
+      computeInverseKinematics(fMe, q, q_, ok, verbose);
+      int sol;
+      nbSol[(size_t)k] = selectAfma6Solution(q, q_, ok, nearest, sol);
+      if (nbSol[(size_t)k]) {
+        for (unsigned int j=0; j<6; j++)
+          Q.data[j*ncols + (unsigned int)k] = q_[sol][j];
+      }
+    }
+  }
+}
+
+/*!
+
+  Compute all the solutions of the inverse kinematics for a batch of camera
+  poses.
+
+  \param fMc : Poses \f$^f{\bf M}_c \f$ of the camera frame in the base frame.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the joint
+  positions used to sort the solutions of pose \e k. These positions are also
+  used in singular configurations, where joint 4 keeps its value.
+
+  \param solutions : For each pose, a \f$6 \times n\f$ matrix whose columns
+  are the \e n solutions (0 to 2) that respect the joint limits, the nearest
+  from the joint positions in \e Q first.
+
+  \param verbose : Activates printings when a joint is out of its limits.
+*/
+void
+vpAfma6::getInverseKinematicsSolutions(const std::vector<vpHomogeneousMatrix> & fMc, const vpMatrix & Q,
+                                       std::vector<vpMatrix> & solutions, const bool &verbose) const
+{
+  checkJointMatrix(Q);
+  if (Q.getCols() != fMc.size()) {
+    throw vpException(vpException::dimensionError,
+                      "The number of joint positions (%d) differs from the number of poses (%d)",
+                      Q.getCols(), (int)fMc.size());
+  }
+  vpHomogeneousMatrix cMe = this->_eMc.inverse();
+  solutions.resize(fMc.size());
+
+  int n = (int)fMc.size();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (n >= afma6ParallelCount)
+#endif
+  {
+    vpHomogeneousMatrix fMe;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int k = 0; k < n; k++) {
+      double q[6], q_[2][6];
+      bool ok[2];
+      for (unsigned int j=0; j<6; j++)
+        q[j] = Q[j][k];
+      multiplyHomogeneous(fMc[(size_t)k], cMe, fMe);
+      computeInverseKinematics(fMe, q, q_, ok, verbose);
+
+      int first;
+      int nbsol = selectAfma6Solution(q, q_, ok, true, first);
+      vpMatrix &S = solutions[(size_t)k];
+      S.resize(6, (unsigned int)nbsol, false);
+      for (int i=0; i<nbsol; i++)
+        for (unsigned int j=0; j<6; j++)
+          S[j][(unsigned int)i] = q_[(first + i) % 2][j];
+    }
+  }
+}
+
+/*!
+
+  Compute the two solutions of the inverse kinematics from the pose of the
+  end-effector frame \e fMe, and check if they respect the joint limits.
+
+  \param fMe : Pose of the end-effector frame in the base frame.
+  \param q : Current joint positions, used in singular configurations.
+  \param q_ : The two solutions.
+  \param ok : true if the corresponding solution respects the joint limits.
+  \param verbose : Activates printings when a joint is out of its limits.
+*/
+void
+vpAfma6::computeInverseKinematics(const vpHomogeneousMatrix & fMe, const double *q, double q_[2][6],
+                                  bool ok[2], const bool &verbose) const
+{
+  double t;
 
   if (fMe[2][2] >= .99999f)
   {
@@ -633,7 +832,7 @@ vpAfma6::getInverseKinematics(const vpHomogeneousMatrix & fMc,
 
   for (int j=0;j<2;j++)
   {
-    ok[j] = 1;
+    ok[j] = true;
     // test is position is reachable
     for (unsigned int i=0;i<6;i++) {
       if (q_[j][i] < this->_joint_min[i] || q_[j][i] > this->_joint_max[i]) {
@@ -643,58 +842,10 @@ vpAfma6::getInverseKinematics(const vpHomogeneousMatrix & fMc,
           else
             std::cout << "Joint " << i << " not in limits: " << vpMath::deg(this->_joint_min[i]) << " < " << vpMath::deg(q_[j][i]) << " < " << vpMath::deg(this->_joint_max[i]) << std::endl;
         }
-        ok[j] = 0;
-      }
-    }
-  }
-  if (ok[0] == 0)
-  {
-    if (ok[1] == 0) {
-      std::cout << "No solution..." << std::endl;
-      nbsol = 0;
-      return nbsol;
-    }
-    else if (ok[1] == 1) {
-      for (unsigned int i=0;i<6;i++) cord[i] = q_[1][i];
-      nbsol = 1;
-    }
-  }
-  else
-  {
-    if (ok[1] == 0) {
-      for (unsigned int i=0;i<6;i++) cord[i] = q_[0][i];
-      nbsol = 1;
-    }
-    else
-    {
-      nbsol = 2;
-      //vpTRACE("2 solutions\n");
-      for (int j=0;j<2;j++)
-      {
-        d[j] = 0.0;
-        for (unsigned int i=3;i<6;i++)
-          d[j] += (q_[j][i] - q[i]) * (q_[j][i] - q[i]);
-      }
-      if (nearest == true)
-      {
-        if (d[0] <= d[1])
-          for (unsigned int i=0;i<6;i++) cord[i] = q_[0][i];
-        else
-          for (unsigned int i=0;i<6;i++) cord[i] = q_[1][i];
-      }
-      else
-      {
-        if (d[0] <= d[1])
-          for (unsigned int i=0;i<6;i++) cord[i] = q_[1][i];
-        else
-          for (unsigned int i=0;i<6;i++) cord[i] = q_[0][i];
+        ok[j] = false;
       }
     }
   }
-  for(unsigned int i=0; i<6; i++)
-    q[i] = cord[i] ;
-
-  return nbsol;
 }
 
 /*!
@@ -762,6 +913,46 @@ vpAfma6::get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const
   return;
 }
 
+/*!
+
+  Compute the forward kinematics (direct geometric model) for a batch of
+  joint positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k: the first 3 translations expressed in
+  meter, then the 3 rotations expressed in radians.
+
+  \param fMc : The \e N homogeneous matrices \f$^f{\bf M}_c \f$. The vector
+  is only resized if it does not contain \e N elements.
+
+  \sa get_fMc(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void
+vpAfma6::get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fMc.resize((size_t)n);
+
+  const vpHomogeneousMatrix &eMc = this->_eMc;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma6ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6], R[9], t[3];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    compute_fMe(q, R, t);
+
+    vpHomogeneousMatrix &M = fMc[(size_t)k];
+    for (unsigned int i=0; i<3; i++) {
+      for (unsigned int j=0; j<4; j++)
+        M[i][j] = R[3*i]*eMc[0][j] + R[3*i+1]*eMc[1][j] + R[3*i+2]*eMc[2][j];
+      M[i][3] += t[i];
+    }
+  }
+}
+
 /*!
 
   Compute the forward kinematics (direct geometric model) as an
@@ -783,6 +974,34 @@ vpAfma6::get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const
 */
 void
 vpAfma6::get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const
+{
+  double R[9], t[3];
+  compute_fMe(q.data, R, t);
+
+  for (unsigned int i=0; i<3; i++) {
+    for (unsigned int j=0; j<3; j++)
+      fMe[i][j] = R[3*i+j];
+    fMe[i][3] = t[i];
+  }
+
+  fMe[3][0] = 0;
+  fMe[3][1] = 0;
+  fMe[3][2] = 0;
+  fMe[3][3] = 1;
+
+  //  vpCTRACE << "Effector position fMe: " << std::endl << fMe;
+
+  return;
+}
+
+/*!
+
+  Compute the rotation \e fRe, stored row after row, and the translation
+  \e fte of the end-effector frame in the base frame from the joint positions
+  \e q. See get_fMe().
+*/
+void
+vpAfma6::compute_fMe(const double *q, double fRe[9], double fte[3]) const
 {
   double            q0 = q[0]; // meter
   double            q1 = q[1]; // meter
@@ -800,29 +1019,20 @@ vpAfma6::get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const
 
   // Compute the direct geometric model: fMe = transformation betwee
   // fix and end effector frame.
-  fMe[0][0] = s1*s2*c3 + c1*s3;
-  fMe[0][1] = -s1*s2*s3 + c1*c3;
-  fMe[0][2] = -s1*c2;
-  fMe[0][3] = q0 + this->_long_56*c1;
-
-  fMe[1][0] = -c1*s2*c3 + s1*s3;
-  fMe[1][1] = c1*s2*s3 + s1*c3;
-  fMe[1][2] = c1*c2;
-  fMe[1][3] = q1 + this->_long_56*s1;
-
-  fMe[2][0] = c2*c3;
-  fMe[2][1] = -c2*s3;
-  fMe[2][2] = s2;
-  fMe[2][3] = q2;
-
-  fMe[3][0] = 0;
-  fMe[3][1] = 0;
-  fMe[3][2] = 0;
-  fMe[3][3] = 1;
-
-  //  vpCTRACE << "Effector position fMe: " << std::endl << fMe;
-
-  return;
+  fRe[0] = s1*s2*c3 + c1*s3;
+  fRe[1] = -s1*s2*s3 + c1*c3;
+  fRe[2] = -s1*c2;
+  fte[0] = q0 + this->_long_56*c1;
+
+  fRe[3] = -c1*s2*c3 + s1*s3;
+  fRe[4] = c1*s2*s3 + s1*c3;
+  fRe[5] = c1*c2;
+  fte[1] = q1 + this->_long_56*s1;
+
+  fRe[6] = c2*c3;
+  fRe[7] = -c2*s3;
+  fRe[8] = s2;
+  fte[2] = q2;
 }
 
 /*!
@@ -893,7 +1103,51 @@ vpAfma6::get_eJe(const vpColVector &q, vpMatrix &eJe) const
 {
 
   eJe.resize(6,6) ;
+  compute_eJe(q.data, eJe);
 
+  return;
+}
+
+/*!
+
+  Get the robot jacobian expressed in the end-effector frame for a batch of
+  joint positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k.
+
+  \param eJe : The \e N robot jacobians expressed in the end-effector frame.
+  The vector is only resized if it does not contain \e N elements.
+
+  \sa get_eJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpAfma6::get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  eJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma6ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    vpMatrix &J = eJe[(size_t)k];
+    J.resize(6, 6, false);
+    compute_eJe(q, J);
+  }
+}
+
+/*!
+  Fill the 6 by 6 matrix \e eJe with the robot jacobian expressed in the
+  end-effector frame. See get_eJe().
+*/
+void
+vpAfma6::compute_eJe(const double *q, vpMatrix &eJe) const
+{
   double s4,c4,s5,c5,s6,c6 ;
 
   s4=sin(q[3]); c4=cos(q[3]);
@@ -925,8 +1179,6 @@ vpAfma6::get_eJe(const vpColVector &q, vpMatrix &eJe) const
   eJe[5][3] = s5;
   eJe[5][4] = -this->_coupl_56;
   eJe[5][5] = 1;
-
-  return;
 }
 
 
@@ -962,6 +1214,52 @@ vpAfma6::get_fJe(const vpColVector &q, vpMatrix &fJe) const
 {
 
   fJe.resize(6,6) ;
+  compute_fJe(q.data, fJe);
+
+  return;
+}
+
+/*!
+
+  Get the robot jacobian expressed in the robot reference frame for a batch
+  of joint positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k.
+
+  \param fJe : The \e N robot jacobians expressed in the robot reference
+  frame. The vector is only resized if it does not contain \e N elements.
+
+  \sa get_fJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpAfma6::get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= afma6ParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    vpMatrix &J = fJe[(size_t)k];
+    J.resize(6, 6, false);
+    compute_fJe(q, J);
+  }
+}
+
+/*!
+  Fill the 6 by 6 matrix \e fJe with the robot jacobian expressed in the
+  robot reference frame. See get_fJe().
+*/
+void
+vpAfma6::compute_fJe(const double *q, vpMatrix &fJe) const
+{
+  fJe = 0;
 
   // block superieur gauche
   fJe[0][0] = fJe[1][1] = fJe[2][2] = 1 ;
@@ -986,8 +1284,6 @@ vpAfma6::get_fJe(const vpColVector &q, vpMatrix &fJe) const
   fJe[3][4] += this->_coupl_56*s4*c5;
   fJe[4][4] += -this->_coupl_56*c4*c5;
   fJe[5][4] += -this->_coupl_56*s5;
-
-  return;
 }
 
 
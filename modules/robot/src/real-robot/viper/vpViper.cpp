@@ -58,6 +58,86 @@
 
 const unsigned int vpViper::njoint = 6;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  /* Under this number of configurations, batched kinematics is computed by the calling thread. */
+  const int viperParallelCount = 32;
+
+  /*
+    Weighted distance between the current joint positions q and each valid
+    solution of the inverse kinematics, taking the 2 pi periodicity into account.
+  */
+  void viperSolutionDistances(const double *q, const double q_sol[8][6], const bool ok[8], double dist[8])
+  {
+    const double weight[6] = { 8., 4., 4., 1., 1., 1. };
+    for (unsigned int i=0; i<8; i++) {
+      dist[i] = 0;
+      if (ok[i] == true) {
+        for (unsigned int j=0; j< 6; j++) {
+          double rought_dist = q[j]- q_sol[i][j];
+          double modulo_dist = rought_dist;
+          if (rought_dist > 0) {
+            if (fabs(rought_dist - 2*M_PI) < fabs(rought_dist))
+              modulo_dist = rought_dist - 2*M_PI;
+          }
+          else {
+            if (fabs(rought_dist + 2*M_PI) < fabs(rought_dist))
+              modulo_dist = rought_dist + 2*M_PI;
+          }
+          dist[i] += weight[j]*vpMath::sqr(modulo_dist);
+        }
+      }
+    }
+  }
+
+  /*
+    Select the valid solution of the inverse kinematics the nearest from the
+    current joint positions q. Return the number of valid solutions.
+  */
+  unsigned int nearestViperSolution(const double *q, const double q_sol[8][6], const bool ok[8], unsigned int &sol)
+  {
+    double dist[8];
+    viperSolutionDistances(q, q_sol, ok, dist);
+
+    unsigned int nbsol = 0;
+    sol = 0;
+    for (unsigned int i=0; i<8; i++) {
+      if (ok[i] == true) {
+        nbsol ++;
+        sol = i;
+      }
+    }
+    if (nbsol) {
+      for (unsigned int i=0; i<8; i++) {
+        if (ok[i] == true)
+          if (dist[i] < dist[sol]) sol = i;
+      }
+    }
+    return nbsol;
+  }
+
+  /* C = A * B without temporary allocation. */
+  void multiplyHomogeneous(const vpHomogeneousMatrix &A, const vpHomogeneousMatrix &B, vpHomogeneousMatrix &C)
+  {
+    for (unsigned int i=0; i<3; i++) {
+      for (unsigned int j=0; j<4; j++) {
+        C[i][j] = A[i][0]*B[0][j] + A[i][1]*B[1][j] + A[i][2]*B[2][j];
+      }
+      C[i][3] += A[i][3];
+    }
+  }
+
+  void checkJointMatrix(const vpMatrix &Q)
+  {
+    if (Q.getRows() != 6) {
+      throw vpException(vpException::dimensionError,
+                        "The joint positions matrix should have 6 rows, not %d", Q.getRows());
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 
   Default constructor.
@@ -228,10 +308,41 @@ vpViper::convertJointPositionInLimits(unsigned int joint, const double &q, doubl
 unsigned int
 vpViper::getInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, vpColVector & q, const bool &verbose) const
 {
-  vpColVector q_sol[8];
+  double q_sol[8][6];
+  bool ok[8];
+
+  if (q.getRows() != njoint)
+    q.resize(6);
+
+  computeInverseKinematicsWrist(fMw, q.data, q_sol, ok, verbose);
+
+  unsigned int sol;
+  unsigned int nbsol = nearestViperSolution(q.data, q_sol, ok, sol);
+  if (nbsol) {
+    // Update the inverse kinematics solution
+    for (unsigned int j=0; j<6; j++)
+      q[j] = q_sol[sol][j];
+  }
+  return nbsol;
+}
+
+/*!
+  Compute the 8 solutions of the inverse kinematics from the pose of the
+  wrist. This is the core of getInverseKinematicsWrist().
 
+  \param fMw : Pose of the wrist frame in the reference frame.
+  \param q : Current joint positions, used in singular configurations.
+  \param q_sol : The 8 solutions.
+  \param ok : ok[i] is true if the solution \e i is in the joint limits.
+  \param verbose : Add extra printings.
+*/
+void
+vpViper::computeInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, const double *q, double q_sol[8][6],
+                                       bool ok[8], const bool &verbose) const
+{
   for (unsigned int i=0; i<8; i++)
-    q_sol[i].resize(6);
+    for (unsigned int j=0; j<6; j++)
+      q_sol[i][j] = 0.0;
 
   double c1[8]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
   double s1[8]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
@@ -246,11 +357,6 @@ vpViper::getInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, vpColVector
   double c6[8]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
   double s6[8]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
 
-  bool ok[8];
-
-  if (q.getRows() != njoint)
-    q.resize(6);
-
   for (unsigned int i=0; i< 8; i++)
     ok[i] = true;
 
@@ -472,52 +578,6 @@ vpViper::getInverseKinematicsWrist(const vpHomogeneousMatrix & fMw, vpColVector
       ok[i] = false;
     }
   }
-
-  // Select the best config in terms of distance from the current position
-  unsigned int nbsol = 0;
-  unsigned int sol = 0;
-  vpColVector dist(8);
-  for (unsigned int i=0; i<8; i++) {
-    if (ok[i] == true) {
-      nbsol ++;
-      sol = i;
-      //      dist[i] = vpColVector::distance(q, q_sol[i]);
-      vpColVector weight(6);
-      weight = 1;
-      weight[0] = 8;
-      weight[1] = weight[2] = 4;
-      dist[i] = 0;
-      for (unsigned int j=0; j< 6; j++) {
-        double rought_dist = q[j]- q_sol[i][j];
-        double modulo_dist = rought_dist;
-        if (rought_dist > 0) {
-          if (fabs(rought_dist - 2*M_PI) < fabs(rought_dist))
-            modulo_dist = rought_dist - 2*M_PI;
-        }
-        else {
-          if (fabs(rought_dist + 2*M_PI) < fabs(rought_dist))
-            modulo_dist = rought_dist + 2*M_PI;
-        }
-        //std::cout << "dist " << i << ": " << rought_dist << " modulo: " << modulo_dist << std::endl;
-        dist[i] += weight[j]*vpMath::sqr(modulo_dist);
-      }
-    }
-    //  std::cout << "sol " << i << " [" << ok[i] << "] dist: " << dist[i] << " q: " << q_sol[i].t() << std::endl;
-  }
-  //std::cout << "dist: " << dist.t() << std::endl;
-  if (nbsol) {
-    for (unsigned int i=0; i<8; i++) {
-      if (ok[i] == true)
-        if (dist[i] < dist[sol]) sol = i;
-    }
-    // Update the inverse kinematics solution
-    q = q_sol[sol];
-
-    //     std::cout << "Nearest solution (" << sol << ") with distance ("
-    // 	      << dist[sol] << "): " << q_sol[sol].t() << std::endl;
-  }
-  return nbsol;
-
 }
 
 /*!
@@ -587,6 +647,143 @@ vpViper::getInverseKinematics(const vpHomogeneousMatrix & fMc, vpColVector & q,
   return (getInverseKinematicsWrist(fMw, q, verbose));
 }
 
+/*!
+
+  Compute the inverse kinematics for a batch of camera poses, keeping for each
+  pose the solution the nearest from a given joint position, as
+  getInverseKinematics(const vpHomogeneousMatrix &, vpColVector &, const bool &) does.
+
+  \param fMc : Poses \f$^f{\bf M}_c \f$ of the camera frame in the base frame.
+
+  \param Q : In input, a \f$6 \times N\f$ matrix whose column \e k contains
+  the joint positions the nearest solution for pose \e k is searched from. In
+  output, column \e k contains this solution, or is unchanged if there is no
+  solution.
+
+  \param nbSol : Number of solutions (0 to 8) of the inverse kinematics for
+  each pose.
+
+  \param verbose : Add extra printings.
+
+  \sa getInverseKinematicsSolutions()
+*/
+void
+vpViper::getInverseKinematics(const std::vector<vpHomogeneousMatrix> & fMc, vpMatrix & Q,
+                              std::vector<unsigned int> & nbSol, const bool &verbose) const
+{
+  checkJointMatrix(Q);
+  if (Q.getCols() != fMc.size()) {
+    throw vpException(vpException::dimensionError,
+                      "The number of joint positions (%d) differs from the number of poses (%d)",
+                      Q.getCols(), (int)fMc.size());
+  }
+  vpHomogeneousMatrix wMe;
+  get_wMe(wMe);
+  vpHomogeneousMatrix cMw = (wMe * this->eMc).inverse();
+  nbSol.resize(fMc.size());
+
+  int n = (int)fMc.size();
+  unsigned int ncols = Q.getCols();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (n >= viperParallelCount)
+#endif
+  {
+    vpHomogeneousMatrix fMw;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int k = 0; k < n; k++) {
+      double q[6], q_sol[8][6];
+      bool ok[8];
+      for (unsigned int j=0; j<6; j++)
+        q[j] = Q[j][k];
+      multiplyHomogeneous(fMc[(size_t)k], cMw, fMw);
+      computeInverseKinematicsWrist(fMw, q, q_sol, ok, verbose);
+      unsigned int sol;
+      nbSol[(size_t)k] = nearestViperSolution(q, q_sol, ok, sol);
+      if (nbSol[(size_t)k]) {
+        for (unsigned int j=0; j<6; j++)
+          Q.data[j*ncols + (unsigned int)k] = q_sol[sol][j];
+      }
+    }
+  }
+}
+
+/*!
+
+  Compute all the solutions of the inverse kinematics for a batch of camera
+  poses.
+
+  \param fMc : Poses \f$^f{\bf M}_c \f$ of the camera frame in the base frame.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the joint
+  positions used to sort the solutions of pose \e k. These positions are also
+  used in singular configurations, where joint 1 or joint 4 keep their value.
+
+  \param solutions : For each pose, a \f$6 \times n\f$ matrix whose columns
+  are the \e n solutions (0 to 8) that respect the joint limits, sorted by
+  increasing distance to the joint positions in \e Q. The first column is thus
+  the solution returned by getInverseKinematics().
+
+  \param verbose : Add extra printings.
+*/
+void
+vpViper::getInverseKinematicsSolutions(const std::vector<vpHomogeneousMatrix> & fMc, const vpMatrix & Q,
+                                       std::vector<vpMatrix> & solutions, const bool &verbose) const
+{
+  checkJointMatrix(Q);
+  if (Q.getCols() != fMc.size()) {
+    throw vpException(vpException::dimensionError,
+                      "The number of joint positions (%d) differs from the number of poses (%d)",
+                      Q.getCols(), (int)fMc.size());
+  }
+  vpHomogeneousMatrix wMe;
+  get_wMe(wMe);
+  vpHomogeneousMatrix cMw = (wMe * this->eMc).inverse();
+  solutions.resize(fMc.size());
+
+  int n = (int)fMc.size();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel if (n >= viperParallelCount)
+#endif
+  {
+    vpHomogeneousMatrix fMw;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int k = 0; k < n; k++) {
+      double q[6], q_sol[8][6], dist[8];
+      bool ok[8];
+      for (unsigned int j=0; j<6; j++)
+        q[j] = Q[j][k];
+      multiplyHomogeneous(fMc[(size_t)k], cMw, fMw);
+      computeInverseKinematicsWrist(fMw, q, q_sol, ok, verbose);
+      viperSolutionDistances(q, q_sol, ok, dist);
+
+      // Sort the valid solutions by increasing distance
+      unsigned int order[8];
+      unsigned int nbsol = 0;
+      for (unsigned int i=0; i<8; i++) {
+        if (ok[i] == false)
+          continue;
+        unsigned int pos = nbsol;
+        while (pos > 0 && dist[order[pos-1]] > dist[i]) {
+          order[pos] = order[pos-1];
+          pos--;
+        }
+        order[pos] = i;
+        nbsol++;
+      }
+
+      vpMatrix &S = solutions[(size_t)k];
+      S.resize(6, nbsol, false);
+      for (unsigned int i=0; i<nbsol; i++)
+        for (unsigned int j=0; j<6; j++)
+          S[j][i] = q_sol[order[i]][j];
+    }
+  }
+}
+
 /*!
 
   Compute the forward kinematics (direct geometric model) as an
@@ -657,6 +854,54 @@ vpViper::get_fMc(const vpColVector & q, vpHomogeneousMatrix & fMc) const
   return;
 }
 
+/*!
+
+  Compute the forward kinematics for a batch of joint positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k expressed in radians.
+
+  \param fMc : The \e N homogeneous matrices \f$^f{\bf M}_c\f$ corresponding
+  to the direct geometric model of each configuration. The vector is only
+  resized if it does not contain \e N elements.
+
+  \sa get_fMc(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void
+vpViper::get_fMc(const vpMatrix & Q, std::vector<vpHomogeneousMatrix> & fMc) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fMc.resize((size_t)n);
+
+  // The end-effector is at distance d6 from the wrist along its z axis
+  double eRc[3][3], etc_[3];
+  for (unsigned int i=0; i<3; i++) {
+    for (unsigned int j=0; j<3; j++)
+      eRc[i][j] = this->eMc[i][j];
+    etc_[i] = this->eMc[i][3];
+  }
+  etc_[2] += d6;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= viperParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6], R[9], t[3];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    compute_fMw(q, R, t);
+
+    vpHomogeneousMatrix &M = fMc[(size_t)k];
+    for (unsigned int i=0; i<3; i++) {
+      const double *r = R + 3*i;
+      for (unsigned int j=0; j<3; j++)
+        M[i][j] = r[0]*eRc[0][j] + r[1]*eRc[1][j] + r[2]*eRc[2][j];
+      M[i][3] = r[0]*etc_[0] + r[1]*etc_[1] + r[2]*etc_[2] + t[i];
+    }
+  }
+}
+
 /*!
 
   Compute the forward kinematics (direct geometric model) as an
@@ -827,6 +1072,26 @@ vpViper::get_fMe(const vpColVector & q, vpHomogeneousMatrix & fMe) const
 */
 void
 vpViper::get_fMw(const vpColVector & q, vpHomogeneousMatrix & fMw) const
+{
+  double R[9], t[3];
+  compute_fMw(q.data, R, t);
+  for (unsigned int i=0; i<3; i++) {
+    for (unsigned int j=0; j<3; j++)
+      fMw[i][j] = R[3*i+j];
+    fMw[i][3] = t[i];
+  }
+
+  //std::cout << "Wrist position fMw: " << std::endl << fMw;
+
+  return;
+}
+
+/*!
+  Compute the rotation and the translation of the wrist frame in the fix
+  frame from the six joint positions \e q. See get_fMw().
+*/
+void
+vpViper::compute_fMw(const double *q, double fRw[9], double ftw[3]) const
 {
   double q1 = q[0];
   double q2 = q[1];
@@ -839,17 +1104,10 @@ vpViper::get_fMw(const vpColVector & q, vpHomogeneousMatrix & fMw) const
   //  if positions are motor position.
   // double q6 = q[5] + c56 * q[4];
 
-//   std::cout << "q6 motor: " << q[5] << " rad " 
-// 	    << vpMath::deg(q[5]) << " deg" << std::endl;
-//   std::cout << "q6 joint: " << q6 << " rad " 
-// 	    << vpMath::deg(q6) << " deg" << std::endl;
-
   double c1 = cos(q1);
   double s1 = sin(q1);
   double c2 = cos(q2);
   double s2 = sin(q2);
-  //  double c3 = cos(q3);
-  //double s3 = sin(q3);
   double c4 = cos(q4);
   double s4 = sin(q4);
   double c5 = cos(q5);
@@ -859,25 +1117,21 @@ vpViper::get_fMw(const vpColVector & q, vpHomogeneousMatrix & fMw) const
   double c23 = cos(q2+q3);
   double s23 = sin(q2+q3);
 
-  fMw[0][0] = c1*(c23*(c4*c5*c6-s4*s6)-s23*s5*c6)-s1*(s4*c5*c6+c4*s6);
-  fMw[1][0] = -s1*(c23*(-c4*c5*c6+s4*s6)+s23*s5*c6)+c1*(s4*c5*c6+c4*s6);
-  fMw[2][0] = s23*(s4*s6-c4*c5*c6)-c23*s5*c6;
+  fRw[0] = c1*(c23*(c4*c5*c6-s4*s6)-s23*s5*c6)-s1*(s4*c5*c6+c4*s6);
+  fRw[3] = -s1*(c23*(-c4*c5*c6+s4*s6)+s23*s5*c6)+c1*(s4*c5*c6+c4*s6);
+  fRw[6] = s23*(s4*s6-c4*c5*c6)-c23*s5*c6;
 
-  fMw[0][1] = -c1*(c23*(c4*c5*s6+s4*c6)-s23*s5*s6)+s1*(s4*c5*s6-c4*c6);
-  fMw[1][1] = -s1*(c23*(c4*c5*s6+s4*c6)-s23*s5*s6)-c1*(s4*c5*s6-c4*c6);
-  fMw[2][1] = s23*(c4*c5*s6+s4*c6)+c23*s5*s6;
+  fRw[1] = -c1*(c23*(c4*c5*s6+s4*c6)-s23*s5*s6)+s1*(s4*c5*s6-c4*c6);
+  fRw[4] = -s1*(c23*(c4*c5*s6+s4*c6)-s23*s5*s6)-c1*(s4*c5*s6-c4*c6);
+  fRw[7] = s23*(c4*c5*s6+s4*c6)+c23*s5*s6;
 
-  fMw[0][2] = c1*(c23*c4*s5+s23*c5)-s1*s4*s5;
-  fMw[1][2] = s1*(c23*c4*s5+s23*c5)+c1*s4*s5;
-  fMw[2][2] = -s23*c4*s5+c23*c5;
+  fRw[2] = c1*(c23*c4*s5+s23*c5)-s1*s4*s5;
+  fRw[5] = s1*(c23*c4*s5+s23*c5)+c1*s4*s5;
+  fRw[8] = -s23*c4*s5+c23*c5;
 
-  fMw[0][3] = c1*(-c23*a3+s23*d4+a1+a2*c2);
-  fMw[1][3] = s1*(-c23*a3+s23*d4+a1+a2*c2);
-  fMw[2][3] = s23*a3+c23*d4-a2*s2+d1;
-
-  //std::cout << "Wrist position fMw: " << std::endl << fMw;
-
-  return;
+  ftw[0] = c1*(-c23*a3+s23*d4+a1+a2*c2);
+  ftw[1] = s1*(-c23*a3+s23*d4+a1+a2*c2);
+  ftw[2] = s23*a3+c23*d4-a2*s2+d1;
 }
 
 /*!
@@ -1036,6 +1290,56 @@ vpViper::get_eJe(const vpColVector &q, vpMatrix &eJe) const
   return;
 }
 
+/*!
+
+  Compute the robot jacobian \f${^e}{\bf J}_e\f$ for a batch of joint
+  positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k expressed in radians.
+
+  \param eJe : The \e N robot jacobians \f${^e}{\bf J}_e\f$. The vector is
+  only resized if it does not contain \e N elements.
+
+  \sa get_eJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpViper::get_eJe(const vpMatrix &Q, std::vector<vpMatrix> &eJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  eJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= viperParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6], R[9], t[3], J[36];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    compute_fMw(q, R, t);
+    compute_fJw(q, J);
+
+    // wRf = fRw^T, and [etw]x wRf with etw = (0, 0, -d6) has rows d6 wRf[1], -d6 wRf[0] and 0
+    vpMatrix &M = eJe[(size_t)k];
+    M.resize(6, 6, false);
+    for (unsigned int j=0; j<6; j++) {
+      double v0 = R[0]*J[j]    + R[3]*J[6+j]  + R[6]*J[12+j];
+      double v1 = R[1]*J[j]    + R[4]*J[6+j]  + R[7]*J[12+j];
+      double v2 = R[2]*J[j]    + R[5]*J[6+j]  + R[8]*J[12+j];
+      double w0 = R[0]*J[18+j] + R[3]*J[24+j] + R[6]*J[30+j];
+      double w1 = R[1]*J[18+j] + R[4]*J[24+j] + R[7]*J[30+j];
+      double w2 = R[2]*J[18+j] + R[5]*J[24+j] + R[8]*J[30+j];
+      M[0][j] = v0 + d6*w1;
+      M[1][j] = v1 - d6*w0;
+      M[2][j] = v2;
+      M[3][j] = w0;
+      M[4][j] = w1;
+      M[5][j] = w2;
+    }
+  }
+}
+
 
 /*!
 
@@ -1086,6 +1390,25 @@ vpViper::get_eJe(const vpColVector &q, vpMatrix &eJe) const
 
 void
 vpViper::get_fJw(const vpColVector &q, vpMatrix &fJw) const
+{
+  double J[36];
+  compute_fJw(q.data, J);
+
+  fJw.resize(6,6, false) ;
+  for (unsigned int i=0;i<6;i++) {
+    for (unsigned int j=0;j<6;j++) {
+      fJw[i][j] = J[6*i+j];
+    }
+  }
+  return;
+}
+
+/*!
+  Compute the robot jacobian \f${^f}{\bf J}_w\f$ as a row major array from
+  the joint positions \e q. See get_fJw().
+*/
+void
+vpViper::compute_fJw(const double *q, double fJw[36]) const
 {
   double q1 = q[0];
   double q2 = q[1];
@@ -1106,66 +1429,51 @@ vpViper::get_fJw(const vpColVector &q, vpMatrix &fJw) const
   double c23 = cos(q2+q3);
   double s23 = sin(q2+q3);
 
-  vpColVector J1(6);
-  vpColVector J2(6);
-  vpColVector J3(6);
-  vpColVector J4(6);
-  vpColVector J5(6);
-  vpColVector J6(6);
-
   // Jacobian when d6 is set to zero
+  double *J1 = fJw, *J2 = fJw + 6, *J3 = fJw + 12, *J4 = fJw + 18, *J5 = fJw + 24, *J6 = fJw + 30;
+
+  // Row i of fJw is stored in Ji, column j corresponds to joint j+1
   J1[0] = -s1*(-c23*a3+s23*d4+a1+a2*c2);
-  J1[1] =  c1*(-c23*a3+s23*d4+a1+a2*c2);
-  J1[2] = 0;
-  J1[3] = 0;
-  J1[4] = 0;
-  J1[5] = 1;
+  J2[0] =  c1*(-c23*a3+s23*d4+a1+a2*c2);
+  J3[0] = 0;
+  J4[0] = 0;
+  J5[0] = 0;
+  J6[0] = 1;
 
-  J2[0] = c1*(s23*a3+c23*d4-a2*s2);
+  J1[1] = c1*(s23*a3+c23*d4-a2*s2);
   J2[1] = s1*(s23*a3+c23*d4-a2*s2);
-  J2[2] = c23*a3-s23*d4-a2*c2;
-  J2[3] = -s1;
-  J2[4] = c1;
-  J2[5] = 0;
+  J3[1] = c23*a3-s23*d4-a2*c2;
+  J4[1] = -s1;
+  J5[1] = c1;
+  J6[1] = 0;
 
-  J3[0] = c1*(a3*(s2*c3+c2*s3)+(-s2*s3+c2*c3)*d4);
-  J3[1] = s1*(a3*(s2*c3+c2*s3)+(-s2*s3+c2*c3)*d4);
+  J1[2] = c1*(a3*(s2*c3+c2*s3)+(-s2*s3+c2*c3)*d4);
+  J2[2] = s1*(a3*(s2*c3+c2*s3)+(-s2*s3+c2*c3)*d4);
   J3[2] = -a3*(s2*s3-c2*c3)-d4*(s2*c3+c2*s3);
-  J3[3] = -s1;
-  J3[4] = c1;
-  J3[5] = 0;
+  J4[2] = -s1;
+  J5[2] = c1;
+  J6[2] = 0;
 
-  J4[0] = 0;
-  J4[1] = 0;
-  J4[2] = 0;
+  J1[3] = 0;
+  J2[3] = 0;
+  J3[3] = 0;
   J4[3] = c1*s23;
-  J4[4] = s1*s23;
-  J4[5] = c23;
+  J5[3] = s1*s23;
+  J6[3] = c23;
 
-  J5[0] = 0;
-  J5[1] = 0;
-  J5[2] = 0;
-  J5[3] = -c23*c1*s4-s1*c4;
+  J1[4] = 0;
+  J2[4] = 0;
+  J3[4] = 0;
+  J4[4] = -c23*c1*s4-s1*c4;
   J5[4] = c1*c4-c23*s1*s4;
-  J5[5] = s23*s4;
+  J6[4] = s23*s4;
 
-  J6[0] = 0;
-  J6[1] = 0;
-  J6[2] = 0;
-  J6[3] = (c1*c23*c4-s1*s4)*s5+c1*s23*c5;
-  J6[4] = (s1*c23*c4+c1*s4)*s5+s1*s23*c5;
+  J1[5] = 0;
+  J2[5] = 0;
+  J3[5] = 0;
+  J4[5] = (c1*c23*c4-s1*s4)*s5+c1*s23*c5;
+  J5[5] = (s1*c23*c4+c1*s4)*s5+s1*s23*c5;
   J6[5] = -s23*c4*s5+c23*c5;
-
-  fJw.resize(6,6) ;
-  for (unsigned int i=0;i<6;i++) {
-    fJw[i][0] = J1[i];
-    fJw[i][1] = J2[i];
-    fJw[i][2] = J3[i];
-    fJw[i][3] = J4[i];
-    fJw[i][4] = J5[i];
-    fJw[i][5] = J6[i];
-  }
-  return;
 }
 /*!
 
@@ -1224,6 +1532,51 @@ vpViper::get_fJe(const vpColVector &q, vpMatrix &fJe) const
   return;
 }
 
+/*!
+
+  Compute the robot jacobian \f${^f}{\bf J}_e\f$ for a batch of joint
+  positions.
+
+  \param Q : A \f$6 \times N\f$ matrix whose column \e k contains the six
+  joint positions of configuration \e k expressed in radians.
+
+  \param fJe : The \e N robot jacobians \f${^f}{\bf J}_e\f$. The vector is
+  only resized if it does not contain \e N elements.
+
+  \sa get_fJe(const vpColVector &, vpMatrix &) const
+*/
+void
+vpViper::get_fJe(const vpMatrix &Q, std::vector<vpMatrix> &fJe) const
+{
+  checkJointMatrix(Q);
+  int n = (int)Q.getCols();
+  fJe.resize((size_t)n);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for if (n >= viperParallelCount)
+#endif
+  for (int k = 0; k < n; k++) {
+    double q[6], R[9], t[3], J[36];
+    for (unsigned int j=0; j<6; j++)
+      q[j] = Q[j][k];
+    compute_fMw(q, R, t);
+    compute_fJw(q, J);
+
+    // [fRw etw]x with etw = (0, 0, -d6)
+    double bx = -d6*R[2], by = -d6*R[5], bz = -d6*R[8];
+    vpMatrix &M = fJe[(size_t)k];
+    M.resize(6, 6, false);
+    for (unsigned int j=0; j<6; j++) {
+      M[0][j] = J[j]    - bz*J[24+j] + by*J[30+j];
+      M[1][j] = J[6+j]  + bz*J[18+j] - bx*J[30+j];
+      M[2][j] = J[12+j] - by*J[18+j] + bx*J[24+j];
+      M[3][j] = J[18+j];
+      M[4][j] = J[24+j];
+      M[5][j] = J[30+j];
+    }
+  }
+}
+
 
 /*!
   Get minimal joint values.
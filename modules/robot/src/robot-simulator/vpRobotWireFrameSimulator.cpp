@@ -62,7 +62,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator()
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(true), constantSamplingTimeMode(false),
-    setVelocityCalled(false), verbose_(false)
+    setVelocityCalled(false), verbose_(false), steppingMode(false), simulationTime(0)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -94,7 +94,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator(bool do_display)
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(do_display), constantSamplingTimeMode(false),
-    setVelocityCalled(false), verbose_(false)
+    setVelocityCalled(false), verbose_(false), steppingMode(false), simulationTime(0)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -370,6 +370,121 @@ vpRobotWireFrameSimulator::get_cMo()
   return cMoTemp;
 }
 
+/*!
+  Enable or disable the stepping mode.
+
+  In stepping mode, the thread that moves the robot according to the wall
+  clock is stopped. The robot only moves when setVelocity() or step() is
+  called, each call advancing the simulated time by the sampling time given
+  by setSamplingTime(). No sleep is done, and since the displacement does
+  not depend on the time spent by the caller between two commands, the
+  simulated trajectories are reproducible.
+
+  Enabling the stepping mode resets the simulated time returned by
+  getSimulationTime(), which is then also the timestamp returned by
+  getPosition() and getVelocity(). Disabling it launches again the thread.
+
+  \param stepping : When true, the robot displacement is driven by the
+  caller. When false, it is driven by the wall clock.
+
+  \sa step(), isSteppingMode()
+*/
+void
+vpRobotWireFrameSimulator::setSteppingMode(bool stepping)
+{
+  if (stepping == steppingMode)
+    return;
+
+  if (stepping) {
+    joinThread();
+    steppingMode = true;
+    simulationTime = 0;
+  }
+  else {
+    steppingMode = false;
+    setSamplingTime(getSamplingTime()); // Restore the minimal sampling time of the thread
+    tcur = vpTime::measureTimeMs();
+    launchThread();
+  }
+  setVelocityCalled = false;
+}
+
+/*!
+  Move the robot during one sampling time with the last velocity applied by
+  setVelocity() and advance the simulated time accordingly.
+
+  \exception vpRobotException::wrongStateError : If the stepping mode is not
+  enabled.
+
+  \sa setSteppingMode(), setSamplingTime(), getSimulationTime()
+*/
+void
+vpRobotWireFrameSimulator::step()
+{
+  if (! steppingMode) {
+    throw vpRobotException(vpRobotException::wrongStateError,
+                           "Cannot step the simulator: the stepping mode is not enabled");
+  }
+
+  setVelocityCalled = false;
+  // In position control the articular velocity is set by setPosition()
+  if (getRobotState() == vpRobot::STATE_VELOCITY_CONTROL)
+    computeArticularVelocity();
+  computeArticularPosition(getSamplingTime());
+  simulationTime += getSamplingTime();
+}
+
+/*!
+  Move the robot with the current articular velocity during \e ellapsedTime
+  seconds and update its display. This method is called by step() and has to
+  be implemented by the simulators that support the stepping mode.
+
+  \exception vpRobotException::functionNotImplementedError : If the simulator
+  does not implement it.
+*/
+void
+vpRobotWireFrameSimulator::computeArticularPosition(double /*ellapsedTime*/)
+{
+  throw vpRobotException(vpRobotException::functionNotImplementedError,
+                         "Cannot move the robot: computeArticularPosition() is not implemented by this simulator");
+}
+
+/*!
+  Launch the thread that moves the robot; see updateArticularPosition().
+*/
+void
+vpRobotWireFrameSimulator::launchThread()
+{
+  robotStop = false;
+#if defined(_WIN32)
+  DWORD   dwThreadIdArray;
+  hThread = CreateThread(
+            NULL,                   // default security attributes
+            0,                      // use default stack size
+            launcher,               // thread function name
+            this,                   // argument to thread function
+            0,                      // use default creation flags
+            &dwThreadIdArray);      // returns the thread identifier
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_create(&thread, NULL, launcher, (void *)this);
+#endif
+}
+
+/*!
+  Stop the thread that moves the robot and wait for its end.
+*/
+void
+vpRobotWireFrameSimulator::joinThread()
+{
+  robotStop = true;
+#if defined(_WIN32)
+  WaitForSingleObject(hThread,INFINITE);
+  CloseHandle(hThread);
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_join(thread, NULL);
+#endif
+}
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_robot.a(vpRobotWireFrameSimulator.cpp.o) has no symbols
 void dummy_vpRobotWireFrameSimulator() {};
@@ -76,16 +76,6 @@ vpSimulatorViper850::vpSimulatorViper850()
   mutex_artCoord = CreateMutex(NULL,FALSE,NULL);
   mutex_velocity = CreateMutex(NULL,FALSE,NULL);
   mutex_display = CreateMutex(NULL,FALSE,NULL);
-
-
-  DWORD   dwThreadIdArray;
-  hThread = CreateThread( 
-            NULL,                   // default security attributes
-            0,                      // use default stack size  
-			launcher,               // thread function name
-            this,                   // argument to thread function 
-            0,                      // use default creation flags 
-            &dwThreadIdArray);     // returns the thread identifier 
   #elif defined (VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -95,9 +85,9 @@ vpSimulatorViper850::vpSimulatorViper850()
   
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-  
-  pthread_create(&thread, NULL, launcher, (void *)this);
   #endif
+
+  launchThread();
   
   compute_fMi();
 }
@@ -124,16 +114,6 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
   mutex_artCoord = CreateMutex(NULL,FALSE,NULL);
   mutex_velocity = CreateMutex(NULL,FALSE,NULL);
   mutex_display = CreateMutex(NULL,FALSE,NULL);
-
-
-  DWORD   dwThreadIdArray;
-  hThread = CreateThread( 
-            NULL,                   // default security attributes
-            0,                      // use default stack size  
-			launcher,               // thread function name
-            this,                   // argument to thread function 
-            0,                      // use default creation flags 
-            &dwThreadIdArray);      // returns the thread identifier 
   #elif defined(VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -143,9 +123,9 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
   
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-  
-  pthread_create(&thread, NULL, launcher, (void *)this);
   #endif
+
+  launchThread();
   
   compute_fMi();
 }
@@ -155,11 +135,10 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
 */
 vpSimulatorViper850::~vpSimulatorViper850()
 {
-  robotStop = true;
+  if (! steppingMode)
+    joinThread();
   
   #if defined(_WIN32)
-  WaitForSingleObject(hThread,INFINITE);
-  CloseHandle(hThread);
   CloseHandle(mutex_fMi);
   CloseHandle(mutex_artVel);
   CloseHandle(mutex_artCoord);
@@ -167,7 +146,6 @@ vpSimulatorViper850::~vpSimulatorViper850()
   CloseHandle(mutex_display);
   #elif defined(VISP_HAVE_PTHREAD)
   pthread_attr_destroy(&attr);
-  pthread_join(thread, NULL);
   pthread_mutex_destroy(&mutex_fMi);
   pthread_mutex_destroy(&mutex_artVel);
   pthread_mutex_destroy(&mutex_artCoord);
@@ -466,95 +444,7 @@ vpSimulatorViper850::updateArticularPosition()
         ellapsedTime = getSamplingTime(); // in second
       }
       
-      vpColVector articularCoordinates = get_artCoord();
-      vpColVector articularVelocities = get_artVel();
-      
-      if (jointLimit)
-      {
-        double art = articularCoordinates[jointLimitArt-1] + ellapsedTime*articularVelocities[jointLimitArt-1];
-        if (art <= joint_min[jointLimitArt-1] || art >= joint_max[jointLimitArt-1]) {
-          if (verbose_) {
-            std::cout << "Joint " << jointLimitArt-1
-                    << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt-1]) << " < " << vpMath::deg(art) << " < " << vpMath::deg(joint_max[jointLimitArt-1]) << std::endl;
-          }
-          articularVelocities = 0.0;
-        }
-        else
-          jointLimit = false;
-      }
-      
-      articularCoordinates[0] = articularCoordinates[0] + ellapsedTime*articularVelocities[0];
-      articularCoordinates[1] = articularCoordinates[1] + ellapsedTime*articularVelocities[1];
-      articularCoordinates[2] = articularCoordinates[2] + ellapsedTime*articularVelocities[2];
-      articularCoordinates[3] = articularCoordinates[3] + ellapsedTime*articularVelocities[3];
-      articularCoordinates[4] = articularCoordinates[4] + ellapsedTime*articularVelocities[4];
-      articularCoordinates[5] = articularCoordinates[5] + ellapsedTime*articularVelocities[5];
-      
-      int jl = isInJointLimit();
-      
-      if (jl != 0 && jointLimit == false)
-      {
-        if (jl < 0)
-          ellapsedTime = (joint_min[(unsigned int)(-jl-1)] - articularCoordinates[(unsigned int)(-jl-1)])/(articularVelocities[(unsigned int)(-jl-1)]);
-        else
-          ellapsedTime = (joint_max[(unsigned int)(jl-1)] - articularCoordinates[(unsigned int)(jl-1)])/(articularVelocities[(unsigned int)(jl-1)]);
-        
-        for (unsigned int i = 0; i < 6; i++)
-          articularCoordinates[i] = articularCoordinates[i] + ellapsedTime*articularVelocities[i];
-        
-        jointLimit = true;
-        jointLimitArt = (unsigned int)fabs((double)jl);
-      }
-
-      set_artCoord(articularCoordinates);
-      set_artVel(articularVelocities);
-      
-      compute_fMi();
-     
-      if (displayAllowed)
-      {
-        vpDisplay::display(I);
-        vpDisplay::displayFrame(I,getExternalCameraPosition (),cameraParam,0.2,vpColor::none, thickness_);
-        vpDisplay::displayFrame(I,getExternalCameraPosition ()*fMi[7],cameraParam,0.1,vpColor::none, thickness_);
-      }
-      
-      if (displayType == MODEL_3D && displayAllowed)
-      {
-        while (get_displayBusy()) vpTime::wait(2);
-        vpSimulatorViper850::getExternalImage(I);
-        set_displayBusy(false);
-      }
-        
-      
-      if (displayType == MODEL_DH && displayAllowed)
-      {
-        vpHomogeneousMatrix fMit[8];
-        get_fMi(fMit);
-      
-      //vpDisplay::displayFrame(I,getExternalCameraPosition ()*fMi[6],cameraParam,0.2,vpColor::none);
-
-        vpImagePoint iP, iP_1;
-        vpPoint pt(0,0,0);
-      
-        pt.track(getExternalCameraPosition ());
-        vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP_1);
-        pt.track(getExternalCameraPosition ()*fMit[0]);
-        vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP);
-        vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
-        for (int k = 1; k < 7; k++)
-        {
-          pt.track(getExternalCameraPosition ()*fMit[k-1]);
-          vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP_1);
-        
-          pt.track(getExternalCameraPosition ()*fMit[k]);
-          vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP);
-        
-          vpDisplay::displayLine(I,iP_1,iP,vpColor::green, thickness_);
-        }
-        vpDisplay::displayCamera(I,getExternalCameraPosition ()*fMit[7],cameraParam,0.1,vpColor::green, thickness_);
-      }
-      
-      vpDisplay::flush(I);      
+      computeArticularPosition(ellapsedTime);
       
       vpTime::wait( tcur, 1000 * getSamplingTime() );
       tcur_1 = tcur;
@@ -564,6 +454,107 @@ vpSimulatorViper850::updateArticularPosition()
   }
 }
 
+/*!
+  Move the robot with the current articular velocity during \e ellapsedTime
+  seconds, stopping it when a joint limit is reached, and update the display
+  of the external view.
+
+  \param ellapsedTime : Duration of the displacement in second.
+*/
+void
+vpSimulatorViper850::computeArticularPosition(double ellapsedTime)
+{
+  vpColVector articularCoordinates = get_artCoord();
+  vpColVector articularVelocities = get_artVel();
+  
+  if (jointLimit)
+  {
+    double art = articularCoordinates[jointLimitArt-1] + ellapsedTime*articularVelocities[jointLimitArt-1];
+    if (art <= joint_min[jointLimitArt-1] || art >= joint_max[jointLimitArt-1]) {
+      if (verbose_) {
+        std::cout << "Joint " << jointLimitArt-1
+                << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt-1]) << " < " << vpMath::deg(art) << " < " << vpMath::deg(joint_max[jointLimitArt-1]) << std::endl;
+      }
+      articularVelocities = 0.0;
+    }
+    else
+      jointLimit = false;
+  }
+  
+  articularCoordinates[0] = articularCoordinates[0] + ellapsedTime*articularVelocities[0];
+  articularCoordinates[1] = articularCoordinates[1] + ellapsedTime*articularVelocities[1];
+  articularCoordinates[2] = articularCoordinates[2] + ellapsedTime*articularVelocities[2];
+  articularCoordinates[3] = articularCoordinates[3] + ellapsedTime*articularVelocities[3];
+  articularCoordinates[4] = articularCoordinates[4] + ellapsedTime*articularVelocities[4];
+  articularCoordinates[5] = articularCoordinates[5] + ellapsedTime*articularVelocities[5];
+  
+  int jl = isInJointLimit();
+  
+  if (jl != 0 && jointLimit == false)
+  {
+    if (jl < 0)
+      ellapsedTime = (joint_min[(unsigned int)(-jl-1)] - articularCoordinates[(unsigned int)(-jl-1)])/(articularVelocities[(unsigned int)(-jl-1)]);
+    else
+      ellapsedTime = (joint_max[(unsigned int)(jl-1)] - articularCoordinates[(unsigned int)(jl-1)])/(articularVelocities[(unsigned int)(jl-1)]);
+    
+    for (unsigned int i = 0; i < 6; i++)
+      articularCoordinates[i] = articularCoordinates[i] + ellapsedTime*articularVelocities[i];
+    
+    jointLimit = true;
+    jointLimitArt = (unsigned int)fabs((double)jl);
+  }
+
+  set_artCoord(articularCoordinates);
+  set_artVel(articularVelocities);
+  
+  compute_fMi();
+ 
+  if (displayAllowed)
+  {
+    vpDisplay::display(I);
+    vpDisplay::displayFrame(I,getExternalCameraPosition (),cameraParam,0.2,vpColor::none, thickness_);
+    vpDisplay::displayFrame(I,getExternalCameraPosition ()*fMi[7],cameraParam,0.1,vpColor::none, thickness_);
+  }
+  
+  if (displayType == MODEL_3D && displayAllowed)
+  {
+    while (get_displayBusy()) vpTime::wait(2);
+    vpSimulatorViper850::getExternalImage(I);
+    set_displayBusy(false);
+  }
+    
+  
+  if (displayType == MODEL_DH && displayAllowed)
+  {
+    vpHomogeneousMatrix fMit[8];
+    get_fMi(fMit);
+  
+  //vpDisplay::displayFrame(I,getExternalCameraPosition ()*fMi[6],cameraParam,0.2,vpColor::none);
+
+    vpImagePoint iP, iP_1;
+    vpPoint pt(0,0,0);
+  
+    pt.track(getExternalCameraPosition ());
+    vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP_1);
+    pt.track(getExternalCameraPosition ()*fMit[0]);
+    vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP);
+    vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
+    for (int k = 1; k < 7; k++)
+    {
+      pt.track(getExternalCameraPosition ()*fMit[k-1]);
+      vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP_1);
+    
+      pt.track(getExternalCameraPosition ()*fMit[k]);
+      vpMeterPixelConversion::convertPoint (cameraParam, pt.get_x(), pt.get_y(), iP);
+    
+      vpDisplay::displayLine(I,iP_1,iP,vpColor::green, thickness_);
+    }
+    vpDisplay::displayCamera(I,getExternalCameraPosition ()*fMit[7],cameraParam,0.1,vpColor::green, thickness_);
+  }
+  
+  vpDisplay::flush(I);
+}
+
 /*!
   Compute the pose between the robot reference frame and the frames used to compute the Denavit-Hartenberg
   representation. The last element of the table corresponds to the pose between the reference frame and
@@ -930,6 +921,8 @@ vpSimulatorViper850::setVelocity (const vpRobot::vpControlFrameType frame, const
   set_velocity (vel * scale_sat);
   setRobotFrame (frame);
   setVelocityCalled = true;
+  if (steppingMode)
+    step();
 }
 
 
@@ -1127,7 +1120,7 @@ vpSimulatorViper850::getVelocity (const vpRobot::vpControlFrameType frame, vpCol
 void
 vpSimulatorViper850::getVelocity (const vpRobot::vpControlFrameType frame, vpColVector & vel, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = steppingMode ? simulationTime : vpTime::measureTimeSecond();
   getVelocity(frame, vel);
 }
 
@@ -1197,7 +1190,7 @@ vpSimulatorViper850::getVelocity (vpRobot::vpControlFrameType frame)
 vpColVector
 vpSimulatorViper850::getVelocity (vpRobot::vpControlFrameType frame, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = steppingMode ? simulationTime : vpTime::measureTimeSecond();
   vpColVector vel(6);
   getVelocity (frame, vel);
 
@@ -1357,6 +1350,8 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
           throw vpRobotException (vpRobotException::positionOutOfRangeError,
 			    "Position out of range.");
         }
+        if (steppingMode)
+          step();
       }while (errsqr > 1e-8 && nbSol > 0);
 
       break ;
@@ -1380,6 +1375,8 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
           set_velocity(error);
           break;
         }
+        if (steppingMode)
+          step();
       }while (errsqr > 1e-8);
       break ;
     }
@@ -1423,6 +1420,8 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
         }
         else
           vpERROR_TRACE ("Positionning error. Position unreachable");
+        if (steppingMode)
+          step();
       }while (errsqr > 1e-8 && nbSol > 0);
       break ;
     }
@@ -1713,7 +1712,7 @@ vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpColV
 void
 vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = steppingMode ? simulationTime : vpTime::measureTimeSecond();
   getPosition(frame, q);
 }
 
@@ -1761,7 +1760,7 @@ void
 vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame,
                                  vpPoseVector &position, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = steppingMode ? simulationTime : vpTime::measureTimeSecond();
   getPosition(frame, position);
 }
 
@@ -40,10 +40,14 @@
   \brief Implementation of a wire frame simulator.
 */
 
+#include <visp3/core/vpMatrixException.h>
 #include <visp3/robot/vpWireFrameSimulator.h>
 #include <fcntl.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <exception>
 #include <vector>
 
 #include "vpClipping.h"
@@ -1531,3 +1535,408 @@ vpWireFrameSimulator::projectCameraTrajectory (const vpImage<unsigned char> &I,
   return iP;
 }
 
+
+/*************************************************************************************************************/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Depth range of the view volume used by the overlay rendering. The view
+// reference point is set at one meter in front of the camera and initScene()
+// sets the "depth" view parameters to (0, 100), so that set_perspective() puts
+// the back clipping plane at 101 meters. The front clipping plane of the scene
+// library only rejects the points behind the camera, the near plane is here a
+// small positive depth to keep the perspective division well defined.
+#define VP_WIREFRAME_NEAR_PLANE 1e-3
+#define VP_WIREFRAME_FAR_PLANE  101.0
+
+static inline void
+vpWireFrameColorToPixel(const vpColor &color, unsigned char &value)
+{
+  value = (unsigned char) (0.299 * color.R + 0.587 * color.G + 0.114 * color.B);
+}
+
+static inline void
+vpWireFrameColorToPixel(const vpColor &color, vpRGBa &value)
+{
+  value = vpRGBa(color.R, color.G, color.B);
+}
+
+/*
+  Draw the segment [(u1,v1), (u2,v2)] in the image pixels. The segment is
+  first clipped against the image borders (Liang-Barsky) then rasterized with
+  the Bresenham algorithm. As in the scene library, the end points are
+  truncated to the pixel grid.
+*/
+template <class Type>
+static void
+vpWireFrameDrawLine(vpImage<Type> &I, double u1, double v1, double u2, double v2,
+                    const Type &value, unsigned int thickness)
+{
+  const double border = (double)thickness;
+  const double bounds[4] = { -border, (double)I.getWidth() - 1 + border,
+                             -border, (double)I.getHeight() - 1 + border };
+  double du = u2 - u1, dv = v2 - v1;
+  const double p[4] = { -du, du, -dv, dv };
+  const double q[4] = { u1 - bounds[0], bounds[1] - u1, v1 - bounds[2], bounds[3] - v1 };
+  double t0 = 0., t1 = 1.;
+  for (unsigned int k = 0; k < 4; k++) {
+    if (std::fabs(p[k]) <= std::numeric_limits<double>::epsilon()) {
+      if (q[k] < 0)
+        return;
+    }
+    else {
+      double r = q[k] / p[k];
+      if (p[k] < 0) {
+        if (r > t1) return;
+        if (r > t0) t0 = r;
+      }
+      else {
+        if (r < t0) return;
+        if (r < t1) t1 = r;
+      }
+    }
+  }
+
+  int x0 = (int)std::floor(u1 + t0 * du), y0 = (int)std::floor(v1 + t0 * dv);
+  int x1 = (int)std::floor(u1 + t1 * du), y1 = (int)std::floor(v1 + t1 * dv);
+  int dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+  int sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+  int err = dx + dy;
+  int width = (int)I.getWidth(), height = (int)I.getHeight();
+  int kmin = -((int)thickness - 1) / 2, kmax = (int)thickness / 2;
+
+  for (;;) {
+    for (int i = y0 + kmin; i <= y0 + kmax; i++) {
+      if (i < 0 || i >= height) continue;
+      Type *row = I[(unsigned int)i];
+      for (int j = x0 + kmin; j <= x0 + kmax; j++) {
+        if (j >= 0 && j < width)
+          row[j] = value;
+      }
+    }
+    if (x0 == x1 && y0 == y1)
+      break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+/*
+  Clip the polygon of camera frame points P (3 coordinates per point) against
+  the half space plane[0] X + plane[1] Y + plane[2] Z + plane[3] >= 0 with the
+  Sutherland-Hodgman algorithm. The clipped polygon is returned in P.
+*/
+static void
+vpWireFrameClipPolygon(std::vector<double> &P, const double plane[4], std::vector<double> &tmp)
+{
+  size_t n = P.size() / 3;
+  tmp.clear();
+  if (n == 0)
+    return;
+  const double *S = &P[3*(n-1)];
+  double ds = plane[0]*S[0] + plane[1]*S[1] + plane[2]*S[2] + plane[3];
+  for (size_t k = 0; k < n; k++) {
+    const double *E = &P[3*k];
+    double de = plane[0]*E[0] + plane[1]*E[1] + plane[2]*E[2] + plane[3];
+    if ((ds >= 0) != (de >= 0)) {
+      // Intersection of the edge [S, E] with the plane
+      double t = ds / (ds - de);
+      for (unsigned int r = 0; r < 3; r++)
+        tmp.push_back(S[r] + t * (E[r] - S[r]));
+    }
+    if (de >= 0)
+      tmp.insert(tmp.end(), E, E + 3);
+    S = E;
+    ds = de;
+  }
+  P.swap(tmp);
+}
+
+/*
+  Rasterize the visible faces of a scene seen from the camera pose cMo. As in
+  display_scene(), the faces are clipped against the view volume, so that the
+  parts of the contours lying on the image borders are drawn, and the
+  back-face culling of the scene library is applied.
+*/
+template <class Type>
+static void
+vpWireFrameDrawScene(vpImage<Type> &I, const Bound_scene &sc, const vpHomogeneousMatrix &cMo,
+                     const vpCameraParameters &cam, bool backFaceCulling, const Type &value,
+                     unsigned int thickness)
+{
+  double px = cam.get_px(), py = cam.get_py(), u0 = cam.get_u0(), v0 = cam.get_v0();
+  double umax = (double)I.getWidth() - 1, vmax = (double)I.getHeight() - 1;
+  // View volume: near and far planes, then the planes through the image borders
+  const double planes[6][4] = { { 0, 0, 1, -VP_WIREFRAME_NEAR_PLANE }, { 0, 0, -1, VP_WIREFRAME_FAR_PLANE },
+                                { px, 0, u0, 0 }, { -px, 0, umax - u0, 0 },
+                                { 0, py, v0, 0 }, { 0, -py, vmax - v0, 0 } };
+  std::vector<double> Xc, poly, tmp, uv;
+
+  const Bound *bend = sc.bound.ptr + sc.bound.nbr;
+  for (const Bound *bp = sc.bound.ptr; bp < bend; bp++) {
+    // Points of the surface in the camera frame
+    Xc.resize(3 * (size_t)bp->point.nbr);
+    for (Index k = 0; k < bp->point.nbr; k++) {
+      const Point3f &P = bp->point.ptr[k];
+      for (unsigned int r = 0; r < 3; r++)
+        Xc[3*k+r] = cMo[r][0]*P.x + cMo[r][1]*P.y + cMo[r][2]*P.z + cMo[r][3];
+    }
+
+    const Face *fend = bp->face.ptr + bp->face.nbr;
+    for (const Face *fp = bp->face.ptr; fp < fend; fp++) {
+      Index n = fp->vertex.nbr;
+      if (n < 1)
+        continue;
+      const Index *vp = fp->vertex.ptr;
+      if (backFaceCulling && n > 2) {
+        // Sign of the projected contour orientation, that is the mixed
+        // product of the first, second and last vertices
+        const double *P0 = &Xc[3*vp[0]], *P1 = &Xc[3*vp[1]], *P2 = &Xc[3*vp[n-1]];
+        double det = P0[0] * (P1[1]*P2[2] - P1[2]*P2[1])
+                   - P0[1] * (P1[0]*P2[2] - P1[2]*P2[0])
+                   + P0[2] * (P1[0]*P2[1] - P1[1]*P2[0]);
+        if (det > 0)
+          continue;
+      }
+
+      poly.clear();
+      for (Index e = 0; e < n; e++)
+        poly.insert(poly.end(), &Xc[3*vp[e]], &Xc[3*vp[e]] + 3);
+      for (unsigned int k = 0; k < 6 && ! poly.empty(); k++)
+        vpWireFrameClipPolygon(poly, planes[k], tmp);
+
+      // Projection of the clipped points, that are in the image up to the
+      // rounding errors
+      size_t m = poly.size() / 3;
+      uv.resize(2 * m);
+      for (size_t k = 0; k < m; k++) {
+        uv[2*k] = vpMath::maximum(0., vpMath::minimum(umax, u0 + px * poly[3*k] / poly[3*k+2]));
+        uv[2*k+1] = vpMath::maximum(0., vpMath::minimum(vmax, v0 + py * poly[3*k+1] / poly[3*k+2]));
+      }
+
+      // A clipped polygon is drawn closed, a clipped segment once
+      size_t nbEdges = (n > 2) ? m : (m > 0 ? 1 : 0);
+      for (size_t e = 0; e < nbEdges; e++) {
+        size_t f = (e + 1) % m;
+        vpWireFrameDrawLine(I, uv[2*e], uv[2*e+1], uv[2*f], uv[2*f+1], value, thickness);
+      }
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Rasterize the internal view seen from the camera pose \e cMo_ in the image
+  \e I. Contrary to getInternalImage() the image pixels are modified and no
+  display is required.
+
+  This method doesn't modify the simulator state except the projection of the
+  image simulators given in \e imSim, so that it can be called concurrently
+  with different images and lists of image simulators.
+*/
+template <class Type>
+void
+vpWireFrameSimulator::renderInternalView(vpImage<Type> &I, const vpHomogeneousMatrix &cMo_,
+                                         std::list<vpImageSimulator> &imSim) const
+{
+  vpCameraParameters cam = getInternalCameraParameters(I);
+
+  I = 255;
+  if (displayImageSimulator)
+  {
+    for(std::list<vpImageSimulator>::iterator it=imSim.begin(); it!=imSim.end(); ++it){
+      it->setCameraPosition(cMo_);
+      it->getImage(I, cam);
+    }
+  }
+
+  bool backFaceCulling = (((Byte) *get_rfstack ()) & IS_BACK) != 0;
+  Type value;
+
+  if (displayObject)
+  {
+    vpWireFrameColorToPixel(curColor, value);
+    vpWireFrameDrawScene(I, scene, cMo_, cam, backFaceCulling, value, thickness_);
+  }
+
+  if (displayDesiredObject)
+  {
+    if (desiredObject == D_TOOL) {
+      // The tool is attached to the camera
+      vpWireFrameColorToPixel(vpColor::red, value);
+      vpWireFrameDrawScene(I, desiredScene, rotz, cam, backFaceCulling, value, thickness_);
+    }
+    else {
+      vpWireFrameColorToPixel(desColor, value);
+      vpWireFrameDrawScene(I, desiredScene, rotz*cdMo, cam, backFaceCulling, value, thickness_);
+    }
+  }
+}
+
+/*!
+  Render in parallel the internal views corresponding to a list of camera
+  poses. OpenMP is used to spread the frames over the available cores when
+  ViSP is built with OpenMP support.
+*/
+template <class Type>
+void
+vpWireFrameSimulator::renderInternalViews(const std::vector<vpHomogeneousMatrix> &list_cMo,
+                                          std::vector<vpImage<Type> > &images)
+{
+  if (!sceneInitialized)
+    throw(vpException(vpException::notInitialized,"The scene has to be initialized")) ;
+  if (images.size() != list_cMo.size())
+    throw(vpException(vpException::dimensionError,"The number of images (%d) differs from the number of poses (%d)",
+                      (int)images.size(), (int)list_cMo.size())) ;
+  for (size_t i = 0; i < images.size(); i++) {
+    if (images[i].getSize() == 0)
+      throw(vpException(vpException::dimensionError,"Image %d is not allocated", (int)i)) ;
+  }
+
+  int nbFrames = (int)list_cMo.size();
+  // An exception can't leave the parallel region, the one of the first
+  // failing frame is kept and thrown after the region
+  int failedFrame = nbFrames;
+  bool matrixFailure = false;
+  vpException failure(vpException::fatalError);
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // The image simulators keep their projection state, each thread uses its own copy
+    std::list<vpImageSimulator> imSim;
+    if (displayImageSimulator)
+      imSim = objectImage;
+
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < nbFrames; i++) {
+      bool isMatrixException = false;
+      vpException e(vpException::fatalError);
+      try {
+        renderInternalView(images[(size_t)i], list_cMo[(size_t)i], imSim);
+        continue;
+      }
+      catch(const vpMatrixException &me) {
+        e = me;
+        isMatrixException = true;
+      }
+      catch(const vpException &ve) {
+        e = ve;
+      }
+      catch(const std::exception &se) {
+        e = vpException(vpException::fatalError, se.what());
+      }
+      catch(...) {
+        e = vpException(vpException::fatalError, "Unknown exception");
+      }
+#ifdef VISP_HAVE_OPENMP
+      #pragma omp critical (vpWireFrameSimulator_renderInternalViews)
+#endif
+      {
+        if (i < failedFrame) {
+          failedFrame = i;
+          failure = e;
+          matrixFailure = isMatrixException;
+        }
+      }
+    }
+  }
+
+  if (failedFrame < nbFrames) {
+    if (matrixFailure)
+      throw vpMatrixException(failure.getCode(), failure.getStringMessage());
+    throw failure;
+  }
+}
+
+/*!
+  Render the internal view directly in the image pixels. It corresponds to the
+  view of the scene given by getInternalImage() from the camera pose \e cMo_
+  except that the scene is rasterized in the image instead of being displayed
+  as overlay. No display is thus required.
+
+  The image background is set to white before rendering. The camera
+  parameters are the ones returned by getInternalCameraParameters().
+
+  \param I : Allocated image where the internal view is rendered.
+  \param cMo_ : Pose of the camera relative to the object.
+
+  \sa renderInternalImages()
+*/
+void
+vpWireFrameSimulator::renderInternalImage(vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo_)
+{
+  if (!sceneInitialized)
+    throw(vpException(vpException::notInitialized,"The scene has to be initialized")) ;
+  if (I.getSize() == 0)
+    throw(vpException(vpException::dimensionError,"The image is not allocated")) ;
+
+  renderInternalView(I, cMo_, objectImage);
+}
+
+/*!
+  Render the internal view directly in the image pixels. It corresponds to the
+  view of the scene given by getInternalImage() from the camera pose \e cMo_
+  except that the scene is rasterized in the image instead of being displayed
+  as overlay. No display is thus required.
+
+  The image background is set to white before rendering. The camera
+  parameters are the ones returned by getInternalCameraParameters().
+
+  \param I : Allocated image where the internal view is rendered.
+  \param cMo_ : Pose of the camera relative to the object.
+
+  \sa renderInternalImages()
+*/
+void
+vpWireFrameSimulator::renderInternalImage(vpImage<vpRGBa> &I, const vpHomogeneousMatrix &cMo_)
+{
+  if (!sceneInitialized)
+    throw(vpException(vpException::notInitialized,"The scene has to be initialized")) ;
+  if (I.getSize() == 0)
+    throw(vpException(vpException::dimensionError,"The image is not allocated")) ;
+
+  renderInternalView(I, cMo_, objectImage);
+}
+
+/*!
+  Headless batch rendering of the internal view for a list of camera poses.
+  Each pose \e list_cMo[i] is rendered in \e images[i] as with
+  renderInternalImage(). Frames are rendered in parallel when ViSP is built
+  with OpenMP.
+
+  \param list_cMo : Poses of the camera relative to the object.
+  \param images : Preallocated images, one per pose. The size of each image
+  may differ.
+
+  \exception vpException::dimensionError : If the number of images differs
+  from the number of poses or if an image is not allocated.
+*/
+void
+vpWireFrameSimulator::renderInternalImages(const std::vector<vpHomogeneousMatrix> &list_cMo,
+                                           std::vector<vpImage<unsigned char> > &images)
+{
+  renderInternalViews(list_cMo, images);
+}
+
+/*!
+  Headless batch rendering of the internal view for a list of camera poses.
+  Each pose \e list_cMo[i] is rendered in \e images[i] as with
+  renderInternalImage(). Frames are rendered in parallel when ViSP is built
+  with OpenMP.
+
+  \param list_cMo : Poses of the camera relative to the object.
+  \param images : Preallocated images, one per pose. The size of each image
+  may differ.
+
+  \exception vpException::dimensionError : If the number of images differs
+  from the number of poses or if an image is not allocated.
+*/
+void
+vpWireFrameSimulator::renderInternalImages(const std::vector<vpHomogeneousMatrix> &list_cMo,
+                                           std::vector<vpImage<vpRGBa> > &images)
+{
+  renderInternalViews(list_cMo, images);
+}
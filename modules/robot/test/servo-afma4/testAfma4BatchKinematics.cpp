@@ -0,0 +1,246 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the batched kinematics of the Afma4 robot.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testAfma4BatchKinematics.cpp
+
+  Check that the forward kinematics and the jacobians of the Afma4 computed
+  for a batch of joint positions match the ones computed for each joint
+  position, and with reference values computed for a few joint positions,
+  and print the computation times.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/robot/vpAfma4.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+  /*
+    Kinematics of a few joint positions computed with the per configuration
+    code of ViSP 3.0.1, before it was shared with the batched code.
+  */
+  struct vpReference
+  {
+    double q[4];
+    double fMc[12];
+    double fJe[24];
+    double eJe[24];
+  };
+
+  const vpReference references[] = {
+    {
+      // Joint positions
+      {0.15, 0, -1.3, 0},
+      // fMc
+      {0.408487440884, 0, 0.912763940261, 0.14247450359,
+       -0.912763940261, 0, 0.408487440884, 0.429109561565,
+       0, -1, 0, 0.14},
+      // fJe
+      {-0.429109561565, 0, 0, 0,
+       0.14247450359, 0, 0, 0,
+       0, 1, 0, 0,
+       0, 0, 0, 0.408487440884,
+       0, 0, 0, -0.912763940261,
+       1, 0, 1, 0},
+      // eJe
+      {0.333476688855, 0, 0, 0,
+       0, -1, 0, 0,
+       -0.305331455946, 0, 0, 0,
+       0, 0, 0, 0,
+       -1, 0, -1, 0,
+       0, 0, 0, 1},
+    },
+    {
+      // Joint positions
+      {-0.51, 0.18, -1.52, 0.304},
+      // fMc
+      {-0.443234415666, 0.268329357952, 0.855302641426, 0.375648054561,
+       -0.896405741152, -0.132677425766, -0.422910685515, 0.25163970097,
+       0, -0.954146768769, 0.299339178269, 0.32},
+      // fJe
+      {-0.25163970097, 0, 0, 0,
+       0.375648054561, 0, 0, 0,
+       0, 1, 0, 0,
+       0, 0, 0, -0.443234415666,
+       0, 0, 0, -0.896405741152,
+       1, 0, 1, 0},
+      // eJe
+      {0.374093677194, -0.299339178269, 0, 0,
+       -0.11736233627, -0.954146768769, 0, 0,
+       -0.225197696943, 0, 0, 0,
+       -0.299339178269, 0, -0.299339178269, 0,
+       -0.954146768769, 0, -0.954146768769, 0,
+       0, 0, 0, 1},
+    },
+    {
+      // Joint positions
+      {1.14, -0.45, -0.86, -0.532},
+      // fMc
+      {0.961055438311, 0.140183597863, -0.238161716872, -0.280572425623,
+       0.276355648564, -0.487503004871, 0.828232078435, 0.354560451799,
+       0, -0.861794278893, -0.507257943129, -0.31},
+      // fJe
+      {-0.354560451799, 0, 0, 0,
+       -0.280572425623, 0, 0, 0,
+       0, 1, 0, 0,
+       0, 0, 0, 0.961055438311,
+       0, 0, 0, 0.276355648564,
+       1, 0, 1, 0},
+      // eJe
+      {0.14793635729, 0.507257943129, 0, 0,
+       0.0870763407821, -0.861794278893, 0, 0,
+       -0.418290025064, 0, 0, 0,
+       0.507257943129, 0, 0.507257943129, 0,
+       -0.861794278893, 0, -0.861794278893, 0,
+       0, 0, 0, 1},
+    }
+  };
+
+  double maxDifference(const double *ref, const double *v, unsigned int n)
+  {
+    double d = 0;
+    for (unsigned int i=0; i<n; i++)
+      d = (std::max)(d, std::fabs(ref[i] - v[i]));
+    return d;
+  }
+
+  double maxDifference(const vpArray2D<double> &A, const vpArray2D<double> &B)
+  {
+    return maxDifference(A.data, B.data, A.size());
+  }
+
+  void check(const std::string &name, double error, const std::string &reference)
+  {
+    std::cout << name << " max error with the " << reference << ": " << error << std::endl;
+    if (! (error < 1e-9)) {
+      throw vpException(vpException::fatalError, "Batched %s differs from the %s", name.c_str(), reference.c_str());
+    }
+  }
+}
+
+int main()
+{
+  try {
+    vpAfma4 robot;
+
+    // Kinematics of known joint positions
+    const unsigned int nref = sizeof(references) / sizeof(references[0]);
+    vpMatrix Qref(4, nref);
+    for (unsigned int k=0; k<nref; k++)
+      for (unsigned int j=0; j<4; j++)
+        Qref[j][k] = references[k].q[j];
+
+    std::vector<vpHomogeneousMatrix> fMc;
+    std::vector<vpMatrix> fJe, eJe;
+    robot.get_fMc(Qref, fMc);
+    robot.get_fJe(Qref, fJe);
+    robot.get_eJe(Qref, eJe);
+
+    double err_fMc = 0, err_fJe = 0, err_eJe = 0;
+    for (unsigned int k=0; k<nref; k++) {
+      const vpReference &ref = references[k];
+      vpColVector q = Qref.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, M.data, 12));
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, fMc[k].data, 12));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, J.data, 24));
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, fJe[k].data, 24));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, J.data, 24));
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, eJe[k].data, 24));
+    }
+    check("fMc", err_fMc, "reference values");
+    check("fJe", err_fJe, "reference values");
+    check("eJe", err_eJe, "reference values");
+
+    // Random joint positions, slightly inside the joint limits
+    vpColVector qmin = robot.getJointMin();
+    vpColVector qmax = robot.getJointMax();
+    const unsigned int n = 2000;
+    vpUniRand rand(42);
+    vpMatrix Q(4, n);
+    for (unsigned int k=0; k<n; k++)
+      for (unsigned int j=0; j<4; j++)
+        Q[j][k] = qmin[j] + 0.1 + (qmax[j] - qmin[j] - 0.2)*rand();
+
+    double t = vpTime::measureTimeMs();
+    robot.get_fMc(Q, fMc);
+    robot.get_fJe(Q, fJe);
+    robot.get_eJe(Q, eJe);
+    double t_batch = vpTime::measureTimeMs() - t;
+
+    err_fMc = err_fJe = err_eJe = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k=0; k<n; k++) {
+      vpColVector q = Q.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(M, fMc[k]));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(J, fJe[k]));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(J, eJe[k]));
+    }
+    double t_single = vpTime::measureTimeMs() - t;
+    std::cout << "Forward kinematics and jacobians of " << n << " configurations: "
+              << t_batch << " ms batched, " << t_single << " ms one by one" << std::endl;
+    check("fMc", err_fMc, "per configuration one");
+    check("fJe", err_fJe, "per configuration one");
+    check("eJe", err_eJe, "per configuration one");
+
+    // A matrix of joint positions of another robot is rejected
+    try {
+      robot.get_fMc(vpMatrix(6, 1), fMc);
+      std::cout << "A 6 rows joint positions matrix should be rejected" << std::endl;
+      return 1;
+    }
+    catch(const vpException &) {
+    }
+
+    return 0;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the batched kinematics of the Afma6 robot.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testAfma6BatchKinematics.cpp
+
+  Check that the forward kinematics, the jacobians and the inverse kinematics
+  of the Afma6 computed for a batch of joint positions match the ones
+  computed for each joint position, and with reference values computed for a
+  few joint positions, and print the computation times.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/robot/vpAfma6.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+  /*
+    Kinematics of a few joint positions computed with the per configuration
+    code of ViSP 3.0.1, before it was shared with the batched code.
+  */
+  struct vpReference
+  {
+    double q[6];
+    double fMc[12];
+    double fJe[36];
+    double eJe[36];
+    double qik[6];
+  };
+
+  const vpReference references[] = {
+    {
+      // Joint positions
+      {0.025, -0.04, -0.02, 0, 1.19, 0},
+      // fMc
+      {0.999662738735, -0.0227561180318, -0.012512708657, -0.0410667646306,
+       -0.0033111144828, 0.366205999116, -0.930527916149, 0.0335466992119,
+       0.0257574320672, 0.930255516137, 0.366007143906, 0.195286863539},
+      // fJe
+      {1, 0, 0, 0, 0, 0,
+       0, 1, 0, -0.06924, 0, 0,
+       0, 0, 1, 0, 0, 0,
+       0, 0, 0, 0, 1, 0,
+       0, 0, 0, 0, -0.00337875989872, 0.371659872261,
+       0, 0, 0, 1, -0.00843980228126, 0.928368967249},
+      // eJe
+      {-0.0108180789808, -0.928314641763, 0.371638123792, 0.0642765057957, 0, 0,
+       0.999941482871, -0.010043168811, 0.00402064585209, 0.000695389008472, 0, 0,
+       0, 0.371659872261, 0.928368967249, -0.0257337295553, 0, 0,
+       0, 0, 0, 0.371638123792, -0.0108180789808, 0,
+       0, 0, 0, 0.00402064585209, 0.999941482871, 0,
+       0, 0, 0, 0.928368967249, -0.009091, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {0.025, -0.04, -0.02, 0, 1.19, 0},
+    },
+    {
+      // Joint positions
+      {-0.245, 0.072, -0.068, 1.092, 0.803, -0.954},
+      // fMc
+      {0.773091409758, -0.634218568619, -0.00982239166493, -0.414501776166,
+       0.241825739966, 0.30902280593, -0.919796290982, 0.0732925554455,
+       0.586387230121, 0.708711304153, 0.39227325134, 0.101988665678},
+      // fJe
+      {1, 0, 0, 0.0614539697073, 0, 0,
+       0, 1, 0, -0.0318996427442, 0, 0,
+       0, 0, 1, 0, 0, 0,
+       0, 0, 0, 0, 0.466315329565, -0.616449269237,
+       0, 0, 0, 0, 0.884641103571, 0.31998765177,
+       0, 0, 0, 1, -0.00654045612929, 0.719442979792},
+      // eJe
+      {-0.0122178538967, -0.917477876761, 0.397599131917, 0.0285163808711, 0, 0,
+       0.787299830118, 0.236309645105, 0.569488129048, 0.0408445066548, 0, 0,
+       -0.616449269237, 0.31998765177, 0.719442979792, -0.0480907464918, 0, 0,
+       0, 0, 0, 0.397599131917, -0.819936493645, 0,
+       0, 0, 0, 0.569488129048, 0.572454492854, 0,
+       0, 0, 0, 0.719442979792, -0.009091, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {-0.245, 0.072, -0.068, 1.092, 0.803, -0.954},
+    },
+    {
+      // Joint positions
+      {0.43, -0.32, 0.076, -1.911, 1.577, 1.272},
+      // fMc
+      {0.792591236921, -0.0275184341864, -0.609132060342, 0.447283945053,
+       -0.609083255444, 0.0110901865493, -0.793028748344, -0.265554438226,
+       0.0285782976016, 0.999559774872, -0.00797103280418, 0.303192746194},
+      // fJe
+      {1, 0, 0, -0.0652716287414, 0, 0,
+       0, 1, 0, 0.0231039408208, 0, 0,
+       0, 0, 1, 0, 0, 0,
+       0, 0, 0, 0, -0.333625934166, -0.00584808285665,
+       0, 0, 0, 0, -0.942705542167, 0.00207002280838,
+       0, 0, 0, 1, -0.00909082506444, 0.999980757281},
+      // eJe
+      {-0.607833583613, -0.794062140403, -0.00191097119039, 0.0213283233062, 0, 0,
+       0.794042904735, -0.60783306276, 0.00590197057218, -0.0658718127935, 0, 0,
+       -0.00584808285665, 0.00207002280838, 0.999980757281, 0.00042953957753, 0, 0,
+       0, 0, 0, -0.00191097119039, 0.951373200038, 0,
+       0, 0, 0, 0.00590197057218, 0.308040637335, 0,
+       0, 0, 0, 0.999980757281, -0.009091, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {0.43, -0.32, 0.076, -1.911, 1.577, 1.272},
+    }
+  };
+
+  double maxDifference(const double *ref, const double *v, unsigned int n)
+  {
+    double d = 0;
+    for (unsigned int i=0; i<n; i++)
+      d = (std::max)(d, std::fabs(ref[i] - v[i]));
+    return d;
+  }
+
+  void checkReference(const std::string &name, double error)
+  {
+    std::cout << name << " max error with the reference values: " << error << std::endl;
+    if (! (error < 1e-9)) {
+      throw vpException(vpException::fatalError, "%s differs from the reference values", name.c_str());
+    }
+  }
+
+  /*
+    Compare the batched and the per configuration kinematics with the
+    reference values. The inverse kinematics starts from the joint positions
+    shifted by +/-0.02.
+  */
+  void checkReferences(const vpAfma6 &robot)
+  {
+    const unsigned int n = sizeof(references) / sizeof(references[0]);
+    vpMatrix Q(6, n), Qik(6, n);
+    for (unsigned int k=0; k<n; k++) {
+      for (unsigned int j=0; j<6; j++) {
+        Q[j][k] = references[k].q[j];
+        Qik[j][k] = references[k].q[j] + ((j % 2) ? 0.02 : -0.02);
+      }
+    }
+
+    std::vector<vpHomogeneousMatrix> fMc;
+    std::vector<vpMatrix> fJe, eJe;
+    std::vector<int> nbSol;
+    vpMatrix Qik_batch = Qik;
+    robot.get_fMc(Q, fMc);
+    robot.get_fJe(Q, fJe);
+    robot.get_eJe(Q, eJe);
+    robot.getInverseKinematics(fMc, Qik_batch, nbSol);
+
+    double err_fMc = 0, err_fJe = 0, err_eJe = 0, err_ik = 0;
+    for (unsigned int k=0; k<n; k++) {
+      const vpReference &ref = references[k];
+      vpColVector q = Q.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, M.data, 12));
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, fMc[k].data, 12));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, J.data, 36));
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, fJe[k].data, 36));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, J.data, 36));
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, eJe[k].data, 36));
+
+      vpColVector qik = Qik.getCol(k);
+      if (robot.getInverseKinematics(M, qik) == 0 || nbSol[k] == 0) {
+        throw vpException(vpException::fatalError, "No inverse kinematics solution for reference %d", k);
+      }
+      err_ik = (std::max)(err_ik, maxDifference(ref.qik, qik.data, 6));
+      err_ik = (std::max)(err_ik, maxDifference(ref.qik, Qik_batch.getCol(k).data, 6));
+    }
+    checkReference("fMc", err_fMc);
+    checkReference("fJe", err_fJe);
+    checkReference("eJe", err_eJe);
+    checkReference("inverse kinematics", err_ik);
+  }
+
+  double maxDifference(const vpArray2D<double> &A, const vpArray2D<double> &B)
+  {
+    double d = 0;
+    for (unsigned int i=0; i<A.size(); i++)
+      d = (std::max)(d, std::fabs(A.data[i] - B.data[i]));
+    return d;
+  }
+
+  void check(const std::string &name, double error, double threshold)
+  {
+    std::cout << name << " max error: " << error << std::endl;
+    if (! (error < threshold)) {
+      throw vpException(vpException::fatalError, "Batched %s differs from the per configuration one", name.c_str());
+    }
+  }
+}
+
+int main()
+{
+  try {
+    vpAfma6 robot;
+
+    // Kinematics of known joint positions
+    checkReferences(robot);
+
+    vpColVector qmin = robot.getJointMin();
+    vpColVector qmax = robot.getJointMax();
+
+    // Random joint positions, slightly inside the joint limits
+    const unsigned int n = 2000;
+    vpUniRand rand(42);
+    vpMatrix Q(6, n);
+    for (unsigned int k=0; k<n; k++)
+      for (unsigned int j=0; j<6; j++)
+        Q[j][k] = qmin[j] + 0.1 + (qmax[j] - qmin[j] - 0.2)*rand();
+
+    std::vector<vpHomogeneousMatrix> fMc;
+    std::vector<vpMatrix> fJe, eJe;
+    double t = vpTime::measureTimeMs();
+    robot.get_fMc(Q, fMc);
+    robot.get_fJe(Q, fJe);
+    robot.get_eJe(Q, eJe);
+    double t_batch = vpTime::measureTimeMs() - t;
+
+    double err_fMc = 0, err_fJe = 0, err_eJe = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k=0; k<n; k++) {
+      vpColVector q = Q.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(M, fMc[k]));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(J, fJe[k]));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(J, eJe[k]));
+    }
+    double t_single = vpTime::measureTimeMs() - t;
+    std::cout << "Forward kinematics and jacobians of " << n << " configurations: "
+              << t_batch << " ms batched, " << t_single << " ms one by one" << std::endl;
+    check("fMc", err_fMc, 1e-12);
+    check("fJe", err_fJe, 1e-12);
+    check("eJe", err_eJe, 1e-12);
+
+    // Inverse kinematics from joint positions close to the ones of the poses
+    vpMatrix Qik(6, n);
+    for (unsigned int k=0; k<n; k++)
+      for (unsigned int j=0; j<6; j++)
+        Qik[j][k] = Q[j][k] + 0.05*(rand() - 0.5);
+    vpMatrix Qik_batch = Qik;
+    std::vector<int> nbSol;
+    std::vector<vpMatrix> solutions;
+    t = vpTime::measureTimeMs();
+    robot.getInverseKinematics(fMc, Qik_batch, nbSol);
+    t_batch = vpTime::measureTimeMs() - t;
+    robot.getInverseKinematicsSolutions(fMc, Qik, solutions);
+
+    double err_ik = 0, err_sol = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k=0; k<n; k++) {
+      vpColVector q = Qik.getCol(k);
+      int nbsol = robot.getInverseKinematics(fMc[k], q);
+      if (nbsol != nbSol[k] || nbsol != (int)solutions[k].getCols()) {
+        throw vpException(vpException::fatalError, "Wrong number of solutions for pose %d", k);
+      }
+      if (nbsol == 0)
+        continue;
+      err_ik = (std::max)(err_ik, maxDifference(q, Qik_batch.getCol(k)));
+      err_sol = (std::max)(err_sol, maxDifference(q, solutions[k].getCol(0)));
+    }
+    t_single = vpTime::measureTimeMs() - t;
+    std::cout << "Inverse kinematics of " << n << " poses: "
+              << t_batch << " ms batched, " << t_single << " ms one by one" << std::endl;
+    check("inverse kinematics", err_ik, 1e-9);
+    check("nearest solution", err_sol, 1e-9);
+
+    return 0;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the batched kinematics of the Viper 850 robot.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testViperBatchKinematics.cpp
+
+  Check that the forward kinematics, the jacobians and the inverse kinematics
+  of the Viper 850 computed for a batch of joint positions match the ones
+  computed for each joint position, and with reference values computed for a
+  few joint positions, and print the computation times.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/robot/vpViper850.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+  /*
+    Kinematics of a few joint positions computed with the per configuration
+    code of ViSP 3.0.1, before it was shared with the batched code.
+  */
+  struct vpReference
+  {
+    double q[6];
+    double fMc[12];
+    double fJe[36];
+    double eJe[36];
+    double qik[6];
+  };
+
+  const vpReference references[] = {
+    {
+      // Joint positions
+      {0, -1.265, 1.981, 0, 0, 0},
+      // fMc
+      {-0.0120444526748, 0.739490680379, 0.673059035147, 0.468266822177,
+       -0.99989991393, -0.0139036565791, -0.00261733761436, -0.0013,
+       0.00742248490894, -0.673023195712, 0.739584129597, 1.21537813815},
+      // fJe
+      {0, 0.849693129403, 0.501626385094, 0, 0.137005803939, 0,
+       0.502012788429, 0, 0, 0, 0, 0,
+       0, -0.427012788429, -0.317128569791, 0, -0.119197188252, 0,
+       0, 0, 0, 0.656372182004, 0, 0.656372182004,
+       0, 1, 1, 0, 1, 0,
+       1, 0, 0, 0.754437246358, 0, 0.754437246358},
+      // eJe
+      {0, 0.921319460481, 0.5866, 0, 0.1816, 0,
+       0.502012788429, 0, 0, 0, 0, 0,
+       0, 0.235560581118, 0.09, 0, 0, 0,
+       -0.656372182004, 0, 0, 0, 0, 0,
+       0, 1, 1, 0, 1, 0,
+       0.754437246358, 0, 0, 1, 0, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {0, -1.265, 1.981, 0.02, 0, 0},
+    },
+    {
+      // Joint positions
+      {-1.187, -0.855, 1.732, 1.326, -0.628, -3.77},
+      // fMc
+      {0.560272196422, -0.752892572579, -0.345322805606, 0.188353583178,
+       0.390410884981, 0.607720053322, -0.69156032107, -0.682122423909,
+       0.73053022306, 0.252644237904, 0.634426104641, 1.04232972928},
+      // fJe
+      {0.655183184284, 0.268642217244, 0.165513647819, 0.000808328425174, 0.171441521201, 0,
+       0.152941401632, -0.665250102394, -0.409868457345, -0.0710601216419, -0.0437950054437, 0,
+       0, -0.589786367741, -0.350266611686, -0.0795840967688, 0.0408455910284, 0,
+       0, 0.927249811648, 0.927249811648, 0.28788098264, -0.00757606668778, -0.329683148138,
+       0, 0.374443302516, 0.374443302516, -0.712891872111, 0.666011739331, -0.705881923104,
+       1, 0, 0, 0.639460490189, 0.745902786083, 0.626928809729},
+      // eJe
+      {-0.413572264707, -0.747903687352, -0.457429760806, -0.0627214128629, -0.146908005252, 0,
+       -0.420313042802, 0.550533763815, 0.329547909075, 0.0863124968333, -0.106754849974, 0,
+       -0.323961425508, 0.0112671441974, 0.0151594444654, 0, 0, 0,
+       0.25653136119, -0.492629078459, -0.492629078459, -0.475289079478, 0.587857103378, 0,
+       -0.735630293189, -0.657574026305, -0.657574026305, -0.345382229421, -0.80896478663, 0,
+       0.626928809729, -0.570011395488, -0.570011395488, 0.809204180988, 0, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {-1.187, -0.855, 1.732, 1.326, -0.628, 2.51318530718},
+    },
+    {
+      // Joint positions
+      {1.78, -2.291, 2.478, -2.321, 0.628, 5.027},
+      // fMc
+      {-0.836669573091, -0.293300263671, 0.462557002751, 0.134414321331,
+       0.241293866801, -0.955544589441, -0.169445588414, -0.157919155019,
+       0.491692277047, -0.030157800311, 0.870246638472, 1.18425733632},
+      // fJe
+      {0.201950280775, -0.175894383132, -0.118915009759, 0.0552298247162, 0.12972272999, 0,
+       0.122668555985, 0.82847871208, 0.560100626169, 0.0901272532153, -0.0933738581715, 0,
+       0, 0.298023007971, 0.0572917179146, -0.0145109417612, -0.0862084446802, 0,
+       0, -0.978196606808, -0.978196606808, -0.0386103980191, 0.517642114483, 0.470931130768,
+       0, -0.207681001609, -0.207681001609, 0.181858523588, 0.844718631043, -0.148581042417,
+       1, 0, 0, 0.982566391937, -0.136003954657, 0.86956744644},
+      // eJe
+      {-0.172818359489, -0.754836264519, -0.507780444527, -0.101458068793, 0.0561955037689, 0,
+       0.141615707988, -0.483242476239, -0.255542787465, 0.0330164052856, 0.172686494423, 0,
+       0.0768784521643, 0.0532207346158, -0.0894021020566, 0, 0, 0,
+       -0.0175708398348, 0.465139318848, 0.465139318848, -0.18180839915, -0.950916819511, 0,
+       -0.493501491061, -0.773894314692, -0.773894314692, -0.558689806127, 0.309446606657, 0,
+       0.86956744644, -0.429805774448, -0.429805774448, 0.809204180988, 0, 1},
+      // Nearest inverse kinematics solution from the joint positions shifted by +/-0.02
+      {1.78, -2.291, 2.478, -2.321, 0.628, -1.25618530718},
+    }
+  };
+
+  double maxDifference(const double *ref, const double *v, unsigned int n)
+  {
+    double d = 0;
+    for (unsigned int i=0; i<n; i++)
+      d = (std::max)(d, std::fabs(ref[i] - v[i]));
+    return d;
+  }
+
+  void checkReference(const std::string &name, double error)
+  {
+    std::cout << name << " max error with the reference values: " << error << std::endl;
+    if (! (error < 1e-9)) {
+      throw vpException(vpException::fatalError, "%s differs from the reference values", name.c_str());
+    }
+  }
+
+  /*
+    Compare the batched and the per configuration kinematics with the
+    reference values. The inverse kinematics starts from the joint positions
+    shifted by +/-0.02.
+  */
+  void checkReferences(const vpViper &robot)
+  {
+    const unsigned int n = sizeof(references) / sizeof(references[0]);
+    vpMatrix Q(6, n), Qik(6, n);
+    for (unsigned int k=0; k<n; k++) {
+      for (unsigned int j=0; j<6; j++) {
+        Q[j][k] = references[k].q[j];
+        Qik[j][k] = references[k].q[j] + ((j % 2) ? 0.02 : -0.02);
+      }
+    }
+
+    std::vector<vpHomogeneousMatrix> fMc;
+    std::vector<vpMatrix> fJe, eJe;
+    std::vector<unsigned int> nbSol;
+    vpMatrix Qik_batch = Qik;
+    robot.get_fMc(Q, fMc);
+    robot.get_fJe(Q, fJe);
+    robot.get_eJe(Q, eJe);
+    robot.getInverseKinematics(fMc, Qik_batch, nbSol);
+
+    double err_fMc = 0, err_fJe = 0, err_eJe = 0, err_ik = 0;
+    for (unsigned int k=0; k<n; k++) {
+      const vpReference &ref = references[k];
+      vpColVector q = Q.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, M.data, 12));
+      err_fMc = (std::max)(err_fMc, maxDifference(ref.fMc, fMc[k].data, 12));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, J.data, 36));
+      err_fJe = (std::max)(err_fJe, maxDifference(ref.fJe, fJe[k].data, 36));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, J.data, 36));
+      err_eJe = (std::max)(err_eJe, maxDifference(ref.eJe, eJe[k].data, 36));
+
+      vpColVector qik = Qik.getCol(k);
+      if (robot.getInverseKinematics(M, qik) == 0 || nbSol[k] == 0) {
+        throw vpException(vpException::fatalError, "No inverse kinematics solution for reference %d", k);
+      }
+      err_ik = (std::max)(err_ik, maxDifference(ref.qik, qik.data, 6));
+      err_ik = (std::max)(err_ik, maxDifference(ref.qik, Qik_batch.getCol(k).data, 6));
+    }
+    checkReference("fMc", err_fMc);
+    checkReference("fJe", err_fJe);
+    checkReference("eJe", err_eJe);
+    checkReference("inverse kinematics", err_ik);
+  }
+
+  double maxDifference(const vpArray2D<double> &A, const vpArray2D<double> &B)
+  {
+    double d = 0;
+    for (unsigned int i=0; i<A.size(); i++)
+      d = (std::max)(d, std::fabs(A.data[i] - B.data[i]));
+    return d;
+  }
+
+  void check(const std::string &name, double error, double threshold)
+  {
+    std::cout << name << " max error: " << error << std::endl;
+    if (! (error < threshold)) {
+      throw vpException(vpException::fatalError, "Batched %s differs from the per configuration one", name.c_str());
+    }
+  }
+}
+
+int main()
+{
+  try {
+    vpViper850 robot;
+
+    // Kinematics of known joint positions
+    checkReferences(robot);
+
+    vpColVector qmin = robot.getJointMin();
+    vpColVector qmax = robot.getJointMax();
+
+    // Random joint positions, slightly inside the joint limits
+    const unsigned int n = 2000;
+    vpUniRand rand(42);
+    vpMatrix Q(6, n);
+    for (unsigned int k=0; k<n; k++)
+      for (unsigned int j=0; j<6; j++)
+        Q[j][k] = qmin[j] + 0.1 + (qmax[j] - qmin[j] - 0.2)*rand();
+
+    std::vector<vpHomogeneousMatrix> fMc;
+    std::vector<vpMatrix> fJe, eJe;
+    double t = vpTime::measureTimeMs();
+    robot.get_fMc(Q, fMc);
+    robot.get_fJe(Q, fJe);
+    robot.get_eJe(Q, eJe);
+    double t_batch = vpTime::measureTimeMs() - t;
+
+    double err_fMc = 0, err_fJe = 0, err_eJe = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k=0; k<n; k++) {
+      vpColVector q = Q.getCol(k);
+      vpHomogeneousMatrix M;
+      vpMatrix J;
+      robot.get_fMc(q, M);
+      err_fMc = (std::max)(err_fMc, maxDifference(M, fMc[k]));
+      robot.get_fJe(q, J);
+      err_fJe = (std::max)(err_fJe, maxDifference(J, fJe[k]));
+      robot.get_eJe(q, J);
+      err_eJe = (std::max)(err_eJe, maxDifference(J, eJe[k]));
+    }
+    double t_single = vpTime::measureTimeMs() - t;
+    std::cout << "Forward kinematics and jacobians of " << n << " configurations: "
+              << t_batch << " ms batched, " << t_single << " ms one by one" << std::endl;
+    check("fMc", err_fMc, 1e-12);
+    check("fJe", err_fJe, 1e-12);
+    check("eJe", err_eJe, 1e-12);
+
+    // Inverse kinematics from joint positions close to the ones of the poses
+    vpMatrix Qik(6, n);
+    for (unsigned int k=0; k<n; k++)
+      for (unsigned int j=0; j<6; j++)
+        Qik[j][k] = Q[j][k] + 0.05*(rand() - 0.5);
+    vpMatrix Qik_batch = Qik;
+    std::vector<unsigned int> nbSol;
+    std::vector<vpMatrix> solutions;
+    t = vpTime::measureTimeMs();
+    robot.getInverseKinematics(fMc, Qik_batch, nbSol);
+    t_batch = vpTime::measureTimeMs() - t;
+    robot.getInverseKinematicsSolutions(fMc, Qik, solutions);
+
+    double err_ik = 0, err_sol = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k=0; k<n; k++) {
+      vpColVector q = Qik.getCol(k);
+      unsigned int nbsol = robot.getInverseKinematics(fMc[k], q);
+      if (nbsol != nbSol[k] || nbsol != solutions[k].getCols()) {
+        throw vpException(vpException::fatalError, "Wrong number of solutions for pose %d", k);
+      }
+      if (nbsol == 0)
+        continue;
+      err_ik = (std::max)(err_ik, maxDifference(q, Qik_batch.getCol(k)));
+      err_sol = (std::max)(err_sol, maxDifference(q, solutions[k].getCol(0)));
+    }
+    t_single = vpTime::measureTimeMs() - t;
+    std::cout << "Inverse kinematics of " << n << " poses: "
+              << t_batch << " ms batched, " << t_single << " ms one by one" << std::endl;
+    check("inverse kinematics", err_ik, 1e-9);
+    check("nearest solution", err_sol, 1e-9);
+
+    return 0;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return 1;
+  }
+}
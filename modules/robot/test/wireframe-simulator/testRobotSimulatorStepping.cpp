@@ -0,0 +1,286 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the stepping mode of the robot simulators.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRobotSimulatorStepping.cpp
+
+  Test the stepping mode of the Viper 850 and Afma6 simulators. Check that
+  the joint positions follow exactly the applied velocities, that a position
+  based visual servoing converges and gives the same trajectory when it is
+  run twice, and print the number of control iterations simulated per second.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpThetaUVector.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/robot/vpSimulatorAfma6.h>
+#include <visp3/robot/vpSimulatorViper850.h>
+
+#include <stdlib.h>
+#include <iostream>
+
+// List of allowed command line options
+#define GETOPTARGS  "cdn:h"
+
+void usage(const char *name, const char *badparam, unsigned int nbIter)
+{
+  fprintf(stdout, "\n\
+Test the stepping mode of the robot simulators.\n\
+\n\
+SYNOPSIS\n\
+  %s [-n <number of iterations>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -n <number of iterations>                            %u\n\
+     Number of visual servoing iterations.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", nbIter);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, unsigned int &nbIter)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'n': nbIter = (unsigned int) atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, nbIter); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, nbIter); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbIter);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+#if defined(VISP_HAVE_MODULE_GUI) && (defined(_WIN32) || defined(VISP_HAVE_PTHREAD))
+
+bool isEqual(const vpColVector &a, const vpColVector &b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (unsigned int i = 0; i < a.size(); i++) {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
+template <class Robot>
+bool testJointVelocity(Robot &robot)
+{
+  const double dt = 0.02;
+  const unsigned int nbSteps = 50;
+  robot.setSteppingMode(true);
+  robot.setSamplingTime(dt);
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+
+  vpColVector q0, q, qdot(6);
+  qdot[0] = 0.01; qdot[1] = -0.02; qdot[2] = 0.01;
+  qdot[3] = 0.05; qdot[4] = -0.03; qdot[5] = 0.02;
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q0);
+  for (unsigned int i = 0; i < nbSteps; i++)
+    robot.setVelocity(vpRobot::ARTICULAR_FRAME, qdot);
+
+  double timestamp;
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q, timestamp);
+  if (std::fabs(timestamp - nbSteps * dt) > 1e-9) {
+    std::cerr << "Bad simulated time: " << timestamp << " instead of " << nbSteps * dt << std::endl;
+    return false;
+  }
+  vpColVector err = q - (q0 + nbSteps * dt * qdot);
+  if (err.infinityNorm() > 1e-9) {
+    std::cerr << "Bad joint position after " << nbSteps << " steps: " << q.t() << std::endl;
+    return false;
+  }
+
+  // The robot does not move anymore once stopped
+  robot.setRobotState(vpRobot::STATE_STOP);
+  robot.step();
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q0);
+  if (! isEqual(q0, q)) {
+    std::cerr << "The robot moves after being stopped" << std::endl;
+    return false;
+  }
+
+  // Positioning is done by stepping
+  vpColVector qd = q;
+  qd[0] += 0.02; qd[3] += 0.1;
+  robot.setRobotState(vpRobot::STATE_POSITION_CONTROL);
+  robot.setPosition(vpRobot::ARTICULAR_FRAME, qd);
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+  if ((q - qd).infinityNorm() > 1e-9) {
+    std::cerr << "Position " << qd.t() << " not reached: " << q.t() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+template <class Robot>
+double servo(Robot &robot, unsigned int nbIter, vpColVector &q)
+{
+  robot.setSteppingMode(true);
+  robot.setSamplingTime(0.02);
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+
+  vpHomogeneousMatrix cdMo(0, 0, 0.5, 0, 0, 0);
+  robot.initialiseObjectRelativeToCamera(vpHomogeneousMatrix(0.05, -0.04, 0.6, vpMath::rad(8), vpMath::rad(-6), vpMath::rad(15)));
+
+  const double lambda = 1.;
+  vpColVector v(6), err(6);
+  for (unsigned int iter = 0; iter < nbIter; iter++) {
+    vpHomogeneousMatrix cdMc = cdMo * robot.get_cMo().inverse();
+    vpRotationMatrix cdRc;
+    vpTranslationVector cdtc;
+    cdMc.extract(cdRc);
+    cdMc.extract(cdtc);
+    vpThetaUVector cdtuc(cdRc);
+    vpTranslationVector vt = cdRc.t() * cdtc;
+    for (unsigned int i = 0; i < 3; i++) {
+      v[i] = -lambda * vt[i];
+      v[i+3] = -lambda * cdtuc[i];
+      err[i] = cdtc[i];
+      err[i+3] = cdtuc[i];
+    }
+    robot.setVelocity(vpRobot::CAMERA_FRAME, v);
+  }
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+  return err.euclideanNorm();
+}
+
+template <class Robot>
+bool testServo(const std::string &name, unsigned int nbIter)
+{
+  vpColVector q1, q2;
+  double err1, err2, t;
+  // The wire frame simulators share global data and cannot coexist
+  {
+    Robot robot(false);
+    t = vpTime::measureTimeMs();
+    err1 = servo(robot, nbIter, q1);
+    t = vpTime::measureTimeMs() - t;
+  }
+  {
+    Robot robot(false);
+    err2 = servo(robot, nbIter, q2);
+  }
+
+  std::cout << name << ": " << nbIter << " iterations (" << nbIter * 0.02
+            << " s simulated) in " << t << " ms, final error " << err1 << std::endl;
+
+  if (! isEqual(q1, q2) || err1 != err2) {
+    std::cerr << name << ": the trajectories of two identical runs differ" << std::endl;
+    return false;
+  }
+  if (nbIter >= 200 && err1 > 1e-3) {
+    std::cerr << name << ": the visual servoing does not converge" << std::endl;
+    return false;
+  }
+  return true;
+}
+#endif
+
+int main(int argc, const char ** argv)
+{
+  try {
+    unsigned int nbIter = 500;
+
+    if (getOptions(argc, argv, nbIter) == false) {
+      exit (-1);
+    }
+
+#if defined(VISP_HAVE_MODULE_GUI) && (defined(_WIN32) || defined(VISP_HAVE_PTHREAD))
+    {
+      vpSimulatorViper850 robot(false);
+      if (! testJointVelocity(robot))
+        return EXIT_FAILURE;
+    }
+    {
+      vpSimulatorAfma6 robot(false);
+      if (! testJointVelocity(robot))
+        return EXIT_FAILURE;
+    }
+    {
+      // step() is only allowed in stepping mode
+      vpSimulatorViper850 robot(false);
+      bool thrown = false;
+      try {
+        robot.step();
+      }
+      catch(const vpRobotException &) {
+        thrown = true;
+      }
+      if (! thrown) {
+        std::cerr << "step() should throw when the stepping mode is disabled" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (! testServo<vpSimulatorViper850>("Viper850", nbIter))
+      return EXIT_FAILURE;
+    if (! testServo<vpSimulatorAfma6>("Afma6", nbIter))
+      return EXIT_FAILURE;
+
+    std::cout << "testRobotSimulatorStepping is ok" << std::endl;
+#else
+    std::cout << "The robot simulators require the gui module and threading capabilities" << std::endl;
+#endif
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,400 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test headless batch rendering of the wire frame simulator.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testWireFrameSimulatorBatch.cpp
+
+  Test the headless rendering of the wire frame simulator internal view.
+  Check that the parallel batch rendering gives the same images than the
+  frame by frame rendering and than the overlay rendering of
+  getInternalImage(), and print the number of frames rendered per second.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/gui/vpDisplayOffscreen.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/robot/vpImageSimulator.h>
+#include <visp3/robot/vpWireFrameSimulator.h>
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+// List of allowed command line options
+#define GETOPTARGS  "cdn:h"
+
+void usage(const char *name, const char *badparam, unsigned int nbPoses)
+{
+  fprintf(stdout, "\n\
+Test headless batch rendering of the wire frame simulator.\n\
+\n\
+SYNOPSIS\n\
+  %s [-n <number of poses>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -n <number of poses>                                 %u\n\
+     Number of camera poses to render.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", nbPoses);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, unsigned int &nbPoses)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'n': nbPoses = (unsigned int) atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, nbPoses); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, nbPoses); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbPoses);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template <class Type>
+bool testBatch(vpWireFrameSimulator &sim, const std::vector<vpHomogeneousMatrix> &list_cMo)
+{
+  std::vector<vpImage<Type> > Iserial(list_cMo.size(), vpImage<Type>(240, 320));
+  std::vector<vpImage<Type> > Ibatch(list_cMo.size(), vpImage<Type>(240, 320));
+
+  double t_serial = vpTime::measureTimeMs();
+  for (size_t i = 0; i < list_cMo.size(); i++)
+    sim.renderInternalImage(Iserial[i], list_cMo[i]);
+  t_serial = vpTime::measureTimeMs() - t_serial;
+
+  double t_batch = vpTime::measureTimeMs();
+  sim.renderInternalImages(list_cMo, Ibatch);
+  t_batch = vpTime::measureTimeMs() - t_batch;
+
+  std::cout << "Serial rendering: " << t_serial << " ms ("
+            << 1000. * list_cMo.size() / vpMath::maximum(t_serial, 1e-3) << " fps)" << std::endl;
+  std::cout << "Batch rendering: " << t_batch << " ms ("
+            << 1000. * list_cMo.size() / vpMath::maximum(t_batch, 1e-3) << " fps)" << std::endl;
+
+  for (size_t i = 0; i < list_cMo.size(); i++) {
+    if (Iserial[i] != Ibatch[i]) {
+      std::cerr << "Batch and serial rendering differ for pose " << i << std::endl;
+      return false;
+    }
+  }
+
+  // The object must be visible in the first view
+  unsigned int nbDrawn = 0;
+  for (unsigned int i = 0; i < Iserial[0].getSize(); i++) {
+    if (Iserial[0].bitmap[i] != Type(255))
+      nbDrawn++;
+  }
+  if (nbDrawn == 0) {
+    std::cerr << "Nothing was rendered in the first view" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Check that the image is drawn (or not) around the pixel (i, j)
+template <class Type>
+bool isDrawnAround(vpImage<Type> &I, int i, int j)
+{
+  for (int di = -1; di <= 1; di++) {
+    for (int dj = -1; dj <= 1; dj++) {
+      if (I[(unsigned int)(i + di)][(unsigned int)(j + dj)] != Type(255))
+        return true;
+    }
+  }
+  return false;
+}
+
+/*
+  Render the plate (a 40 cm square) seen from a known pose and check the
+  position of its corners. Like in getInternalImage(), the internal view is
+  rotated by 180 degrees around the optical axis: with the plate at 1 meter
+  and shifted by (0.05, 0) the corners are projected at u in {60, 220} and
+  v in {40, 200} instead of u in {100, 260}.
+*/
+template <class Type>
+bool testProjection()
+{
+  vpWireFrameSimulator sim;
+  sim.initScene(vpWireFrameSimulator::PLATE, vpWireFrameSimulator::D_STANDARD);
+  sim.setInternalCameraParameters(vpCameraParameters(400, 400, 160, 120));
+  // Desired object out of the field of view
+  sim.setDesiredCameraPosition(vpHomogeneousMatrix(10, 0, 1, 0, 0, 0));
+
+  vpImage<Type> I(240, 320);
+  sim.renderInternalImage(I, vpHomogeneousMatrix(0.05, 0, 1, 0, 0, 0));
+
+  const int corners[4][2] = { {40, 100}, {40, 260}, {200, 100}, {200, 260} };
+  for (unsigned int k = 0; k < 4; k++) {
+    if (! isDrawnAround(I, corners[k][0], corners[k][1])) {
+      std::cerr << "Plate corner not rendered at (" << corners[k][0] << ", " << corners[k][1] << ")" << std::endl;
+      return false;
+    }
+  }
+  if (isDrawnAround(I, 40, 60) || isDrawnAround(I, 200, 60)) {
+    std::cerr << "Plate rendered with a rotation around the optical axis" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Wire frame pixels are colored, the background and the texture are grey
+bool isWire(const vpRGBa &c)
+{
+  return c.R != c.G || c.G != c.B;
+}
+
+bool sameColor(const vpRGBa &c1, const vpRGBa &c2)
+{
+  return c1.R == c2.R && c1.G == c2.G && c1.B == c2.B;
+}
+
+// Check that the wire frame pixel (i, j) of I1 has a wire frame pixel, of the
+// same color if required, in a 3x3 neighborhood in I2
+bool hasNeighbor(const vpImage<vpRGBa> &I1, const vpImage<vpRGBa> &I2, int i, int j, bool checkColor)
+{
+  for (int di = -1; di <= 1; di++) {
+    for (int dj = -1; dj <= 1; dj++) {
+      int k = i + di, l = j + dj;
+      if (k >= 0 && l >= 0 && k < (int)I2.getHeight() && l < (int)I2.getWidth() && isWire(I2[k][l])
+          && (! checkColor || sameColor(I2[k][l], I1[i][j])))
+        return true;
+    }
+  }
+  return false;
+}
+
+// Check that the pixel (i, j) is far from the wire frame in both images
+bool isFarFromWire(const vpImage<vpRGBa> &I1, const vpImage<vpRGBa> &I2, int i, int j)
+{
+  for (int di = -2; di <= 2; di++) {
+    for (int dj = -2; dj <= 2; dj++) {
+      int k = i + di, l = j + dj;
+      if (k >= 0 && l >= 0 && k < (int)I1.getHeight() && l < (int)I1.getWidth() && (isWire(I1[k][l]) || isWire(I2[k][l])))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Check that the pixel (i, j) is on the image simulator border, where the
+// rounding errors of the poses given to the image simulators may change the
+// pixel
+bool isOnTextureBorder(const vpImage<vpRGBa> &I, int i, int j)
+{
+  bool background = false, texture = false;
+  for (int di = -1; di <= 1; di++) {
+    for (int dj = -1; dj <= 1; dj++) {
+      int k = i + di, l = j + dj;
+      if (k >= 0 && l >= 0 && k < (int)I.getHeight() && l < (int)I.getWidth()) {
+        if (sameColor(I[k][l], vpRGBa(255, 255, 255)))
+          background = true;
+        else
+          texture = true;
+      }
+    }
+  }
+  return background && texture;
+}
+
+/*
+  Compare the batch rendering with the overlay rendering of getInternalImage()
+  for the same camera and desired poses, with the object, the desired object
+  and a textured image simulator in view. The two renderings project and
+  rasterize the segments independently, so that the wire frame pixels may be
+  shifted by one pixel, and the image simulator pixels have to be equal away
+  from the wire frame and from the image simulator border.
+*/
+bool testOverlay(const std::vector<vpHomogeneousMatrix> &list_cMo)
+{
+  vpImage<vpRGBa> texture(100, 100);
+  for (unsigned int i = 0; i < texture.getHeight(); i++) {
+    for (unsigned int j = 0; j < texture.getWidth(); j++) {
+      unsigned char g = (unsigned char)(((i / 10 + j / 10) % 2) ? 60 + i : 160 + j / 2);
+      texture[i][j] = vpRGBa(g, g, g);
+    }
+  }
+  vpColVector X[4];
+  const double corners[4][2] = { {-0.15, -0.15}, {0.15, -0.15}, {0.15, 0.15}, {-0.15, 0.15} };
+  for (unsigned int k = 0; k < 4; k++) {
+    X[k].resize(3);
+    X[k][0] = corners[k][0];
+    X[k][1] = corners[k][1];
+    X[k][2] = 0;
+  }
+  vpImageSimulator imsim;
+  imsim.init(texture, X);
+  std::list<vpImageSimulator> imObj;
+  imObj.push_back(imsim);
+
+  vpWireFrameSimulator sim;
+  sim.initScene(vpWireFrameSimulator::PLATE, vpWireFrameSimulator::D_STANDARD, imObj);
+  sim.setInternalCameraParameters(vpCameraParameters(400, 400, 160, 120));
+  vpHomogeneousMatrix cdMo(0.02, -0.01, 0.7, vpMath::rad(5), 0, vpMath::rad(20));
+  sim.setDesiredCameraPosition(cdMo);
+
+  std::vector<vpImage<vpRGBa> > Ibatch(list_cMo.size(), vpImage<vpRGBa>(240, 320));
+  sim.renderInternalImages(list_cMo, Ibatch);
+
+  vpImage<vpRGBa> I(240, 320);
+  vpDisplayOffscreen d(I);
+  const vpImage<vpRGBa> &Ioverlay = d.getCanvas();
+  for (size_t n = 0; n < list_cMo.size(); n++) {
+    sim.setCameraPositionRelObj(list_cMo[n]);
+    sim.setDesiredCameraPosition(cdMo);
+    sim.getInternalImage(I);
+
+    const vpImage<vpRGBa> &Ib = Ibatch[n];
+    unsigned int nbWire = 0, nbWrongColor = 0, nbTexture = 0;
+    for (int i = 0; i < (int)I.getHeight(); i++) {
+      for (int j = 0; j < (int)I.getWidth(); j++) {
+        if (isWire(Ib[i][j])) {
+          nbWire++;
+          if (! hasNeighbor(Ib, Ioverlay, i, j, false)) {
+            std::cerr << "Pose " << n << ": rendered pixel (" << i << ", " << j << ") not in the overlay" << std::endl;
+            return false;
+          }
+          if (! hasNeighbor(Ib, Ioverlay, i, j, true))
+            nbWrongColor++;
+        }
+        if (isWire(Ioverlay[i][j])) {
+          if (! hasNeighbor(Ioverlay, Ib, i, j, false)) {
+            std::cerr << "Pose " << n << ": overlay pixel (" << i << ", " << j << ") not rendered" << std::endl;
+            return false;
+          }
+          if (! hasNeighbor(Ioverlay, Ib, i, j, true))
+            nbWrongColor++;
+        }
+        if (isFarFromWire(Ib, Ioverlay, i, j) && ! isOnTextureBorder(Ib, i, j)) {
+          if (! sameColor(Ib[i][j], Ioverlay[i][j])) {
+            std::cerr << "Pose " << n << ": different image simulator pixel (" << i << ", " << j << ")" << std::endl;
+            return false;
+          }
+          if (! sameColor(Ib[i][j], vpRGBa(255, 255, 255)))
+            nbTexture++;
+        }
+      }
+    }
+    // The color may only differ where a segment hides the other object in one
+    // of the images
+    if (100 * nbWrongColor > nbWire) {
+      std::cerr << "Pose " << n << ": " << nbWrongColor << " pixels of the wire frame have a different color" << std::endl;
+      return false;
+    }
+    if (nbWire == 0 || nbTexture == 0) {
+      std::cerr << "Pose " << n << ": the wire frame or the image simulator is not in view" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, const char ** argv)
+{
+  try {
+    unsigned int nbPoses = 500;
+
+    if (getOptions(argc, argv, nbPoses) == false) {
+      exit (-1);
+    }
+
+    std::cout << "Check the projection of the plate" << std::endl;
+    if (! testProjection<unsigned char>() || ! testProjection<vpRGBa>())
+      return EXIT_FAILURE;
+
+    std::cout << "Compare with the overlay rendering" << std::endl;
+    std::vector<vpHomogeneousMatrix> list_cMo_overlay;
+    for (unsigned int i = 0; i < 8; i++) {
+      double t = i / 8.;
+      list_cMo_overlay.push_back(vpHomogeneousMatrix(0.03 * cos(2 * M_PI * t), 0.03 * sin(2 * M_PI * t), 0.6 + t,
+                                                     vpMath::rad(10 * sin(2 * M_PI * t)), vpMath::rad(5), vpMath::rad(45 * t)));
+    }
+    if (! testOverlay(list_cMo_overlay))
+      return EXIT_FAILURE;
+
+    vpWireFrameSimulator sim;
+    sim.initScene(vpWireFrameSimulator::PLATE, vpWireFrameSimulator::D_STANDARD);
+    sim.setInternalCameraParameters(vpCameraParameters(400, 400, 160, 120));
+    sim.setDesiredCameraPosition(vpHomogeneousMatrix(0, 0, 0.5, 0, 0, 0));
+
+    std::vector<vpHomogeneousMatrix> list_cMo(nbPoses);
+    for (unsigned int i = 0; i < nbPoses; i++) {
+      double t = (double)i / vpMath::maximum(nbPoses, 1u);
+      list_cMo[i].buildFrom(0.05 * cos(2 * M_PI * t), 0.05 * sin(2 * M_PI * t), 0.5 + 0.3 * t,
+                            vpMath::rad(10 * sin(4 * M_PI * t)), vpMath::rad(10 * cos(4 * M_PI * t)), vpMath::rad(90 * t));
+    }
+
+    std::cout << "Render " << nbPoses << " grey level views" << std::endl;
+    if (! testBatch<unsigned char>(sim, list_cMo))
+      return EXIT_FAILURE;
+
+    std::cout << "Render " << nbPoses << " color views" << std::endl;
+    if (! testBatch<vpRGBa>(sim, list_cMo))
+      return EXIT_FAILURE;
+
+    std::cout << "testWireFrameSimulatorBatch is ok" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Depth image filtering.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthFilter.h
+  \brief Decimation, edge-preserving filtering and hole filling of depth images.
+*/
+
+#ifndef vpDepthFilter_h
+#define vpDepthFilter_h
+
+#include <stdint.h>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpDepthFilter
+
+  \ingroup group_sensor_rgbd
+
+  \brief Post-processing of depth images acquired by RGB-D sensors.
+
+  Depth images are given either as vpImage<uint16_t> in sensor units (as
+  acquired by vpRealSense) or as vpImage<float> in meter (as acquired by
+  vpKinect). A pixel without depth measurement, that is a hole, is a pixel
+  with a null value, or for float images a negative (vpKinect uses -1) or NaN
+  value.
+
+  The following filters are available. They can be chained and do not need
+  any device, so that they can also be applied on recorded depth images:
+  - decimate() reduces the resolution by taking the median of the valid
+    depth values of each block of pixels;
+  - spatialFilter() smooths the depth along the rows and the columns with a
+    recursive filter that stops at depth discontinuities;
+  - temporalFilter() smooths the depth of each pixel over the successive
+    frames, keeps the edges and can fill the holes of a pixel with its last
+    valid depth;
+  - fillHoles() fills the holes of each row from their valid neighbours.
+
+  The filters use SSE2 when available and OpenMP when ViSP is built with
+  OpenMP support.
+
+  \code
+#include <visp3/sensor/vpDepthFilter.h>
+
+int main()
+{
+  vpImage<uint16_t> depth(480, 640), depth_low;
+  vpDepthFilter filter;
+  filter.setTemporalFilterParameters(0.4f, 20.f, 3);
+
+  for (;;) {
+    // Acquire depth...
+    vpDepthFilter::decimate(depth, depth_low, 2);
+    vpDepthFilter::spatialFilter(depth_low, 0.5f, 20.f);
+    filter.temporalFilter(depth_low);
+    vpDepthFilter::fillHoles(depth_low, vpDepthFilter::HOLE_FILLING_FARTHEST);
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpDepthFilter
+{
+public:
+  //! Method used to fill the holes of a depth image.
+  typedef enum {
+    HOLE_FILLING_LEFT,     /*!< Use the valid depth on the left of the hole. */
+    HOLE_FILLING_NEAREST,  /*!< Use the nearest to the sensor of the valid depths on the left and the right of the hole. */
+    HOLE_FILLING_FARTHEST  /*!< Use the farthest from the sensor of the valid depths on the left and the right of the hole. */
+  } vpHoleFillingType;
+
+  vpDepthFilter();
+  virtual ~vpDepthFilter();
+
+  static void decimate(const vpImage<uint16_t> &I, vpImage<uint16_t> &Idec, unsigned int factor);
+  static void decimate(const vpImage<float> &I, vpImage<float> &Idec, unsigned int factor);
+
+  static void fillHoles(vpImage<uint16_t> &I, const vpHoleFillingType &type=HOLE_FILLING_FARTHEST);
+  static void fillHoles(vpImage<float> &I, const vpHoleFillingType &type=HOLE_FILLING_FARTHEST);
+
+  /*!
+    Return the temporal filter smoothing factor.
+    \sa setTemporalFilterParameters()
+  */
+  inline float getTemporalFilterAlpha() const { return m_temporalAlpha; }
+  /*!
+    Return the temporal filter edge threshold.
+    \sa setTemporalFilterParameters()
+  */
+  inline float getTemporalFilterDelta() const { return m_temporalDelta; }
+  /*!
+    Return the number of successive frames during which a hole is filled
+    with the last valid depth.
+    \sa setTemporalFilterParameters()
+  */
+  inline unsigned int getTemporalFilterPersistence() const { return m_temporalPersistence; }
+
+  void resetTemporalFilter();
+  void setTemporalFilterParameters(float alpha, float delta, unsigned int persistence=0);
+
+  static void spatialFilter(vpImage<uint16_t> &I, float alpha=0.5f, float delta=20.f, unsigned int iterations=2);
+  static void spatialFilter(vpImage<float> &I, float alpha=0.5f, float delta=0.02f, unsigned int iterations=2);
+
+  void temporalFilter(vpImage<uint16_t> &I);
+  void temporalFilter(vpImage<float> &I);
+
+private:
+  void applyTemporalFilter(float *Z, unsigned int height, unsigned int width);
+
+  float m_temporalAlpha;
+  float m_temporalDelta;
+  unsigned int m_temporalPersistence;
+  vpImage<float> m_history;     //!< Filtered depth of the previous frame
+  vpImage<float> m_holeCount;   //!< Number of successive frames a hole was filled from the history
+  vpImage<float> m_buffer;      //!< Depth of the current frame converted in float
+};
+
+#endif
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Registration of depth and color images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthRegistration.h
+  \brief Registration of depth and color images acquired by RGB-D sensors.
+*/
+
+#ifndef vpDepthRegistration_h
+#define vpDepthRegistration_h
+
+#include <stdint.h>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpDepthRegistration
+
+  \ingroup group_sensor_rgbd
+
+  \brief Align the depth and the color images of an RGB-D sensor.
+
+  Given the intrinsic parameters of the depth and the color cameras and the
+  transformation \f$ ^c{\bf M}_d \f$ from the depth camera frame to the color
+  camera frame, this class allows:
+  - to express the color image in the depth camera frame with
+    alignColorToDepth(): each pixel of the aligned color image corresponds to
+    the pixel of the depth image with the same coordinates;
+  - to express the depth image in the color camera frame with
+    alignDepthToColor(): each pixel of the aligned depth image is the depth of
+    the corresponding color pixel. Each depth pixel covers the color pixels
+    of its projected footprint and a z-buffer keeps the nearest depth.
+
+  The rotation of the viewing direction of each depth pixel is computed once
+  in init() and stored in a lookup table, so that aligning a frame only
+  costs one scaled vector addition and one projection per pixel. The
+  projection uses SSE2 when available and OpenMP when ViSP is built with
+  OpenMP support. Depth images are given as vpImage<uint16_t> in sensor
+  units, using the depth scale given to init(), or as vpImage<float> in
+  meter. Pixels without depth measurement have a null, negative or NaN value.
+
+  \code
+#include <visp3/sensor/vpDepthRegistration.h>
+
+int main()
+{
+  vpImage<uint16_t> depth(480, 640), depth_aligned;
+  vpImage<vpRGBa> color(480, 640), color_aligned;
+  vpCameraParameters cam_depth(475., 475., 320., 240.), cam_color(615., 615., 320., 240.);
+  vpHomogeneousMatrix cMd(0.025, 0., 0., 0., 0., 0.);
+
+  vpDepthRegistration registration;
+  registration.init(cam_depth, 480, 640, cam_color, 480, 640, cMd, 0.001f);
+  for (;;) {
+    // Acquire color and depth...
+    registration.alignColorToDepth(color, depth, color_aligned);
+    registration.alignDepthToColor(depth, depth_aligned);
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpDepthRegistration
+{
+public:
+  vpDepthRegistration();
+  virtual ~vpDepthRegistration();
+
+  void alignColorToDepth(const vpImage<vpRGBa> &color, const vpImage<uint16_t> &depth, vpImage<vpRGBa> &color_aligned);
+  void alignColorToDepth(const vpImage<vpRGBa> &color, const vpImage<float> &depth, vpImage<vpRGBa> &color_aligned);
+
+  void alignDepthToColor(const vpImage<uint16_t> &depth, vpImage<uint16_t> &depth_aligned);
+  void alignDepthToColor(const vpImage<float> &depth, vpImage<float> &depth_aligned);
+
+  /*!
+    Return the scale factor used to convert vpImage<uint16_t> depth values in meter.
+  */
+  inline float getDepthScale() const { return m_depthScale; }
+
+  void init(const vpCameraParameters &cam_depth, unsigned int depth_height, unsigned int depth_width,
+            const vpCameraParameters &cam_color, unsigned int color_height, unsigned int color_width,
+            const vpHomogeneousMatrix &cMd, float depth_scale=0.001f);
+
+  /*!
+    Return true if init() was called.
+  */
+  inline bool isInitialized() const { return m_depthHeight > 0; }
+
+private:
+  void checkDepthSize(unsigned int height, unsigned int width) const;
+  void gatherColor(const vpImage<vpRGBa> &color, vpImage<vpRGBa> &color_aligned);
+  void projectCenters(const float *Z);
+  void projectFootprints(const float *Z);
+
+  unsigned int m_depthHeight, m_depthWidth;
+  unsigned int m_colorHeight, m_colorWidth;
+  vpCameraParameters m_camColor;
+  bool m_colorDistortion;
+  float m_depthScale;
+  float m_tx, m_ty, m_tz;
+
+  // Lookup tables: rotated viewing direction of the center of each depth
+  // pixel, and of the corners of the depth pixels
+  std::vector<float> m_centerX, m_centerY, m_centerZ;
+  std::vector<float> m_cornerX, m_cornerY, m_cornerZ;
+
+  // Per frame buffers
+  std::vector<float> m_depth;
+  std::vector<float> m_u0, m_v0, m_u1, m_v1, m_Zc;
+  std::vector<float> m_zbuffer;
+};
+
+#endif
@@ -53,6 +53,8 @@
 #include <visp3/core/vpCameraParameters.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPointCloud.h>
+#include <visp3/sensor/vpDepthRegistration.h>
 
 /*!
 
@@ -132,6 +134,7 @@ public:
 
   bool getDepthMap(vpImage<float>& map);
   bool getDepthMap(vpImage<float>& map, vpImage<unsigned char>& Imap);
+  bool getPointCloud(vpPointCloud &pointcloud);
   bool getRGB(vpImage<vpRGBa>& IRGB);
 
 
@@ -143,9 +146,11 @@ public:
   }
   inline void setIRCamParameters(const vpCameraParameters &cam) {
     IRcam = cam;
+    m_registrationInitialized = false;
   }
   inline void setRGBCamParameters(const vpCameraParameters &cam) {
     RGBcam = cam;
+    m_registrationInitialized = false;
   }
 
   void warpRGBFrame(const vpImage<vpRGBa> & Irgb, const vpImage<float> & Idepth, vpImage<vpRGBa> & IrgbWarped);//warp the RGB image into the Depth camera frame
@@ -177,6 +182,11 @@ public:
   bool m_new_depth_image;
   unsigned int height;//height of the rgb image
   unsigned int width;//width of the rgb image
+  vpImage<float> m_pointCloudDepth;//depth map buffer reused by getPointCloud()
+  vpDepthRegistration m_registration;//lookup tables used by warpRGBFrame()
+  bool m_registrationInitialized;
+  unsigned int m_registrationColorHeight;
+  unsigned int m_registrationColorWidth;
 
 };
 
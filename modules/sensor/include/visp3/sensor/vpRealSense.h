@@ -47,6 +47,7 @@
 #include <visp3/core/vpException.h>
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImage.h>
+#include <visp3/core/vpPointCloud.h>
 
 #if defined(VISP_HAVE_REALSENSE) && defined(VISP_HAVE_CPP11_COMPATIBILITY)
 
@@ -243,6 +244,7 @@ public:
   virtual ~vpRealSense();
 
   void acquire(std::vector<vpColVector> &pointcloud);
+  void acquire(vpPointCloud &pointcloud);
 #ifdef VISP_HAVE_PCL
   void acquire(pcl::PointCloud<pcl::PointXYZ>::Ptr &pointcloud);
   void acquire(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &pointcloud);
@@ -250,6 +252,7 @@ public:
   void acquire(vpImage<unsigned char> &grey); // tested
   void acquire(vpImage<unsigned char> &grey, std::vector<vpColVector> &pointcloud);
   void acquire(vpImage<unsigned char> &grey, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, std::vector<vpColVector> &pointcloud);
+  void acquire(vpImage<unsigned char> &grey, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, vpPointCloud &pointcloud);
 #ifdef VISP_HAVE_PCL
   void acquire(vpImage<unsigned char> &grey, pcl::PointCloud<pcl::PointXYZ>::Ptr &pointcloud);
   void acquire(vpImage<unsigned char> &grey, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, pcl::PointCloud<pcl::PointXYZ>::Ptr &pointcloud);
@@ -259,6 +262,7 @@ public:
   void acquire(vpImage<vpRGBa> &color);  // tested
   void acquire(vpImage<vpRGBa> &color, std::vector<vpColVector> &pointcloud);
   void acquire(vpImage<vpRGBa> &color, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, std::vector<vpColVector> &pointcloud);
+  void acquire(vpImage<vpRGBa> &color, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, vpPointCloud &pointcloud);
 
   void acquire(unsigned char * const data_image, unsigned char * const data_depth, std::vector<vpColVector> * const data_pointCloud, unsigned char * const data_infrared,
                unsigned char * const data_infrared2=NULL);
@@ -42,6 +42,7 @@
 #if defined(VISP_HAVE_LIBFREENECT_AND_DEPENDENCIES)
 
 #include <limits>   // numeric_limits
+#include <string.h> // memcpy
 
 #include <visp3/sensor/vpKinect.h>
 #include <visp3/core/vpXmlParserCamera.h>
@@ -58,7 +59,9 @@ vpKinect::vpKinect(freenect_context *ctx, int index)
     m_new_rgb_frame(false),
     m_new_depth_map(false),
     m_new_depth_image(false),
-    height(480), width(640)
+    height(480), width(640), m_pointCloudDepth(),
+    m_registration(), m_registrationInitialized(false),
+    m_registrationColorHeight(0), m_registrationColorWidth(0)
 {
   dmap.resize(height, width);
   IRGB.resize(height, width);
@@ -110,6 +113,7 @@ void vpKinect::start(vpKinect::vpDMResolution res)
 //  RGBcam.initPersProjWithoutDistortion(512.0559503505,511.9352058050,310.6693938678,267.0673901049);//new
   	RGBcam.initPersProjWithDistortion(522.5431816996,522.7191431808,311.4001982614,267.4283562142,0.0477365207,-0.0462326418);//new
 #endif
+  m_registrationInitialized = false;
 
   this->startVideo();
   this->startDepth();
@@ -234,6 +238,42 @@ bool vpKinect::getDepthMap(vpImage<float>& map,vpImage<unsigned char>& Imap)
 }
 
 
+/*!
+  Get the point cloud corresponding to the last depth map in the IR camera
+  frame. The point cloud is organized with the resolution of the depth map
+  (see start()) and its buffer is reused from one call to the other. Pixels
+  without depth measurement lead to points with X = Y = Z = 0.
+
+  \return true if a new depth map was available, false otherwise.
+*/
+bool vpKinect::getPointCloud(vpPointCloud &pointcloud)
+{
+  {
+    vpMutex::vpScopedLock lock(m_depth_mutex);
+    if (!m_new_depth_map && !m_new_depth_image)
+      return false;
+
+    m_pointCloudDepth.resize(hd, wd);
+    if (DMres == DMAP_LOW_RES) {
+      for (unsigned int i = 0; i < hd; i++) {
+        const float *src = dmap[i<<1];
+        float *dst = m_pointCloudDepth[i];
+        for (unsigned int j = 0; j < wd; j++)
+          dst[j] = src[j<<1];
+      }
+    }
+    else {
+      memcpy(m_pointCloudDepth.bitmap, dmap.bitmap, hd*wd*sizeof(float));
+    }
+    m_new_depth_map = false;
+    m_new_depth_image = false;
+  }
+
+  // Invalid depth values are set to -1 and are discarded by the deprojection
+  pointcloud.deproject(m_pointCloudDepth, IRcam);
+  return true;
+}
+
 /*!
   Get RGB image
 */
@@ -252,57 +292,21 @@ bool vpKinect::getRGB(vpImage<vpRGBa>& I_RGB)
 */
 void vpKinect::warpRGBFrame(const vpImage<vpRGBa> & Irgb, const vpImage<float> & Idepth, vpImage<vpRGBa> & IrgbWarped)
 {
-	if ((Idepth.getHeight()!=hd )||(Idepth.getWidth()!=wd)){
-	      vpERROR_TRACE(1, "Idepth image size does not match vpKinect DM resolution");
-	}
-	else{
-		if((IrgbWarped.getHeight()!=hd )||(IrgbWarped.getWidth()!=wd))
-			IrgbWarped.resize(hd, wd);
-		IrgbWarped=0;
-		double x1=0., y1=0., x2=0., y2=0., Z1, Z2;
-		vpImagePoint imgPoint(0,0);
-		double u=0., v=0.;
-		vpColVector P1(4),P2(4);
-
-//		std::cout <<"rgbMir : "<<rgbMir<<std::endl;
-
-		for (unsigned int i = 0; i< hd;i++)
-		  for (unsigned int j = 0 ; j < wd ; j++){
-			  //! Compute metric coordinates in the ir camera Frame :
-			  vpPixelMeterConversion::convertPoint(IRcam, j, i, x1, y1);
-			  Z1 = Idepth[i][j];
-              //if (Z1!=-1){
-              if (std::fabs(Z1+1) <= std::numeric_limits<double>::epsilon()){
-                  P1[0]=x1*Z1;
-				  P1[1]=y1*Z1;
-				  P1[2]=Z1;
-				  P1[3]=1;
-
-				  //! Change frame :
-				  P2 = rgbMir*P1;
-				  Z2 = P2[2];
-                  //if (Z2!= 0){
-                  if (std::fabs(Z2) > std::numeric_limits<double>::epsilon()){
-                      x2 = P2[0]/P2[2];
-					  y2 = P2[1]/P2[2];
-				  }
-				  else
-					  std::cout<<"Z2 = 0 !!"<<std::endl;
-
-				  //! compute pixel coordinates of the corresponding point in the depth image
-				  vpMeterPixelConversion::convertPoint(RGBcam, x2, y2, u, v);
-
-				  unsigned int u_ = (unsigned int)u;
-				  unsigned int v_ = (unsigned int)v;
-				  //!Fill warped image value
-				  if ((u_<width)&&(v_<height)){
-					IrgbWarped[i][j] = Irgb[v_][u_];
-				  }
-				  else
-					  IrgbWarped[i][j] = 0;
-			  }
-		  }
-	}
+  if ((Idepth.getHeight()!=hd )||(Idepth.getWidth()!=wd)){
+    vpERROR_TRACE(1, "Idepth image size does not match vpKinect DM resolution");
+    return;
+  }
+
+  // The lookup tables are only computed again when the camera parameters or the image sizes change
+  if (! m_registrationInitialized || Irgb.getHeight() != m_registrationColorHeight || Irgb.getWidth() != m_registrationColorWidth) {
+    m_registration.init(IRcam, hd, wd, RGBcam, Irgb.getHeight(), Irgb.getWidth(), rgbMir);
+    m_registrationInitialized = true;
+    m_registrationColorHeight = Irgb.getHeight();
+    m_registrationColorWidth = Irgb.getWidth();
+  }
+
+  // Pixels without depth (set to -1) or projected outside of Irgb are set to black
+  m_registration.alignColorToDepth(Irgb, Idepth, IrgbWarped);
 }
 
 #elif !defined(VISP_BUILD_SHARED_LIBS)
@@ -383,6 +383,97 @@ void vpRealSense::acquire(std::vector<vpColVector> &pointcloud)
   vp_rs_get_pointcloud_impl(m_device, m_intrinsics, m_max_Z, pointcloud);
 }
 
+/*!
+  Acquire a point cloud from RealSense device.
+
+  Compared to acquire(std::vector<vpColVector> &) this function doesn't allocate memory per point and uses
+  a vectorized deprojection when the depth stream has no distortion.
+
+  \param pointcloud : Point cloud filled in place from the depth stream. Its buffer is only reallocated when the
+  depth stream resolution changes. When the color is enabled with vpPointCloud::enableColor() and the color
+  stream is enabled, the color of each point is retrieved from the color stream.
+ */
+void vpRealSense::acquire(vpPointCloud &pointcloud)
+{
+  if (m_device == NULL) {
+    throw vpException(vpException::fatalError, "RealSense Camera - Device not opened!");
+  }
+  if (! m_device->is_streaming()) {
+    open();
+  }
+
+  m_device->wait_for_frames();
+
+  // Retrieve point cloud
+  vp_rs_get_pointcloud_impl(m_device, m_intrinsics, m_max_Z, pointcloud);
+}
+
+/*!
+  Acquire data from RealSense device.
+  \param grey : Grey level image.
+  \param infrared : Infrared image.
+  \param depth : Depth image.
+  \param pointcloud : Point cloud filled in place from the depth stream. Its buffer is only reallocated when the
+  depth stream resolution changes. When the color is enabled with vpPointCloud::enableColor() and the color
+  stream is enabled, the color of each point is retrieved from the color stream.
+ */
+void vpRealSense::acquire(vpImage<unsigned char> &grey, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, vpPointCloud &pointcloud)
+{
+  if (m_device == NULL) {
+    throw vpException(vpException::fatalError, "RealSense Camera - Device not opened!");
+  }
+  if (! m_device->is_streaming()) {
+    open();
+  }
+
+  m_device->wait_for_frames();
+
+  // Retrieve grey image
+  vp_rs_get_grey_impl(m_device, m_intrinsics, grey);
+
+  // Retrieve infrared image
+  vp_rs_get_frame_data_impl(m_device, m_intrinsics, rs::stream::infrared, infrared);
+
+  // Retrieve depth image
+  vp_rs_get_frame_data_impl(m_device, m_intrinsics, rs::stream::depth, depth);
+
+  // Retrieve point cloud
+  vp_rs_get_pointcloud_impl(m_device, m_intrinsics, m_max_Z, pointcloud);
+}
+
+/*!
+  Acquire data from RealSense device.
+  \param color : Color image.
+  \param infrared : Infrared image.
+  \param depth : Depth image.
+  \param pointcloud : Point cloud filled in place from the depth stream. Its buffer is only reallocated when the
+  depth stream resolution changes. When the color is enabled with vpPointCloud::enableColor() and the color
+  stream is enabled, the color of each point is retrieved from the color stream.
+ */
+void vpRealSense::acquire(vpImage<vpRGBa> &color, vpImage<uint16_t> &infrared, vpImage<uint16_t> &depth, vpPointCloud &pointcloud)
+{
+  if (m_device == NULL) {
+    throw vpException(vpException::fatalError, "RealSense Camera - Device not opened!");
+  }
+  if (! m_device->is_streaming()) {
+    open();
+  }
+
+  m_device->wait_for_frames();
+
+  // Retrieve color image
+  vp_rs_get_color_impl(m_device, m_intrinsics, color);
+
+  // Retrieve infrared image
+  vp_rs_get_frame_data_impl(m_device, m_intrinsics, rs::stream::infrared, infrared);
+
+  // Retrieve depth image
+  vp_rs_get_frame_data_impl(m_device, m_intrinsics, rs::stream::depth, depth);
+
+  // Retrieve point cloud
+  vp_rs_get_pointcloud_impl(m_device, m_intrinsics, m_max_Z, pointcloud);
+}
+
 /*!
   Acquire data from RealSense device.
   \param color : Color image.
@@ -41,6 +41,7 @@
 
 #include <librealsense/rs.hpp>
 #include <visp3/core/vpImage.h>
+#include <visp3/core/vpPointCloud.h>
 
 template <class Type>
 void vp_rs_get_frame_data_impl(const rs::device *m_device, const std::map <rs::stream, rs::intrinsics> &m_intrinsics, const rs::stream &stream, vpImage<Type> &data)
@@ -193,7 +194,7 @@ void vp_rs_get_grey_impl(const rs::device *m_device, const std::map <rs::stream,
 void vp_rs_get_pointcloud_impl(const rs::device *m_device, const std::map <rs::stream, rs::intrinsics> &m_intrinsics, float max_Z, std::vector<vpColVector> &pointcloud)
 {
   if (m_device->is_stream_enabled(rs::stream::depth)) {
-    std::map<rs::stream, rs::intrinsics>::const_iterator it_intrinsics = m_intrinsics.find(rs::stream::color);
+    std::map<rs::stream, rs::intrinsics>::const_iterator it_intrinsics = m_intrinsics.find(rs::stream::depth);
     if (it_intrinsics == m_intrinsics.end()) {
       throw vpException(vpException::fatalError, "Cannot find intrinsics for depth stream!");
     }
@@ -231,6 +232,87 @@ void vp_rs_get_pointcloud_impl(const rs::device *m_device, const std::map <rs::s
   }
 }
 
+// Retrieve point cloud in a vpPointCloud, reusing its buffer
+void vp_rs_get_pointcloud_impl(const rs::device *m_device, const std::map <rs::stream, rs::intrinsics> &m_intrinsics, float max_Z, vpPointCloud &pointcloud)
+{
+  if (! m_device->is_stream_enabled(rs::stream::depth)) {
+    pointcloud.resize(0);
+    return;
+  }
+
+  std::map<rs::stream, rs::intrinsics>::const_iterator it_intrinsics_depth = m_intrinsics.find(rs::stream::depth);
+  if (it_intrinsics_depth == m_intrinsics.end()) {
+    throw vpException(vpException::fatalError, "Cannot find intrinsics for depth stream!");
+  }
+  const rs::intrinsics &intrinsics_depth = it_intrinsics_depth->second;
+
+  const float depth_scale = m_device->get_depth_scale();
+  uint16_t *depth = (uint16_t *)m_device->get_frame_data(rs::stream::depth);
+  unsigned int depth_width = (unsigned int) intrinsics_depth.width;
+  unsigned int depth_height = (unsigned int) intrinsics_depth.height;
+
+  if (intrinsics_depth.model() == rs::distortion::none) {
+    // Deproject the depth frame without copy using the vectorized deprojection
+    vpCameraParameters cam(intrinsics_depth.fx, intrinsics_depth.fy, intrinsics_depth.ppx, intrinsics_depth.ppy);
+    pointcloud.deproject(depth, depth_height, depth_width, cam, depth_scale, max_Z);
+  }
+  else {
+    // Distortion models that are not supported by vpCameraParameters
+    pointcloud.resize(depth_height, depth_width);
+    float *X = pointcloud.getX(), *Y = pointcloud.getY(), *Z = pointcloud.getZ();
+    for (unsigned int i = 0; i < depth_height; i++) {
+      for (unsigned int j = 0; j < depth_width; j++) {
+        size_t k = (size_t)i * depth_width + j;
+        rs::float2 depth_pixel = { (float) j, (float) i };
+        rs::float3 depth_point = intrinsics_depth.deproject(depth_pixel, depth[k] * depth_scale);
+
+        if (depth_point.z <= 0 || depth_point.z > max_Z) {
+          depth_point.x = depth_point.y = depth_point.z = 0;
+        }
+        X[k] = depth_point.x;
+        Y[k] = depth_point.y;
+        Z[k] = depth_point.z;
+      }
+    }
+  }
+
+  if (! pointcloud.hasColor() || ! m_device->is_stream_enabled(rs::stream::color)) {
+    return;
+  }
+
+  std::map<rs::stream, rs::intrinsics>::const_iterator it_intrinsics_color = m_intrinsics.find(rs::stream::color);
+  if (it_intrinsics_color == m_intrinsics.end()) {
+    throw vpException(vpException::fatalError, "Cannot find intrinsics for color stream!");
+  }
+  const rs::intrinsics &intrinsics_color = it_intrinsics_color->second;
+  rs::extrinsics depth_2_color_extrinsic = m_device->get_extrinsics(rs::stream::depth, rs::stream::color);
+
+  const unsigned char *color = (const unsigned char *)m_device->get_frame_data(rs::stream::color);
+  const rs::format color_format = m_device->get_stream_format(rs::stream::color);
+  const bool is_bgr = (color_format == rs::format::bgr8 || color_format == rs::format::bgra8);
+  const unsigned int nb_color_pixel = (color_format == rs::format::rgb8 || color_format == rs::format::bgr8) ? 3 : 4;
+  const int color_width = intrinsics_color.width;
+  const int color_height = intrinsics_color.height;
+
+  const float *X = pointcloud.getX(), *Y = pointcloud.getY(), *Z = pointcloud.getZ();
+  vpRGBa *rgb = pointcloud.getColor();
+  for (unsigned int k = 0; k < pointcloud.size(); k++) {
+    rgb[k] = vpRGBa(0, 0, 0, vpRGBa::alpha_default);
+    if (Z[k] <= 0)
+      continue;
+
+    rs::float3 depth_point = { X[k], Y[k], Z[k] };
+    rs::float2 color_pixel = intrinsics_color.project(depth_2_color_extrinsic.transform(depth_point));
+    if (color_pixel.y < 0 || color_pixel.y >= color_height || color_pixel.x < 0 || color_pixel.x >= color_width)
+      continue;
+
+    const unsigned char *c = color + ((unsigned int) color_pixel.y * (unsigned int) color_width + (unsigned int) color_pixel.x) * nb_color_pixel;
+    rgb[k].R = is_bgr ? c[2] : c[0];
+    rgb[k].G = c[1];
+    rgb[k].B = is_bgr ? c[0] : c[2];
+  }
+}
+
 #ifdef VISP_HAVE_PCL
 // Retrieve point cloud
 void vp_rs_get_pointcloud_impl(const rs::device *m_device, const std::map<rs::stream, rs::intrinsics> &m_intrinsics, float max_Z, pcl::PointCloud<pcl::PointXYZ>::Ptr &pointcloud)
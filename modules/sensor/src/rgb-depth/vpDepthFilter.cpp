@@ -0,0 +1,472 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Depth image filtering.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthFilter.cpp
+  \brief Decimation, edge-preserving filtering and hole filling of depth images.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/sensor/vpDepthFilter.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Number of columns processed by a thread during the vertical pass of the spatial filter
+  const unsigned int vpSpatialFilterColumnBlock = 64;
+
+  // A depth is valid if strictly positive; this also discards NaN values
+  template <class Type> inline bool isValidDepth(const Type &d)
+  {
+    return d > 0;
+  }
+
+  void toFloat(const vpImage<uint16_t> &I, vpImage<float> &Z)
+  {
+    Z.resize(I.getHeight(), I.getWidth());
+    const int size = (int)I.getSize();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int k = 0; k < size; k++) {
+      Z.bitmap[k] = (float)I.bitmap[k];
+    }
+  }
+
+  void fromFloat(const vpImage<float> &Z, vpImage<uint16_t> &I)
+  {
+    const int size = (int)I.getSize();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int k = 0; k < size; k++) {
+      float z = Z.bitmap[k];
+      I.bitmap[k] = z > 0 ? (z < 65535.f ? (uint16_t)(z + 0.5f) : (uint16_t)65535) : (uint16_t)0;
+    }
+  }
+
+  // Blend the valid depth cur with the valid depth prev if they are close enough
+  inline void blendDepth(float &cur, float prev, float alpha, float delta)
+  {
+    if (cur > 0 && prev > 0 && std::fabs(cur - prev) < delta)
+      cur = prev + alpha * (cur - prev);
+  }
+
+  void spatialFilterHorizontal(float *Z, unsigned int height, unsigned int width, float alpha, float delta)
+  {
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < (int)height; i++) {
+      float *row = Z + (size_t)i * width;
+      for (unsigned int j = 1; j < width; j++)
+        blendDepth(row[j], row[j-1], alpha, delta);
+      for (int j = (int)width - 2; j >= 0; j--)
+        blendDepth(row[j], row[j+1], alpha, delta);
+    }
+  }
+
+  void spatialFilterVerticalRow(float *cur, const float *prev, unsigned int start, unsigned int end, float alpha, float delta)
+  {
+    unsigned int j = start;
+#if VISP_HAVE_SSE2
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_alpha = _mm_set1_ps(alpha);
+    const __m128 v_delta = _mm_set1_ps(delta);
+    const __m128 v_abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; j + 4 <= end; j += 4) {
+      __m128 v_cur = _mm_loadu_ps(cur + j);
+      __m128 v_prev = _mm_loadu_ps(prev + j);
+      __m128 v_diff = _mm_sub_ps(v_cur, v_prev);
+      __m128 v_mask = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(v_cur, v_zero), _mm_cmpgt_ps(v_prev, v_zero)),
+                                 _mm_cmplt_ps(_mm_and_ps(v_diff, v_abs_mask), v_delta));
+      __m128 v_blend = _mm_add_ps(v_prev, _mm_mul_ps(v_alpha, v_diff));
+      _mm_storeu_ps(cur + j, _mm_or_ps(_mm_and_ps(v_mask, v_blend), _mm_andnot_ps(v_mask, v_cur)));
+    }
+#endif
+    for (; j < end; j++)
+      blendDepth(cur[j], prev[j], alpha, delta);
+  }
+
+  void spatialFilterVertical(float *Z, unsigned int height, unsigned int width, float alpha, float delta)
+  {
+    const int nbBlocks = (int)((width + vpSpatialFilterColumnBlock - 1) / vpSpatialFilterColumnBlock);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < nbBlocks; b++) {
+      unsigned int start = (unsigned int)b * vpSpatialFilterColumnBlock;
+      unsigned int end = std::min(start + vpSpatialFilterColumnBlock, width);
+      for (unsigned int i = 1; i < height; i++)
+        spatialFilterVerticalRow(Z + (size_t)i * width, Z + (size_t)(i-1) * width, start, end, alpha, delta);
+      for (int i = (int)height - 2; i >= 0; i--)
+        spatialFilterVerticalRow(Z + (size_t)i * width, Z + (size_t)(i+1) * width, start, end, alpha, delta);
+    }
+  }
+
+  void spatialFilterImpl(float *Z, unsigned int height, unsigned int width, float alpha, float delta, unsigned int iterations)
+  {
+    if (alpha <= 0 || alpha > 1) {
+      throw vpException(vpException::badValue, "Spatial filter alpha %f should be in ]0, 1]", alpha);
+    }
+    for (unsigned int iter = 0; iter < iterations; iter++) {
+      spatialFilterHorizontal(Z, height, width, alpha, delta);
+      spatialFilterVertical(Z, height, width, alpha, delta);
+    }
+  }
+
+  template <class Type>
+  void decimateImpl(const vpImage<Type> &I, vpImage<Type> &Idec, unsigned int factor)
+  {
+    if (factor < 1 || factor > 8) {
+      throw vpException(vpException::badValue, "Decimation factor %u should be in [1, 8]", factor);
+    }
+    const unsigned int height = I.getHeight() / factor, width = I.getWidth() / factor;
+    Idec.resize(height, width);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<Type> values(factor * factor);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+      for (int i = 0; i < (int)height; i++) {
+        for (unsigned int j = 0; j < width; j++) {
+          size_t n = 0;
+          for (unsigned int ii = 0; ii < factor; ii++) {
+            const Type *src = I[(unsigned int)i * factor + ii] + j * factor;
+            for (unsigned int jj = 0; jj < factor; jj++) {
+              if (isValidDepth(src[jj]))
+                values[n++] = src[jj];
+            }
+          }
+          if (n == 0) {
+            Idec[i][j] = 0;
+          }
+          else {
+            typename std::vector<Type>::iterator median = values.begin() + n / 2;
+            std::nth_element(values.begin(), median, values.begin() + n);
+            Idec[i][j] = *median;
+          }
+        }
+      }
+    }
+  }
+
+  template <class Type>
+  void fillHolesImpl(vpImage<Type> &I, const vpDepthFilter::vpHoleFillingType &type)
+  {
+    const unsigned int width = I.getWidth();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < (int)I.getHeight(); i++) {
+      Type *row = I[i];
+      unsigned int j = 0;
+      while (j < width) {
+        if (isValidDepth(row[j])) {
+          j++;
+          continue;
+        }
+        // Hole from j to end-1
+        unsigned int end = j + 1;
+        while (end < width && ! isValidDepth(row[end]))
+          end++;
+
+        bool hasLeft = (j > 0), hasRight = (end < width);
+        if (hasLeft || hasRight) {
+          Type value;
+          if (type == vpDepthFilter::HOLE_FILLING_LEFT || ! hasRight)
+            value = hasLeft ? row[j-1] : row[end];
+          else if (! hasLeft)
+            value = row[end];
+          else if (type == vpDepthFilter::HOLE_FILLING_NEAREST)
+            value = std::min(row[j-1], row[end]);
+          else
+            value = std::max(row[j-1], row[end]);
+
+          if (type != vpDepthFilter::HOLE_FILLING_LEFT || hasLeft) {
+            for (unsigned int k = j; k < end; k++)
+              row[k] = value;
+          }
+        }
+        j = end;
+      }
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. The temporal filter is initialized with alpha = 0.4,
+  delta = 20 and without persistence.
+*/
+vpDepthFilter::vpDepthFilter()
+  : m_temporalAlpha(0.4f), m_temporalDelta(20.f), m_temporalPersistence(0),
+    m_history(), m_holeCount(), m_buffer()
+{
+}
+
+/*!
+  Destructor.
+*/
+vpDepthFilter::~vpDepthFilter()
+{
+}
+
+/*!
+  Reduce the resolution of a depth image. Each pixel of the decimated image
+  is the median of the valid depth values of the corresponding \e factor x
+  \e factor block of the input image, or 0 if the block has no valid depth.
+
+  \param I : Input depth image in sensor units.
+  \param Idec : Decimated image of size (I.getHeight()/factor, I.getWidth()/factor).
+  \param factor : Decimation factor in [1, 8].
+
+  \exception vpException::badValue : If the decimation factor is not in [1, 8].
+*/
+void vpDepthFilter::decimate(const vpImage<uint16_t> &I, vpImage<uint16_t> &Idec, unsigned int factor)
+{
+  decimateImpl(I, Idec, factor);
+}
+
+/*!
+  Reduce the resolution of a depth image expressed in meter.
+
+  \sa decimate(const vpImage<uint16_t> &, vpImage<uint16_t> &, unsigned int)
+*/
+void vpDepthFilter::decimate(const vpImage<float> &I, vpImage<float> &Idec, unsigned int factor)
+{
+  decimateImpl(I, Idec, factor);
+}
+
+/*!
+  Fill the holes of each row of a depth image from the valid depth values
+  on the left and the right of the hole. Rows without valid depth are left
+  unchanged. With vpDepthFilter::HOLE_FILLING_LEFT, the holes at the
+  beginning of a row are also left unchanged.
+
+  \param I : Depth image in sensor units.
+  \param type : Hole filling method.
+*/
+void vpDepthFilter::fillHoles(vpImage<uint16_t> &I, const vpHoleFillingType &type)
+{
+  fillHolesImpl(I, type);
+}
+
+/*!
+  Fill the holes of each row of a depth image expressed in meter.
+
+  \sa fillHoles(vpImage<uint16_t> &, const vpHoleFillingType &)
+*/
+void vpDepthFilter::fillHoles(vpImage<float> &I, const vpHoleFillingType &type)
+{
+  fillHolesImpl(I, type);
+}
+
+/*!
+  Forget the depth history used by the temporal filter. This function has
+  to be called when the filtered sequence is interrupted.
+*/
+void vpDepthFilter::resetTemporalFilter()
+{
+  m_history.resize(0, 0);
+  m_holeCount.resize(0, 0);
+}
+
+/*!
+  Set the parameters of the temporal filter.
+
+  \param alpha : Smoothing factor in ]0, 1]. The filtered depth is
+  \f$ Z_t = Z_{t-1} + \alpha (d_t - Z_{t-1}) \f$ where \f$ d_t \f$ is the
+  measured depth. A value of 1 disables the smoothing.
+  \param delta : Depth difference between two successive frames above which
+  the measured depth is considered as an edge and is not smoothed. It is
+  expressed in sensor units for vpImage<uint16_t> and in meter for
+  vpImage<float> images.
+  \param persistence : Number of successive frames during which a hole is
+  filled with the last valid depth of the pixel. 0 disables the filling.
+
+  \exception vpException::badValue : If alpha is not in ]0, 1].
+*/
+void vpDepthFilter::setTemporalFilterParameters(float alpha, float delta, unsigned int persistence)
+{
+  if (alpha <= 0 || alpha > 1) {
+    throw vpException(vpException::badValue, "Temporal filter alpha %f should be in ]0, 1]", alpha);
+  }
+  m_temporalAlpha = alpha;
+  m_temporalDelta = delta;
+  m_temporalPersistence = persistence;
+}
+
+/*!
+  Apply an edge-preserving spatial filter to a depth image.
+
+  Each row is filtered from left to right and from right to left, then each
+  column from top to bottom and from bottom to top with a first order
+  recursive filter \f$ Z_k = Z_{k-1} + \alpha (d_k - Z_{k-1}) \f$. The
+  recursion stops at holes and when the depth difference between two
+  neighbours is greater than \e delta, so that the depth discontinuities are
+  preserved. Holes are not modified.
+
+  \param I : Depth image in sensor units.
+  \param alpha : Smoothing factor in ]0, 1]. A value of 1 disables the smoothing.
+  \param delta : Depth discontinuity threshold in sensor units.
+  \param iterations : Number of times the filter is applied.
+
+  \exception vpException::badValue : If alpha is not in ]0, 1].
+*/
+void vpDepthFilter::spatialFilter(vpImage<uint16_t> &I, float alpha, float delta, unsigned int iterations)
+{
+  vpImage<float> Z;
+  toFloat(I, Z);
+  spatialFilterImpl(Z.bitmap, Z.getHeight(), Z.getWidth(), alpha, delta, iterations);
+  fromFloat(Z, I);
+}
+
+/*!
+  Apply an edge-preserving spatial filter to a depth image expressed in
+  meter. The image is filtered in place.
+
+  \sa spatialFilter(vpImage<uint16_t> &, float, float, unsigned int)
+*/
+void vpDepthFilter::spatialFilter(vpImage<float> &I, float alpha, float delta, unsigned int iterations)
+{
+  spatialFilterImpl(I.bitmap, I.getHeight(), I.getWidth(), alpha, delta, iterations);
+}
+
+/*!
+  Apply the temporal filter to a depth image. The image is expected to be
+  the next frame of the sequence given at the previous call. A change of
+  the image size resets the filter.
+
+  \param I : Depth image in sensor units, filtered in place.
+
+  \sa setTemporalFilterParameters(), resetTemporalFilter()
+*/
+void vpDepthFilter::temporalFilter(vpImage<uint16_t> &I)
+{
+  toFloat(I, m_buffer);
+  applyTemporalFilter(m_buffer.bitmap, m_buffer.getHeight(), m_buffer.getWidth());
+  fromFloat(m_buffer, I);
+}
+
+/*!
+  Apply the temporal filter to a depth image expressed in meter.
+
+  \sa temporalFilter(vpImage<uint16_t> &)
+*/
+void vpDepthFilter::temporalFilter(vpImage<float> &I)
+{
+  applyTemporalFilter(I.bitmap, I.getHeight(), I.getWidth());
+}
+
+void vpDepthFilter::applyTemporalFilter(float *Z, unsigned int height, unsigned int width)
+{
+  if (m_history.getHeight() != height || m_history.getWidth() != width) {
+    m_history.resize(height, width);
+    m_holeCount.resize(height, width);
+    m_history = 0;
+    m_holeCount = 0;
+  }
+
+  float *H = m_history.bitmap, *N = m_holeCount.bitmap;
+  const float alpha = m_temporalAlpha, delta = m_temporalDelta, persistence = (float)m_temporalPersistence;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)height; i++) {
+    unsigned int j = 0;
+    const size_t offset = (size_t)i * width;
+#if VISP_HAVE_SSE2
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_one = _mm_set1_ps(1.f);
+    const __m128 v_alpha = _mm_set1_ps(alpha);
+    const __m128 v_delta = _mm_set1_ps(delta);
+    const __m128 v_persistence = _mm_set1_ps(persistence);
+    const __m128 v_abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; j + 4 <= width; j += 4) {
+      const size_t k = offset + j;
+      __m128 v_cur = _mm_loadu_ps(Z + k);
+      __m128 v_hist = _mm_loadu_ps(H + k);
+      __m128 v_count = _mm_loadu_ps(N + k);
+      __m128 v_diff = _mm_sub_ps(v_cur, v_hist);
+
+      __m128 v_cur_valid = _mm_cmpgt_ps(v_cur, v_zero);
+      __m128 v_hist_valid = _mm_cmpgt_ps(v_hist, v_zero);
+      __m128 v_close = _mm_and_ps(_mm_and_ps(v_cur_valid, v_hist_valid),
+                                  _mm_cmplt_ps(_mm_and_ps(v_diff, v_abs_mask), v_delta));
+      __m128 v_keep = _mm_andnot_ps(v_cur_valid, _mm_and_ps(v_hist_valid, _mm_cmplt_ps(v_count, v_persistence)));
+
+      __m128 v_blend = _mm_add_ps(v_hist, _mm_mul_ps(v_alpha, v_diff));
+      // out = close ? blend : (cur valid ? cur : (keep ? hist : 0))
+      __m128 v_out = _mm_or_ps(_mm_and_ps(v_keep, v_hist), _mm_and_ps(v_cur_valid, v_cur));
+      v_out = _mm_or_ps(_mm_and_ps(v_close, v_blend), _mm_andnot_ps(v_close, v_out));
+
+      __m128 v_write = _mm_or_ps(v_cur_valid, v_keep);
+      _mm_storeu_ps(Z + k, _mm_or_ps(_mm_and_ps(v_write, v_out), _mm_andnot_ps(v_write, v_cur)));
+      _mm_storeu_ps(H + k, v_out);
+      _mm_storeu_ps(N + k, _mm_and_ps(v_keep, _mm_add_ps(v_count, v_one)));
+    }
+#endif
+    for (; j < width; j++) {
+      const size_t k = offset + j;
+      const float cur = Z[k], hist = H[k];
+      if (cur > 0) {
+        Z[k] = (hist > 0 && std::fabs(cur - hist) < delta) ? hist + alpha * (cur - hist) : cur;
+        H[k] = Z[k];
+        N[k] = 0;
+      }
+      else if (hist > 0 && N[k] < persistence) {
+        Z[k] = hist;
+        N[k] += 1;
+      }
+      else {
+        H[k] = 0;
+        N[k] = 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,418 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Registration of depth and color images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthRegistration.cpp
+  \brief Registration of depth and color images acquired by RGB-D sensors.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/sensor/vpDepthRegistration.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Pixel coordinate given to the points that cannot be projected
+  const float vpInvalidProjection = -1e9f;
+
+  struct vpProjection
+  {
+    const vpCameraParameters *cam;
+    bool distortion;
+    float px, py, u0, v0;
+    float tx, ty, tz;
+  };
+
+  /*
+    Project n points given by their depth Z in the depth frame and the
+    rotated viewing directions (rx, ry, rz): P = Z (rx, ry, rz) + t. Points
+    without depth or behind the color camera get vpInvalidProjection.
+  */
+  void projectPoints(const vpProjection &p, const float *Z, const float *rx, const float *ry, const float *rz,
+                     unsigned int n, float *u, float *v)
+  {
+    unsigned int k = 0;
+    if (! p.distortion) {
+#if VISP_HAVE_SSE2
+      const __m128 v_zero = _mm_setzero_ps();
+      const __m128 v_invalid = _mm_set1_ps(vpInvalidProjection);
+      const __m128 v_px = _mm_set1_ps(p.px), v_py = _mm_set1_ps(p.py);
+      const __m128 v_u0 = _mm_set1_ps(p.u0), v_v0 = _mm_set1_ps(p.v0);
+      const __m128 v_tx = _mm_set1_ps(p.tx), v_ty = _mm_set1_ps(p.ty), v_tz = _mm_set1_ps(p.tz);
+      for (; k + 4 <= n; k += 4) {
+        __m128 v_Z = _mm_loadu_ps(Z + k);
+        __m128 v_Xc = _mm_add_ps(_mm_mul_ps(v_Z, _mm_loadu_ps(rx + k)), v_tx);
+        __m128 v_Yc = _mm_add_ps(_mm_mul_ps(v_Z, _mm_loadu_ps(ry + k)), v_ty);
+        __m128 v_Zc = _mm_add_ps(_mm_mul_ps(v_Z, _mm_loadu_ps(rz + k)), v_tz);
+        __m128 v_valid = _mm_and_ps(_mm_cmpgt_ps(v_Z, v_zero), _mm_cmpgt_ps(v_Zc, v_zero));
+        __m128 v_inv_Zc = _mm_div_ps(_mm_set1_ps(1.f), _mm_or_ps(_mm_and_ps(v_valid, v_Zc), _mm_andnot_ps(v_valid, _mm_set1_ps(1.f))));
+        __m128 v_u = _mm_add_ps(_mm_mul_ps(v_px, _mm_mul_ps(v_Xc, v_inv_Zc)), v_u0);
+        __m128 v_v = _mm_add_ps(_mm_mul_ps(v_py, _mm_mul_ps(v_Yc, v_inv_Zc)), v_v0);
+        _mm_storeu_ps(u + k, _mm_or_ps(_mm_and_ps(v_valid, v_u), _mm_andnot_ps(v_valid, v_invalid)));
+        _mm_storeu_ps(v + k, _mm_or_ps(_mm_and_ps(v_valid, v_v), _mm_andnot_ps(v_valid, v_invalid)));
+      }
+#endif
+    }
+    for (; k < n; k++) {
+      const float Zc = Z[k] * rz[k] + p.tz;
+      if (! (Z[k] > 0) || Zc <= 0) {
+        u[k] = v[k] = vpInvalidProjection;
+        continue;
+      }
+      const float x = (Z[k] * rx[k] + p.tx) / Zc;
+      const float y = (Z[k] * ry[k] + p.ty) / Zc;
+      if (p.distortion) {
+        double u_ = 0., v_ = 0.;
+        vpMeterPixelConversion::convertPoint(*p.cam, x, y, u_, v_);
+        u[k] = (float)u_;
+        v[k] = (float)v_;
+      }
+      else {
+        u[k] = p.px * x + p.u0;
+        v[k] = p.py * y + p.v0;
+      }
+    }
+  }
+
+  // Nearest pixel index of (u, v) or -1 if outside of the image
+  inline int nearestPixel(float u, float v, unsigned int height, unsigned int width)
+  {
+    if (u < -0.5f || v < -0.5f)
+      return -1;
+    int j = (int)(u + 0.5f), i = (int)(v + 0.5f);
+    if (i >= (int)height || j >= (int)width)
+      return -1;
+    return i * (int)width + j;
+  }
+
+  void depthToMeter(const vpImage<uint16_t> &depth, float depth_scale, std::vector<float> &Z)
+  {
+    const int size = (int)depth.getSize();
+    Z.resize((size_t)size);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int k = 0; k < size; k++) {
+      Z[(size_t)k] = depth.bitmap[k] * depth_scale;
+    }
+  }
+
+  void depthToMeter(const vpImage<float> &depth, std::vector<float> &Z)
+  {
+    const int size = (int)depth.getSize();
+    Z.resize((size_t)size);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int k = 0; k < size; k++) {
+      const float d = depth.bitmap[k];
+      Z[(size_t)k] = d > 0 ? d : 0.f;
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. init() has to be called before aligning images.
+*/
+vpDepthRegistration::vpDepthRegistration()
+  : m_depthHeight(0), m_depthWidth(0), m_colorHeight(0), m_colorWidth(0), m_camColor(),
+    m_colorDistortion(false), m_depthScale(0.001f), m_tx(0), m_ty(0), m_tz(0),
+    m_centerX(), m_centerY(), m_centerZ(), m_cornerX(), m_cornerY(), m_cornerZ(),
+    m_depth(), m_u0(), m_v0(), m_u1(), m_v1(), m_Zc(), m_zbuffer()
+{
+}
+
+/*!
+  Destructor.
+*/
+vpDepthRegistration::~vpDepthRegistration()
+{
+}
+
+/*!
+  Express the color image in the depth camera frame. Each pixel of the depth
+  image is deprojected, expressed in the color camera frame and projected in
+  the color image. Pixels without depth or that project outside of the color
+  image are set to black.
+
+  \param color : Color image.
+  \param depth : Depth image in sensor units.
+  \param color_aligned : Color image aligned with the depth image.
+
+  \exception vpException::notInitialized : If init() was not called.
+  \exception vpException::dimensionError : If the size of the images differs
+  from the ones given to init().
+*/
+void vpDepthRegistration::alignColorToDepth(const vpImage<vpRGBa> &color, const vpImage<uint16_t> &depth,
+                                            vpImage<vpRGBa> &color_aligned)
+{
+  checkDepthSize(depth.getHeight(), depth.getWidth());
+  depthToMeter(depth, m_depthScale, m_depth);
+  gatherColor(color, color_aligned);
+}
+
+/*!
+  Express the color image in the depth camera frame, the depth being
+  expressed in meter.
+
+  \sa alignColorToDepth(const vpImage<vpRGBa> &, const vpImage<uint16_t> &, vpImage<vpRGBa> &)
+*/
+void vpDepthRegistration::alignColorToDepth(const vpImage<vpRGBa> &color, const vpImage<float> &depth,
+                                            vpImage<vpRGBa> &color_aligned)
+{
+  checkDepthSize(depth.getHeight(), depth.getWidth());
+  depthToMeter(depth, m_depth);
+  gatherColor(color, color_aligned);
+}
+
+/*!
+  Express the depth image in the color camera frame. Each pixel of the depth
+  image covers the color pixels of its projected footprint and the nearest
+  depth is kept. Color pixels that are not covered are set to 0.
+
+  \param depth : Depth image in sensor units.
+  \param depth_aligned : Depth image in sensor units with the size of the
+  color image given to init().
+
+  \exception vpException::notInitialized : If init() was not called.
+  \exception vpException::dimensionError : If the size of the depth image
+  differs from the one given to init().
+*/
+void vpDepthRegistration::alignDepthToColor(const vpImage<uint16_t> &depth, vpImage<uint16_t> &depth_aligned)
+{
+  checkDepthSize(depth.getHeight(), depth.getWidth());
+  depthToMeter(depth, m_depthScale, m_depth);
+  projectFootprints(&m_depth[0]);
+
+  depth_aligned.resize(m_colorHeight, m_colorWidth);
+  const int size = (int)(m_colorHeight * m_colorWidth);
+  const float inv_scale = 1.f / m_depthScale;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < size; k++) {
+    float d = m_zbuffer[(size_t)k] * inv_scale + 0.5f;
+    depth_aligned.bitmap[k] = d < 65535.f ? (uint16_t)d : (uint16_t)65535;
+  }
+}
+
+/*!
+  Express the depth image in meter in the color camera frame.
+
+  \sa alignDepthToColor(const vpImage<uint16_t> &, vpImage<uint16_t> &)
+*/
+void vpDepthRegistration::alignDepthToColor(const vpImage<float> &depth, vpImage<float> &depth_aligned)
+{
+  checkDepthSize(depth.getHeight(), depth.getWidth());
+  depthToMeter(depth, m_depth);
+  projectFootprints(&m_depth[0]);
+
+  depth_aligned.resize(m_colorHeight, m_colorWidth);
+  std::copy(m_zbuffer.begin(), m_zbuffer.end(), depth_aligned.bitmap);
+}
+
+void vpDepthRegistration::checkDepthSize(unsigned int height, unsigned int width) const
+{
+  if (! isInitialized()) {
+    throw vpException(vpException::notInitialized, "Depth registration is not initialized");
+  }
+  if (height != m_depthHeight || width != m_depthWidth) {
+    throw vpException(vpException::dimensionError, "Depth image size %ux%u differs from %ux%u given to init()",
+                      width, height, m_depthWidth, m_depthHeight);
+  }
+}
+
+void vpDepthRegistration::gatherColor(const vpImage<vpRGBa> &color, vpImage<vpRGBa> &color_aligned)
+{
+  if (color.getHeight() != m_colorHeight || color.getWidth() != m_colorWidth) {
+    throw vpException(vpException::dimensionError, "Color image size %ux%u differs from %ux%u given to init()",
+                      color.getWidth(), color.getHeight(), m_colorWidth, m_colorHeight);
+  }
+
+  projectCenters(&m_depth[0]);
+
+  color_aligned.resize(m_depthHeight, m_depthWidth);
+  const int size = (int)(m_depthHeight * m_depthWidth);
+  const vpRGBa black(0, 0, 0, vpRGBa::alpha_default);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < size; k++) {
+    int index = nearestPixel(m_u0[(size_t)k], m_v0[(size_t)k], m_colorHeight, m_colorWidth);
+    color_aligned.bitmap[k] = index >= 0 ? color.bitmap[index] : black;
+  }
+}
+
+/*!
+  Initialize the lookup tables used to align the images.
+
+  \param cam_depth : Intrinsic parameters of the depth camera. Distortion is supported.
+  \param depth_height, depth_width : Size of the depth images.
+  \param cam_color : Intrinsic parameters of the color camera. When the
+  distortion is used, the projection is not vectorized.
+  \param color_height, color_width : Size of the color images.
+  \param cMd : Transformation from the depth camera frame to the color camera frame.
+  \param depth_scale : Scale factor that converts vpImage<uint16_t> depth values in meter.
+
+  \exception vpException::badValue : If a size or the depth scale is null.
+*/
+void vpDepthRegistration::init(const vpCameraParameters &cam_depth, unsigned int depth_height, unsigned int depth_width,
+                               const vpCameraParameters &cam_color, unsigned int color_height, unsigned int color_width,
+                               const vpHomogeneousMatrix &cMd, float depth_scale)
+{
+  if (depth_height == 0 || depth_width == 0 || color_height == 0 || color_width == 0) {
+    throw vpException(vpException::badValue, "Cannot initialize depth registration with an empty image size");
+  }
+  if (depth_scale <= 0) {
+    throw vpException(vpException::badValue, "Bad depth scale %f", depth_scale);
+  }
+
+  m_depthHeight = depth_height;
+  m_depthWidth = depth_width;
+  m_colorHeight = color_height;
+  m_colorWidth = color_width;
+  m_camColor = cam_color;
+  m_colorDistortion = (cam_color.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion);
+  m_depthScale = depth_scale;
+  m_tx = (float)cMd[0][3];
+  m_ty = (float)cMd[1][3];
+  m_tz = (float)cMd[2][3];
+
+  const size_t nb_centers = (size_t)depth_height * depth_width;
+  const size_t nb_corners = (size_t)(depth_height + 1) * (depth_width + 1);
+  m_centerX.resize(nb_centers);
+  m_centerY.resize(nb_centers);
+  m_centerZ.resize(nb_centers);
+  m_cornerX.resize(nb_corners);
+  m_cornerY.resize(nb_corners);
+  m_cornerZ.resize(nb_corners);
+
+  // Rotated viewing direction of the pixel centers, then of the pixel
+  // corners stored in a (height+1) x (width+1) grid
+  for (int pass = 0; pass < 2; pass++) {
+    const unsigned int rows = pass == 0 ? depth_height : depth_height + 1;
+    const unsigned int cols = pass == 0 ? depth_width : depth_width + 1;
+    const double offset = pass == 0 ? 0. : -0.5;
+    float *X = pass == 0 ? &m_centerX[0] : &m_cornerX[0];
+    float *Y = pass == 0 ? &m_centerY[0] : &m_cornerY[0];
+    float *Z = pass == 0 ? &m_centerZ[0] : &m_cornerZ[0];
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < (int)rows; i++) {
+      for (unsigned int j = 0; j < cols; j++) {
+        double x = 0., y = 0.;
+        vpPixelMeterConversion::convertPoint(cam_depth, j + offset, i + offset, x, y);
+        const size_t k = (size_t)i * cols + j;
+        X[k] = (float)(cMd[0][0] * x + cMd[0][1] * y + cMd[0][2]);
+        Y[k] = (float)(cMd[1][0] * x + cMd[1][1] * y + cMd[1][2]);
+        Z[k] = (float)(cMd[2][0] * x + cMd[2][1] * y + cMd[2][2]);
+      }
+    }
+  }
+
+  m_u0.resize(nb_centers);
+  m_v0.resize(nb_centers);
+  m_u1.resize(nb_centers);
+  m_v1.resize(nb_centers);
+  m_Zc.resize(nb_centers);
+  m_zbuffer.resize((size_t)color_height * color_width);
+}
+
+void vpDepthRegistration::projectCenters(const float *Z)
+{
+  vpProjection p = { &m_camColor, m_colorDistortion,
+                     (float)m_camColor.get_px(), (float)m_camColor.get_py(),
+                     (float)m_camColor.get_u0(), (float)m_camColor.get_v0(), m_tx, m_ty, m_tz };
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)m_depthHeight; i++) {
+    const size_t k = (size_t)i * m_depthWidth;
+    projectPoints(p, Z + k, &m_centerX[k], &m_centerY[k], &m_centerZ[k], m_depthWidth, &m_u0[k], &m_v0[k]);
+  }
+}
+
+void vpDepthRegistration::projectFootprints(const float *Z)
+{
+  vpProjection p = { &m_camColor, m_colorDistortion,
+                     (float)m_camColor.get_px(), (float)m_camColor.get_py(),
+                     (float)m_camColor.get_u0(), (float)m_camColor.get_v0(), m_tx, m_ty, m_tz };
+  const unsigned int cols = m_depthWidth + 1;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)m_depthHeight; i++) {
+    const size_t k = (size_t)i * m_depthWidth;
+    const size_t top_left = (size_t)i * cols, bottom_right = (size_t)(i + 1) * cols + 1;
+    projectPoints(p, Z + k, &m_cornerX[top_left], &m_cornerY[top_left], &m_cornerZ[top_left], m_depthWidth, &m_u0[k], &m_v0[k]);
+    projectPoints(p, Z + k, &m_cornerX[bottom_right], &m_cornerY[bottom_right], &m_cornerZ[bottom_right], m_depthWidth, &m_u1[k], &m_v1[k]);
+    for (unsigned int j = 0; j < m_depthWidth; j++)
+      m_Zc[k + j] = Z[k + j] * m_centerZ[k + j] + m_tz;
+  }
+
+  // Z-buffer: each depth pixel covers the color pixels of its footprint
+  std::fill(m_zbuffer.begin(), m_zbuffer.end(), 0.f);
+  const float umax = (float)m_colorWidth - 0.5f, vmax = (float)m_colorHeight - 0.5f;
+  const size_t size = (size_t)m_depthHeight * m_depthWidth;
+  for (size_t k = 0; k < size; k++) {
+    if (m_u0[k] <= vpInvalidProjection || m_u1[k] <= vpInvalidProjection)
+      continue;
+    const float umin_ = std::max(std::min(m_u0[k], m_u1[k]), -0.5f), umax_ = std::min(std::max(m_u0[k], m_u1[k]), umax);
+    const float vmin_ = std::max(std::min(m_v0[k], m_v1[k]), -0.5f), vmax_ = std::min(std::max(m_v0[k], m_v1[k]), vmax);
+    if (umin_ > umax_ || vmin_ > vmax_)
+      continue;
+
+    const unsigned int j0 = (unsigned int)(umin_ + 0.5f), j1 = std::min((unsigned int)(umax_ + 0.5f), m_colorWidth - 1);
+    const unsigned int i0 = (unsigned int)(vmin_ + 0.5f), i1 = std::min((unsigned int)(vmax_ + 0.5f), m_colorHeight - 1);
+    const float Zc = m_Zc[k];
+    for (unsigned int i = i0; i <= i1; i++) {
+      float *zb = &m_zbuffer[(size_t)i * m_colorWidth];
+      for (unsigned int j = j0; j <= j1; j++) {
+        if (zb[j] == 0.f || Zc < zb[j])
+          zb[j] = Zc;
+      }
+    }
+  }
+}
@@ -0,0 +1,378 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test depth image filtering.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testDepthFilter.cpp
+
+  \brief Test depth image decimation, spatial and temporal filtering and hole
+  filling on synthetic or recorded depth images.
+*/
+
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/sensor/vpDepthFilter.h>
+
+//! List of allowed command line options
+#define GETOPTARGS	"cdhi:n:"
+
+void usage(const char *name, const char *badparam, unsigned int nbIter);
+bool getOptions(int argc, const char **argv, std::string &ipath, unsigned int &nbIter);
+
+/*!
+
+Print the program options.
+
+\param name : Program name.
+\param badparam : Bad parameter name.
+\param nbIter : Number of benchmark iterations.
+
+ */
+void usage(const char *name, const char *badparam, unsigned int nbIter)
+{
+  fprintf(stdout, "\n\
+Test depth image filtering.\n\
+\n\
+SYNOPSIS\n\
+  %s [-i <depth image>] [-n <number of iterations>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -i <depth image>\n\
+     16 bits PGM depth image, for example recorded with a\n\
+     RealSense camera, used for the benchmark instead of a\n\
+     synthetic depth image.\n\
+\n\
+  -n <number of iterations>                            %u\n\
+     Number of iterations used to benchmark the filters.\n\
+\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", nbIter);
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param ipath : Depth image used for the benchmark.
+  \param nbIter : Number of benchmark iterations.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv, std::string &ipath, unsigned int &nbIter)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'i': ipath = optarg_; break;
+    case 'n': nbIter = (unsigned int)atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, nbIter); return false; break;
+
+    default:
+      usage(argv[0], optarg_, nbIter); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbIter);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  // Straightforward implementation of the spatial filter used as reference
+  void blend(float &cur, float prev, float alpha, float delta)
+  {
+    if (cur > 0 && prev > 0 && std::fabs(cur - prev) < delta)
+      cur = prev + alpha * (cur - prev);
+  }
+
+  void spatialFilterReference(vpImage<float> &Z, float alpha, float delta, unsigned int iterations)
+  {
+    const int h = (int)Z.getHeight(), w = (int)Z.getWidth();
+    for (unsigned int iter = 0; iter < iterations; iter++) {
+      for (int i = 0; i < h; i++) {
+        for (int j = 1; j < w; j++) blend(Z[i][j], Z[i][j-1], alpha, delta);
+        for (int j = w - 2; j >= 0; j--) blend(Z[i][j], Z[i][j+1], alpha, delta);
+      }
+      for (int j = 0; j < w; j++) {
+        for (int i = 1; i < h; i++) blend(Z[i][j], Z[i-1][j], alpha, delta);
+        for (int i = h - 2; i >= 0; i--) blend(Z[i][j], Z[i+1][j], alpha, delta);
+      }
+    }
+  }
+
+  // Synthetic depth in mm: two planes separated by a step, noise and holes
+  void syntheticDepth(vpImage<uint16_t> &depth, unsigned int frame)
+  {
+    for (unsigned int i = 0; i < depth.getHeight(); i++) {
+      for (unsigned int j = 0; j < depth.getWidth(); j++) {
+        unsigned int noise = (i * 31 + j * 17 + frame * 13) % 11;
+        if ((i * 7 + j * 3 + frame) % 23 == 0)
+          depth[i][j] = 0;
+        else
+          depth[i][j] = (uint16_t)((j < depth.getWidth() / 2 ? 1000 : 1500) + noise);
+      }
+    }
+  }
+
+  double stdDev(const vpImage<uint16_t> &I, unsigned int j0, unsigned int j1)
+  {
+    double sum = 0, sum2 = 0;
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = j0; j < j1; j++) {
+        if (I[i][j]) {
+          sum += I[i][j];
+          sum2 += I[i][j] * (double)I[i][j];
+          n++;
+        }
+      }
+    }
+    return n ? sqrt(sum2 / n - (sum / n) * (sum / n)) : 0.;
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    std::string ipath;
+    unsigned int nbIter = 20;
+    if (getOptions(argc, argv, ipath, nbIter) == false) {
+      exit (-1);
+    }
+
+    // Decimation: median of the valid values of each block
+    {
+      vpImage<uint16_t> I(4, 6, 0), Idec;
+      I[0][0] = 10; I[0][1] = 30; I[1][0] = 20; // Median of 3 values
+      I[2][2] = 7;                              // Single valid value
+      I[0][4] = 5; I[0][5] = 1; I[1][4] = 9; I[1][5] = 3;
+      vpDepthFilter::decimate(I, Idec, 2);
+      if (Idec.getHeight() != 2 || Idec.getWidth() != 3 || Idec[0][0] != 20 || Idec[1][1] != 7
+          || Idec[0][1] != 0 || (Idec[0][2] != 5 && Idec[0][2] != 3)) {
+        std::cerr << "Bad decimation" << std::endl;
+        return EXIT_FAILURE;
+      }
+      bool exception = false;
+      try {
+        vpDepthFilter::decimate(I, Idec, 9);
+      }
+      catch(const vpException &) {
+        exception = true;
+      }
+      if (! exception) {
+        std::cerr << "Decimation factor 9 should be refused" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Hole filling
+    {
+      const uint16_t row[7] = { 0, 5, 0, 0, 9, 0, 0 };
+      const uint16_t left[7] = { 0, 5, 5, 5, 9, 9, 9 };
+      const uint16_t nearest[7] = { 5, 5, 5, 5, 9, 9, 9 };
+      const uint16_t farthest[7] = { 5, 5, 9, 9, 9, 9, 9 };
+      const uint16_t *expected[3] = { left, nearest, farthest };
+      const vpDepthFilter::vpHoleFillingType types[3] = { vpDepthFilter::HOLE_FILLING_LEFT, vpDepthFilter::HOLE_FILLING_NEAREST,
+                                                          vpDepthFilter::HOLE_FILLING_FARTHEST };
+      for (unsigned int t = 0; t < 3; t++) {
+        vpImage<uint16_t> I(2, 7, 0);
+        vpImage<float> If(2, 7, -1.f);
+        for (unsigned int j = 0; j < 7; j++) {
+          I[0][j] = row[j];
+          if (row[j]) If[0][j] = row[j];
+        }
+        vpDepthFilter::fillHoles(I, types[t]);
+        vpDepthFilter::fillHoles(If, types[t]);
+        for (unsigned int j = 0; j < 7; j++) {
+          float expected_f = expected[t][j] ? (float)expected[t][j] : -1.f;
+          if (I[0][j] != expected[t][j] || std::fabs(If[0][j] - expected_f) > 0 || I[1][j] != 0) {
+            std::cerr << "Bad hole filling of type " << t << " at column " << j << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // Spatial filter against the reference implementation; the width is not
+    // a multiple of 4 to test the scalar tail of the vectorized passes
+    vpImage<uint16_t> depth(97, 131);
+    syntheticDepth(depth, 0);
+    {
+      vpImage<float> Z(depth.getHeight(), depth.getWidth()), Zref;
+      for (unsigned int k = 0; k < depth.getSize(); k++)
+        Z.bitmap[k] = depth.bitmap[k] ? depth.bitmap[k] : -1.f;
+      Zref = Z;
+      spatialFilterReference(Zref, 0.5f, 20.f, 2);
+      vpDepthFilter::spatialFilter(Z, 0.5f, 20.f, 2);
+      for (unsigned int k = 0; k < Z.getSize(); k++) {
+        if (std::fabs(Z.bitmap[k] - Zref.bitmap[k]) > 1e-3f) {
+          std::cerr << "Spatial filter differs from the reference at pixel " << k << ": "
+                    << Z.bitmap[k] << " instead of " << Zref.bitmap[k] << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      vpImage<uint16_t> filtered = depth;
+      vpDepthFilter::spatialFilter(filtered, 0.5f, 20.f, 2);
+      double std_before = stdDev(depth, 0, depth.getWidth() / 2 - 1);
+      double std_after = stdDev(filtered, 0, depth.getWidth() / 2 - 1);
+      std::cout << "Spatial filter: standard deviation " << std_before << " -> " << std_after << std::endl;
+      if (std_after >= std_before) {
+        std::cerr << "Spatial filter does not reduce the noise" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int i = 0; i < depth.getHeight(); i++) {
+        for (unsigned int j = 0; j < depth.getWidth(); j++) {
+          // The step of 500 mm is preserved and holes are not modified
+          bool far_plane = j >= depth.getWidth() / 2;
+          if ((depth[i][j] == 0) != (filtered[i][j] == 0) ||
+              (filtered[i][j] && (far_plane ? filtered[i][j] < 1400 : filtered[i][j] > 1100))) {
+            std::cerr << "Spatial filter does not preserve pixel (" << i << ", " << j << ")" << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // Temporal filter
+    {
+      vpDepthFilter filter;
+      filter.setTemporalFilterParameters(0.3f, 30.f, 2);
+      vpImage<uint16_t> I(depth.getHeight(), depth.getWidth());
+      for (unsigned int frame = 0; frame < 10; frame++) {
+        syntheticDepth(I, frame);
+        filter.temporalFilter(I);
+      }
+      vpImage<uint16_t> Iraw(depth.getHeight(), depth.getWidth());
+      syntheticDepth(Iraw, 10);
+      I = Iraw;
+      filter.temporalFilter(I);
+      double std_before = stdDev(Iraw, 0, depth.getWidth() / 2 - 1);
+      double std_after = stdDev(I, 0, depth.getWidth() / 2 - 1);
+      std::cout << "Temporal filter: standard deviation " << std_before << " -> " << std_after << std::endl;
+      if (std_after >= std_before) {
+        std::cerr << "Temporal filter does not reduce the noise" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // A large depth change is an edge that is not smoothed
+      I = 3000;
+      filter.temporalFilter(I);
+      if (I[10][10] != 3000) {
+        std::cerr << "Temporal filter smooths a depth edge" << std::endl;
+        return EXIT_FAILURE;
+      }
+      // A hole is filled with the last valid depth during 2 frames
+      for (unsigned int frame = 0; frame < 3; frame++) {
+        I = 0;
+        filter.temporalFilter(I);
+        if (I[10][10] != (frame < 2 ? 3000 : 0)) {
+          std::cerr << "Bad temporal hole filling at frame " << frame << ": " << I[10][10] << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Benchmark of the filtering pipeline
+    vpImage<uint16_t> depth_bench;
+    if (! ipath.empty()) {
+      vpImageIo::readPGM(depth_bench, ipath);
+    }
+    else {
+      depth_bench.resize(480, 640);
+      syntheticDepth(depth_bench, 0);
+    }
+
+    vpDepthFilter filter;
+    vpImage<uint16_t> I, Idec;
+    double t_decimate = 0, t_spatial = 0, t_temporal = 0, t_holes = 0;
+    for (unsigned int iter = 0; iter < nbIter; iter++) {
+      I = depth_bench;
+      double t = vpTime::measureTimeMs();
+      vpDepthFilter::decimate(I, Idec, 2);
+      t_decimate += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      vpDepthFilter::spatialFilter(I);
+      t_spatial += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      filter.temporalFilter(I);
+      t_temporal += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      vpDepthFilter::fillHoles(I);
+      t_holes += vpTime::measureTimeMs() - t;
+    }
+    if (nbIter) {
+      std::cout << "Filtering of a " << depth_bench.getWidth() << "x" << depth_bench.getHeight() << " depth image: " << std::endl;
+      std::cout << "  decimation by 2: " << t_decimate / nbIter << " ms" << std::endl;
+      std::cout << "  spatial filter:  " << t_spatial / nbIter << " ms" << std::endl;
+      std::cout << "  temporal filter: " << t_temporal / nbIter << " ms" << std::endl;
+      std::cout << "  hole filling:    " << t_holes / nbIter << " ms" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
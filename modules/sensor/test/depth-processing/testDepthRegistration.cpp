@@ -0,0 +1,316 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test registration of depth and color images.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testDepthRegistration.cpp
+
+  \brief Test the alignment of color images in the depth camera frame and of
+  depth images in the color camera frame against a per pixel reference.
+*/
+
+#include <stdlib.h>
+#include <cmath>
+#include <iostream>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/sensor/vpDepthRegistration.h>
+
+//! List of allowed command line options
+#define GETOPTARGS	"cdhn:"
+
+void usage(const char *name, const char *badparam, unsigned int nbIter);
+bool getOptions(int argc, const char **argv, unsigned int &nbIter);
+
+/*!
+
+Print the program options.
+
+\param name : Program name.
+\param badparam : Bad parameter name.
+\param nbIter : Number of benchmark iterations.
+
+ */
+void usage(const char *name, const char *badparam, unsigned int nbIter)
+{
+  fprintf(stdout, "\n\
+Test registration of depth and color images.\n\
+\n\
+SYNOPSIS\n\
+  %s [-n <number of iterations>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -n <number of iterations>                            %u\n\
+     Number of iterations used to benchmark the registration.\n\
+\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", nbIter);
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param nbIter : Number of benchmark iterations.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv, unsigned int &nbIter)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'n': nbIter = (unsigned int)atoi(optarg_); break;
+    case 'h': usage(argv[0], NULL, nbIter); return false; break;
+
+    default:
+      usage(argv[0], optarg_, nbIter); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbIter);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  // Per pixel reference implementation of the color to depth alignment
+  void alignColorToDepthReference(const vpImage<vpRGBa> &color, const vpImage<uint16_t> &depth, float depth_scale,
+                                  const vpCameraParameters &cam_depth, const vpCameraParameters &cam_color,
+                                  const vpHomogeneousMatrix &cMd, vpImage<vpRGBa> &color_aligned)
+  {
+    color_aligned.resize(depth.getHeight(), depth.getWidth());
+    vpColVector P1(4), P2(4);
+    for (unsigned int i = 0; i < depth.getHeight(); i++) {
+      for (unsigned int j = 0; j < depth.getWidth(); j++) {
+        color_aligned[i][j] = vpRGBa(0, 0, 0, vpRGBa::alpha_default);
+        double Z = depth[i][j] * depth_scale;
+        if (Z <= 0)
+          continue;
+        double x = 0., y = 0., u = 0., v = 0.;
+        vpPixelMeterConversion::convertPoint(cam_depth, j, i, x, y);
+        P1[0] = x * Z; P1[1] = y * Z; P1[2] = Z; P1[3] = 1;
+        P2 = cMd * P1;
+        if (P2[2] <= 0)
+          continue;
+        vpMeterPixelConversion::convertPoint(cam_color, P2[0] / P2[2], P2[1] / P2[2], u, v);
+        if (u < -0.5 || v < -0.5)
+          continue;
+        unsigned int u_ = (unsigned int)(u + 0.5), v_ = (unsigned int)(v + 0.5);
+        if (u_ < color.getWidth() && v_ < color.getHeight())
+          color_aligned[i][j] = color[v_][u_];
+      }
+    }
+  }
+
+  bool sameColor(const vpRGBa &a, const vpRGBa &b)
+  {
+    return a.R == b.R && a.G == b.G && a.B == b.B;
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    unsigned int nbIter = 20;
+    if (getOptions(argc, argv, nbIter) == false) {
+      exit (-1);
+    }
+
+    const unsigned int depth_height = 121, depth_width = 163;
+    const unsigned int color_height = 242, color_width = 326;
+    const float depth_scale = 0.001f;
+
+    // Synthetic depth in mm with holes and a color image where each pixel has a unique color
+    vpImage<uint16_t> depth(depth_height, depth_width);
+    for (unsigned int i = 0; i < depth_height; i++) {
+      for (unsigned int j = 0; j < depth_width; j++) {
+        depth[i][j] = ((i + 3 * j) % 19 == 0) ? 0 : (uint16_t)(800 + (i * 5 + j * 3) % 700);
+      }
+    }
+    vpImage<vpRGBa> color(color_height, color_width);
+    for (unsigned int i = 0; i < color_height; i++) {
+      for (unsigned int j = 0; j < color_width; j++) {
+        color[i][j] = vpRGBa((unsigned char)(i % 256), (unsigned char)(j % 256), (unsigned char)((i / 256) * 16 + j / 256), vpRGBa::alpha_default);
+      }
+    }
+
+    vpCameraParameters cam_depth, cam_color;
+    cam_depth.initPersProjWithDistortion(150., 152., 81.5, 60.2, -0.1, 0.1);
+    cam_color.initPersProjWithoutDistortion(300., 301., 163., 121.);
+    vpHomogeneousMatrix cMd(0.025, 0.002, -0.001, vpMath::rad(0.5), vpMath::rad(-1.), vpMath::rad(0.2));
+
+    vpDepthRegistration registration;
+    registration.init(cam_depth, depth_height, depth_width, cam_color, color_height, color_width, cMd, depth_scale);
+
+    // Color to depth against the reference; rounding differences between the
+    // float and double computations can change a few nearest pixels
+    vpImage<vpRGBa> color_aligned, color_reference;
+    registration.alignColorToDepth(color, depth, color_aligned);
+    alignColorToDepthReference(color, depth, depth_scale, cam_depth, cam_color, cMd, color_reference);
+    unsigned int nb_diff = 0;
+    for (unsigned int k = 0; k < color_aligned.getSize(); k++) {
+      if (! sameColor(color_aligned.bitmap[k], color_reference.bitmap[k]))
+        nb_diff++;
+      if (depth.bitmap[k] == 0 && ! sameColor(color_aligned.bitmap[k], vpRGBa(0, 0, 0)))
+        nb_diff += 1000;
+    }
+    std::cout << "Color to depth: " << nb_diff << " pixels differ from the reference" << std::endl;
+    if (nb_diff > color_aligned.getSize() / 200) {
+      std::cerr << "Color to depth alignment differs from the reference" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Same result with a float depth in meter where holes are set to -1
+    vpImage<float> depth_float(depth_height, depth_width);
+    for (unsigned int k = 0; k < depth.getSize(); k++)
+      depth_float.bitmap[k] = depth.bitmap[k] ? depth.bitmap[k] * depth_scale : -1.f;
+    vpImage<vpRGBa> color_aligned_float;
+    registration.alignColorToDepth(color, depth_float, color_aligned_float);
+    for (unsigned int k = 0; k < color_aligned.getSize(); k++) {
+      if (! sameColor(color_aligned.bitmap[k], color_aligned_float.bitmap[k])) {
+        std::cerr << "Color to depth alignment differs with a float depth" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Depth to color with a fronto-parallel plane at 1 m and a translation
+    // along X: the aligned depth is 1 m wherever it is defined, and the
+    // footprint of the depth pixels covers the color image without holes
+    vpImage<uint16_t> plane(depth_height, depth_width, 1000), plane_aligned;
+    vpCameraParameters cam_depth_pinhole(150., 150., 81., 60.);
+    vpDepthRegistration registration_plane;
+    registration_plane.init(cam_depth_pinhole, depth_height, depth_width, cam_color, color_height, color_width,
+                            vpHomogeneousMatrix(0.02, 0., 0., 0., 0., 0.), depth_scale);
+    registration_plane.alignDepthToColor(plane, plane_aligned);
+    unsigned int nb_holes = 0;
+    for (unsigned int i = 10; i < color_height - 10; i++) {
+      for (unsigned int j = 20; j < color_width - 20; j++) {
+        if (plane_aligned[i][j] == 0) {
+          nb_holes++;
+        }
+        else if (plane_aligned[i][j] != 1000) {
+          std::cerr << "Bad aligned depth " << plane_aligned[i][j] << " at (" << i << ", " << j << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    if (nb_holes) {
+      std::cerr << "Depth to color alignment has " << nb_holes << " holes" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A nearer object hides the plane behind it. The color pixel where
+    // depth pixel (60, 73) of the object projects is also the projection of
+    // depth pixel (60, 76) of the plane.
+    for (unsigned int i = 50; i < 70; i++)
+      for (unsigned int j = 60; j < 75; j++)
+        plane[i][j] = 500;
+    registration_plane.alignDepthToColor(plane, plane_aligned);
+    vpImage<float> plane_float(depth_height, depth_width), plane_aligned_float;
+    for (unsigned int k = 0; k < plane.getSize(); k++)
+      plane_float.bitmap[k] = plane.bitmap[k] * depth_scale;
+    registration_plane.alignDepthToColor(plane_float, plane_aligned_float);
+
+    double u = 0., v = 0.;
+    vpMeterPixelConversion::convertPoint(cam_color, ((73. - 81.) / 150. * 0.5 + 0.02) / 0.5, 0., u, v);
+    unsigned int i_ = (unsigned int)(v + 0.5), j_ = (unsigned int)(u + 0.5);
+    if (plane_aligned[i_][j_] != 500 || std::fabs(plane_aligned_float[i_][j_] - 0.5f) > 1e-4f) {
+      std::cerr << "The nearest depth is not kept: " << plane_aligned[i_][j_] << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Benchmark at VGA resolution
+    vpImage<uint16_t> depth_vga(480, 640), depth_vga_aligned;
+    for (unsigned int i = 0; i < depth_vga.getHeight(); i++)
+      for (unsigned int j = 0; j < depth_vga.getWidth(); j++)
+        depth_vga[i][j] = (uint16_t)(600 + (i * 3 + j * 5) % 3000);
+    vpImage<vpRGBa> color_vga(480, 640, vpRGBa(128, 128, 128, vpRGBa::alpha_default)), color_vga_aligned;
+    vpDepthRegistration registration_vga;
+    registration_vga.init(vpCameraParameters(475., 475., 320., 240.), 480, 640,
+                          vpCameraParameters(615., 615., 320., 240.), 480, 640, cMd, depth_scale);
+
+    double t_color = 0, t_depth = 0, t_reference = 0;
+    for (unsigned int iter = 0; iter < nbIter; iter++) {
+      double t = vpTime::measureTimeMs();
+      registration_vga.alignColorToDepth(color_vga, depth_vga, color_vga_aligned);
+      t_color += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      registration_vga.alignDepthToColor(depth_vga, depth_vga_aligned);
+      t_depth += vpTime::measureTimeMs() - t;
+    }
+    if (nbIter) {
+      double t = vpTime::measureTimeMs();
+      alignColorToDepthReference(color_vga, depth_vga, depth_scale, vpCameraParameters(475., 475., 320., 240.),
+                                 vpCameraParameters(615., 615., 320., 240.), cMd, color_vga_aligned);
+      t_reference = vpTime::measureTimeMs() - t;
+
+      std::cout << "Registration of 640x480 images: " << std::endl;
+      std::cout << "  color to depth, per pixel reference: " << t_reference << " ms" << std::endl;
+      std::cout << "  color to depth:                      " << t_color / nbIter << " ms" << std::endl;
+      std::cout << "  depth to color:                      " << t_depth / nbIter << " ms" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
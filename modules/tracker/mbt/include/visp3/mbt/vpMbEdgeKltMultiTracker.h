@@ -69,6 +69,12 @@
   or in a cao file. The cao format is described in loadCAOModel().
   It may also use an xml file used to tune the behavior of the tracker and an
   init file used to compute the pose at the very first image.
+
+  The cameras can be tracked concurrently with setParallelCameraTracking()
+  when ViSP is built with OpenMP. The moving edges and the KLT points of each
+  camera are then tracked in separate threads, and each camera fills its own
+  blocks of the stacked interaction matrix, so that the estimated pose does
+  not depend on this option.
 */
 class VISP_EXPORT vpMbEdgeKltMultiTracker: public vpMbEdgeMultiTracker, public vpMbKltMultiTracker
 {
@@ -174,6 +180,15 @@ public:
     return (unsigned int) m_mapOfKltTrackers.size();
   }
 
+  /*!
+    Return true if the cameras are tracked concurrently.
+
+    \sa setParallelCameraTracking()
+  */
+  virtual inline bool getParallelCameraTracking() const {
+    return vpMbEdgeMultiTracker::m_parallelCameraTracking;
+  }
+
   using vpMbKltMultiTracker::getPose;
   virtual void getPose(vpHomogeneousMatrix &c1Mo, vpHomogeneousMatrix &c2Mo) const;
   virtual void getPose(const std::string &cameraName, vpHomogeneousMatrix &cMo_) const;
@@ -323,6 +338,8 @@ public:
 
   virtual void setOptimizationMethod(const vpMbtOptimizationMethod &opt);
 
+  virtual void setParallelCameraTracking(const bool parallel);
+
   virtual void setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo);
 
   virtual void setPose(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2, const vpHomogeneousMatrix &c1Mo,
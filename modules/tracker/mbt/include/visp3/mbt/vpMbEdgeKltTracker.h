@@ -74,6 +74,16 @@
   It may also use an xml file used to tune the behavior of the tracker and an
   init file used to compute the pose at the very first image.
 
+  At each call to track(), the keypoints are tracked with KLT and the moving
+  edges are searched in the image before the pose is estimated from both
+  kinds of features. When ViSP is built with OpenMP, setParallelTracking()
+  allows to run the KLT and the moving-edges searches at the same time in two
+  threads. The moving edges that have to be initialized are then positioned
+  with the pose predicted from the previous image instead of the pose refined
+  with the keypoints. The time spent in each stage of the last call to track()
+  is given by getKltTrackingTime(), getMovingEdgeTrackingTime(),
+  getVVSTime() and getPostTrackingTime().
+
   The following code shows the simplest way to use the tracker. The \ref tutorial-tracking-mb is also a good starting point to use this class.
   
 \code
@@ -235,6 +245,16 @@ protected:
   double thresholdMBT;
   //! The maximum iteration of the virtual visual servoing stage.
   unsigned int  maxIter;
+  //! If true, the KLT and the moving-edges searches are run concurrently.
+  bool m_parallelTracking;
+  //! Time spent in the KLT tracking during the last call to track() (ms).
+  double m_kltTrackingTime;
+  //! Time spent in the moving-edges tracking during the last call to track() (ms).
+  double m_meTrackingTime;
+  //! Time spent in the pose estimation during the last call to track() (ms).
+  double m_vvsTime;
+  //! Time spent in the post tracking during the last call to track() (ms).
+  double m_postTrackingTime;
 
 public:
   
@@ -246,6 +266,13 @@ public:
   virtual void display(const vpImage<vpRGBa>& I, const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam,
                        const vpColor& col, const unsigned int thickness=1, const bool displayFullModel = false);
 
+  /*!
+    Get the time spent in the KLT tracking during the last call to track().
+
+    \return Time in ms.
+   */
+  inline double getKltTrackingTime() const {return m_kltTrackingTime;}
+
   /*!
     Get the value of the gain used to compute the control law.
 
@@ -259,6 +286,14 @@ public:
     \return the number of iteration
    */
   virtual inline  unsigned int getMaxIter() const {return maxIter;}
+
+  /*!
+    Get the time spent in the moving-edges tracking during the last call to
+    track().
+
+    \return Time in ms.
+   */
+  inline double getMovingEdgeTrackingTime() const {return m_meTrackingTime;}
   
   /*!
     Get the near distance for clipping.
@@ -267,6 +302,29 @@ public:
    */
   virtual inline  double getNearClippingDistance() const { return vpMbKltTracker::getNearClippingDistance(); }
 
+  /*!
+    Return true if the KLT and the moving-edges searches are run concurrently.
+
+    \sa setParallelTracking()
+   */
+  inline bool getParallelTracking() const {return m_parallelTracking;}
+
+  /*!
+    Get the time spent in the post tracking (visibility tests and update of
+    the features) during the last call to track().
+
+    \return Time in ms.
+   */
+  inline double getPostTrackingTime() const {return m_postTrackingTime;}
+
+  /*!
+    Get the time spent in the pose estimation from the KLT and the moving-edges
+    features during the last call to track().
+
+    \return Time in ms.
+   */
+  inline double getVVSTime() const {return m_vvsTime;}
+
   void loadConfigFile(const char* configFile);
   virtual void loadConfigFile(const std::string& configFile);
   
@@ -315,6 +373,8 @@ public:
    */
   virtual void setNearClippingDistance(const double &dist) { vpMbEdgeTracker::setNearClippingDistance(dist); }
 
+  void setParallelTracking(const bool parallel);
+
   /*!
     Use Ogre3D for visibility tests
 
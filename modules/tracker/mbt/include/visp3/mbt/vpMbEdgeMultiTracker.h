@@ -63,6 +63,12 @@
   or in a cao file. The cao format is described in loadCAOModel().
   It may also use an xml file used to tune the behavior of the tracker and an
   init file used to compute the pose at the very first image.
+
+  The cameras can be tracked concurrently with setParallelCameraTracking()
+  when ViSP is built with OpenMP: the moving edges of each camera are searched
+  in a separate thread, and each camera fills its own block of the stacked
+  interaction matrix. The blocks are stacked in the order of the camera names,
+  so that the estimated pose does not depend on this option.
 */
 class VISP_EXPORT vpMbEdgeMultiTracker: public vpMbEdgeTracker
 {
@@ -79,6 +85,9 @@ protected:
   //! Name of the reference camera
   std::string m_referenceCameraName;
 
+  //! If true, the cameras are tracked concurrently
+  bool m_parallelCameraTracking;
+
 
 public:
   // Default constructor <==> equivalent to vpMbEdgeTracker
@@ -164,6 +173,15 @@ public:
     return (unsigned int) m_mapOfEdgeTrackers.size();
   }
 
+  /*!
+    Return true if the cameras are tracked concurrently.
+
+    \sa setParallelCameraTracking()
+  */
+  virtual inline bool getParallelCameraTracking() const {
+    return m_parallelCameraTracking;
+  }
+
   using vpMbTracker::getPose;
   virtual void getPose(vpHomogeneousMatrix &c1Mo, vpHomogeneousMatrix &c2Mo) const;
   virtual void getPose(const std::string &cameraName, vpHomogeneousMatrix &cMo_) const;
@@ -302,6 +320,8 @@ public:
 
   virtual void setOptimizationMethod(const vpMbtOptimizationMethod &opt);
 
+  virtual void setParallelCameraTracking(const bool parallel);
+
   virtual void setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo);
 
   virtual void setPose(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2, const vpHomogeneousMatrix &c1Mo,
@@ -311,6 +311,13 @@ class VISP_EXPORT vpMbEdgeTracker: virtual public vpMbTracker
     //! Number of features used in the computation of the projection error
     unsigned int nbFeaturesForProjErrorComputation;
 
+    //! Norm of the pose increment below which the virtual visual servoing is stopped (0 to disable)
+    double m_poseIncrementThreshold;
+    //! Number of iterations of the first phase of the last virtual visual servoing
+    unsigned int m_nbFirstPhaseIterations;
+    //! Number of iterations of the second phase of the last virtual visual servoing
+    unsigned int m_nbSecondPhaseIterations;
+
 public:
   
   vpMbEdgeTracker(); 
@@ -349,6 +356,29 @@ public:
   virtual inline vpMe getMovingEdge() const { return this->me;}
 
   virtual unsigned int getNbPoints(const unsigned int level=0) const;
+
+  /*!
+    Return the number of iterations of the first phase (without robust
+    estimation) of the virtual visual servoing of the last tracked image.
+
+    \sa getNbSecondPhaseIterations()
+  */
+  inline unsigned int getNbFirstPhaseIterations() const { return m_nbFirstPhaseIterations; }
+  /*!
+    Return the number of iterations of the second phase (with robust
+    estimation) of the virtual visual servoing of the last tracked image.
+
+    \sa getNbFirstPhaseIterations(), setPoseIncrementThreshold()
+  */
+  inline unsigned int getNbSecondPhaseIterations() const { return m_nbSecondPhaseIterations; }
+
+  /*!
+    Return the norm of the pose increment below which the virtual visual
+    servoing is stopped, or 0 if this stopping criterion is disabled.
+
+    \sa setPoseIncrementThreshold()
+  */
+  inline double getPoseIncrementThreshold() const { return m_poseIncrementThreshold; }
   
   /*!
     Return the scales levels used for the tracking. 
@@ -460,6 +490,8 @@ public:
   void setMovingEdge(const vpMe &me);
 
   virtual void setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatrix& cdMo);
+
+  void setPoseIncrementThreshold(const double threshold);
   
   void setScales(const std::vector<bool>& _scales);
 
@@ -488,6 +520,7 @@ protected:
       vpColVector &weighted_error, vpMatrix &L, bool &isoJoIdentity_);
   void computeVVSSecondPhase(const vpImage<unsigned char>& I, vpMatrix &L, vpColVector &error_lines,
       vpColVector &error_cylinders, vpColVector &error_circles, vpColVector &error, const unsigned int lvl);
+  bool computeVVSSecondPhaseConverged(const vpHomogeneousMatrix &cMoPrev) const;
   void computeVVSSecondPhaseCheckLevenbergMarquardt(const unsigned int iter, const unsigned int nbrow,
       const vpColVector &m_error_prev, const vpColVector &m_w_prev, const vpHomogeneousMatrix &cMoPrev,
       double &mu, bool &reStartFromLastIncrement);
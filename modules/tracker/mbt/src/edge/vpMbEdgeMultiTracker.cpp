@@ -48,12 +48,15 @@
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 
+#include "vpMbtCameraExceptions.h"
+
 
 /*!
   Basic constructor
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker() : m_mapOfCameraTransformationMatrix(), m_mapOfEdgeTrackers(),
-    m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfPyramidalImages(), m_referenceCameraName("Camera"),
+    m_parallelCameraTracking(false) {
   m_mapOfEdgeTrackers["Camera"] = new vpMbEdgeTracker();
 
   //Add default camera transformation matrix
@@ -66,7 +69,8 @@ vpMbEdgeMultiTracker::vpMbEdgeMultiTracker() : m_mapOfCameraTransformationMatrix
   \param nbCameras : Number of cameras to use.
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const unsigned int nbCameras) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera"),
+    m_parallelCameraTracking(false) {
 
   if(nbCameras == 0) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbEdgeMultiTracker with no camera !");
@@ -107,7 +111,8 @@ vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const unsigned int nbCameras) : m_map
   \param cameraNames : List of camera names.
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const std::vector<std::string> &cameraNames) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera"),
+    m_parallelCameraTracking(false) {
 
   if(cameraNames.empty()) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbEdgeMultiTracker with no camera !");
@@ -237,7 +242,6 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
   unsigned int iter = 0;
   vpColVector weighted_error;
   vpColVector factor;
-  std::map<std::string, vpColVector> mapOfFactors;
 
   //Parametre pour la premiere phase d'asservissement
   bool reloop = true;
@@ -252,15 +256,45 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
     mapOfVelocityTwist[it->first] = cVo;
   }
 
+  // Cameras in the map order, with the position of their features in the stacked system
+  int nbCameras = (int)m_mapOfEdgeTrackers.size();
+  bool parallel = m_parallelCameraTracking && nbCameras > 1;
+  std::vector<vpMbEdgeTracker *> trackers;
+  std::vector<const vpImage<unsigned char> *> images;
+  std::vector<vpVelocityTwistMatrix> twists;
+  std::vector<unsigned int> nbRows, rowOffsets, nbLines, lineOffsets;
+  std::vector<unsigned int> nbCylinders, cylinderOffsets, nbCircles, circleOffsets;
+  std::vector<vpColVector> factors((size_t)nbCameras);
+  unsigned int rowOffset = 0, lineOffset = 0, cylinderOffset = 0, circleOffset = 0;
+  for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+      it != m_mapOfEdgeTrackers.end(); ++it) {
+    trackers.push_back(it->second);
+    images.push_back(mapOfImages[it->first]);
+    twists.push_back(mapOfVelocityTwist[it->first]);
+
+    nbRows.push_back(mapOfNumberOfRows[it->first]);
+    rowOffsets.push_back(rowOffset);
+    rowOffset += nbRows.back();
+
+    nbLines.push_back(mapOfNumberOfLines[it->first]);
+    lineOffsets.push_back(lineOffset);
+    lineOffset += nbLines.back();
+
+    nbCylinders.push_back(mapOfNumberOfCylinders[it->first]);
+    cylinderOffsets.push_back(cylinderOffset);
+    cylinderOffset += nbCylinders.back();
+
+    nbCircles.push_back(mapOfNumberOfCircles[it->first]);
+    circleOffsets.push_back(circleOffset);
+    circleOffset += nbCircles.back();
+  }
+
 //  std::cout << "\n\n\ncMo used before the first phase=\n" << cMo << std::endl;
 
   /*** First phase ***/
 
   while(reloop == true && iter < 10)
   {
-    m_w.resize(0);
-    m_error.resize(0);
-
     for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
         it != m_mapOfEdgeTrackers.end(); ++it) {
       it->second->cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo;
@@ -270,40 +304,79 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
     {
       weighted_error.resize(nerror);
 
-      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-          it != m_mapOfEdgeTrackers.end(); ++it) {
-        it->second->m_w.resize(mapOfNumberOfRows[it->first]);
-        it->second->m_w = 0;
+      for(size_t i = 0; i < trackers.size(); i++) {
+        trackers[i]->m_w.resize(nbRows[i]);
+        trackers[i]->m_w = 0;
 
-        it->second->m_error.resize(mapOfNumberOfRows[it->first]);
+        trackers[i]->m_error.resize(nbRows[i]);
 
-        mapOfFactors[it->first].resize(mapOfNumberOfRows[it->first]);
-        mapOfFactors[it->first] = 1;
+        factors[i].resize(nbRows[i]);
+        factors[i] = 1;
       }
     }
 
     double count = 0;
     reloop = false;
 
-    L = vpMatrix();
-    factor = vpColVector();
+    if(parallel) {
+      L.resize(nbrow, 6, false);
+      factor.resize(nbrow, false);
+      m_w.resize(nbrow, false);
+      m_error.resize(nbrow, false);
+
+      // Each camera fills its own rows of the stacked system
+      std::vector<double> counts((size_t)nbCameras, 0.0);
+      vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < nbCameras; i++) {
+        vpMbEdgeTracker *tracker = trackers[(size_t)i];
+        try {
+          vpMatrix L_tmp(nbRows[(size_t)i], 6);
 
+          tracker->computeVVSFirstPhase(*images[(size_t)i], iter, L_tmp, factors[(size_t)i], counts[(size_t)i],
+              tracker->m_error, tracker->m_w, lvl);
 
-    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-        it != m_mapOfEdgeTrackers.end(); ++it) {
-      vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
+          L_tmp = L_tmp*twists[(size_t)i];
+
+          L.insert(L_tmp, rowOffsets[(size_t)i], 0);
+          factor.insert(rowOffsets[(size_t)i], factors[(size_t)i]);
+          m_w.insert(rowOffsets[(size_t)i], tracker->m_w);
+          m_error.insert(rowOffsets[(size_t)i], tracker->m_error);
+        } catch(...) {
+          exceptions.setCurrentException((size_t)i);
+        }
+      }
+      exceptions.throwFirst();
+
+      for(size_t i = 0; i < counts.size(); i++) {
+        count += counts[i];
+      }
+    } else {
+      m_w.resize(0);
+      m_error.resize(0);
+
+      L = vpMatrix();
+      factor = vpColVector();
 
-      double count_tmp = 0.0;
-      it->second->computeVVSFirstPhase(*mapOfImages[it->first], iter, L_tmp, mapOfFactors[it->first], count_tmp,
-          it->second->m_error, it->second->m_w, lvl);
-      count += count_tmp;
+      size_t cameraIndex = 0;
+      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+          it != m_mapOfEdgeTrackers.end(); ++it, ++cameraIndex) {
+        vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
 
-      L_tmp = L_tmp*mapOfVelocityTwist[it->first];
+        double count_tmp = 0.0;
+        it->second->computeVVSFirstPhase(*mapOfImages[it->first], iter, L_tmp, factors[cameraIndex], count_tmp,
+            it->second->m_error, it->second->m_w, lvl);
+        count += count_tmp;
 
-      L.stack(L_tmp);
-      factor.stack(mapOfFactors[it->first]);
-      m_w.stack(it->second->m_w);
-      m_error.stack(it->second->m_error);
+        L_tmp = L_tmp*mapOfVelocityTwist[it->first];
+
+        L.stack(L_tmp);
+        factor.stack(factors[cameraIndex]);
+        m_w.stack(it->second->m_w);
+        m_error.stack(it->second->m_error);
+      }
     }
 
     count = count / (double) nbrow;
@@ -315,6 +388,7 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
 
     iter++;
   }
+  m_nbFirstPhaseIterations = iter;
 
 //  std::cout << "\n\t First minimization in " << iter << " iteration give as initial cMo: \n" << cMo << std::endl;
 //  std::cout << "Residual=" << m_error.sum() / m_error.size() << std::endl;
@@ -364,47 +438,106 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
 
   double residu_1 = 1e3;
   double r =1e3-1;
+  bool converged = false;
 
   //while ( ((int)((residu_1 - r)*1e8) != 0 )  && (iter<30))
-  while(std::fabs((residu_1 - r)*1e8) > std::numeric_limits<double>::epsilon() && (iter<30))
+  while(!converged && std::fabs((residu_1 - r)*1e8) > std::numeric_limits<double>::epsilon() && (iter<30))
   {
-    L.resize(0,0);
-    m_error.resize(0);
-
-    error_lines.resize(0);
-    error_cylinders.resize(0);
-    error_circles.resize(0);
-
     std::map<std::string, vpColVector> mapOfErrorLines;
     std::map<std::string, vpColVector> mapOfErrorCylinders;
     std::map<std::string, vpColVector> mapOfErrorCircles;
 
-    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-        it != m_mapOfEdgeTrackers.end(); ++it) {
-      vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
-      vpColVector error_lines_tmp(mapOfNumberOfLines[it->first]);
-      vpColVector error_cylinders_tmp(mapOfNumberOfCylinders[it->first]);
-      vpColVector error_circles_tmp(mapOfNumberOfCircles[it->first]);
+    if(parallel) {
+      L.resize(nbrow, 6, false);
+      m_error.resize(nbrow, false);
+
+      error_lines.resize(lineOffset, false);
+      error_cylinders.resize(cylinderOffset, false);
+      error_circles.resize(circleOffset, false);
+
+      std::vector<vpColVector> errorLines((size_t)nbCameras);
+      std::vector<vpColVector> errorCylinders((size_t)nbCameras);
+      std::vector<vpColVector> errorCircles((size_t)nbCameras);
+
+      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+          it != m_mapOfEdgeTrackers.end(); ++it) {
+        it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
+      }
+
+      // Each camera fills its own rows of the stacked system
+      vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < nbCameras; i++) {
+        size_t k = (size_t)i;
+        try {
+          vpMatrix L_tmp(nbRows[k], 6);
+          errorLines[k].resize(nbLines[k]);
+          errorCylinders[k].resize(nbCylinders[k]);
+          errorCircles[k].resize(nbCircles[k]);
+
+          vpColVector error_tmp;
+          error_tmp.resize(nbRows[k]);
+
+          trackers[k]->computeVVSSecondPhase(*images[k], L_tmp, errorLines[k],
+              errorCylinders[k], errorCircles[k], error_tmp, lvl);
+          L_tmp = L_tmp*twists[k];
+
+          L.insert(L_tmp, rowOffsets[k], 0);
+          m_error.insert(rowOffsets[k], error_tmp);
+
+          error_lines.insert(lineOffsets[k], errorLines[k]);
+          error_cylinders.insert(cylinderOffsets[k], errorCylinders[k]);
+          error_circles.insert(circleOffsets[k], errorCircles[k]);
+        } catch(...) {
+          exceptions.setCurrentException(k);
+        }
+      }
+      exceptions.throwFirst();
+
+      size_t cameraIndex = 0;
+      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+          it != m_mapOfEdgeTrackers.end(); ++it, ++cameraIndex) {
+        mapOfErrorLines[it->first] = errorLines[cameraIndex];
+        mapOfErrorCylinders[it->first] = errorCylinders[cameraIndex];
+        mapOfErrorCircles[it->first] = errorCircles[cameraIndex];
+      }
+    } else {
+      L.resize(0,0);
+      m_error.resize(0);
 
-      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
+      error_lines.resize(0);
+      error_cylinders.resize(0);
+      error_circles.resize(0);
 
-      vpColVector error_tmp;
-      error_tmp.resize(mapOfNumberOfRows[it->first]);
+      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+          it != m_mapOfEdgeTrackers.end(); ++it) {
+        vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
+        vpColVector error_lines_tmp(mapOfNumberOfLines[it->first]);
+        vpColVector error_cylinders_tmp(mapOfNumberOfCylinders[it->first]);
+        vpColVector error_circles_tmp(mapOfNumberOfCircles[it->first]);
 
-      it->second->computeVVSSecondPhase(*mapOfImages[it->first], L_tmp, error_lines_tmp,
-          error_cylinders_tmp, error_circles_tmp, error_tmp, lvl);
-      L_tmp = L_tmp*mapOfVelocityTwist[it->first];
+        it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
 
-      L.stack(L_tmp);
-      m_error.stack(error_tmp);
+        vpColVector error_tmp;
+        error_tmp.resize(mapOfNumberOfRows[it->first]);
 
-      error_lines.stack(error_lines_tmp);
-      error_cylinders.stack(error_cylinders_tmp);
-      error_circles.stack(error_circles_tmp);
+        it->second->computeVVSSecondPhase(*mapOfImages[it->first], L_tmp, error_lines_tmp,
+            error_cylinders_tmp, error_circles_tmp, error_tmp, lvl);
+        L_tmp = L_tmp*mapOfVelocityTwist[it->first];
 
-      mapOfErrorLines[it->first] = error_lines_tmp;
-      mapOfErrorCylinders[it->first] = error_cylinders_tmp;
-      mapOfErrorCircles[it->first] = error_circles_tmp;
+        L.stack(L_tmp);
+        m_error.stack(error_tmp);
+
+        error_lines.stack(error_lines_tmp);
+        error_cylinders.stack(error_cylinders_tmp);
+        error_circles.stack(error_circles_tmp);
+
+        mapOfErrorLines[it->first] = error_lines_tmp;
+        mapOfErrorCylinders[it->first] = error_cylinders_tmp;
+        mapOfErrorCircles[it->first] = error_circles_tmp;
+      }
     }
 
     bool reStartFromLastIncrement = false;
@@ -450,10 +583,13 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
 
       computeVVSSecondPhasePoseEstimation(nerror, L, L_true, LVJ_true, W_true, factor, iter, isoJoIdentity_,
           weighted_error, mu, m_error_prev, m_w_prev, cMoPrev, residu_1, r);
+
+      converged = computeVVSSecondPhaseConverged(cMoPrev);
     }
 
     iter++;
   }
+  m_nbSecondPhaseIterations = iter;
 
 // std::cout << "VVS estimate pose cMo:\n" << cMo << std::endl;
 
@@ -2552,6 +2688,25 @@ void vpMbEdgeMultiTracker::setOptimizationMethod(const vpMbtOptimizationMethod &
   m_optimizationMethod = opt;
 }
 
+/*!
+  Track the cameras concurrently. This requires ViSP to be built with OpenMP,
+  otherwise the cameras are processed one after the other.
+
+  When enabled, the moving edges of each camera are tracked in a separate
+  thread, the blocks of the stacked interaction matrix and residual of the
+  virtual visual servoing are computed concurrently, as well as the visibility
+  tests and the update of the moving edges after the pose estimation. The
+  blocks are always stacked in the order of the camera names, so that the
+  estimated pose is the same as when the cameras are processed one after the
+  other. When the Ogre visibility test is used, the cameras are always
+  processed one after the other.
+
+  \param parallel : true to track the cameras concurrently.
+*/
+void vpMbEdgeMultiTracker::setParallelCameraTracking(const bool parallel) {
+  m_parallelCameraTracking = parallel;
+}
+
 /*!
   Set the pose to be used in entry of the next call to the track() function.
   This pose will be just used once.
@@ -2875,6 +3030,18 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
 
   initPyramid(mapOfImages, m_mapOfPyramidalImages);
 
+  // Cameras in the map order
+  int nbCameras = (int)m_mapOfEdgeTrackers.size();
+  std::vector<vpMbEdgeTracker *> trackers;
+  std::vector<const vpImage<unsigned char> *> images;
+  for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+      it != m_mapOfEdgeTrackers.end(); ++it) {
+    trackers.push_back(it->second);
+    images.push_back(mapOfImages[it->first]);
+  }
+  // Ogre visibility tests can not be run concurrently
+  bool parallel = m_parallelCameraTracking && nbCameras > 1 && !useOgre;
+
   unsigned int lvl = (unsigned int) scales.size();
   do {
     lvl--;
@@ -2886,17 +3053,46 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
       try
       {
         downScale(lvl);
-        for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
-            it1 != m_mapOfEdgeTrackers.end(); ++it1) {
-          //Downscale for each camera
-          it1->second->downScale(lvl);
 
-          //Track moving edges
-          try {
-            it1->second->trackMovingEdge(*m_mapOfPyramidalImages[it1->first][lvl]);
-          } catch(...) {
+        if(parallel) {
+          std::vector<const vpImage<unsigned char> *> levelImages;
+          for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+              it != m_mapOfEdgeTrackers.end(); ++it) {
+            levelImages.push_back(m_mapOfPyramidalImages[it->first][lvl]);
+          }
+
+          vpMbtCameraExceptions meExceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+          for(int i = 0; i < nbCameras; i++) {
+            try {
+              //Downscale for each camera
+              trackers[(size_t)i]->downScale(lvl);
+
+              //Track moving edges
+              trackers[(size_t)i]->trackMovingEdge(*levelImages[(size_t)i]);
+            } catch(...) {
+              meExceptions.setCurrentException((size_t)i);
+            }
+          }
+          if(meExceptions.failed()) {
             vpTRACE("Error in moving edge tracking") ;
-            throw ;
+            meExceptions.throwFirst();
+          }
+        } else {
+          for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
+              it1 != m_mapOfEdgeTrackers.end(); ++it1) {
+            //Downscale for each camera
+            it1->second->downScale(lvl);
+
+            //Track moving edges
+            try {
+              it1->second->trackMovingEdge(*m_mapOfPyramidalImages[it1->first][lvl]);
+            } catch(...) {
+              vpTRACE("Error in moving edge tracking") ;
+              throw ;
+            }
           }
         }
 
@@ -2944,41 +3140,79 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
           }
         }
 
-        // Looking for new visible face
-        bool newvisibleface = false;
-        for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-            it != m_mapOfEdgeTrackers.end(); ++it) {
-          it->second->visibleFace(*mapOfImages[it->first], it->second->cMo, newvisibleface);
-        }
-
-        if(useScanLine) {
+        if(parallel) {
+          // Update the visibility and the moving edges of each camera
+          vpMbtCameraExceptions updateExceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+          for(int i = 0; i < nbCameras; i++) {
+            vpMbEdgeTracker *tracker = trackers[(size_t)i];
+            const vpImage<unsigned char> &I = *images[(size_t)i];
+
+            try {
+              // Looking for new visible face
+              bool newvisibleface = false;
+              tracker->visibleFace(I, tracker->cMo, newvisibleface);
+
+              if(useScanLine) {
+                tracker->faces.computeClippedPolygons(tracker->cMo, tracker->cam);
+                tracker->faces.computeScanLineRender(tracker->cam, I.getWidth(), I.getHeight());
+              }
+
+              tracker->updateMovingEdge(I);
+
+              tracker->initMovingEdge(I, tracker->cMo);
+
+              // Reinit the moving edge for the lines which need it.
+              tracker->reinitMovingEdge(I, tracker->cMo);
+
+              if(computeProjError) {
+                //Compute the projection error
+                tracker->computeProjectionError(I);
+              }
+            } catch(...) {
+              updateExceptions.setCurrentException((size_t)i);
+            }
+          }
+          updateExceptions.throwFirst();
+        } else {
+          // Looking for new visible face
+          bool newvisibleface = false;
           for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                      it != m_mapOfEdgeTrackers.end(); ++it) {
-            it->second->faces.computeClippedPolygons(it->second->cMo, it->second->cam);
-            it->second->faces.computeScanLineRender(it->second->cam, mapOfImages[it->first]->getWidth(),
-                mapOfImages[it->first]->getHeight());
+              it != m_mapOfEdgeTrackers.end(); ++it) {
+            it->second->visibleFace(*mapOfImages[it->first], it->second->cMo, newvisibleface);
           }
-        }
 
-        try {
-          for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                      it != m_mapOfEdgeTrackers.end(); ++it) {
-            it->second->updateMovingEdge(*mapOfImages[it->first]);
+          if(useScanLine) {
+            for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                        it != m_mapOfEdgeTrackers.end(); ++it) {
+              it->second->faces.computeClippedPolygons(it->second->cMo, it->second->cam);
+              it->second->faces.computeScanLineRender(it->second->cam, mapOfImages[it->first]->getWidth(),
+                  mapOfImages[it->first]->getHeight());
+            }
           }
-        } catch(...) {
-          throw; // throw the original exception
-        }
 
-        for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-            it != m_mapOfEdgeTrackers.end(); ++it) {
-          it->second->initMovingEdge(*mapOfImages[it->first], it->second->cMo);
+          try {
+            for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                        it != m_mapOfEdgeTrackers.end(); ++it) {
+              it->second->updateMovingEdge(*mapOfImages[it->first]);
+            }
+          } catch(...) {
+            throw; // throw the original exception
+          }
+
+          for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+              it != m_mapOfEdgeTrackers.end(); ++it) {
+            it->second->initMovingEdge(*mapOfImages[it->first], it->second->cMo);
 
-          // Reinit the moving edge for the lines which need it.
-          it->second->reinitMovingEdge(*mapOfImages[it->first], it->second->cMo);
+            // Reinit the moving edge for the lines which need it.
+            it->second->reinitMovingEdge(*mapOfImages[it->first], it->second->cMo);
 
-          if(computeProjError) {
-            //Compute the projection error
-            it->second->computeProjectionError(*mapOfImages[it->first]);
+            if(computeProjError) {
+              //Compute the projection error
+              it->second->computeProjectionError(*mapOfImages[it->first]);
+            }
           }
         }
 
@@ -70,7 +70,8 @@
 vpMbEdgeTracker::vpMbEdgeTracker()
   : compute_interaction(1), lambda(1), me(), lines(1), circles(1), cylinders(1), nline(0), ncircle(0), ncylinder(0),
     nbvisiblepolygone(0), percentageGdPt(0.4), scales(1),
-    Ipyramid(0), scaleLevel(0), nbFeaturesForProjErrorComputation(0)
+    Ipyramid(0), scaleLevel(0), nbFeaturesForProjErrorComputation(0),
+    m_poseIncrementThreshold(0), m_nbFirstPhaseIterations(0), m_nbSecondPhaseIterations(0)
 {
   angleAppears = vpMath::rad(89);
   angleDisappears = vpMath::rad(89);
@@ -235,6 +236,7 @@ vpMbEdgeTracker::computeVVS(const vpImage<unsigned char>& _I, const unsigned int
 
     iter++;
   }
+  m_nbFirstPhaseIterations = iter;
 
 //   std::cout << "\t First minimization in " << iter << " iteration give as initial cMo: \n" << cMo << std::endl ;
   
@@ -263,9 +265,10 @@ vpMbEdgeTracker::computeVVS(const vpImage<unsigned char>& _I, const unsigned int
   double mu = 0.01;
   vpColVector m_error_prev(nbrow);
   vpColVector m_w_prev(nbrow);
+  bool converged = false;
   
   //while ( ((int)((residu_1 - r)*1e8) !=0 )  && (iter<30))
-  while(std::fabs((residu_1 - r)*1e8) > std::numeric_limits<double>::epsilon() && (iter<30))
+  while(!converged && std::fabs((residu_1 - r)*1e8) > std::numeric_limits<double>::epsilon() && (iter<30))
   {
     computeVVSSecondPhase(_I, L, error_lines, error_cylinders, error_circles, m_error, lvl);
 
@@ -281,10 +284,12 @@ vpMbEdgeTracker::computeVVS(const vpImage<unsigned char>& _I, const unsigned int
       computeVVSSecondPhasePoseEstimation(nerror, L, L_true, LVJ_true, W_true, factor, iter, isoJoIdentity_,
           weighted_error, mu, m_error_prev, m_w_prev, cMoPrev, residu_1, r);
 
+      converged = computeVVSSecondPhaseConverged(cMoPrev);
     } // endif(!restartFromLast)
 
     iter++;
   }
+  m_nbSecondPhaseIterations = iter;
 
 //   std::cout << "VVS estimate pose cMo:\n" << cMo << std::endl;
   if(computeCovariance){
@@ -828,6 +833,23 @@ vpMbEdgeTracker::computeVVSSecondPhase(const vpImage<unsigned char>& _I, vpMatri
   }
 }
 
+/*!
+  Return true if the pose increment of the last iteration of the second phase
+  of the virtual visual servoing is small enough to stop the minimization.
+
+  \param cMoPrev : The pose before the last increment.
+
+  \sa setPoseIncrementThreshold()
+*/
+bool
+vpMbEdgeTracker::computeVVSSecondPhaseConverged(const vpHomogeneousMatrix &cMoPrev) const {
+  if(m_poseIncrementThreshold <= 0)
+    return false;
+
+  vpColVector dv = vpExponentialMap::inverse(cMo * cMoPrev.inverse());
+  return dv.sumSquare() < vpMath::sqr(m_poseIncrementThreshold);
+}
+
 void
 vpMbEdgeTracker::computeVVSSecondPhaseCheckLevenbergMarquardt(const unsigned int iter, const unsigned int nbrow,
     const vpColVector &m_error_prev, const vpColVector &m_w_prev, const vpHomogeneousMatrix &cMoPrev,
@@ -860,8 +882,7 @@ vpMbEdgeTracker::computeVVSSecondPhasePoseEstimation(const unsigned int nerror,
   vpMatrix LTL;
   vpColVector LTR;
 
-  L_true = L;
-  W_true = vpColVector(nerror);
+  W_true.resize(nerror, false);
 
   vpVelocityTwistMatrix cVo;
   if(computeCovariance){
@@ -2660,6 +2681,28 @@ vpMbEdgeTracker::getNbPoints(const unsigned int level) const
   return nbGoodPoints;
 }
 
+/*!
+  Stop the second phase of the virtual visual servoing as soon as the pose
+  increment becomes negligible. The increment is measured as the norm of the
+  6-dimension vector that stacks the translation (in meter) and the rotation
+  (in radian, theta u representation) between two successive poses.
+
+  By default this criterion is disabled, and the minimization only stops when
+  the weighted residual does not change anymore or after 30 iterations. Setting
+  a threshold such as 1e-6 usually saves most of the iterations once the pose is
+  well estimated.
+
+  \param threshold : Norm of the pose increment below which the minimization
+  is stopped. A value lower or equal to 0 disables this criterion.
+
+  \sa getPoseIncrementThreshold(), getNbSecondPhaseIterations()
+*/
+void
+vpMbEdgeTracker::setPoseIncrementThreshold(const double threshold)
+{
+  m_poseIncrementThreshold = threshold;
+}
+
 /*!
   Set the scales to use to realize the tracking. The vector of boolean activates
   or not the scales to set for the object tracking. The first element of the list
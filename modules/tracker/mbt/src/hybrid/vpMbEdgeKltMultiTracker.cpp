@@ -50,6 +50,8 @@
 #include <visp3/core/vpVelocityTwistMatrix.h>
 #include <visp3/mbt/vpMbEdgeKltMultiTracker.h>
 
+#include "vpMbtCameraExceptions.h"
+
 
 /*!
   Basic constructor
@@ -186,6 +188,58 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
     mapOfVelocityTwist[it->first] = cVo;
   }
 
+  //Edge cameras in the map order, with the first row of their blocks in the stacked vectors
+  int nbEdgeCameras = (int)m_mapOfEdgeTrackers.size();
+  std::vector<vpMbEdgeTracker *> edgeTrackers;
+  std::vector<const vpImage<unsigned char> *> edgeImages;
+  std::vector<vpHomogeneousMatrix> edgeTransformations;
+  std::vector<vpVelocityTwistMatrix> edgeTwists;
+  std::vector<unsigned int> nbRows, rowOffsets;
+  std::vector<unsigned int> nbLines, lineOffsets;
+  std::vector<unsigned int> nbCylinders, cylinderOffsets;
+  std::vector<unsigned int> nbCircles, circleOffsets;
+  unsigned int nbTotalRows = 0, nbTotalLines = 0, nbTotalCylinders = 0, nbTotalCircles = 0;
+  for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+      it != m_mapOfEdgeTrackers.end(); ++it) {
+    edgeTrackers.push_back(it->second);
+    edgeImages.push_back(mapOfImages[it->first]);
+    edgeTransformations.push_back(m_mapOfCameraTransformationMatrix[it->first]);
+    edgeTwists.push_back(mapOfVelocityTwist[it->first]);
+
+    nbRows.push_back(mapOfNumberOfRows[it->first]);
+    rowOffsets.push_back(nbTotalRows);
+    nbTotalRows += mapOfNumberOfRows[it->first];
+    nbLines.push_back(mapOfNumberOfLines[it->first]);
+    lineOffsets.push_back(nbTotalLines);
+    nbTotalLines += mapOfNumberOfLines[it->first];
+    nbCylinders.push_back(mapOfNumberOfCylinders[it->first]);
+    cylinderOffsets.push_back(nbTotalCylinders);
+    nbTotalCylinders += mapOfNumberOfCylinders[it->first];
+    nbCircles.push_back(mapOfNumberOfCircles[it->first]);
+    circleOffsets.push_back(nbTotalCircles);
+    nbTotalCircles += mapOfNumberOfCircles[it->first];
+  }
+
+  //KLT cameras in the map order, with the first row of their block in the stacked vectors
+  int nbKltCameras = (int)m_mapOfKltTrackers.size();
+  std::vector<vpMbKltTracker *> kltTrackers;
+  std::vector<vpHomogeneousMatrix> kltTransformations;
+  std::vector<vpVelocityTwistMatrix> kltTwists;
+  std::vector<unsigned int> nbKltRows, kltRowOffsets;
+  unsigned int nbTotalKltRows = 0;
+  for(std::map<std::string, vpMbKltTracker*>::const_iterator it = m_mapOfKltTrackers.begin();
+      it != m_mapOfKltTrackers.end(); ++it) {
+    kltTrackers.push_back(it->second);
+    kltTransformations.push_back(m_mapOfCameraTransformationMatrix[it->first]);
+    kltTwists.push_back(mapOfVelocityTwist[it->first]);
+    nbKltRows.push_back(2 * mapOfNbInfos[it->first]);
+    kltRowOffsets.push_back(nbTotalKltRows);
+    nbTotalKltRows += 2 * mapOfNbInfos[it->first];
+  }
+
+  bool parallelEdge = vpMbEdgeMultiTracker::m_parallelCameraTracking && nbEdgeCameras > 1;
+  bool parallelKlt = vpMbKltMultiTracker::m_parallelCameraTracking && nbKltCameras > 1;
+
   //Map of robust for edge trackers
   //Individual weights for each primitives and for each camera
   std::map<std::string, vpRobust> mapOfEdgeRobustLines;
@@ -259,72 +313,163 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
     vpColVector R_mbt;
     vpMatrix L_mbt;
     if(nbrow >= 4) {
-      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-          it != m_mapOfEdgeTrackers.end(); ++it) {
-        vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
-        vpColVector error_lines_tmp(mapOfNumberOfLines[it->first]);
-        vpColVector error_cylinders_tmp(mapOfNumberOfCylinders[it->first]);
-        vpColVector error_circles_tmp(mapOfNumberOfCircles[it->first]);
-
-        //Set the corresponding cMo for the current camera
-        it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
-
-        vpColVector R_tmp;
-        R_tmp.resize(mapOfNumberOfRows[it->first]);
-        it->second->computeVVSSecondPhase(*mapOfImages[it->first], L_tmp, error_lines_tmp,
-            error_cylinders_tmp, error_circles_tmp, R_tmp, 0);
-        //Set the computed weight
-        it->second->m_w = R_tmp;
-        L_tmp = L_tmp*mapOfVelocityTwist[it->first];
-
-        //Stack interaction matrix for MBT
-        L_mbt.stack(L_tmp);
-        //Stack residual for MBT
-        R_mbt.stack(R_tmp);
-
-        error_lines.stack(error_lines_tmp);
-        error_cylinders.stack(error_cylinders_tmp);
-        error_circles.stack(error_circles_tmp);
-
-        mapOfErrorLines[it->first] = error_lines_tmp;
-        mapOfErrorCylinders[it->first] = error_cylinders_tmp;
-        mapOfErrorCircles[it->first] = error_circles_tmp;
+      if(parallelEdge) {
+        L_mbt.resize(nbTotalRows, 6, false);
+        R_mbt.resize(nbTotalRows, false);
+        error_lines.resize(nbTotalLines, false);
+        error_cylinders.resize(nbTotalCylinders, false);
+        error_circles.resize(nbTotalCircles, false);
+
+        //Set the corresponding cMo for each camera
+        for(int i = 0; i < nbEdgeCameras; i++) {
+          edgeTrackers[(size_t)i]->cMo = edgeTransformations[(size_t)i]*cMo;
+        }
+
+        vpMbtCameraExceptions exceptions((size_t)nbEdgeCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < nbEdgeCameras; i++) {
+          vpMbEdgeTracker *tracker = edgeTrackers[(size_t)i];
+          try {
+            vpMatrix L_tmp(nbRows[(size_t)i], 6);
+            vpColVector error_lines_tmp(nbLines[(size_t)i]);
+            vpColVector error_cylinders_tmp(nbCylinders[(size_t)i]);
+            vpColVector error_circles_tmp(nbCircles[(size_t)i]);
+
+            vpColVector R_tmp;
+            R_tmp.resize(nbRows[(size_t)i]);
+            tracker->computeVVSSecondPhase(*edgeImages[(size_t)i], L_tmp, error_lines_tmp,
+                error_cylinders_tmp, error_circles_tmp, R_tmp, 0);
+            //Set the computed weight
+            tracker->m_w = R_tmp;
+            L_tmp = L_tmp*edgeTwists[(size_t)i];
+
+            //Stack interaction matrix and residual for MBT in the block of the camera
+            L_mbt.insert(L_tmp, rowOffsets[(size_t)i], 0);
+            R_mbt.insert(rowOffsets[(size_t)i], R_tmp);
+
+            error_lines.insert(lineOffsets[(size_t)i], error_lines_tmp);
+            error_cylinders.insert(cylinderOffsets[(size_t)i], error_cylinders_tmp);
+            error_circles.insert(circleOffsets[(size_t)i], error_circles_tmp);
+          } catch(...) {
+            exceptions.setCurrentException((size_t)i);
+          }
+        }
+        exceptions.throwFirst();
+
+        int i = 0;
+        for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+            it != m_mapOfEdgeTrackers.end(); ++it, i++) {
+          mapOfErrorLines[it->first] = vpColVector(error_lines, lineOffsets[(size_t)i], nbLines[(size_t)i]);
+          mapOfErrorCylinders[it->first] = vpColVector(error_cylinders, cylinderOffsets[(size_t)i], nbCylinders[(size_t)i]);
+          mapOfErrorCircles[it->first] = vpColVector(error_circles, circleOffsets[(size_t)i], nbCircles[(size_t)i]);
+        }
+      } else {
+        for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+            it != m_mapOfEdgeTrackers.end(); ++it) {
+          vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
+          vpColVector error_lines_tmp(mapOfNumberOfLines[it->first]);
+          vpColVector error_cylinders_tmp(mapOfNumberOfCylinders[it->first]);
+          vpColVector error_circles_tmp(mapOfNumberOfCircles[it->first]);
+
+          //Set the corresponding cMo for the current camera
+          it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
+
+          vpColVector R_tmp;
+          R_tmp.resize(mapOfNumberOfRows[it->first]);
+          it->second->computeVVSSecondPhase(*mapOfImages[it->first], L_tmp, error_lines_tmp,
+              error_cylinders_tmp, error_circles_tmp, R_tmp, 0);
+          //Set the computed weight
+          it->second->m_w = R_tmp;
+          L_tmp = L_tmp*mapOfVelocityTwist[it->first];
+
+          //Stack interaction matrix for MBT
+          L_mbt.stack(L_tmp);
+          //Stack residual for MBT
+          R_mbt.stack(R_tmp);
+
+          error_lines.stack(error_lines_tmp);
+          error_cylinders.stack(error_cylinders_tmp);
+          error_circles.stack(error_circles_tmp);
+
+          mapOfErrorLines[it->first] = error_lines_tmp;
+          mapOfErrorCylinders[it->first] = error_cylinders_tmp;
+          mapOfErrorCircles[it->first] = error_circles_tmp;
+        }
       }
     }
 
     //KLT
     vpColVector R_klt;
     vpMatrix L_klt;
-    for(std::map<std::string, vpMbKltTracker*>::const_iterator it1 = m_mapOfKltTrackers.begin();
-        it1 != m_mapOfKltTrackers.end(); ++it1) {
-      if(mapOfNbInfos[it1->first] > 0) {
-        unsigned int shift = 0;
-        vpColVector R_current;  // residu for the current camera for KLT
-        vpMatrix L_current;     // interaction matrix for the current camera for KLT
-        vpHomography H_current;
-
-        R_current.resize(2 * mapOfNbInfos[it1->first]);
-        L_current.resize(2 * mapOfNbInfos[it1->first], 6, 0);
-
-        //Use the ctTc0 variable instead of the formula in the monocular case
-        //to ensure that we have the same result than vpMbKltTracker
-        //as some slight differences can occur due to numerical imprecision
-        if(m_mapOfKltTrackers.size() == 1) {
-          computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-              it1->second->kltPolygons, it1->second->kltCylinders, ctTc0);
-        } else {
-          vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it1->first] *
-              cMo * it1->second->c0Mo.inverse();
-          computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-              it1->second->kltPolygons, it1->second->kltCylinders, c_curr_tTc_curr0);
+    if(parallelKlt) {
+      R_klt.resize(nbTotalKltRows);
+      L_klt.resize(nbTotalKltRows, 6);
+      vpMbtCameraExceptions kltExceptions((size_t)nbKltCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < nbKltCameras; i++) {
+        if(nbKltRows[(size_t)i] > 0) {
+          vpMbKltTracker *tracker = kltTrackers[(size_t)i];
+          try {
+            unsigned int shift = 0;
+            vpColVector R_current;  // residu for the current camera for KLT
+            vpMatrix L_current;     // interaction matrix for the current camera for KLT
+            vpHomography H_current;
+
+            R_current.resize(nbKltRows[(size_t)i]);
+            L_current.resize(nbKltRows[(size_t)i], 6, 0);
+
+            vpHomogeneousMatrix c_curr_tTc_curr0 = kltTransformations[(size_t)i] * cMo * tracker->c0Mo.inverse();
+            computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+                tracker->kltPolygons, tracker->kltCylinders, c_curr_tTc_curr0);
+
+            //Transform the current interaction matrix with VelocityTwistMatrix
+            L_current = L_current*kltTwists[(size_t)i];
+
+            //Stack residual and interaction matrix in the block of the camera
+            R_klt.insert(kltRowOffsets[(size_t)i], R_current);
+            L_klt.insert(L_current, kltRowOffsets[(size_t)i], 0);
+          } catch(...) {
+            kltExceptions.setCurrentException((size_t)i);
+          }
         }
+      }
+      kltExceptions.throwFirst();
+    } else {
+      for(std::map<std::string, vpMbKltTracker*>::const_iterator it1 = m_mapOfKltTrackers.begin();
+          it1 != m_mapOfKltTrackers.end(); ++it1) {
+        if(mapOfNbInfos[it1->first] > 0) {
+          unsigned int shift = 0;
+          vpColVector R_current;  // residu for the current camera for KLT
+          vpMatrix L_current;     // interaction matrix for the current camera for KLT
+          vpHomography H_current;
+
+          R_current.resize(2 * mapOfNbInfos[it1->first]);
+          L_current.resize(2 * mapOfNbInfos[it1->first], 6, 0);
+
+          //Use the ctTc0 variable instead of the formula in the monocular case
+          //to ensure that we have the same result than vpMbKltTracker
+          //as some slight differences can occur due to numerical imprecision
+          if(m_mapOfKltTrackers.size() == 1) {
+            computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+                it1->second->kltPolygons, it1->second->kltCylinders, ctTc0);
+          } else {
+            vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it1->first] *
+                cMo * it1->second->c0Mo.inverse();
+            computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+                it1->second->kltPolygons, it1->second->kltCylinders, c_curr_tTc_curr0);
+          }
 
-        //Transform the current interaction matrix with VelocityTwistMatrix
-        L_current = L_current*mapOfVelocityTwist[it1->first];
+          //Transform the current interaction matrix with VelocityTwistMatrix
+          L_current = L_current*mapOfVelocityTwist[it1->first];
 
-        //Stack residual and interaction matrix
-        R_klt.stack(R_current);
-        L_klt.stack(L_current);
+          //Stack residual and interaction matrix
+          R_klt.stack(R_current);
+          L_klt.stack(L_current);
+        }
       }
     }
 
@@ -1457,61 +1602,142 @@ void vpMbEdgeKltMultiTracker::loadModel(const std::string &modelFile, const bool
 void vpMbEdgeKltMultiTracker::postTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
     vpColVector &w_mbt, vpColVector &w_klt, std::map<std::string, unsigned int> &mapOfNumberOfRows,
     std::map<std::string, unsigned int> &mapOfNbInfos, const unsigned int lvl) {
-  //MBT
-  unsigned int cpt = 0;
-  for(std::map<std::string, unsigned int>::const_iterator it = mapOfNumberOfRows.begin(); it != mapOfNumberOfRows.end(); ++it) {
-    for(unsigned int i = 0; i < mapOfNumberOfRows[it->first]; i++) {
-      m_mapOfEdgeTrackers[it->first]->m_w[i] = w_mbt[i+cpt];
+  int nbCameras = (int)m_mapOfEdgeTrackers.size();
+  // Ogre visibility tests can not be run concurrently
+  if(vpMbEdgeMultiTracker::m_parallelCameraTracking && nbCameras > 1 && !useOgre) {
+    //Edge cameras in the map order, with the first row of their block in the weights
+    std::vector<vpMbEdgeTracker *> trackers;
+    std::vector<const vpImage<unsigned char> *> images;
+    std::vector<unsigned int> nbRows;
+    std::vector<unsigned int> rowOffsets;
+    unsigned int cpt = 0;
+    for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+        it != m_mapOfEdgeTrackers.end(); ++it) {
+      trackers.push_back(it->second);
+      images.push_back(mapOfImages[it->first]);
+      nbRows.push_back(mapOfNumberOfRows[it->first]);
+      rowOffsets.push_back(cpt);
+      cpt += mapOfNumberOfRows[it->first];
     }
 
-    m_mapOfEdgeTrackers[it->first]->updateMovingEdgeWeights();
-    cpt += mapOfNumberOfRows[it->first];
-  }
+    //MBT
+    vpMbtCameraExceptions weightExceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < nbCameras; i++) {
+      try {
+        for(unsigned int j = 0; j < nbRows[(size_t)i]; j++) {
+          trackers[(size_t)i]->m_w[j] = w_mbt[j+rowOffsets[(size_t)i]];
+        }
 
-  if(displayFeatures) {
-    for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                it != m_mapOfEdgeTrackers.end(); ++it) {
-      it->second->displayFeaturesOnImage(*mapOfImages[it->first], lvl);
+        trackers[(size_t)i]->updateMovingEdgeWeights();
+      } catch(...) {
+        weightExceptions.setCurrentException((size_t)i);
+      }
     }
-  }
+    weightExceptions.throwFirst();
 
-  //KLT
-  vpMbKltMultiTracker::postTracking(mapOfImages, mapOfNbInfos, w_klt);
+    if(displayFeatures) {
+      for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                  it != m_mapOfEdgeTrackers.end(); ++it) {
+        it->second->displayFeaturesOnImage(*mapOfImages[it->first], lvl);
+      }
+    }
 
-  // Looking for new visible face
-  bool newvisibleface = false;
-  for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-      it != m_mapOfEdgeTrackers.end(); ++it) {
-    it->second->visibleFace(*mapOfImages[it->first], it->second->cMo, newvisibleface);
-  }
+    //KLT
+    vpMbKltMultiTracker::postTracking(mapOfImages, mapOfNbInfos, w_klt);
 
-  if(useScanLine) {
-    for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                it != m_mapOfEdgeTrackers.end(); ++it) {
-      it->second->faces.computeClippedPolygons(it->second->cMo, it->second->cam);
-      it->second->faces.computeScanLineRender(it->second->cam, mapOfImages[it->first]->getWidth(),
-          mapOfImages[it->first]->getHeight());
+    vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < nbCameras; i++) {
+      vpMbEdgeTracker *tracker = trackers[(size_t)i];
+      const vpImage<unsigned char> &I = *images[(size_t)i];
+
+      try {
+        // Looking for new visible face
+        bool newvisibleface = false;
+        tracker->visibleFace(I, tracker->cMo, newvisibleface);
+
+        if(useScanLine) {
+          tracker->faces.computeClippedPolygons(tracker->cMo, tracker->cam);
+          tracker->faces.computeScanLineRender(tracker->cam, I.getWidth(), I.getHeight());
+        }
+
+        tracker->updateMovingEdge(I);
+
+        tracker->initMovingEdge(I, tracker->cMo);
+
+        // Reinit the moving edge for the lines which need it.
+        tracker->reinitMovingEdge(I, tracker->cMo);
+
+        if(computeProjError) {
+          tracker->computeProjectionError(I);
+        }
+      } catch(...) {
+        exceptions.setCurrentException((size_t)i);
+      }
     }
-  }
+    exceptions.throwFirst();
+  } else {
+    //MBT
+    unsigned int cpt = 0;
+    for(std::map<std::string, unsigned int>::const_iterator it = mapOfNumberOfRows.begin(); it != mapOfNumberOfRows.end(); ++it) {
+      for(unsigned int i = 0; i < mapOfNumberOfRows[it->first]; i++) {
+        m_mapOfEdgeTrackers[it->first]->m_w[i] = w_mbt[i+cpt];
+      }
 
-  try {
+      m_mapOfEdgeTrackers[it->first]->updateMovingEdgeWeights();
+      cpt += mapOfNumberOfRows[it->first];
+    }
+
+    if(displayFeatures) {
+      for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                  it != m_mapOfEdgeTrackers.end(); ++it) {
+        it->second->displayFeaturesOnImage(*mapOfImages[it->first], lvl);
+      }
+    }
+
+    //KLT
+    vpMbKltMultiTracker::postTracking(mapOfImages, mapOfNbInfos, w_klt);
+
+    // Looking for new visible face
+    bool newvisibleface = false;
     for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                it != m_mapOfEdgeTrackers.end(); ++it) {
-      it->second->updateMovingEdge(*mapOfImages[it->first]);
+        it != m_mapOfEdgeTrackers.end(); ++it) {
+      it->second->visibleFace(*mapOfImages[it->first], it->second->cMo, newvisibleface);
     }
-  } catch(vpException &e) {
-    throw e;
-  }
 
-  for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-      it != m_mapOfEdgeTrackers.end(); ++it) {
-    it->second->initMovingEdge(*mapOfImages[it->first], it->second->cMo);
+    if(useScanLine) {
+      for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                  it != m_mapOfEdgeTrackers.end(); ++it) {
+        it->second->faces.computeClippedPolygons(it->second->cMo, it->second->cam);
+        it->second->faces.computeScanLineRender(it->second->cam, mapOfImages[it->first]->getWidth(),
+            mapOfImages[it->first]->getHeight());
+      }
+    }
+
+    try {
+      for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+                  it != m_mapOfEdgeTrackers.end(); ++it) {
+        it->second->updateMovingEdge(*mapOfImages[it->first]);
+      }
+    } catch(vpException &e) {
+      throw e;
+    }
 
-    // Reinit the moving edge for the lines which need it.
-    it->second->reinitMovingEdge(*mapOfImages[it->first], it->second->cMo);
+    for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
+        it != m_mapOfEdgeTrackers.end(); ++it) {
+      it->second->initMovingEdge(*mapOfImages[it->first], it->second->cMo);
+
+      // Reinit the moving edge for the lines which need it.
+      it->second->reinitMovingEdge(*mapOfImages[it->first], it->second->cMo);
 
-    if(computeProjError) {
-      it->second->computeProjectionError(*mapOfImages[it->first]);
+      if(computeProjError) {
+        it->second->computeProjectionError(*mapOfImages[it->first]);
+      }
     }
   }
 }
@@ -1971,6 +2197,25 @@ void vpMbEdgeKltMultiTracker::setOptimizationMethod(const vpMbtOptimizationMetho
   vpMbKltMultiTracker::setOptimizationMethod(opt);
 }
 
+/*!
+  Track the cameras concurrently. This requires ViSP to be built with OpenMP,
+  otherwise the cameras are processed one after the other.
+
+  When enabled, the moving edges and the KLT points of each camera are tracked
+  in separate threads, and the blocks of the stacked interaction matrix and
+  residual of the virtual visual servoing are computed concurrently. The
+  blocks are always stacked in the order of the camera names, so that the
+  estimated pose is the same as when the cameras are processed one after the
+  other. When the Ogre visibility test is used, the visibility and the
+  features are updated one camera after the other.
+
+  \param parallel : true to track the cameras concurrently.
+*/
+void vpMbEdgeKltMultiTracker::setParallelCameraTracking(const bool parallel) {
+  vpMbEdgeMultiTracker::setParallelCameraTracking(parallel);
+  vpMbKltMultiTracker::setParallelCameraTracking(parallel);
+}
+
 /*!
   Set the pose to be used in entry of the next call to the track() function.
   This pose will be just used once.
@@ -2218,33 +2463,104 @@ unsigned int vpMbEdgeKltMultiTracker::trackFirstLoop(std::map<std::string, const
       return nbrow;
   }
 
-  factor = vpColVector();
-  for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-      it != m_mapOfEdgeTrackers.end(); ++it) {
-    //Set the corresponding cMo for each camera
-    //Used in computeVVSFirstPhaseFactor with computeInteractionMatrixError
-    it->second->cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo;
-
-    vpColVector factor_tmp;
-    factor_tmp.resize(mapOfNumberOfRows[it->first]);
-    factor_tmp = 1;
-    it->second->computeVVSFirstPhaseFactor(*mapOfImages[it->first], factor_tmp, lvl);
+  int nbCameras = (int)m_mapOfEdgeTrackers.size();
+  if(vpMbEdgeMultiTracker::m_parallelCameraTracking && nbCameras > 1) {
+    //Edge cameras in the map order, with the first row of their block in the factors
+    std::vector<vpMbEdgeTracker *> trackers;
+    std::vector<const vpImage<unsigned char> *> images;
+    std::vector<unsigned int> nbRows;
+    std::vector<unsigned int> rowOffsets;
+    unsigned int nbTotalRows = 0;
+    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+        it != m_mapOfEdgeTrackers.end(); ++it) {
+      //Set the corresponding cMo for each camera
+      //Used in computeVVSFirstPhaseFactor with computeInteractionMatrixError
+      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo;
+
+      trackers.push_back(it->second);
+      images.push_back(mapOfImages[it->first]);
+      nbRows.push_back(mapOfNumberOfRows[it->first]);
+      rowOffsets.push_back(nbTotalRows);
+      nbTotalRows += mapOfNumberOfRows[it->first];
+    }
 
-    factor.stack(factor_tmp);
+    factor.resize(nbTotalRows, false);
+    vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < nbCameras; i++) {
+      try {
+        vpColVector factor_tmp;
+        factor_tmp.resize(nbRows[(size_t)i]);
+        factor_tmp = 1;
+        trackers[(size_t)i]->computeVVSFirstPhaseFactor(*images[(size_t)i], factor_tmp, lvl);
+
+        factor.insert(rowOffsets[(size_t)i], factor_tmp);
+      } catch(...) {
+        exceptions.setCurrentException((size_t)i);
+      }
+    }
+    exceptions.throwFirst();
+  } else {
+    factor = vpColVector();
+    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
+        it != m_mapOfEdgeTrackers.end(); ++it) {
+      //Set the corresponding cMo for each camera
+      //Used in computeVVSFirstPhaseFactor with computeInteractionMatrixError
+      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo;
+
+      vpColVector factor_tmp;
+      factor_tmp.resize(mapOfNumberOfRows[it->first]);
+      factor_tmp = 1;
+      it->second->computeVVSFirstPhaseFactor(*mapOfImages[it->first], factor_tmp, lvl);
+
+      factor.stack(factor_tmp);
+    }
   }
 
   return nbrow;
 }
 
 void vpMbEdgeKltMultiTracker::trackMovingEdges(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages) {
-  for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
-      it1 != m_mapOfEdgeTrackers.end(); ++it1) {
-    //Track moving edges
-    try {
-      it1->second->trackMovingEdge(*mapOfImages[it1->first]);
-    } catch(...) {
+  int nbCameras = (int)m_mapOfEdgeTrackers.size();
+  if(vpMbEdgeMultiTracker::m_parallelCameraTracking && nbCameras > 1) {
+    //Edge cameras in the map order
+    std::vector<vpMbEdgeTracker *> trackers;
+    std::vector<const vpImage<unsigned char> *> images;
+    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
+        it1 != m_mapOfEdgeTrackers.end(); ++it1) {
+      trackers.push_back(it1->second);
+      images.push_back(mapOfImages[it1->first]);
+    }
+
+    vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < nbCameras; i++) {
+      //Track moving edges
+      try {
+        trackers[(size_t)i]->trackMovingEdge(*images[(size_t)i]);
+      } catch(...) {
+        exceptions.setCurrentException((size_t)i);
+      }
+    }
+
+    if(exceptions.failed()) {
       std::cerr << "Error in moving edge tracking" << std::endl;
-      throw ;
+      exceptions.throwFirst();
+    }
+  } else {
+    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
+        it1 != m_mapOfEdgeTrackers.end(); ++it1) {
+      //Track moving edges
+      try {
+        it1->second->trackMovingEdge(*mapOfImages[it1->first]);
+      } catch(...) {
+        std::cerr << "Error in moving edge tracking" << std::endl;
+        throw ;
+      }
     }
   }
 }
@@ -39,14 +39,18 @@
 //#define VP_DEBUG_MODE 1 // Activate debug level 1
 
 #include <visp3/core/vpDebug.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/mbt/vpMbEdgeKltTracker.h>
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 
+#include "vpMbtCameraExceptions.h"
+
 #if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
 
 vpMbEdgeKltTracker::vpMbEdgeKltTracker()
-  : compute_interaction(true), lambda(0.8), thresholdKLT(2.), thresholdMBT(2.), maxIter(200)
+  : compute_interaction(true), lambda(0.8), thresholdKLT(2.), thresholdMBT(2.), maxIter(200),
+    m_parallelTracking(false), m_kltTrackingTime(0.), m_meTrackingTime(0.), m_vvsTime(0.), m_postTrackingTime(0.)
 {
   computeCovariance = false;
   
@@ -887,24 +891,80 @@ vpMbEdgeKltTracker::track(const vpImage<unsigned char>& I)
   unsigned int nbInfos  = 0;
   unsigned int nbFaceUsed = 0;
   vpColVector w_klt;
-
-  try{
-    vpMbKltTracker::preTracking(I, nbInfos, nbFaceUsed);
+  double t;
+
+  if (m_parallelTracking) {
+    // The KLT and the moving-edges searches only read the image and the
+    // predicted pose, and each one updates its own features.
+    vpMbtCameraExceptions meExceptions(1);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel sections
+#endif
+    {
+#ifdef VISP_HAVE_OPENMP
+#pragma omp section
+#endif
+      {
+        double t_klt = vpTime::measureTimeMs();
+        try{
+          vpMbKltTracker::preTracking(I, nbInfos, nbFaceUsed);
+        }
+        catch(...){}
+        m_kltTrackingTime = vpTime::measureTimeMs() - t_klt;
+      }
+#ifdef VISP_HAVE_OPENMP
+#pragma omp section
+#endif
+      {
+        double t_me = vpTime::measureTimeMs();
+        // An exception can not leave a parallel region, it is thrown after
+        // with its original type
+        try{
+          vpMbEdgeTracker::trackMovingEdge(I);
+        }
+        catch(...){
+          meExceptions.setCurrentException(0);
+        }
+        m_meTrackingTime = vpTime::measureTimeMs() - t_me;
+      }
+    }
+    meExceptions.throwFirst();
+
+    t = vpTime::measureTimeMs();
+    if(nbInfos >= 4)
+      vpMbKltTracker::computeVVS(nbInfos, w_klt);
+    else
+      nbInfos = 0;
+    m_vvsTime = vpTime::measureTimeMs() - t;
   }
-  catch(...){}
-  
-  if(nbInfos >= 4)
-    vpMbKltTracker::computeVVS(nbInfos, w_klt);
-  else{
-    nbInfos = 0;
-    // std::cout << "[Warning] Unable to init with KLT" << std::endl;
+  else {
+    t = vpTime::measureTimeMs();
+    try{
+      vpMbKltTracker::preTracking(I, nbInfos, nbFaceUsed);
+    }
+    catch(...){}
+    m_kltTrackingTime = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    if(nbInfos >= 4)
+      vpMbKltTracker::computeVVS(nbInfos, w_klt);
+    else{
+      nbInfos = 0;
+      // std::cout << "[Warning] Unable to init with KLT" << std::endl;
+    }
+    m_vvsTime = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    vpMbEdgeTracker::trackMovingEdge(I);
+    m_meTrackingTime = vpTime::measureTimeMs() - t;
   }
-  
-  vpMbEdgeTracker::trackMovingEdge(I);
  
+  t = vpTime::measureTimeMs();
   vpColVector w_mbt;
   computeVVS(I, nbInfos, w_mbt, w_klt);
+  m_vvsTime += vpTime::measureTimeMs() - t;
 
+  t = vpTime::measureTimeMs();
   if(postTracking(I, w_mbt, w_klt)){
     vpMbKltTracker::reinit(I);
     
@@ -924,6 +984,25 @@ vpMbEdgeKltTracker::track(const vpImage<unsigned char>& I)
     
 //    cleanPyramid(Ipyramid);
   }
+  m_postTrackingTime = vpTime::measureTimeMs() - t;
+}
+
+/*!
+  Run the KLT and the moving-edges searches of track() concurrently in two
+  threads. This requires ViSP to be built with OpenMP, otherwise the two
+  searches are run one after the other.
+
+  When enabled, the moving edges that have to be initialized are positioned
+  with the pose predicted from the previous image, since the pose refined with
+  the KLT keypoints is not yet available. The tracked moving edges do not
+  depend on the pose, so that the tracking results are otherwise the same.
+
+  \param parallel : true to run the two searches concurrently.
+*/
+void
+vpMbEdgeKltTracker::setParallelTracking(const bool parallel)
+{
+  m_parallelTracking = parallel;
 }
 
 unsigned int
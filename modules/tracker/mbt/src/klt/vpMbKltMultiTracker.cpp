@@ -50,12 +50,14 @@
 #include <visp3/core/vpVelocityTwistMatrix.h>
 #include <visp3/mbt/vpMbKltMultiTracker.h>
 
+#include "vpMbtCameraExceptions.h"
+
 
 /*!
   Basic constructor
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker() : m_mapOfCameraTransformationMatrix(), m_mapOfKltTrackers(),
-    m_referenceCameraName("Camera") {
+    m_referenceCameraName("Camera"), m_parallelCameraTracking(false) {
   m_mapOfKltTrackers["Camera"] = new vpMbKltTracker();
 
   //Add default camera transformation matrix
@@ -68,7 +70,7 @@ vpMbKltMultiTracker::vpMbKltMultiTracker() : m_mapOfCameraTransformationMatrix()
   \param nbCameras : Number of cameras to use.
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker(const unsigned int nbCameras) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfKltTrackers(), m_referenceCameraName("Camera") {
+    m_mapOfKltTrackers(), m_referenceCameraName("Camera"), m_parallelCameraTracking(false) {
 
   if(nbCameras == 0) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbkltMultiTracker with no camera !");
@@ -108,7 +110,7 @@ vpMbKltMultiTracker::vpMbKltMultiTracker(const unsigned int nbCameras) : m_mapOf
   \param cameraNames : List of camera names.
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker(const std::vector<std::string> &cameraNames) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfKltTrackers(), m_referenceCameraName("Camera") {
+    m_mapOfKltTrackers(), m_referenceCameraName("Camera"), m_parallelCameraTracking(false) {
   if(cameraNames.empty()) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbKltMultiTracker with no camera !");
   }
@@ -189,39 +191,94 @@ void vpMbKltMultiTracker::computeVVS(std::map<std::string, unsigned int> &mapOfN
     mapOfVelocityTwist[it->first] = cVo;
   }
 
+  // Cameras in the map order, with the first row of their block in the stacked residual
+  int nbCameras = (int)m_mapOfKltTrackers.size();
+  std::vector<vpMbKltTracker *> trackers;
+  std::vector<vpHomogeneousMatrix> cameraTransformations;
+  std::vector<vpVelocityTwistMatrix> twists;
+  std::vector<unsigned int> nbRows;
+  std::vector<unsigned int> rowOffsets;
+  unsigned int nbrow = 0;
+  for(std::map<std::string, vpMbKltTracker*>::const_iterator it = m_mapOfKltTrackers.begin();
+      it != m_mapOfKltTrackers.end(); ++it) {
+    trackers.push_back(it->second);
+    cameraTransformations.push_back(m_mapOfCameraTransformationMatrix[it->first]);
+    twists.push_back(mapOfVelocityTwist[it->first]);
+    nbRows.push_back(2 * mapOfNbInfos[it->first]);
+    rowOffsets.push_back(nbrow);
+    nbrow += 2 * mapOfNbInfos[it->first];
+  }
+  bool parallel = m_parallelCameraTracking && nbCameras > 1;
+
   while( ((int)((normRes - normRes_1)*1e8) != 0 )  && (iter<maxIter) ) {
-    L.resize(0,0);
-    R.resize(0);
-
-    for(std::map<std::string, vpMbKltTracker*>::const_iterator it1 = m_mapOfKltTrackers.begin();
-        it1 != m_mapOfKltTrackers.end(); ++it1) {
-      unsigned int shift = 0;
-      vpColVector R_current;  // residu
-      vpMatrix L_current;     // interaction matrix
-      vpHomography H_current;
-
-      R_current.resize(2 * mapOfNbInfos[it1->first]);
-      L_current.resize(2 * mapOfNbInfos[it1->first], 6, 0);
-
-      //Use the ctTc0 variable instead of the formula in the monocular case
-      //to ensure that we have the same result than vpMbKltTracker
-      //as some slight differences can occur due to numerical imprecision
-      if(m_mapOfKltTrackers.size() == 1) {
-        computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-            it1->second->kltPolygons, it1->second->kltCylinders, ctTc0);
-      } else {
-        vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it1->first] *
-            cMo * it1->second->c0Mo.inverse();
-        computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-            it1->second->kltPolygons, it1->second->kltCylinders, c_curr_tTc_curr0);
+    if(parallel) {
+      L.resize(nbrow, 6, false);
+      R.resize(nbrow, false);
+
+      vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < nbCameras; i++) {
+        vpMbKltTracker *tracker = trackers[(size_t)i];
+        try {
+          unsigned int shift = 0;
+          vpColVector R_current;  // residu
+          vpMatrix L_current;     // interaction matrix
+          vpHomography H_current;
+
+          R_current.resize(nbRows[(size_t)i]);
+          L_current.resize(nbRows[(size_t)i], 6, 0);
+
+          vpHomogeneousMatrix c_curr_tTc_curr0 = cameraTransformations[(size_t)i] * cMo * tracker->c0Mo.inverse();
+          computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+              tracker->kltPolygons, tracker->kltCylinders, c_curr_tTc_curr0);
+
+          //VelocityTwistMatrix
+          L_current = L_current*twists[(size_t)i];
+
+          //Stack residu and interaction matrix in the block of the camera
+          R.insert(rowOffsets[(size_t)i], R_current);
+          L.insert(L_current, rowOffsets[(size_t)i], 0);
+        } catch(...) {
+          exceptions.setCurrentException((size_t)i);
+        }
       }
+      exceptions.throwFirst();
+    } else {
+      L.resize(0,0);
+      R.resize(0);
+
+      for(std::map<std::string, vpMbKltTracker*>::const_iterator it1 = m_mapOfKltTrackers.begin();
+          it1 != m_mapOfKltTrackers.end(); ++it1) {
+        unsigned int shift = 0;
+        vpColVector R_current;  // residu
+        vpMatrix L_current;     // interaction matrix
+        vpHomography H_current;
+
+        R_current.resize(2 * mapOfNbInfos[it1->first]);
+        L_current.resize(2 * mapOfNbInfos[it1->first], 6, 0);
+
+        //Use the ctTc0 variable instead of the formula in the monocular case
+        //to ensure that we have the same result than vpMbKltTracker
+        //as some slight differences can occur due to numerical imprecision
+        if(m_mapOfKltTrackers.size() == 1) {
+          computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+              it1->second->kltPolygons, it1->second->kltCylinders, ctTc0);
+        } else {
+          vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it1->first] *
+              cMo * it1->second->c0Mo.inverse();
+          computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+              it1->second->kltPolygons, it1->second->kltCylinders, c_curr_tTc_curr0);
+        }
 
-      //VelocityTwistMatrix
-      L_current = L_current*mapOfVelocityTwist[it1->first];
+        //VelocityTwistMatrix
+        L_current = L_current*mapOfVelocityTwist[it1->first];
 
-      //Stack residu and interaction matrix
-      R.stack(R_current);
-      L.stack(L_current);
+        //Stack residu and interaction matrix
+        R.stack(R_current);
+        L.stack(L_current);
+      }
     }
 
     bool reStartFromLastIncrement = false;
@@ -1565,33 +1622,110 @@ void vpMbKltMultiTracker::preTracking(std::map<std::string, const vpImage<unsign
     mapOfNbFaceUsed[it->first] = 0;
   }
 
-  for (std::map<std::string, vpMbKltTracker*>::const_iterator it =
-      m_mapOfKltTrackers.begin(); it != m_mapOfKltTrackers.end(); ++it) {
-    try {
-      it->second->preTracking(*mapOfImages[it->first], mapOfNbInfos[it->first], mapOfNbFaceUsed[it->first]);
-    } catch (/*vpException &e*/...) {
-//      throw e;
+  int nbCameras = (int)m_mapOfKltTrackers.size();
+  if(m_parallelCameraTracking && nbCameras > 1 && !useOgre) {
+    // Cameras in the map order
+    std::vector<vpMbKltTracker *> trackers;
+    std::vector<const vpImage<unsigned char> *> images;
+    std::vector<unsigned int *> nbInfos;
+    std::vector<unsigned int *> nbFaceUsed;
+    for (std::map<std::string, vpMbKltTracker*>::const_iterator it =
+        m_mapOfKltTrackers.begin(); it != m_mapOfKltTrackers.end(); ++it) {
+      trackers.push_back(it->second);
+      images.push_back(mapOfImages[it->first]);
+      nbInfos.push_back(&mapOfNbInfos[it->first]);
+      nbFaceUsed.push_back(&mapOfNbFaceUsed[it->first]);
+    }
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < nbCameras; i++) {
+      try {
+        trackers[(size_t)i]->preTracking(*images[(size_t)i], *nbInfos[(size_t)i], *nbFaceUsed[(size_t)i]);
+      } catch (/*vpException &e*/...) {
+//        throw e;
+      }
+    }
+  } else {
+    for (std::map<std::string, vpMbKltTracker*>::const_iterator it =
+        m_mapOfKltTrackers.begin(); it != m_mapOfKltTrackers.end(); ++it) {
+      try {
+        it->second->preTracking(*mapOfImages[it->first], mapOfNbInfos[it->first], mapOfNbFaceUsed[it->first]);
+      } catch (/*vpException &e*/...) {
+//        throw e;
+      }
     }
   }
 }
 
 void vpMbKltMultiTracker::postTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
     std::map<std::string, unsigned int> &mapOfNbInfos, vpColVector &w_klt) {
-  unsigned int shift = 0;
-  for(std::map<std::string, vpMbKltTracker *>::const_iterator it = m_mapOfKltTrackers.begin();
-      it != m_mapOfKltTrackers.end(); ++it) {
-    //Set the camera pose
-    it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
+  int nbCameras = (int)m_mapOfKltTrackers.size();
+  if(m_parallelCameraTracking && nbCameras > 1 && !useOgre) {
+    // Cameras in the map order, with the first row of their block in the weights
+    std::vector<vpMbKltTracker *> trackers;
+    std::vector<const vpImage<unsigned char> *> images;
+    std::vector<unsigned int> nbRows;
+    std::vector<unsigned int> shifts;
+    int referenceCamera = -1;
+    unsigned int shift = 0;
+    for(std::map<std::string, vpMbKltTracker *>::const_iterator it = m_mapOfKltTrackers.begin();
+        it != m_mapOfKltTrackers.end(); ++it) {
+      //Set the camera pose
+      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
 
-    if(mapOfNbInfos[it->first] > 0) {
-      vpSubColVector sub_w(w_klt, shift, 2*mapOfNbInfos[it->first]);
+      if(it->first == m_referenceCameraName) {
+        referenceCamera = (int)trackers.size();
+      }
+      trackers.push_back(it->second);
+      images.push_back(mapOfImages[it->first]);
+      nbRows.push_back(2*mapOfNbInfos[it->first]);
+      shifts.push_back(shift);
       shift += 2*mapOfNbInfos[it->first];
-      if(it->second->postTracking(*mapOfImages[it->first], sub_w)) {
-        it->second->reinit(*mapOfImages[it->first]);
+    }
+
+    std::vector<char> reinitialized((size_t)nbCameras, 0);
+    vpMbtCameraExceptions exceptions((size_t)nbCameras);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < nbCameras; i++) {
+      try {
+        if(nbRows[(size_t)i] > 0) {
+          vpSubColVector sub_w(w_klt, shifts[(size_t)i], nbRows[(size_t)i]);
+          if(trackers[(size_t)i]->postTracking(*images[(size_t)i], sub_w)) {
+            trackers[(size_t)i]->reinit(*images[(size_t)i]);
+            reinitialized[(size_t)i] = 1;
+          }
+        }
+      } catch(...) {
+        exceptions.setCurrentException((size_t)i);
+      }
+    }
+    exceptions.throwFirst();
 
-        //set ctTc0 to identity
-        if(it->first == m_referenceCameraName) {
-          reinit(/*mapOfImages[it->first]*/);
+    //set ctTc0 to identity
+    if(referenceCamera >= 0 && reinitialized[(size_t)referenceCamera]) {
+      reinit(/*mapOfImages[m_referenceCameraName]*/);
+    }
+  } else {
+    unsigned int shift = 0;
+    for(std::map<std::string, vpMbKltTracker *>::const_iterator it = m_mapOfKltTrackers.begin();
+        it != m_mapOfKltTrackers.end(); ++it) {
+      //Set the camera pose
+      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
+
+      if(mapOfNbInfos[it->first] > 0) {
+        vpSubColVector sub_w(w_klt, shift, 2*mapOfNbInfos[it->first]);
+        shift += 2*mapOfNbInfos[it->first];
+        if(it->second->postTracking(*mapOfImages[it->first], sub_w)) {
+          it->second->reinit(*mapOfImages[it->first]);
+
+          //set ctTc0 to identity
+          if(it->first == m_referenceCameraName) {
+            reinit(/*mapOfImages[it->first]*/);
+          }
         }
       }
     }
@@ -2274,6 +2408,24 @@ void vpMbKltMultiTracker::setOptimizationMethod(const vpMbtOptimizationMethod &o
   m_optimizationMethod = opt;
 }
 
+/*!
+  Track the cameras concurrently. This requires ViSP to be built with OpenMP,
+  otherwise the cameras are processed one after the other.
+
+  When enabled, the KLT points of each camera are tracked in a separate
+  thread, and the blocks of the stacked interaction matrix and residual of
+  the virtual visual servoing are computed concurrently. The blocks are always
+  stacked in the order of the camera names, so that the estimated pose is the
+  same as when the cameras are processed one after the other. When the Ogre
+  visibility test is used, the KLT points are tracked one camera after the
+  other.
+
+  \param parallel : true to track the cameras concurrently.
+*/
+void vpMbKltMultiTracker::setParallelCameraTracking(const bool parallel) {
+  m_parallelCameraTracking = parallel;
+}
+
 /*!
   Set the pose to be used in entry of the next call to the track() function.
   This pose will be just used once.
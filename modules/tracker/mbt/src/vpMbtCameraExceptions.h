@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Exceptions of the cameras processed in parallel by the multi-camera trackers.
+ *
+ *****************************************************************************/
+
+#ifndef vpMbtCameraExceptions_h
+#define vpMbtCameraExceptions_h
+
+#include <exception>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpMatrixException.h>
+#include <visp3/core/vpTrackingException.h>
+#include <visp3/vision/vpPoseException.h>
+#include <visp3/visual_features/vpFeatureException.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/*
+  Exceptions thrown while processing the cameras in a parallel loop. They
+  can not leave the parallel region and are thrown afterwards, the one of
+  the first camera in the map order first, as in a sequential loop.
+
+  setCurrentException() has to be called from a catch(...) block. Since
+  vpException has no virtual copy, the exception is rethrown and caught
+  again as each of the exception types of the trackers, from the most
+  derived ones, so that throwFirst() throws a copy of the same type. Other
+  exceptions are replaced by a vpException.
+*/
+class vpMbtCameraExceptions
+{
+public:
+  explicit vpMbtCameraExceptions(const size_t nbCameras)
+    : m_exceptions(nbCameras, (vpException *)NULL), m_throwers(nbCameras, (vpThrower)NULL) {}
+
+  ~vpMbtCameraExceptions() {
+    for(size_t i = 0; i < m_exceptions.size(); i++)
+      delete m_exceptions[i];
+  }
+
+  bool failed() const {
+    for(size_t i = 0; i < m_exceptions.size(); i++) {
+      if(m_exceptions[i] != NULL)
+        return true;
+    }
+    return false;
+  }
+
+  void setCurrentException(const size_t i) {
+    try {
+      throw;
+    } catch(vpTrackingException &e) {
+      set(i, e);
+    } catch(vpMatrixException &e) {
+      set(i, e);
+    } catch(vpImageException &e) {
+      set(i, e);
+    } catch(vpPoseException &e) {
+      set(i, e);
+    } catch(vpFeatureException &e) {
+      set(i, e);
+    } catch(vpException &e) {
+      set(i, e);
+    } catch(std::exception &e) {
+      set(i, vpException(vpException::fatalError, "%s", e.what()));
+    } catch(...) {
+      set(i, vpException(vpException::fatalError, "Unknown exception"));
+    }
+  }
+
+  void throwFirst() const {
+    for(size_t i = 0; i < m_exceptions.size(); i++) {
+      if(m_exceptions[i] != NULL)
+        m_throwers[i](*m_exceptions[i]);
+    }
+  }
+
+private:
+  typedef void (*vpThrower)(const vpException &);
+
+  template <class Exception> static void throwAs(const vpException &e) {
+    throw static_cast<const Exception &>(e);
+  }
+
+  template <class Exception> void set(const size_t i, const Exception &e) {
+    delete m_exceptions[i];
+    m_exceptions[i] = new Exception(e);
+    m_throwers[i] = &throwAs<Exception>;
+  }
+
+  vpMbtCameraExceptions(const vpMbtCameraExceptions &);
+  vpMbtCameraExceptions &operator=(const vpMbtCameraExceptions &);
+
+  std::vector<vpException *> m_exceptions;
+  std::vector<vpThrower> m_throwers;
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
@@ -0,0 +1,248 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the pose increment stopping criterion of the edge tracker.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMbEdgeTrackerPoseIncrement.cpp
+
+  \brief Track a box in a synthetic sequence with vpMbEdgeTracker, with and
+  without the pose increment stopping criterion of the virtual visual
+  servoing. Check that the criterion saves iterations and that the estimated
+  poses are still the ground truth ones.
+*/
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/mbt/vpMbEdgeTracker.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+  // Box of the tutorials, faces given by the index of their corners
+  const double box_points[8][3] = {
+    {0, 0, 0}, {0, 0, -0.08}, {0.165, 0, -0.08}, {0.165, 0, 0},
+    {0.165, 0.068, 0}, {0.165, 0.068, -0.08}, {0, 0.068, -0.08}, {0, 0.068, 0}
+  };
+  const unsigned int box_faces[6][4] = {
+    {0, 1, 2, 3}, {1, 6, 5, 2}, {4, 5, 6, 7}, {0, 3, 4, 7}, {5, 4, 3, 2}, {0, 7, 6, 1}
+  };
+  const unsigned char face_levels[6] = { 110, 150, 190, 230, 170, 130 };
+
+  void writeModel(const std::string &filename)
+  {
+    std::ofstream file(filename.c_str());
+    file << "V1" << std::endl << "8" << std::endl;
+    for (unsigned int i = 0; i < 8; i++)
+      file << box_points[i][0] << " " << box_points[i][1] << " " << box_points[i][2] << std::endl;
+    file << "0" << std::endl << "0" << std::endl << "6" << std::endl;
+    for (unsigned int f = 0; f < 6; f++)
+      file << "4 " << box_faces[f][0] << " " << box_faces[f][1] << " " << box_faces[f][2] << " "
+           << box_faces[f][3] << std::endl;
+    file << "0" << std::endl << "0" << std::endl;
+  }
+
+  // True if (u, v) is inside the convex polygon, whatever its orientation
+  bool isInside(const std::vector<double> &pu, const std::vector<double> &pv, double u, double v)
+  {
+    bool positive = false, negative = false;
+    for (size_t i = 0; i < pu.size(); i++) {
+      size_t j = (i + 1) % pu.size();
+      double cross = (pu[j] - pu[i]) * (v - pv[i]) - (pv[j] - pv[i]) * (u - pu[i]);
+      if (cross > 0)
+        positive = true;
+      else if (cross < 0)
+        negative = true;
+    }
+    return !(positive && negative);
+  }
+
+  // Render the visible faces of the box with a 4x4 supersampling
+  void render(vpImage<unsigned char> &I, const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo)
+  {
+    const unsigned int s = 4;
+    std::vector<double> sum(I.getSize(), 0.);
+    vpColVector center(3, 0.);
+    for (unsigned int i = 0; i < 8; i++)
+      for (unsigned int k = 0; k < 3; k++)
+        center[k] += box_points[i][k] / 8;
+
+    std::vector<unsigned int> label(I.getSize() * s * s, 6);
+    for (unsigned int f = 0; f < 6; f++) {
+      // Back face culling with the normal pointing outside the box
+      vpColVector faceCenter(3, 0.);
+      std::vector<double> pu, pv;
+      for (unsigned int c = 0; c < 4; c++) {
+        const double *P = box_points[box_faces[f][c]];
+        for (unsigned int k = 0; k < 3; k++)
+          faceCenter[k] += P[k] / 4;
+        double X = cMo[0][0]*P[0] + cMo[0][1]*P[1] + cMo[0][2]*P[2] + cMo[0][3];
+        double Y = cMo[1][0]*P[0] + cMo[1][1]*P[1] + cMo[1][2]*P[2] + cMo[1][3];
+        double Z = cMo[2][0]*P[0] + cMo[2][1]*P[1] + cMo[2][2]*P[2] + cMo[2][3];
+        double u, v;
+        vpMeterPixelConversion::convertPoint(cam, X / Z, Y / Z, u, v);
+        pu.push_back(u);
+        pv.push_back(v);
+      }
+      vpColVector n = faceCenter - center;
+      vpColVector n_c = cMo.getRotationMatrix() * n;
+      vpColVector c_c = cMo.getRotationMatrix() * faceCenter + vpColVector(cMo.getTranslationVector());
+      if (vpColVector::dotProd(n_c, c_c) >= 0)
+        continue;
+
+      for (unsigned int i = 0; i < I.getHeight() * s; i++)
+        for (unsigned int j = 0; j < I.getWidth() * s; j++)
+          if (isInside(pu, pv, (j + 0.5) / s - 0.5, (i + 0.5) / s - 0.5))
+            label[i * I.getWidth() * s + j] = f;
+    }
+
+    for (unsigned int i = 0; i < I.getHeight() * s; i++)
+      for (unsigned int j = 0; j < I.getWidth() * s; j++) {
+        unsigned int f = label[i * I.getWidth() * s + j];
+        sum[(i / s) * I.getWidth() + j / s] += (f < 6 ? face_levels[f] : 30);
+      }
+    for (unsigned int i = 0; i < I.getSize(); i++)
+      I.bitmap[i] = (unsigned char)vpMath::round(sum[i] / (s * s));
+  }
+
+  // Pose of frame k of the sequence
+  vpHomogeneousMatrix getPose(unsigned int k)
+  {
+    return vpHomogeneousMatrix(-0.07 + 0.002 * k, -0.02 + 0.001 * k, 0.45 + 0.003 * k,
+                               vpMath::rad(-35 + 0.5 * k), vpMath::rad(30 - 0.3 * k), vpMath::rad(10 + 0.4 * k));
+  }
+
+  /*
+    Track the sequence, return the total number of iterations of the second
+    phase of the virtual visual servoing and the largest pose errors.
+  */
+  unsigned int track(const std::vector<vpImage<unsigned char> > &sequence, const vpCameraParameters &cam,
+                     const std::string &model, double threshold, double &maxTranslationError,
+                     double &maxRotationError)
+  {
+    vpMbEdgeTracker tracker;
+    vpMe me;
+    me.setMaskSize(5);
+    me.setMaskNumber(180);
+    me.setRange(8);
+    me.setThreshold(10000);
+    me.setMu1(0.5);
+    me.setMu2(0.5);
+    me.setSampleStep(4);
+    tracker.setMovingEdge(me);
+    tracker.setCameraParameters(cam);
+    tracker.setAngleAppear(vpMath::rad(70));
+    tracker.setAngleDisappear(vpMath::rad(80));
+    tracker.setPoseIncrementThreshold(threshold);
+    tracker.loadModel(model);
+    tracker.initFromPose(sequence[0], getPose(0));
+
+    unsigned int nbIterations = 0;
+    maxTranslationError = maxRotationError = 0;
+    for (unsigned int k = 1; k < sequence.size(); k++) {
+      tracker.track(sequence[k]);
+      nbIterations += tracker.getNbSecondPhaseIterations();
+
+      vpHomogeneousMatrix cMo;
+      tracker.getPose(cMo);
+      vpColVector e = vpExponentialMap::inverse(getPose(k) * cMo.inverse());
+      maxTranslationError = std::max(maxTranslationError, std::sqrt(e[0]*e[0] + e[1]*e[1] + e[2]*e[2]));
+      maxRotationError = std::max(maxRotationError, std::sqrt(e[3]*e[3] + e[4]*e[4] + e[5]*e[5]));
+    }
+    return nbIterations;
+  }
+}
+
+int main()
+{
+  try {
+    std::string username;
+    vpIoTools::getUserName(username);
+#if defined(_WIN32)
+    std::string opath = "C:/temp";
+#else
+    std::string opath = "/tmp";
+#endif
+    opath = vpIoTools::createFilePath(opath, username);
+    if (vpIoTools::checkDirectory(opath) == false)
+      vpIoTools::makeDirectory(opath);
+    std::string model = vpIoTools::createFilePath(opath, "testMbEdgeTrackerPoseIncrement.cao");
+    writeModel(model);
+
+    vpCameraParameters cam(600, 600, 160, 120);
+    std::vector<vpImage<unsigned char> > sequence(20, vpImage<unsigned char>(240, 320));
+    for (unsigned int k = 0; k < sequence.size(); k++)
+      render(sequence[k], cam, getPose(k));
+
+    // Tolerance on the pose errors with respect to the ground truth
+    const double translationTolerance = 0.002, rotationTolerance = vpMath::rad(0.5);
+
+    double translationError, rotationError, translationError_threshold, rotationError_threshold;
+    unsigned int nbIterations = track(sequence, cam, model, 0, translationError, rotationError);
+    unsigned int nbIterations_threshold = track(sequence, cam, model, 1e-6, translationError_threshold,
+                                                rotationError_threshold);
+
+    std::cout << "Without threshold: " << nbIterations << " iterations, errors " << translationError << " m "
+              << vpMath::deg(rotationError) << " deg" << std::endl;
+    std::cout << "With threshold: " << nbIterations_threshold << " iterations, errors " << translationError_threshold
+              << " m " << vpMath::deg(rotationError_threshold) << " deg" << std::endl;
+
+    if (translationError > translationTolerance || rotationError > rotationTolerance) {
+      std::cerr << "The pose estimated without threshold is not the ground truth one" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (translationError_threshold > translationTolerance || rotationError_threshold > rotationTolerance) {
+      std::cerr << "The pose estimated with the threshold is not the ground truth one" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (nbIterations_threshold >= nbIterations) {
+      std::cerr << "The pose increment threshold does not save iterations" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -595,85 +595,126 @@ vpMeEllipse::leastSquare()
   // Construction du systeme Ax=b
   // i^2 + K0 j^2 + 2 K1 i j + 2 K2 i + 2 K3 j + K4
   // A = (j^2 2ij 2i 2j 1)   x = (K0 K1 K2 K3 K4)^T  b = (-i^2 )
+  // The weighted system is solved through its 5x5 normal equations. To keep
+  // them well conditioned the coordinates are first centered on the centroid
+  // of the sites and scaled to a unit mean distance to this centroid.
   unsigned int i ;
 
-  vpMeSite p_me ;
-
   unsigned int iter =0 ;
-  vpColVector b_(numberOfSignal()) ;
-  vpRobust r(numberOfSignal()) ;
+  unsigned int nos_1 = numberOfSignal() ;
+  vpRobust r(nos_1) ;
   r.setThreshold(2);
   r.setIteration(0) ;
-  vpMatrix D(numberOfSignal(),numberOfSignal()) ;
-  D.eye() ;
-  vpMatrix DA, DAmemory ;
-  vpColVector DAx ;
-  vpColVector w(numberOfSignal()) ;
+  vpColVector w(nos_1) ;
   w =1 ;
-  unsigned int nos_1 = numberOfSignal() ;
 
-  if (list.size() < 3)
+  if (list.size() < 3 || nos_1 == 0)
   {
     throw(vpException(vpException::dimensionError,
                       "Not enought moving edges to track the ellipse")) ;
   }
 
-  vpMatrix A(numberOfSignal(),5) ;
-  vpColVector x(5);
-
+  std::vector<double> u(nos_1), v(nos_1);
+  double ic = 0, jc = 0;
   unsigned int k =0 ;
   for(std::list<vpMeSite>::const_iterator it=list.begin(); it!=list.end(); ++it){
-    p_me = *it;
-    if (p_me.getState() == vpMeSite::NO_SUPPRESSION)
+    if (it->getState() == vpMeSite::NO_SUPPRESSION)
     {
-      A[k][0] = vpMath::sqr(p_me.jfloat) ;
-      A[k][1] = 2 * p_me.ifloat * p_me.jfloat ;
-      A[k][2] = 2 * p_me.ifloat ;
-      A[k][3] = 2 * p_me.jfloat ;
-      A[k][4] = 1 ;
-
-      b_[k] = - vpMath::sqr(p_me.ifloat) ;
+      u[k] = it->ifloat ;
+      v[k] = it->jfloat ;
+      ic += u[k] ;
+      jc += v[k] ;
       k++ ;
     }
   }
+  ic /= nos_1 ;
+  jc /= nos_1 ;
+
+  double scale = 0;
+  for (k = 0 ; k < nos_1 ; k++)
+  {
+    u[k] -= ic ;
+    v[k] -= jc ;
+    scale += sqrt(vpMath::sqr(u[k]) + vpMath::sqr(v[k])) ;
+  }
+  scale /= nos_1 ;
+  if (scale <= std::numeric_limits<double>::epsilon())
+    scale = 1 ;
+  for (k = 0 ; k < nos_1 ; k++)
+  {
+    u[k] /= scale ;
+    v[k] /= scale ;
+  }
+
+  vpMatrix AtWA(5,5) ;
+  vpColVector AtWb(5) ;
+  vpColVector x(5);
+  vpColVector residu(nos_1);
+  double a_k[5] ;
+  double scale2 = vpMath::sqr(scale) ;
 
   while (iter < 4 )
   {
-    DA = D*A ;
-    vpMatrix DAp ;
+    AtWA = 0 ;
+    AtWb = 0 ;
+    for (k = 0 ; k < nos_1 ; k++)
+    {
+      a_k[0] = vpMath::sqr(v[k]) ;
+      a_k[1] = 2 * u[k] * v[k] ;
+      a_k[2] = 2 * u[k] ;
+      a_k[3] = 2 * v[k] ;
+      a_k[4] = 1 ;
+      double b_k = - vpMath::sqr(u[k]) ;
+      double w2 = vpMath::sqr(w[k]) ;
+
+      for (i = 0 ; i < 5 ; i++)
+      {
+        double wa = w2 * a_k[i] ;
+        AtWb[i] += wa * b_k ;
+        for (unsigned int j = i ; j < 5 ; j++)
+          AtWA[i][j] += wa * a_k[j] ;
+      }
+    }
+    for (i = 1 ; i < 5 ; i++)
+      for (unsigned int j = 0 ; j < i ; j++)
+        AtWA[i][j] = AtWA[j][i] ;
 
-    x = DA.pseudoInverse(1e-26) *D*b_ ;
+    x = AtWA.pseudoInverse(1e-26) * AtWb ;
 
-    vpColVector residu(nos_1);
-    residu = b_ - A*x;
+    // Residues expressed in pixels, as if the system was built from the
+    // image coordinates
+    for (k = 0 ; k < nos_1 ; k++)
+    {
+      residu[k] = - scale2 * (vpMath::sqr(u[k]) + x[0] * vpMath::sqr(v[k]) + 2 * x[1] * u[k] * v[k]
+                              + 2 * x[2] * u[k] + 2 * x[3] * v[k] + x[4]) ;
+    }
     r.setIteration(iter) ;
     r.MEstimator(vpRobust::TUKEY,residu,w) ;
 
-    k = 0;
-    for (i=0 ; i < nos_1 ; i++)
-    {
-      D[k][k] =w[k]  ;
-      k++;
-    }
     iter++;
   }
 
   k =0 ;
   for(std::list<vpMeSite>::iterator it=list.begin(); it!=list.end(); ++it){
-    p_me = *it;
-    if (p_me.getState() == vpMeSite::NO_SUPPRESSION)
+    if (it->getState() == vpMeSite::NO_SUPPRESSION)
     {
       if (w[k] < thresholdWeight)
       {
-        p_me.setState(vpMeSite::M_ESTIMATOR);
-
-        *it = p_me;
+        it->setState(vpMeSite::M_ESTIMATOR);
       }
       k++ ;
     }
   }
-  for(i = 0; i < 5; i ++)
-    K[i] = x[i];
+
+  // Back to the image coordinates
+  double K2c = x[2] * scale ;
+  double K3c = x[3] * scale ;
+  double K4c = x[4] * scale2 ;
+  K[0] = x[0] ;
+  K[1] = x[1] ;
+  K[2] = K2c - ic - K[1] * jc ;
+  K[3] = K3c - K[0] * jc - K[1] * ic ;
+  K[4] = vpMath::sqr(ic) + K[0] * vpMath::sqr(jc) + 2 * K[1] * ic * jc - 2 * K2c * ic - 2 * K3c * jc + K4c ;
 
   getParameters() ;
 }
@@ -51,19 +51,10 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpRect.h>
 #include <visp3/core/vpImageTools.h>
-#include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpImageFilter.h>
 #include <stdlib.h>
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
-#ifdef VISP_HAVE_OPENCV
-#  if (VISP_HAVE_OPENCV_VERSION >= 0x020101) // Require opencv >= 2.1.1
-//#    include <opencv2/imgproc/imgproc.hpp>
-#    include <opencv2/imgproc/imgproc_c.h>
-#  else
-#    include <cv.h>
-#  endif
-#endif
 
 double computeDelta(double deltai, double deltaj);
 void findAngle(const vpImage<unsigned char> &I, const vpImagePoint &iP,
@@ -537,19 +528,14 @@ vpMeNurbs::seekExtremities(const vpImage<unsigned char> &I)
   
   This method is practicle when the edge is not smooth.
   
-  \note To use the canny detection, OpenCV has to be installed.
+  The edges are detected with vpImageFilter::canny() using the two
+  thresholds set with setCannyThreshold().
 
   \param I : Image in which the edge appears.
 */
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
 void
 vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> &I)
-#else
-void
-vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
-#endif
 {
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
   vpMeSite pt = list.front();
   vpImagePoint firstPoint(pt.ifloat,pt.jfloat);
   pt = list.back();
@@ -580,17 +566,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u > 0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-    
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-    
-    vpImageConvert::convert(dst, Isub);
-#endif
+    vpImageFilter::canny(Isub, Isub, 3, vpMath::minimum(cannyTh1, cannyTh2), vpMath::maximum(cannyTh1, cannyTh2), 3);
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -717,17 +693,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u < 1.0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-
-    vpImageConvert::convert(dst, Isub);
-#endif
+    vpImageFilter::canny(Isub, Isub, 3, vpMath::minimum(cannyTh1, cannyTh2), vpMath::maximum(cannyTh1, cannyTh2), 3);
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -834,9 +800,6 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     /* if (end != NULL) */ delete[] end;
     endPtFound = 0;
   }
-#else
-  vpTRACE("To use the canny detection, OpenCV has to be installed.");
-#endif
 }
 
 
@@ -903,73 +903,42 @@ void vpNurbs::globalCurveApprox(std::vector<vpImagePoint> &l_crossingPoints, uns
   for(unsigned int k = 0; k <= l_p ; k++)
     l_knots.push_back(1.0);
 
-  //Compute Rk
-  std::vector<vpImagePoint> Rk;
+  //Compute Rk and accumulate the normal equations A^T A P = A^T R. Each row
+  //of A has at most l_p+1 non null values, so that A is never built.
+  vpMatrix AtA(l_n-1,l_n-1);
+  vpColVector Ri(l_n-1);
+  vpColVector Rj(l_n-1);
+  vpColVector Rw(l_n-1);
   vpBasisFunction* N;
   for(unsigned int k = 1; k <= m-1; k++)
   {
     unsigned int span = findSpan(ubar[k], l_p, l_knots);
-    if (span == l_p && span == l_n) 
-    {
-      N = computeBasisFuns(ubar[k], span, l_p, l_knots);
-      vpImagePoint pt(l_crossingPoints[k].get_i()-N[0].value*l_crossingPoints[0].get_i()-N[l_p].value*l_crossingPoints[m].get_i(),
-		      l_crossingPoints[k].get_j()-N[0].value*l_crossingPoints[0].get_j()-N[l_p].value*l_crossingPoints[m].get_j());
-      Rk.push_back(pt);
-      delete[] N;
-    }
-    else if (span == l_p) 
-    {
-      N = computeBasisFuns(ubar[k], span, l_p, l_knots);
-      vpImagePoint pt(l_crossingPoints[k].get_i()-N[0].value*l_crossingPoints[0].get_i(),
-		      l_crossingPoints[k].get_j()-N[0].value*l_crossingPoints[0].get_j());
-      Rk.push_back(pt);
-      delete[] N;
-    }
-    else if (span == l_n)
+    N = computeBasisFuns(ubar[k], span, l_p, l_knots);
+    vpImagePoint Rk = l_crossingPoints[k];
+    if (span == l_p)
+      Rk.set_ij(Rk.get_i()-N[0].value*l_crossingPoints[0].get_i(),
+                Rk.get_j()-N[0].value*l_crossingPoints[0].get_j());
+    if (span == l_n)
+      Rk.set_ij(Rk.get_i()-N[l_p].value*l_crossingPoints[m].get_i(),
+                Rk.get_j()-N[l_p].value*l_crossingPoints[m].get_j());
+
+    for (unsigned int r = 0; r <= l_p; r++)
     {
-      N = computeBasisFuns(ubar[k], span, l_p, l_knots);
-      vpImagePoint pt(l_crossingPoints[k].get_i()-N[l_p].value*l_crossingPoints[m].get_i(),
-		      l_crossingPoints[k].get_j()-N[l_p].value*l_crossingPoints[m].get_j());
-      Rk.push_back(pt);
-      delete[] N;
-    }
-    else
-    {
-      Rk.push_back(l_crossingPoints[k]);
-    }
-  }
-
-  vpMatrix A(m-1,l_n-1);
-  //Compute A
-  for(unsigned int i = 1; i <= m-1; i++)
-  {
-    unsigned int span = findSpan(ubar[i], l_p, l_knots);
-    N = computeBasisFuns(ubar[i], span, l_p, l_knots);
-    for (unsigned int k = 0; k <= l_p; k++)
-    {
-      if (N[k].i > 0 && N[k].i < l_n)
-        A[i-1][N[k].i-1] = N[k].value;
+      if (N[r].i == 0 || N[r].i >= l_n)
+        continue;
+      unsigned int row = N[r].i-1;
+      Ri[row] += N[r].value*Rk.get_i();
+      Rj[row] += N[r].value*Rk.get_j();
+      Rw[row] += N[r].value; //The crossing points weigths are equal to 1.
+      for (unsigned int c = 0; c <= l_p; c++)
+      {
+        if (N[c].i > 0 && N[c].i < l_n)
+          AtA[row][N[c].i-1] += N[r].value*N[c].value;
+      }
     }
     delete[] N;
   }
   
-  vpColVector Ri(l_n-1);
-  vpColVector Rj(l_n-1);
-  vpColVector Rw(l_n-1);
-  for (unsigned int i = 0; i < l_n-1; i++)
-  {
-    double sum =0;
-    for (unsigned int k = 0; k < m-1; k++) sum = sum + A[k][i]*Rk[k].get_i();
-    Ri[i] = sum;
-    sum = 0;
-    for (unsigned int k = 0; k < m-1; k++) sum = sum + A[k][i]*Rk[k].get_j();
-    Rj[i] = sum;
-    sum = 0;
-    for (unsigned int k = 0; k < m-1; k++) sum = sum + A[k][i]; //The crossing points weigths are equal to 1.
-    Rw[i] = sum;
-  }
-  
-  vpMatrix AtA = A.AtA();
   vpMatrix AtAinv;
   AtA.pseudoInverse(AtAinv);
   
@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the ellipse and the Nurbs moving-edges trackers on synthetic images.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMeEllipseNurbs.cpp
+
+  \brief Track a synthetic ellipse with vpMeEllipse and a synthetic curve with
+  vpMeNurbs, check the estimated curves and measure the tracking time.
+*/
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/me/vpMeEllipse.h>
+#include <visp3/me/vpMeNurbs.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <vector>
+
+namespace {
+  // Dark ellipse of semi axes a (along j) and b (along i) on a bright background
+  void drawEllipse(vpImage<unsigned char> &I, double ic, double jc, double a, double b)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        double d = vpMath::sqr((j - jc) / a) + vpMath::sqr((i - ic) / b);
+        I[i][j] = (d <= 1) ? 50 : 200;
+      }
+    }
+  }
+
+  // Dark area below a sine shaped curve, shifted by j0 along j
+  double curve(double j, double j0)
+  {
+    return 240 + 40 * sin(2 * M_PI * (j - j0) / 400.);
+  }
+
+  void drawCurve(vpImage<unsigned char> &I, double j0)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        I[i][j] = (i >= curve(j, j0)) ? 50 : 200;
+      }
+    }
+  }
+
+  vpImagePoint ellipsePoint(double ic, double jc, double a, double b, double alpha)
+  {
+    return vpImagePoint(ic + b * sin(alpha), jc + a * cos(alpha));
+  }
+}
+
+int main()
+{
+  try {
+    const double a = 120, b = 80;
+    double ic = 240, jc = 300;
+    const unsigned int nframes = 20;
+    vpImage<unsigned char> I(480, 640);
+
+    vpMe me;
+    me.setRange(10);
+    me.setThreshold(15000);
+    me.setSampleStep(5);
+
+    // Ellipse
+    drawEllipse(I, ic, jc, a, b);
+    std::vector<vpImagePoint> ip;
+    for (unsigned int k = 0; k < 5; k++)
+      ip.push_back(ellipsePoint(ic, jc, a, b, vpMath::rad(310 - 70 * k)));
+
+    vpMeEllipse ellipse;
+    ellipse.setMe(&me);
+    ellipse.setDisplay(vpMeSite::NONE);
+    ellipse.initTracking(I, ip);
+
+    double t_ellipse = 0;
+    for (unsigned int frame = 0; frame < nframes; frame++) {
+      jc += 1;
+      drawEllipse(I, ic, jc, a, b);
+      double t = vpTime::measureTimeMs();
+      ellipse.track(I);
+      t_ellipse += vpTime::measureTimeMs() - t;
+    }
+
+    vpImagePoint center = ellipse.getCenter();
+    double axis_min = std::min(ellipse.getA(), ellipse.getB());
+    double axis_max = std::max(ellipse.getA(), ellipse.getB());
+    std::cout << "Ellipse center: " << center << " semi axes: " << axis_max << " " << axis_min << std::endl;
+    if (std::fabs(center.get_i() - ic) > 1 || std::fabs(center.get_j() - jc) > 1
+        || std::fabs(axis_max - a) > 2 || std::fabs(axis_min - b) > 2) {
+      std::cerr << "Wrong ellipse, expected center: " << vpImagePoint(ic, jc) << " semi axes: " << a << " " << b
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Ellipse tracking: " << t_ellipse / nframes << " ms per frame" << std::endl;
+
+    // Nurbs along an open curve
+    double j0 = 0;
+    drawCurve(I, j0);
+    std::list<vpImagePoint> ipList;
+    for (unsigned int k = 0; k <= 4; k++)
+      ipList.push_back(vpImagePoint(curve(200 + 60 * k, j0), 200 + 60 * k));
+
+    vpMeNurbs nurbs;
+    nurbs.setMe(&me);
+    nurbs.setDisplay(vpMeSite::NONE);
+    nurbs.setNbControlPoints(10);
+    nurbs.initTracking(I, ipList);
+
+    double t_nurbs = 0;
+    for (unsigned int frame = 0; frame < nframes; frame++) {
+      j0 += 1;
+      drawCurve(I, j0);
+      double t = vpTime::measureTimeMs();
+      nurbs.track(I);
+      t_nurbs += vpTime::measureTimeMs() - t;
+    }
+
+    std::cout << "Nurbs tracking: " << t_nurbs / nframes << " ms per frame" << std::endl;
+
+    std::list<vpMeSite> sites = nurbs.getMeList();
+    for (std::list<vpMeSite>::const_iterator it = sites.begin(); it != sites.end(); ++it) {
+      if (std::fabs(it->ifloat - curve(it->jfloat, j0)) > 3) {
+        std::cerr << "Site " << vpImagePoint(it->ifloat, it->jfloat) << " too far from the curve" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Approximation of a large number of points
+    std::list<vpImagePoint> pts;
+    for (unsigned int k = 0; k < 5000; k++)
+      pts.push_back(vpImagePoint(curve(k * 0.128, j0), k * 0.128));
+    vpNurbs n;
+    double t = vpTime::measureTimeMs();
+    n.globalCurveApprox(pts, 50);
+    std::cout << "Nurbs approximation of " << pts.size() << " points with 50 control points: "
+              << vpTime::measureTimeMs() - t << " ms" << std::endl;
+    if (vpImagePoint::distance(n.computeCurvePoint(0), pts.front()) > 1e-6
+        || vpImagePoint::distance(n.computeCurvePoint(1), pts.back()) > 1e-6) {
+      std::cerr << "The approximation should interpolate the end points" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
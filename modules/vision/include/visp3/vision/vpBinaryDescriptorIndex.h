@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Index of binary descriptors for approximate nearest neighbor matching.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpBinaryDescriptorIndex.h
+  \brief Index of binary descriptors based on multi-probe locality sensitive
+  hashing.
+*/
+
+#ifndef vpBinaryDescriptorIndex_h
+#define vpBinaryDescriptorIndex_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpBinaryDescriptorIndex
+  \ingroup group_vision_keypoints
+
+  \brief Index of binary descriptors (ORB, BRISK, BRIEF, FREAK, AKAZE...)
+  to find the nearest neighbors of query descriptors in the Hamming space.
+
+  The descriptors are stored in a single contiguous buffer and indexed by
+  several hash tables. Each table uses as key a fixed random subset of the
+  descriptor bits. A query is compared, with a popcount based Hamming
+  distance, only to the descriptors stored in its bucket and, with
+  multi-probing, in the buckets whose key differs by one (or two) bits. When
+  the probed buckets contain less than \e k descriptors, or when the index is
+  small, the query is compared to all the descriptors.
+
+  Descriptors can be added at any time with add(). Adding descriptors only
+  copies them; the hash tables are rebuilt by a linear counting sort before
+  the next query, which is much cheaper than training a FLANN index again.
+  The queries of a knnMatch() call are processed in parallel when ViSP is
+  built with OpenMP.
+
+  The index, including the hash tables, can be saved with save() and loaded
+  back with load().
+
+  \code
+#include <visp3/vision/vpBinaryDescriptorIndex.h>
+
+int main()
+{
+  // 32 bytes descriptors, as ORB
+  std::vector<unsigned char> train(1000*32), query(10*32);
+  // ... fill the descriptors
+
+  vpBinaryDescriptorIndex index;
+  index.add(&train[0], 1000, 32);
+
+  std::vector<std::vector<vpBinaryDescriptorIndex::vpMatch> > matches;
+  index.knnMatch(&query[0], 10, 2, matches);
+  for (size_t i = 0; i < matches.size(); i++) {
+    if (matches[i].size() == 2 && matches[i][0].distance < 0.8 * matches[i][1].distance)
+      std::cout << "Query " << i << " matches " << matches[i][0].trainIdx << std::endl;
+  }
+}
+  \endcode
+
+  \sa vpKeyPoint::setUseDescriptorIndex()
+*/
+class VISP_EXPORT vpBinaryDescriptorIndex
+{
+public:
+  /*!
+    Correspondence between a query descriptor and a descriptor of the index.
+  */
+  struct vpMatch {
+    unsigned int queryIdx; //!< Index of the query descriptor.
+    unsigned int trainIdx; //!< Index of the descriptor in the index.
+    unsigned int distance; //!< Hamming distance between the two descriptors.
+  };
+
+  vpBinaryDescriptorIndex(unsigned int nbTables=8, unsigned int keySize=14, unsigned int multiProbeLevel=1);
+  virtual ~vpBinaryDescriptorIndex();
+
+  void add(const unsigned char *descriptors, unsigned int rows, unsigned int descriptorSize);
+  void clear();
+
+  /*!
+    Return a pointer to the descriptor \e index.
+  */
+  inline const unsigned char *getDescriptor(unsigned int index) const
+  {
+    return &m_descriptors[(size_t)index * m_descriptorSize];
+  }
+  /*!
+    Return the size of the descriptors in bytes, 0 if the index is empty.
+  */
+  inline unsigned int getDescriptorSize() const { return m_descriptorSize; }
+  /*!
+    Return the number of descriptors in the index.
+  */
+  inline unsigned int size() const { return m_size; }
+
+  static unsigned int hammingDistance(const unsigned char *a, const unsigned char *b, unsigned int size);
+
+  void knnMatch(const unsigned char *queries, unsigned int rows, unsigned int k,
+                std::vector<std::vector<vpMatch> > &matches);
+
+  void load(const std::string &filename);
+  void save(const std::string &filename);
+
+  /*!
+    Set the number of descriptors under which the queries are compared to all
+    the descriptors instead of using the hash tables. The default value is 1000.
+  */
+  inline void setExhaustiveSearchThreshold(unsigned int size) { m_exhaustiveThreshold = size; }
+
+private:
+  void build();
+  unsigned int computeKey(const unsigned char *descriptor, unsigned int table) const;
+  void initKeyBits();
+  void searchExhaustive(const unsigned char *query, unsigned int k, std::vector<vpMatch> &best) const;
+
+  unsigned int m_nbTables;
+  unsigned int m_keySize;
+  unsigned int m_multiProbeLevel;
+  unsigned int m_exhaustiveThreshold;
+  unsigned int m_descriptorSize;
+  unsigned int m_size;
+  std::vector<unsigned char> m_descriptors;
+  //! Bits of the descriptors used as key by each table
+  std::vector<unsigned int> m_keyBits;
+  //! For each table, first index in m_buckets of each key (2^keySize + 1 values)
+  std::vector<unsigned int> m_offsets;
+  //! For each table, descriptor indexes sorted by key
+  std::vector<unsigned int> m_buckets;
+  //! True if descriptors were added since the last build of the tables
+  bool m_dirty;
+};
+
+#endif
@@ -52,9 +52,11 @@
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpMemoryMappedFile.h>
 #include <visp3/core/vpPlane.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpBinaryDescriptorIndex.h>
 #ifdef VISP_HAVE_MODULE_IO
 #  include <visp3/io/vpImageIo.h>
 #endif
@@ -567,7 +569,7 @@ public:
     \return The number of train images.
   */
   inline unsigned int getNbImages() const {
-    return static_cast<unsigned int>(m_mapOfImages.size());
+    return static_cast<unsigned int>(m_mapOfImages.size() + m_mapOfImagePaths.size());
   }
 
   void getObjectPoints(std::vector<cv::Point3f> &objectPoints) const;
@@ -664,7 +666,8 @@ public:
 
   void reset();
 
-  void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true);
+  void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true,
+                        const bool mappedFormat=false);
 
   /*!
     Set if the covariance matrix has to be computed in the Virtual Visual Servoing approach.
@@ -950,6 +953,9 @@ public:
     }
   }
 
+  void setTiledDetection(const unsigned int nbTileRows, const unsigned int nbTileCols,
+                         const unsigned int maxKeyPointsPerTile=0, const unsigned int tileOverlap=64);
+
   /*!
     Set if multiple affine transformations must be used to detect and extract keypoints.
 
@@ -976,6 +982,8 @@ public:
   }
 #endif
 
+  void setUseDescriptorIndex(const bool useIndex);
+
   /*!
     Set if we want to match the train keypoints to the query keypoints.
 
@@ -1028,6 +1036,8 @@ private:
   double m_detectionThreshold;
   //! Elapsed time to detect keypoints.
   double m_detectionTime;
+  //! Index of the binary train descriptors used for the matching if m_useDescriptorIndex is true.
+  vpBinaryDescriptorIndex m_descriptorIndex;
   //! List of detector names.
   std::vector<std::string> m_detectorNames;
   //! Map of smart reference-counting pointers (similar to shared_ptr in Boost) detectors,
@@ -1048,12 +1058,16 @@ private:
   vpImageFormatType m_imageFormat;
   //! List of k-nearest neighbors for each detected keypoints (if the method chosen is based upon on knn).
   std::vector<std::vector<cv::DMatch> > m_knnMatches;
+  //! Learning data file mapped in memory, referenced by the train descriptors.
+  cv::Ptr<vpMemoryMappedFile> m_learningDataFile;
   //! Map descriptor enum type to string.
   std::map<vpFeatureDescriptorType, std::string> m_mapOfDescriptorNames;
   //! Map detector enum type to string.
   std::map<vpFeatureDetectorType, std::string> m_mapOfDetectorNames;
   //! Map of image id to know to which training image is related a training keypoints.
   std::map<int, int> m_mapOfImageId;
+  //! Map of image id to the path of the training images loaded only when needed.
+  std::map<int, std::string> m_mapOfImagePaths;
   //! Map of images to have access to the image buffer according to his image id.
   std::map<int, vpImage<unsigned char> > m_mapOfImages;
   //! Smart reference-counting pointer (similar to shared_ptr in Boost) of descriptor matcher (e.g. BruteForce or FlannBased).
@@ -1070,10 +1084,16 @@ private:
   double m_matchingTime;
   //! List of pairs between the keypoint and the 3D point after the Ransac.
   std::vector<std::pair<cv::KeyPoint, cv::Point3f> > m_matchRansacKeyPointsToPoints;
+  //! Maximum number of keypoints kept in each tile with the tiled detection, 0 for no limit.
+  unsigned int m_maxKeyPointsPerTile;
   //! Maximum number of iterations for the Ransac method.
   int m_nbRansacIterations;
   //! Minimum number of inliers for the Ransac method.
   int m_nbRansacMinInlierCount;
+  //! Number of tiles along the image columns used to detect and extract keypoints in parallel.
+  unsigned int m_nbTileCols;
+  //! Number of tiles along the image rows used to detect and extract keypoints in parallel.
+  unsigned int m_nbTileRows;
   //! List of 3D points (in the object frame) filtered after the matching to compute the pose.
   std::vector<cv::Point3f> m_objectFilteredPoints;
   //! Elapsed time to compute the pose.
@@ -1095,6 +1115,8 @@ private:
   double m_ransacReprojectionError;
   //! Maximum error (in meter for the ViSP method) to decide if a point is an inlier or not.
   double m_ransacThreshold;
+  //! Number of pixels added around each tile so that the detectors and extractors see the tile neighborhood.
+  unsigned int m_tileOverlap;
   //! Matrix of descriptors (each row contains the descriptors values for each keypoints
   //detected in the train images).
   cv::Mat m_trainDescriptors;
@@ -1113,6 +1135,8 @@ private:
 #endif
   //! Flag set if a percentage value is used to determine the number of inliers for the Ransac method.
   bool m_useConsensusPercentage;
+  //! Flag set if the binary train descriptors are matched with m_descriptorIndex instead of m_matcher.
+  bool m_useDescriptorIndex;
   //! Flag set if a knn matching method must be used.
   bool m_useKnn;
   //! Flag set if we want to match the train keypoints to the query keypoints, useful when there is only one train image
@@ -1130,6 +1154,11 @@ private:
   double computePoseEstimationError(const std::vector<std::pair<cv::KeyPoint, cv::Point3f> > &matchKeyPoints,
                                     const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo_est);
 
+  void detectTiled(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoints, const cv::Mat &mask);
+
+  void extractTiled(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors,
+                    std::vector<cv::Point3f> *trainPoints);
+
   void filterMatches();
 
   void init();
@@ -1141,6 +1170,10 @@ private:
 
   void initFeatureNames();
 
+  void loadMappedLearningData(const std::string &filename, const std::string &parent, const bool append,
+                              const int startClassId, const int startImageId);
+  void loadTrainingImages();
+
   inline size_t myKeypointHash(const cv::KeyPoint &kp) {
     size_t _Val = 2166136261U, scale = 16777619U;
     Cv32suf u;
@@ -1156,6 +1189,11 @@ private:
     return _Val;
   }
 
+  void saveMappedLearningData(const std::string &filename, const std::map<int, std::string> &mapOfImgPath,
+                              const bool saveTrainingImages);
+
+  void updateDescriptorIndex(const int startRow);
+
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
   /*
@@ -40,12 +40,120 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
 
+#include <algorithm> // std::copy
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
+#include <vector>
 
 #undef MAX
 #undef MIN
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /* Normal equations L^T L x = L^T e of the multi-images calibration
+     restricted to the rows of one image. The unknowns are the 6 parameters of
+     the pose of this image and the intrinsic parameters shared by all the
+     images. */
+  struct vpCalibrationPoseSystem
+  {
+    vpMatrix U;       // L_pose^T L_pose (6 x 6)
+    vpMatrix W;       // L_pose^T L_intrinsics (6 x n)
+    vpMatrix V;       // L_intrinsics^T L_intrinsics (n x n)
+    vpColVector b;    // L_pose^T e
+    vpColVector c;    // L_intrinsics^T e
+    vpMatrix Uinv;    // Pseudo inverse of U
+    vpMatrix UinvW;   // U^+ W
+    double residual;  // Sum of the squared reprojection errors
+
+    void init(unsigned int n)
+    {
+      U.resize(6, 6);
+      W.resize(6, n);
+      V.resize(n, n);
+      b.resize(6);
+      c.resize(n);
+      residual = 0;
+    }
+
+    void addRow(const double *Lpose, const double *Lintrinsics, double e)
+    {
+      const unsigned int n = c.getRows();
+      for (unsigned int i = 0; i < 6; i++) {
+        for (unsigned int j = i; j < 6; j++)
+          U[i][j] += Lpose[i] * Lpose[j];
+        for (unsigned int j = 0; j < n; j++)
+          W[i][j] += Lpose[i] * Lintrinsics[j];
+        b[i] += Lpose[i] * e;
+      }
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = i; j < n; j++)
+          V[i][j] += Lintrinsics[i] * Lintrinsics[j];
+        c[i] += Lintrinsics[i] * e;
+      }
+    }
+
+    // Fill the lower part of the symmetric matrices
+    void symmetrize()
+    {
+      for (unsigned int i = 1; i < U.getRows(); i++)
+        for (unsigned int j = 0; j < i; j++)
+          U[i][j] = U[j][i];
+      for (unsigned int i = 1; i < V.getRows(); i++)
+        for (unsigned int j = 0; j < i; j++)
+          V[i][j] = V[j][i];
+    }
+  };
+
+  /* Least square solution of the normal equations of all the images, as given
+     by the pseudo inverse of the whole interaction matrix when it has full
+     rank. Since the pose blocks are independent, the pose parameters are
+     eliminated with the Schur complement: the intrinsic update is obtained from
+     a n x n system, then the update of each pose from its 6 x 6 block. */
+  void solveCalibrationSystems(std::vector<vpCalibrationPoseSystem> &systems, std::vector<vpColVector> &dPose,
+                               vpColVector &dIntrinsics)
+  {
+    const int nbPose = (int) systems.size();
+    const double svThreshold = std::numeric_limits<double>::epsilon();
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int p = 0; p < nbPose; p++) {
+      vpCalibrationPoseSystem &system = systems[(size_t) p];
+      system.symmetrize();
+      system.U.pseudoInverse(system.Uinv, svThreshold);
+      system.UinvW = system.Uinv * system.W;
+    }
+
+    // Reduced system on the intrinsics, summed in the image order
+    vpMatrix S = systems[0].V;
+    vpColVector s = systems[0].c;
+    for (int p = 1; p < nbPose; p++) {
+      S += systems[(size_t) p].V;
+      s += systems[(size_t) p].c;
+    }
+    for (int p = 0; p < nbPose; p++) {
+      const vpCalibrationPoseSystem &system = systems[(size_t) p];
+      S -= system.W.t() * system.UinvW;
+      s -= system.UinvW.t() * system.b;
+    }
+    vpMatrix Sinv;
+    S.pseudoInverse(Sinv, svThreshold);
+    dIntrinsics = Sinv * s;
+
+    dPose.resize(systems.size());
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int p = 0; p < nbPose; p++) {
+      const vpCalibrationPoseSystem &system = systems[(size_t) p];
+      dPose[(size_t) p] = system.Uinv * system.b - system.UinvW * dIntrinsics;
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
  
 void
 vpCalibration::calibLagrange(vpCameraParameters &cam_est, vpHomogeneousMatrix &cMo_est)
@@ -373,16 +481,12 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[256]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
+  std::vector<unsigned int> firstPoint(nbPose+1, 0); //index of the first point of each image
 
   for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
+    firstPoint[i+1] = firstPoint[i] + table_cal[i].npt;
+  unsigned int nbPointTotal = firstPoint[nbPose]; //total number of points
 
   if (nbPointTotal < 4) {
     //vpERROR_TRACE("Not enough point to calibrate");
@@ -390,14 +494,9 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
+  vpColVector oX(nbPointTotal), oY(nbPointTotal), oZ(nbPointTotal) ;
   vpColVector u(nbPointTotal) ;
   vpColVector v(nbPointTotal) ;
-
-  vpColVector P(2*nbPointTotal) ;
-  vpColVector Pd(2*nbPointTotal) ;
   vpImagePoint ip;
 
   unsigned int curPoint = 0 ; //current point indice
@@ -408,7 +507,7 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
     std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
     std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
     
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
+    for (unsigned int i =0 ; i < table_cal[p].npt ; i++)
     {
       oX[curPoint]  = *it_LoX;
       oY[curPoint]  = *it_LoY;
@@ -431,9 +530,12 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
 
   double  residu_1 = 1e12 ;
   double r =1e12-1;
+  std::vector<vpCalibrationPoseSystem> systems(nbPose);
+  std::vector<vpColVector> dPose;
+  vpColVector dIntrinsics;
   while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
   {
-
+    double t = vpTime::measureTimeMs();
     iter++ ;
     residu_1 = r ;
     
@@ -441,125 +543,82 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
     double py = cam_est.get_py();
     double u0 = cam_est.get_u0();
     double v0 = cam_est.get_v0();
-   
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;    
-        
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        Pd[curPoint2] =   u[curPoint] ;
-        Pd[curPoint2+1] = v[curPoint] ;
-
-        P[curPoint2] =    cX[curPoint]/cZ[curPoint]*px + u0 ;
-        P[curPoint2+1] =  cY[curPoint]/cZ[curPoint]*py + v0 ;
-
-        r += (vpMath::sqr(P[curPoint2]-Pd[curPoint2])
-               + vpMath::sqr(P[curPoint2+1]-Pd[curPoint2+1])) ;
-        curPoint++;
-      }
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
 
-    vpMatrix L(nbPointTotal*2,nbPose6+4) ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
+    // The rows of the interaction matrix of an image only depend on its pose
+    // and on the intrinsics (u0, v0, px, py)
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int p = 0; p < (int) nbPose; p++)
     {
-      unsigned int q = 6*p;   
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
+      vpCalibrationPoseSystem &system = systems[(size_t) p];
+      system.init(4);
+      const vpHomogeneousMatrix &cMoTmp = table_cal[(size_t) p].cMo;
+      double Lpose[6], Lintrinsics[4];
+      for (unsigned int i = firstPoint[(size_t) p]; i < firstPoint[(size_t) p+1]; i++)
       {
-        unsigned int curPoint2 = 2*curPoint;
-        unsigned int curPoint21 = curPoint2 + 1;
-
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
+        double x = oX[i]*cMoTmp[0][0]+oY[i]*cMoTmp[0][1]
+                   +oZ[i]*cMoTmp[0][2] + cMoTmp[0][3];
+        double y = oX[i]*cMoTmp[1][0]+oY[i]*cMoTmp[1][1]
+                   +oZ[i]*cMoTmp[1][2] + cMoTmp[1][3];
+        double z = oX[i]*cMoTmp[2][0]+oY[i]*cMoTmp[2][1]
+                   +oZ[i]*cMoTmp[2][2] + cMoTmp[2][3];
 
         double inv_z = 1/z;
-            
+
         double X =   x*inv_z ;
         double Y =   y*inv_z ;
 
-        //---------------
-        {
-          {
-            L[curPoint2][q] =  px * (-inv_z) ;
-            L[curPoint2][q+1] =  0 ;
-            L[curPoint2][q+2] =  px*(X*inv_z) ;
-            L[curPoint2][q+3] =  px*X*Y ;
-            L[curPoint2][q+4] =  -px*(1+X*X) ;
-            L[curPoint2][q+5] =  px*Y ;
-          }
-          {
-            L[curPoint2][nbPose6]= 1 ;
-            L[curPoint2][nbPose6+1]= 0 ;
-            L[curPoint2][nbPose6+2]= X ;
-            L[curPoint2][nbPose6+3]= 0;
-          }
-          {
-            L[curPoint21][q] = 0 ;
-            L[curPoint21][q+1] = py*(-inv_z) ;
-            L[curPoint21][q+2] = py*(Y*inv_z) ;
-            L[curPoint21][q+3] = py* (1+Y*Y) ;
-            L[curPoint21][q+4] = -py*X*Y ;
-            L[curPoint21][q+5] = -py*X ;
-          }
-          {
-            L[curPoint21][nbPose6]= 0 ;
-            L[curPoint21][nbPose6+1]= 1 ;
-            L[curPoint21][nbPose6+2]= 0;
-            L[curPoint21][nbPose6+3]= Y ;
-          }
-
-        }
-        curPoint++;
-      }    // end interaction
+        double error_u = X*px + u0 - u[i];
+        double error_v = Y*py + v0 - v[i];
+        system.residual += vpMath::sqr(error_u) + vpMath::sqr(error_v);
+
+        Lpose[0] =  px * (-inv_z) ;
+        Lpose[1] =  0 ;
+        Lpose[2] =  px*(X*inv_z) ;
+        Lpose[3] =  px*X*Y ;
+        Lpose[4] =  -px*(1+X*X) ;
+        Lpose[5] =  px*Y ;
+        Lintrinsics[0] = 1 ;
+        Lintrinsics[1] = 0 ;
+        Lintrinsics[2] = X ;
+        Lintrinsics[3] = 0 ;
+        system.addRow(Lpose, Lintrinsics, error_u);
+
+        Lpose[0] = 0 ;
+        Lpose[1] = py*(-inv_z) ;
+        Lpose[2] = py*(Y*inv_z) ;
+        Lpose[3] = py* (1+Y*Y) ;
+        Lpose[4] = -py*X*Y ;
+        Lpose[5] = -py*X ;
+        Lintrinsics[0] = 0 ;
+        Lintrinsics[1] = 1 ;
+        Lintrinsics[2] = 0 ;
+        Lintrinsics[3] = Y ;
+        system.addRow(Lpose, Lintrinsics, error_v);
+      }
     }
-    vpMatrix Lp ;
-    Lp = L.pseudoInverse(1e-10) ;
 
-    vpColVector e ;
-    e = Lp*error ;
-
-    vpColVector Tc, Tc_v(nbPose6) ;
-    Tc = -e*gain ;
-
-    //   Tc_v =0 ;
-    for (unsigned int i = 0 ; i < nbPose6 ; i++)
-      Tc_v[i] = Tc[i] ;
+    r = 0 ;
+    for (unsigned int p=0; p<nbPose ; p++)
+      r += systems[p].residual;
 
-    cam_est.initPersProjWithoutDistortion(px+Tc[nbPose6+2],
-                                      py+Tc[nbPose6+3],
-                                      u0+Tc[nbPose6],
-                                      v0+Tc[nbPose6+1]) ;
+    solveCalibrationSystems(systems, dPose, dIntrinsics);
 
-    //    cam.setKd(get_kd() + Tc[10]) ;
-    vpColVector Tc_v_Tmp(6) ;
+    cam_est.initPersProjWithoutDistortion(px-gain*dIntrinsics[2],
+                                      py-gain*dIntrinsics[3],
+                                      u0-gain*dIntrinsics[0],
+                                      v0-gain*dIntrinsics[1]) ;
 
     for (unsigned int p = 0 ; p < nbPose ; p++)
     {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo = vpExponentialMap::direct(Tc_v_Tmp,1).inverse()
+      table_cal[p].cMo = vpExponentialMap::direct(dPose[p]*(-gain),1).inverse()
                          * table_cal[p].cMo;
     }
 
     if (verbose)
-      std::cout <<  " std dev " << sqrt(r/nbPointTotal) << std::endl;
+      std::cout <<  " std dev " << sqrt(r/nbPointTotal)
+                << " (iteration " << iter << " in " << vpTime::measureTimeMs() - t << " ms)" << std::endl;
 
   }
   if (iter == nbIterMax)
@@ -833,15 +892,11 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[1024]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
+  std::vector<unsigned int> firstPoint(nbPose+1, 0); //index of the first point of each image
   for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
+    firstPoint[i+1] = firstPoint[i] + table_cal[i].npt;
+  unsigned int nbPointTotal = firstPoint[nbPose]; //total number of points
 
   if (nbPointTotal < 4)
   {
@@ -850,14 +905,9 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
+  vpColVector oX(nbPointTotal), oY(nbPointTotal), oZ(nbPointTotal) ;
   vpColVector u(nbPointTotal) ;
   vpColVector v(nbPointTotal) ;
-
-  vpColVector P(4*nbPointTotal) ;
-  vpColVector Pd(4*nbPointTotal) ;
   vpImagePoint ip;
 
   unsigned int curPoint = 0 ; //current point indice
@@ -868,7 +918,7 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
     std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
     std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
 
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
+    for (unsigned int i =0 ; i < table_cal[p].npt ; i++)
     {
       oX[curPoint]  = *it_LoX;
       oY[curPoint]  = *it_LoY;
@@ -890,32 +940,15 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
 
   double  residu_1 = 1e12 ;
   double r =1e12-1;
+  std::vector<vpCalibrationPoseSystem> systems(nbPose);
+  std::vector<vpColVector> dPose;
+  vpColVector dIntrinsics;
   while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
   {
+    double t = vpTime::measureTimeMs();
     iter++ ;
     residu_1 = r ;
 
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo_dist;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        curPoint++;
-      }
-    }
-
-
-    vpMatrix L(nbPointTotal*4,nbPose6+6) ;
-    curPoint = 0 ; //current point indice
     double px = cam_est.get_px() ;
     double py = cam_est.get_py() ;
     double u0 = cam_est.get_u0() ;
@@ -929,171 +962,145 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
 
     double k2ud = 2*kud;
     double k2du = 2*kdu;
-    
-    for (unsigned int p=0; p<nbPose ; p++)
+
+    // The rows of the interaction matrix of an image only depend on its pose
+    // and on the intrinsics (u0, v0, px, py, kdu, kud)
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int p = 0; p < (int) nbPose; p++)
     {
-      unsigned int q = 6*p;   
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
+      vpCalibrationPoseSystem &system = systems[(size_t) p];
+      system.init(6);
+      const vpHomogeneousMatrix &cMoTmp = table_cal[(size_t) p].cMo_dist;
+      double Lpose[6], Lintrinsics[6];
+      for (unsigned int i = firstPoint[(size_t) p]; i < firstPoint[(size_t) p+1]; i++)
       {
-        unsigned int curPoint4 = 4*curPoint;
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
+        double x = oX[i]*cMoTmp[0][0]+oY[i]*cMoTmp[0][1]
+                   +oZ[i]*cMoTmp[0][2] + cMoTmp[0][3];
+        double y = oX[i]*cMoTmp[1][0]+oY[i]*cMoTmp[1][1]
+                   +oZ[i]*cMoTmp[1][2] + cMoTmp[1][3];
+        double z = oX[i]*cMoTmp[2][0]+oY[i]*cMoTmp[2][1]
+                   +oZ[i]*cMoTmp[2][2] + cMoTmp[2][3];
 
-        double inv_z = 1/z;    
+        double inv_z = 1/z;
         double X =   x*inv_z ;
         double Y =   y*inv_z ;
 
         double X2 = X*X;
         double Y2 = Y*Y;
         double XY = X*Y;
-       
-        double up = u[curPoint] ;
-        double vp = v[curPoint] ;
 
-        Pd[curPoint4] =   up ;
-        Pd[curPoint4+1] = vp ;
+        double up = u[i] ;
+        double vp = v[i] ;
 
         double up0 = up - u0;
         double vp0 = vp - v0;
 
         double xp0 = up0 * inv_px;
         double xp02 = xp0 *xp0 ;
-      
+
         double yp0 = vp0 * inv_py;
         double yp02 = yp0 * yp0;
-      
+
         double r2du = xp02 + yp02 ;
         double kr2du = kdu * r2du;
 
-        P[curPoint4] =   u0 + px*X - kr2du *(up0) ;
-        P[curPoint4+1] = v0 + py*Y - kr2du *(vp0) ;
-
         double r2ud = X2 + Y2 ;
         double kr2ud = 1 + kud * r2ud;
-      
+
         double Axx = px*(kr2ud+k2ud*X2);
         double Axy = px*k2ud*XY;
         double Ayy = py*(kr2ud+k2ud*Y2);
         double Ayx = py*k2ud*XY;
 
-        Pd[curPoint4+2] = up ;
-        Pd[curPoint4+3] = vp ;
-
-        P[curPoint4+2] = u0 + px*X*kr2ud ;
-        P[curPoint4+3] = v0 + py*Y*kr2ud ;
-
-        r += (vpMath::sqr(P[curPoint4]-Pd[curPoint4]) +
-             vpMath::sqr(P[curPoint4+1]-Pd[curPoint4+1]) +
-             vpMath::sqr(P[curPoint4+2]-Pd[curPoint4+2]) +
-             vpMath::sqr(P[curPoint4+3]-Pd[curPoint4+3]))*0.5 ;
-
-        unsigned int curInd = curPoint4;
-        //---------------
-        {
-          {
-            L[curInd][q] =  px * (-inv_z) ;
-            L[curInd][q+1] =  0 ;
-            L[curInd][q+2] =  px*X*inv_z ;
-            L[curInd][q+3] =  px*X*Y ;
-            L[curInd][q+4] =  -px*(1+X2) ;
-            L[curInd][q+5] =  px*Y ;
-          }
-          {
-            L[curInd][nbPose6]= 1 + kr2du + k2du*xp02  ;
-            L[curInd][nbPose6+1]= k2du*up0*yp0*inv_py ;
-            L[curInd][nbPose6+2]= X + k2du*xp02*xp0 ;
-            L[curInd][nbPose6+3]= k2du*up0*yp02*inv_py ;
-            L[curInd][nbPose6+4] = -(up0)*(r2du) ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;     
-          {
-            L[curInd][q] = 0 ;
-            L[curInd][q+1] = py*(-inv_z) ;
-            L[curInd][q+2] = py*Y*inv_z ;
-            L[curInd][q+3] = py* (1+Y2) ;
-            L[curInd][q+4] = -py*XY ;
-            L[curInd][q+5] = -py*X ;
-          }
-          {
-            L[curInd][nbPose6]= k2du*xp0*vp0*inv_px ;
-            L[curInd][nbPose6+1]= 1 + kr2du + k2du*yp02;
-            L[curInd][nbPose6+2]= k2du*vp0*xp02*inv_px;
-            L[curInd][nbPose6+3]= Y + k2du*yp02*yp0;
-            L[curInd][nbPose6+4] = -vp0*r2du ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-  //---undistorted to distorted
-          {
-            L[curInd][q] = Axx*(-inv_z) ;
-            L[curInd][q+1] = Axy*(-inv_z) ;
-            L[curInd][q+2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
-            L[curInd][q+3] = Axx*X*Y +  Axy*(1+Y2);
-            L[curInd][q+4] = -Axx*(1+X2) - Axy*XY;
-            L[curInd][q+5] = Axx*Y -Axy*X;
-          }
-          {
-            L[curInd][nbPose6]= 1 ;
-            L[curInd][nbPose6+1]= 0 ;
-            L[curInd][nbPose6+2]= X*kr2ud ;
-            L[curInd][nbPose6+3]= 0;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = px*X*r2ud ;
-          }
-            curInd++;   
-          {
-            L[curInd][q] = Ayx*(-inv_z) ;
-            L[curInd][q+1] = Ayy*(-inv_z) ;
-            L[curInd][q+2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
-            L[curInd][q+3] = Ayx*XY + Ayy*(1+Y2) ;
-            L[curInd][q+4] = -Ayx*(1+X2) -Ayy*XY ;
-            L[curInd][q+5] = Ayx*Y -Ayy*X;
-          }
-          {
-            L[curInd][nbPose6]= 0 ;
-            L[curInd][nbPose6+1]= 1;
-            L[curInd][nbPose6+2]= 0;
-            L[curInd][nbPose6+3]= Y*kr2ud ;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = py*Y*r2ud ;
-          }
-        }  // end interaction
-        curPoint++;
-      }    // end interaction
+        //---distorted to undistorted
+        double error_u = u0 + px*X - kr2du *(up0) - up;
+        double error_v = v0 + py*Y - kr2du *(vp0) - vp;
+        //---undistorted to distorted
+        double error_ud = u0 + px*X*kr2ud - up;
+        double error_vd = v0 + py*Y*kr2ud - vp;
+
+        system.residual += (vpMath::sqr(error_u) + vpMath::sqr(error_v) +
+                            vpMath::sqr(error_ud) + vpMath::sqr(error_vd))*0.5 ;
+
+        Lpose[0] =  px * (-inv_z) ;
+        Lpose[1] =  0 ;
+        Lpose[2] =  px*X*inv_z ;
+        Lpose[3] =  px*X*Y ;
+        Lpose[4] =  -px*(1+X2) ;
+        Lpose[5] =  px*Y ;
+        Lintrinsics[0] = 1 + kr2du + k2du*xp02  ;
+        Lintrinsics[1] = k2du*up0*yp0*inv_py ;
+        Lintrinsics[2] = X + k2du*xp02*xp0 ;
+        Lintrinsics[3] = k2du*up0*yp02*inv_py ;
+        Lintrinsics[4] = -(up0)*(r2du) ;
+        Lintrinsics[5] = 0 ;
+        system.addRow(Lpose, Lintrinsics, error_u);
+
+        Lpose[0] = 0 ;
+        Lpose[1] = py*(-inv_z) ;
+        Lpose[2] = py*Y*inv_z ;
+        Lpose[3] = py* (1+Y2) ;
+        Lpose[4] = -py*XY ;
+        Lpose[5] = -py*X ;
+        Lintrinsics[0] = k2du*xp0*vp0*inv_px ;
+        Lintrinsics[1] = 1 + kr2du + k2du*yp02;
+        Lintrinsics[2] = k2du*vp0*xp02*inv_px;
+        Lintrinsics[3] = Y + k2du*yp02*yp0;
+        Lintrinsics[4] = -vp0*r2du ;
+        Lintrinsics[5] = 0 ;
+        system.addRow(Lpose, Lintrinsics, error_v);
+
+        Lpose[0] = Axx*(-inv_z) ;
+        Lpose[1] = Axy*(-inv_z) ;
+        Lpose[2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
+        Lpose[3] = Axx*X*Y +  Axy*(1+Y2);
+        Lpose[4] = -Axx*(1+X2) - Axy*XY;
+        Lpose[5] = Axx*Y -Axy*X;
+        Lintrinsics[0] = 1 ;
+        Lintrinsics[1] = 0 ;
+        Lintrinsics[2] = X*kr2ud ;
+        Lintrinsics[3] = 0;
+        Lintrinsics[4] = 0 ;
+        Lintrinsics[5] = px*X*r2ud ;
+        system.addRow(Lpose, Lintrinsics, error_ud);
+
+        Lpose[0] = Ayx*(-inv_z) ;
+        Lpose[1] = Ayy*(-inv_z) ;
+        Lpose[2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
+        Lpose[3] = Ayx*XY + Ayy*(1+Y2) ;
+        Lpose[4] = -Ayx*(1+X2) -Ayy*XY ;
+        Lpose[5] = Ayx*Y -Ayy*X;
+        Lintrinsics[0] = 0 ;
+        Lintrinsics[1] = 1;
+        Lintrinsics[2] = 0;
+        Lintrinsics[3] = Y*kr2ud ;
+        Lintrinsics[4] = 0 ;
+        Lintrinsics[5] = py*Y*r2ud ;
+        system.addRow(Lpose, Lintrinsics, error_vd);
+      }
     }
 
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
+    r = 0 ;
+    for (unsigned int p=0; p<nbPose ; p++)
+      r += systems[p].residual;
 
-    vpMatrix Lp ;
-    /*double rank =*/
-    L.pseudoInverse(Lp,1e-10) ;
-    vpColVector e ;
-    e = Lp*error ;
-    vpColVector Tc, Tc_v(6*nbPose) ;
-    Tc = -e*gain ;
-    for (unsigned int i = 0 ; i < 6*nbPose ; i++)
-      Tc_v[i] = Tc[i] ;
+    solveCalibrationSystems(systems, dPose, dIntrinsics);
 
-    cam_est.initPersProjWithDistortion(  px+Tc[nbPose6+2], py+Tc[nbPose6+3],
-                                     u0+Tc[nbPose6], v0+Tc[nbPose6+1],
-                                     kud + Tc[nbPose6+5],
-                                     kdu + Tc[nbPose6+4]);
+    cam_est.initPersProjWithDistortion(  px-gain*dIntrinsics[2], py-gain*dIntrinsics[3],
+                                     u0-gain*dIntrinsics[0], v0-gain*dIntrinsics[1],
+                                     kud-gain*dIntrinsics[5],
+                                     kdu-gain*dIntrinsics[4]);
 
-    vpColVector Tc_v_Tmp(6) ;
     for (unsigned int p = 0 ; p < nbPose ; p++)
     {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo_dist = vpExponentialMap::direct(Tc_v_Tmp).inverse()
+      table_cal[p].cMo_dist = vpExponentialMap::direct(dPose[p]*(-gain)).inverse()
                             * table_cal[p].cMo_dist;
     }
     if (verbose)
-      std::cout <<  " std dev: " << sqrt(r/nbPointTotal) << std::endl;
+      std::cout <<  " std dev: " << sqrt(r/nbPointTotal)
+                << " (iteration " << iter << " in " << vpTime::measureTimeMs() - t << " ms)" << std::endl;
     //std::cout <<  "   residual: " << r << std::endl;
 
   }
@@ -1331,216 +1338,12 @@ vpCalibration::calibVVSMulti(unsigned int nbPose,
                              vpCameraParameters &cam_est,
                              bool verbose)
 {
-  std::ios::fmtflags original_flags( std::cout.flags() );
-  std::cout.precision(10);
-  unsigned int nbPoint[256]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
-
-  unsigned int nbPose6 = 6*nbPose;
-
-  for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
-
-  if (nbPointTotal < 4)
-  {
-    //vpERROR_TRACE("Not enough point to calibrate");
-    throw(vpCalibrationException(vpCalibrationException::notInitializedError,
-                                 "Not enough point to calibrate")) ;
-  }
-
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(2*nbPointTotal) ;
-  vpColVector Pd(2*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
-
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
-  unsigned int iter = 0 ;
-
-  double  residu_1 = 1e12 ;
-  double r =1e12-1;
-  while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
-  {
-
-    iter++ ;
-    residu_1 = r ;
-
-    double px = cam_est.get_px();
-    double py = cam_est.get_py();
-    double u0 = cam_est.get_u0();
-    double v0 = cam_est.get_v0();
-
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        Pd[curPoint2] =   u[curPoint] ;
-        Pd[curPoint2+1] = v[curPoint] ;
-
-        P[curPoint2] =    cX[curPoint]/cZ[curPoint]*px + u0 ;
-        P[curPoint2+1] =  cY[curPoint]/cZ[curPoint]*py + v0 ;
-
-        r += (vpMath::sqr(P[curPoint2]-Pd[curPoint2])
-               + vpMath::sqr(P[curPoint2+1]-Pd[curPoint2+1])) ;
-        curPoint++;
-      }
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix L(nbPointTotal*2,nbPose6+4) ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-        unsigned int curPoint21 = curPoint2 + 1;
-
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;
-
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        //---------------
-        {
-          {
-            L[curPoint2][q] =  px * (-inv_z) ;
-            L[curPoint2][q+1] =  0 ;
-            L[curPoint2][q+2] =  px*(X*inv_z) ;
-            L[curPoint2][q+3] =  px*X*Y ;
-            L[curPoint2][q+4] =  -px*(1+X*X) ;
-            L[curPoint2][q+5] =  px*Y ;
-          }
-          {
-            L[curPoint2][nbPose6]= 1 ;
-            L[curPoint2][nbPose6+1]= 0 ;
-            L[curPoint2][nbPose6+2]= X ;
-            L[curPoint2][nbPose6+3]= 0;
-          }
-          {
-            L[curPoint21][q] = 0 ;
-            L[curPoint21][q+1] = py*(-inv_z) ;
-            L[curPoint21][q+2] = py*(Y*inv_z) ;
-            L[curPoint21][q+3] = py* (1+Y*Y) ;
-            L[curPoint21][q+4] = -py*X*Y ;
-            L[curPoint21][q+5] = -py*X ;
-          }
-          {
-            L[curPoint21][nbPose6]= 0 ;
-            L[curPoint21][nbPose6+1]= 1 ;
-            L[curPoint21][nbPose6+2]= 0;
-            L[curPoint21][nbPose6+3]= Y ;
-          }
-
-        }
-        curPoint++;
-      }    // end interaction
-    }
-    vpMatrix Lp ;
-    Lp = L.pseudoInverse(1e-10) ;
-
-    vpColVector e ;
-    e = Lp*error ;
-
-    vpColVector Tc, Tc_v(nbPose6) ;
-    Tc = -e*gain ;
-
-    //   Tc_v =0 ;
-    for (unsigned int i = 0 ; i < nbPose6 ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithoutDistortion(px+Tc[nbPose6+2],
-                                      py+Tc[nbPose6+3],
-                                      u0+Tc[nbPose6],
-                                      v0+Tc[nbPose6+1]) ;
-
-    //    cam.setKd(get_kd() + Tc[10]) ;
-    vpColVector Tc_v_Tmp(6) ;
-
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo = vpExponentialMap::direct(Tc_v_Tmp,1).inverse()
-                         * table_cal[p].cMo;
-    }
-    if (verbose)
-      std::cout <<  " std dev " << sqrt(r/nbPointTotal) << std::endl;
-
-  }
-  if (iter == nbIterMax)
-  {
-    vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
-    throw(vpCalibrationException(vpCalibrationException::convergencyError,
-                                 "Maximum number of iterations reached")) ;
-  }
-  for (unsigned int p = 0 ; p < nbPose ; p++)
-  {
-    table_cal[p].cMo_dist = table_cal[p].cMo ;
-    table_cal[p].cam = cam_est;
-    table_cal[p].cam_dist = cam_est;
-    double deviation,deviation_dist;
-    table_cal[p].computeStdDeviation(deviation,deviation_dist);
-  }
+  std::vector<vpCalibration> table(table_cal, table_cal + nbPose);
+  double globalReprojectionError;
+  calibVVSMulti(table, cam_est, globalReprojectionError, verbose);
+  std::copy(table.begin(), table.end(), table_cal);
   if (verbose)
-    std::cout <<  " Global std dev " << sqrt(r/nbPointTotal) << std::endl;
-
-  // Restore ostream format
-  std::cout.flags(original_flags);
+    std::cout <<  " Global std dev " << globalReprojectionError << std::endl;
 }
 
 
@@ -1551,287 +1354,14 @@ vpCalibration::calibVVSWithDistortionMulti(
   vpCameraParameters &cam_est,
   bool verbose)
 {
-  std::ios::fmtflags original_flags( std::cout.flags() );
-  std::cout.precision(10);
-  unsigned int nbPoint[1024]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
-
-  unsigned int nbPose6 = 6*nbPose;
-  for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
-
-  if (nbPointTotal < 4)
-  {
-    //vpERROR_TRACE("Not enough point to calibrate");
-    throw(vpCalibrationException(vpCalibrationException::notInitializedError,
-                                 "Not enough point to calibrate")) ;
-  }
-
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(4*nbPointTotal) ;
-  vpColVector Pd(4*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
-  unsigned int iter = 0 ;
-
-  double  residu_1 = 1e12 ;
-  double r =1e12-1;
-  while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
-  {
-    iter++ ;
-    residu_1 = r ;
-
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo_dist;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        curPoint++;
-      }
-    }
-
-
-    vpMatrix L(nbPointTotal*4,nbPose6+6) ;
-    curPoint = 0 ; //current point indice
-    double px = cam_est.get_px() ;
-    double py = cam_est.get_py() ;
-    double u0 = cam_est.get_u0() ;
-    double v0 = cam_est.get_v0() ;
-
-    double inv_px = 1/px ;
-    double inv_py = 1/py ;
-
-    double kud = cam_est.get_kud() ;
-    double kdu = cam_est.get_kdu() ;
-
-    double k2ud = 2*kud;
-    double k2du = 2*kdu;
-
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint4 = 4*curPoint;
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        double X2 = X*X;
-        double Y2 = Y*Y;
-        double XY = X*Y;
-
-        double up = u[curPoint] ;
-        double vp = v[curPoint] ;
-
-        Pd[curPoint4] =   up ;
-        Pd[curPoint4+1] = vp ;
-
-        double up0 = up - u0;
-        double vp0 = vp - v0;
-
-        double xp0 = up0 * inv_px;
-        double xp02 = xp0 *xp0 ;
-
-        double yp0 = vp0 * inv_py;
-        double yp02 = yp0 * yp0;
-
-        double r2du = xp02 + yp02 ;
-        double kr2du = kdu * r2du;
-
-        P[curPoint4] =   u0 + px*X - kr2du *(up0) ;
-        P[curPoint4+1] = v0 + py*Y - kr2du *(vp0) ;
-
-        double r2ud = X2 + Y2 ;
-        double kr2ud = 1 + kud * r2ud;
-
-        double Axx = px*(kr2ud+k2ud*X2);
-        double Axy = px*k2ud*XY;
-        double Ayy = py*(kr2ud+k2ud*Y2);
-        double Ayx = py*k2ud*XY;
-
-        Pd[curPoint4+2] = up ;
-        Pd[curPoint4+3] = vp ;
-
-        P[curPoint4+2] = u0 + px*X*kr2ud ;
-        P[curPoint4+3] = v0 + py*Y*kr2ud ;
-
-        r += (vpMath::sqr(P[curPoint4]-Pd[curPoint4]) +
-             vpMath::sqr(P[curPoint4+1]-Pd[curPoint4+1]) +
-             vpMath::sqr(P[curPoint4+2]-Pd[curPoint4+2]) +
-             vpMath::sqr(P[curPoint4+3]-Pd[curPoint4+3]))*0.5 ;
-
-        unsigned int curInd = curPoint4;
-        //---------------
-        {
-          {
-            L[curInd][q] =  px * (-inv_z) ;
-            L[curInd][q+1] =  0 ;
-            L[curInd][q+2] =  px*X*inv_z ;
-            L[curInd][q+3] =  px*X*Y ;
-            L[curInd][q+4] =  -px*(1+X2) ;
-            L[curInd][q+5] =  px*Y ;
-          }
-          {
-            L[curInd][nbPose6]= 1 + kr2du + k2du*xp02  ;
-            L[curInd][nbPose6+1]= k2du*up0*yp0*inv_py ;
-            L[curInd][nbPose6+2]= X + k2du*xp02*xp0 ;
-            L[curInd][nbPose6+3]= k2du*up0*yp02*inv_py ;
-            L[curInd][nbPose6+4] = -(up0)*(r2du) ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-          {
-            L[curInd][q] = 0 ;
-            L[curInd][q+1] = py*(-inv_z) ;
-            L[curInd][q+2] = py*Y*inv_z ;
-            L[curInd][q+3] = py* (1+Y2) ;
-            L[curInd][q+4] = -py*XY ;
-            L[curInd][q+5] = -py*X ;
-          }
-          {
-            L[curInd][nbPose6]= k2du*xp0*vp0*inv_px ;
-            L[curInd][nbPose6+1]= 1 + kr2du + k2du*yp02;
-            L[curInd][nbPose6+2]= k2du*vp0*xp02*inv_px;
-            L[curInd][nbPose6+3]= Y + k2du*yp02*yp0;
-            L[curInd][nbPose6+4] = -vp0*r2du ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-  //---undistorted to distorted
-          {
-            L[curInd][q] = Axx*(-inv_z) ;
-            L[curInd][q+1] = Axy*(-inv_z) ;
-            L[curInd][q+2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
-            L[curInd][q+3] = Axx*X*Y +  Axy*(1+Y2);
-            L[curInd][q+4] = -Axx*(1+X2) - Axy*XY;
-            L[curInd][q+5] = Axx*Y -Axy*X;
-          }
-          {
-            L[curInd][nbPose6]= 1 ;
-            L[curInd][nbPose6+1]= 0 ;
-            L[curInd][nbPose6+2]= X*kr2ud ;
-            L[curInd][nbPose6+3]= 0;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = px*X*r2ud ;
-          }
-            curInd++;
-          {
-            L[curInd][q] = Ayx*(-inv_z) ;
-            L[curInd][q+1] = Ayy*(-inv_z) ;
-            L[curInd][q+2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
-            L[curInd][q+3] = Ayx*XY + Ayy*(1+Y2) ;
-            L[curInd][q+4] = -Ayx*(1+X2) -Ayy*XY ;
-            L[curInd][q+5] = Ayx*Y -Ayy*X;
-          }
-          {
-            L[curInd][nbPose6]= 0 ;
-            L[curInd][nbPose6+1]= 1;
-            L[curInd][nbPose6+2]= 0;
-            L[curInd][nbPose6+3]= Y*kr2ud ;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = py*Y*r2ud ;
-          }
-        }  // end interaction
-        curPoint++;
-      }    // end interaction
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix Lp ;
-    /*double rank =*/
-    L.pseudoInverse(Lp,1e-10) ;
-    vpColVector e ;
-    e = Lp*error ;
-    vpColVector Tc, Tc_v(6*nbPose) ;
-    Tc = -e*gain ;
-    for (unsigned int i = 0 ; i < 6*nbPose ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithDistortion(  px+Tc[nbPose6+2], py+Tc[nbPose6+3],
-                                     u0+Tc[nbPose6], v0+Tc[nbPose6+1],
-                                     kud + Tc[nbPose6+5],
-                                     kdu + Tc[nbPose6+4]);
-
-    vpColVector Tc_v_Tmp(6) ;
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo_dist = vpExponentialMap::direct(Tc_v_Tmp).inverse()
-                            * table_cal[p].cMo_dist;
-    }
-    if (verbose)
-      std::cout <<  " std dev: " << sqrt(r/nbPointTotal) << std::endl;
-    //std::cout <<  "   residual: " << r << std::endl;
-
-  }
-  if (iter == nbIterMax)
-  {
-    vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
-    throw(vpCalibrationException(vpCalibrationException::convergencyError,
-                                 "Maximum number of iterations reached")) ;
-  }
-
+  std::vector<vpCalibration> table(table_cal, table_cal + nbPose);
+  double globalReprojectionError;
+  calibVVSWithDistortionMulti(table, cam_est, globalReprojectionError, verbose);
   for (unsigned int p = 0 ; p < nbPose ; p++)
   {
-    table_cal[p].cam_dist = cam_est ;
+    table_cal[p] = table[p];
     table_cal[p].computeStdDeviation_dist(table_cal[p].cMo_dist, cam_est);
   }
   if (verbose)
-    std::cout <<" Global std dev " << sqrt(r/(nbPointTotal)) << std::endl;
-
-  // Restore ostream format
-  std::cout.flags(original_flags);
+    std::cout <<" Global std dev " << globalReprojectionError << std::endl;
 }
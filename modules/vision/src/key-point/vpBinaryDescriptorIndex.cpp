@@ -0,0 +1,474 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Index of binary descriptors for approximate nearest neighbor matching.
+ *
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpBinaryDescriptorIndex.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  const char vp_index_magic[8] = { 'V', 'P', 'B', 'D', 'I', 'D', 'X', '\0' };
+  const unsigned int vp_index_version = 1;
+  const unsigned int vp_index_byte_order = 0x01020304;
+  const unsigned int vp_index_max_key_size = 20;
+
+  inline unsigned int popcount64(uint64_t x)
+  {
+#if defined(__GNUC__) && defined(__POPCNT__)
+    return (unsigned int)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+  }
+
+  // xorshift32 generator
+  inline uint32_t nextRandom(uint32_t &state)
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  // Insert a candidate in the list of the k best matches sorted by increasing distance
+  inline void insertMatch(std::vector<vpBinaryDescriptorIndex::vpMatch> &best, unsigned int k,
+                          unsigned int trainIdx, unsigned int distance)
+  {
+    if (best.size() == k && distance >= best.back().distance)
+      return;
+    if (best.size() < k)
+      best.push_back(vpBinaryDescriptorIndex::vpMatch());
+    size_t i = best.size() - 1;
+    while (i > 0 && best[i-1].distance > distance) {
+      best[i] = best[i-1];
+      i--;
+    }
+    best[i].trainIdx = trainIdx;
+    best[i].distance = distance;
+  }
+
+  template<class Type> void writeArray(std::ofstream &file, const std::vector<Type> &v)
+  {
+    if (! v.empty())
+      file.write(reinterpret_cast<const char *>(&v[0]), (std::streamsize)(v.size() * sizeof(Type)));
+  }
+
+  template<class Type> void readArray(std::ifstream &file, std::vector<Type> &v, size_t n)
+  {
+    v.resize(n);
+    if (n > 0)
+      file.read(reinterpret_cast<char *>(&v[0]), (std::streamsize)(n * sizeof(Type)));
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Create an empty index.
+
+  \param nbTables : Number of hash tables. More tables increase the
+  probability to find the true nearest neighbors, and the query time.
+  \param keySize : Number of descriptor bits used as key by each table, at
+  most 20. Each table has 2^keySize buckets.
+  \param multiProbeLevel : 0 to probe only the bucket of the query, 1 to also
+  probe the buckets whose key differs by one bit, 2 to also probe the buckets
+  whose key differs by two bits.
+*/
+vpBinaryDescriptorIndex::vpBinaryDescriptorIndex(unsigned int nbTables, unsigned int keySize,
+                                                 unsigned int multiProbeLevel)
+  : m_nbTables(nbTables), m_keySize(keySize), m_multiProbeLevel(multiProbeLevel), m_exhaustiveThreshold(1000),
+    m_descriptorSize(0), m_size(0), m_descriptors(), m_keyBits(), m_offsets(), m_buckets(), m_dirty(false)
+{
+  if (nbTables == 0 || keySize == 0 || keySize > vp_index_max_key_size) {
+    throw vpException(vpException::badValue, "The number of tables has to be positive and the key size in [1, %u]",
+                      vp_index_max_key_size);
+  }
+  if (multiProbeLevel > 2) {
+    throw vpException(vpException::badValue, "The multi-probe level has to be 0, 1 or 2");
+  }
+}
+
+/*!
+  Destructor.
+*/
+vpBinaryDescriptorIndex::~vpBinaryDescriptorIndex()
+{
+}
+
+/*!
+  Add descriptors to the index. Their indexes follow the ones of the
+  descriptors already in the index.
+
+  \param descriptors : Descriptors stored row by row.
+  \param rows : Number of descriptors.
+  \param descriptorSize : Size of a descriptor in bytes. It has to be the
+  same for all the descriptors of the index.
+
+  \exception vpException::dimensionError : If the descriptor size differs from
+  the one of the descriptors already in the index, or is too small for the key
+  size.
+*/
+void vpBinaryDescriptorIndex::add(const unsigned char *descriptors, unsigned int rows, unsigned int descriptorSize)
+{
+  if (rows == 0)
+    return;
+
+  if (m_size == 0) {
+    if (descriptorSize * 8 < m_keySize) {
+      throw vpException(vpException::dimensionError, "The descriptors of %u bytes are too small for a key of %u bits",
+                        descriptorSize, m_keySize);
+    }
+    if (descriptorSize != m_descriptorSize || m_keyBits.empty()) {
+      m_descriptorSize = descriptorSize;
+      initKeyBits();
+    }
+  }
+  else if (descriptorSize != m_descriptorSize) {
+    throw vpException(vpException::dimensionError, "Cannot add descriptors of %u bytes to an index of %u bytes descriptors",
+                      descriptorSize, m_descriptorSize);
+  }
+
+  m_descriptors.insert(m_descriptors.end(), descriptors, descriptors + (size_t)rows * descriptorSize);
+  m_size += rows;
+  m_dirty = true;
+}
+
+/*!
+  Remove all the descriptors from the index.
+*/
+void vpBinaryDescriptorIndex::clear()
+{
+  m_descriptorSize = 0;
+  m_size = 0;
+  m_descriptors.clear();
+  m_keyBits.clear();
+  m_offsets.clear();
+  m_buckets.clear();
+  m_dirty = false;
+}
+
+/*!
+  Compute the Hamming distance between two binary descriptors.
+
+  \param a, b : Descriptors.
+  \param size : Size of the descriptors in bytes.
+  \return Number of different bits.
+*/
+unsigned int vpBinaryDescriptorIndex::hammingDistance(const unsigned char *a, const unsigned char *b, unsigned int size)
+{
+  unsigned int distance = 0;
+  unsigned int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t wa, wb;
+    memcpy(&wa, a + i, 8);
+    memcpy(&wb, b + i, 8);
+    distance += popcount64(wa ^ wb);
+  }
+  for (; i < size; i++)
+    distance += popcount64((uint64_t)(a[i] ^ b[i]));
+  return distance;
+}
+
+/*!
+  Find the \e k nearest neighbors of each query descriptor.
+
+  \param queries : Query descriptors stored row by row, with the same size as
+  the descriptors of the index.
+  \param rows : Number of query descriptors.
+  \param k : Number of neighbors to find.
+  \param matches : For each query, the matches sorted by increasing
+  distance. A query has less than \e k matches only if the index contains
+  less than \e k descriptors.
+*/
+void vpBinaryDescriptorIndex::knnMatch(const unsigned char *queries, unsigned int rows, unsigned int k,
+                                       std::vector<std::vector<vpMatch> > &matches)
+{
+  matches.resize(rows);
+  if (m_size == 0 || k == 0) {
+    for (unsigned int q = 0; q < rows; q++)
+      matches[q].clear();
+    return;
+  }
+
+  bool useTables = m_size > m_exhaustiveThreshold;
+  if (useTables && m_dirty)
+    build();
+
+  const unsigned int nbKeys = 1u << m_keySize;
+
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // Last query that reached each descriptor, to compare a candidate found by several tables only once
+    std::vector<unsigned int> stamp(useTables ? m_size : 0, 0);
+    std::vector<unsigned int> probes;
+
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp for schedule(dynamic, 16)
+#endif
+    for (int q = 0; q < (int)rows; q++) {
+      const unsigned char *query = queries + (size_t)q * m_descriptorSize;
+      std::vector<vpMatch> &best = matches[(size_t)q];
+      best.clear();
+
+      unsigned int nbCandidates = 0;
+      if (useTables) {
+        for (unsigned int t = 0; t < m_nbTables; t++) {
+          unsigned int key = computeKey(query, t);
+          probes.clear();
+          probes.push_back(key);
+          if (m_multiProbeLevel >= 1) {
+            for (unsigned int b1 = 0; b1 < m_keySize; b1++) {
+              probes.push_back(key ^ (1u << b1));
+              if (m_multiProbeLevel >= 2) {
+                for (unsigned int b2 = b1 + 1; b2 < m_keySize; b2++)
+                  probes.push_back(key ^ (1u << b1) ^ (1u << b2));
+              }
+            }
+          }
+
+          const unsigned int *offsets = &m_offsets[(size_t)t * (nbKeys + 1)];
+          const unsigned int *buckets = &m_buckets[(size_t)t * m_size];
+          for (size_t p = 0; p < probes.size(); p++) {
+            for (unsigned int n = offsets[probes[p]]; n < offsets[probes[p] + 1]; n++) {
+              unsigned int index = buckets[n];
+              if (stamp[index] == (unsigned int)q + 1)
+                continue;
+              stamp[index] = (unsigned int)q + 1;
+              nbCandidates++;
+              insertMatch(best, k, index, hammingDistance(query, getDescriptor(index), m_descriptorSize));
+            }
+          }
+        }
+      }
+
+      if (nbCandidates < k) {
+        best.clear();
+        searchExhaustive(query, k, best);
+      }
+      for (size_t i = 0; i < best.size(); i++)
+        best[i].queryIdx = (unsigned int)q;
+    }
+  }
+}
+
+/*!
+  Load an index saved with save(). The descriptors already in the index are
+  removed.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file cannot be read or is not a
+  valid index file.
+*/
+void vpBinaryDescriptorIndex::load(const std::string &filename)
+{
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  if (! file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot open the descriptor index file %s", filename.c_str());
+  }
+
+  char magic[8];
+  unsigned int header[7];
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (! file || memcmp(magic, vp_index_magic, sizeof(magic)) != 0) {
+    throw vpException(vpException::ioError, "%s is not a descriptor index file", filename.c_str());
+  }
+  if (header[0] != vp_index_version || header[1] != vp_index_byte_order) {
+    throw vpException(vpException::ioError, "Unsupported version or byte order in descriptor index file %s",
+                      filename.c_str());
+  }
+  const size_t nbBits = (size_t)header[5] * 8;
+  if (header[2] == 0 || header[3] == 0 || header[3] > vp_index_max_key_size || header[4] > 2
+      || (header[6] > 0 && nbBits < header[3])) {
+    throw vpException(vpException::ioError, "Bad parameters in descriptor index file %s", filename.c_str());
+  }
+
+  // An empty index is saved without its tables
+  const size_t nbKeys = (size_t)1 << header[3];
+  size_t nbKeyBits = 0, nbOffsets = 0, nbBuckets = 0, nbBytes = 0;
+  if (header[6] > 0) {
+    nbKeyBits = (size_t)header[2] * header[3];
+    nbOffsets = (size_t)header[2] * (nbKeys + 1);
+    nbBuckets = (size_t)header[2] * header[6];
+    nbBytes = (size_t)header[6] * header[5];
+  }
+
+  // Check the size of the file before allocating the arrays
+  std::streampos position = file.tellg();
+  file.seekg(0, std::ifstream::end);
+  size_t remaining = (size_t)(file.tellg() - position);
+  file.seekg(position);
+  if (! file || remaining != (nbKeyBits + nbOffsets + nbBuckets) * sizeof(unsigned int) + nbBytes) {
+    throw vpException(vpException::ioError, "Truncated or corrupted descriptor index file %s", filename.c_str());
+  }
+
+  clear();
+  m_nbTables = header[2];
+  m_keySize = header[3];
+  m_multiProbeLevel = header[4];
+  m_descriptorSize = header[5];
+  m_size = header[6];
+
+  readArray(file, m_keyBits, nbKeyBits);
+  readArray(file, m_offsets, nbOffsets);
+  readArray(file, m_buckets, nbBuckets);
+  readArray(file, m_descriptors, nbBytes);
+  if (! file) {
+    clear();
+    throw vpException(vpException::ioError, "Truncated descriptor index file %s", filename.c_str());
+  }
+
+  // The queries index the descriptors with the key bits and the buckets
+  // without any check
+  bool valid = true;
+  for (size_t i = 0; i < m_keyBits.size() && valid; i++)
+    valid = m_keyBits[i] < nbBits;
+  for (size_t t = 0; t < nbOffsets && valid; t += nbKeys + 1) {
+    valid = m_offsets[t] == 0 && m_offsets[t + nbKeys] == m_size;
+    for (size_t key = 0; key < nbKeys && valid; key++)
+      valid = m_offsets[t + key] <= m_offsets[t + key + 1];
+  }
+  for (size_t i = 0; i < m_buckets.size() && valid; i++)
+    valid = m_buckets[i] < m_size;
+  if (! valid) {
+    clear();
+    throw vpException(vpException::ioError, "Corrupted tables in descriptor index file %s", filename.c_str());
+  }
+}
+
+/*!
+  Save the index, including its hash tables, in a binary file.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file cannot be written.
+*/
+void vpBinaryDescriptorIndex::save(const std::string &filename)
+{
+  if (m_dirty || (m_size > 0 && m_offsets.empty()))
+    build();
+
+  std::ofstream file(filename.c_str(), std::ofstream::binary);
+  if (! file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot create the descriptor index file %s", filename.c_str());
+  }
+
+  unsigned int header[7] = { vp_index_version, vp_index_byte_order, m_nbTables, m_keySize, m_multiProbeLevel,
+                             m_descriptorSize, m_size };
+  file.write(vp_index_magic, sizeof(vp_index_magic));
+  file.write(reinterpret_cast<const char *>(header), sizeof(header));
+  writeArray(file, m_keyBits);
+  writeArray(file, m_offsets);
+  writeArray(file, m_buckets);
+  writeArray(file, m_descriptors);
+  if (! file) {
+    throw vpException(vpException::ioError, "Cannot write the descriptor index file %s", filename.c_str());
+  }
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Sort the descriptor indexes by key in each table with a counting sort
+void vpBinaryDescriptorIndex::build()
+{
+  const unsigned int nbKeys = 1u << m_keySize;
+  m_offsets.assign((size_t)m_nbTables * (nbKeys + 1), 0);
+  m_buckets.resize((size_t)m_nbTables * m_size);
+
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int t = 0; t < (int)m_nbTables; t++) {
+    unsigned int *offsets = &m_offsets[(size_t)t * (nbKeys + 1)];
+    unsigned int *buckets = &m_buckets[(size_t)t * m_size];
+    std::vector<unsigned int> keys(m_size);
+    for (unsigned int i = 0; i < m_size; i++) {
+      keys[i] = computeKey(getDescriptor(i), (unsigned int)t);
+      offsets[keys[i] + 1]++;
+    }
+    for (unsigned int key = 0; key < nbKeys; key++)
+      offsets[key + 1] += offsets[key];
+
+    std::vector<unsigned int> next(offsets, offsets + nbKeys);
+    for (unsigned int i = 0; i < m_size; i++)
+      buckets[next[keys[i]]++] = i;
+  }
+  m_dirty = false;
+}
+
+unsigned int vpBinaryDescriptorIndex::computeKey(const unsigned char *descriptor, unsigned int table) const
+{
+  const unsigned int *bits = &m_keyBits[(size_t)table * m_keySize];
+  unsigned int key = 0;
+  for (unsigned int b = 0; b < m_keySize; b++)
+    key |= (unsigned int)((descriptor[bits[b] >> 3] >> (bits[b] & 7)) & 1) << b;
+  return key;
+}
+
+// Draw for each table keySize distinct bits of the descriptors. The seed is
+// fixed so that indexes built from the same descriptors are identical. A
+// local generator is used since vpUniRand shares its shuffle table between
+// instances.
+void vpBinaryDescriptorIndex::initKeyBits()
+{
+  const unsigned int nbBits = m_descriptorSize * 8;
+  uint32_t state = 17;
+  std::vector<unsigned int> bits(nbBits);
+  m_keyBits.resize((size_t)m_nbTables * m_keySize);
+  for (unsigned int t = 0; t < m_nbTables; t++) {
+    for (unsigned int i = 0; i < nbBits; i++)
+      bits[i] = i;
+    for (unsigned int b = 0; b < m_keySize; b++) {
+      unsigned int r = b + nextRandom(state) % (nbBits - b);
+      std::swap(bits[b], bits[r]);
+      m_keyBits[(size_t)t * m_keySize + b] = bits[b];
+    }
+  }
+}
+
+void vpBinaryDescriptorIndex::searchExhaustive(const unsigned char *query, unsigned int k,
+                                               std::vector<vpMatch> &best) const
+{
+  for (unsigned int i = 0; i < m_size; i++)
+    insertMatch(best, k, i, hammingDistance(query, getDescriptor(i), m_descriptorSize));
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
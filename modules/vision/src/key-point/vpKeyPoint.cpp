@@ -38,9 +38,11 @@
 #include <limits>
 #include <iomanip>
 #include <stdint.h> //uint32_t ; works also with >= VS2010 / _MSC_VER >= 1600
+#include <string.h> //memcpy
 
 #include <visp3/vision/vpKeyPoint.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMemoryMappedFile.h>
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
 
@@ -321,6 +323,125 @@ namespace {
     file.write((char *)(&double_value), sizeof(double_value));
   #endif
   }
+
+  //Memory-mappable learning data format: a header followed by sections starting at offsets multiple of
+  //vp_learning_data_alignment, all values being stored in little endian.
+  const char vp_learning_data_magic[8] = { 'V', 'P', 'K', 'P', 'D', 'A', 'T', 'A' };
+  const uint32_t vp_learning_data_version = 1;
+  const size_t vp_learning_data_alignment = 16;
+
+  struct vpLearningDataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nbImages;
+    uint32_t have3DInfo;
+    int32_t nbDescriptors;
+    int32_t descriptorSize;
+    int32_t descriptorType;
+    uint64_t imagesOffset;      //For each training image: image id, path length, path
+    uint64_t keyPointsOffset;   //Array of vpLearningDataKeyPoint
+    uint64_t pointsOffset;      //Array of 3D points (oX, oY, oZ) if have3DInfo
+    uint64_t descriptorsOffset; //Descriptors stored row by row
+    uint64_t fileSize;
+    uint64_t checksum;          //Checksum of the header, with a null checksum, and of the image paths
+  };
+
+  struct vpLearningDataKeyPoint {
+    float u, v, size, angle, response;
+    int32_t octave, class_id, image_id;
+  };
+
+  size_t alignLearningDataOffset(const size_t offset) {
+    return (offset + vp_learning_data_alignment - 1) / vp_learning_data_alignment * vp_learning_data_alignment;
+  }
+
+  //True if count elements of elemSize bytes starting at offset are inside a file of fileSize bytes. The sizes are
+  //compared to the remaining bytes so that corrupted values cannot overflow.
+  bool isLearningDataArrayInFile(const uint64_t offset, const uint64_t count, const uint64_t elemSize,
+                                 const uint64_t fileSize) {
+    return offset <= fileSize && (elemSize == 0 || count <= (fileSize - offset) / elemSize);
+  }
+
+  //64 bits FNV-1a like checksum computed on four interleaved streams of 64 bits words
+  uint64_t learningDataChecksum(const unsigned char *data, const size_t size) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t h[4] = { 14695981039346656037ULL, 14695981039346656037ULL ^ 1, 14695981039346656037ULL ^ 2,
+                      14695981039346656037ULL ^ 3 };
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+      for(size_t l = 0; l < 4; l++) {
+        uint64_t word;
+        memcpy(&word, data + i + 8*l, sizeof(word));
+        h[l] = (h[l] ^ word) * prime;
+        h[l] ^= h[l] >> 32;
+      }
+    }
+
+    uint64_t hash = h[0];
+    for(size_t l = 1; l < 4; l++) {
+      hash = (hash ^ h[l]) * prime;
+    }
+    for(; i < size; i++) {
+      hash = (hash ^ data[i]) * prime;
+    }
+    return (hash ^ (uint64_t) size) * prime;
+  }
+
+  //Core area of the tile (row, col) of a grid of nbRows x nbCols tiles covering an image
+  cv::Rect getTile(const cv::Size &size, const unsigned int nbRows, const unsigned int nbCols,
+                   const unsigned int row, const unsigned int col) {
+    int x0 = (int) ((size_t) size.width * col / nbCols), x1 = (int) ((size_t) size.width * (col + 1) / nbCols);
+    int y0 = (int) ((size_t) size.height * row / nbRows), y1 = (int) ((size_t) size.height * (row + 1) / nbRows);
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+  }
+
+  //Index of the tile containing a coordinate along an image dimension of the given length split in nbTiles tiles
+  unsigned int getTileIndex(const float coord, const int length, const unsigned int nbTiles) {
+    if(coord <= 0.f) {
+      return 0;
+    }
+    unsigned int index = std::min<unsigned int>((unsigned int) (coord * nbTiles / length), nbTiles - 1);
+    while(index > 0 && coord < (float) ((size_t) length * index / nbTiles)) {
+      index--;
+    }
+    while(index + 1 < nbTiles && coord >= (float) ((size_t) length * (index + 1) / nbTiles)) {
+      index++;
+    }
+    return index;
+  }
+
+  //Tile extended by the overlap and clipped to the image
+  cv::Rect expandTile(const cv::Rect &tile, const int overlap, const cv::Size &size) {
+    int x0 = std::max(tile.x - overlap, 0), y0 = std::max(tile.y - overlap, 0);
+    int x1 = std::min(tile.x + tile.width + overlap, size.width), y1 = std::min(tile.y + tile.height + overlap, size.height);
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+  }
+
+  //Order keypoints by decreasing response, and by position for equal responses, to select the best keypoints of a
+  //tile deterministically
+  bool compareKeyPointResponse(const cv::KeyPoint &kp1, const cv::KeyPoint &kp2) {
+    if(kp1.response != kp2.response) {
+      return kp1.response > kp2.response;
+    }
+    if(kp1.pt.y != kp2.pt.y) {
+      return kp1.pt.y < kp2.pt.y;
+    }
+    if(kp1.pt.x != kp2.pt.x) {
+      return kp1.pt.x < kp2.pt.x;
+    }
+    if(kp1.octave != kp2.octave) {
+      return kp1.octave < kp2.octave;
+    }
+    return kp1.size < kp2.size;
+  }
+
+  //Check if a learning data file is in the memory-mappable format
+  bool isMappedLearningDataFile(const std::string &filename) {
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    char magic[sizeof(vp_learning_data_magic)];
+    file.read(magic, sizeof(magic));
+    return file && memcmp(magic, vp_learning_data_magic, sizeof(magic)) == 0;
+  }
 }
 
 /*!
@@ -334,20 +455,22 @@ namespace {
 vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatureDescriptorType &descriptorType,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
-    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
+    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_descriptorIndex(), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImagePaths(),
+    m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
-    m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
+    m_matchRansacKeyPointsToPoints(), m_maxKeyPointsPerTile(0), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100),
+    m_nbTileCols(1), m_nbTileRows(1), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
-    m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
+    m_ransacThreshold(0.01), m_tileOverlap(64), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -369,20 +492,22 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
 vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extractorName,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
-    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
+    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_descriptorIndex(), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImagePaths(),
+    m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
-    m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
+    m_matchRansacKeyPointsToPoints(), m_maxKeyPointsPerTile(0), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100),
+    m_nbTileCols(1), m_nbTileRows(1), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
-    m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
+    m_ransacThreshold(0.01), m_tileOverlap(64), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -404,20 +529,22 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
 vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std::vector<std::string> &extractorNames,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
-    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(detectorNames),
+    m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_descriptorIndex(), m_detectorNames(detectorNames),
     m_detectors(), m_extractionTime(0.), m_extractorNames(extractorNames), m_extractors(), m_filteredMatches(),
-    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(),
+    m_mapOfImagePaths(), m_mapOfImages(),
     m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
-    m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
+    m_matchRansacKeyPointsToPoints(), m_maxKeyPointsPerTile(0), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100),
+    m_nbTileCols(1), m_nbTileRows(1), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
-    m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
+    m_ransacThreshold(0.01), m_tileOverlap(64), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -521,6 +648,7 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   m_trainPoints.clear();
   m_mapOfImageId.clear();
   m_mapOfImages.clear();
+  m_mapOfImagePaths.clear();
   m_currentImageId = 1;
 
   if(m_useAffineDetection) {
@@ -568,6 +696,7 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateDescriptorIndex(0);
 
   return static_cast<unsigned int>(m_trainKeyPoints.size());
 }
@@ -629,6 +758,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
     m_currentImageId = 0;
     m_mapOfImageId.clear();
     m_mapOfImages.clear();
+    m_mapOfImagePaths.clear();
     this->m_trainKeyPoints.clear();
     this->m_trainPoints.clear();
   }
@@ -669,6 +799,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateDescriptorIndex(append ? m_trainDescriptors.rows - trainDescriptors.rows : 0);
 
   _reference_computed = true;
 }
@@ -1234,6 +1365,8 @@ void vpKeyPoint::createImageMatching(vpImage<unsigned char> &IRef, vpImage<unsig
    \param IMatching : Image initialized with appropriate size.
  */
 void vpKeyPoint::createImageMatching(vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching) {
+  loadTrainingImages();
+
   //Nb images in the training database + the current image we want to detect the object
   unsigned int nbImg = (unsigned int) (m_mapOfImages.size() + 1);
 
@@ -1338,6 +1471,12 @@ void vpKeyPoint::detect(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoi
   double t = vpTime::measureTimeMs();
   keyPoints.clear();
 
+  if(m_nbTileRows * m_nbTileCols > 1) {
+    detectTiled(matImg, keyPoints, mask);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin(); it != m_detectors.end(); ++it) {
     std::vector<cv::KeyPoint> kp;
     it->second->detect(matImg, kp, mask);
@@ -1347,6 +1486,67 @@ void vpKeyPoint::detect(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoi
   elapsedTime = vpTime::measureTimeMs() - t;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+   Detect keypoints in parallel in the tiles of the image, keeping at most m_maxKeyPointsPerTile keypoints of highest
+   response per tile. Each tile is processed with its neighborhood of m_tileOverlap pixels, and only the keypoints
+   located in the tile itself are kept, so that a keypoint is never detected twice.
+ */
+void vpKeyPoint::detectTiled(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoints, const cv::Mat &mask) {
+  const cv::Size size(matImg.cols, matImg.rows);
+  const int nbTiles = (int) (m_nbTileRows * m_nbTileCols);
+  std::vector<std::vector<cv::KeyPoint> > listOfTileKeyPoints((size_t) nbTiles);
+
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < nbTiles; i++) {
+    cv::Rect tile = getTile(size, m_nbTileRows, m_nbTileCols, (unsigned int) i / m_nbTileCols, (unsigned int) i % m_nbTileCols);
+    if(tile.width <= 0 || tile.height <= 0 || (!mask.empty() && cv::countNonZero(mask(tile)) == 0)) {
+      continue;
+    }
+    cv::Rect roi = expandTile(tile, (int) m_tileOverlap, size);
+    cv::Mat roiImg = matImg(roi);
+    cv::Mat roiMask;
+    if(!mask.empty()) {
+      roiMask = mask(roi);
+    }
+
+    std::vector<cv::KeyPoint> &tileKeyPoints = listOfTileKeyPoints[(size_t) i];
+    for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin(); it != m_detectors.end(); ++it) {
+      std::vector<cv::KeyPoint> kp;
+      it->second->detect(roiImg, kp, roiMask);
+
+      for(std::vector<cv::KeyPoint>::iterator itKp = kp.begin(); itKp != kp.end(); ++itKp) {
+        itKp->pt.x += (float) roi.x;
+        itKp->pt.y += (float) roi.y;
+        //Keep only the keypoints of the tile, the others belong to the neighbor tiles
+        if(itKp->pt.x >= (float) tile.x && itKp->pt.x < (float) (tile.x + tile.width) && itKp->pt.y >= (float) tile.y
+           && itKp->pt.y < (float) (tile.y + tile.height)) {
+          tileKeyPoints.push_back(*itKp);
+        }
+      }
+    }
+
+    if(m_maxKeyPointsPerTile > 0 && tileKeyPoints.size() > m_maxKeyPointsPerTile) {
+      std::partial_sort(tileKeyPoints.begin(), tileKeyPoints.begin() + m_maxKeyPointsPerTile, tileKeyPoints.end(),
+                        compareKeyPointResponse);
+      tileKeyPoints.resize(m_maxKeyPointsPerTile);
+    }
+  }
+
+  //Merge in the tile order so that the result does not depend on the thread scheduling
+  size_t nbKeyPoints = 0;
+  for(size_t i = 0; i < listOfTileKeyPoints.size(); i++) {
+    nbKeyPoints += listOfTileKeyPoints[i].size();
+  }
+  keyPoints.reserve(nbKeyPoints);
+  for(size_t i = 0; i < listOfTileKeyPoints.size(); i++) {
+    keyPoints.insert(keyPoints.end(), listOfTileKeyPoints[i].begin(), listOfTileKeyPoints[i].end());
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
    Display the reference and the detected keypoints in the images.
 
@@ -1430,6 +1630,8 @@ void vpKeyPoint::displayMatching(const vpImage<unsigned char> &IRef, vpImage<uns
  */
 void vpKeyPoint::displayMatching(const vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching,
                                  const std::vector<vpImagePoint> &ransacInliers, unsigned int crossSize, unsigned int lineThickness) {
+  loadTrainingImages();
+
   if(m_mapOfImages.empty() || m_mapOfImageId.empty()) {
     //No training images so return
     std::cerr << "There is no training image loaded !" << std::endl;
@@ -1594,6 +1796,12 @@ void vpKeyPoint::extract(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPo
   double t = vpTime::measureTimeMs();
   bool first = true;
 
+  if(m_nbTileRows * m_nbTileCols > 1 && m_extractors.size() == 1) {
+    extractTiled(matImg, keyPoints, descriptors, trainPoints);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   for(std::map<std::string, cv::Ptr<cv::DescriptorExtractor> >::const_iterator itd = m_extractors.begin();
       itd != m_extractors.end(); ++itd) {
     if(first) {
@@ -1683,6 +1891,85 @@ void vpKeyPoint::extract(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPo
   elapsedTime = vpTime::measureTimeMs() - t;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+   Extract in parallel the descriptors of the keypoints of each tile of the image, with the single extractor. The
+   keypoints are sorted by tile, and the keypoints whose descriptor cannot be computed are removed.
+ */
+void vpKeyPoint::extractTiled(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors,
+                              std::vector<cv::Point3f> *trainPoints) {
+  const cv::Size size(matImg.cols, matImg.rows);
+  const int nbTiles = (int) (m_nbTileRows * m_nbTileCols);
+  const cv::Ptr<cv::DescriptorExtractor> &extractor = m_extractors.begin()->second;
+  const bool have3DInfo = trainPoints != NULL && !trainPoints->empty();
+
+  //Store the hash of a keypoint as the key and the index of the keypoint as the value, to retrieve the 3D points
+  std::map<size_t, size_t> mapOfKeypointHashes;
+  if(have3DInfo) {
+    for(size_t i = 0; i < keyPoints.size(); i++) {
+      mapOfKeypointHashes[myKeypointHash(keyPoints[i])] = i;
+    }
+  }
+
+  std::vector<std::vector<cv::KeyPoint> > listOfTileKeyPoints((size_t) nbTiles);
+  for(std::vector<cv::KeyPoint>::const_iterator it = keyPoints.begin(); it != keyPoints.end(); ++it) {
+    unsigned int row = getTileIndex(it->pt.y, size.height, m_nbTileRows);
+    unsigned int col = getTileIndex(it->pt.x, size.width, m_nbTileCols);
+    listOfTileKeyPoints[(size_t) (row * m_nbTileCols + col)].push_back(*it);
+  }
+  std::vector<cv::Mat> listOfTileDescriptors((size_t) nbTiles);
+
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < nbTiles; i++) {
+    std::vector<cv::KeyPoint> &tileKeyPoints = listOfTileKeyPoints[(size_t) i];
+    if(tileKeyPoints.empty()) {
+      continue;
+    }
+    cv::Rect tile = getTile(size, m_nbTileRows, m_nbTileCols, (unsigned int) i / m_nbTileCols, (unsigned int) i % m_nbTileCols);
+    cv::Rect roi = expandTile(tile, (int) m_tileOverlap, size);
+
+    for(std::vector<cv::KeyPoint>::iterator it = tileKeyPoints.begin(); it != tileKeyPoints.end(); ++it) {
+      it->pt.x -= (float) roi.x;
+      it->pt.y -= (float) roi.y;
+    }
+    extractor->compute(matImg(roi), tileKeyPoints, listOfTileDescriptors[(size_t) i]);
+    for(std::vector<cv::KeyPoint>::iterator it = tileKeyPoints.begin(); it != tileKeyPoints.end(); ++it) {
+      it->pt.x += (float) roi.x;
+      it->pt.y += (float) roi.y;
+    }
+  }
+
+  //Merge in the tile order so that the result does not depend on the thread scheduling
+  keyPoints.clear();
+  std::vector<cv::Mat> listOfDescriptors;
+  for(size_t i = 0; i < listOfTileKeyPoints.size(); i++) {
+    if(!listOfTileKeyPoints[i].empty() && !listOfTileDescriptors[i].empty()) {
+      keyPoints.insert(keyPoints.end(), listOfTileKeyPoints[i].begin(), listOfTileKeyPoints[i].end());
+      listOfDescriptors.push_back(listOfTileDescriptors[i]);
+    }
+  }
+  if(listOfDescriptors.empty()) {
+    descriptors = cv::Mat();
+  } else {
+    cv::vconcat(&listOfDescriptors[0], listOfDescriptors.size(), descriptors);
+  }
+
+  if(have3DInfo) {
+    std::vector<cv::Point3f> trainPoints_tmp;
+    trainPoints_tmp.reserve(keyPoints.size());
+    for(std::vector<cv::KeyPoint>::const_iterator it = keyPoints.begin(); it != keyPoints.end(); ++it) {
+      std::map<size_t, size_t>::const_iterator it_hash = mapOfKeypointHashes.find(myKeypointHash(*it));
+      if(it_hash != mapOfKeypointHashes.end()) {
+        trainPoints_tmp.push_back((*trainPoints)[it_hash->second]);
+      }
+    }
+    *trainPoints = trainPoints_tmp;
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
    Filter the matches using the desired filtering method.
  */
@@ -1783,15 +2070,20 @@ void vpKeyPoint::filterMatches() {
     std::vector<cv::Point3f> trainPtsTmp;
     std::vector<cv::KeyPoint> queryKptsTmp;
 
-    std::map<int, int> mapOfTrainIdx;
     //Count the number of query points matched to the same train point
+    std::vector<int> nbMatchesPerTrainIdx((size_t) m_trainDescriptors.rows, 0);
     for(std::vector<cv::DMatch>::const_iterator it = m.begin(); it != m.end(); ++it) {
-      mapOfTrainIdx[it->trainIdx]++;
+      if((size_t) it->trainIdx >= nbMatchesPerTrainIdx.size()) {
+        nbMatchesPerTrainIdx.resize((size_t) it->trainIdx + 1, 0);
+      }
+      nbMatchesPerTrainIdx[(size_t) it->trainIdx]++;
     }
 
     //Keep matches with only one correspondence
+    mTmp.reserve(m.size());
+    queryKptsTmp.reserve(m.size());
     for(std::vector<cv::DMatch>::const_iterator it = m.begin(); it != m.end(); ++it) {
-      if(mapOfTrainIdx[it->trainIdx] == 1) {
+      if(nbMatchesPerTrainIdx[(size_t) it->trainIdx] == 1) {
         mTmp.push_back(cv::DMatch((int) queryKptsTmp.size(), it->trainIdx, it->distance));
 
         if(!m_trainPoints.empty()) {
@@ -1801,13 +2093,13 @@ void vpKeyPoint::filterMatches() {
       }
     }
 
-    m_filteredMatches = mTmp;
-    m_objectFilteredPoints = trainPtsTmp;
-    m_queryFilteredKeyPoints = queryKptsTmp;
+    m_filteredMatches.swap(mTmp);
+    m_objectFilteredPoints.swap(trainPtsTmp);
+    m_queryFilteredKeyPoints.swap(queryKptsTmp);
   } else {
-    m_filteredMatches = m;
-    m_objectFilteredPoints = trainPts;
-    m_queryFilteredKeyPoints = queryKpts;
+    m_filteredMatches.swap(m);
+    m_objectFilteredPoints.swap(trainPts);
+    m_queryFilteredKeyPoints.swap(queryKpts);
   }
 }
 
@@ -2393,6 +2685,8 @@ void vpKeyPoint::insertImageMatching(const vpImage<unsigned char> &IRef, const v
    detected in the training images
  */
 void vpKeyPoint::insertImageMatching(const vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching) {
+  loadTrainingImages();
+
   //Nb images in the training database + the current image we want to detect the object
   int nbImg = (int) (m_mapOfImages.size() + 1);
 
@@ -2525,6 +2819,15 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 /*!
    Load learning data saved on disk.
 
+   In binary mode, both the little endian binary format and the memory-mappable format written by
+   saveLearningData() are supported. A file in the memory-mappable format is mapped in memory: its header and its
+   training image paths are checked with a checksum, the sizes of its arrays are checked against the file size,
+   and the train descriptors are used in place without being copied. In all modes, the training images are only
+   read when they are needed, for instance by createImageMatching() or insertImageMatching().
+
+   When the descriptor index is enabled (see setUseDescriptorIndex()) and an index file \e filename.index
+   saved by saveLearningData() exists, the index is loaded from this file instead of being built.
+
    \param filename : Path of the learning file.
    \param binaryMode : If true, the learning file is in a binary mode, otherwise it is in XML mode.
    \param append : If true, concatenate the learning data, otherwise reset the variables.
@@ -2532,11 +2835,13 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 void vpKeyPoint::loadLearningData(const std::string &filename, const bool binaryMode, const bool append) {
   int startClassId = 0;
   int startImageId = 0;
+  int startDescriptorRow = append ? m_trainDescriptors.rows : 0;
   if(!append) {
     m_trainKeyPoints.clear();
     m_trainPoints.clear();
     m_mapOfImageId.clear();
     m_mapOfImages.clear();
+    m_mapOfImagePaths.clear();
   } else {
     //In append case, find the max index of keypoint class Id
     for(std::map<int, int>::const_iterator it = m_mapOfImageId.begin(); it != m_mapOfImageId.end(); ++it) {
@@ -2551,6 +2856,11 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
         startImageId = it->first;
       }
     }
+    for(std::map<int, std::string>::const_iterator it = m_mapOfImagePaths.begin(); it != m_mapOfImagePaths.end(); ++it) {
+      if(startImageId < it->first) {
+        startImageId = it->first;
+      }
+    }
   }
 
   //Get parent directory
@@ -2559,7 +2869,9 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     parent += "/";
   }
 
-  if(binaryMode) {
+  if(binaryMode && isMappedLearningDataFile(filename)) {
+    loadMappedLearningData(filename, parent, append, startClassId, startImageId);
+  } else if(binaryMode) {
     std::ifstream file(filename.c_str(), std::ifstream::binary);
     if(!file.is_open()){
       throw vpException(vpException::ioError, "Cannot open the file.");
@@ -2596,16 +2908,13 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
       }
       path[length] = '\0';
 
-      vpImage<unsigned char> I;
 #ifdef VISP_HAVE_MODULE_IO
+      //The image is only read when needed, and only if VISP_HAVE_MODULE_IO
       if(vpIoTools::isAbsolutePathname(std::string(path))) {
-        vpImageIo::read(I, path);
+        m_mapOfImagePaths[id + startImageId] = path;
       } else {
-        vpImageIo::read(I, parent + path);
+        m_mapOfImagePaths[id + startImageId] = parent + path;
       }
-
-      //Add the image previously loaded only if VISP_HAVE_MODULE_IO
-      m_mapOfImages[id + startImageId] = I;
 #endif
 
       //Delete path
@@ -2809,18 +3118,14 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
             }
             xmlFree(image_id_property);
 
-            vpImage<unsigned char> I;
 #ifdef VISP_HAVE_MODULE_IO
             std::string path((char *) image_info_node->children->content);
-            //Read path to the training images
+            //Path to the training images, read only when needed and only if VISP_HAVE_MODULE_IO
             if(vpIoTools::isAbsolutePathname(std::string(path))) {
-              vpImageIo::read(I, path);
+              m_mapOfImagePaths[id + startImageId] = path;
             } else {
-              vpImageIo::read(I, parent + path);
+              m_mapOfImagePaths[id + startImageId] = parent + path;
             }
-
-            //Add the image previously loaded only if VISP_HAVE_MODULE_IO
-            m_mapOfImages[id + startImageId] = I;
 #endif
           }
         }
@@ -2985,10 +3290,161 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
 
+  std::string indexFilename = filename + ".index";
+  if(m_useDescriptorIndex && !append && vpIoTools::checkFilename(indexFilename)) {
+    //Load the index saved with the learning data instead of building it
+    m_descriptorIndex.load(indexFilename);
+    if(m_descriptorIndex.size() != (unsigned int) m_trainDescriptors.rows
+       || m_descriptorIndex.getDescriptorSize() != (unsigned int) m_trainDescriptors.cols) {
+      std::cerr << "The descriptor index " << indexFilename << " does not match the learning data" << std::endl;
+      m_descriptorIndex.clear();
+      updateDescriptorIndex(0);
+    }
+  } else {
+    updateDescriptorIndex(startDescriptorRow);
+  }
+
   //Set _reference_computed to true as we load learning file
   _reference_computed = true;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+   Load learning data saved in the memory-mappable binary format. The file stays mapped in memory and the train
+   descriptors point directly in the file mapping when they are not appended to other descriptors.
+ */
+void vpKeyPoint::loadMappedLearningData(const std::string &filename, const std::string &parent, const bool append,
+                                        const int startClassId, const int startImageId) {
+#ifdef VISP_LITTLE_ENDIAN
+  cv::Ptr<vpMemoryMappedFile> mappedFile = cv::Ptr<vpMemoryMappedFile>(new vpMemoryMappedFile(filename));
+  const unsigned char *data = mappedFile->getData();
+  const size_t fileSize = mappedFile->getSize();
+
+  vpLearningDataHeader header;
+  if(fileSize < sizeof(header)) {
+    throw vpException(vpException::ioError, "Truncated learning data file %s", filename.c_str());
+  }
+  memcpy(&header, data, sizeof(header));
+
+  if(header.version != vp_learning_data_version) {
+    throw vpException(vpException::ioError, "Unsupported version %u of learning data file %s", header.version,
+                      filename.c_str());
+  }
+
+  const int descriptorDepth = CV_MAT_DEPTH(header.descriptorType);
+  if(header.nbDescriptors < 0 || header.descriptorSize < 0 || descriptorDepth > CV_64F
+     || CV_MAT_CN(header.descriptorType) != 1 || header.fileSize != fileSize) {
+    throw vpException(vpException::ioError, "Corrupted learning data file %s", filename.c_str());
+  }
+  const uint64_t nbDescriptors = (uint64_t) header.nbDescriptors;
+  const uint64_t rowSize = (uint64_t) header.descriptorSize * (uint64_t) CV_ELEM_SIZE(header.descriptorType);
+  if(header.imagesOffset < sizeof(header) || header.keyPointsOffset < header.imagesOffset
+     || header.keyPointsOffset % vp_learning_data_alignment != 0
+     || !isLearningDataArrayInFile(header.keyPointsOffset, nbDescriptors, sizeof(vpLearningDataKeyPoint), fileSize)
+     || header.pointsOffset % vp_learning_data_alignment != 0
+     || !isLearningDataArrayInFile(header.pointsOffset, header.have3DInfo ? nbDescriptors : 0, sizeof(cv::Point3f),
+                                   fileSize)
+     || header.descriptorsOffset % vp_learning_data_alignment != 0
+     || !isLearningDataArrayInFile(header.descriptorsOffset, nbDescriptors, rowSize, fileSize)) {
+    throw vpException(vpException::ioError, "Corrupted learning data file %s", filename.c_str());
+  }
+
+  //The checksum covers the header, with a null checksum, and the image paths stored before the keypoints. The
+  //arrays are not read here, they are used in place.
+  std::vector<unsigned char> checkedData(data, data + (size_t) header.keyPointsOffset);
+  vpLearningDataHeader checkedHeader = header;
+  checkedHeader.checksum = 0;
+  memcpy(&checkedData[0], &checkedHeader, sizeof(checkedHeader));
+  if(learningDataChecksum(&checkedData[0], checkedData.size()) != header.checksum) {
+    throw vpException(vpException::ioError, "Bad checksum of learning data file %s", filename.c_str());
+  }
+
+  //Paths of the training images, which are read when they are needed
+  const size_t imagesEnd = (size_t) header.keyPointsOffset;
+  size_t offset = (size_t) header.imagesOffset;
+  for(uint32_t i = 0; i < header.nbImages; i++) {
+    int32_t id;
+    uint32_t length;
+    if(imagesEnd - offset < sizeof(id) + sizeof(length)) {
+      throw vpException(vpException::ioError, "Corrupted learning data file %s", filename.c_str());
+    }
+    memcpy(&id, data + offset, sizeof(id));
+    memcpy(&length, data + offset + sizeof(id), sizeof(length));
+    offset += sizeof(id) + sizeof(length);
+    if(length > imagesEnd - offset) {
+      throw vpException(vpException::ioError, "Corrupted learning data file %s", filename.c_str());
+    }
+    std::string path(reinterpret_cast<const char *>(data + offset), length);
+    offset += length;
+
+#ifdef VISP_HAVE_MODULE_IO
+    m_mapOfImagePaths[id + startImageId] = vpIoTools::isAbsolutePathname(path) ? path : parent + path;
+#else
+    (void)parent;
+#endif
+  }
+
+#if !defined(VISP_HAVE_MODULE_IO)
+  if(header.nbImages > 0) {
+    std::cout << "Warning: The learning file contains image data that will not be loaded as visp_io module "
+        "is not available !" << std::endl;
+  }
+#endif
+
+  //Keypoints and 3D points
+  const vpLearningDataKeyPoint *keyPoints = reinterpret_cast<const vpLearningDataKeyPoint *>(data + header.keyPointsOffset);
+  m_trainKeyPoints.reserve(m_trainKeyPoints.size() + (size_t) nbDescriptors);
+  for(size_t i = 0; i < (size_t) nbDescriptors; i++) {
+    const vpLearningDataKeyPoint &kp = keyPoints[i];
+    m_trainKeyPoints.push_back(cv::KeyPoint(cv::Point2f(kp.u, kp.v), kp.size, kp.angle, kp.response, kp.octave,
+                                            kp.class_id + startClassId));
+
+    if(kp.image_id != -1) {
+#ifdef VISP_HAVE_MODULE_IO
+      //No training images if image_id == -1
+      m_mapOfImageId[kp.class_id] = kp.image_id + startImageId;
+#endif
+    }
+  }
+
+  if(header.have3DInfo) {
+    const cv::Point3f *points = reinterpret_cast<const cv::Point3f *>(data + header.pointsOffset);
+    m_trainPoints.insert(m_trainPoints.end(), points, points + (size_t) nbDescriptors);
+  }
+
+  //Descriptors used in place. The mapping is private: a modification of the descriptors is not written in the file.
+  cv::Mat trainDescriptorsTmp;
+  if(nbDescriptors > 0) {
+    trainDescriptorsTmp = cv::Mat(header.nbDescriptors, header.descriptorSize, header.descriptorType,
+                                  mappedFile->getData() + header.descriptorsOffset);
+  }
+
+  if(!append || m_trainDescriptors.empty()) {
+    m_trainDescriptors = trainDescriptorsTmp;
+    m_learningDataFile = mappedFile;
+  } else {
+    cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
+  }
+#else
+  (void)parent; (void)append; (void)startClassId; (void)startImageId;
+  throw vpException(vpException::ioError, "The format of learning data file %s is not supported on big endian hosts",
+                    filename.c_str());
+#endif
+}
+
+/*
+   Read the training images whose path has been loaded with the learning data.
+ */
+void vpKeyPoint::loadTrainingImages() {
+#ifdef VISP_HAVE_MODULE_IO
+  for(std::map<int, std::string>::const_iterator it = m_mapOfImagePaths.begin(); it != m_mapOfImagePaths.end(); ++it) {
+    vpImageIo::read(m_mapOfImages[it->first], it->second);
+  }
+#endif
+  m_mapOfImagePaths.clear();
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
    Match keypoints based on distance between their descriptors.
 
@@ -3001,6 +3457,33 @@ void vpKeyPoint::match(const cv::Mat &trainDescriptors, const cv::Mat &queryDesc
                        std::vector<cv::DMatch> &matches, double &elapsedTime) {
   double t = vpTime::measureTimeMs();
 
+  if(m_useDescriptorIndex && !m_useMatchTrainToQuery && queryDescriptors.type() == CV_8U
+     && trainDescriptors.rows == (int) m_descriptorIndex.size() && m_descriptorIndex.size() > 0
+     && queryDescriptors.cols == (int) m_descriptorIndex.getDescriptorSize()) {
+    //Match query descriptors to the binary descriptor index
+    cv::Mat queryDescriptorsCont = queryDescriptors.isContinuous() ? queryDescriptors : queryDescriptors.clone();
+    std::vector<std::vector<vpBinaryDescriptorIndex::vpMatch> > indexMatches;
+    m_descriptorIndex.knnMatch(queryDescriptorsCont.ptr<unsigned char>(0), (unsigned int) queryDescriptorsCont.rows,
+                               m_useKnn ? 2 : 1, indexMatches);
+
+    m_knnMatches.resize(indexMatches.size());
+    for(size_t i = 0; i < indexMatches.size(); i++) {
+      m_knnMatches[i].resize(indexMatches[i].size());
+      for(size_t j = 0; j < indexMatches[i].size(); j++) {
+        m_knnMatches[i][j] = cv::DMatch((int) indexMatches[i][j].queryIdx, (int) indexMatches[i][j].trainIdx,
+                                        (float) indexMatches[i][j].distance);
+      }
+    }
+    matches.resize(m_knnMatches.size());
+    std::transform(m_knnMatches.begin(), m_knnMatches.end(), matches.begin(), knnToDMatch);
+    if(!m_useKnn) {
+      m_knnMatches.clear();
+    }
+
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   if(m_useKnn) {
     m_knnMatches.clear();
 
@@ -3697,22 +4180,25 @@ void vpKeyPoint::reset() {
 
 
   m_computeCovariance = false; m_covarianceMatrix = vpMatrix(); m_currentImageId = 0; m_detectionMethod = detectionScore;
-  m_detectionScore = 0.15; m_detectionThreshold = 100.0; m_detectionTime = 0.0; m_detectorNames.clear();
+  m_detectionScore = 0.15; m_detectionThreshold = 100.0; m_detectionTime = 0.0; m_descriptorIndex.clear();
+  m_detectorNames.clear();
   m_detectors.clear(); m_extractionTime = 0.0; m_extractorNames.clear(); m_extractors.clear(); m_filteredMatches.clear();
   m_filterType = ratioDistanceThreshold;
   m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_mapOfImageId.clear(); m_mapOfImages.clear();
+  m_mapOfImagePaths.clear(); m_learningDataFile = cv::Ptr<vpMemoryMappedFile>();
   m_matcher = cv::Ptr<cv::DescriptorMatcher>(); m_matcherName = "BruteForce-Hamming";
   m_matches.clear(); m_matchingFactorThreshold = 2.0; m_matchingRatioThreshold = 0.85; m_matchingTime = 0.0;
-  m_matchRansacKeyPointsToPoints.clear(); m_nbRansacIterations = 200; m_nbRansacMinInlierCount = 100;
+  m_matchRansacKeyPointsToPoints.clear(); m_maxKeyPointsPerTile = 0; m_nbRansacIterations = 200;
+  m_nbRansacMinInlierCount = 100; m_nbTileCols = 1; m_nbTileRows = 1;
   m_objectFilteredPoints.clear();
   m_poseTime = 0.0; m_queryDescriptors = cv::Mat(); m_queryFilteredKeyPoints.clear(); m_queryKeyPoints.clear();
   m_ransacConsensusPercentage = 20.0; m_ransacInliers.clear(); m_ransacOutliers.clear(); m_ransacReprojectionError = 6.0;
-  m_ransacThreshold = 0.01; m_trainDescriptors = cv::Mat(); m_trainKeyPoints.clear(); m_trainPoints.clear();
+  m_ransacThreshold = 0.01; m_tileOverlap = 64; m_trainDescriptors = cv::Mat(); m_trainKeyPoints.clear(); m_trainPoints.clear();
   m_trainVpPoints.clear(); m_useAffineDetection = false;
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   m_useBruteForceCrossCheck = true;
 #endif
-  m_useConsensusPercentage = false;
+  m_useConsensusPercentage = false; m_useDescriptorIndex = false;
   m_useKnn = true; //as m_filterType == ratioDistanceThreshold
   m_useMatchTrainToQuery = false; m_useRansacVVS = true; m_useSingleMatchFilter = true;
 
@@ -3725,11 +4211,22 @@ void vpKeyPoint::reset() {
 /*!
    Save the learning data in a file in XML or binary mode.
 
+   In binary mode and when \e mappedFormat is true, the data is saved in a versioned memory-mappable format: the
+   keypoints, the 3D points and the descriptors are stored as aligned arrays, which loadLearningData() maps in
+   memory instead of reading them. A checksum protects the header and the table of the training image paths.
+   This format is only written on little endian hosts, the little endian binary format being used otherwise.
+   Both binary formats are read by loadLearningData().
+
+   When the descriptor index is enabled (see setUseDescriptorIndex()), the index is also saved in the file
+   \e filename.index, so that loadLearningData() does not have to build it again.
+
    \param filename : Path of the save file
    \param binaryMode : If true, the data are saved in binary mode, otherwise in XML mode
    \param saveTrainingImages : If true, save also the training images on disk
+   \param mappedFormat : If true and in binary mode, the data are saved in the memory-mappable format
  */
-void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages) {
+void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages,
+                                  const bool mappedFormat) {
   std::string parent = vpIoTools::getParent(filename);
   if(!parent.empty()) {
     vpIoTools::makeDirectory(parent);
@@ -3738,6 +4235,8 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
   std::map<int, std::string> mapOfImgPath;
   if(saveTrainingImages) {
 #ifdef VISP_HAVE_MODULE_IO
+    loadTrainingImages();
+
     //Save the training image files in the same directory
     int cpt = 0;
 
@@ -3788,7 +4287,17 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
     throw vpException(vpException::fatalError, "List of keypoints and list of 3D points have different size !");
   }
 
-  if(binaryMode) {
+#ifdef VISP_LITTLE_ENDIAN
+  //The memory-mappable format stores the data in the memory layout of little endian hosts
+  const bool saveMapped = binaryMode && mappedFormat;
+#else
+  const bool saveMapped = false;
+  (void)mappedFormat;
+#endif
+
+  if(saveMapped) {
+    saveMappedLearningData(filename, mapOfImgPath, saveTrainingImages);
+  } else if(binaryMode) {
     //Save the learning data into little endian binary file.
     std::ofstream file(filename.c_str(), std::ofstream::binary);
     if(!file.is_open()) {
@@ -4158,6 +4667,187 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
     std::cerr << "Error: libxml2 is required !" << std::endl;
 #endif
   }
+
+  if(m_useDescriptorIndex && m_descriptorIndex.size() > 0) {
+    m_descriptorIndex.save(filename + ".index");
+  }
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+   Save the learning data in the memory-mappable binary format.
+ */
+void vpKeyPoint::saveMappedLearningData(const std::string &filename, const std::map<int, std::string> &mapOfImgPath,
+                                        const bool saveTrainingImages) {
+  const bool have3DInfo = m_trainPoints.size() > 0;
+  const size_t nbDescriptors = (size_t) m_trainDescriptors.rows;
+  if(m_trainKeyPoints.size() != nbDescriptors) {
+    throw vpException(vpException::fatalError, "List of keypoints and descriptors have different size !");
+  }
+  const size_t rowSize = (size_t) m_trainDescriptors.cols * m_trainDescriptors.elemSize();
+
+  vpLearningDataHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, vp_learning_data_magic, sizeof(header.magic));
+  header.version = vp_learning_data_version;
+  header.nbImages = (uint32_t) mapOfImgPath.size();
+  header.have3DInfo = have3DInfo ? 1 : 0;
+  header.nbDescriptors = m_trainDescriptors.rows;
+  header.descriptorSize = m_trainDescriptors.cols;
+  header.descriptorType = m_trainDescriptors.type();
+
+  size_t imagesSize = 0;
+  for(std::map<int, std::string>::const_iterator it = mapOfImgPath.begin(); it != mapOfImgPath.end(); ++it) {
+    imagesSize += sizeof(int32_t) + sizeof(uint32_t) + it->second.length();
+  }
+  header.imagesOffset = sizeof(header);
+  header.keyPointsOffset = alignLearningDataOffset(sizeof(header) + imagesSize);
+  header.pointsOffset = alignLearningDataOffset(header.keyPointsOffset + nbDescriptors * sizeof(vpLearningDataKeyPoint));
+  header.descriptorsOffset = alignLearningDataOffset(header.pointsOffset
+                                                     + (have3DInfo ? nbDescriptors * sizeof(cv::Point3f) : 0));
+  header.fileSize = header.descriptorsOffset + nbDescriptors * rowSize;
+
+  std::vector<unsigned char> buffer((size_t) header.fileSize, 0);
+
+  size_t offset = (size_t) header.imagesOffset;
+  for(std::map<int, std::string>::const_iterator it = mapOfImgPath.begin(); it != mapOfImgPath.end(); ++it) {
+    int32_t id = it->first;
+    uint32_t length = (uint32_t) it->second.length();
+    memcpy(&buffer[offset], &id, sizeof(id));
+    memcpy(&buffer[offset + sizeof(id)], &length, sizeof(length));
+    offset += sizeof(id) + sizeof(length);
+    if(length > 0) {
+      memcpy(&buffer[offset], it->second.c_str(), length);
+      offset += length;
+    }
+  }
+
+  for(size_t i = 0; i < nbDescriptors; i++) {
+    const cv::KeyPoint &keyPoint = m_trainKeyPoints[i];
+    vpLearningDataKeyPoint kp;
+    kp.u = keyPoint.pt.x;
+    kp.v = keyPoint.pt.y;
+    kp.size = keyPoint.size;
+    kp.angle = keyPoint.angle;
+    kp.response = keyPoint.response;
+    kp.octave = keyPoint.octave;
+    kp.class_id = keyPoint.class_id;
+    kp.image_id = -1;
+#ifdef VISP_HAVE_MODULE_IO
+    std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(keyPoint.class_id);
+    if(saveTrainingImages && it_findImgId != m_mapOfImageId.end()) {
+      kp.image_id = it_findImgId->second;
+    }
+#else
+    (void)saveTrainingImages;
+#endif
+    memcpy(&buffer[(size_t) header.keyPointsOffset + i * sizeof(kp)], &kp, sizeof(kp));
+  }
+
+  if(have3DInfo) {
+    memcpy(&buffer[(size_t) header.pointsOffset], &m_trainPoints[0], nbDescriptors * sizeof(cv::Point3f));
+  }
+
+  for(size_t i = 0; i < nbDescriptors; i++) {
+    memcpy(&buffer[(size_t) header.descriptorsOffset + i * rowSize], m_trainDescriptors.ptr((int) i), rowSize);
+  }
+
+  //The checksum covers the header and the image paths, the arrays are used in place without being read
+  memcpy(&buffer[0], &header, sizeof(header));
+  header.checksum = learningDataChecksum(&buffer[0], (size_t) header.keyPointsOffset);
+  memcpy(&buffer[0], &header, sizeof(header));
+
+  std::ofstream file(filename.c_str(), std::ofstream::binary);
+  if(!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot create the file %s", filename.c_str());
+  }
+  file.write(reinterpret_cast<const char *>(&buffer[0]), (std::streamsize) buffer.size());
+  if(!file) {
+    throw vpException(vpException::ioError, "Cannot write the file %s", filename.c_str());
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+   Set the tiled detection and extraction of the keypoints.
+
+   The image is split in a grid of tiles in which the keypoints are detected and their descriptors extracted in
+   parallel when ViSP is built with OpenMP support. Each tile is processed with its neighborhood, so that a keypoint
+   close to a tile border is detected as in the whole image. The overlap should be at least the border ignored by
+   the detectors and the extractors at their coarser scale (for instance the ORB edge threshold multiplied by the
+   scale of the last pyramid level). The keypoints are merged in the tile order, so that the result does not
+   depend on the thread scheduling.
+
+   Limiting the number of keypoints per tile spreads the keypoints evenly in the image, which makes the pose
+   estimation more stable. Note that the limits of the detectors, like the maximum number of ORB features,
+   apply to each tile.
+
+   \note The descriptors are extracted per tile only when a single extractor is used. The descriptors of keypoints
+   detected at a coarse scale may slightly differ from those extracted on the whole image, as the image pyramid
+   is built on each tile.
+
+   \param nbTileRows : Number of tiles along the image rows.
+   \param nbTileCols : Number of tiles along the image columns. A grid of a single tile disables the tiled mode.
+   \param maxKeyPointsPerTile : Maximum number of keypoints of highest response kept in each tile, 0 to keep all the
+   keypoints.
+   \param tileOverlap : Number of pixels of the neighborhood of a tile processed with the tile.
+ */
+void vpKeyPoint::setTiledDetection(const unsigned int nbTileRows, const unsigned int nbTileCols,
+                                   const unsigned int maxKeyPointsPerTile, const unsigned int tileOverlap) {
+  if(nbTileRows == 0 || nbTileCols == 0) {
+    throw vpException(vpException::badValue, "The number of tiles must be positive.");
+  }
+  m_nbTileRows = nbTileRows;
+  m_nbTileCols = nbTileCols;
+  m_maxKeyPointsPerTile = maxKeyPointsPerTile;
+  m_tileOverlap = tileOverlap;
+}
+
+/*!
+   Set if the train descriptors are matched with a vpBinaryDescriptorIndex instead of the OpenCV matcher.
+
+   The index is a multi-probe LSH index of binary descriptors (ORB, BRISK, FREAK, BRIEF...) using the Hamming
+   distance. It is updated when train keypoints are added, can be saved with the learning data, and queries
+   the descriptors of an image in parallel when ViSP is built with OpenMP. The search is approximate: a
+   nearest neighbor may be missed, which is in practice compensated by the matching filters. Non binary
+   descriptors and the matching of the train keypoints to the query keypoints (see setUseMatchTrainToQuery())
+   still use the OpenCV matcher.
+
+   \param useIndex : True to use the descriptor index.
+ */
+void vpKeyPoint::setUseDescriptorIndex(const bool useIndex) {
+  m_useDescriptorIndex = useIndex;
+  m_descriptorIndex.clear();
+  updateDescriptorIndex(0);
+}
+
+/*!
+   Update the binary descriptor index after train descriptors have been set or added.
+
+   \param startRow : Index of the first train descriptor that is not in the index. If the index does not
+   contain exactly the previous train descriptors, all the train descriptors are indexed again.
+ */
+void vpKeyPoint::updateDescriptorIndex(const int startRow) {
+  if(!m_useDescriptorIndex || m_trainDescriptors.empty() || m_trainDescriptors.type() != CV_8U) {
+    m_descriptorIndex.clear();
+    return;
+  }
+
+  int start = startRow;
+  if(start <= 0 || m_descriptorIndex.size() != (unsigned int) start) {
+    //Index all the train descriptors
+    m_descriptorIndex.clear();
+    start = 0;
+  }
+
+  if(start < m_trainDescriptors.rows) {
+    cv::Mat descriptors = m_trainDescriptors.rowRange(start, m_trainDescriptors.rows);
+    if(!descriptors.isContinuous()) {
+      descriptors = descriptors.clone();
+    }
+    m_descriptorIndex.add(descriptors.ptr<unsigned char>(0), (unsigned int) descriptors.rows,
+                          (unsigned int) descriptors.cols);
+  }
 }
 
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the multi-images camera calibration on synthetic data.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testCalibrationMulti.cpp
+
+  Test the multi-images camera calibration with and without distortion on
+  synthetic views of a calibration grid.
+*/
+
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpCalibration.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+namespace {
+  // Simulate the views of a planar grid with a camera following the undistorted to distorted model
+  void simulateViews(const vpCameraParameters &cam, unsigned int nbView, std::vector<vpCalibration> &table_cal)
+  {
+    table_cal.clear();
+    for (unsigned int n = 0; n < nbView; n++) {
+      double a = 2 * M_PI * n / nbView;
+      vpHomogeneousMatrix cMo(0.05*cos(a) - 0.12, 0.05*sin(a) - 0.09, 0.5 + 0.1*sin(3*a),
+                              vpMath::rad(20*sin(a)), vpMath::rad(20*cos(a)), vpMath::rad(10*sin(2*a)));
+      vpCalibration calib;
+      calib.clearPoint();
+      for (unsigned int i = 0; i < 7; i++) {
+        for (unsigned int j = 0; j < 9; j++) {
+          double oX = 0.03*j, oY = 0.03*i, oZ = 0;
+          double X = cMo[0][0]*oX + cMo[0][1]*oY + cMo[0][2]*oZ + cMo[0][3];
+          double Y = cMo[1][0]*oX + cMo[1][1]*oY + cMo[1][2]*oZ + cMo[1][3];
+          double Z = cMo[2][0]*oX + cMo[2][1]*oY + cMo[2][2]*oZ + cMo[2][3];
+          double x = X / Z, y = Y / Z;
+          double d = 1 + cam.get_kud() * (x*x + y*y);
+          vpImagePoint ip(cam.get_v0() + cam.get_py()*y*d, cam.get_u0() + cam.get_px()*x*d);
+          calib.addPoint(oX, oY, oZ, ip);
+        }
+      }
+      table_cal.push_back(calib);
+    }
+  }
+}
+
+int main()
+{
+  try {
+    unsigned int nbView = 120;
+    std::vector<vpCalibration> table_cal;
+
+    // Without distortion
+    vpCameraParameters cam_true(600, 610, 320, 240);
+    simulateViews(cam_true, nbView, table_cal);
+    vpCameraParameters cam(550, 550, 310, 250);
+    double error;
+    double t = vpTime::measureTimeMs();
+    vpCalibration::computeCalibrationMulti(vpCalibration::CALIB_VIRTUAL_VS, table_cal, cam, error, false);
+    std::cout << "Calibration without distortion from " << nbView << " views in "
+              << vpTime::measureTimeMs() - t << " ms, residual " << error << std::endl;
+    std::cout << cam << std::endl;
+    if (error > 1e-4 || std::fabs(cam.get_px() - cam_true.get_px()) > 1e-3
+        || std::fabs(cam.get_py() - cam_true.get_py()) > 1e-3 || std::fabs(cam.get_u0() - cam_true.get_u0()) > 1e-3
+        || std::fabs(cam.get_v0() - cam_true.get_v0()) > 1e-3) {
+      std::cerr << "Bad calibration without distortion" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // With distortion. Since the distorted to undistorted model is only an
+    // approximation of the inverse model, the parameters are slightly biased
+    cam_true.initPersProjWithDistortion(600, 610, 320, 240, -0.15, 0.15);
+    simulateViews(cam_true, nbView, table_cal);
+    cam.initPersProjWithoutDistortion(550, 550, 310, 250);
+    t = vpTime::measureTimeMs();
+    vpCalibration::computeCalibrationMulti(vpCalibration::CALIB_VIRTUAL_VS_DIST, table_cal, cam, error, false);
+    std::cout << "Calibration with distortion from " << nbView << " views in "
+              << vpTime::measureTimeMs() - t << " ms, residual " << error << std::endl;
+    std::cout << cam << std::endl;
+    if (std::fabs(cam.get_px() - cam_true.get_px()) > 1 || std::fabs(cam.get_py() - cam_true.get_py()) > 1
+        || std::fabs(cam.get_u0() - cam_true.get_u0()) > 1 || std::fabs(cam.get_v0() - cam_true.get_v0()) > 1
+        || std::fabs(cam.get_kud() - cam_true.get_kud()) > 0.01) {
+      std::cerr << "Bad calibration with distortion" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "testCalibrationMulti is ok" << std::endl;
+  return EXIT_SUCCESS;
+}
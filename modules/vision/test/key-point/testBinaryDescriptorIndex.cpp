@@ -0,0 +1,376 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the binary descriptor index.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testBinaryDescriptorIndex.cpp
+
+  \brief Test the nearest neighbor search of vpBinaryDescriptorIndex against
+  an exhaustive search, the incremental addition of descriptors and the
+  save/load of the index, and compare the matching time.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/vision/vpBinaryDescriptorIndex.h>
+
+// List of allowed command line options
+#define GETOPTARGS	"cdho:"
+
+void usage(const char *name, const char *badparam, const std::string &opath);
+bool getOptions(int argc, const char **argv, std::string &opath);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+  \param opath : Output directory.
+
+ */
+void usage(const char *name, const char *badparam, const std::string &opath)
+{
+  fprintf(stdout, "\n\
+Test the binary descriptor index.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output directory>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output directory>                                %s\n\
+     Directory where the index file is saved.\n\
+\n\
+  -c \n\
+     Disable mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n\n", opath.c_str());
+
+  if (badparam) {
+    fprintf(stderr, "ERROR: \n" );
+    fprintf(stderr, "\nBad parameter [%s]\n", badparam);
+  }
+}
+
+/*!
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param opath : Output directory.
+  \return false if the program has to be stopped, true otherwise.
+*/
+bool getOptions(int argc, const char **argv, std::string &opath)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'o': opath = optarg_; break;
+    case 'h': usage(argv[0], NULL, opath); return false; break;
+
+    default:
+      usage(argv[0], optarg_, opath); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  const unsigned int descriptorSize = 32; // ORB descriptor
+
+  void randomDescriptors(vpUniRand &rng, unsigned int rows, std::vector<unsigned char> &descriptors)
+  {
+    descriptors.resize((size_t)rows * descriptorSize);
+    for (size_t i = 0; i < descriptors.size(); i++)
+      descriptors[i] = (unsigned char)(rng() * 256);
+  }
+
+  // Copy some descriptors and flip a few bits, as a keypoint seen from another view point
+  void noisyQueries(vpUniRand &rng, const std::vector<unsigned char> &train, unsigned int rows,
+                    unsigned int nbFlips, std::vector<unsigned char> &queries, std::vector<unsigned int> &sources)
+  {
+    unsigned int nbTrain = (unsigned int)(train.size() / descriptorSize);
+    queries.resize((size_t)rows * descriptorSize);
+    sources.resize(rows);
+    for (unsigned int q = 0; q < rows; q++) {
+      sources[q] = (unsigned int)(rng() * nbTrain) % nbTrain;
+      for (unsigned int b = 0; b < descriptorSize; b++)
+        queries[q * descriptorSize + b] = train[sources[q] * descriptorSize + b];
+      for (unsigned int f = 0; f < nbFlips; f++) {
+        unsigned int bit = (unsigned int)(rng() * descriptorSize * 8) % (descriptorSize * 8);
+        queries[q * descriptorSize + bit / 8] ^= (unsigned char)(1 << (bit % 8));
+      }
+    }
+  }
+
+  // Write a copy of an index file with the unsigned int at the given byte
+  // position replaced, or truncated to this position if value is NULL, and
+  // check that it cannot be loaded
+  bool isRejected(const std::vector<char> &data, size_t position, const unsigned int *value, const std::string &filename)
+  {
+    std::vector<char> corrupted(data.begin(), data.begin() + (value ? data.size() : position));
+    if (value)
+      memcpy(&corrupted[position], value, sizeof(unsigned int));
+    std::ofstream file(filename.c_str(), std::ofstream::binary);
+    file.write(&corrupted[0], (std::streamsize)corrupted.size());
+    file.close();
+
+    vpBinaryDescriptorIndex index;
+    try {
+      index.load(filename);
+    }
+    catch(vpException &e) {
+      return e.getCode() == vpException::ioError && index.size() == 0;
+    }
+    return false;
+  }
+
+  void exhaustiveMatch(const std::vector<unsigned char> &train, const std::vector<unsigned char> &queries,
+                       std::vector<unsigned int> &bestIdx, std::vector<unsigned int> &bestDist)
+  {
+    unsigned int nbTrain = (unsigned int)(train.size() / descriptorSize);
+    unsigned int nbQueries = (unsigned int)(queries.size() / descriptorSize);
+    bestIdx.resize(nbQueries);
+    bestDist.resize(nbQueries);
+    for (unsigned int q = 0; q < nbQueries; q++) {
+      bestDist[q] = descriptorSize * 8 + 1;
+      for (unsigned int i = 0; i < nbTrain; i++) {
+        unsigned int d = vpBinaryDescriptorIndex::hammingDistance(&queries[q * descriptorSize], &train[i * descriptorSize],
+                                                                  descriptorSize);
+        if (d < bestDist[q]) {
+          bestDist[q] = d;
+          bestIdx[q] = i;
+        }
+      }
+    }
+  }
+
+  bool sameMatches(const std::vector<std::vector<vpBinaryDescriptorIndex::vpMatch> > &m1,
+                   const std::vector<std::vector<vpBinaryDescriptorIndex::vpMatch> > &m2)
+  {
+    if (m1.size() != m2.size())
+      return false;
+    for (size_t q = 0; q < m1.size(); q++) {
+      if (m1[q].size() != m2[q].size())
+        return false;
+      for (size_t i = 0; i < m1[q].size(); i++) {
+        if (m1[q][i].trainIdx != m2[q][i].trainIdx || m1[q][i].distance != m2[q][i].distance
+            || m1[q][i].queryIdx != q)
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    std::string opath;
+    // Set the default output path
+#if defined(_WIN32)
+    opath = "C:/temp";
+#else
+    opath = "/tmp";
+#endif
+    if (getOptions(argc, argv, opath) == false) {
+      exit (-1);
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opath, vpIoTools::getUserName());
+    if (! vpIoTools::checkDirectory(opath))
+      vpIoTools::makeDirectory(opath);
+
+    vpUniRand rng(3);
+    std::vector<unsigned char> train, queries;
+    std::vector<unsigned int> sources, bestIdx, bestDist;
+    std::vector<std::vector<vpBinaryDescriptorIndex::vpMatch> > matches, matches2;
+
+    // Small index: the search is exhaustive and has to give the exact 2 nearest neighbors
+    randomDescriptors(rng, 500, train);
+    noisyQueries(rng, train, 100, 20, queries, sources);
+    vpBinaryDescriptorIndex small_index;
+    small_index.add(&train[0], 500, descriptorSize);
+    small_index.knnMatch(&queries[0], 100, 2, matches);
+    exhaustiveMatch(train, queries, bestIdx, bestDist);
+    for (unsigned int q = 0; q < 100; q++) {
+      if (matches[q].size() != 2 || matches[q][0].distance != bestDist[q] || matches[q][1].distance < matches[q][0].distance
+          || matches[q][0].queryIdx != q) {
+        std::cerr << "Bad exhaustive match for query " << q << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Large index built in several steps, as when learning several objects
+    const unsigned int nbTrain = 50000, nbQueries = 2000;
+    randomDescriptors(rng, nbTrain, train);
+    noisyQueries(rng, train, nbQueries, 20, queries, sources);
+    vpBinaryDescriptorIndex index;
+    for (unsigned int start = 0; start < nbTrain; start += 10000)
+      index.add(&train[start * descriptorSize], 10000, descriptorSize);
+    if (index.size() != nbTrain || index.getDescriptorSize() != descriptorSize) {
+      std::cerr << "Bad index size" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    double t = vpTime::measureTimeMs();
+    index.knnMatch(&queries[0], nbQueries, 2, matches);
+    double t_index = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    exhaustiveMatch(train, queries, bestIdx, bestDist);
+    double t_exhaustive = vpTime::measureTimeMs() - t;
+
+    unsigned int nbFound = 0;
+    for (unsigned int q = 0; q < nbQueries; q++) {
+      if (matches[q].size() != 2 || matches[q][0].distance < bestDist[q]
+          || matches[q][1].distance < matches[q][0].distance) {
+        std::cerr << "Bad match for query " << q << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (matches[q][0].trainIdx == sources[q])
+        nbFound++;
+    }
+    double recall = (double)nbFound / nbQueries;
+    std::cout << "Nearest neighbor found for " << 100. * recall << " % of the queries" << std::endl;
+    if (recall < 0.9) {
+      std::cerr << "The recall is too low" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The same index built in one step gives the same matches
+    vpBinaryDescriptorIndex index2;
+    index2.add(&train[0], nbTrain, descriptorSize);
+    index2.knnMatch(&queries[0], nbQueries, 2, matches2);
+    if (! sameMatches(matches, matches2)) {
+      std::cerr << "The matches depend on the way the index is built" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Save and load the index
+    std::string filename = vpIoTools::createFilePath(opath, "testBinaryDescriptorIndex.bin");
+    index.save(filename);
+    vpBinaryDescriptorIndex index_loaded;
+    t = vpTime::measureTimeMs();
+    index_loaded.load(filename);
+    double t_load = vpTime::measureTimeMs() - t;
+    index_loaded.knnMatch(&queries[0], nbQueries, 2, matches2);
+    if (! sameMatches(matches, matches2)) {
+      std::cerr << "The loaded index does not give the same matches" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Corrupted files are rejected instead of being indexed out of bounds
+    {
+      std::ifstream file(filename.c_str(), std::ifstream::binary);
+      std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      unsigned int header[7];
+      memcpy(header, &data[8], sizeof(header));
+      const size_t keyBits = 8 + sizeof(header);
+      const size_t offsets = keyBits + (size_t)header[2] * header[3] * sizeof(unsigned int);
+      const size_t buckets = offsets + (size_t)header[2] * ((1u << header[3]) + 1) * sizeof(unsigned int);
+      const unsigned int badKeyBit = descriptorSize * 8, badOffset = nbTrain + 1, badBucket = nbTrain;
+      const unsigned int hugeSize = 0x40000000;
+      std::string corrupted = vpIoTools::createFilePath(opath, "testBinaryDescriptorIndexCorrupted.bin");
+      if (! isRejected(data, keyBits + 4, &badKeyBit, corrupted)
+          || ! isRejected(data, offsets + 4, &badOffset, corrupted)
+          || ! isRejected(data, offsets, &badOffset, corrupted)
+          || ! isRejected(data, buckets + 8, &badBucket, corrupted)
+          || ! isRejected(data, 8 + 6 * sizeof(unsigned int), &hugeSize, corrupted)
+          || ! isRejected(data, data.size() - 1, NULL, corrupted)) {
+        std::cerr << "A corrupted index file was loaded" << std::endl;
+        return EXIT_FAILURE;
+      }
+      vpIoTools::remove(corrupted);
+    }
+    vpIoTools::remove(filename);
+
+    // An empty index can be saved and loaded
+    vpBinaryDescriptorIndex index_empty;
+    index_empty.save(filename);
+    index_empty.load(filename);
+    vpIoTools::remove(filename);
+
+    // Descriptors of another size are rejected
+    bool exception = false;
+    try {
+      index.add(&train[0], 1, 64);
+    }
+    catch(const vpException &) {
+      exception = true;
+    }
+    if (! exception) {
+      std::cerr << "Adding descriptors of another size should fail" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Matching of " << nbQueries << " queries with " << nbTrain << " descriptors:" << std::endl;
+    std::cout << "  exhaustive search: " << t_exhaustive << " ms" << std::endl;
+    std::cout << "  index:             " << t_index << " ms" << std::endl;
+    std::cout << "Index loaded in " << t_load << " ms" << std::endl;
+
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
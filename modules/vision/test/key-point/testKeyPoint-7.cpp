@@ -418,6 +418,37 @@ int main(int argc, const char ** argv) {
       }
 
 
+      //Save in the memory-mappable binary format with training images
+      filename = vpIoTools::createFilePath(opath, "mapped_bin_with_img");
+      vpIoTools::makeDirectory(filename);
+      filename = vpIoTools::createFilePath(filename, "test_save_in_mapped_bin_with_img.bin");
+      keyPoints.saveLearningData(filename, true, true, true);
+
+      //Test if save is ok
+      if(!vpIoTools::checkFilename(filename)) {
+        std::stringstream ss;
+        ss << "Problem when saving file=" << filename;
+        throw vpException(vpException::ioError, ss.str().c_str());
+      }
+
+      //Test if read is ok
+      vpKeyPoint read_keypoint_mapped;
+      read_keypoint_mapped.loadLearningData(filename, true);
+      trainKeyPoints_read.clear();
+      read_keypoint_mapped.getTrainKeyPoints(trainKeyPoints_read);
+      trainDescriptors_read = read_keypoint_mapped.getTrainDescriptors();
+
+      if(!compareKeyPoints(trainKeyPoints, trainKeyPoints_read)) {
+        throw vpException(vpException::fatalError, "Problem with trainKeyPoints when reading learning file saved in "
+            "the memory-mappable binary format !");
+      }
+
+      if(!compareDescriptors(trainDescriptors, trainDescriptors_read)) {
+        throw vpException(vpException::fatalError, "Problem with trainDescriptors when reading learning file saved in "
+            "the memory-mappable binary format !");
+      }
+
+
 #if defined(VISP_HAVE_XML2)
       //Save in xml with training images
       filename = vpIoTools::createFilePath(opath, "xml_with_img");
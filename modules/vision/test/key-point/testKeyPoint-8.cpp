@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the tiled keypoint detection and extraction.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020301)
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/vision/vpKeyPoint.h>
+
+// List of allowed command line options
+#define GETOPTARGS "cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the tiled keypoint detection and extraction.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Not used.\n\
+\n\
+  -d \n\
+     Turn off the display. Not used.\n\
+\n\
+  -h\n\
+     Print the help.\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break;
+    case 'd': break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+  bool compareKeyPointPosition(const cv::KeyPoint &kp1, const cv::KeyPoint &kp2) {
+    if (kp1.pt.y != kp2.pt.y)
+      return kp1.pt.y < kp2.pt.y;
+    return kp1.pt.x < kp2.pt.x;
+  }
+
+  bool sameKeyPoints(const std::vector<cv::KeyPoint> &kpts1, const std::vector<cv::KeyPoint> &kpts2) {
+    if (kpts1.size() != kpts2.size())
+      return false;
+    for (size_t i = 0; i < kpts1.size(); i++) {
+      if (kpts1[i].pt != kpts2[i].pt || kpts1[i].response != kpts2[i].response)
+        return false;
+    }
+    return true;
+  }
+}
+
+/*!
+  \example testKeyPoint-8.cpp
+
+  \brief   Test the tiled keypoint detection and extraction.
+*/
+int main(int argc, const char ** argv) {
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      exit (EXIT_FAILURE);
+    }
+
+    //Get the visp-images-data package path or VISP_INPUT_IMAGE_PATH environment variable value
+    std::string env_ipath = vpIoTools::getViSPImagesDataPath();
+
+    if(env_ipath.empty()) {
+      std::cerr << "Please set the VISP_INPUT_IMAGE_PATH environment variable value." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpImage<unsigned char> I;
+    std::string filename = vpIoTools::createFilePath(env_ipath, "ViSP-images/Klimt/Klimt.png");
+    vpImageIo::read(I, filename);
+
+    // FAST is a local detector: with tiles processed with their neighborhood, the keypoints are the same as on the
+    // whole image
+    vpKeyPoint keyPoints("FAST", "ORB", "BruteForce-Hamming");
+    std::vector<cv::KeyPoint> kpts, kpts_tiled;
+    keyPoints.detect(I, kpts);
+    keyPoints.setTiledDetection(3, 4);
+    keyPoints.detect(I, kpts_tiled);
+    std::cout << "FAST: " << kpts.size() << " keypoints, " << kpts_tiled.size() << " keypoints with tiles" << std::endl;
+    std::sort(kpts.begin(), kpts.end(), compareKeyPointPosition);
+    std::sort(kpts_tiled.begin(), kpts_tiled.end(), compareKeyPointPosition);
+    if (kpts.empty() || ! sameKeyPoints(kpts, kpts_tiled)) {
+      std::cerr << "The tiled detection does not give the same FAST keypoints" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Per tile budget
+    const unsigned int nbTileRows = 4, nbTileCols = 4, maxKeyPointsPerTile = 20;
+    vpKeyPoint keyPointsOrb("ORB", "ORB", "BruteForce-Hamming");
+    keyPointsOrb.setTiledDetection(nbTileRows, nbTileCols, maxKeyPointsPerTile);
+    double t = vpTime::measureTimeMs();
+    keyPointsOrb.detect(I, kpts);
+    cv::Mat descriptors;
+    keyPointsOrb.extract(I, kpts, descriptors);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "ORB: " << kpts.size() << " keypoints with tiles in " << t << " ms" << std::endl;
+
+    if (kpts.empty() || kpts.size() > nbTileRows * nbTileCols * maxKeyPointsPerTile
+        || descriptors.rows != (int) kpts.size()) {
+      std::cerr << "Bad number of keypoints or descriptors" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::vector<unsigned int> nbKeyPointsPerTile(nbTileRows * nbTileCols, 0);
+    for (size_t i = 0; i < kpts.size(); i++) {
+      if (kpts[i].pt.x < 0 || kpts[i].pt.y < 0 || kpts[i].pt.x >= I.getWidth() || kpts[i].pt.y >= I.getHeight()) {
+        std::cerr << "Keypoint outside the image" << std::endl;
+        return EXIT_FAILURE;
+      }
+      unsigned int row = std::min(nbTileRows - 1, (unsigned int) (kpts[i].pt.y * nbTileRows / I.getHeight()));
+      unsigned int col = std::min(nbTileCols - 1, (unsigned int) (kpts[i].pt.x * nbTileCols / I.getWidth()));
+      nbKeyPointsPerTile[row * nbTileCols + col]++;
+    }
+    for (size_t i = 0; i < nbKeyPointsPerTile.size(); i++) {
+      // A keypoint on a tile border may be counted in the next tile
+      if (nbKeyPointsPerTile[i] > maxKeyPointsPerTile + 2) {
+        std::cerr << "Too many keypoints in tile " << i << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The result does not depend on the thread scheduling
+    std::vector<cv::KeyPoint> kpts2;
+    cv::Mat descriptors2;
+    keyPointsOrb.detect(I, kpts2);
+    keyPointsOrb.extract(I, kpts2, descriptors2);
+    if (! sameKeyPoints(kpts, kpts2) || cv::countNonZero(descriptors != descriptors2) != 0) {
+      std::cerr << "The tiled detection is not deterministic" << std::endl;
+      return EXIT_FAILURE;
+    }
+  } catch(vpException &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "testKeyPoint-8 is ok !" << std::endl;
+  return EXIT_SUCCESS;
+}
+#else
+#include <cstdlib>
+
+int main() {
+  std::cerr << "You need OpenCV library." << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+#endif